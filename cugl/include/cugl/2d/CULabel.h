@@ -47,6 +47,9 @@
 
 namespace cugl {
 
+/** Forward references */
+class TextBatch;
+
 /**
  * This class is a node the represents a single line of text.
  *
@@ -222,6 +225,8 @@ protected:
     /** THe quad indices for the vertices */
     std::vector<unsigned short> _indices;
     std::shared_ptr<Texture> _texture;
+    /** The text batch to defer drawing to (if any) */
+    std::shared_ptr<TextBatch> _textbatch;
 
 public:
 #pragma mark -
@@ -874,6 +879,30 @@ public:
      */
     GLenum getBlendEquation() const { return _blendEquation; }
 
+    /**
+     * Returns the text batch that this label defers to (if any)
+     *
+     * If this value is not nullptr, then {@link draw} will not draw the label
+     * directly.  Instead it adds the text to the batch, which will render it
+     * when {@link TextBatch#draw} is called.
+     *
+     * @return the text batch that this label defers to (if any)
+     */
+    const std::shared_ptr<TextBatch>& getTextBatch() const { return _textbatch; }
+
+    /**
+     * Sets the text batch that this label defers to (if any)
+     *
+     * If this value is not nullptr, then {@link draw} will not draw the label
+     * directly.  Instead it adds the text to the batch, which will render it
+     * when {@link TextBatch#draw} is called.  This allows many labels in a
+     * scene graph to be rendered with one draw call per font.  However, the
+     * text will no longer be drawn in scene graph order.
+     *
+     * @param batch The text batch that this label defers to (if any)
+     */
+    void setTextBatch(const std::shared_ptr<TextBatch>& batch) { _textbatch = batch; }
+
     /**
      * Draws this Node via the given SpriteBatch.
      *
@@ -931,6 +960,9 @@ private:
      * colors.
      */
     void updateColor();
+
+    // The text batch needs access to the render data
+    friend class TextBatch;
 };
     
 }
@@ -0,0 +1,407 @@
+//
+//  CUTextBatch.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a batch for rendering the text of many labels at
+//  once.  Normally each label sets its own texture and pushes its own mesh
+//  to the SpriteBatch.  When labels with different fonts are interleaved with
+//  other sprites, this causes the SpriteBatch to flush repeatedly.  This class
+//  gathers the glyph quads of many labels, grouped by texture page, and then
+//  emits each page as a single mesh.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_TEXT_BATCH_H__
+#define __CU_TEXT_BATCH_H__
+
+#include <vector>
+#include <unordered_map>
+#include <cugl/math/CUMat4.h>
+#include <cugl/math/CUColor4.h>
+#include <cugl/renderer/CUVertex.h>
+
+namespace cugl {
+
+/** Forward references */
+class Label;
+class Font;
+class Texture;
+class SpriteBatch;
+
+/**
+ * This class is a batch for drawing the text of many labels at once.
+ *
+ * Each label normally draws itself, setting its own texture in the
+ * {@link SpriteBatch}.  If labels with different fonts are drawn in between
+ * other sprites, every label forces a flush of the SpriteBatch.  For things
+ * like scoreboards and damage numbers this can be hundreds of draw calls.
+ *
+ * A text batch collects the glyph quads (and background panels) of many
+ * labels, grouped by the texture page that they use.  The vertices are
+ * transformed and tinted when they are added, so each label may have its
+ * own transform and color.  When the batch is drawn, each page is sent to
+ * the SpriteBatch as a single mesh.  Hence the number of texture switches
+ * is the number of distinct pages, not the number of labels.
+ *
+ * The background panels all share the blank texture, and that page is
+ * always drawn before any glyph page.  Hence no background will ever cover
+ * text, though the text of one label may appear on top of an overlapping
+ * label that was added later.
+ *
+ * Because the text is drawn when the batch is drawn, and not when each label
+ * is added, the text will appear on top of anything drawn earlier in the
+ * pass.  In addition, the blend settings of the individual labels are
+ * ignored; the batch uses its own blend settings for all pages.
+ *
+ * A label may also be attached to a text batch with {@link Label#setTextBatch}.
+ * In that case, drawing the label in a scene graph will defer its text to
+ * this batch, and the text will be rendered when {@link draw} is called.
+ */
+class TextBatch {
+#pragma mark Values
+private:
+    /**
+     * The render data for a single texture page.
+     *
+     * A mesh is limited to the vertex capacity of a default SpriteBatch, so
+     * a page that exceeds this capacity is broken into several meshes.  A
+     * large label may be split across meshes.  These meshes still share
+     * the same texture and so do not force a flush.
+     */
+    class Page {
+    public:
+        /** The texture for this page */
+        std::shared_ptr<Texture> texture;
+        /** The (transformed) vertices for this page */
+        std::vector<Vertex2> vertices;
+        /** The mesh indices for this page */
+        std::vector<unsigned short> indices;
+        /** The vertex offset of each mesh in this page */
+        std::vector<size_t> vsplits;
+        /** The index offset of each mesh in this page */
+        std::vector<size_t> isplits;
+    };
+
+    /** The texture pages, in order of first use */
+    std::vector<Page> _pages;
+    /** A map from texture buffers to page positions */
+    std::unordered_map<GLuint,size_t> _pagemap;
+    /** The number of active pages (pages are recycled between passes) */
+    size_t _pagesize;
+    /** A scratch buffer for text added without a label */
+    std::vector<Vertex2> _scratch;
+
+    /** The texture buffer of the most recent submission (for call estimates) */
+    GLuint _lastBuffer;
+    /** The number of draw calls required if every label rendered itself */
+    unsigned int _naiveCalls;
+    /** The number of labels added in this pass */
+    unsigned int _labelCount;
+
+    /** The blending equation for this batch */
+    GLenum _blendEquation;
+    /** The source factor for the blend function */
+    GLenum _srcFactor;
+    /** The destination factor for the blend function */
+    GLenum _dstFactor;
+
+    /** Whether this batch has been initialized */
+    bool _initialized;
+
+public:
+#pragma mark -
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized text batch.
+     *
+     * You must initialize this batch before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    TextBatch();
+
+    /**
+     * Deletes this text batch, disposing all resources
+     */
+    ~TextBatch() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this batch.
+     *
+     * A disposed batch can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Initializes an empty text batch.
+     *
+     * The batch uses the standard alpha blending of a {@link Label}.
+     *
+     * @return true if initialization was successful.
+     */
+    bool init();
+
+    /**
+     * Returns a newly allocated empty text batch.
+     *
+     * The batch uses the standard alpha blending of a {@link Label}.
+     *
+     * @return a newly allocated empty text batch.
+     */
+    static std::shared_ptr<TextBatch> alloc() {
+        std::shared_ptr<TextBatch> result = std::make_shared<TextBatch>();
+        return (result->init() ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the number of labels added since the last call to {@link clear}.
+     *
+     * @return the number of labels added since the last call to {@link clear}.
+     */
+    unsigned int getLabelCount() const { return _labelCount; }
+
+    /**
+     * Returns the number of texture pages in this batch.
+     *
+     * This is the number of texture switches (and hence draw calls) that
+     * will be made when this batch is drawn.
+     *
+     * @return the number of texture pages in this batch.
+     */
+    unsigned int getPageCount() const { return (unsigned int)_pagesize; }
+
+    /**
+     * Returns the number of draw calls if each label were rendered individually.
+     *
+     * This is an estimate of the number of texture switches that would
+     * occur if the labels were drawn in the order that they were added.
+     * It does not account for any sprites drawn in between the labels, so
+     * the true savings are usually larger.
+     *
+     * @return the number of draw calls if each label were rendered individually.
+     */
+    unsigned int getUnbatchedCalls() const { return _naiveCalls; }
+
+    /**
+     * Returns the number of draw calls saved by this batch.
+     *
+     * This is the difference between {@link getUnbatchedCalls()} and
+     * {@link getPageCount()}.
+     *
+     * @return the number of draw calls saved by this batch.
+     */
+    unsigned int getCallsSaved() const {
+        return _naiveCalls > _pagesize ? _naiveCalls-(unsigned int)_pagesize : 0;
+    }
+
+    /**
+     * Sets the blending function for this batch
+     *
+     * The enums are the standard ones supported by OpenGL.  See
+     *
+     *      https://www.opengl.org/sdk/docs/man/html/glBlendFunc.xhtml
+     *
+     * This setting applies to every page in the batch.  The blend settings
+     * of the individual labels are ignored.
+     *
+     * @param srcFactor Specifies how the source blending factors are computed
+     * @param dstFactor Specifies how the destination blending factors are computed.
+     */
+    void setBlendFunc(GLenum srcFactor, GLenum dstFactor) { _srcFactor = srcFactor; _dstFactor = dstFactor; }
+
+    /**
+     * Returns the source blending factor
+     *
+     * By default this value is GL_SRC_ALPHA. For other options, see
+     *
+     *      https://www.opengl.org/sdk/docs/man/html/glBlendFunc.xhtml
+     *
+     * @return the source blending factor
+     */
+    GLenum getSourceBlendFactor() const { return _srcFactor; }
+
+    /**
+     * Returns the destination blending factor
+     *
+     * By default this value is GL_ONE_MINUS_SRC_ALPHA. For other options, see
+     *
+     *      https://www.opengl.org/sdk/docs/man/html/glBlendFunc.xhtml
+     *
+     * @return the destination blending factor
+     */
+    GLenum getDestinationBlendFactor() const { return _dstFactor; }
+
+    /**
+     * Sets the blending equation for this batch
+     *
+     * The enum must be a standard ones supported by OpenGL.  See
+     *
+     *      https://www.opengl.org/sdk/docs/man/html/glBlendEquation.xhtml
+     *
+     * This setting applies to every page in the batch.
+     *
+     * @param equation  Specifies how source and destination colors are combined
+     */
+    void setBlendEquation(GLenum equation) { _blendEquation = equation; }
+
+    /**
+     * Returns the blending equation for this batch
+     *
+     * By default this value is GL_FUNC_ADD. For other options, see
+     *
+     *      https://www.opengl.org/sdk/docs/man/html/glBlendEquation.xhtml
+     *
+     * @return the blending equation for this batch
+     */
+    GLenum getBlendEquation() const { return _blendEquation; }
+
+#pragma mark -
+#pragma mark Batching
+    /**
+     * Adds the text of the given label to this batch.
+     *
+     * The label vertices are transformed by the given matrix and tinted by
+     * the given color as they are added. The matrix should be the global
+     * transform of the label (e.g. the value passed to {@link Node#draw}).
+     * If the label has a background color, the background panel is added
+     * as well.
+     *
+     * @param label     The label to add
+     * @param transform The global transformation matrix
+     * @param tint      The tint to blend with the label colors
+     */
+    void add(const std::shared_ptr<Label>& label, const Mat4& transform, Color4 tint=Color4::WHITE) {
+        add(label.get(),transform,tint);
+    }
+
+    /**
+     * Adds the text of the given label to this batch.
+     *
+     * The label vertices are transformed by the given matrix and tinted by
+     * the given color as they are added. The matrix should be the global
+     * transform of the label (e.g. the value passed to {@link Node#draw}).
+     * If the label has a background color, the background panel is added
+     * as well.
+     *
+     * @param label     The label to add
+     * @param transform The global transformation matrix
+     * @param tint      The tint to blend with the label colors
+     */
+    void add(Label* label, const Mat4& transform, Color4 tint=Color4::WHITE);
+
+    /**
+     * Adds a single line of text to this batch without a label.
+     *
+     * The text is laid out with the font starting at the given origin, which
+     * is the bottom left corner of the text bounds. The glyphs are then
+     * transformed by the given matrix and colored with the given color.
+     *
+     * This method is useful for transient text like damage numbers, which
+     * do not warrant a scene graph node.
+     *
+     * @param font      The font to render the text
+     * @param text      The text to render
+     * @param origin    The bottom left corner of the text bounds
+     * @param transform The global transformation matrix
+     * @param color     The text color
+     */
+    void add(const std::shared_ptr<Font>& font, const std::string& text, const Vec2& origin,
+             const Mat4& transform, Color4 color=Color4::BLACK);
+
+    /**
+     * Draws all the text in this batch to the given SpriteBatch.
+     *
+     * Each texture page is drawn as a single mesh (unless it exceeds the
+     * vertex capacity of a default SpriteBatch).  The page of background
+     * panels is drawn first, so that the glyphs are on top of every panel.
+     * The SpriteBatch must be active. The text is not cleared afterwards,
+     * so the same batch may be drawn several times.  Call {@link clear} to
+     * start a new pass.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     */
+    void draw(const std::shared_ptr<SpriteBatch>& batch);
+
+    /**
+     * Removes all text from this batch.
+     *
+     * The page buffers are retained (but emptied), so that subsequent
+     * passes do not need to allocate any memory.
+     */
+    void clear();
+
+private:
+#pragma mark -
+#pragma mark Internal Helpers
+    /**
+     * Returns the page for the given texture, creating it if necessary.
+     *
+     * This method also updates the estimate of unbatched draw calls.
+     *
+     * @param texture   The page texture
+     *
+     * @return the page for the given texture
+     */
+    Page& acquire(const std::shared_ptr<Texture>& texture);
+
+    /**
+     * Appends the given quads to the page, transforming and tinting them.
+     *
+     * The vertices are assumed to be quads, in the order produced by
+     * {@link Font#getQuads}. If the page exceeds the mesh capacity, a new
+     * mesh is started in the same page, and the quads are split between them.
+     *
+     * @param page      The page to append to
+     * @param vertices  The vertices to add
+     * @param vsize     The number of vertices to add
+     * @param transform The global transformation matrix
+     * @param tint      The color tint
+     */
+    void append(Page& page, const Vertex2* vertices, size_t vsize, const Mat4& transform, Color4 tint);
+
+    /**
+     * Draws the meshes of a single page to the given SpriteBatch.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     * @param page      The page to draw
+     */
+    void drawPage(const std::shared_ptr<SpriteBatch>& batch, const Page& page);
+};
+
+}
+
+#endif /* __CU_TEXT_BATCH_H__ */
@@ -38,6 +38,7 @@
 #include "CUNinePatch.h"
 #include "CUAnimationNode.h"
 #include "CULabel.h"
+#include "CUTextBatch.h"
 #include "CUButton.h"
 #include "CUProgressBar.h"
 #include "CUSlider.h"
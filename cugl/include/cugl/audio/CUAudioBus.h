@@ -0,0 +1,356 @@
+//
+//  CUAudioBus.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a submix bus for the software mixer.  Buses form a
+//  tree rooted at the master bus.  Every sound effect voice is routed to a
+//  bus, and every bus other than master is mixed into its parent.  A bus has
+//  its own gain and an ordered chain of DSP nodes, which are applied to the
+//  submix before the gain.
+//
+//  The mixer always creates four buses: master, music, sound (for effects)
+//  and voice (for dialogue).  Applications may add their own buses beneath
+//  these.  Buses are never removed, though they may be left empty.
+//
+//  Bus gains may be set from any thread, and are ramped over the next block.
+//  Every edit to the node chain publishes a new copy of the chain to the
+//  audio thread, so the audio thread never waits on a lock.  Edits should
+//  still be infrequent.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_AUDIO_BUS_H__
+#define __CU_AUDIO_BUS_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/audio/CUAudioNode.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cugl {
+
+/** Forward reference to the software mixer */
+class SoundMixer;
+
+#pragma mark -
+#pragma mark Audio Bus
+/**
+ * This class is a submix bus with a gain and a chain of DSP nodes.
+ *
+ * Buses are created by the mixer (or by {@link AudioEngine#addBus}), which
+ * assigns each one an index.  A parent always has a smaller index than its
+ * children, so the mixer processes the buses from the highest index to the
+ * lowest, and master (index 0) is always last.
+ *
+ * The level of a bus is the RMS level of its most recent block, after the
+ * nodes and gain have been applied.  It is suitable for metering, and is
+ * used as the key of a {@link DuckerNode}.
+ */
+class AudioBus {
+private:
+    /** This macro disables the copy constructor (not allowed on buses) */
+    CU_DISALLOW_COPY_AND_ASSIGN(AudioBus);
+
+    /** A node chain, as published to the audio thread */
+    typedef std::vector<std::shared_ptr<AudioNode>> NodeChain;
+
+    /** The bus name */
+    std::string _name;
+    /** The index of this bus in the mixer */
+    Uint32 _index;
+    /** The index of the parent bus (this index for master) */
+    Uint32 _parent;
+    /** The target gain */
+    std::atomic<float> _gain;
+    /** The RMS level of the most recent block */
+    std::atomic<float> _level;
+    /** The current gain (audio thread only) */
+    float _current;
+    /** Whether anything was mixed into this bus this block (audio thread only) */
+    bool _touched;
+    /** The DSP node chain */
+    NodeChain _nodes;
+    /** The lock protecting node chain edits (never held by the audio thread) */
+    mutable std::mutex _mutex;
+    /** The copy of the node chain used by the audio thread (nullptr if empty) */
+    std::atomic<NodeChain*> _chain;
+    /** The number of blocks processed by the audio thread */
+    std::atomic<Uint64> _blocks;
+    /** The replaced chains, with the block count at the time of replacement */
+    std::vector<std::pair<Uint64,NodeChain*>> _retired;
+    /** The raw allocation for the submix buffer */
+    void*  _raw;
+    /** The aligned submix buffer (interleaved stereo) */
+    float* _buffer;
+    /** The capacity of the submix buffer in frames */
+    Uint32 _capacity;
+
+public:
+    /** The index of the master bus */
+    static const Uint32 MASTER = 0;
+    /** The index of the music bus */
+    static const Uint32 MUSIC = 1;
+    /** The index of the sound effect bus */
+    static const Uint32 SOUND = 2;
+    /** The index of the voice (dialogue) bus */
+    static const Uint32 VOICE = 3;
+
+#pragma mark Constructors
+    /**
+     * Creates a degenerate bus with no buffer.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioBus();
+
+    /**
+     * Deletes this bus, disposing all resources.
+     */
+    ~AudioBus() { dispose(); }
+
+    /**
+     * Disposes all resources allocated for this bus.
+     *
+     * The bus must not be in use by the audio thread when this is called.
+     */
+    void dispose();
+
+    /**
+     * Initializes a bus with the given name and position in the tree.
+     *
+     * A bus whose parent is its own index is a root (master) bus.
+     *
+     * @param name      The bus name
+     * @param index     The bus index in the mixer
+     * @param parent    The index of the parent bus
+     * @param capacity  The maximum block size in frames
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(const std::string& name, Uint32 index, Uint32 parent, Uint32 capacity);
+
+    /**
+     * Returns a newly allocated bus with the given name and position in the tree.
+     *
+     * A bus whose parent is its own index is a root (master) bus.
+     *
+     * @param name      The bus name
+     * @param index     The bus index in the mixer
+     * @param parent    The index of the parent bus
+     * @param capacity  The maximum block size in frames
+     *
+     * @return a newly allocated bus with the given name and position in the tree.
+     */
+    static std::shared_ptr<AudioBus> alloc(const std::string& name, Uint32 index,
+                                           Uint32 parent, Uint32 capacity) {
+        std::shared_ptr<AudioBus> result = std::make_shared<AudioBus>();
+        return (result->init(name,index,parent,capacity) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the name of this bus.
+     *
+     * @return the name of this bus.
+     */
+    const std::string& getName() const { return _name; }
+
+    /**
+     * Returns the index of this bus in the mixer.
+     *
+     * @return the index of this bus in the mixer.
+     */
+    Uint32 getIndex() const { return _index; }
+
+    /**
+     * Returns the index of the parent bus.
+     *
+     * The master bus is its own parent.
+     *
+     * @return the index of the parent bus.
+     */
+    Uint32 getParent() const { return _parent; }
+
+    /**
+     * Returns true if this is the master bus.
+     *
+     * @return true if this is the master bus.
+     */
+    bool isMaster() const { return _parent == _index; }
+
+    /**
+     * Returns the gain of this bus.
+     *
+     * @return the gain of this bus.
+     */
+    float getGain() const { return _gain.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets the gain of this bus.
+     *
+     * The change is ramped over the next block to prevent clicks.
+     *
+     * @param gain  The bus gain
+     */
+    void setGain(float gain) { _gain.store(gain < 0 ? 0 : gain,std::memory_order_relaxed); }
+
+    /**
+     * Returns the RMS level of the most recent block.
+     *
+     * This level is measured after the nodes and the gain.
+     *
+     * @return the RMS level of the most recent block.
+     */
+    float getLevel() const { return _level.load(std::memory_order_relaxed); }
+
+#pragma mark Node Chain
+    /**
+     * Returns the number of nodes in this bus.
+     *
+     * @return the number of nodes in this bus.
+     */
+    size_t getNodeCount() const;
+
+    /**
+     * Returns the node at the given position.
+     *
+     * @param pos   The node position
+     *
+     * @return the node at the given position.
+     */
+    std::shared_ptr<AudioNode> getNode(size_t pos) const;
+
+    /**
+     * Returns the first node with the given name (or nullptr).
+     *
+     * @param name  The node name
+     *
+     * @return the first node with the given name (or nullptr).
+     */
+    std::shared_ptr<AudioNode> getNode(const std::string& name) const;
+
+    /**
+     * Appends a node to the end of the chain.
+     *
+     * @param node  The node to append
+     */
+    void addNode(const std::shared_ptr<AudioNode>& node);
+
+    /**
+     * Inserts a node at the given position in the chain.
+     *
+     * @param pos   The position to insert at
+     * @param node  The node to insert
+     */
+    void insertNode(size_t pos, const std::shared_ptr<AudioNode>& node);
+
+    /**
+     * Removes a node from the chain.
+     *
+     * @param node  The node to remove
+     *
+     * @return true if the node was in the chain
+     */
+    bool removeNode(const std::shared_ptr<AudioNode>& node);
+
+    /**
+     * Removes all nodes from the chain.
+     */
+    void clearNodes();
+
+#pragma mark Profiling
+    /**
+     * Returns a report of the CPU cost of each node in this bus.
+     *
+     * There is one line per node, with the average cost per block in
+     * microseconds and the load as a percentage of one core.
+     *
+     * @return a report of the CPU cost of each node in this bus.
+     */
+    std::string getProfile() const;
+
+private:
+    /**
+     * Publishes a copy of the node chain to the audio thread.
+     *
+     * The replaced copy is deleted once the audio thread has finished a
+     * block without it.  This method must be called while holding the lock.
+     */
+    void publish();
+
+#pragma mark Mixing (Audio Thread)
+    /**
+     * Returns the submix buffer of this bus.
+     *
+     * Anything mixed into this buffer should also {@link touch} the bus.
+     *
+     * @return the submix buffer of this bus.
+     */
+    float* getBuffer() { return _buffer; }
+
+    /**
+     * Marks that audio was mixed into this bus for the current block.
+     */
+    void touch() { _touched = true; }
+
+    /**
+     * Clears the submix buffer for a new block.
+     *
+     * @param frames    The number of frames in the block
+     */
+    void clear(Uint32 frames);
+
+    /**
+     * Processes the submix and adds it to the given output.
+     *
+     * This applies the node chain and then the gain.  If the bus is silent
+     * and has no nodes, it does nothing and returns false.
+     *
+     * @param output    The output buffer (interleaved stereo)
+     * @param frames    The number of frames in the block
+     *
+     * @return true if anything was added to the output
+     */
+    bool process(float* output, Uint32 frames);
+
+    /** Allow the mixer access to the submix */
+    friend class SoundMixer;
+};
+
+}
+
+#endif /* __CU_AUDIO_BUS_H__ */
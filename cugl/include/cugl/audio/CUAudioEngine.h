@@ -40,7 +40,9 @@
 #define __CU_AUDIO_ENGINE_H__
 #include <cugl/audio/CUSound.h>
 #include <cugl/audio/CUMusic.h>
+#include <cugl/audio/CUAudioBus.h>
 #include <cugl/util/CUTimestamp.h>
+#include <cugl/math/CUVec2.h>
 #include <functional>
 #include <unordered_map>
 #include <vector>
@@ -65,13 +67,25 @@ namespace cugl {
 class SoundChannel;
 /** Opaque reference to "hidden" package class for the music queue */
 class MusicQueue;
+
+/** 
+ * A generation-checked reference to an active sound effect
+ *
+ * Handles are returned by {@link AudioEngine#playEffect}.  A handle remains
+ * valid until its sound effect completes.  After that, the engine will 
+ * safely reject it, even if the internal slot has been reused by another 
+ * sound.  The value 0 is never a valid handle.
+ */
+typedef Uint64 EffectHandle;
     
 /**
  * Class provides a singleton audio engine
  *
  * This class is a simple (e.g. 2000-era) audio engine.  It exposes a flat 
- * channel structure and there is no mixer graph for advanced effects such
- * as 3D audio.  If you need these features, use {@link AudioEngineHD} instead.
+ * channel structure, with a simple tree of {@link AudioBus} objects for
+ * submixing.  Each bus may have a short chain of effects (filters, dynamics,
+ * and reverb).  If you need a more general mixer graph, use
+ * {@link AudioEngineHD} instead.
  *
  * This class allows one music asset to be played at a time, though it does
  * allow you to queue up music asset.  All other sounds should be preloaded.
@@ -88,6 +102,10 @@ class MusicQueue;
  * executed in the host thread.  If you need to access the AudioEngine in a
  * callback function, you should use the {@link Application#schedule} method
  * to delay until the main thread is next available.
+ *
+ * The engine uses the {@link Application} to collect completed sounds every
+ * animation frame.  If there is no application, completed sounds are only
+ * collected when a new sound or music asset is played.
  */
 class AudioEngine {
 #pragma mark -
@@ -105,6 +123,23 @@ public:
         PAUSED
     };
 
+    /**
+     * This enumeration is the distance attenuation model for positional audio
+     *
+     * These are the clamped models of OpenAL.  The distance is clamped to
+     * the range [reference,maximum] of the effect before it is applied.
+     */
+    enum class DistanceModel {
+        /** There is no distance attenuation (sounds are only panned) */
+        NONE,
+        /** The gain is reference/(reference+rolloff*(distance-reference)) */
+        INVERSE,
+        /** The gain falls linearly from 1 at reference to 1-rolloff at maximum */
+        LINEAR,
+        /** The gain is (distance/reference)^(-rolloff) */
+        EXPONENTIAL
+    };
+
     
 private:
     /** Reference to the audio engine singleton */
@@ -117,10 +152,96 @@ private:
     unsigned int _capacity;
     /** The channel objects for managing sounds */
     std::vector<std::shared_ptr<SoundChannel>> _channels;
-    /** Map keys to identifiers */
-    std::unordered_map<std::string,int> _effects;
-    /** The queue for subsequent sound loops */
-    std::deque<std::string> _equeue;
+    
+    /**
+     * The state of an active sound effect.
+     *
+     * Effects are stored in slots, which are referenced by an {@link EffectHandle}.
+     * A slot is reused once its effect completes, but its generation changes, 
+     * so that old handles are safely rejected.
+     *
+     * Effects are ranked first by priority and then by audibility (volume
+     * times attenuation).  The lowest ranked effects lose their channels first
+     * when the engine runs out.  An effect without a channel is virtual.  It
+     * keeps track of its playback position, so that it can pick up at the 
+     * correct place when it regains a channel.
+     */
+    typedef struct {
+        /** The generation of this slot (changes each time it is reused) */
+        Uint32 generation;
+        /** Whether this slot holds an active effect */
+        bool active;
+        /** The channel for this effect (-1 if virtual) */
+        int channel;
+        /** The string key for this effect (empty if anonymous) */
+        std::string key;
+        /** The effect priority (higher values are more important) */
+        Sint32 priority;
+        /** The game-specific attenuation (e.g. from distance) */
+        float attenuation;
+        /** Whether this effect has a position */
+        bool positional;
+        /** The emitter position (positional effects only) */
+        Vec2 position;
+        /** The emitter velocity (positional effects only) */
+        Vec2 velocity;
+        /** The distance at which there is no attenuation */
+        float reference;
+        /** The distance beyond which there is no further attenuation */
+        float maximum;
+        /** The rate of attenuation beyond the reference distance */
+        float rolloff;
+        /** The bus this effect is routed to */
+        Uint32 bus;
+        /** The sound asset (virtual effects only) */
+        std::shared_ptr<Sound> sound;
+        /** The effect volume (virtual effects only) */
+        float volume;
+        /** Whether the effect loops (virtual effects only) */
+        bool loop;
+        /** Whether the effect is paused (virtual effects only) */
+        bool paused;
+        /** The playback position (in seconds) at the time marked */
+        double elapsed;
+        /** The time at which the playback position was recorded */
+        Timestamp marked;
+        /** The audio clock at which the playback position was recorded */
+        Uint64 clock;
+    } Effect;
+    
+    /** The effect slots */
+    std::vector<Effect> _slots;
+    /** The unused effect slots (reused in FIFO order) */
+    std::deque<Uint32> _unused;
+    /** The number of active effects with a channel */
+    size_t _audible;
+    /** The number of active effects without a channel */
+    size_t _virtual;
+    /** Map string keys to handles (for the string API) */
+    std::unordered_map<std::string,EffectHandle> _keys;
+    /** The active effects in the order played (lazily cleaned) */
+    std::deque<EffectHandle> _equeue;
+    /** The channels with no attached assets */
+    std::vector<int> _freelist;
+    /** The channels that are stopped but not yet detached */
+    std::vector<int> _stoplist;
+    /** The channels with a shadow asset waiting to play (offline only) */
+    std::vector<int> _shadowlist;
+    /** The scheduled callback for updating virtual effects */
+    Uint32 _scheduler;
+    /** Whether this engine renders offline (with no audio device) */
+    bool _offline;
+    
+    /** The listener position for positional effects */
+    Vec2 _listenerPos;
+    /** The listener velocity for positional effects */
+    Vec2 _listenerVel;
+    /** The distance attenuation model for positional effects */
+    DistanceModel _model;
+    /** The doppler factor (0 if disabled) */
+    float _doppler;
+    /** The speed of sound for doppler */
+    float _speed;
     
     /** 
      * Callback function for background music
@@ -147,6 +268,19 @@ private:
      * @param status    True if the music terminated normally, false otherwise.
      */
     std::function<void(const std::string& key , bool status)> _soundCB;
+
+    /**
+     * Callback function for the sound effects (by handle)
+     *
+     * This function is called whenever a sound effect completes. It is called
+     * whether or not the sound completed normally or if it was terminated 
+     * manually.  However, the second parameter can be used to distinguish the 
+     * two cases.
+     *
+     * @param handle    The handle identifying this sound effect
+     * @param status    True if the music terminated normally, false otherwise.
+     */
+    std::function<void(EffectHandle handle, bool status)> _handleCB;
     
 #pragma mark -
 #pragma mark Constructors (Private)
@@ -155,7 +289,8 @@ private:
      *
      * The engine must be initialized before is can be used.
      */
-    AudioEngine() : _capacity(0) {}
+    AudioEngine() : _capacity(0), _audible(0), _virtual(0), _scheduler(0), _offline(false),
+    _model(DistanceModel::INVERSE), _doppler(0), _speed(343.3f) {}
     
     /**
      * Disposes of the singleton audio engine.
@@ -172,11 +307,15 @@ private:
      * the mixer graph for the sound effect channels.  The provided parameter
      * indicates the number of simultaneously supported sounds.
      *
+     * If offline is true, the engine does not open an audio device, and only
+     * advances when {@link render} is called.
+     *
      * @param channels  The maximum number of sound effect channels to support
+     * @param offline   Whether to render offline
      *
      * @return true if the audio engine was successfully initialized.
      */
-    bool init(unsigned int channels=AUDIO_INPUT_CHANNELS);
+    bool init(unsigned int channels=AUDIO_INPUT_CHANNELS, bool offline=false);
     
     /**
      * Releases all resources for this singleton audio engine.
@@ -190,14 +329,204 @@ private:
 #pragma mark -
 #pragma mark Internal Helpers
     /**
-     * Purges this key from the list of active effects.
+     * Returns the effect for the given handle, or nullptr if it is invalid.
+     *
+     * A handle is invalid if its effect has completed, even if the slot has
+     * been reused since.
+     *
+     * @param handle    The effect handle
+     *
+     * @return the effect for the given handle, or nullptr if it is invalid.
+     */
+    Effect* lookup(EffectHandle handle);
+    
+    /**
+     * Returns the effect for the given handle, or nullptr if it is invalid.
+     *
+     * A handle is invalid if its effect has completed, even if the slot has
+     * been reused since.
+     *
+     * @param handle    The effect handle
+     *
+     * @return the effect for the given handle, or nullptr if it is invalid.
+     */
+    const Effect* lookup(EffectHandle handle) const;
+    
+    /**
+     * Returns the handle for the given key, or 0 if there is none.
+     *
+     * @param key   The reference key for the sound effect
+     *
+     * @return the handle for the given key, or 0 if there is none.
+     */
+    EffectHandle lookup(const std::string& key) const;
+    
+    /**
+     * Returns the handle for the effect in the given slot.
+     *
+     * @param slot  The slot index
+     *
+     * @return the handle for the effect in the given slot.
+     */
+    EffectHandle handleOf(Uint32 slot) const {
+        return (((EffectHandle)_slots[slot].generation) << 32) | slot;
+    }
+    
+    /**
+     * Purges this effect from the list of active effects.
      *
      * This method is not the same as stopping the channel. A channel may play a
-     * little longer after the key is removed.  This is simply a clean-up method.
+     * little longer after the effect is removed.  This is simply a clean-up 
+     * method.  The slot is released, invalidating the handle.
+     *
+     * @param handle    The effect to purge from the list of active effects.
+     */
+    void removeEffect(EffectHandle handle);
+    
+    /**
+     * Returns a channel available for a new sound effect, or -1 if none.
+     *
+     * Channels with no attached assets are preferred.  Otherwise this
+     * method returns a stopped channel that is still waiting to detach.  In
+     * that case, shadow is set to true, and the new asset must be attached
+     * as a shadow asset.
+     *
+     * @param shadow    Whether the new asset must be a shadow asset
+     *
+     * @return a channel available for a new sound effect, or -1 if none.
+     */
+    int acquireChannel(bool& shadow);
+    
+    /**
+     * Starts a sound effect on the given channel.
+     *
+     * A shadow asset starts once the stopped asset has had a chance to
+     * fade out.  Normally this is the next animation frame.  For an offline
+     * engine, it is the start of the next call to {@link render}.
+     *
+     * @param id        The channel to play on
+     * @param shadow    Whether to attach the sound as a shadow asset
+     * @param handle    The handle for the sound effect
+     * @param sound     The sound effect to play
+     * @param volume    The sound effect volume
+     * @param loop      Whether to loop the sound effect continuously
+     * @param time      The position (in seconds) to start playback
+     */
+    void startChannel(int id, bool shadow, EffectHandle handle, const std::shared_ptr<Sound>& sound,
+                      float volume, bool loop, double time);
+    
+    /**
+     * Returns true if the first effect outranks the second.
+     *
+     * Effects are ranked first by priority and then by audibility.
+     *
+     * @param priority1 The priority of the first effect
+     * @param volume1   The audibility of the first effect
+     * @param priority2 The priority of the second effect
+     * @param volume2   The audibility of the second effect
+     *
+     * @return true if the first effect outranks the second.
+     */
+    static bool outranks(Sint32 priority1, float volume1, Sint32 priority2, float volume2) {
+        return priority1 > priority2 || (priority1 == priority2 && volume1 > volume2);
+    }
+    
+    /**
+     * Returns the audibility (volume times attenuation) of the given effect.
+     *
+     * For positional effects, the attenuation includes the distance model.
+     *
+     * @param effect    The sound effect
+     *
+     * @return the audibility (volume times attenuation) of the given effect.
+     */
+    float getAudibility(const Effect& effect) const;
+    
+    /**
+     * Returns the distance attenuation of the given effect.
+     *
+     * This is a scalar version of the computation performed by the mixer,
+     * and is used to rank effects.  It is 1 for effects without a position.
+     *
+     * @param effect    The sound effect
+     *
+     * @return the distance attenuation of the given effect.
+     */
+    float getDistanceGain(const Effect& effect) const;
+    
+    /**
+     * Sends the emitter of the given effect to its channel.
+     *
+     * Effects without a position clear the emitter of the channel.
+     *
+     * @param effect    The sound effect (which must have a channel)
+     */
+    void applyEmitter(const Effect& effect);
+    
+    /**
+     * Returns the lowest ranked effect with a channel, or 0 if none.
+     *
+     * Only effects that are outranked by the given priority and audibility
+     * are considered, unless force is true.  Ties are broken in favor of
+     * stealing from the oldest effect.
+     *
+     * @param priority  The priority of the effect that needs a channel
+     * @param volume    The audibility of the effect that needs a channel
+     * @param force     Whether to consider all effects
+     *
+     * @return the lowest ranked effect with a channel, or 0 if none.
+     */
+    EffectHandle findVictim(Sint32 priority, float volume, bool force) const;
+    
+    /**
+     * Moves an effect from its channel to the virtual effects.
+     *
+     * The channel is stopped, but the effect remains active and keeps
+     * track of its playback position.
+     *
+     * @param effect    The sound effect
+     *
+     * @return the channel freed by this effect
+     */
+    int virtualize(Effect& effect);
+    
+    /**
+     * Records the current time as the reference for the effect position.
      *
-     * @remove key  The key to purge from the list of active effects.
+     * The position of a virtual effect is measured from this time.
+     *
+     * @param effect    The sound effect
+     */
+    void markEffect(Effect& effect) const;
+    
+    /**
+     * Returns the current playback position of a virtual effect in seconds.
+     *
+     * For effects that do not loop, this value may exceed the duration.
+     * An offline engine measures this position with the audio clock, so
+     * that it only advances when the engine is rendered.
+     *
+     * @param effect    The virtual effect
+     *
+     * @return the current playback position of a virtual effect in seconds.
+     */
+    double getVirtualTime(const Effect& effect) const;
+    
+    /**
+     * Updates the virtual effects, moving the most audible ones to channels.
+     *
+     * This method also garbage collects any virtual effects that would
+     * have completed by now.  It is called once every animation frame.
+     */
+    void updateVirtuals();
+    
+    /**
+     * Starts the shadow assets waiting on channels of an offline engine.
+     *
+     * This takes the place of the callback that a realtime engine
+     * schedules with the {@link Application}.
      */
-    void removeKey(std::string key);
+    void advanceShadows();
     
     
 #pragma mark -
@@ -230,6 +559,24 @@ public:
      */
     static void start(unsigned int channels=AUDIO_INPUT_CHANNELS);
     
+    /**
+     * Starts the singleton audio engine without an audio device.
+     *
+     * An offline engine behaves like a normal engine, except that time only
+     * advances when {@link render} is called.  Completion callbacks are
+     * invoked inside of that method, so the behavior of the engine is
+     * deterministic.  This is intended for automated tests and benchmarks
+     * (see {@link AudioRecorder}).
+     *
+     * Offline rendering requires the SDL audio backend.  On other backends,
+     * this method fails and get() will continue to return nullptr.  Calling
+     * the method while an engine is running (without calling stop) will have
+     * no effect.
+     *
+     * @param channels  The maximum number of sound effect channels to support
+     */
+    static void startOffline(unsigned int channels=AUDIO_INPUT_CHANNELS);
+    
     /**
      * Stops the singleton audio engine, releasing all resources.
      *
@@ -242,6 +589,64 @@ public:
      */
     static void stop();
     
+    /**
+     * Returns the generation that follows the given one.
+     *
+     * A slot advances its generation each time its sound effect completes,
+     * so that old handles to the slot are rejected.  Generations wrap
+     * around, but they skip 0, as 0 is never a valid handle.
+     *
+     * @param generation    The current slot generation
+     *
+     * @return the generation that follows the given one.
+     */
+    static Uint32 nextGeneration(Uint32 generation) {
+        return generation == 0xFFFFFFFF ? 1 : generation+1;
+    }
+    
+    
+#pragma mark -
+#pragma mark Offline Rendering
+    /**
+     * Returns true if this engine renders offline.
+     *
+     * An offline engine has no audio device.  It only advances when
+     * {@link render} is called.
+     *
+     * @return true if this engine renders offline.
+     */
+    bool isOffline() const { return _offline; }
+    
+    /**
+     * Returns the sample rate of the engine output.
+     *
+     * @return the sample rate of the engine output.
+     */
+    Uint32 getSampleRate() const;
+    
+    /**
+     * Returns the number of channels of the engine output.
+     *
+     * @return the number of channels of the engine output.
+     */
+    Uint32 getOutputChannels() const;
+    
+    /**
+     * Advances an offline engine by the given number of frames.
+     *
+     * The output is interleaved floats, with {@link getOutputChannels}
+     * samples per frame.  The previous contents of the buffer are replaced.
+     * Any completion callbacks are invoked (and virtual effects are updated)
+     * before this method returns.  Sounds that took over the channel of
+     * another sound since the last call start on the first frame.
+     *
+     * This method may only be called on an offline engine.
+     *
+     * @param output    The output buffer
+     * @param frames    The number of frames to render
+     */
+    void render(float* output, Uint32 frames);
+    
     
 #pragma mark -
 #pragma mark Music Management
@@ -271,6 +676,40 @@ public:
      */
     void playMusic(const std::shared_ptr<Music>& music, bool loop=false, float volume=-1.0f, float fade=0.0f);
     
+    /**
+     * Plays given music asset as a background track at the given clock time.
+     *
+     * This method is the same as {@link playMusic}, except that the music
+     * is silent until the audio clock (see {@link getClock}) reaches the
+     * given time.  The music then starts on that exact audio frame, which
+     * makes it possible to synchronize music with gameplay.  If the time has
+     * already passed, the music starts immediately.  The music asset
+     * replaces any active music immediately, not at the scheduled time.
+     *
+     * Not all platforms can start music on an exact audio frame.  On those
+     * platforms, the start time is only accurate to an animation frame.
+     *
+     * @param music     The music asset to play
+     * @param time      The audio clock time to start playback
+     * @param loop      Whether to loop the music continuously
+     * @param volume    The music volume (< 0 to use asset default volume)
+     * @param fade      The number of seconds to fade in
+     */
+    void scheduleMusic(const std::shared_ptr<Music>& music, Uint64 time, bool loop=false,
+                       float volume=-1.0f, float fade=0.0f);
+    
+    /**
+     * Returns the audio clock, in audio frames.
+     *
+     * The audio clock is the number of frames rendered by the audio device
+     * since the engine started.  It is updated by the audio thread, so it
+     * is not tied to the animation frame rate.  Divide by {@link getSampleRate}
+     * to convert it to seconds.  This is the time base for {@link scheduleMusic}.
+     *
+     * @return the audio clock, in audio frames.
+     */
+    Uint64 getClock() const;
+    
     /**
      * Returns the music asset currently playing
      *
@@ -480,10 +919,10 @@ public:
     /**
      * Callback function for when a music channel finishes
      *
-     * This method is called when the active music completes.  If there is any
-     * music waiting in the queue, it plays it immediately (using the second
-     * channel for a smooth transition).  Otherwise, it sets _musicData to
-     * nullptr.
+     * This method is called when the active music completes.  If the next
+     * music in the queue has already taken over (because it was cued), it
+     * becomes the active music.  Otherwise, if there is any music waiting in
+     * the queue, it plays it immediately.
      *
      * This method is never intended to be accessed by general users.  It is
      * only publicly visible because this makes our cross-platform code cleaner.
@@ -507,9 +946,14 @@ public:
      * If the queue is empty and there is no active music, this method will 
      * play the music immediately.  Otherwise, it will add the music to the 
      * queue, and it will play as soon as it is removed from the queue.
+     * Queued music starts on the audio frame after the previous track ends,
+     * so there is no gap between tracks.
      *
      * When it begins playing, it will start at full volume unless you
-     * provide a number of seconds to fade in. Note that looping a song will
+     * provide a number of seconds to fade in.  If the music follows another
+     * track, the fade is a crossfade: the music starts that many seconds
+     * before the end of the previous track, and the two overlap.  Not all
+     * platforms support crossfades.  Note that looping a song will
      * cause it to block the queue indefinitely until you turn off looping for
      * that asset {@see setLoop}. This can be desired behavior, as it gives you
      * a way to control the speed of the queue processing.
@@ -517,7 +961,7 @@ public:
      * @param music     The music asset to queue
      * @param loop      Whether to loop the music continuously
      * @param volume    The music volume (< 0 to use asset default volume)
-     * @param fade      The number of seconds to fade in
+     * @param fade      The number of seconds to fade in (or crossfade)
      */
     void queueMusic(const std::shared_ptr<Music>& music, bool loop=false, float volume=-1.0f, float fade=0.0f);
     
@@ -562,20 +1006,26 @@ public:
      * is the responsibility of the application layer to manage key usage.
      *
      * There are a limited number of channels available for sound effects.  If 
-     * you go over the number available, the sound will not play unless force 
-     * is true. In that case, it will grab the channel from the longest playing 
-     * sound effect.
+     * you go over the number available, the sound will take the channel of the
+     * lowest ranked sound effect, provided that this sound outranks it.  Sounds
+     * are ranked first by priority and then by audibility (volume times
+     * attenuation).  The displaced sound is not stopped.  It becomes a virtual
+     * effect that keeps track of its position, and will get a channel back
+     * once one is available.  If this sound does not outrank any playing
+     * sound, it starts as a virtual effect itself, unless force is true.  In
+     * that case, it will grab the channel from the lowest ranked sound effect.
      *
      * @param  key      The reference key for the sound effect
      * @param  sound    The sound effect to play
      * @param  loop     Whether to loop the sound effect continuously
      * @param  volume   The sound effect (< 0 to use asset default volume)
-     * @param  force    Whether to force another sound to stop.
+     * @param  force    Whether to force another sound off its channel.
+     * @param  priority The sound priority (higher values are more important)
      *
-     * @return true if there was an available channel for the sound
+     * @return true if the sound effect is active
      */
     bool playEffect(const std::string& key, const std::shared_ptr<Sound>& sound,
-                    bool loop=false, float volume=-1.0f, bool force=false);
+                    bool loop=false, float volume=-1.0f, bool force=false, Sint32 priority=0);
 
     /**
      * Plays the given sound effect, and associates it with the specified key.
@@ -589,443 +1039,940 @@ public:
      * is the responsibility of the application layer to manage key usage.
      *
      * There are a limited number of channels available for sound effects.  If
-     * you go over the number available, the sound will not play unless force
-     * is true. In that case, it will grab the channel from the longest playing
-     * sound effect.
+     * you go over the number available, the sound will take the channel of the
+     * lowest ranked sound effect, provided that this sound outranks it.  Sounds
+     * are ranked first by priority and then by audibility (volume times
+     * attenuation).  The displaced sound is not stopped.  It becomes a virtual
+     * effect that keeps track of its position, and will get a channel back
+     * once one is available.  If this sound does not outrank any playing
+     * sound, it starts as a virtual effect itself, unless force is true.  In
+     * that case, it will grab the channel from the lowest ranked sound effect.
      *
      * @param  key      The reference key for the sound effect
      * @param  sound    The sound effect to play
      * @param  loop     Whether to loop the sound effect continuously
      * @param  volume   The sound effect (< 0 to use asset default volume)
-     * @param  force    Whether to force another sound to stop.
+     * @param  force    Whether to force another sound off its channel.
+     * @param  priority The sound priority (higher values are more important)
      *
-     * @return true if there was an available channel for the sound
+     * @return true if the sound effect is active
      */
     bool playEffect(const char* key, const std::shared_ptr<Sound>& sound,
-                    bool loop=false, float volume=-1.0f, bool force=false) {
-        return playEffect(std::string(key),sound,loop,volume,force);
+                    bool loop=false, float volume=-1.0f, bool force=false, Sint32 priority=0) {
+        return playEffect(std::string(key),sound,loop,volume,force,priority);
     }
 
     /**
-     * Returns the number of channels available for sound effects.
+     * Plays the given sound effect, returning a handle to reference it.
+     *
+     * Unlike the keyed version of this method, the sound effect is anonymous.
+     * The returned handle is the only way to reference it.  Handles are cheaper
+     * than keys, as they do not require any string hashing or allocation.  They
+     * are also safe to use after the sound completes; the engine will ignore
+     * any handle that no longer refers to an active sound effect.
      *
      * There are a limited number of channels available for sound effects.  If
-     * all channels are in use, this method will return 0. If you go over the 
-     * number available, you cannot play another sound unless you force it. In 
-     * that case, it will grab the channel from the longest playing sound effect.
+     * you go over the number available, the sound will take the channel of the
+     * lowest ranked sound effect, provided that this sound outranks it.  Sounds
+     * are ranked first by priority and then by audibility (volume times
+     * attenuation).  The displaced sound is not stopped.  It becomes a virtual
+     * effect that keeps track of its position, and will get a channel back
+     * once one is available.  If this sound does not outrank any playing
+     * sound, it starts as a virtual effect itself, unless force is true.  In
+     * that case, it will grab the channel from the lowest ranked sound effect.
      *
-     * @return the number of channels available for sound effects.
+     * @param  sound    The sound effect to play
+     * @param  loop     Whether to loop the sound effect continuously
+     * @param  volume   The sound effect (< 0 to use asset default volume)
+     * @param  force    Whether to force another sound off its channel.
+     * @param  priority The sound priority (higher values are more important)
+     *
+     * @return the handle for the sound effect (0 if it failed to play)
      */
-    size_t getAvailableChannels() const {
-        return (size_t)_capacity-_effects.size();
-    }
-    
+    EffectHandle playEffect(const std::shared_ptr<Sound>& sound, bool loop=false,
+                            float volume=-1.0f, bool force=false, Sint32 priority=0);
+
     /**
-     * Returns the current state of the sound effect for the given key.
+     * Returns the handle for the sound effect with the given key.
      *
-     * If there is no sound effect for the given key, it returns
-     * State::INACTIVE.
+     * If there is no active sound effect for the key, this method returns 0.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return the current state of the sound effect for the given key.
+     * @return the handle for the sound effect with the given key.
      */
-    State getEffectState(const std::string& key) const;
+    EffectHandle getEffectHandle(const std::string& key) const {
+        return lookup(key);
+    }
 
     /**
-     * Returns the current state of the sound effect for the given key.
+     * Returns the handle for the sound effect with the given key.
      *
-     * If there is no sound effect for the given key, it returns
-     * State::INACTIVE.
+     * If there is no active sound effect for the key, this method returns 0.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return the current state of the sound effect for the given key.
+     * @return the handle for the sound effect with the given key.
      */
-    State getEffectState(const char* key) const {
-        return getEffectState(std::string(key));
+    EffectHandle getEffectHandle(const char* key) const {
+        return lookup(std::string(key));
     }
-    
+
     /**
-     * Returns true if the key is associated with an active channel.
+     * Returns the number of channels available for sound effects.
      *
-     * @param  key      the reference key for the sound effect
+     * There are a limited number of channels available for sound effects.  If
+     * all channels are in use, this method will return 0. If you go over the 
+     * number available, any further sounds will compete for the channels, with
+     * the losers becoming virtual effects.
      *
-     * @return true if the key is associated with an active channel.
+     * @return the number of channels available for sound effects.
      */
-    bool isActiveEffect(const std::string& key) const {
-        return _effects.find(key) != _effects.end();
+    size_t getAvailableChannels() const {
+        return (size_t)_capacity-_audible;
     }
-
+    
     /**
-     * Returns true if the key is associated with an active channel.
+     * Returns the number of active sound effects without a channel.
      *
-     * @param  key      the reference key for the sound effect
+     * Virtual effects are not audible, but they keep track of their
+     * playback position.  They will get a channel back as soon as one is
+     * available (or they outrank a sound with a channel).
      *
-     * @return true if the key is associated with an active channel.
+     * @return the number of active sound effects without a channel.
      */
-    bool isActiveEffect(const char* key) const {
-        return isActiveEffect(std::string(key));
+    size_t getVirtualEffects() const {
+        return _virtual;
     }
     
     /**
-     * Returns the sound asset attached to the given key.
+     * Returns true if the key is associated with a virtual effect.
      *
-     * If there is no active sound effect for the given key, this method
-     * returns nullptr.
+     * A virtual effect is active but does not have a channel.  It keeps
+     * track of its playback position so that it can resume when it gets
+     * a channel back.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return the sound asset attached to the given key.
+     * @return true if the key is associated with a virtual effect.
      */
-    const Sound* currentEffect(const std::string& key) const;
-
+    bool isVirtualEffect(const std::string& key) const {
+        return isVirtualEffect(lookup(key));
+    }
+    
     /**
-     * Returns the sound asset attached to the given key.
+     * Returns true if the key is associated with a virtual effect.
      *
-     * If there is no active sound effect for the given key, this method
-     * returns nullptr.
+     * A virtual effect is active but does not have a channel.  It keeps
+     * track of its playback position so that it can resume when it gets
+     * a channel back.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return the sound asset attached to the given key.
+     * @return true if the key is associated with a virtual effect.
      */
-    const Sound* currentEffect(const char* key) const {
-        return currentEffect(std::string(key));
+    bool isVirtualEffect(const char* key) const {
+        return isVirtualEffect(std::string(key));
     }
-
+    
     /**
-     * Returns true if the sound effect is in a continuous loop.
+     * Returns true if the handle is associated with a virtual effect.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * A virtual effect is active but does not have a channel.  It keeps
+     * track of its playback position so that it can resume when it gets
+     * a channel back.
      *
-     * @param  key      the reference key for the sound effect
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method returns false.
      *
-     * @return true if the sound effect is in a continuous loop.
+     * @param  handle   the handle for the sound effect
+     *
+     * @return true if the handle is associated with a virtual effect.
      */
-    bool isEffectLoop(const std::string& key) const;
-
+    bool isVirtualEffect(EffectHandle handle) const;
+    
     /**
-     * Returns true if the sound effect is in a continuous loop.
+     * Returns the priority of the given sound effect.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * Effects with higher priority always outrank effects with lower
+     * priority when competing for a channel.
+     *
+     * If the key does not correspond to an active effect, this method 
+     * raises an error.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return true if the sound effect is in a continuous loop.
+     * @return the priority of the given sound effect.
      */
-    bool isEffectLoop(const char* key) const {
-        return isEffectLoop(std::string(key));
-    }
+    Sint32 getEffectPriority(const std::string& key) const;
     
     /**
-     * Sets whether the sound effect is in a continuous loop.
+     * Returns the priority of the given sound effect.
      *
-     * If the key does not correspond to a channel, this method raises an error.
-     *
-     * @param  key      the reference key for the sound effect
-     * @param  loop     whether the sound effect is in a continuous loop
-     */
-    void setEffectLoop(const std::string& key, bool loop);
-
-    /**
-     * Sets whether the sound effect is in a continuous loop.
+     * Effects with higher priority always outrank effects with lower
+     * priority when competing for a channel.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If the key does not correspond to an active effect, this method 
+     * raises an error.
      *
      * @param  key      the reference key for the sound effect
-     * @param  loop     whether the sound effect is in a continuous loop
+     *
+     * @return the priority of the given sound effect.
      */
-    void setEffectLoop(const char* key, bool loop) {
-        setEffectLoop(std::string(key),loop);
+    Sint32 getEffectPriority(const char* key) const {
+        return getEffectPriority(std::string(key));
     }
     
     /**
-     * Returns the current volume of the sound effect.
+     * Returns the priority of the given sound effect.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * Effects with higher priority always outrank effects with lower
+     * priority when competing for a channel.
      *
-     * @param  key      the reference key for the sound effect
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method raises an error.
      *
-     * @return the current volume of the sound effect
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the priority of the given sound effect.
      */
-    float getEffectVolume(const std::string& key) const;
+    Sint32 getEffectPriority(EffectHandle handle) const;
     
     /**
-     * Returns the current volume of the sound effect.
+     * Sets the priority of the given sound effect.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * Effects with higher priority always outrank effects with lower
+     * priority when competing for a channel. The channels are reassigned
+     * at the next animation frame.
      *
-     * @param  key      the reference key for the sound effect
+     * If the key does not correspond to an active effect, this method 
+     * raises an error.
      *
-     * @return the current volume of the sound effect
+     * @param  key      the reference key for the sound effect
+     * @param  priority the sound priority
      */
-    float getEffectVolume(const char* key) const {
-        return getEffectVolume(std::string(key));
-    }
+    void setEffectPriority(const std::string& key, Sint32 priority);
     
     /**
-     * Sets the current volume of the sound effect.
+     * Sets the priority of the given sound effect.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * Effects with higher priority always outrank effects with lower
+     * priority when competing for a channel. The channels are reassigned
+     * at the next animation frame.
+     *
+     * If the key does not correspond to an active effect, this method 
+     * raises an error.
      *
      * @param  key      the reference key for the sound effect
-     * @param  volume   the current volume of the sound effect
+     * @param  priority the sound priority
      */
-    void setEffectVolume(const std::string& key, float volume);
-
+    void setEffectPriority(const char* key, Sint32 priority) {
+        setEffectPriority(std::string(key),priority);
+    }
+    
     /**
-     * Sets the current volume of the sound effect.
+     * Sets the priority of the given sound effect.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * Effects with higher priority always outrank effects with lower
+     * priority when competing for a channel. The channels are reassigned
+     * at the next animation frame.
      *
-     * @param  key      the reference key for the sound effect
-     * @param  volume   the current volume of the sound effect
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  priority the sound priority
      */
-    void setEffectVolume(const char* key, float volume) {
-        setEffectVolume(std::string(key),volume);
-    }
-
+    void setEffectPriority(EffectHandle handle, Sint32 priority);
+    
     /**
-     * Returns the duration of the sound effect, in seconds.
+     * Returns the attenuation of the given sound effect.
      *
-     * Because the asset is fully decompressed at load time, the result of this 
-     * method is reasonably accurate.
+     * The attenuation is a game-specific factor (such as distance from the
+     * listener) that is multiplied with the volume to determine how audible
+     * a sound is.  It does not change the volume of the sound, but it is
+     * used to rank sounds of equal priority.  The default is 1.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If the key does not correspond to an active effect, this method 
+     * raises an error.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return the duration of the sound effect, in seconds.
+     * @return the attenuation of the given sound effect.
      */
-    float getEffectDuration(const std::string& key) const;
-
+    float getEffectAttenuation(const std::string& key) const;
+    
     /**
-     * Returns the duration of the sound effect, in seconds.
+     * Returns the attenuation of the given sound effect.
      *
-     * Because the asset is fully decompressed at load time, the result of this
-     * method is reasonably accurate.
+     * The attenuation is a game-specific factor (such as distance from the
+     * listener) that is multiplied with the volume to determine how audible
+     * a sound is.  It does not change the volume of the sound, but it is
+     * used to rank sounds of equal priority.  The default is 1.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If the key does not correspond to an active effect, this method 
+     * raises an error.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return the duration of the sound effect, in seconds.
+     * @return the attenuation of the given sound effect.
      */
-    float getEffectDuration(const char* key) const {
-        return getEffectDuration(std::string(key));
+    float getEffectAttenuation(const char* key) const {
+        return getEffectAttenuation(std::string(key));
     }
     
     /**
-     * Returns the elapsed time of the sound effect, in seconds
+     * Returns the attenuation of the given sound effect.
      *
-     * The elapsed time is the current position of the sound from the beginning. 
-     * It does not include any time spent on a continuous loop. Because the 
-     * asset is fully decompressed at load time, the result of this method is 
-     * reasonably accurate.
+     * The attenuation is a game-specific factor (such as distance from the
+     * listener) that is multiplied with the volume to determine how audible
+     * a sound is.  The default is 1.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method raises an error.
      *
-     * @param  key      the reference key for the sound effect
+     * @param  handle   the handle for the sound effect
      *
-     * @return the elapsed time of the sound effect, in seconds
+     * @return the attenuation of the given sound effect.
      */
-    float getEffectElapsed(const std::string& key) const;
+    float getEffectAttenuation(EffectHandle handle) const;
     
     /**
-     * Returns the elapsed time of the sound effect, in seconds
+     * Sets the attenuation of the given sound effect.
      *
-     * The elapsed time is the current position of the sound from the beginning.
-     * It does not include any time spent on a continuous loop. Because the
-     * asset is fully decompressed at load time, the result of this method is
-     * reasonably accurate.
+     * The attenuation is a game-specific factor (such as distance from the
+     * listener) that is multiplied with the volume to determine how audible
+     * a sound is.  It does not change the volume of the sound, but it is
+     * used to rank sounds of equal priority.  The channels are reassigned
+     * at the next animation frame.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If the key does not correspond to an active effect, this method 
+     * raises an error.
      *
-     * @param  key      the reference key for the sound effect
+     * @param  key          the reference key for the sound effect
+     * @param  attenuation  the attenuation factor
+     */
+    void setEffectAttenuation(const std::string& key, float attenuation);
+    
+    /**
+     * Sets the attenuation of the given sound effect.
      *
-     * @return the elapsed time of the sound effect, in seconds
+     * The attenuation is a game-specific factor (such as distance from the
+     * listener) that is multiplied with the volume to determine how audible
+     * a sound is.  It does not change the volume of the sound, but it is
+     * used to rank sounds of equal priority.  The channels are reassigned
+     * at the next animation frame.
+     *
+     * If the key does not correspond to an active effect, this method 
+     * raises an error.
+     *
+     * @param  key          the reference key for the sound effect
+     * @param  attenuation  the attenuation factor
      */
-    float getEffectElapsed(const char* key) const {
-        return getEffectElapsed(std::string(key));
+    void setEffectAttenuation(const char* key, float attenuation) {
+        setEffectAttenuation(std::string(key),attenuation);
     }
     
     /**
-     * Returns the time remaining for the sound effect, in seconds
+     * Sets the attenuation of the given sound effect.
      *
-     * The time remaining is just duration-elapsed.  This method does not take 
-     * into account whether the sound is on a loop. Because the asset is fully
-     * decompressed at load time, the result of this method is reasonably 
-     * accurate.
+     * The attenuation is a game-specific factor (such as distance from the
+     * listener) that is multiplied with the volume to determine how audible
+     * a sound is.  The channels are reassigned at the next animation frame.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  attenuation  the attenuation factor
+     */
+    void setEffectAttenuation(EffectHandle handle, float attenuation);
+    
+    /**
+     * Returns the current state of the sound effect for the given key.
+     *
+     * If there is no sound effect for the given key, it returns
+     * State::INACTIVE.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return the time remaining for the sound effect, in seconds
+     * @return the current state of the sound effect for the given key.
      */
-    float getEffectRemaining(const std::string& key) const;
+    State getEffectState(const std::string& key) const;
 
     /**
-     * Returns the time remaining for the sound effect, in seconds
-     *
-     * The time remaining is just duration-elapsed.  This method does not take
-     * into account whether the sound is on a loop. Because the asset is fully
-     * decompressed at load time, the result of this method is reasonably
-     * accurate.
+     * Returns the current state of the sound effect for the given key.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If there is no sound effect for the given key, it returns
+     * State::INACTIVE.
      *
      * @param  key      the reference key for the sound effect
      *
-     * @return the time remaining for the sound effect
+     * @return the current state of the sound effect for the given key.
      */
-    float getEffectRemaining(const char* key) const {
-        return getEffectRemaining(std::string(key));
+    State getEffectState(const char* key) const {
+        return getEffectState(std::string(key));
     }
-
+    
     /**
-     * Sets the elapsed time of the sound effect, in seconds
+     * Returns the current state of the sound effect for the given handle.
      *
-     * The elapsed time is the current position of the sound from the beginning.  
-     * It does not include any time spent on a continuous loop.  Because the
-     * asset is fully decompressed at load time, the result of this method is
-     * reasonably accurate.
+     * If the handle is no longer valid (e.g. the sound has completed), it
+     * returns State::INACTIVE.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the current state of the sound effect for the given handle.
+     */
+    State getEffectState(EffectHandle handle) const;
+    
+    /**
+     * Returns true if the key is associated with an active sound effect.
+     *
+     * Virtual effects are considered active.
      *
      * @param  key      the reference key for the sound effect
-     * @param  time     the new position of the sound effect
+     *
+     * @return true if the key is associated with an active sound effect.
      */
-    void setEffectElapsed(const std::string& key, float time);
+    bool isActiveEffect(const std::string& key) const {
+        return _keys.find(key) != _keys.end();
+    }
 
     /**
-     * Sets the elapsed time of the sound effect, in seconds
-     *
-     * The elapsed time is the current position of the sound from the beginning.
-     * It does not include any time spent on a continuous loop.  Because the
-     * asset is fully decompressed at load time, the result of this method is
-     * reasonably accurate.
+     * Returns true if the key is associated with an active sound effect.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * Virtual effects are considered active.
      *
      * @param  key      the reference key for the sound effect
-     * @param  time     the new position of the sound effect
+     *
+     * @return true if the key is associated with an active channel.
      */
-    void setEffectElapsed(const char* key, float time) {
-        setEffectElapsed(std::string(key),time);
+    bool isActiveEffect(const char* key) const {
+        return isActiveEffect(std::string(key));
     }
     
     /**
-     * Sets the time remaining for the sound effect, in seconds
+     * Returns true if the handle is associated with an active sound effect.
      *
-     * The time remaining is just duration-elapsed.  This method does not take 
-     * into account whether the sound is on a loop. Because the asset is fully
-     * decompressed at load time, the result of this method is reasonably
-     * accurate.
+     * Virtual effects are considered active.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method returns false.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return true if the handle is associated with an active sound effect.
+     */
+    bool isActiveEffect(EffectHandle handle) const;
+    
+    /**
+     * Returns the sound asset attached to the given key.
+     *
+     * If there is no active sound effect for the given key, this method
+     * returns nullptr.
      *
      * @param  key      the reference key for the sound effect
-     * @param  time     the new time remaining for the sound effect
+     *
+     * @return the sound asset attached to the given key.
      */
-    void setEffectRemaining(const std::string& key, float time);
+    const Sound* currentEffect(const std::string& key) const;
 
     /**
-     * Sets the time remaining for the sound effect, in seconds
-     *
-     * The time remaining is just duration-elapsed.  This method does not take
-     * into account whether the sound is on a loop. Because the asset is fully
-     * decompressed at load time, the result of this method is reasonably
-     * accurate.
+     * Returns the sound asset attached to the given key.
      *
-     * If the key does not correspond to a channel, this method raises an error.
+     * If there is no active sound effect for the given key, this method
+     * returns nullptr.
      *
      * @param  key      the reference key for the sound effect
-     * @param  time     the new time remaining for the sound effect
+     *
+     * @return the sound asset attached to the given key.
      */
-    void setEffectRemaining(const char* key, float time) {
-        setEffectRemaining(std::string(key),time);
+    const Sound* currentEffect(const char* key) const {
+        return currentEffect(std::string(key));
     }
     
     /**
-     * Stops the sound effect for the given key, removing it.
+     * Returns the sound asset attached to the given handle.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method returns nullptr.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the sound asset attached to the given handle.
+     */
+    const Sound* currentEffect(EffectHandle handle) const;
+
+    /**
+     * Returns true if the sound effect is in a continuous loop.
      *
      * If the key does not correspond to a channel, this method raises an error.
-     * The effect will be removed from the audio engine entirely.  You will need
-     * to add it again if you wish to replay it.
      *
      * @param  key      the reference key for the sound effect
+     *
+     * @return true if the sound effect is in a continuous loop.
      */
-    void stopEffect(const std::string& key);
-    
+    bool isEffectLoop(const std::string& key) const;
+
     /**
-     * Stops the sound effect for the given key, removing it.
+     * Returns true if the sound effect is in a continuous loop.
      *
      * If the key does not correspond to a channel, this method raises an error.
-     * The effect will be removed from the audio engine entirely.  You will need
-     * to add it again if you wish to replay it.
      *
      * @param  key      the reference key for the sound effect
+     *
+     * @return true if the sound effect is in a continuous loop.
      */
-    void stopEffect(const char* key) {
-        stopEffect(std::string(key));
+    bool isEffectLoop(const char* key) const {
+        return isEffectLoop(std::string(key));
     }
     
     /**
-     * Pauses the sound effect for the given key.
+     * Returns true if the sound effect is in a continuous loop.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return true if the sound effect is in a continuous loop.
+     */
+    bool isEffectLoop(EffectHandle handle) const;
+    
+    /**
+     * Sets whether the sound effect is in a continuous loop.
      *
      * If the key does not correspond to a channel, this method raises an error.
      *
      * @param  key      the reference key for the sound effect
+     * @param  loop     whether the sound effect is in a continuous loop
      */
-    void pauseEffect(const std::string& key);
+    void setEffectLoop(const std::string& key, bool loop);
 
     /**
-     * Pauses the sound effect for the given key.
+     * Sets whether the sound effect is in a continuous loop.
      *
      * If the key does not correspond to a channel, this method raises an error.
      *
      * @param  key      the reference key for the sound effect
+     * @param  loop     whether the sound effect is in a continuous loop
      */
-    void pauseEffect(const char* key) {
-        pauseEffect(std::string(key));
+    void setEffectLoop(const char* key, bool loop) {
+        setEffectLoop(std::string(key),loop);
     }
-
+    
     /**
-     * Resumes the sound effect for the given key.
+     * Sets whether the sound effect is in a continuous loop.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  loop     whether the sound effect is in a continuous loop
+     */
+    void setEffectLoop(EffectHandle handle, bool loop);
+    
+    /**
+     * Returns the current volume of the sound effect.
      *
      * If the key does not correspond to a channel, this method raises an error.
      *
      * @param  key      the reference key for the sound effect
+     *
+     * @return the current volume of the sound effect
      */
-    void resumeEffect(std::string key);
-
+    float getEffectVolume(const std::string& key) const;
+    
     /**
-     * Resumes the sound effect for the given key.
+     * Returns the current volume of the sound effect.
      *
      * If the key does not correspond to a channel, this method raises an error.
      *
      * @param  key      the reference key for the sound effect
+     *
+     * @return the current volume of the sound effect
      */
-    void resumeEffect(const char* key) {
-        resumeEffect(std::string(key));
+    float getEffectVolume(const char* key) const {
+        return getEffectVolume(std::string(key));
     }
     
     /**
-     * Stops all sound effects, removing them from the engine.
+     * Returns the current volume of the sound effect.
      *
-     * You will need to add the effects again if you wish to replay them.
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the current volume of the sound effect.
      */
-    void stopAllEffects();
+    float getEffectVolume(EffectHandle handle) const;
     
     /**
-     * Pauses all sound effects, allowing them to be resumed later.
+     * Sets the current volume of the sound effect.
      *
-     * Sound effects already paused will remain paused.
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  volume   the current volume of the sound effect
      */
-    void pauseAllEffects();
-    
+    void setEffectVolume(const std::string& key, float volume);
+
+    /**
+     * Sets the current volume of the sound effect.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  volume   the current volume of the sound effect
+     */
+    void setEffectVolume(const char* key, float volume) {
+        setEffectVolume(std::string(key),volume);
+    }
+    
+    /**
+     * Sets the current volume of the sound effect.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  volume   the current volume of the sound effect
+     */
+    void setEffectVolume(EffectHandle handle, float volume);
+
+    /**
+     * Returns the duration of the sound effect, in seconds.
+     *
+     * Because the asset is fully decompressed at load time, the result of this 
+     * method is reasonably accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the duration of the sound effect, in seconds.
+     */
+    float getEffectDuration(const std::string& key) const;
+
+    /**
+     * Returns the duration of the sound effect, in seconds.
+     *
+     * Because the asset is fully decompressed at load time, the result of this
+     * method is reasonably accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the duration of the sound effect, in seconds.
+     */
+    float getEffectDuration(const char* key) const {
+        return getEffectDuration(std::string(key));
+    }
+    
+    /**
+     * Returns the duration of the sound effect, in seconds.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the duration of the sound effect, in seconds.
+     */
+    float getEffectDuration(EffectHandle handle) const;
+    
+    /**
+     * Returns the elapsed time of the sound effect, in seconds
+     *
+     * The elapsed time is the current position of the sound from the beginning. 
+     * It does not include any time spent on a continuous loop. Because the 
+     * asset is fully decompressed at load time, the result of this method is 
+     * reasonably accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the elapsed time of the sound effect, in seconds
+     */
+    float getEffectElapsed(const std::string& key) const;
+    
+    /**
+     * Returns the elapsed time of the sound effect, in seconds
+     *
+     * The elapsed time is the current position of the sound from the beginning.
+     * It does not include any time spent on a continuous loop. Because the
+     * asset is fully decompressed at load time, the result of this method is
+     * reasonably accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the elapsed time of the sound effect, in seconds
+     */
+    float getEffectElapsed(const char* key) const {
+        return getEffectElapsed(std::string(key));
+    }
+    
+    /**
+     * Returns the elapsed time of the sound effect, in seconds
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the elapsed time of the sound effect, in seconds
+     */
+    float getEffectElapsed(EffectHandle handle) const;
+    
+    /**
+     * Returns the time remaining for the sound effect, in seconds
+     *
+     * The time remaining is just duration-elapsed.  This method does not take 
+     * into account whether the sound is on a loop. Because the asset is fully
+     * decompressed at load time, the result of this method is reasonably 
+     * accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the time remaining for the sound effect, in seconds
+     */
+    float getEffectRemaining(const std::string& key) const;
+
+    /**
+     * Returns the time remaining for the sound effect, in seconds
+     *
+     * The time remaining is just duration-elapsed.  This method does not take
+     * into account whether the sound is on a loop. Because the asset is fully
+     * decompressed at load time, the result of this method is reasonably
+     * accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the time remaining for the sound effect
+     */
+    float getEffectRemaining(const char* key) const {
+        return getEffectRemaining(std::string(key));
+    }
+    
+    /**
+     * Returns the time remaining for the sound effect, in seconds
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the time remaining for the sound effect, in seconds
+     */
+    float getEffectRemaining(EffectHandle handle) const;
+
+    /**
+     * Sets the elapsed time of the sound effect, in seconds
+     *
+     * The elapsed time is the current position of the sound from the beginning.  
+     * It does not include any time spent on a continuous loop.  Because the
+     * asset is fully decompressed at load time, the result of this method is
+     * reasonably accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  time     the new position of the sound effect
+     */
+    void setEffectElapsed(const std::string& key, float time);
+
+    /**
+     * Sets the elapsed time of the sound effect, in seconds
+     *
+     * The elapsed time is the current position of the sound from the beginning.
+     * It does not include any time spent on a continuous loop.  Because the
+     * asset is fully decompressed at load time, the result of this method is
+     * reasonably accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  time     the new position of the sound effect
+     */
+    void setEffectElapsed(const char* key, float time) {
+        setEffectElapsed(std::string(key),time);
+    }
+    
+    /**
+     * Sets the elapsed time of the sound effect, in seconds
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  time     the new position of the sound effect
+     */
+    void setEffectElapsed(EffectHandle handle, float time);
+    
+    /**
+     * Sets the time remaining for the sound effect, in seconds
+     *
+     * The time remaining is just duration-elapsed.  This method does not take 
+     * into account whether the sound is on a loop. Because the asset is fully
+     * decompressed at load time, the result of this method is reasonably
+     * accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  time     the new time remaining for the sound effect
+     */
+    void setEffectRemaining(const std::string& key, float time);
+
+    /**
+     * Sets the time remaining for the sound effect, in seconds
+     *
+     * The time remaining is just duration-elapsed.  This method does not take
+     * into account whether the sound is on a loop. Because the asset is fully
+     * decompressed at load time, the result of this method is reasonably
+     * accurate.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  time     the new time remaining for the sound effect
+     */
+    void setEffectRemaining(const char* key, float time) {
+        setEffectRemaining(std::string(key),time);
+    }
+    
+    /**
+     * Sets the time remaining for the sound effect, in seconds
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  time     the new time remaining for the sound effect
+     */
+    void setEffectRemaining(EffectHandle handle, float time);
+    
+    /**
+     * Stops the sound effect for the given key, removing it.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     * The effect will be removed from the audio engine entirely.  You will need
+     * to add it again if you wish to replay it.
+     *
+     * @param  key      the reference key for the sound effect
+     */
+    void stopEffect(const std::string& key);
+    
+    /**
+     * Stops the sound effect for the given key, removing it.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     * The effect will be removed from the audio engine entirely.  You will need
+     * to add it again if you wish to replay it.
+     *
+     * @param  key      the reference key for the sound effect
+     */
+    void stopEffect(const char* key) {
+        stopEffect(std::string(key));
+    }
+    
+    /**
+     * Stops the sound effect for the given handle, removing it.
+     *
+     * The effect will be removed from the audio engine entirely. You will need
+     * to add it again if you wish to replay it.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     */
+    void stopEffect(EffectHandle handle);
+    
+    /**
+     * Pauses the sound effect for the given key.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     */
+    void pauseEffect(const std::string& key);
+
+    /**
+     * Pauses the sound effect for the given key.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     */
+    void pauseEffect(const char* key) {
+        pauseEffect(std::string(key));
+    }
+    
+    /**
+     * Pauses the sound effect for the given handle.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     */
+    void pauseEffect(EffectHandle handle);
+
+    /**
+     * Resumes the sound effect for the given key.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     */
+    void resumeEffect(std::string key);
+
+    /**
+     * Resumes the sound effect for the given key.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     */
+    void resumeEffect(const char* key) {
+        resumeEffect(std::string(key));
+    }
+    
+    /**
+     * Resumes the sound effect for the given handle.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     */
+    void resumeEffect(EffectHandle handle);
+    
+    /**
+     * Stops all sound effects, removing them from the engine.
+     *
+     * You will need to add the effects again if you wish to replay them.
+     */
+    void stopAllEffects();
+    
+    /**
+     * Pauses all sound effects, allowing them to be resumed later.
+     *
+     * Sound effects already paused will remain paused.
+     */
+    void pauseAllEffects();
+    
     /**
      * Resumes all paused sound effects.
      */
@@ -1059,6 +2006,40 @@ public:
         return _soundCB;
     }
 
+    /**
+     * Sets the callback for sound effects (by handle)
+     *
+     * This callback function is called whenever a sound effect completes. It
+     * is called whether or not the sound completed normally or if it was
+     * terminated manually.  However, the second parameter can be used to
+     * distinguish the two cases.
+     *
+     * Unlike {@link setEffectListener}, this callback is invoked for all
+     * sound effects, including anonymous ones.
+     *
+     * @param callback  The callback for sound effects
+     */
+    void setHandleListener(std::function<void(EffectHandle handle,bool)> callback) {
+        _handleCB = callback;
+    }
+
+    /**
+     * Returns the callback for sound effects (by handle)
+     *
+     * This callback function is called whenever a sound effect completes. It
+     * is called whether or not the sound completed normally or if it was
+     * terminated manually.  However, the second parameter can be used to
+     * distinguish the two cases.
+     *
+     * Unlike {@link getEffectListener}, this callback is invoked for all
+     * sound effects, including anonymous ones.
+     *
+     * @return the callback for sound effects
+     */
+    std::function<void(EffectHandle handle,bool)> getHandleListener() const {
+        return _handleCB;
+    }
+
     /**
      * Callback function for when a sound effect channel finishes
      *
@@ -1074,6 +2055,473 @@ public:
     void gcEffect(int id, bool status);
     
     
+#pragma mark -
+#pragma mark Positional Audio
+    /**
+     * Sets the position and velocity of the listener.
+     *
+     * Positional sound effects are attenuated by their distance to the
+     * listener, and are panned by their horizontal offset from it.  The
+     * gains of all positional effects are recomputed by the mixer once per
+     * audio block, so there is no need to update the effects when only the
+     * listener moves.
+     *
+     * The velocity is only used for doppler.  It should be in the same units
+     * per second as the speed of sound.
+     *
+     * @param position  The listener position
+     * @param velocity  The listener velocity
+     */
+    void setListener(const Vec2& position, const Vec2& velocity=Vec2::ZERO);
+    
+    /**
+     * Returns the position of the listener.
+     *
+     * @return the position of the listener.
+     */
+    const Vec2& getListenerPosition() const { return _listenerPos; }
+    
+    /**
+     * Returns the velocity of the listener.
+     *
+     * @return the velocity of the listener.
+     */
+    const Vec2& getListenerVelocity() const { return _listenerVel; }
+    
+    /**
+     * Sets the distance attenuation model for positional effects.
+     *
+     * The default model is {@link DistanceModel#INVERSE}.
+     *
+     * @param model The distance attenuation model
+     */
+    void setDistanceModel(DistanceModel model);
+    
+    /**
+     * Returns the distance attenuation model for positional effects.
+     *
+     * The default model is {@link DistanceModel#INVERSE}.
+     *
+     * @return the distance attenuation model for positional effects.
+     */
+    DistanceModel getDistanceModel() const { return _model; }
+    
+    /**
+     * Sets the doppler parameters for positional effects.
+     *
+     * Doppler shifts the pitch of an effect according to the velocities of
+     * the effect and the listener.  A factor of 0 (the default) disables
+     * doppler; larger values exaggerate the effect.  The speed of sound
+     * should be in the same units as the velocities.  The pitch shift is
+     * clamped to one octave in either direction.
+     *
+     * Doppler is not applied to streamed sounds, or on platforms that do not
+     * support it (such as AVFoundation).
+     *
+     * @param factor    The doppler factor
+     * @param speed     The speed of sound
+     */
+    void setDoppler(float factor, float speed=343.3f);
+    
+    /**
+     * Returns the doppler factor (0 if doppler is disabled).
+     *
+     * @return the doppler factor (0 if doppler is disabled).
+     */
+    float getDopplerFactor() const { return _doppler; }
+    
+    /**
+     * Returns the speed of sound for doppler.
+     *
+     * @return the speed of sound for doppler.
+     */
+    float getSpeedOfSound() const { return _speed; }
+    
+    /**
+     * Sets the position and velocity of the given sound effect.
+     *
+     * This makes the effect positional.  Its gain is attenuated by its
+     * distance to the listener, and it is panned (with equal power) by its
+     * horizontal offset from the listener.  This gain is multiplied with the
+     * volume of the effect.  Positional effects also rank by this gain when
+     * competing for a channel.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  position the effect position
+     * @param  velocity the effect velocity (for doppler)
+     */
+    void setEffectPosition(const std::string& key, const Vec2& position, const Vec2& velocity=Vec2::ZERO);
+    
+    /**
+     * Sets the position and velocity of the given sound effect.
+     *
+     * This makes the effect positional.  Its gain is attenuated by its
+     * distance to the listener, and it is panned (with equal power) by its
+     * horizontal offset from the listener.  This gain is multiplied with the
+     * volume of the effect.  Positional effects also rank by this gain when
+     * competing for a channel.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  position the effect position
+     * @param  velocity the effect velocity (for doppler)
+     */
+    void setEffectPosition(const char* key, const Vec2& position, const Vec2& velocity=Vec2::ZERO) {
+        setEffectPosition(std::string(key),position,velocity);
+    }
+    
+    /**
+     * Sets the position and velocity of the given sound effect.
+     *
+     * This makes the effect positional.  Its gain is attenuated by its
+     * distance to the listener, and it is panned (with equal power) by its
+     * horizontal offset from the listener.  This gain is multiplied with the
+     * volume of the effect.  Positional effects also rank by this gain when
+     * competing for a channel.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  position the effect position
+     * @param  velocity the effect velocity (for doppler)
+     */
+    void setEffectPosition(EffectHandle handle, const Vec2& position, const Vec2& velocity=Vec2::ZERO);
+    
+    /**
+     * Returns the position of the given sound effect.
+     *
+     * If the effect is not positional, this returns the origin.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the position of the given sound effect.
+     */
+    Vec2 getEffectPosition(const std::string& key) const;
+    
+    /**
+     * Returns the position of the given sound effect.
+     *
+     * If the effect is not positional, this returns the origin.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the position of the given sound effect.
+     */
+    Vec2 getEffectPosition(const char* key) const {
+        return getEffectPosition(std::string(key));
+    }
+    
+    /**
+     * Returns the position of the given sound effect.
+     *
+     * If the effect is not positional, this returns the origin.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the position of the given sound effect.
+     */
+    Vec2 getEffectPosition(EffectHandle handle) const;
+    
+    /**
+     * Returns true if the given sound effect is positional.
+     *
+     * An effect becomes positional once it is given a position.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return true if the given sound effect is positional.
+     */
+    bool isEffectPositional(const std::string& key) const;
+    
+    /**
+     * Returns true if the given sound effect is positional.
+     *
+     * An effect becomes positional once it is given a position.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return true if the given sound effect is positional.
+     */
+    bool isEffectPositional(const char* key) const {
+        return isEffectPositional(std::string(key));
+    }
+    
+    /**
+     * Returns true if the given sound effect is positional.
+     *
+     * An effect becomes positional once it is given a position.  If the
+     * handle is no longer valid (e.g. the sound has completed), this method
+     * returns false.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return true if the given sound effect is positional.
+     */
+    bool isEffectPositional(EffectHandle handle) const;
+    
+    /**
+     * Sets the attenuation range of the given sound effect.
+     *
+     * The reference distance is the distance at which the effect is heard
+     * at full volume.  The maximum distance is the distance beyond which
+     * the effect is attenuated no further.  The rolloff scales the rate of
+     * attenuation in between.  The defaults are 1, infinity, and 1.  This
+     * range only matters once the effect is positional.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key          the reference key for the sound effect
+     * @param  reference    the reference distance (must be positive)
+     * @param  maximum      the maximum distance
+     * @param  rolloff      the rolloff factor
+     */
+    void setEffectRange(const std::string& key, float reference, float maximum, float rolloff=1.0f);
+    
+    /**
+     * Sets the attenuation range of the given sound effect.
+     *
+     * The reference distance is the distance at which the effect is heard
+     * at full volume.  The maximum distance is the distance beyond which
+     * the effect is attenuated no further.  The rolloff scales the rate of
+     * attenuation in between.  The defaults are 1, infinity, and 1.  This
+     * range only matters once the effect is positional.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key          the reference key for the sound effect
+     * @param  reference    the reference distance (must be positive)
+     * @param  maximum      the maximum distance
+     * @param  rolloff      the rolloff factor
+     */
+    void setEffectRange(const char* key, float reference, float maximum, float rolloff=1.0f) {
+        setEffectRange(std::string(key),reference,maximum,rolloff);
+    }
+    
+    /**
+     * Sets the attenuation range of the given sound effect.
+     *
+     * The reference distance is the distance at which the effect is heard
+     * at full volume.  The maximum distance is the distance beyond which
+     * the effect is attenuated no further.  The rolloff scales the rate of
+     * attenuation in between.  The defaults are 1, infinity, and 1.  This
+     * range only matters once the effect is positional.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle       the handle for the sound effect
+     * @param  reference    the reference distance (must be positive)
+     * @param  maximum      the maximum distance
+     * @param  rolloff      the rolloff factor
+     */
+    void setEffectRange(EffectHandle handle, float reference, float maximum, float rolloff=1.0f);
+    
+    
+#pragma mark -
+#pragma mark Audio Buses
+    /**
+     * Returns the number of buses in this engine.
+     *
+     * Every engine starts with four buses: master, music, sound, and voice.
+     * The master bus is the root of the bus tree, and the other three are
+     * its children.
+     *
+     * @return the number of buses in this engine.
+     */
+    Uint32 getBusCount() const;
+    
+    /**
+     * Returns the bus with the given index.
+     *
+     * The indices of the standard buses are the constants of {@link AudioBus}.
+     * If there is no such bus, this method returns nullptr.
+     *
+     * @param index     the bus index
+     *
+     * @return the bus with the given index.
+     */
+    std::shared_ptr<AudioBus> getBus(Uint32 index) const;
+    
+    /**
+     * Returns the bus with the given name.
+     *
+     * If there is no such bus, this method returns nullptr.
+     *
+     * @param name      the bus name
+     *
+     * @return the bus with the given name.
+     */
+    std::shared_ptr<AudioBus> getBus(const std::string& name) const;
+    
+    /**
+     * Returns the master bus.
+     *
+     * All other buses mix into this one, so its gain and effects apply to
+     * all audio.
+     *
+     * @return the master bus.
+     */
+    std::shared_ptr<AudioBus> getMasterBus() const { return getBus(AudioBus::MASTER); }
+    
+    /**
+     * Returns the music bus.
+     *
+     * Background music is routed to this bus on platforms that support it.
+     *
+     * @return the music bus.
+     */
+    std::shared_ptr<AudioBus> getMusicBus() const { return getBus(AudioBus::MUSIC); }
+    
+    /**
+     * Returns the sound bus.
+     *
+     * Sound effects are routed to this bus by default.
+     *
+     * @return the sound bus.
+     */
+    std::shared_ptr<AudioBus> getSoundBus() const { return getBus(AudioBus::SOUND); }
+    
+    /**
+     * Returns the voice bus.
+     *
+     * This bus is intended for dialogue, and is a natural key for ducking
+     * the other buses.
+     *
+     * @return the voice bus.
+     */
+    std::shared_ptr<AudioBus> getVoiceBus() const { return getBus(AudioBus::VOICE); }
+    
+    /**
+     * Returns a newly created bus that mixes into the given parent.
+     *
+     * If the parent is nullptr, the new bus mixes into the master bus.  Buses
+     * can never be removed, so they should be created at initialization.
+     *
+     * @param name      the bus name
+     * @param parent    the parent bus
+     *
+     * @return a newly created bus that mixes into the given parent.
+     */
+    std::shared_ptr<AudioBus> addBus(const std::string& name, const std::shared_ptr<AudioBus>& parent=nullptr);
+    
+    /**
+     * Returns the bus for the given sound effect.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the bus for the given sound effect.
+     */
+    std::shared_ptr<AudioBus> getEffectBus(const std::string& key) const;
+    
+    /**
+     * Returns the bus for the given sound effect.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the bus for the given sound effect.
+     */
+    std::shared_ptr<AudioBus> getEffectBus(const char* key) const {
+        return getEffectBus(std::string(key));
+    }
+    
+    /**
+     * Returns the bus for the given sound effect.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method returns nullptr.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the bus for the given sound effect.
+     */
+    std::shared_ptr<AudioBus> getEffectBus(EffectHandle handle) const;
+    
+    /**
+     * Routes the given sound effect to a bus.
+     *
+     * Sound effects are routed to the sound bus by default.  The change is
+     * immediate, even if the effect is playing.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  bus      the bus for the sound effect
+     */
+    void setEffectBus(const std::string& key, const std::shared_ptr<AudioBus>& bus);
+    
+    /**
+     * Routes the given sound effect to a bus.
+     *
+     * Sound effects are routed to the sound bus by default.  The change is
+     * immediate, even if the effect is playing.
+     *
+     * If the key does not correspond to an active effect, this method
+     * raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  bus      the bus for the sound effect
+     */
+    void setEffectBus(const char* key, const std::shared_ptr<AudioBus>& bus) {
+        setEffectBus(std::string(key),bus);
+    }
+    
+    /**
+     * Routes the given sound effect to a bus.
+     *
+     * Sound effects are routed to the sound bus by default.  The change is
+     * immediate, even if the effect is playing.
+     *
+     * If the handle is no longer valid (e.g. the sound has completed), this
+     * method does nothing.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  bus      the bus for the sound effect
+     */
+    void setEffectBus(EffectHandle handle, const std::shared_ptr<AudioBus>& bus);
+    
+    /**
+     * Returns a report of the CPU cost of the bus graph.
+     *
+     * The report lists every bus, together with the average cost of each
+     * of its nodes (in microseconds per block) and their load (as a
+     * percentage of a single core).  This is intended for tuning effect
+     * chains during development.
+     *
+     * @return a report of the CPU cost of the bus graph.
+     */
+    std::string getProfile() const;
+    
+    
 #pragma mark -
 #pragma mark Global Management
     /**
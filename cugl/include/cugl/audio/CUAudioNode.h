@@ -0,0 +1,919 @@
+//
+//  CUAudioNode.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the DSP nodes that may be inserted into an audio bus.
+//  A node processes a block of interleaved stereo audio in place.  Blocks are
+//  never larger than the mixer block size, so nodes can size their scratch
+//  memory at initialization and never allocate on the audio thread.
+//
+//  We provide four types of nodes: biquad filters, a compressor (which is
+//  also a limiter), a simple reverb, and a sidechain ducker.  Every node
+//  keeps track of how much time it spends processing, so that the CPU cost
+//  of an effect graph can be reported at runtime.
+//
+//  Node parameters may be changed from the main thread at any time.  They
+//  are stored atomically, and picked up by the audio thread at the start of
+//  the next block.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_AUDIO_NODE_H__
+#define __CU_AUDIO_NODE_H__
+#include <cugl/base/CUBase.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace cugl {
+
+/** Forward reference to an audio bus (for sidechains) */
+class AudioBus;
+
+#pragma mark -
+#pragma mark Audio Node
+/**
+ * This class is the base class for a DSP effect in an audio bus.
+ *
+ * A node processes a block of interleaved stereo audio in place.  Subclasses
+ * implement {@link process}, which is only ever called on the audio thread.
+ * The public method {@link render} wraps that call with bypass support and
+ * profiling.  The cost of a node is the average time spent in each block,
+ * while the load is the ratio of processing time to the duration of the
+ * audio processed.  A load of 0.01 means the node uses 1% of one core.
+ *
+ * Nodes should not be shared between buses, as they have internal state.
+ */
+class AudioNode {
+private:
+    /** This macro disables the copy constructor (not allowed on nodes) */
+    CU_DISALLOW_COPY_AND_ASSIGN(AudioNode);
+
+protected:
+    /** The name of this node (for profiling) */
+    std::string _name;
+    /** The sample rate of this node */
+    Uint32 _rate;
+    /** Whether this node is bypassed */
+    std::atomic<bool> _bypass;
+    /** The total processing time in nanoseconds */
+    std::atomic<Uint64> _nanos;
+    /** The total number of frames processed */
+    std::atomic<Uint64> _frames;
+    /** The total number of blocks processed */
+    std::atomic<Uint64> _blocks;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate node with no sample rate.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioNode();
+
+    /**
+     * Deletes this node, disposing all resources.
+     */
+    virtual ~AudioNode() { }
+
+    /**
+     * Disposes any resources allocated for this node.
+     *
+     * The node must not be attached to a bus when this is called.
+     */
+    virtual void dispose();
+
+    /**
+     * Initializes a node with the given name and sample rate.
+     *
+     * @param name  The node name
+     * @param rate  The sample rate in HZ
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(const std::string& name, Uint32 rate);
+
+#pragma mark Attributes
+    /**
+     * Returns the name of this node.
+     *
+     * @return the name of this node.
+     */
+    const std::string& getName() const { return _name; }
+
+    /**
+     * Sets the name of this node.
+     *
+     * This should only be set before the node is attached to a bus.
+     *
+     * @param name  The node name
+     */
+    void setName(const std::string& name) { _name = name; }
+
+    /**
+     * Returns the sample rate of this node.
+     *
+     * @return the sample rate of this node.
+     */
+    Uint32 getRate() const { return _rate; }
+
+    /**
+     * Returns true if this node is bypassed.
+     *
+     * A bypassed node passes its input through unchanged.
+     *
+     * @return true if this node is bypassed.
+     */
+    bool isBypassed() const { return _bypass.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets whether this node is bypassed.
+     *
+     * A bypassed node passes its input through unchanged.
+     *
+     * @param bypass    Whether this node is bypassed
+     */
+    void setBypass(bool bypass) { _bypass.store(bypass,std::memory_order_relaxed); }
+
+#pragma mark Profiling
+    /**
+     * Returns the average processing time per block in microseconds.
+     *
+     * @return the average processing time per block in microseconds.
+     */
+    double getCost() const;
+
+    /**
+     * Returns the ratio of processing time to audio time.
+     *
+     * This is the fraction of a single core this node would use in real
+     * time.
+     *
+     * @return the ratio of processing time to audio time.
+     */
+    double getLoad() const;
+
+    /**
+     * Returns the number of blocks processed since the last reset.
+     *
+     * @return the number of blocks processed since the last reset.
+     */
+    Uint64 getBlocks() const { return _blocks.load(std::memory_order_relaxed); }
+
+    /**
+     * Resets the profiling statistics of this node.
+     */
+    void resetCost();
+
+#pragma mark Processing
+    /**
+     * Processes a block of audio in place, recording the time spent.
+     *
+     * This method should only be called on the audio thread.  If the node
+     * is bypassed, the block is unchanged.
+     *
+     * @param buffer    The audio block (interleaved stereo)
+     * @param frames    The number of frames in the block
+     */
+    void render(float* buffer, Uint32 frames);
+
+    /**
+     * Processes a block of audio in place.
+     *
+     * This method should only be called on the audio thread.
+     *
+     * @param buffer    The audio block (interleaved stereo)
+     * @param frames    The number of frames in the block
+     */
+    virtual void process(float* buffer, Uint32 frames) = 0;
+
+    /**
+     * Clears the internal state (e.g. delay lines) of this node.
+     *
+     * This method should only be called when the node is not attached.
+     */
+    virtual void reset() { }
+};
+
+
+#pragma mark -
+#pragma mark Biquad Filter
+/**
+ * This class is a second order IIR filter.
+ *
+ * The coefficients follow the well-known cookbook of Robert Bristow-Johnson.
+ * The two channels are filtered together, one channel per vector lane, as
+ * the recursion prevents vectorizing across time.
+ */
+class BiquadNode : public AudioNode {
+public:
+    /** The filter shapes */
+    enum class Type : int {
+        /** Passes frequencies below the cutoff */
+        LOWPASS,
+        /** Passes frequencies above the cutoff */
+        HIGHPASS,
+        /** Passes frequencies near the center */
+        BANDPASS,
+        /** Rejects frequencies near the center */
+        NOTCH,
+        /** Boosts or cuts frequencies near the center */
+        PEAK,
+        /** Boosts or cuts frequencies below the cutoff */
+        LOWSHELF,
+        /** Boosts or cuts frequencies above the cutoff */
+        HIGHSHELF
+    };
+
+private:
+    /** The filter shape */
+    std::atomic<Type> _type;
+    /** The cutoff or center frequency in HZ */
+    std::atomic<float> _frequency;
+    /** The filter quality */
+    std::atomic<float> _quality;
+    /** The gain in decibels (PEAK and shelf filters only) */
+    std::atomic<float> _gain;
+    /** Whether the coefficients must be recomputed */
+    std::atomic<bool> _dirty;
+    /** The normalized coefficients b0, b1, b2, a1, a2 (audio thread only) */
+    float _coeff[5];
+    /** The filter state z1 and z2 for each channel (audio thread only) */
+    float _state[4];
+
+    /**
+     * Recomputes the filter coefficients from the parameters.
+     */
+    void update();
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate filter.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    BiquadNode();
+
+    /**
+     * Initializes a filter with the given parameters.
+     *
+     * @param rate      The sample rate in HZ
+     * @param type      The filter shape
+     * @param frequency The cutoff or center frequency in HZ
+     * @param quality   The filter quality (0.7071 is maximally flat)
+     * @param gain      The gain in decibels (PEAK and shelf filters only)
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 rate, Type type, float frequency, float quality=0.70710678f, float gain=0.0f);
+
+    /**
+     * Returns a newly allocated filter with the given parameters.
+     *
+     * @param rate      The sample rate in HZ
+     * @param type      The filter shape
+     * @param frequency The cutoff or center frequency in HZ
+     * @param quality   The filter quality (0.7071 is maximally flat)
+     * @param gain      The gain in decibels (PEAK and shelf filters only)
+     *
+     * @return a newly allocated filter with the given parameters.
+     */
+    static std::shared_ptr<BiquadNode> alloc(Uint32 rate, Type type, float frequency,
+                                             float quality=0.70710678f, float gain=0.0f) {
+        std::shared_ptr<BiquadNode> result = std::make_shared<BiquadNode>();
+        return (result->init(rate,type,frequency,quality,gain) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the filter shape.
+     *
+     * @return the filter shape.
+     */
+    Type getType() const { return _type.load(); }
+
+    /**
+     * Sets the filter shape.
+     *
+     * @param type  The filter shape
+     */
+    void setType(Type type);
+
+    /**
+     * Returns the cutoff or center frequency in HZ.
+     *
+     * @return the cutoff or center frequency in HZ.
+     */
+    float getFrequency() const { return _frequency.load(); }
+
+    /**
+     * Sets the cutoff or center frequency in HZ.
+     *
+     * The frequency is clamped below the Nyquist limit.
+     *
+     * @param frequency The cutoff or center frequency in HZ
+     */
+    void setFrequency(float frequency);
+
+    /**
+     * Returns the filter quality.
+     *
+     * @return the filter quality.
+     */
+    float getQuality() const { return _quality.load(); }
+
+    /**
+     * Sets the filter quality.
+     *
+     * A quality of 0.7071 is maximally flat.  Larger values produce a
+     * resonant peak at the cutoff.
+     *
+     * @param quality   The filter quality
+     */
+    void setQuality(float quality);
+
+    /**
+     * Returns the gain in decibels.
+     *
+     * This is only used by PEAK and shelf filters.
+     *
+     * @return the gain in decibels.
+     */
+    float getGain() const { return _gain.load(); }
+
+    /**
+     * Sets the gain in decibels.
+     *
+     * This is only used by PEAK and shelf filters.
+     *
+     * @param gain  The gain in decibels
+     */
+    void setGain(float gain);
+
+#pragma mark Processing
+    /**
+     * Filters a block of audio in place.
+     *
+     * @param buffer    The audio block (interleaved stereo)
+     * @param frames    The number of frames in the block
+     */
+    virtual void process(float* buffer, Uint32 frames) override;
+
+    /**
+     * Clears the filter state.
+     */
+    virtual void reset() override;
+};
+
+
+#pragma mark -
+#pragma mark Compressor
+/**
+ * This class is a feed-forward peak compressor.
+ *
+ * The envelope and gain are computed on short segments of the block, and the
+ * gain is ramped across each segment.  Signals above the threshold are
+ * reduced according to the ratio.  A compressor with an infinite ratio and
+ * no attack is a limiter; when the attack is 0, gain reductions apply at the
+ * start of the segment, so the output never exceeds the ceiling.
+ */
+class CompressorNode : public AudioNode {
+private:
+    /** The threshold in decibels */
+    std::atomic<float> _threshold;
+    /** The compression ratio (infinite for a limiter) */
+    std::atomic<float> _ratio;
+    /** The attack time in seconds */
+    std::atomic<float> _attack;
+    /** The release time in seconds */
+    std::atomic<float> _release;
+    /** The makeup gain in decibels */
+    std::atomic<float> _makeup;
+    /** The most recent gain reduction in decibels (for metering) */
+    std::atomic<float> _reduction;
+    /** The envelope of the signal (audio thread only) */
+    float _envelope;
+    /** The current gain (audio thread only) */
+    float _current;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate compressor.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    CompressorNode();
+
+    /**
+     * Initializes a compressor with the given parameters.
+     *
+     * @param rate      The sample rate in HZ
+     * @param threshold The threshold in decibels
+     * @param ratio     The compression ratio
+     * @param attack    The attack time in seconds
+     * @param release   The release time in seconds
+     * @param makeup    The makeup gain in decibels
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 rate, float threshold=-12.0f, float ratio=4.0f,
+              float attack=0.01f, float release=0.1f, float makeup=0.0f);
+
+    /**
+     * Returns a newly allocated compressor with the given parameters.
+     *
+     * @param rate      The sample rate in HZ
+     * @param threshold The threshold in decibels
+     * @param ratio     The compression ratio
+     * @param attack    The attack time in seconds
+     * @param release   The release time in seconds
+     * @param makeup    The makeup gain in decibels
+     *
+     * @return a newly allocated compressor with the given parameters.
+     */
+    static std::shared_ptr<CompressorNode> alloc(Uint32 rate, float threshold=-12.0f, float ratio=4.0f,
+                                                 float attack=0.01f, float release=0.1f, float makeup=0.0f) {
+        std::shared_ptr<CompressorNode> result = std::make_shared<CompressorNode>();
+        return (result->init(rate,threshold,ratio,attack,release,makeup) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated limiter with the given ceiling.
+     *
+     * A limiter is a compressor with an infinite ratio and no attack.
+     *
+     * @param rate      The sample rate in HZ
+     * @param ceiling   The output ceiling in decibels
+     * @param release   The release time in seconds
+     *
+     * @return a newly allocated limiter with the given ceiling.
+     */
+    static std::shared_ptr<CompressorNode> allocLimiter(Uint32 rate, float ceiling=-1.0f, float release=0.05f);
+
+#pragma mark Attributes
+    /**
+     * Returns the threshold in decibels.
+     *
+     * @return the threshold in decibels.
+     */
+    float getThreshold() const { return _threshold.load(); }
+
+    /**
+     * Sets the threshold in decibels.
+     *
+     * @param threshold The threshold in decibels
+     */
+    void setThreshold(float threshold) { _threshold.store(threshold); }
+
+    /**
+     * Returns the compression ratio.
+     *
+     * @return the compression ratio.
+     */
+    float getRatio() const { return _ratio.load(); }
+
+    /**
+     * Sets the compression ratio.
+     *
+     * The ratio must be at least 1.  Use INFINITY for a limiter.
+     *
+     * @param ratio The compression ratio
+     */
+    void setRatio(float ratio) { _ratio.store(ratio < 1 ? 1 : ratio); }
+
+    /**
+     * Returns the attack time in seconds.
+     *
+     * @return the attack time in seconds.
+     */
+    float getAttack() const { return _attack.load(); }
+
+    /**
+     * Sets the attack time in seconds.
+     *
+     * @param attack    The attack time in seconds
+     */
+    void setAttack(float attack) { _attack.store(attack < 0 ? 0 : attack); }
+
+    /**
+     * Returns the release time in seconds.
+     *
+     * @return the release time in seconds.
+     */
+    float getRelease() const { return _release.load(); }
+
+    /**
+     * Sets the release time in seconds.
+     *
+     * @param release   The release time in seconds
+     */
+    void setRelease(float release) { _release.store(release < 0 ? 0 : release); }
+
+    /**
+     * Returns the makeup gain in decibels.
+     *
+     * @return the makeup gain in decibels.
+     */
+    float getMakeup() const { return _makeup.load(); }
+
+    /**
+     * Sets the makeup gain in decibels.
+     *
+     * @param makeup    The makeup gain in decibels
+     */
+    void setMakeup(float makeup) { _makeup.store(makeup); }
+
+    /**
+     * Returns the most recent gain reduction in decibels.
+     *
+     * This value is positive, and is suitable for metering.
+     *
+     * @return the most recent gain reduction in decibels.
+     */
+    float getReduction() const { return _reduction.load(std::memory_order_relaxed); }
+
+#pragma mark Processing
+    /**
+     * Compresses a block of audio in place.
+     *
+     * @param buffer    The audio block (interleaved stereo)
+     * @param frames    The number of frames in the block
+     */
+    virtual void process(float* buffer, Uint32 frames) override;
+
+    /**
+     * Clears the envelope of this compressor.
+     */
+    virtual void reset() override;
+};
+
+
+#pragma mark -
+#pragma mark Reverb
+/**
+ * This class is a simple stereo reverb.
+ *
+ * This is a reduced version of the classic Schroeder-Moorer design (as used
+ * in Freeverb), with four damped comb filters and two allpass filters per
+ * channel.  The right channel uses slightly longer delays to widen the
+ * image.  It is intended for ambience, not for realistic rooms.
+ */
+class ReverbNode : public AudioNode {
+private:
+    /** The room size (0 to 1) */
+    std::atomic<float> _size;
+    /** The high frequency damping (0 to 1) */
+    std::atomic<float> _damping;
+    /** The wet (reverberated) level */
+    std::atomic<float> _wet;
+    /** The dry (original) level */
+    std::atomic<float> _dry;
+    /** The delay line memory */
+    float* _memory;
+    /** The comb filter delay lines (4 per channel) */
+    float* _combs[8];
+    /** The comb filter lengths */
+    Uint32 _comblen[8];
+    /** The comb filter positions */
+    Uint32 _combpos[8];
+    /** The comb filter damping state */
+    float  _combstore[8];
+    /** The allpass delay lines (2 per channel) */
+    float* _passes[4];
+    /** The allpass lengths */
+    Uint32 _passlen[4];
+    /** The allpass positions */
+    Uint32 _passpos[4];
+    /** The wet signal for the current block */
+    float* _scratch;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate reverb.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    ReverbNode();
+
+    /**
+     * Deletes this reverb, disposing all resources.
+     */
+    ~ReverbNode() { dispose(); }
+
+    /**
+     * Disposes the delay lines of this reverb.
+     */
+    virtual void dispose() override;
+
+    /**
+     * Initializes a reverb with the given parameters.
+     *
+     * @param rate      The sample rate in HZ
+     * @param size      The room size (0 to 1)
+     * @param damping   The high frequency damping (0 to 1)
+     * @param wet       The wet (reverberated) level
+     * @param dry       The dry (original) level
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 rate, float size=0.5f, float damping=0.5f, float wet=0.25f, float dry=1.0f);
+
+    /**
+     * Returns a newly allocated reverb with the given parameters.
+     *
+     * @param rate      The sample rate in HZ
+     * @param size      The room size (0 to 1)
+     * @param damping   The high frequency damping (0 to 1)
+     * @param wet       The wet (reverberated) level
+     * @param dry       The dry (original) level
+     *
+     * @return a newly allocated reverb with the given parameters.
+     */
+    static std::shared_ptr<ReverbNode> alloc(Uint32 rate, float size=0.5f, float damping=0.5f,
+                                             float wet=0.25f, float dry=1.0f) {
+        std::shared_ptr<ReverbNode> result = std::make_shared<ReverbNode>();
+        return (result->init(rate,size,damping,wet,dry) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the room size (0 to 1).
+     *
+     * @return the room size (0 to 1).
+     */
+    float getSize() const { return _size.load(); }
+
+    /**
+     * Sets the room size (0 to 1).
+     *
+     * Larger rooms have longer tails.
+     *
+     * @param size  The room size (0 to 1)
+     */
+    void setSize(float size);
+
+    /**
+     * Returns the high frequency damping (0 to 1).
+     *
+     * @return the high frequency damping (0 to 1).
+     */
+    float getDamping() const { return _damping.load(); }
+
+    /**
+     * Sets the high frequency damping (0 to 1).
+     *
+     * @param damping   The high frequency damping (0 to 1)
+     */
+    void setDamping(float damping);
+
+    /**
+     * Returns the wet (reverberated) level.
+     *
+     * @return the wet (reverberated) level.
+     */
+    float getWet() const { return _wet.load(); }
+
+    /**
+     * Sets the wet (reverberated) level.
+     *
+     * @param wet   The wet (reverberated) level
+     */
+    void setWet(float wet) { _wet.store(wet); }
+
+    /**
+     * Returns the dry (original) level.
+     *
+     * @return the dry (original) level.
+     */
+    float getDry() const { return _dry.load(); }
+
+    /**
+     * Sets the dry (original) level.
+     *
+     * @param dry   The dry (original) level
+     */
+    void setDry(float dry) { _dry.store(dry); }
+
+#pragma mark Processing
+    /**
+     * Applies reverb to a block of audio in place.
+     *
+     * @param buffer    The audio block (interleaved stereo)
+     * @param frames    The number of frames in the block
+     */
+    virtual void process(float* buffer, Uint32 frames) override;
+
+    /**
+     * Clears the delay lines of this reverb.
+     */
+    virtual void reset() override;
+};
+
+
+#pragma mark -
+#pragma mark Ducker
+/**
+ * This class is a sidechain ducker.
+ *
+ * A ducker reduces the gain of its bus whenever another bus (the key) is
+ * louder than a threshold.  The classic use is to duck music under dialogue.
+ * The key level is the RMS level of the most recent block of the key bus.
+ * If the key bus is processed after this one (it has a lower index), that
+ * level is one block behind.
+ */
+class DuckerNode : public AudioNode {
+private:
+    /** The key bus (for ownership) */
+    std::shared_ptr<AudioBus> _keyref;
+    /** The key bus (for the audio thread) */
+    std::atomic<AudioBus*> _key;
+    /** The key threshold in decibels */
+    std::atomic<float> _threshold;
+    /** The gain reduction in decibels */
+    std::atomic<float> _depth;
+    /** The attack time in seconds */
+    std::atomic<float> _attack;
+    /** The release time in seconds */
+    std::atomic<float> _release;
+    /** The current gain (audio thread only) */
+    float _current;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate ducker.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    DuckerNode();
+
+    /**
+     * Disposes the key of this ducker.
+     */
+    virtual void dispose() override;
+
+    /**
+     * Initializes a ducker with the given parameters.
+     *
+     * @param rate      The sample rate in HZ
+     * @param key       The key bus
+     * @param threshold The key threshold in decibels
+     * @param depth     The gain reduction in decibels
+     * @param attack    The attack time in seconds
+     * @param release   The release time in seconds
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 rate, const std::shared_ptr<AudioBus>& key, float threshold=-40.0f,
+              float depth=12.0f, float attack=0.05f, float release=0.5f);
+
+    /**
+     * Returns a newly allocated ducker with the given parameters.
+     *
+     * @param rate      The sample rate in HZ
+     * @param key       The key bus
+     * @param threshold The key threshold in decibels
+     * @param depth     The gain reduction in decibels
+     * @param attack    The attack time in seconds
+     * @param release   The release time in seconds
+     *
+     * @return a newly allocated ducker with the given parameters.
+     */
+    static std::shared_ptr<DuckerNode> alloc(Uint32 rate, const std::shared_ptr<AudioBus>& key,
+                                             float threshold=-40.0f, float depth=12.0f,
+                                             float attack=0.05f, float release=0.5f) {
+        std::shared_ptr<DuckerNode> result = std::make_shared<DuckerNode>();
+        return (result->init(rate,key,threshold,depth,attack,release) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the key bus.
+     *
+     * @return the key bus.
+     */
+    const std::shared_ptr<AudioBus>& getKey() const { return _keyref; }
+
+    /**
+     * Sets the key bus.
+     *
+     * The key bus must belong to the same mixer as the bus of this node.
+     *
+     * @param key   The key bus
+     */
+    void setKey(const std::shared_ptr<AudioBus>& key);
+
+    /**
+     * Returns the key threshold in decibels.
+     *
+     * @return the key threshold in decibels.
+     */
+    float getThreshold() const { return _threshold.load(); }
+
+    /**
+     * Sets the key threshold in decibels.
+     *
+     * @param threshold The key threshold in decibels
+     */
+    void setThreshold(float threshold) { _threshold.store(threshold); }
+
+    /**
+     * Returns the gain reduction in decibels.
+     *
+     * @return the gain reduction in decibels.
+     */
+    float getDepth() const { return _depth.load(); }
+
+    /**
+     * Sets the gain reduction in decibels.
+     *
+     * @param depth The gain reduction in decibels
+     */
+    void setDepth(float depth) { _depth.store(depth < 0 ? -depth : depth); }
+
+    /**
+     * Returns the attack time in seconds.
+     *
+     * @return the attack time in seconds.
+     */
+    float getAttack() const { return _attack.load(); }
+
+    /**
+     * Sets the attack time in seconds.
+     *
+     * @param attack    The attack time in seconds
+     */
+    void setAttack(float attack) { _attack.store(attack < 0 ? 0 : attack); }
+
+    /**
+     * Returns the release time in seconds.
+     *
+     * @return the release time in seconds.
+     */
+    float getRelease() const { return _release.load(); }
+
+    /**
+     * Sets the release time in seconds.
+     *
+     * @param release   The release time in seconds
+     */
+    void setRelease(float release) { _release.store(release < 0 ? 0 : release); }
+
+#pragma mark Processing
+    /**
+     * Ducks a block of audio in place.
+     *
+     * @param buffer    The audio block (interleaved stereo)
+     * @param frames    The number of frames in the block
+     */
+    virtual void process(float* buffer, Uint32 frames) override;
+
+    /**
+     * Restores the ducker to unity gain.
+     */
+    virtual void reset() override;
+};
+
+}
+
+#endif /* __CU_AUDIO_NODE_H__ */
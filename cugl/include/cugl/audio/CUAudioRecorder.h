@@ -0,0 +1,303 @@
+//
+//  CUAudioRecorder.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a recorder for offline audio.  A recorder pulls
+//  fixed-size blocks from an audio source and (optionally) keeps a copy of
+//  everything that it pulled.  The captured audio can then be encoded as a
+//  WAV file, either for listening or for byte-for-byte comparison in tests.
+//
+//  The default source is the offline audio engine (see the method
+//  AudioEngine::startOffline).  As the offline engine only advances when it
+//  is rendered, the recorder is the clock for that engine.  This makes it
+//  possible to write deterministic tests and benchmarks of the audio code
+//  with no audio device.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_AUDIO_RECORDER_H__
+#define __CU_AUDIO_RECORDER_H__
+#include <cugl/base/CUBase.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Audio Recorder
+/**
+ * This class records the output of an offline audio source.
+ *
+ * The source is a function that fills a buffer of interleaved float samples.
+ * Every call to {@link advance} clears an internal block buffer, asks the
+ * source to fill it, and returns it.  If capture is enabled, the block is
+ * also appended to the recording.
+ *
+ * The recording may be encoded as a WAV file with {@link encode} or
+ * {@link save}.  The encoding only depends on the samples, so two identical
+ * offline runs will produce identical files.
+ */
+class AudioRecorder {
+public:
+    /**
+     * @typedef Source
+     *
+     * This type represents an offline audio source.
+     *
+     * The source should add (or write) the given number of frames of audio to
+     * the buffer.  The buffer is interleaved, and it is zeroed before the
+     * source is called.
+     *
+     * The function type is equivalent to
+     *
+     *      std::function<void(float* buffer, Uint32 frames)>
+     */
+    typedef std::function<void(float* buffer, Uint32 frames)> Source;
+
+private:
+    /** This macro disables the copy constructor (not allowed on recorders) */
+    CU_DISALLOW_COPY_AND_ASSIGN(AudioRecorder);
+
+    /** The audio source */
+    Source _source;
+    /** The number of channels per frame */
+    Uint32 _channels;
+    /** The sample rate */
+    Uint32 _rate;
+    /** Whether to append each block to the recording */
+    bool _capture;
+    /** The current block */
+    std::vector<float> _block;
+    /** The recorded samples */
+    std::vector<float> _samples;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate recorder with no source.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioRecorder();
+
+    /**
+     * Deletes this recorder, disposing all resources.
+     */
+    ~AudioRecorder() { dispose(); }
+
+    /**
+     * Disposes all resources allocated for this recorder.
+     *
+     * The recording is lost when this method is called.
+     */
+    void dispose();
+
+    /**
+     * Initializes a recorder for the offline audio engine.
+     *
+     * The audio engine must have been started with
+     * {@link AudioEngine#startOffline}.  Every call to {@link advance} will
+     * render the engine.
+     *
+     * @return true if initialization was successful.
+     */
+    bool init();
+
+    /**
+     * Initializes a recorder for the given source.
+     *
+     * @param channels  The number of channels per frame
+     * @param rate      The sample rate
+     * @param source    The audio source
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 channels, Uint32 rate, const Source& source);
+
+    /**
+     * Returns a newly allocated recorder for the offline audio engine.
+     *
+     * The audio engine must have been started with
+     * {@link AudioEngine#startOffline}.  Every call to {@link advance} will
+     * render the engine.
+     *
+     * @return a newly allocated recorder for the offline audio engine.
+     */
+    static std::shared_ptr<AudioRecorder> alloc() {
+        std::shared_ptr<AudioRecorder> result = std::make_shared<AudioRecorder>();
+        return (result->init() ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated recorder for the given source.
+     *
+     * @param channels  The number of channels per frame
+     * @param rate      The sample rate
+     * @param source    The audio source
+     *
+     * @return a newly allocated recorder for the given source.
+     */
+    static std::shared_ptr<AudioRecorder> alloc(Uint32 channels, Uint32 rate, const Source& source) {
+        std::shared_ptr<AudioRecorder> result = std::make_shared<AudioRecorder>();
+        return (result->init(channels,rate,source) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the number of channels per frame
+     *
+     * @return the number of channels per frame
+     */
+    Uint32 getChannels() const { return _channels; }
+
+    /**
+     * Returns the sample rate
+     *
+     * @return the sample rate
+     */
+    Uint32 getRate() const { return _rate; }
+
+    /**
+     * Returns true if this recorder keeps the blocks that it renders.
+     *
+     * If this is false, {@link advance} still renders the source, but the
+     * result is discarded after the next call.  This is useful for skipping
+     * ahead, or for benchmarks.  Capture is enabled by default.
+     *
+     * @return true if this recorder keeps the blocks that it renders.
+     */
+    bool isCapture() const { return _capture; }
+
+    /**
+     * Sets whether this recorder keeps the blocks that it renders.
+     *
+     * If this is false, {@link advance} still renders the source, but the
+     * result is discarded after the next call.  This is useful for skipping
+     * ahead, or for benchmarks.  Capture is enabled by default.
+     *
+     * @param value Whether this recorder keeps the blocks that it renders.
+     */
+    void setCapture(bool value) { _capture = value; }
+
+    /**
+     * Returns the number of frames recorded so far
+     *
+     * @return the number of frames recorded so far
+     */
+    Uint64 getFrames() const {
+        return _channels ? _samples.size()/_channels : 0;
+    }
+
+    /**
+     * Returns the recorded samples
+     *
+     * The samples are interleaved, with {@link getChannels} samples per frame.
+     *
+     * @return the recorded samples
+     */
+    const std::vector<float>& getSamples() const { return _samples; }
+
+    /**
+     * Erases the recording, keeping the source.
+     */
+    void clear() { _samples.clear(); }
+
+#pragma mark Recording
+    /**
+     * Renders the given number of frames from the source
+     *
+     * The returned block is owned by this recorder, and is only valid until
+     * the next call to this method.  If capture is enabled, the block is also
+     * appended to the recording.
+     *
+     * @param frames    The number of frames to render
+     *
+     * @return the rendered block of interleaved samples
+     */
+    const float* advance(Uint32 frames);
+
+    /**
+     * Returns the recording encoded as a WAV file.
+     *
+     * If floats is true, the file uses 32-bit float samples.  Otherwise the
+     * samples are clamped and converted to 16-bit integers.
+     *
+     * @param floats    Whether to encode the samples as floats
+     *
+     * @return the recording encoded as a WAV file.
+     */
+    std::vector<Uint8> encode(bool floats=false) const {
+        std::vector<Uint8> result;
+        encode(_samples.data(),getFrames(),_channels,_rate,floats,result);
+        return result;
+    }
+
+    /**
+     * Saves the recording to the given WAV file.
+     *
+     * If floats is true, the file uses 32-bit float samples.  Otherwise the
+     * samples are clamped and converted to 16-bit integers.
+     *
+     * @param file      The path of the WAV file
+     * @param floats    Whether to encode the samples as floats
+     *
+     * @return true if the file was successfully written.
+     */
+    bool save(const std::string& file, bool floats=false) const;
+
+    /**
+     * Encodes the given samples as a WAV file.
+     *
+     * The samples should be interleaved, with the given number of channels
+     * per frame.  If floats is true, the file uses 32-bit float samples.
+     * Otherwise the samples are clamped and converted to 16-bit integers.
+     * The previous contents of the output vector are replaced.
+     *
+     * @param samples   The interleaved samples
+     * @param frames    The number of frames
+     * @param channels  The number of channels per frame
+     * @param rate      The sample rate
+     * @param floats    Whether to encode the samples as floats
+     * @param output    The vector to store the encoded file
+     */
+    static void encode(const float* samples, Uint64 frames, Uint32 channels,
+                       Uint32 rate, bool floats, std::vector<Uint8>& output);
+};
+
+}
+
+#endif /* __CU_AUDIO_RECORDER_H__ */
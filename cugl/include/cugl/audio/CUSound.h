@@ -69,15 +69,26 @@ namespace impl {
 /**
  * Class provides a reference to a pre-loaded asset.
  *
- * Sound assets are loaded entirely into memory.  They are not streamed. 
- * Therefore, this type of asset should be reserved for low-memory footprint
- * sounds such as sound effects. Music files should be streamed and processed
- * as a {@link Music} asset instead.
+ * Sound assets are normally loaded entirely into memory.  Therefore, this
+ * type of asset should be reserved for low-memory footprint sounds such as
+ * sound effects. Music files should be streamed and processed as a
+ * {@link Music} asset instead.
+ *
+ * The exception is long OGG Vorbis sounds (such as ambient loops).  If the
+ * decoded sound would be larger than the {@link getStreamThreshold stream
+ * threshold}, it is kept compressed in memory and decoded on a background
+ * thread as it plays.  This is only supported by the SDL audio backend, and
+ * only when the sample rate of the file matches that of the audio device.
  *
  * As a general rule, it is best for these assets to be WAV files. There are
  * no cross-platform lossless encodings for both Androi and iOS.  For lossy
  * encodings, only OGG Vorbis is good enough for sound effects.
  *
+ * Decoded sounds are converted to the sample rate of the audio device when
+ * they are loaded, so that no conversion happens during playback.  Sounds
+ * loaded from identical files (even under different keys) share the same
+ * decoded samples on the SDL audio backend.
+ *
  * The internal representation of the sound buffer is platform dependent.
  * You should never attempt to access the buffer directly.
  */
@@ -93,6 +104,9 @@ private:
     /** The default volume for this sound */
     float _volume;
     
+    /** The decoded size in bytes above which sounds are streamed */
+    static Uint64 _threshold;
+    
 #pragma mark -
 #pragma mark Constructors
 public:
@@ -254,6 +268,67 @@ public:
      * @param volume    The default volume of this sound asset.
      */
     void setVolume(float volume);
+
+    /**
+     * Returns true if this sound asset is streamed.
+     *
+     * A streamed sound is kept compressed in memory, and is decoded on a
+     * background thread during playback.  Streamed sounds use much less
+     * memory, at the cost of some CPU time whenever they are played.
+     *
+     * @return true if this sound asset is streamed.
+     */
+    bool isStreaming() const;
+
+    /**
+     * Returns the memory used by this sound asset in bytes.
+     *
+     * For a sound in memory, this is the size of the decoded samples.  For
+     * a streamed sound, this is the size of the compressed file.  The decoded
+     * samples may be shared with other sound assets loaded from identical
+     * files (see {@link getShareCount}), in which case the memory is only
+     * used once for all of them.
+     *
+     * @return the memory used by this sound asset in bytes.
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Returns the number of sound assets sharing the samples of this one.
+     *
+     * Sound assets loaded from files with identical contents share a single
+     * copy of the decoded samples.  This count includes this sound asset, so
+     * a value of 1 means that the samples are not shared.  This is only
+     * supported by the SDL audio backend.
+     *
+     * @return the number of sound assets sharing the samples of this one.
+     */
+    Uint32 getShareCount() const;
+
+#pragma mark Streaming
+    /**
+     * Returns the decoded size in bytes above which sounds are streamed.
+     *
+     * This threshold is applied when a sound is loaded, and so it does not
+     * affect sounds already in memory.  A value of 0 means that sounds are
+     * never streamed.  The default is 4 MB, which is about 12 seconds of
+     * stereo audio at 44.1 kHz.
+     *
+     * @return the decoded size in bytes above which sounds are streamed.
+     */
+    static Uint64 getStreamThreshold() { return _threshold; }
+
+    /**
+     * Sets the decoded size in bytes above which sounds are streamed.
+     *
+     * This threshold is applied when a sound is loaded, and so it does not
+     * affect sounds already in memory.  A value of 0 means that sounds are
+     * never streamed.  The default is 4 MB, which is about 12 seconds of
+     * stereo audio at 44.1 kHz.
+     *
+     * @param bytes The decoded size in bytes above which sounds are streamed.
+     */
+    static void setStreamThreshold(Uint64 bytes) { _threshold = bytes; }
     
     /** Allow a sound channel to access the internal buffers */
     friend class SoundChannel;
@@ -30,6 +30,9 @@
 
 #include "CUSound.h"
 #include "CUMusic.h"
+#include "CUAudioNode.h"
+#include "CUAudioBus.h"
+#include "CUAudioRecorder.h"
 #include "CUAudioEngine.h"
 
 #endif /* __CU_AUDIO_PKG_H__ */
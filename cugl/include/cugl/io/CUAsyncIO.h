@@ -0,0 +1,536 @@
+//
+//  CUAsyncIO.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a service for reading and writing files off of the
+//  main thread.  Requests are queued by priority and processed by a small
+//  pool of worker threads.  The results are available as futures, and can
+//  also be delivered to callbacks on the main thread (at the start of the
+//  next animation frame).
+//
+//  Writes are atomic: the data is written to a temporary file that replaces
+//  the original only once it is complete.  Requests are coalesced when they
+//  are still waiting in the queue, so a burst of saves to the same file only
+//  writes the file once.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_ASYNC_IO_H__
+#define __CU_ASYNC_IO_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/io/CUPathname.h>
+#include <cugl/util/CUThreadPool.h>
+#include <unordered_map>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark AsyncIO
+
+/**
+ * Service for asynchronous file reads and writes.
+ *
+ * This class allows you to overlap file access with computation.  Each
+ * request is placed in a priority queue, and is processed by the next
+ * available worker thread.  Higher priorities are processed first, and
+ * requests of equal priority are processed in the order received.
+ *
+ * Every request returns a future for its result.  In addition, you may
+ * specify a callback function for the result.  Callbacks are always
+ * executed on the main thread, via {@link Application#schedule}.  They are
+ * not executed until the next animation frame, even if the request was
+ * satisfied immediately.
+ *
+ * Requests are coalesced whenever possible.  A read of a file that is
+ * already waiting to be read shares the same request.  A write to a file
+ * that is already waiting to be written replaces the data of that request,
+ * so that only the most recent data is written.  In that case, both the
+ * old and new futures report the result of the final write.  Finally, a
+ * read of a file that is waiting to be written is satisfied immediately
+ * with the data to be written.
+ *
+ * Requests on the same file are never processed at the same time as a
+ * write to that file.  So a read of a file always reflects all of the
+ * writes to that file made before it.  Writes to different files are
+ * processed in parallel.
+ *
+ * Writes are atomic.  The data is written to a temporary file, which is
+ * then renamed to replace the original file.  Hence a crash in the middle
+ * of a save will never leave a partially written file.
+ */
+class AsyncIO {
+public:
+    /**
+     * @typedef ReadCallback
+     *
+     * This type represents a callback for an asynchronous read.
+     *
+     * The function receives the data that was read.  This value is nullptr
+     * if the file could not be read.  The function type is equivalent to
+     *
+     *      std::function<void(const std::shared_ptr<std::string>& data)>
+     */
+    typedef std::function<void(const std::shared_ptr<std::string>& data)> ReadCallback;
+    
+    /**
+     * @typedef WriteCallback
+     *
+     * This type represents a callback for an asynchronous write.
+     *
+     * The function receives whether the write was successful.  The function
+     * type is equivalent to
+     *
+     *      std::function<void(bool success)>
+     */
+    typedef std::function<void(bool success)> WriteCallback;
+    
+    /**
+     * @typedef ReadFuture
+     *
+     * This type represents the future result of an asynchronous read.
+     *
+     * The result is the data that was read, or nullptr if the file could
+     * not be read.
+     */
+    typedef std::shared_future<std::shared_ptr<std::string>> ReadFuture;
+    
+    /**
+     * @typedef WriteFuture
+     *
+     * This type represents the future result of an asynchronous write.
+     *
+     * The result is true if the write was successful.
+     */
+    typedef std::shared_future<bool> WriteFuture;
+    
+protected:
+    /**
+     * A single request in the queue.
+     *
+     * Reads of an entire file are represented as a range from 0 with the
+     * maximum possible length.
+     */
+    class Request {
+    public:
+        /** Whether this request is a write */
+        bool write;
+        /** The absolute path of the file */
+        std::string path;
+        /** The key for coalescing this request */
+        std::string key;
+        /** The offset of the first byte to read */
+        Uint64 offset;
+        /** The maximum number of bytes to read */
+        Uint64 length;
+        /** The request priority (higher priorities are processed first) */
+        int priority;
+        /** The request order, to break ties in priority */
+        Uint64 order;
+        /** The data to write */
+        std::string data;
+        
+        /** The promise for a read result */
+        std::promise<std::shared_ptr<std::string>> reader;
+        /** The future for a read result */
+        ReadFuture readFuture;
+        /** The callbacks for a read result */
+        std::vector<ReadCallback> readCallbacks;
+        
+        /** The promise for a write result */
+        std::promise<bool> writer;
+        /** The future for a write result */
+        WriteFuture writeFuture;
+        /** The callbacks for a write result */
+        std::vector<WriteCallback> writeCallbacks;
+    };
+    
+    /** The worker threads */
+    std::shared_ptr<ThreadPool> _pool;
+    /** The queued requests, as a heap ordered by priority */
+    std::vector<std::shared_ptr<Request>> _queue;
+    /** The queued requests, indexed by coalescing key */
+    std::unordered_map<std::string,std::shared_ptr<Request>> _waiting;
+    /** The requests in progress for each file (-1 for a write, else the number of reads) */
+    std::unordered_map<std::string,int> _active;
+    /** Requests postponed until a write of the same file completes */
+    std::vector<std::shared_ptr<Request>> _deferred;
+    
+    /** A mutex lock for the request queue */
+    std::mutex _mutex;
+    /** A condition variable to signal when all requests are complete */
+    std::condition_variable _idle;
+    /** The number of requests that are not yet complete */
+    size_t _pending;
+    /** The number of requests received so far */
+    Uint64 _order;
+    /** The number of requests that were merged into another */
+    Uint64 _coalesced;
+    
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Adds a request to the queue, coalescing it if possible.
+     *
+     * If the request is coalesced, this method returns the request that
+     * absorbed it.  Otherwise it returns the argument.
+     *
+     * @param request   The request to add
+     * @param rcallback The read callback (may be nullptr)
+     * @param wcallback The write callback (may be nullptr)
+     *
+     * @return the request that will satisfy this one
+     */
+    std::shared_ptr<Request> submit(const std::shared_ptr<Request>& request,
+                                    ReadCallback rcallback, WriteCallback wcallback);
+    
+    /**
+     * Processes the request at the front of the queue.
+     *
+     * This method is executed on a worker thread.  There is one task in
+     * the thread pool for every request in the queue.
+     */
+    void process();
+    
+    /**
+     * Delivers the result of a read to the request futures and callbacks.
+     *
+     * @param request   The completed request
+     * @param data      The data read (or nullptr on failure)
+     */
+    static void resolve(const std::shared_ptr<Request>& request,
+                        const std::shared_ptr<std::string>& data);
+
+    /**
+     * Delivers the result of a write to the request futures and callbacks.
+     *
+     * @param request   The completed request
+     * @param success   Whether the write was successful
+     */
+    static void resolve(const std::shared_ptr<Request>& request, bool success);
+    
+    
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates an inactive I/O service.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AsyncIO() : _pool(nullptr), _pending(0), _order(0), _coalesced(0) {}
+    
+    /**
+     * Deletes this I/O service, completing all pending requests.
+     */
+    ~AsyncIO() { dispose(); }
+    
+    /**
+     * Completes all pending requests and stops the worker threads.
+     *
+     * Requests are not abandoned, so that no save is ever lost.  You must
+     * reinitialize the service to use it again.
+     */
+    void dispose();
+    
+    /**
+     * Initializes an I/O service with the given number of worker threads.
+     *
+     * More than one thread allows writes to different files to proceed in
+     * parallel.  However, most storage devices gain little beyond a few
+     * threads.
+     *
+     * @param threads   The number of worker threads
+     *
+     * @return true if the service is initialized properly, false otherwise.
+     */
+    bool init(int threads=2);
+    
+    /**
+     * Returns a newly allocated I/O service with the given number of threads.
+     *
+     * More than one thread allows writes to different files to proceed in
+     * parallel.  However, most storage devices gain little beyond a few
+     * threads.
+     *
+     * @param threads   The number of worker threads
+     *
+     * @return a newly allocated I/O service with the given number of threads.
+     */
+    static std::shared_ptr<AsyncIO> alloc(int threads=2) {
+        std::shared_ptr<AsyncIO> result = std::make_shared<AsyncIO>();
+        return (result->init(threads) ? result : nullptr);
+    }
+    
+
+#pragma mark -
+#pragma mark Reading
+    /**
+     * Returns the future contents of the given file.
+     *
+     * If the file is a relative path, this method will look for the file
+     * in the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the contents of the file.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param callback  An optional callback for the file contents
+     * @param priority  The request priority
+     *
+     * @return the future contents of the given file.
+     */
+    ReadFuture readFile(const std::string& file, ReadCallback callback=nullptr, int priority=0) {
+        return readFile(Pathname(file),callback,priority);
+    }
+
+    /**
+     * Returns the future contents of the given file.
+     *
+     * If the file is a relative path, this method will look for the file
+     * in the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the contents of the file.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param callback  An optional callback for the file contents
+     * @param priority  The request priority
+     *
+     * @return the future contents of the given file.
+     */
+    ReadFuture readFile(const char* file, ReadCallback callback=nullptr, int priority=0) {
+        return readFile(Pathname(file),callback,priority);
+    }
+
+    /**
+     * Returns the future contents of the given file.
+     *
+     * If the file is a relative path, this method will look for the file
+     * in the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the contents of the file.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param callback  An optional callback for the file contents
+     * @param priority  The request priority
+     *
+     * @return the future contents of the given file.
+     */
+    ReadFuture readFile(const Pathname& file, ReadCallback callback=nullptr, int priority=0);
+
+    /**
+     * Returns the future contents of the given range of a file.
+     *
+     * The range is truncated if it extends past the end of the file.  If
+     * the offset is past the end of the file, the read fails.
+     *
+     * If the file is a relative path, this method will look for the file
+     * in the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the contents of the range.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param offset    The offset of the first byte to read
+     * @param length    The maximum number of bytes to read
+     * @param callback  An optional callback for the range contents
+     * @param priority  The request priority
+     *
+     * @return the future contents of the given range of a file.
+     */
+    ReadFuture readRange(const std::string& file, Uint64 offset, Uint64 length,
+                         ReadCallback callback=nullptr, int priority=0) {
+        return readRange(Pathname(file),offset,length,callback,priority);
+    }
+
+    /**
+     * Returns the future contents of the given range of a file.
+     *
+     * The range is truncated if it extends past the end of the file.  If
+     * the offset is past the end of the file, the read fails.
+     *
+     * If the file is a relative path, this method will look for the file
+     * in the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the contents of the range.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param offset    The offset of the first byte to read
+     * @param length    The maximum number of bytes to read
+     * @param callback  An optional callback for the range contents
+     * @param priority  The request priority
+     *
+     * @return the future contents of the given range of a file.
+     */
+    ReadFuture readRange(const char* file, Uint64 offset, Uint64 length,
+                         ReadCallback callback=nullptr, int priority=0) {
+        return readRange(Pathname(file),offset,length,callback,priority);
+    }
+
+    /**
+     * Returns the future contents of the given range of a file.
+     *
+     * The range is truncated if it extends past the end of the file.  If
+     * the offset is past the end of the file, the read fails.
+     *
+     * If the file is a relative path, this method will look for the file
+     * in the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the contents of the range.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param offset    The offset of the first byte to read
+     * @param length    The maximum number of bytes to read
+     * @param callback  An optional callback for the range contents
+     * @param priority  The request priority
+     *
+     * @return the future contents of the given range of a file.
+     */
+    ReadFuture readRange(const Pathname& file, Uint64 offset, Uint64 length,
+                         ReadCallback callback=nullptr, int priority=0);
+    
+
+#pragma mark -
+#pragma mark Writing
+    /**
+     * Returns the future result of atomically writing data to a file.
+     *
+     * The data replaces the contents of the file, which is created if it
+     * does not exist.  The data is moved into the request, so pass it with
+     * std::move to avoid a copy.
+     *
+     * If the file is a relative path, this method will write the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the result of the write.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param data      The data to write
+     * @param callback  An optional callback for the write result
+     * @param priority  The request priority
+     *
+     * @return the future result of atomically writing data to a file.
+     */
+    WriteFuture writeFile(const std::string& file, std::string data,
+                          WriteCallback callback=nullptr, int priority=0) {
+        return writeFile(Pathname(file),std::move(data),callback,priority);
+    }
+
+    /**
+     * Returns the future result of atomically writing data to a file.
+     *
+     * The data replaces the contents of the file, which is created if it
+     * does not exist.  The data is moved into the request, so pass it with
+     * std::move to avoid a copy.
+     *
+     * If the file is a relative path, this method will write the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the result of the write.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param data      The data to write
+     * @param callback  An optional callback for the write result
+     * @param priority  The request priority
+     *
+     * @return the future result of atomically writing data to a file.
+     */
+    WriteFuture writeFile(const char* file, std::string data,
+                          WriteCallback callback=nullptr, int priority=0) {
+        return writeFile(Pathname(file),std::move(data),callback,priority);
+    }
+
+    /**
+     * Returns the future result of atomically writing data to a file.
+     *
+     * The data replaces the contents of the file, which is created if it
+     * does not exist.  The data is moved into the request, so pass it with
+     * std::move to avoid a copy.
+     *
+     * If the file is a relative path, this method will write the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     *
+     * If callback is not nullptr, it will be executed on the main thread
+     * with the result of the write.
+     *
+     * @param file      The path (absolute or relative) to the file
+     * @param data      The data to write
+     * @param callback  An optional callback for the write result
+     * @param priority  The request priority
+     *
+     * @return the future result of atomically writing data to a file.
+     */
+    WriteFuture writeFile(const Pathname& file, std::string data,
+                          WriteCallback callback=nullptr, int priority=0);
+
+    
+#pragma mark -
+#pragma mark Synchronization
+    /**
+     * Blocks until all pending requests are complete.
+     *
+     * This includes any requests made by other threads while waiting.
+     * Callbacks are not executed by this method; they are still delivered
+     * at the next animation frame.
+     */
+    void wait();
+    
+    /**
+     * Returns the number of requests that are not yet complete.
+     *
+     * @return the number of requests that are not yet complete.
+     */
+    size_t getPending();
+    
+    /**
+     * Returns the number of requests merged into another request.
+     *
+     * This value is a measure of how much work coalescing has saved.
+     *
+     * @return the number of requests merged into another request.
+     */
+    Uint64 getCoalesced();
+    
+    // Copying is only allowed via shared pointer.
+    CU_DISALLOW_COPY_AND_ASSIGN(AsyncIO);
+};
+
+}
+
+#endif /* __CU_ASYNC_IO_H__ */
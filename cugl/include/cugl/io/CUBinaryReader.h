@@ -17,6 +17,9 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  Large files may be memory mapped instead of buffered.  In that case, the
+//  reads are just pointer arithmetic on the mapped file.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -55,6 +58,7 @@
 #include <cugl/base/CUBase.h>
 #include <SDL/SDL.h>
 #include <cugl/io/CUPathname.h>
+#include <cugl/io/CUMappedFile.h>
 #include <string>
 
 namespace cugl {
@@ -92,10 +96,17 @@ protected:
     char*       _buffer;
     /** The buffer capacity */
     Uint32      _capacity;
-    /** The buffer capacity */
-    Uint32      _bufsize;
-    /** The current offset in the read buffer */
-    Sint32      _bufoff;
+    /** The number of bytes of readable data */
+    Uint64      _bufsize;
+    /** The current offset in the read buffer (-1, past any window, if closed) */
+    Sint64      _bufoff;
+    
+    /** The memory mapped file (nullptr if this reader is buffered) */
+    std::shared_ptr<MappedFile> _mapping;
+    /** Whether this reader reads from a memory mapped file */
+    bool        _mapped;
+    /** The readable data (either the transfer buffer or the mapped file) */
+    const char* _window;
     
 #pragma mark -
 #pragma mark Internal Methods
@@ -103,12 +114,51 @@ protected:
      * Fills the storage buffer to capacity
      *
      * This cuts down on the number of reads to the file by allowing us
-     * to read from the file in predefined chunks.
+     * to read from the file in predefined chunks.  It has no effect on a
+     * memory mapped reader, as the entire file is already readable.
      *
      * @param bytes The minimum number of bytes to ensure in the stream
      */
     void fill(unsigned int bytes=1);
     
+    /**
+     * Returns the number of bytes read from the stream into the given buffer
+     *
+     * This is the only method that reads from the underlying stream.  The
+     * default implementation reads the bytes as is.  Subclasses may override
+     * it to decode the file (e.g. to decompress it) before it is buffered.
+     *
+     * @param dst       The buffer to store the bytes read
+     * @param length    The maximum number of bytes to read
+     *
+     * @return the number of bytes read from the stream into the given buffer
+     */
+    virtual size_t readStream(void* dst, size_t length);
+    
+    /**
+     * Returns true if the reader successfully attached to its mapped file
+     *
+     * This method makes the entire mapped file the readable data.
+     *
+     * @return true if the reader successfully attached to its mapped file
+     */
+    bool attach();
+    
+    /**
+     * Reads a sequence of values from the stream, marshalling each one.
+     *
+     * The values are copied directly from the read window, and are converted
+     * from network order in bulk.  This is the implementation of all of the
+     * array reads.
+     *
+     * @param buffer    The array to store the data when read
+     * @param count     The maximum number of values to read from the stream
+     * @param bytes     The size of each value in bytes
+     *
+     * @return the number of values read from the stream
+     */
+    size_t readArray(void* buffer, size_t count, unsigned int bytes);
+    
     
 #pragma mark -
 #pragma mark Constructors
@@ -120,14 +170,15 @@ public:
      * the heap, use one of the static constructors instead.
      */
     BinaryReader() : _name(""), _stream(nullptr), _ssize(-1), _scursor(-1),
-                     _buffer(nullptr), _capacity(0), _bufoff(-1), _bufsize(0) {}
+                     _buffer(nullptr), _capacity(0), _bufsize(0), _bufoff(-1),
+                     _mapping(nullptr), _mapped(false), _window(nullptr) {}
     
     /**
      * Deletes this reader and all of its resources.
      *
      * Calls to the destructor will close the file if it is not already closed.
      */
-    ~BinaryReader() { close(); }
+    virtual ~BinaryReader() { close(); }
     
     /**
      * Initializes a reader for the given file.
@@ -297,6 +348,102 @@ public:
      */
     bool initWithAsset(const char* file, unsigned int capacity);
     
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  This
+     * is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const std::string& file) {
+        return initMapped(Pathname(file));
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  This
+     * is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const char* file) {
+        return initMapped(Pathname(file));
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  This
+     * is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const Pathname& file);
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  If
+     * the asset cannot be mapped (e.g. it is inside of a packaged archive),
+     * the file is read into memory all at once.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMappedWithAsset(const std::string& file) {
+        return initMappedWithAsset(file.c_str());
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  If
+     * the asset cannot be mapped (e.g. it is inside of a packaged archive),
+     * the file is read into memory all at once.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMappedWithAsset(const char* file);
+    
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -450,6 +597,111 @@ public:
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
     
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  This
+     * is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMapped(const std::string& file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMapped(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  This
+     * is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMapped(const char* file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMapped(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  This
+     * is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMapped(const Pathname& file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMapped(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  If
+     * the asset cannot be mapped (e.g. it is inside of a packaged archive),
+     * the file is read into memory all at once.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMappedWithAsset(const std::string& file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMappedWithAsset(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and every read is just pointer arithmetic on the file.  If
+     * the asset cannot be mapped (e.g. it is inside of a packaged archive),
+     * the file is read into memory all at once.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMappedWithAsset(const char* file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMappedWithAsset(file) ? result : nullptr);
+    }
+    
     
 #pragma mark -
 #pragma mark Stream Management
@@ -459,7 +711,7 @@ public:
      * This allows the stream to be read a second time.  It may even be called
      * if the stream has been closed.
      */
-    void reset();
+    virtual void reset();
     
     /**
      * Closes the stream, releasing all resources
@@ -467,7 +719,7 @@ public:
      * Any attempts to read from a closed stream will fail.  Calling this method
      * on a previously closed stream has no effect.
      */
-    void close();
+    virtual void close();
     
     /**
      * Returns true if there is still data to read.
@@ -481,6 +733,13 @@ public:
      */
     bool ready(unsigned int bytes=1) const;
     
+    /**
+     * Returns true if this reader reads from a memory mapped file.
+     *
+     * @return true if this reader reads from a memory mapped file.
+     */
+    bool isMapped() const { return _mapped; }
+    
     
 #pragma mark -
 #pragma mark Single Element Reads
@@ -578,6 +837,20 @@ public:
      */
     double readDouble();
     
+    /**
+     * Returns a pointer to the next bytes of the stream, without copying them.
+     *
+     * The bytes are returned as is, with no marshalling.  For a memory mapped
+     * reader, the pointer is valid until the reader is closed.  For a buffered
+     * reader, the number of bytes may not exceed the buffer capacity, and the
+     * pointer is only valid until the next read.  This method returns nullptr
+     * if there are too few bytes remaining.
+     *
+     * @param bytes The number of bytes to read
+     *
+     * @return a pointer to the next bytes of the stream, without copying them.
+     */
+    const Uint8* readSpan(size_t bytes);
     
 #pragma mark -
 #pragma mark Array Reads
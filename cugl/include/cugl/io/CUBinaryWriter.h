@@ -91,6 +91,35 @@ protected:
     /** The current offset in the writer buffer */
     Sint32      _bufoff;
 
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Writes a sequence of values to the binary file, marshalling each one.
+     *
+     * The values are converted to network order in bulk as they are copied
+     * into the write buffer.  This is the implementation of all of the array
+     * writes.
+     *
+     * @param array  the array of values to write
+     * @param length the number of values to write
+     * @param bytes  the size of each value in bytes
+     */
+    void writeArray(const void* array, size_t length, unsigned int bytes);
+    
+    /**
+     * Writes the given bytes to the underlying stream.
+     *
+     * This is the only method that writes to the underlying stream.  The
+     * default implementation writes the bytes as is.  Subclasses may override
+     * it to encode the file (e.g. to compress it) as it is written.
+     *
+     * @param src       The bytes to write
+     * @param length    The number of bytes to write
+     *
+     * @return the number of bytes written to the stream
+     */
+    virtual size_t writeStream(const void* src, size_t length);
+    
     
 #pragma mark -
 #pragma mark Constructors
@@ -108,7 +137,7 @@ public:
      *
      * Calls to the destructor will close the file if it is not already closed.
      */
-    ~BinaryWriter() { close(); }
+    virtual ~BinaryWriter() { close(); }
     
     /**
      * Initializes a writer for the given file.
@@ -361,7 +390,7 @@ public:
      * attempts to write to a closed stream will fail.  Calling this method
      * on a previously closed stream has no effect.
      */
-    void close();
+    virtual void close();
 
 
 #pragma mark -
@@ -0,0 +1,574 @@
+//
+//  CUCompressedReader.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a binary reader for compressed files.  The file is
+//  decompressed a block at a time as it is read, so the reader never needs
+//  more memory than a single block.  Otherwise, it is identical to a normal
+//  BinaryReader, and all data is marshalled from network order.
+//
+//  Compressed files are created with either CompressedWriter or the container
+//  functions in CUCompression.h.  This reader also has support for JSON,
+//  making it suitable for compressed save files.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.  Keep in mind that
+//  absolute paths are very dangerous on mobile devices, because they do not
+//  have proper file systems.  You should confine all files to either the asset
+//  or the save directory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_COMPRESSED_READER_H__
+#define __CU_COMPRESSED_READER_H__
+#include <cugl/io/CUBinaryReader.h>
+#include <cugl/io/CUCompression.h>
+#include <vector>
+
+namespace cugl {
+
+// Forward references
+class JsonValue;
+
+/**
+ * Binary reader for compressed files.
+ *
+ * This class decompresses a file written by {@link CompressedWriter} (or
+ * by {@link compression::compress}) as it reads it.  The file is decoded a
+ * block at a time, and a block is decoded straight into the read buffer
+ * (or into the array of an array read) whenever there is room for it.  So
+ * the only cost over a normal {@link BinaryReader} is the decompression
+ * itself, which is typically much faster than the disk.
+ *
+ * Every read method of {@link BinaryReader} is supported.  In addition,
+ * this reader can read the entire file as a string, or as a JSON value.
+ * Compressed files cannot be memory mapped, as they must be decoded.
+ *
+ * If the file is corrupt, this reader logs an error and stops at the last
+ * valid block.  Hence {@link ready} will return false from that point on.
+ *
+ * By default, this class (and every class in the io package) accesses the
+ * application save directory {@see Application#getSaveDirectory()}.  If you
+ * want to access another directory, you will need to specify an absolute path
+ * for the file name.  Keep in mind that absolute paths are very dangerous on
+ * mobile devices, because they do not have proper file systems.  You should
+ * confine all files to either the asset or the save directory.
+ */
+class CompressedReader : public BinaryReader {
+protected:
+    /** The size of the compressed file in bytes */
+    Sint64 _filesize;
+    /** The cursor into the compressed file */
+    Sint64 _filepos;
+    /** The number of uncompressed bytes decoded so far */
+    Uint64 _decoded;
+    /** The maximum number of uncompressed bytes in a block */
+    Uint32 _blocksize;
+    
+    /** The compressed data of the current block */
+    std::vector<Uint8> _packed;
+    /** The decompressed data of the current block (if it did not fit) */
+    std::vector<Uint8> _block;
+    /** The number of decompressed bytes in the current block */
+    size_t _blocklen;
+    /** The offset of the first unread byte in the current block */
+    size_t _blockoff;
+    
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Returns true if the file was opened and its header is valid
+     *
+     * This method opens the file named by this reader, reads the container
+     * header, and allocates the read buffer.  The file must already be set.
+     *
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the file was opened and its header is valid
+     */
+    bool open(unsigned int capacity);
+    
+    /**
+     * Returns the number of bytes decompressed into the given buffer
+     *
+     * This method decompresses the next block in the file.  If the block
+     * fits in the buffer, it is decompressed directly into the buffer.
+     * Otherwise, it is decompressed into the block buffer of this reader,
+     * and this method returns 0.  If the block is corrupt, this method
+     * returns -1.
+     *
+     * @param dst   The buffer to store the bytes read
+     * @param room  The capacity of the buffer
+     *
+     * @return the number of bytes decompressed into the given buffer
+     */
+    Sint64 readBlock(Uint8* dst, size_t room);
+    
+    /**
+     * Returns the number of bytes decompressed into the given buffer
+     *
+     * This method decompresses as many blocks as necessary to fill the buffer.
+     * Any part of a block that does not fit is saved for the next call.
+     *
+     * @param dst       The buffer to store the bytes read
+     * @param length    The maximum number of bytes to read
+     *
+     * @return the number of bytes decompressed into the given buffer
+     */
+    virtual size_t readStream(void* dst, size_t length) override;
+    
+    
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a compressed reader with no assigned file.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    CompressedReader() : BinaryReader(), _filesize(0), _filepos(0), _decoded(0),
+                         _blocksize(0), _blocklen(0), _blockoff(0) {}
+    
+    /**
+     * Deletes this reader and all of its resources.
+     *
+     * Calls to the destructor will close the file if it is not already closed.
+     */
+    ~CompressedReader() { close(); }
+    
+    /**
+     * Initializes a reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool init(const std::string& file) {
+        return init(Pathname(file));
+    }
+    
+    /**
+     * Initializes a reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool init(const char* file) {
+        return init(Pathname(file));
+    }
+    
+    /**
+     * Initializes a reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool init(const Pathname& file);
+    
+    /**
+     * Initializes a reader for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool init(const std::string& file, unsigned int capacity) {
+        return init(Pathname(file),capacity);
+    }
+    
+    /**
+     * Initializes a reader for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool init(const char* file, unsigned int capacity) {
+        return init(Pathname(file),capacity);
+    }
+    
+    /**
+     * Initializes a reader for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool init(const Pathname& file, unsigned int capacity);
+    
+    /**
+     * Initializes a reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithAsset(const std::string& file) {
+        return initWithAsset(file.c_str());
+    }
+    
+    /**
+     * Initializes a reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithAsset(const char* file);
+    
+    /**
+     * Initializes a reader for the given file with the specified capacity.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file      the relative path to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithAsset(const std::string& file, unsigned int capacity) {
+        return initWithAsset(file.c_str(),capacity);
+    }
+    
+    /**
+     * Initializes a reader for the given file with the specified capacity.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file      the relative path to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithAsset(const char* file, unsigned int capacity);
+    
+    
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated reader for the given file.
+     */
+    static std::shared_ptr<CompressedReader> alloc(const std::string& file) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->init(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated reader for the given file.
+     */
+    static std::shared_ptr<CompressedReader> alloc(const char* file) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->init(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated reader for the given file.
+     */
+    static std::shared_ptr<CompressedReader> alloc(const Pathname& file) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->init(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated reader for the given file with the specified capacity.
+     */
+    static std::shared_ptr<CompressedReader> alloc(const std::string& file, unsigned int capacity) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->init(file,capacity) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated reader for the given file with the specified capacity.
+     */
+    static std::shared_ptr<CompressedReader> alloc(const char* file, unsigned int capacity) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->init(file,capacity) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated reader for the given file with the specified capacity.
+     */
+    static std::shared_ptr<CompressedReader> alloc(const Pathname& file, unsigned int capacity) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->init(file,capacity) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * This allocator assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated reader for the given file.
+     */
+    static std::shared_ptr<CompressedReader> allocWithAsset(const std::string& file) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file.
+     *
+     * The reader will have the default buffer capacity for reading chunks from
+     * the file.
+     *
+     * This allocator assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated reader for the given file.
+     */
+    static std::shared_ptr<CompressedReader> allocWithAsset(const char* file) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file with the specified capacity.
+     *
+     * This allocator assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file      the relative path to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated reader for the given file with the specified capacity.
+     */
+    static std::shared_ptr<CompressedReader> allocWithAsset(const std::string& file, unsigned int capacity) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->initWithAsset(file,capacity) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated reader for the given file with the specified capacity.
+     *
+     * This allocator assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file      the relative path to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated reader for the given file with the specified capacity.
+     */
+    static std::shared_ptr<CompressedReader> allocWithAsset(const char* file, unsigned int capacity) {
+        std::shared_ptr<CompressedReader> result = std::make_shared<CompressedReader>();
+        return (result->initWithAsset(file,capacity) ? result : nullptr);
+    }
+    
+    
+#pragma mark -
+#pragma mark Stream Management
+    /**
+     * Resets the stream back to the beginning
+     *
+     * This allows the stream to be read a second time.  It may even be called
+     * if the stream has been closed.
+     */
+    virtual void reset() override;
+    
+    /**
+     * Closes the stream, releasing all resources
+     *
+     * Any attempts to read from a closed stream will fail.  Calling this method
+     * on a previously closed stream has no effect.
+     */
+    virtual void close() override;
+    
+    
+#pragma mark -
+#pragma mark Bulk Reads
+    /**
+     * Returns the remainder of the file as a string.
+     *
+     * The string is the decompressed data from the current position to the
+     * end of the file.  It is empty if the stream is finished or closed.
+     *
+     * @return the remainder of the file as a string.
+     */
+    std::string readAll();
+    
+    /**
+     * Returns the remainder of the file as a JSON value.
+     *
+     * The remainder of the file must be a single JSON string, such as one
+     * written by {@link CompressedWriter#writeJson}.  This method returns
+     * nullptr if the stream is finished or closed.
+     *
+     * @return the remainder of the file as a JSON value.
+     */
+    std::shared_ptr<JsonValue> readJson();
+};
+
+}
+
+#endif /* __CU_COMPRESSED_READER_H__ */
@@ -0,0 +1,419 @@
+//
+//  CUCompressedWriter.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a binary writer for compressed files.  The data is
+//  compressed a block at a time as it is written, so the writer never needs
+//  more memory than a single block.  Otherwise, it is identical to a normal
+//  BinaryWriter, and all data is marshalled to network order.
+//
+//  The files are in the container format of CUCompression.h, and are read
+//  with CompressedReader.  This writer also has support for JSON, making it
+//  suitable for compressed save files.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.  Keep in mind that
+//  absolute paths are very dangerous on mobile devices, because they do not
+//  have proper file systems.  You should confine all files to either the asset
+//  or the save directory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_COMPRESSED_WRITER_H__
+#define __CU_COMPRESSED_WRITER_H__
+#include <cugl/io/CUBinaryWriter.h>
+#include <cugl/io/CUCompression.h>
+#include <vector>
+
+namespace cugl {
+
+// Forward references
+class JsonValue;
+
+/**
+ * Binary writer for compressed files.
+ *
+ * This class compresses the data as it writes it, in independent blocks of
+ * {@link CU_COMPRESSION_BLOCK} bytes.  Blocks that do not compress are stored
+ * as is, so a compressed file is never more than a few bytes larger than the
+ * original.  The file is in the container format of {@link compression}, and
+ * can be read with a {@link CompressedReader}, or loaded into memory and
+ * decompressed with {@link compression::decompress}.
+ *
+ * Every write method of {@link BinaryWriter} is supported.  In addition,
+ * this writer can write a JSON value, for compressed save files.  The file
+ * is not complete until it is closed, as the header stores the size of the
+ * uncompressed data.
+ *
+ * By default, this class (and every class in the io package) accesses the
+ * application save directory {@see Application#getSaveDirectory()}.  If you
+ * want to access another directory, you will need to specify an absolute path
+ * for the file name.  Keep in mind that absolute paths are very dangerous on
+ * mobile devices, because they do not have proper file systems.  You should
+ * confine all files to either the asset or the save directory.
+ */
+class CompressedWriter : public BinaryWriter {
+protected:
+    /** The uncompressed data of the current block */
+    std::vector<Uint8> _block;
+    /** The number of bytes in the current block */
+    size_t _blocklen;
+    /** The compressed data of the current block */
+    std::vector<Uint8> _packed;
+    /** The number of uncompressed bytes written so far */
+    Uint64 _total;
+    
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Compresses the given block and writes it to the file.
+     *
+     * If the block does not compress, it is stored as is.
+     *
+     * @param data      The uncompressed data
+     * @param length    The number of uncompressed bytes
+     */
+    void writeBlock(const Uint8* data, size_t length);
+    
+    /**
+     * Writes the given bytes to the underlying stream.
+     *
+     * The bytes are added to the current block, which is compressed and
+     * written whenever it is full.
+     *
+     * @param src       The bytes to write
+     * @param length    The number of bytes to write
+     *
+     * @return the number of bytes written to the stream
+     */
+    virtual size_t writeStream(const void* src, size_t length) override;
+    
+    
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a compressed writer with no assigned file.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    CompressedWriter() : BinaryWriter(), _blocklen(0), _total(0) {}
+    
+    /**
+     * Deletes this writer and all of its resources.
+     *
+     * Calls to the destructor will close the file if it is not already closed.
+     */
+    ~CompressedWriter() { close(); }
+    
+    /**
+     * Initializes a writer for the given file.
+     *
+     * The writer will have the default buffer capacity for writing chunks to
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool init(const std::string& file) {
+        return init(Pathname(file));
+    }
+    
+    /**
+     * Initializes a writer for the given file.
+     *
+     * The writer will have the default buffer capacity for writing chunks to
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool init(const char* file) {
+        return init(Pathname(file));
+    }
+
+    /**
+     * Initializes a writer for the given file.
+     *
+     * The writer will have the default buffer capacity for writing chunks to
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool init(const Pathname& file);
+
+    /**
+     * Initializes a writer for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool init(const std::string& file, unsigned int capacity) {
+        return init(Pathname(file),capacity);
+    }
+    
+    /**
+     * Initializes a writer for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool init(const char* file, unsigned int capacity) {
+        return init(Pathname(file),capacity);
+    }
+
+    /**
+     * Initializes a writer for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool init(const Pathname& file, unsigned int capacity);
+    
+    
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated writer for the given file.
+     *
+     * The writer will have the default buffer capacity for writing chunks to
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated writer for the given file.
+     */
+    static std::shared_ptr<CompressedWriter> alloc(const std::string& file) {
+        std::shared_ptr<CompressedWriter> result = std::make_shared<CompressedWriter>();
+        return (result->init(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated writer for the given file.
+     *
+     * The writer will have the default buffer capacity for writing chunks to
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated writer for the given file.
+     */
+    static std::shared_ptr<CompressedWriter> alloc(const char* file) {
+        std::shared_ptr<CompressedWriter> result = std::make_shared<CompressedWriter>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated writer for the given file.
+     *
+     * The writer will have the default buffer capacity for writing chunks to
+     * the file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated writer for the given file.
+     */
+    static std::shared_ptr<CompressedWriter> alloc(const Pathname& file) {
+        std::shared_ptr<CompressedWriter> result = std::make_shared<CompressedWriter>();
+        return (result->init(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated writer for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<CompressedWriter> alloc(const std::string& file, unsigned int capacity) {
+        std::shared_ptr<CompressedWriter> result = std::make_shared<CompressedWriter>();
+        return (result->init(file,capacity) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated writer for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<CompressedWriter> alloc(const char* file, unsigned int capacity) {
+        std::shared_ptr<CompressedWriter> result = std::make_shared<CompressedWriter>();
+        return (result->init(file,capacity) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated writer for the given file with the specified capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<CompressedWriter> alloc(const Pathname& file, unsigned int capacity) {
+        std::shared_ptr<CompressedWriter> result = std::make_shared<CompressedWriter>();
+        return (result->init(file,capacity) ? result : nullptr);
+    }
+    
+    
+#pragma mark -
+#pragma mark Stream Management
+    /**
+     * Closes the stream, releasing all resources
+     *
+     * The contents of the buffer are compressed and flushed before the file
+     * is closed, and the header is updated with the total size.  Any attempts
+     * to write to a closed stream will fail.  Calling this method on a
+     * previously closed stream has no effect.
+     */
+    virtual void close() override;
+    
+    
+#pragma mark -
+#pragma mark JSON Writes
+    /**
+     * Writes a JsonValue to the file.
+     *
+     * The JSON may either be pretty-printed or condensed depending on the
+     * value of format.  By default, we condense the JSON string, as it is
+     * not meant to be read by a person.
+     *
+     * @param json      The JSON value to write
+     * @param format    Whether to pretty-print the JSON string
+     */
+    void writeJson(const std::shared_ptr<JsonValue>& json, bool format=false) {
+        writeJson(json.get(),format);
+    }
+    
+    /**
+     * Writes a JsonValue to the file.
+     *
+     * The JSON may either be pretty-printed or condensed depending on the
+     * value of format.  By default, we condense the JSON string, as it is
+     * not meant to be read by a person.
+     *
+     * @param json      The JSON value to write
+     * @param format    Whether to pretty-print the JSON string
+     */
+    void writeJson(const JsonValue* json, bool format=false);
+};
+
+}
+
+#endif /* __CU_COMPRESSED_WRITER_H__ */
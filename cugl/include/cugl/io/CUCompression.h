@@ -0,0 +1,164 @@
+//
+//  CUCompression.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a fast, dependency-free compression codec for save
+//  data and asset payloads.  The block codec produces the LZ4 block format,
+//  which trades some compression ratio for very fast decompression.  Larger
+//  payloads are split into independent blocks inside a small container, so
+//  that they can be compressed and decompressed in a streaming fashion.
+//
+//  The container format is shared with CompressedWriter and CompressedReader.
+//  So a buffer compressed with these functions can be read as a file by a
+//  CompressedReader, and vice versa.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_COMPRESSION_H__
+#define __CU_COMPRESSION_H__
+#include <SDL/SDL.h>
+#include <string>
+
+/** The magic number at the start of every compressed container */
+#define CU_COMPRESSION_MAGIC    "CULZ"
+/** The size of the compressed container header in bytes */
+#define CU_COMPRESSION_HEADER   16
+/** The size of a compressed block header in bytes */
+#define CU_COMPRESSION_FRAME    8
+/** The default number of uncompressed bytes in a container block */
+#define CU_COMPRESSION_BLOCK    65536
+/** The flag marking a container block as stored without compression */
+#define CU_COMPRESSION_STORED   0x80000000u
+
+namespace cugl {
+
+/**
+ * Functions for compressing and decompressing data.
+ *
+ * The block functions implement the LZ4 block format, without any framing.
+ * The caller must remember the size of the original data.  This is the
+ * fastest option when the sizes are stored elsewhere (such as in the index
+ * of an asset pack).
+ *
+ * The string functions wrap the data in a container.  The container stores
+ * the uncompressed size, and splits the data into independent blocks of at
+ * most {@link CU_COMPRESSION_BLOCK} bytes.  Blocks that do not compress are
+ * stored as is, so the container is never more than a few bytes larger than
+ * the original data.  All sizes in the container are in network order.
+ *
+ * The container layout is a 16 byte header (the magic "CULZ", the block
+ * size, and the uncompressed size), followed by the blocks.  Each block has
+ * an 8 byte header (the uncompressed and compressed sizes), followed by its
+ * data.  The high bit of the compressed size marks a block that is stored
+ * without compression.
+ */
+namespace compression {
+
+#pragma mark Block Functions
+/**
+ * Returns the maximum compressed size of a block of the given size.
+ *
+ * This is the capacity required to guarantee that {@link compressBlock}
+ * succeeds.  Incompressible data grows by less than 0.5%.
+ *
+ * @param size  The uncompressed size
+ *
+ * @return the maximum compressed size of a block of the given size.
+ */
+size_t bound(size_t size);
+
+/**
+ * Returns the size of the data after compressing it into the destination.
+ *
+ * The compressed data is in the LZ4 block format.  This function returns
+ * 0 if the destination capacity is too small, or if the source is larger
+ * than 2 GB.  A capacity of {@link bound} is always large enough.
+ *
+ * @param src       The data to compress
+ * @param size      The number of bytes to compress
+ * @param dst       The buffer to store the compressed data
+ * @param capacity  The capacity of the destination buffer
+ *
+ * @return the size of the data after compressing it into the destination.
+ */
+size_t compressBlock(const void* src, size_t size, void* dst, size_t capacity);
+
+/**
+ * Returns the size of the data after decompressing it into the destination.
+ *
+ * The source must be a complete block in the LZ4 block format.  This
+ * function never reads past the end of the source or writes past the
+ * destination capacity, so it is safe on corrupt data.  It returns -1
+ * if the data is corrupt or the capacity is too small.
+ *
+ * @param src       The data to decompress
+ * @param size      The number of compressed bytes
+ * @param dst       The buffer to store the decompressed data
+ * @param capacity  The capacity of the destination buffer
+ *
+ * @return the size of the data after decompressing it into the destination.
+ */
+Sint64 decompressBlock(const void* src, size_t size, void* dst, size_t capacity);
+
+
+#pragma mark -
+#pragma mark Container Functions
+/**
+ * Returns the given data compressed into a container.
+ *
+ * @param data  The data to compress
+ * @param block The maximum number of uncompressed bytes in a block
+ *
+ * @return the given data compressed into a container.
+ */
+std::string compress(const std::string& data, size_t block=CU_COMPRESSION_BLOCK);
+
+/**
+ * Returns true if the container was decompressed successfully.
+ *
+ * The decompressed data is appended to the result.  If the container is
+ * corrupt, this function returns false, and the contents of result are
+ * unspecified.
+ *
+ * @param data      The container to decompress
+ * @param result    The string to store the decompressed data
+ *
+ * @return true if the container was decompressed successfully.
+ */
+bool decompress(const std::string& data, std::string& result);
+
+/**
+ * Returns true if the given data begins with a container header.
+ *
+ * @param data  The data to check
+ * @param size  The number of bytes of data
+ *
+ * @return true if the given data begins with a container header.
+ */
+bool isCompressed(const void* data, size_t size);
+
+}
+
+}
+
+#endif /* __CU_COMPRESSION_H__ */
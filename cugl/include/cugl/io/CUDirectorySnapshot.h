@@ -0,0 +1,538 @@
+//
+//  CUDirectorySnapshot.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a snapshot of the contents of a directory.  The
+//  snapshot scans the directory (and all of its subdirectories) once, and
+//  caches the type, size, and modification time of every file.  Queries on
+//  the snapshot never access the file system.  This is much faster than
+//  Pathname when you need to query a lot of files over and over again, such
+//  as when looking for modified assets.
+//
+//  Snapshots can be compared to find the files that were added, removed, or
+//  modified in between.  On Linux (and Android), a snapshot can also watch
+//  its directory, so that refreshing it only rescans the subdirectories that
+//  have actually changed.
+//
+//  Because snapshots are intended to be on the stack, we do not provide any
+//  shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_DIRECTORY_SNAPSHOT_H__
+#define __CU_DIRECTORY_SNAPSHOT_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/io/CUPathname.h>
+#include <cugl/util/CUDebug.h>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+namespace cugl {
+
+/**
+ * This class is a cached snapshot of a directory tree.
+ *
+ * A snapshot records every file and directory below its root directory.
+ * The paths are relative to the root, and always use '/' as the separator,
+ * regardless of platform.  The entries are stored in a single compact array,
+ * sorted by path, and the paths themselves are stored in a single string.
+ * So a snapshot of thousands of files requires just a few allocations, and
+ * all queries on it are binary searches.
+ *
+ * A snapshot is never updated automatically.  You must call {@link refresh}
+ * to update it.  By default, this rescans the entire directory tree.  But
+ * if the snapshot is watching its root directory (see {@link watch}), it
+ * only rescans those directories that the operating system reports as
+ * changed.  This is currently only supported on Linux and Android.
+ *
+ * To find the files that changed, copy the snapshot before you refresh it,
+ * and then {@link diff} the two.  A copy never watches the directory.
+ *
+ * As with {@link Pathname}, you should never use a snapshot on the asset
+ * directory ({@see Application#getAssetDirectory()}) of a packaged game.
+ * It is intended for the save directory, or for the asset directory of a
+ * game in development.
+ */
+class DirectorySnapshot {
+public:
+    /**
+     * The types of entries in a snapshot.
+     */
+    enum class Type : Uint8 {
+        /** A regular file */
+        FILE,
+        /** A directory */
+        DIRECTORY,
+        /** Any other type of file (e.g. a device or pipe) */
+        OTHER
+    };
+    
+    /**
+     * An entry in a directory snapshot.
+     *
+     * The path of an entry is stored in the snapshot, and may be accessed
+     * with {@link getPath}.  Sizes are only meaningful for regular files.
+     */
+    struct Entry {
+        /** The offset of the relative path in the snapshot */
+        Uint32 path;
+        /** The offset of the short name in the relative path */
+        Uint32 name;
+        /** The length of the relative path */
+        Uint32 length;
+        /** The type of this entry */
+        Type   type;
+        /** The size of this entry in bytes */
+        Uint64 size;
+        /** The modification time in nanoseconds since the epoch */
+        Uint64 modified;
+    };
+    
+    /**
+     * A difference between two snapshots.
+     *
+     * The indices refer to the entries of the earlier and later snapshots
+     * of a {@link diff}.  An added entry has no earlier index, and a removed
+     * entry has no later index.  The missing index is -1.
+     */
+    struct Change {
+        /** The index of the entry in the earlier snapshot */
+        Sint64 before;
+        /** The index of the entry in the later snapshot */
+        Sint64 after;
+        
+        /**
+         * Returns true if this change is a newly added entry.
+         *
+         * @return true if this change is a newly added entry.
+         */
+        bool isAdded() const { return before < 0; }
+        
+        /**
+         * Returns true if this change is a removed entry.
+         *
+         * @return true if this change is a removed entry.
+         */
+        bool isRemoved() const { return after < 0; }
+        
+        /**
+         * Returns true if this change is a modified entry.
+         *
+         * @return true if this change is a modified entry.
+         */
+        bool isModified() const { return before >= 0 && after >= 0; }
+    };
+    
+private:
+    /** The absolute path of the root directory */
+    std::string _root;
+    /** The entries, sorted by path */
+    std::vector<Entry> _entries;
+    /** The relative paths of the entries (each terminated by a null) */
+    std::string _names;
+    
+    /** The file descriptor for the watch events (-1 if not watching) */
+    int _watcher;
+    /** The relative directory path for each watch */
+    std::unordered_map<int,std::string> _watches;
+    
+#pragma mark Internal Helpers
+    /**
+     * Returns true if the given directory was successfully scanned
+     *
+     * The entries found are appended to the given list, and their paths are
+     * appended to names.  The entries are not sorted.  If recursive is true,
+     * this method also scans every subdirectory (but not symbolic links to
+     * directories).  If this snapshot is watching, it also watches every
+     * directory scanned.
+     *
+     * @param dir       The relative path of the directory
+     * @param recursive Whether to scan the subdirectories
+     * @param entries   The list to store the entries
+     * @param names     The string to store the paths
+     *
+     * @return true if the given directory was successfully scanned
+     */
+    bool scanDirectory(const std::string& dir, bool recursive,
+                       std::vector<Entry>& entries, std::string& names);
+    
+    /**
+     * Sorts the given entries, and makes them the contents of this snapshot
+     *
+     * @param entries   The unsorted entries
+     * @param names     The paths of the entries
+     */
+    void assign(std::vector<Entry>& entries, std::string& names);
+    
+    /**
+     * Watches the given directory for changes
+     *
+     * @param dir       The relative path of the directory
+     */
+    void addWatch(const std::string& dir);
+    
+    /**
+     * Stops watching all directories in the given subtree
+     *
+     * @param dir       The relative path of the subtree root
+     */
+    void removeWatches(const std::string& dir);
+    
+    /**
+     * Returns true if this snapshot was updated from the watch events
+     *
+     * This method only rescans the directories with pending events.  If the
+     * events were lost, or the root directory itself changed, it rescans the
+     * entire tree.
+     *
+     * @return true if this snapshot was updated from the watch events
+     */
+    bool update();
+
+public:
+#pragma mark -
+#pragma mark Constructors
+    /**
+     * Creates an empty snapshot with no root directory.
+     */
+    DirectorySnapshot() : _watcher(-1) {}
+    
+    /**
+     * Creates a snapshot of the given directory.
+     *
+     * The snapshot includes every subdirectory.  If the directory does not
+     * exist, the snapshot is empty.
+     *
+     * @param root  The root directory
+     */
+    explicit DirectorySnapshot(const Pathname& root) : _watcher(-1) {
+        scan(root);
+    }
+    
+    /**
+     * Creates a copy of the given snapshot.
+     *
+     * The copy has the same entries, but it does not watch the directory,
+     * even if the original does.
+     *
+     * @param copy  The snapshot to copy
+     */
+    DirectorySnapshot(const DirectorySnapshot& copy) :
+    _root(copy._root), _entries(copy._entries), _names(copy._names), _watcher(-1) {}
+    
+    /**
+     * Creates a snapshot with the resources of the given one.
+     *
+     * The original snapshot is empty and no longer watches the directory.
+     *
+     * @param other The snapshot to take from
+     */
+    DirectorySnapshot(DirectorySnapshot&& other);
+    
+    /**
+     * Deletes this snapshot, releasing all resources.
+     */
+    ~DirectorySnapshot() { unwatch(); }
+    
+    /**
+     * Sets this snapshot to be a copy of the given one.
+     *
+     * The copy has the same entries, but it does not watch the directory,
+     * even if the original does.  If this snapshot was watching, it stops.
+     *
+     * @param copy  The snapshot to copy
+     *
+     * @return this snapshot, after assignment
+     */
+    DirectorySnapshot& operator=(const DirectorySnapshot& copy);
+    
+    /**
+     * Sets this snapshot to have the resources of the given one.
+     *
+     * The original snapshot is empty and no longer watches the directory.
+     *
+     * @param other The snapshot to take from
+     *
+     * @return this snapshot, after assignment
+     */
+    DirectorySnapshot& operator=(DirectorySnapshot&& other);
+    
+    
+#pragma mark -
+#pragma mark Scanning
+    /**
+     * Returns true if the given directory was scanned successfully.
+     *
+     * This method replaces the contents of this snapshot with the given
+     * directory and all of its subdirectories.  If the snapshot is
+     * watching, it watches the new directory instead.
+     *
+     * @param root  The root directory
+     *
+     * @return true if the given directory was scanned successfully.
+     */
+    bool scan(const Pathname& root);
+    
+    /**
+     * Returns true if the root directory was rescanned successfully.
+     *
+     * This method rescans the entire directory tree, even if the snapshot
+     * is watching the directory.
+     *
+     * @return true if the root directory was rescanned successfully.
+     */
+    bool scan();
+    
+    /**
+     * Returns true if this snapshot may have changed since the last refresh.
+     *
+     * If this snapshot is watching its directory, this method only rescans
+     * the directories that have changed, and returns false if there were no
+     * changes.  Otherwise, it rescans the entire tree and always returns
+     * true.  Either way, this method never misses a change.
+     *
+     * @return true if this snapshot may have changed since the last refresh.
+     */
+    bool refresh();
+    
+    /**
+     * Returns true if this snapshot is now watching its directory.
+     *
+     * A watching snapshot is notified by the operating system whenever a
+     * file in its directory tree changes.  This makes {@link refresh} much
+     * faster for large directories.  Watching is only supported on Linux and
+     * Android, and this method returns false on other platforms.
+     *
+     * Watching requires a scan of the directory tree, and so this method
+     * updates the snapshot as well.
+     *
+     * @return true if this snapshot is now watching its directory.
+     */
+    bool watch();
+    
+    /**
+     * Stops watching the directory of this snapshot.
+     *
+     * This method has no effect if the snapshot is not watching.
+     */
+    void unwatch();
+    
+    /**
+     * Returns true if this snapshot is watching its directory.
+     *
+     * @return true if this snapshot is watching its directory.
+     */
+    bool isWatching() const { return _watcher >= 0; }
+    
+    
+#pragma mark -
+#pragma mark Entries
+    /**
+     * Returns the absolute path of the root directory.
+     *
+     * @return the absolute path of the root directory.
+     */
+    const std::string& getRoot() const { return _root; }
+    
+    /**
+     * Returns the number of entries in this snapshot.
+     *
+     * The root directory is not an entry.
+     *
+     * @return the number of entries in this snapshot.
+     */
+    size_t size() const { return _entries.size(); }
+    
+    /**
+     * Returns the entry at the given index.
+     *
+     * The entries are sorted by path.
+     *
+     * @param index The entry index
+     *
+     * @return the entry at the given index.
+     */
+    const Entry& operator[](size_t index) const {
+        CUAssertLog(index < _entries.size(), "Index %zu is out of bounds", index);
+        return _entries[index];
+    }
+    
+    /**
+     * Returns the path of the entry at the given index.
+     *
+     * The path is relative to the root directory, and uses '/' as the
+     * separator.  The string is owned by this snapshot, and is invalid once
+     * the snapshot changes.
+     *
+     * @param index The entry index
+     *
+     * @return the path of the entry at the given index.
+     */
+    const char* getPath(size_t index) const {
+        return _names.data()+(*this)[index].path;
+    }
+    
+    /**
+     * Returns the short name of the entry at the given index.
+     *
+     * The short name ignores any parent directories.  The string is owned by
+     * this snapshot, and is invalid once the snapshot changes.
+     *
+     * @param index The entry index
+     *
+     * @return the short name of the entry at the given index.
+     */
+    const char* getName(size_t index) const {
+        const Entry& entry = (*this)[index];
+        return _names.data()+entry.path+entry.name;
+    }
+    
+    /**
+     * Returns the index of the entry with the given path.
+     *
+     * The path is relative to the root directory, and must use '/' as the
+     * separator.  This method returns -1 if there is no such entry.
+     *
+     * @param path  The relative path
+     *
+     * @return the index of the entry with the given path.
+     */
+    Sint64 find(const std::string& path) const;
+    
+    
+#pragma mark -
+#pragma mark Path Queries
+    /**
+     * Returns true if the given path was in the directory tree.
+     *
+     * The path is relative to the root directory, and must use '/' as the
+     * separator.  Unlike {@link Pathname#exists}, this method does not access
+     * the file system.
+     *
+     * @param path  The relative path
+     *
+     * @return true if the given path was in the directory tree.
+     */
+    bool exists(const std::string& path) const {
+        return find(path) >= 0;
+    }
+    
+    /**
+     * Returns true if the given path was a directory.
+     *
+     * The path is relative to the root directory, and must use '/' as the
+     * separator.  Unlike {@link Pathname#isDirectory}, this method does not
+     * access the file system.
+     *
+     * @param path  The relative path
+     *
+     * @return true if the given path was a directory.
+     */
+    bool isDirectory(const std::string& path) const;
+    
+    /**
+     * Returns true if the given path was a regular file.
+     *
+     * The path is relative to the root directory, and must use '/' as the
+     * separator.  Unlike {@link Pathname#isFile}, this method does not access
+     * the file system.
+     *
+     * @param path  The relative path
+     *
+     * @return true if the given path was a regular file.
+     */
+    bool isFile(const std::string& path) const;
+    
+    /**
+     * Returns the length of the given file in bytes.
+     *
+     * The path is relative to the root directory, and must use '/' as the
+     * separator.  The value is 0 if the file does not exist.  Unlike
+     * {@link Pathname#length}, this method does not access the file system.
+     *
+     * @param path  The relative path
+     *
+     * @return the length of the given file in bytes.
+     */
+    Uint64 length(const std::string& path) const;
+    
+    /**
+     * Returns the time that the given file was last modified.
+     *
+     * The path is relative to the root directory, and must use '/' as the
+     * separator.  As with {@link Pathname#lastModified}, the value is in
+     * seconds since the epoch, and is 0 if the file does not exist.  However,
+     * this method does not access the file system.
+     *
+     * @param path  The relative path
+     *
+     * @return the time that the given file was last modified.
+     */
+    Uint64 lastModified(const std::string& path) const;
+    
+    
+#pragma mark -
+#pragma mark Comparison
+    /**
+     * Appends the differences from the previous snapshot to the given list.
+     *
+     * The previous snapshot should be an earlier copy of this one.  An entry
+     * is modified if its type, size, or modification time has changed.  The
+     * exception is directories, whose modification time changes whenever a
+     * child is added or removed.  A directory is only modified if its type
+     * has changed.
+     *
+     * This method is a single pass over the two snapshots, and does not
+     * access the file system.  The changes are sorted by path.
+     *
+     * @param previous  The earlier snapshot
+     * @param changes   The list to store the differences
+     */
+    void diff(const DirectorySnapshot& previous, std::vector<Change>& changes) const;
+    
+    /**
+     * Returns the differences from the previous snapshot.
+     *
+     * The previous snapshot should be an earlier copy of this one.  An entry
+     * is modified if its type, size, or modification time has changed.  The
+     * exception is directories, whose modification time changes whenever a
+     * child is added or removed.  A directory is only modified if its type
+     * has changed.
+     *
+     * This method is a single pass over the two snapshots, and does not
+     * access the file system.  The changes are sorted by path.
+     *
+     * @param previous  The earlier snapshot
+     *
+     * @return the differences from the previous snapshot.
+     */
+    std::vector<Change> diff(const DirectorySnapshot& previous) const {
+        std::vector<Change> result;
+        diff(previous,result);
+        return result;
+    }
+};
+
+}
+
+#endif /* __CU_DIRECTORY_SNAPSHOT_H__ */
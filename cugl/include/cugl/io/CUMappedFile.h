@@ -0,0 +1,344 @@
+//
+//  CUMappedFile.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides read-only access to an entire file as a single block
+//  of memory.  Where the platform supports it, the file is memory mapped, so
+//  the operating system pages it in on demand and there are no copies at all.
+//  Packaged assets that are not real files (such as those on Android) fall
+//  back to a single read through SDL_RWops.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_MAPPED_FILE_H__
+#define __CU_MAPPED_FILE_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/io/CUPathname.h>
+#include <string>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark MappedFile
+
+/**
+ * Read-only view of an entire file in memory.
+ *
+ * This class exposes the contents of a file as a span of bytes, given by
+ * {@link #data()} and {@link #size()}.  On platforms with a proper file
+ * system, the file is memory mapped.  This means that opening the file is
+ * (nearly) free, and pages are only loaded when they are touched.  Because
+ * there is no intermediate buffer, readers built on top of this class can
+ * parse the file with pointer arithmetic alone.
+ *
+ * If the file cannot be mapped (for example, an asset packaged inside of an
+ * Android APK), this class falls back to reading the entire file with a
+ * single call to SDL_RWread.  The span is the same in either case, and
+ * {@link #isMapped()} reports which backend is in use.
+ *
+ * The span is valid until the file is disposed.  The memory is read-only;
+ * any attempt to write to it is undefined.
+ */
+class MappedFile {
+protected:
+    /** The (full) path for the file */
+    std::string _name;
+    /** The contents of the file */
+    const char* _data;
+    /** The size of the file in bytes */
+    size_t _size;
+    /** Whether the contents are memory mapped (as opposed to loaded) */
+    bool   _mapped;
+#if defined (__WINDOWS__)
+    /** The file mapping object */
+    HANDLE _handle;
+#endif
+
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Opens the file with the current name, returning true on success
+     *
+     * This method attempts to map the file first, and only reads it through
+     * SDL if the mapping fails (e.g. the file is inside of a packaged
+     * archive).
+     *
+     * @return true if the file was opened
+     */
+    bool open();
+
+    /**
+     * Returns true if the file was successfully mapped into memory.
+     *
+     * @return true if the file was successfully mapped into memory.
+     */
+    bool map();
+
+    /**
+     * Returns true if the file was successfully read into memory.
+     *
+     * This is the fallback for when the file cannot be mapped.
+     *
+     * @return true if the file was successfully read into memory.
+     */
+    bool load();
+    
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a mapped file with no assigned file.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    MappedFile();
+
+    /**
+     * Deletes this mapped file and all of its resources.
+     */
+    ~MappedFile() { dispose(); }
+
+    /**
+     * Unmaps the file, releasing all resources.
+     *
+     * Any pointers into the contents are invalid after this call.
+     */
+    void dispose();
+
+    /**
+     * Initializes a view of the given file.
+     *
+     * If the file is a relative path, this method will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the file is initialized properly, false otherwise.
+     */
+    bool init(const std::string& file) {
+        return init(Pathname(file));
+    }
+
+    /**
+     * Initializes a view of the given file.
+     *
+     * If the file is a relative path, this method will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the file is initialized properly, false otherwise.
+     */
+    bool init(const char* file) {
+        return init(Pathname(file));
+    }
+
+    /**
+     * Initializes a view of the given file.
+     *
+     * If the file is a relative path, this method will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the file is initialized properly, false otherwise.
+     */
+    bool init(const Pathname& file);
+
+    /**
+     * Initializes a view of the given asset.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the file is initialized properly, false otherwise.
+     */
+    bool initWithAsset(const std::string& file) {
+        return initWithAsset(file.c_str());
+    }
+
+    /**
+     * Initializes a view of the given asset.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the file is initialized properly, false otherwise.
+     */
+    bool initWithAsset(const char* file);
+
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated view of the given file.
+     *
+     * If the file is a relative path, this method will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated view of the given file.
+     */
+    static std::shared_ptr<MappedFile> alloc(const std::string& file) {
+        std::shared_ptr<MappedFile> result = std::make_shared<MappedFile>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated view of the given file.
+     *
+     * If the file is a relative path, this method will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated view of the given file.
+     */
+    static std::shared_ptr<MappedFile> alloc(const char* file) {
+        std::shared_ptr<MappedFile> result = std::make_shared<MappedFile>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated view of the given file.
+     *
+     * If the file is a relative path, this method will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated view of the given file.
+     */
+    static std::shared_ptr<MappedFile> alloc(const Pathname& file) {
+        std::shared_ptr<MappedFile> result = std::make_shared<MappedFile>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated view of the given asset.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return nullptr if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated view of the given asset.
+     */
+    static std::shared_ptr<MappedFile> allocWithAsset(const std::string& file) {
+        std::shared_ptr<MappedFile> result = std::make_shared<MappedFile>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated view of the given asset.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return nullptr if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated view of the given asset.
+     */
+    static std::shared_ptr<MappedFile> allocWithAsset(const char* file) {
+        std::shared_ptr<MappedFile> result = std::make_shared<MappedFile>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the (full) path of this file.
+     *
+     * @return the (full) path of this file.
+     */
+    const std::string& getName() const { return _name; }
+
+    /**
+     * Returns the contents of this file.
+     *
+     * The contents are read-only, and are valid until the file is disposed.
+     * This method returns nullptr if the file is empty.
+     *
+     * @return the contents of this file.
+     */
+    const char* data() const { return _data; }
+
+    /**
+     * Returns the size of this file in bytes.
+     *
+     * @return the size of this file in bytes.
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * Returns true if the contents are memory mapped.
+     *
+     * If this method is false, the contents were read into memory with
+     * SDL_RWops instead.  This is the case for packaged assets on some
+     * platforms.
+     *
+     * @return true if the contents are memory mapped.
+     */
+    bool isMapped() const { return _mapped; }
+};
+
+}
+#endif /* __CU_MAPPED_FILE_H__ */
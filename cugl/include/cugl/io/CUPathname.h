@@ -76,6 +76,10 @@ namespace cugl {
  * Instances of Pathname are immutable. Once created, the pathname represented 
  * by a Pathname object will never change.
  *
+ * Every query of a Pathname (e.g. {@link exists} or {@link lastModified})
+ * accesses the file system.  If you need to query a lot of files over and
+ * over again, use a {@link DirectorySnapshot} instead.
+ *
  * IMPORTANT: Never use a Pathname object to refer to an asset in the asset
  * directory ({@see Application#getAssetDirectory()}).  This is not guaranteed
  * to be a proper directory, as the assets may be packaged together in a 
@@ -744,7 +748,7 @@ public:
     /**
      * Returns the length of the file denoted by this pathname.
      *
-     * The value is measured in bytes.
+     * The value is measured in bytes.  It is 0 if the file does not exist.
      *
      * @return the length of the file denoted by this pathname.
      */
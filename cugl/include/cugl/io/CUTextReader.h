@@ -13,6 +13,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  Large files may be memory mapped instead of buffered.  In that case, the
+//  reads are just pointer arithmetic on the mapped file, with no copies until
+//  the data is appended to the result string.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -52,6 +56,7 @@
 #include <SDL/SDL.h>
 #include <string>
 #include "CUPathname.h"
+#include "CUMappedFile.h"
 
 namespace  cugl {
 
@@ -89,8 +94,17 @@ protected:
     char*       _cbuffer;
     /** The buffer capacity */
     Uint32      _capacity;
-    /** The current offset in the read buffer */
-    Sint32      _bufoff;
+    /** The current offset in the read buffer (-1, past any window, if closed) */
+    Sint64      _bufoff;
+    
+    /** The memory mapped file (nullptr if this reader is buffered) */
+    std::shared_ptr<MappedFile> _mapping;
+    /** Whether this reader reads from a memory mapped file */
+    bool        _mapped;
+    /** The readable data (either the storage buffer or the mapped file) */
+    const char* _window;
+    /** The number of bytes of readable data */
+    size_t      _winsize;
 
 #pragma mark -
 #pragma mark Internal Methods
@@ -98,10 +112,20 @@ protected:
      * Fills the storage buffer to capacity
      *
      * This cuts down on the number of reads to the file by allowing us
-     * to read from the file in predefined chunks.
+     * to read from the file in predefined chunks.  It has no effect on a
+     * memory mapped reader, as the entire file is already readable.
      */
     void fill();
     
+    /**
+     * Returns true if the reader successfully attached to its mapped file
+     *
+     * This method makes the entire mapped file the readable data.
+     *
+     * @return true if the reader successfully attached to its mapped file
+     */
+    bool attach();
+    
 #pragma mark -
 #pragma mark Constructors
 public:
@@ -112,7 +136,8 @@ public:
      * the heap, use one of the static constructors instead.
      */
     TextReader() : _name(""), _stream(nullptr), _ssize(-1), _scursor(-1),
-                   _sbuffer(""), _cbuffer(nullptr), _capacity(0), _bufoff(-1) {}
+                   _sbuffer(""), _cbuffer(nullptr), _capacity(0), _bufoff(-1),
+                   _mapping(nullptr), _mapped(false), _window(nullptr), _winsize(0) {}
     
     /**
      * Deletes this reader and all of its resources.
@@ -289,6 +314,102 @@ public:
      */
     bool initWithAsset(const char* file, unsigned int capacity);
     
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  This is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const std::string& file) {
+        return initMapped(Pathname(file));
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  This is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const char* file) {
+        return initMapped(Pathname(file));
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  This is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const Pathname& file);
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  If the asset cannot be mapped (e.g. it is inside of
+     * a packaged archive), the file is read into memory all at once.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMappedWithAsset(const std::string& file) {
+        return initMappedWithAsset(file.c_str());
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  If the asset cannot be mapped (e.g. it is inside of
+     * a packaged archive), the file is read into memory all at once.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMappedWithAsset(const char* file);
+    
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -479,6 +600,111 @@ public:
         std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  This is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<TextReader> allocMapped(const std::string& file) {
+        std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
+        return (result->initMapped(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  This is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<TextReader> allocMapped(const char* file) {
+        std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
+        return (result->initMapped(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  This is the fastest way to read a large file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<TextReader> allocMapped(const Pathname& file) {
+        std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
+        return (result->initMapped(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  If the asset cannot be mapped (e.g. it is inside of
+     * a packaged archive), the file is read into memory all at once.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<TextReader> allocMappedWithAsset(const std::string& file) {
+        std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
+        return (result->initMappedWithAsset(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * A mapped reader has no buffer.  Instead, the entire file is readable
+     * at once, and reading a line (or the whole file) only copies the data
+     * into the result.  If the asset cannot be mapped (e.g. it is inside of
+     * a packaged archive), the file is read into memory all at once.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<TextReader> allocMappedWithAsset(const char* file) {
+        std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
+        return (result->initMappedWithAsset(file) ? result : nullptr);
+    }
 
     
 #pragma mark -
@@ -506,7 +732,14 @@ public:
      *
      * @return true if there is still data to read
      */
-    bool ready() const { return _bufoff < _sbuffer.size() || _scursor < _ssize; }
+    bool ready() const { return (size_t)_bufoff < _winsize || _scursor < _ssize; }
+    
+    /**
+     * Returns true if this reader reads from a memory mapped file.
+     *
+     * @return true if this reader reads from a memory mapped file.
+     */
+    bool isMapped() const { return _mapped; }
     
     
 #pragma mark -
@@ -592,6 +825,21 @@ public:
      */
     std::string& readLine(std::string& data);
     
+    /**
+     * Returns a pointer to the next line of text, without copying it.
+     *
+     * This method is only supported by memory mapped readers.  The line is
+     * not null-terminated; its length (without the newline) is stored in
+     * the argument.  The pointer is valid until the reader is closed.
+     *
+     * If the stream is finished, this method returns nullptr.
+     *
+     * @param length    the length of the line (output)
+     *
+     * @return a pointer to the next line of text, without copying it.
+     */
+    const char* readLineSpan(size_t& length);
+    
     /**
      * Returns the unread remainder of the stream
      *
@@ -29,11 +29,17 @@
 #define __CU_IO_PKG_H__
 
 #include "CUPathname.h"
+#include "CUDirectorySnapshot.h"
 #include "CUTextReader.h"
 #include "CUTextWriter.h"
 #include "CUJsonReader.h"
 #include "CUJsonWriter.h"
 #include "CUBinaryReader.h"
 #include "CUBinaryWriter.h"
+#include "CUMappedFile.h"
+#include "CUAsyncIO.h"
+#include "CUCompression.h"
+#include "CUCompressedReader.h"
+#include "CUCompressedWriter.h"
 
 #endif /* __CU_IO_PKG_H__ */
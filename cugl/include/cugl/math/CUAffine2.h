@@ -823,6 +823,68 @@ public:
      */
     static Rect* transform(const Affine2& aff, const Rect& rect, Rect* dst);
     
+    /**
+     * Transforms the array of points and stores the result in output.
+     *
+     * The points are treated as points, which means that translation is
+     * applied to the result.  This method is much faster than transforming
+     * each point individually on vectorized platforms.  The input and output
+     * may be the same array, but they may not otherwise overlap.
+     *
+     * @param aff       The affine transform.
+     * @param input     The points to transform.
+     * @param output    An array to store the transformed points in.
+     * @param count     The number of points to transform.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec2* transform(const Affine2& aff, const Vec2* input, Vec2* output, size_t count);
+
+    /**
+     * Transforms the strided array of points and stores the result in output.
+     *
+     * Consecutive points are separated by the given number of bytes, instead
+     * of sizeof(Vec2).  This allows the method to transform the positions of
+     * an interleaved vertex array, like those of {@link Vertex2}, without
+     * copying them.  For example, the vertices of a vector verts may be
+     * transformed in place with
+     *
+     *     Affine2::transform(aff,&verts[0].position,sizeof(Vertex2),
+     *                        &verts[0].position,sizeof(Vertex2),verts.size());
+     *
+     * The input and output may be the same array (with the same stride), but
+     * they may not otherwise overlap.
+     *
+     * @param aff       The affine transform.
+     * @param input     The first point to transform.
+     * @param istride   The number of bytes between input points.
+     * @param output    The location to store the first transformed point.
+     * @param ostride   The number of bytes between output points.
+     * @param count     The number of points to transform.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec2* transform(const Affine2& aff, const Vec2* input, size_t istride,
+                           Vec2* output, size_t ostride, size_t count);
+
+    /**
+     * Transforms the points stored as separate coordinate arrays.
+     *
+     * This is the structure-of-arrays layout, where the x and y coordinates
+     * are stored in separate arrays.  It is the fastest layout to transform
+     * on vectorized platforms.  Each output array may be the same as its
+     * input array, but the arrays may not otherwise overlap.
+     *
+     * @param aff       The affine transform.
+     * @param xin       The x-coordinates to transform.
+     * @param yin       The y-coordinates to transform.
+     * @param xout      An array to store the transformed x-coordinates.
+     * @param yout      An array to store the transformed y-coordinates.
+     * @param count     The number of points to transform.
+     */
+    static void transform(const Affine2& aff, const float* xin, const float* yin,
+                          float* xout, float* yout, size_t count);
+    
     /**
      * Returns a copy of the given point transformed.
      *
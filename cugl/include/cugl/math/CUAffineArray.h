@@ -0,0 +1,332 @@
+//
+//  CUAffineArray.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an array of 2d affine transforms in structure-of-arrays
+//  form.  Each of the six coefficients is stored in a separate aligned array,
+//  so that a large number of transforms (such as the local transforms of a
+//  particle system) can be composed several at a time.
+//
+//  An array may either own its storage or be a view of arrays owned by
+//  someone else.  The latter allows an application that already keeps its
+//  data in structure-of-arrays form to use these operations with no copies.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef __CU_AFFINE_ARRAY_H__
+#define __CU_AFFINE_ARRAY_H__
+
+#include <cugl/math/CUMathBase.h>
+#include <cugl/math/CUAffine2.h>
+#include <cugl/util/CUDebug.h>
+#include <vector>
+#include <cstddef>
+
+/** The number of coefficients in an affine transform */
+#define CU_AFFINE_COMPONENTS    6
+
+namespace cugl {
+
+/**
+ * This class is an array of 2d affine transforms in structure-of-arrays form.
+ *
+ * Each transform is broken into six coefficients, which are stored in
+ * separate 16 byte aligned arrays.  The coefficients are ordered so that
+ * component 0, 1 and 2 compute the x-coordinate of a transformed point, and
+ * components 3, 4 and 5 compute the y-coordinate.  In terms of
+ * {@link Affine2}, this order is
+ *
+ *    {m[0], m[1], offset.x, m[2], m[3], offset.y}
+ *
+ * The bulk operations use SIMD instructions to process four transforms at
+ * a time.  They can be combined with {@link Vec2Array#transform} to apply
+ * a different transform to each point.
+ *
+ * Conversion to and from an array of {@link Affine2} is done with the
+ * {@link #load} and {@link #store} methods.  If the application already
+ * stores its transforms in structure-of-arrays form, it can wrap those
+ * arrays in a view with no copy at all.  A view never owns its storage, and
+ * so its size cannot be changed.
+ */
+class AffineArray {
+private:
+    /** The raw allocation (nullptr if this is a view) */
+    void* _raw;
+    /** The coefficient arrays */
+    float* _coeff[CU_AFFINE_COMPONENTS];
+    /** The number of transforms */
+    size_t _size;
+    /** The number of transforms that can be stored without reallocation */
+    size_t _capacity;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty transform array
+     */
+    AffineArray();
+
+    /**
+     * Creates a transform array of the given size.
+     *
+     * All of the transforms are initialized to the identity.
+     *
+     * @param size  The number of transforms
+     */
+    explicit AffineArray(size_t size);
+
+    /**
+     * Creates a transform array with a copy of the given transforms.
+     *
+     * @param transforms    The transforms to copy
+     * @param size          The number of transforms
+     */
+    AffineArray(const Affine2* transforms, size_t size);
+
+    /**
+     * Creates a transform array with a copy of the given transforms.
+     *
+     * @param transforms    The transforms to copy
+     */
+    explicit AffineArray(const std::vector<Affine2>& transforms) :
+    AffineArray(transforms.data(),transforms.size()) {}
+
+    /**
+     * Creates a view of the given coefficient arrays.
+     *
+     * There must be six coefficient arrays, in the order specified in the
+     * class description.  The view does not copy the arrays, and it does
+     * not take ownership of them.  They must outlive this view.  The arrays
+     * do not need to be aligned.  A view cannot be resized.
+     *
+     * @param components    The coefficient arrays
+     * @param size          The number of transforms
+     */
+    AffineArray(float* const* components, size_t size);
+
+    /**
+     * Creates a copy of the given transform array.
+     *
+     * The copy always owns its storage, even if the original is a view.
+     *
+     * @param array The array to copy
+     */
+    AffineArray(const AffineArray& array);
+
+    /**
+     * Creates a transform array with the resources of the original.
+     *
+     * @param array The array to take from
+     */
+    AffineArray(AffineArray&& array);
+
+    /**
+     * Deletes this transform array, releasing all resources.
+     */
+    ~AffineArray();
+
+    /**
+     * Sets this array to be a copy of the given one.
+     *
+     * If this array is a view, the array must have the same size, and the
+     * coefficients are copied into the viewed arrays.
+     *
+     * @param array The array to copy
+     *
+     * @return a reference to this array for chaining.
+     */
+    AffineArray& operator=(const AffineArray& array);
+
+    /**
+     * Sets this array to have the resources of the given one.
+     *
+     * @param array The array to take from
+     *
+     * @return a reference to this array for chaining.
+     */
+    AffineArray& operator=(AffineArray&& array);
+
+
+#pragma mark -
+#pragma mark Storage
+    /**
+     * Returns the number of transforms in this array.
+     *
+     * @return the number of transforms in this array.
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * Returns the number of transforms that can be stored without reallocation.
+     *
+     * @return the number of transforms that can be stored without reallocation.
+     */
+    size_t capacity() const { return _capacity; }
+
+    /**
+     * Returns true if this array is a view of storage owned by someone else.
+     *
+     * @return true if this array is a view of storage owned by someone else.
+     */
+    bool isView() const { return _raw == nullptr && _coeff[0] != nullptr; }
+
+    /**
+     * Ensures that this array can store the given number of transforms.
+     *
+     * This method may not be called on a view.
+     *
+     * @param capacity  The number of transforms to reserve
+     */
+    void reserve(size_t capacity);
+
+    /**
+     * Changes the number of transforms in this array.
+     *
+     * Any new transforms are initialized to the identity.  This method may
+     * not be called on a view.
+     *
+     * @param size  The new number of transforms
+     */
+    void resize(size_t size);
+
+    /**
+     * Removes all transforms from this array.
+     *
+     * This does not release the storage.  This method may not be called on
+     * a view.
+     */
+    void clear() { resize(0); }
+
+    /**
+     * Appends a transform to the end of this array.
+     *
+     * This method may not be called on a view.
+     *
+     * @param transform The transform to append
+     */
+    void append(const Affine2& transform);
+
+
+#pragma mark -
+#pragma mark Access
+    /**
+     * Returns the given coefficient array.
+     *
+     * The coefficients are ordered as specified in the class description.
+     *
+     * @param index The coefficient index (0-5)
+     *
+     * @return the given coefficient array.
+     */
+    float* component(size_t index) {
+        CUAssertLog(index < CU_AFFINE_COMPONENTS, "Component %zu is out of bounds", index);
+        return _coeff[index];
+    }
+
+    /**
+     * Returns the given coefficient array.
+     *
+     * The coefficients are ordered as specified in the class description.
+     *
+     * @param index The coefficient index (0-5)
+     *
+     * @return the given coefficient array.
+     */
+    const float* component(size_t index) const {
+        CUAssertLog(index < CU_AFFINE_COMPONENTS, "Component %zu is out of bounds", index);
+        return _coeff[index];
+    }
+
+    /**
+     * Returns the transform at the given position.
+     *
+     * @param index The transform position
+     *
+     * @return the transform at the given position.
+     */
+    Affine2 get(size_t index) const;
+
+    /**
+     * Sets the transform at the given position.
+     *
+     * @param index     The transform position
+     * @param transform The new transform value
+     */
+    void set(size_t index, const Affine2& transform);
+
+
+#pragma mark -
+#pragma mark Conversion
+    /**
+     * Sets this array to a copy of the given transforms.
+     *
+     * If this array is a view, the number of transforms must be the same as
+     * the size of the view.  Otherwise, the array is resized.
+     *
+     * @param transforms    The transforms to copy
+     * @param size          The number of transforms
+     *
+     * @return a reference to this array for chaining.
+     */
+    AffineArray& load(const Affine2* transforms, size_t size);
+
+    /**
+     * Stores the transforms of this array in the given buffer.
+     *
+     * The buffer must have room for {@link #size} transforms.
+     *
+     * @param transforms    The buffer to store the transforms
+     */
+    void store(Affine2* transforms) const;
+
+
+#pragma mark -
+#pragma mark Composition
+    /**
+     * Multiplies every transform in this array on the right by the given one.
+     *
+     * The result is the same as calling {@link Affine2#multiply} on each
+     * transform.  The given transform is applied after the transforms in
+     * this array.
+     *
+     * @param transform The transform to multiply by
+     *
+     * @return a reference to this array for chaining.
+     */
+    AffineArray& multiply(const Affine2& transform);
+
+    /**
+     * Multiplies each transform in this array on the right by its partner.
+     *
+     * The result is the same as calling {@link Affine2#multiply} on each
+     * pair of transforms.  The given transforms are applied after the
+     * transforms in this array.
+     *
+     * @param array The transforms to multiply by
+     *
+     * @return a reference to this array for chaining.
+     */
+    AffineArray& multiply(const AffineArray& array);
+};
+
+}
+
+#endif /* __CU_AFFINE_ARRAY_H__ */
@@ -0,0 +1,469 @@
+//
+//  CUColor4Array.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an array of colors in structure-of-arrays form.  The
+//  four color channels are stored in separate aligned arrays, so that large
+//  batches of colors (such as the tints of a particle system) can be faded
+//  and blended several colors at a time.
+//
+//  An array may either own its storage or be a view of arrays owned by
+//  someone else.  The latter allows an application that already keeps its
+//  data in structure-of-arrays form to use these operations with no copies.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef __CU_COLOR4_ARRAY_H__
+#define __CU_COLOR4_ARRAY_H__
+
+#include <cugl/math/CUMathBase.h>
+#include <cugl/math/CUColor4.h>
+#include <cugl/util/CUDebug.h>
+#include <vector>
+#include <cstddef>
+
+namespace cugl {
+
+/**
+ * This class is an array of colors in structure-of-arrays form.
+ *
+ * The colors are stored as floats, like {@link Color4f}, but the red, green,
+ * blue and alpha channels are stored in separate 16 byte aligned arrays.
+ * The bulk operations use SIMD instructions to process four colors at a
+ * time.  Each operation has the same semantics as the {@link Color4f}
+ * method of the same name, including which operations are clamped.
+ *
+ * Conversion to and from an array of {@link Color4f} or {@link Color4} is
+ * done with the {@link #load} and {@link #store} methods.  If the
+ * application already stores its colors in structure-of-arrays form, it can
+ * wrap those arrays in a view with no copy at all.  A view never owns its
+ * storage, and so its size cannot be changed.
+ *
+ * Binary operations require that both arrays have the same size.
+ */
+class Color4Array {
+private:
+    /** The raw allocation (nullptr if this is a view) */
+    void* _raw;
+    /** The color channels, in the order r, g, b, a */
+    float* _channel[4];
+    /** The number of colors */
+    size_t _size;
+    /** The number of colors that can be stored without reallocation */
+    size_t _capacity;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty color array
+     */
+    Color4Array();
+
+    /**
+     * Creates a color array of the given size.
+     *
+     * All of the colors are initialized to transparent black.
+     *
+     * @param size  The number of colors
+     */
+    explicit Color4Array(size_t size);
+
+    /**
+     * Creates a color array with a copy of the given colors.
+     *
+     * @param colors    The colors to copy
+     * @param size      The number of colors
+     */
+    Color4Array(const Color4f* colors, size_t size);
+
+    /**
+     * Creates a color array with a copy of the given colors.
+     *
+     * @param colors    The colors to copy
+     */
+    explicit Color4Array(const std::vector<Color4f>& colors) :
+    Color4Array(colors.data(),colors.size()) {}
+
+    /**
+     * Creates a view of the given channel arrays.
+     *
+     * The view does not copy the arrays, and it does not take ownership of
+     * them.  They must outlive this view.  The arrays do not need to be
+     * aligned.  A view cannot be resized.
+     *
+     * @param r     The red channel
+     * @param g     The green channel
+     * @param b     The blue channel
+     * @param a     The alpha channel
+     * @param size  The number of colors
+     */
+    Color4Array(float* r, float* g, float* b, float* a, size_t size);
+
+    /**
+     * Creates a copy of the given color array.
+     *
+     * The copy always owns its storage, even if the original is a view.
+     *
+     * @param array The array to copy
+     */
+    Color4Array(const Color4Array& array);
+
+    /**
+     * Creates a color array with the resources of the original.
+     *
+     * @param array The array to take from
+     */
+    Color4Array(Color4Array&& array);
+
+    /**
+     * Deletes this color array, releasing all resources.
+     */
+    ~Color4Array();
+
+    /**
+     * Sets this array to be a copy of the given one.
+     *
+     * If this array is a view, the array must have the same size, and the
+     * colors are copied into the viewed arrays.
+     *
+     * @param array The array to copy
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& operator=(const Color4Array& array);
+
+    /**
+     * Sets this array to have the resources of the given one.
+     *
+     * @param array The array to take from
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& operator=(Color4Array&& array);
+
+
+#pragma mark -
+#pragma mark Storage
+    /**
+     * Returns the number of colors in this array.
+     *
+     * @return the number of colors in this array.
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * Returns the number of colors that can be stored without reallocation.
+     *
+     * @return the number of colors that can be stored without reallocation.
+     */
+    size_t capacity() const { return _capacity; }
+
+    /**
+     * Returns true if this array is a view of storage owned by someone else.
+     *
+     * @return true if this array is a view of storage owned by someone else.
+     */
+    bool isView() const { return _raw == nullptr && _channel[0] != nullptr; }
+
+    /**
+     * Ensures that this array can store the given number of colors.
+     *
+     * This method may not be called on a view.
+     *
+     * @param capacity  The number of colors to reserve
+     */
+    void reserve(size_t capacity);
+
+    /**
+     * Changes the number of colors in this array.
+     *
+     * Any new colors are initialized to transparent black.  This method may
+     * not be called on a view.
+     *
+     * @param size  The new number of colors
+     */
+    void resize(size_t size);
+
+    /**
+     * Removes all colors from this array.
+     *
+     * This does not release the storage.  This method may not be called on
+     * a view.
+     */
+    void clear() { resize(0); }
+
+    /**
+     * Appends a color to the end of this array.
+     *
+     * This method may not be called on a view.
+     *
+     * @param color The color to append
+     */
+    void append(const Color4f& color);
+
+
+#pragma mark -
+#pragma mark Access
+    /**
+     * Returns the red channel of this array.
+     *
+     * @return the red channel of this array.
+     */
+    float* r() { return _channel[0]; }
+
+    /**
+     * Returns the red channel of this array.
+     *
+     * @return the red channel of this array.
+     */
+    const float* r() const { return _channel[0]; }
+
+    /**
+     * Returns the green channel of this array.
+     *
+     * @return the green channel of this array.
+     */
+    float* g() { return _channel[1]; }
+
+    /**
+     * Returns the green channel of this array.
+     *
+     * @return the green channel of this array.
+     */
+    const float* g() const { return _channel[1]; }
+
+    /**
+     * Returns the blue channel of this array.
+     *
+     * @return the blue channel of this array.
+     */
+    float* b() { return _channel[2]; }
+
+    /**
+     * Returns the blue channel of this array.
+     *
+     * @return the blue channel of this array.
+     */
+    const float* b() const { return _channel[2]; }
+
+    /**
+     * Returns the alpha channel of this array.
+     *
+     * @return the alpha channel of this array.
+     */
+    float* a() { return _channel[3]; }
+
+    /**
+     * Returns the alpha channel of this array.
+     *
+     * @return the alpha channel of this array.
+     */
+    const float* a() const { return _channel[3]; }
+
+    /**
+     * Returns the color at the given position.
+     *
+     * @param index The color position
+     *
+     * @return the color at the given position.
+     */
+    Color4f get(size_t index) const {
+        CUAssertLog(index < _size, "Index %zu is out of bounds", index);
+        return Color4f(_channel[0][index],_channel[1][index],_channel[2][index],_channel[3][index]);
+    }
+
+    /**
+     * Sets the color at the given position.
+     *
+     * @param index The color position
+     * @param color The new color value
+     */
+    void set(size_t index, const Color4f& color) {
+        CUAssertLog(index < _size, "Index %zu is out of bounds", index);
+        _channel[0][index] = color.r;
+        _channel[1][index] = color.g;
+        _channel[2][index] = color.b;
+        _channel[3][index] = color.a;
+    }
+
+
+#pragma mark -
+#pragma mark Conversion
+    /**
+     * Sets this array to a copy of the given colors.
+     *
+     * If this array is a view, the number of colors must be the same as
+     * the size of the view.  Otherwise, the array is resized.
+     *
+     * @param colors    The colors to copy
+     * @param size      The number of colors
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& load(const Color4f* colors, size_t size);
+
+    /**
+     * Sets this array to a copy of the given byte colors.
+     *
+     * If this array is a view, the number of colors must be the same as
+     * the size of the view.  Otherwise, the array is resized.
+     *
+     * @param colors    The colors to copy
+     * @param size      The number of colors
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& load(const Color4* colors, size_t size);
+
+    /**
+     * Stores the colors of this array in the given buffer.
+     *
+     * The buffer must have room for {@link #size} colors.
+     *
+     * @param colors    The buffer to store the colors
+     */
+    void store(Color4f* colors) const;
+
+    /**
+     * Stores the colors of this array in the given buffer of byte colors.
+     *
+     * The colors are clamped to the range [0,1] before conversion.  The
+     * buffer must have room for {@link #size} colors.
+     *
+     * @param colors    The buffer to store the colors
+     */
+    void store(Color4* colors) const;
+
+
+#pragma mark -
+#pragma mark Arithmetic
+    /**
+     * Adds the given colors to this array in place.
+     *
+     * This operation is functionally identical to additive blending. The
+     * addition is clamped so that these remain valid colors.
+     *
+     * @param array The colors to add
+     * @param alpha Whether to add the alpha values (optional)
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& add(const Color4Array& array, bool alpha = false);
+
+    /**
+     * Scales every color in this array by the given factor.
+     *
+     * The scaling is clamped so that these remain valid colors.
+     *
+     * @param s     The scalar to multiply by
+     * @param alpha Whether to scale the alpha values (optional)
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& scale(float s, bool alpha = false);
+
+    /**
+     * Scales every color in this array nonuniformly by the given color.
+     *
+     * This operation is functionally identical to multiplicative blending.
+     *
+     * @param c     The color to scale by
+     * @param alpha Whether to scale the alpha values (optional)
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& scale(const Color4f& c, bool alpha = false);
+
+    /**
+     * Scales each color in this array nonuniformly by its partner.
+     *
+     * This operation is functionally identical to multiplicative blending.
+     *
+     * @param array The colors to scale by
+     * @param alpha Whether to scale the alpha values (optional)
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& scale(const Color4Array& array, bool alpha = false);
+
+    /**
+     * Linearly interpolates this array towards the given one in place.
+     *
+     * If alpha is 0, the colors are unchanged.  If alpha is 1, the colors
+     * are those of other.  If alpha is outside of the range 0 to 1, it is
+     * clamped to the nearest value.
+     *
+     * @param array The colors to interpolate with
+     * @param alpha The interpolation value in 0..1
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& lerp(const Color4Array& array, float alpha);
+
+
+#pragma mark -
+#pragma mark Blending
+    /**
+     * Blends the given colors over the colors of this array.
+     *
+     * The blending is the standard over operation with this array as the
+     * destination. It assumes that the color values are not premultiplied.
+     * Unlike {@link Color4f#blend}, a pair of transparent colors blends to
+     * transparent black instead of dividing by zero.
+     *
+     * @param array The colors to blend with
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& blend(const Color4Array& array);
+
+    /**
+     * Blends the given colors over the colors of this array.
+     *
+     * The blending is the standard over operation with this array as the
+     * destination. It assumes that the colors are premultiplied.
+     *
+     * @param array The colors to blend with
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& blendPre(const Color4Array& array);
+
+    /**
+     * Premultiplies every color in this array with its alpha.
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& premultiply();
+
+    /**
+     * Undoes premultiplication of every color in this array.
+     *
+     * Any color with alpha value 0 is unchanged.
+     *
+     * @return a reference to this array for chaining.
+     */
+    Color4Array& unpremultiply();
+};
+
+}
+
+#endif /* __CU_COLOR4_ARRAY_H__ */
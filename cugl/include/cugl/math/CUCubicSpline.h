@@ -385,6 +385,10 @@ public:
      * a closed spline.  They may only be inserted between two other
      * anchors.
      *
+     * Closing a spline adds a copy of the first anchor to the end if it is
+     * not already there.  Opening a spline keeps that last anchor, so the
+     * curve is unchanged.
+     *
      * @param flag whether the spline is closed
      */
     void setClosed(bool flag);
@@ -787,7 +791,7 @@ protected:
      * @param  rght     vector to store the right bezier
      */
     void subdivide(int segment, float tp, std::vector<Vec2>& left, std::vector<Vec2>& rght) const {
-        subdivide(_points,6*segment,tp,left,rght);
+        subdivide(_points,3*segment,tp,left,rght);
     }
     
     /**
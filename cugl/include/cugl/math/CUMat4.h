@@ -44,9 +44,6 @@
     #define VIMAGE_H
     #include <Accelerate/Accelerate.h>
 #endif
-    #ifdef CU_MATH_VECTOR_SSE
-    #include <xmmintrin.h>
-#endif
 
 #if defined (__WINDOWS__)
 #define NOMAXMIN
@@ -88,6 +85,13 @@ class Affine2;
  * example, suppose we have a translation matrix T and a rotation matrix R.
  * To first rotate an object around the origin and then translate it, you would 
  * multiply the two matrices as RT, with T on the right.
+ *
+ * On SSE platforms, the matrix is stored as a plain float array, and the
+ * vectorized operations use unaligned loads and stores.  Hence there is no
+ * alignment requirement on matrices, and they may be freely stored in
+ * std::vector or as members of classes allocated with std::make_shared.
+ * If AVX is enabled at compile time, matrix multiplication and array
+ * transforms process two columns (or two vectors) at a time.
  */
 class Mat4 {
 #pragma mark Values
@@ -97,11 +101,6 @@ public:
         vFloat col[4];
         float  m[16];
     };
-#elif defined CU_MATH_VECTOR_SSE
-	__declspec(align(16)) union {
-        __m128 col[4];
-        float m[16];
-    };
 #else
     float m[16];
 #endif
@@ -1422,6 +1421,68 @@ public:
      */
     static Rect* transform(const Mat4& mat, const Rect& rect, Rect* dst);
     
+    /**
+     * Transforms the array of points and stores the result in output.
+     *
+     * The points are treated as points, which means that translation is
+     * applied to the result.  This method is much faster than transforming
+     * each point individually on vectorized platforms.  The input and output
+     * may be the same array, but they may not otherwise overlap.
+     *
+     * @param mat       The transform matrix.
+     * @param input     The points to transform.
+     * @param output    An array to store the transformed points in.
+     * @param count     The number of points to transform.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec2* transform(const Mat4& mat, const Vec2* input, Vec2* output, size_t count);
+
+    /**
+     * Transforms the strided array of points and stores the result in output.
+     *
+     * Consecutive points are separated by the given number of bytes, instead
+     * of sizeof(Vec2).  This allows the method to transform the positions of
+     * an interleaved vertex array, like those of {@link Vertex2}, without
+     * copying them.  For example, the vertices of a vector verts may be
+     * transformed in place with
+     *
+     *     Mat4::transform(mat,&verts[0].position,sizeof(Vertex2),
+     *                     &verts[0].position,sizeof(Vertex2),verts.size());
+     *
+     * The input and output may be the same array (with the same stride), but
+     * they may not otherwise overlap.
+     *
+     * @param mat       The transform matrix.
+     * @param input     The first point to transform.
+     * @param istride   The number of bytes between input points.
+     * @param output    The location to store the first transformed point.
+     * @param ostride   The number of bytes between output points.
+     * @param count     The number of points to transform.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec2* transform(const Mat4& mat, const Vec2* input, size_t istride,
+                           Vec2* output, size_t ostride, size_t count);
+
+    /**
+     * Transforms the points stored as separate coordinate arrays.
+     *
+     * This is the structure-of-arrays layout, where the x and y coordinates
+     * are stored in separate arrays.  It is the fastest layout to transform
+     * on vectorized platforms.  Each output array may be the same as its
+     * input array, but the arrays may not otherwise overlap.
+     *
+     * @param mat       The transform matrix.
+     * @param xin       The x-coordinates to transform.
+     * @param yin       The y-coordinates to transform.
+     * @param xout      An array to store the transformed x-coordinates.
+     * @param yout      An array to store the transformed y-coordinates.
+     * @param count     The number of points to transform.
+     */
+    static void transform(const Mat4& mat, const float* xin, const float* yin,
+                          float* xout, float* yout, size_t count);
+    
     /**
      * Transforms the vector by the given matrix, and stores the result in dst.
      *
@@ -1477,6 +1538,24 @@ public:
      * @return A reference to dst for chaining
      */
     static Vec4* transform(const Mat4& mat, const Vec4& vec, Vec4* dst);
+
+    /**
+     * Transforms the array of vectors by the given matrix.
+     *
+     * The vectors are treated as is.  Hence whether or not translation is
+     * applied depends on the value of w.  This method is much faster than
+     * transforming each vector individually on vectorized platforms.  The
+     * input and output may be the same array, but they may not otherwise
+     * overlap.
+     *
+     * @param mat       The transform matrix.
+     * @param input     The vectors to transform.
+     * @param output    An array to store the transformed vectors in.
+     * @param count     The number of vectors to transform.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec4* transform(const Mat4& mat, const Vec4* input, Vec4* output, size_t count);
     
 
 #pragma mark -
@@ -41,10 +41,12 @@
     #define CU_MATH_VECTOR_APPLE
 #elif defined (__IPHONE__)
     #define CU_MATH_VECTOR_IOS
-#elif defined (__SSE__)
-	// TODO: There is apparently an alignment error here
-	// I do not know enough SSE to debug this right now
-    // #define CU_MATH_VECTOR_SSE
+#elif defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1)
+    // The SSE kernels never assume that a matrix is 16-byte aligned
+    #define CU_MATH_VECTOR_SSE
+    #if defined (__AVX__)
+        #define CU_MATH_VECTOR_AVX
+    #endif
 #endif
 
 /**
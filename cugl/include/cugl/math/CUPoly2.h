@@ -44,6 +44,7 @@
 #define __CU_POLY2_H__
 
 #include <vector>
+#include <memory>
 #include "CUVec2.h"
 #include "CURect.h"
 
@@ -78,6 +79,17 @@ class Affine2;
  * polygon if it is incident on any of the lines. Non-solid (or path) polygons 
  * do not support line strips.
  *
+ * Containment queries on large solid polygons use an acceleration grid.  The
+ * grid is a uniform grid over the bounding box, where each cell lists the
+ * triangles that overlap it.  It is built the first time it is needed, and
+ * it is discarded whenever the polygon changes.  Copies of a polygon share
+ * the same grid, as the grid is never modified once it is built.
+ *
+ * Indices are 32-bit values.  Hence a polygon (or a mesh built from one, such
+ * as an extruded path or merged static geometry) may have more than 65,535
+ * vertices, and it can still be submitted to a {@link SpriteBatch} in one
+ * piece.
+ *
  * Generating indices for a Poly2 can be nontrivial.  While this class has
  * standard constructors, allowing the programmer full control, most Poly2
  * objects are created through alternate means.  For simple shapes, like lines,
@@ -143,12 +155,17 @@ private:
     /** The vector of vertices in this polygon */
     std::vector<Vec2> _vertices;
     /** The vector of indices in the triangulation */
-    std::vector<unsigned short> _indices;
+    std::vector<Uint32> _indices;
     /** The bounding box for this polygon */
     Rect _bounds;
     /** The indexing style of polygon (determines normal form) */
     Type _type;
     
+    /** The acceleration structure for containment queries */
+    struct TriangleGrid;
+    /** The containment grid (built on demand, and shared by copies) */
+    mutable std::shared_ptr<const TriangleGrid> _grid;
+    
 #pragma mark -
 #pragma mark Constructors
 public:
@@ -185,7 +202,7 @@ public:
      * @param vertices  The vector of vertices (as Vec2) in this polygon
      * @param indices   The vector of indices for the rendering
      */
-    Poly2(const std::vector<Vec2>& vertices, const std::vector<unsigned short>& indices) {
+    Poly2(const std::vector<Vec2>& vertices, const std::vector<Uint32>& indices) {
         set(vertices, indices);
     }
     
@@ -224,7 +241,7 @@ public:
      * @param vertices  The vector of vertices (as floats) in this polygon
      * @param indices   The vector of indices for the rendering
      */
-    Poly2(const std::vector<float>& vertices, const std::vector<unsigned short>& indices) {
+    Poly2(const std::vector<float>& vertices, const std::vector<Uint32>& indices) {
         set(vertices, indices);
     }
     
@@ -278,7 +295,7 @@ public:
      * @param voffset   The offset in vertices to start the polygon
      * @param ioffset   The offset in indices to start from
      */
-    Poly2(Vec2* vertices,  int vertsize, unsigned short* indices, int indxsize,
+    Poly2(Vec2* vertices,  int vertsize, Uint32* indices, int indxsize,
           int voffset=0, int ioffset=0) {
         set(vertices, vertsize, indices, indxsize, voffset, ioffset);
     }
@@ -307,7 +324,7 @@ public:
      * @param voffset   The offset in vertices to start the polygon
      * @param ioffset   The offset in indices to start from
      */
-    Poly2(float* vertices,  int vertsize, unsigned short* indices, int indxsize,
+    Poly2(float* vertices,  int vertsize, Uint32* indices, int indxsize,
           int voffset=0, int ioffset=0) {
         set(vertices, vertsize, indices, indxsize, voffset, ioffset);
     }
@@ -329,7 +346,7 @@ public:
      */
     Poly2(Poly2&& poly) :
         _vertices(std::move(poly._vertices)), _indices(std::move(poly._indices)),
-        _bounds(std::move(poly._bounds)), _type(poly._type) {}
+        _bounds(std::move(poly._bounds)), _type(poly._type), _grid(std::move(poly._grid)) {}
     
     /**
      * Creates a polygon for the given rectangle.
@@ -477,6 +494,7 @@ public:
         _indices = std::move(other._indices);
         _bounds = std::move(other._bounds);
         _type = other._type;
+        _grid = std::move(other._grid);
         return *this;
     }
 
@@ -525,7 +543,7 @@ public:
      *
      * @return This polygon, returned for chaining
      */
-    Poly2& set(const std::vector<Vec2>& vertices, const std::vector<unsigned short>& indices);
+    Poly2& set(const std::vector<Vec2>& vertices, const std::vector<Uint32>& indices);
     
     /**
      * Sets the polygon to have the given vertices
@@ -568,7 +586,7 @@ public:
      *
      * @return This polygon, returned for chaining
      */
-    Poly2& set(const std::vector<float>& vertices, const std::vector<unsigned short>& indices);
+    Poly2& set(const std::vector<float>& vertices, const std::vector<Uint32>& indices);
     
     /**
      * Sets the polygon to have the given vertices.
@@ -630,7 +648,7 @@ public:
      *
      * @return This polygon, returned for chaining
      */
-    Poly2& set(Vec2* vertices, int vertsize, unsigned short* indices, int indxsize,
+    Poly2& set(Vec2* vertices, int vertsize, Uint32* indices, int indxsize,
                int voffset=0, int ioffset=0);
     
     /**
@@ -661,7 +679,7 @@ public:
      *
      * @return This polygon, returned for chaining
      */
-    Poly2& set(float* vertices, int vertsize, unsigned short* indices, int indxsize,
+    Poly2& set(float* vertices, int vertsize, Uint32* indices, int indxsize,
                int voffset=0, int ioffset=0) {
         return set((Vec2*)vertices, vertsize/2, indices, indxsize, voffset/2, ioffset);
     }
@@ -710,6 +728,7 @@ public:
         _indices.clear();
         _type = Type::UNDEFINED;
         _bounds = Rect::ZERO;
+        _grid = nullptr;
         return *this;
     }
 
@@ -734,7 +753,7 @@ public:
      *
      * @return This polygon, returned for chaining
      */
-    Poly2& setIndices(const std::vector<unsigned short>& indices);
+    Poly2& setIndices(const std::vector<Uint32>& indices);
     
     /**
      * Sets the indices for this polygon to the ones given.
@@ -759,7 +778,7 @@ public:
      *
      * @return This polygon, returned for chaining
      */
-    Poly2& setIndices(unsigned short* indices, int indxsize, int ioffset=0);
+    Poly2& setIndices(Uint32* indices, int indxsize, int ioffset=0);
     
     /**
      * Returns true if the indices are in the proper normal form.
@@ -824,11 +843,13 @@ public:
      * intended to allow minor distortions to the polygon without changing
      * the underlying mesh.
      *
+     * As the vertex may change, this method discards any containment grid.
+     *
      * @param index  The attribute index
      *
      * @return a reference to the attribute at the given index.
      */
-    Vec2& at(int index) { return _vertices.at(index); }
+    Vec2& at(int index) { _grid = nullptr; return _vertices.at(index); }
 
     /**
      * Returns the list of vertices
@@ -848,7 +869,7 @@ public:
      *
      * @return a reference to the vertex array
      */
-    const std::vector<unsigned short>& getIndices() const  { return _indices; }
+    const std::vector<Uint32>& getIndices() const  { return _indices; }
 
     /**
      * Returns a reference to list of indices.
@@ -856,11 +877,12 @@ public:
      * This accessor will not permit any changes to the index array.  To change
      * the array, you must change the polygon via a set() method.
      *
-     * This non-const version of the method is used by triangulators.
+     * This non-const version of the method is used by triangulators.  As the
+     * indices may change, it discards any containment grid.
      *
      * @return a reference to the vertex array
      */
-    std::vector<unsigned short>& getIndices()  { return _indices; }
+    std::vector<Uint32>& getIndices()  { _grid = nullptr; return _indices; }
 
     /**
      * Returns the bounding box for the polygon
@@ -904,7 +926,7 @@ public:
      *
      * @param type  The type of this polygon.
      */
-    void setType(Type type) { _type = type; }
+    void setType(Type type) { _type = type; _grid = nullptr; }
     
     
 #pragma mark -
@@ -1199,12 +1221,34 @@ public:
      * it checks for containment within the associated triangles.  It includes
      * points on the polygon border.
      *
+     * If the polygon has many triangles, this method builds a containment grid
+     * the first time that it is called.  Later queries only test the triangles
+     * in the cell of the point.  Because the grid is built on demand, the first
+     * query is not thread safe, even though this method is const.
+     *
      * @param  point    The point to test
      *
      * @return true if this polygon contains the given point.
      */
     bool contains(const Vec2& point) const;
     
+    /**
+     * Tests each of the given points for containment in this polygon.
+     *
+     * This method is the same as calling {@link contains} on each point, and
+     * storing the result in the corresponding position of results.  However,
+     * it always uses the containment grid, building it if necessary.  Hence it
+     * is the preferred way to test many points at once.  As with the single
+     * point version, the first query is not thread safe.
+     *
+     * @param  points   The points to test
+     * @param  results  The array to store the results
+     * @param  count    The number of points to test
+     *
+     * @return the number of points contained in this polygon.
+     */
+    size_t contains(const Vec2* points, bool* results, size_t count) const;
+    
     /**
      * Returns true if the given point is on the boundary of this polygon.
      *
@@ -1231,7 +1275,8 @@ private:
      * Compute the type for this polygon.
      *
      * The bounding box is the minimal rectangle that contains all of the vertices in
-     * this polygon.  It is recomputed whenever the vertices are set.
+     * this polygon.  It is recomputed whenever the vertices are set.  As this
+     * means the vertices have changed, it also discards any containment grid.
      */
     void computeBounds();
 
@@ -1259,13 +1304,24 @@ private:
      *
      * @return the barycentric coordinates for a point relative to a triangle.
      */
-    Vec3 getBarycentric(const Vec2& point, unsigned short index) const;
+    Vec3 getBarycentric(const Vec2& point, Uint32 index) const;
+    
+    /**
+     * Returns the containment grid for this polygon, building it if necessary.
+     *
+     * This method is not defined if the polygon is not SOLID.
+     *
+     * @return the containment grid for this polygon
+     */
+    const TriangleGrid* getGrid() const;
 
     // Make friends with the factory classes
     friend class CubicSplineApproximator;
     friend class SimpleTriangulator;
+    friend class MonotoneTriangulator;
     friend class PathOutliner;
     friend class PathExtruder;
+    friend class PolyClipper;
 };
 
 }
@@ -238,7 +238,31 @@ public:
     float normalize();
     
     /**
-     * Computes the roots of this polynomial using Bairstow's method
+     * Computes the roots of this polynomial
+     *
+     * Polynomials of degree at most four are solved exactly using the
+     * closed-form solutions in {@link SmallPolynomial}. Higher degree
+     * polynomials are factored with Bairstow's method until the remaining
+     * factor has degree four, which is then solved exactly.  The value
+     * epsilon is the error tolerance for Bairstow's method.
+     *
+     * The roots are stored in the provided vector.  When complete, the vector
+     * will have degree many elements.  If any root is complex, this method will
+     * have added NaN in its place.
+     *
+     * It is possible for Bairstow's method to fail, which is why this method
+     * has a return value.  This method always succeeds for polynomials of
+     * degree at most four.
+     *
+     * @param  roots    the vector to store the root values
+     * @param  epsilon  the error tolerance for the root values
+     *
+     * @return true if the root finding completes successfully
+     */
+    bool roots(vector<float>& roots, float epsilon=CU_MATH_EPSILON) const;
+    
+    /**
+     * Computes the roots of this polynomial using only Bairstow's method
      *
      * Bairstow's method is an approximate root finding technique.  The value
      * epsilon is the error value for all of the roots.  A good description
@@ -246,6 +270,10 @@ public:
      *
      *    http://nptel.ac.in/courses/122104019/numerical-analysis/Rathish-kumar/ratish-1/f3node9.html
      *
+     * Unlike {@link #roots}, this method does not use the closed-form
+     * solutions for small degree.  It is slower and less accurate, and is
+     * provided for comparison purposes.
+     *
      * The roots are stored in the provided vector.  When complete, the vector
      * will have degree many elements.  If any root is complex, this method will
      * have added NaN in its place.
@@ -258,7 +286,7 @@ public:
      *
      * @return true if Bairstow's method completes successfully
      */
-    bool roots(vector<float>& roots, float epsilon=CU_MATH_EPSILON) const;
+    bool bairstowRoots(vector<float>& roots, float epsilon=CU_MATH_EPSILON) const;
     
 #pragma mark -
 #pragma mark Setters
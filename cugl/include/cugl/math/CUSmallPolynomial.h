@@ -0,0 +1,308 @@
+//
+//  CUSmallPolynomial.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a fixed-capacity polynomial of degree at most four.
+//  Unlike Polynomial, this class never allocates memory, and it finds its
+//  roots with closed-form solvers instead of iteration.  It is designed for
+//  the inner loops of curve math, such as bezier easing and intersection,
+//  where the polynomials are small and there are a lot of them.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+
+#ifndef __CU_SMALL_POLYNOMIAL_H__
+#define __CU_SMALL_POLYNOMIAL_H__
+
+#include <cugl/math/CUMathBase.h>
+#include <cugl/util/CUDebug.h>
+#include <cstddef>
+
+/** The maximum degree of a small polynomial */
+#define CU_SMALL_POLY_DEGREE    4
+
+namespace cugl {
+
+// Forward references
+class Polynomial;
+
+/**
+ * This class represents a polynomial of degree at most four.
+ *
+ * Like {@link Polynomial}, the coefficients are stored from highest degree
+ * to constant.  For example, the coefficients [1, -1, 2, -3] are equivalent
+ * to
+ *
+ *    1*x^3  - 1*x^2  + 2*x - 3
+ *
+ * However, the coefficients are stored in a fixed-size array, so this class
+ * never allocates memory.  In addition, the roots are computed with the
+ * closed-form solutions (the quadratic formula, Cardano's method, and
+ * Ferrari's method) in double precision, and are then polished with a step
+ * of Newton's method.  This is both faster and more reliable than the
+ * Bairstow iteration used by {@link Polynomial}.
+ *
+ * The static solvers are available separately for when you do not want to
+ * construct a polynomial at all.  There is also a batched solver for
+ * processing a large number of cubics at once.
+ */
+class SmallPolynomial {
+private:
+    /** The coefficients, from highest degree to constant */
+    float _coeffs[CU_SMALL_POLY_DEGREE+1];
+    /** The degree of this polynomial */
+    int _degree;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a zero polynomial
+     */
+    SmallPolynomial() : _degree(0) {
+        _coeffs[0] = 0;
+    }
+
+    /**
+     * Creates a polynomial with the given coefficients.
+     *
+     * The coefficients are specified from highest degree to constant, and
+     * there must be degree+1 of them.  The degree may not exceed four.
+     *
+     * @param coeffs    The polynomial coefficients
+     * @param degree    The polynomial degree
+     */
+    SmallPolynomial(const float* coeffs, int degree) {
+        set(coeffs,degree);
+    }
+
+    /**
+     * Creates a copy of the given polynomial.
+     *
+     * The polynomial must have degree at most four.
+     *
+     * @param poly      The polynomial to copy
+     */
+    explicit SmallPolynomial(const Polynomial& poly) {
+        set(poly);
+    }
+
+
+#pragma mark -
+#pragma mark Setters
+    /**
+     * Sets the coefficients of this polynomial.
+     *
+     * The coefficients are specified from highest degree to constant, and
+     * there must be degree+1 of them.  The degree may not exceed four.
+     *
+     * @param coeffs    The polynomial coefficients
+     * @param degree    The polynomial degree
+     *
+     * @return this polynomial, after modification.
+     */
+    SmallPolynomial& set(const float* coeffs, int degree);
+
+    /**
+     * Sets this polynomial to be a copy of the given one.
+     *
+     * The polynomial must have degree at most four.
+     *
+     * @param poly      The polynomial to copy
+     *
+     * @return this polynomial, after modification.
+     */
+    SmallPolynomial& set(const Polynomial& poly);
+
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the degree of this polynomial.
+     *
+     * @return the degree of this polynomial.
+     */
+    int degree() const { return _degree; }
+
+    /**
+     * Returns a reference to the coefficient at the given position.
+     *
+     * Position 0 is the coefficient of the highest degree term.
+     *
+     * @param pos   The coefficient position
+     *
+     * @return a reference to the coefficient at the given position.
+     */
+    float& operator[](int pos) {
+        CUAssertLog(pos >= 0 && pos <= _degree, "Position %d is out of bounds", pos);
+        return _coeffs[pos];
+    }
+
+    /**
+     * Returns the coefficient at the given position.
+     *
+     * Position 0 is the coefficient of the highest degree term.
+     *
+     * @param pos   The coefficient position
+     *
+     * @return the coefficient at the given position.
+     */
+    float operator[](int pos) const {
+        CUAssertLog(pos >= 0 && pos <= _degree, "Position %d is out of bounds", pos);
+        return _coeffs[pos];
+    }
+
+    /**
+     * Returns the coefficients of this polynomial.
+     *
+     * There are degree+1 coefficients, from highest degree to constant.
+     *
+     * @return the coefficients of this polynomial.
+     */
+    const float* data() const { return _coeffs; }
+
+
+#pragma mark -
+#pragma mark Calculation Methods
+    /**
+     * Returns the evaluation of the polynomial on the given value.
+     *
+     * @param value The value to plug in for the polynomial variable
+     *
+     * @return the evaluation of the polynomial on the given value.
+     */
+    float evaluate(float value) const {
+        float accum = _coeffs[0];
+        for(int ii = 1; ii <= _degree; ii++) {
+            accum = accum*value+_coeffs[ii];
+        }
+        return accum;
+    }
+
+    /**
+     * Returns the derivative of this polynomial
+     *
+     * The derivative has degree one less than original, unless it the
+     * original has degree 0.  In that case, the derivative is 0.
+     *
+     * @return the derivative of this polynomial
+     */
+    SmallPolynomial derivative() const;
+
+    /**
+     * Computes the real roots of this polynomial.
+     *
+     * The roots are stored in ascending order in the given array, which must
+     * have room for degree() elements.  Repeated roots are stored once for
+     * each multiplicity.  Leading zero coefficients are ignored, and the zero
+     * polynomial has no roots.
+     *
+     * @param roots The array to store the roots
+     *
+     * @return the number of real roots found
+     */
+    int roots(float* roots) const;
+
+    /**
+     * Returns a Polynomial equivalent to this one.
+     *
+     * @return a Polynomial equivalent to this one.
+     */
+    operator Polynomial() const;
+
+
+#pragma mark -
+#pragma mark Static Solvers
+    /**
+     * Computes the real roots of the polynomial ax^2 + bx + c.
+     *
+     * The roots are stored in ascending order in the given array, which must
+     * have room for two elements.  A double root is stored twice.  If a is
+     * zero, this solves the linear equation instead.
+     *
+     * @param a     The quadratic coefficient
+     * @param b     The linear coefficient
+     * @param c     The constant coefficient
+     * @param roots The array to store the roots
+     *
+     * @return the number of real roots found
+     */
+    static int solveQuadratic(float a, float b, float c, float* roots);
+
+    /**
+     * Computes the real roots of the polynomial ax^3 + bx^2 + cx + d.
+     *
+     * The roots are stored in ascending order in the given array, which must
+     * have room for three elements.  Repeated roots are stored once for each
+     * multiplicity.  If a is zero, this solves the quadratic instead.
+     *
+     * @param a     The cubic coefficient
+     * @param b     The quadratic coefficient
+     * @param c     The linear coefficient
+     * @param d     The constant coefficient
+     * @param roots The array to store the roots
+     *
+     * @return the number of real roots found
+     */
+    static int solveCubic(float a, float b, float c, float d, float* roots);
+
+    /**
+     * Computes the real roots of the polynomial ax^4 + bx^3 + cx^2 + dx + e.
+     *
+     * The roots are stored in ascending order in the given array, which must
+     * have room for four elements.  Repeated roots are stored once for each
+     * multiplicity.  If a is zero, this solves the cubic instead.
+     *
+     * @param a     The quartic coefficient
+     * @param b     The cubic coefficient
+     * @param c     The quadratic coefficient
+     * @param d     The linear coefficient
+     * @param e     The constant coefficient
+     * @param roots The array to store the roots
+     *
+     * @return the number of real roots found
+     */
+    static int solveQuartic(float a, float b, float c, float d, float e, float* roots);
+
+    /**
+     * Computes the real roots of many cubics at once.
+     *
+     * The array coeffs stores the cubics as consecutive groups of four
+     * coefficients, each from highest degree to constant.  The roots of
+     * cubic i are stored (in ascending order) at positions 3i to 3i+2 of
+     * the array roots, and the number of roots is stored in sizes[i].
+     *
+     * This method is designed for solving easing curves and intersections
+     * in bulk.  The cubics are solved in a single pass with no allocation.
+     *
+     * @param coeffs    The cubic coefficients (4*count elements)
+     * @param count     The number of cubics
+     * @param roots     The array to store the roots (3*count elements)
+     * @param sizes     The array to store the number of roots (count elements)
+     */
+    static void solveCubics(const float* coeffs, size_t count, float* roots, int* sizes);
+};
+
+}
+#endif /* __CU_SMALL_POLYNOMIAL_H__ */
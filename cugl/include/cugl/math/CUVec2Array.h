@@ -0,0 +1,515 @@
+//
+//  CUVec2Array.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an array of 2d vectors in structure-of-arrays form.
+//  The x and y coordinates are stored in separate aligned arrays, so that
+//  operations on the entire array (such as integrating positions in a
+//  particle system) can be processed several vectors at a time.
+//
+//  An array may either own its storage or be a view of arrays owned by
+//  someone else.  The latter allows an application that already keeps its
+//  data in structure-of-arrays form to use these operations with no copies.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef __CU_VEC2_ARRAY_H__
+#define __CU_VEC2_ARRAY_H__
+
+#include <cugl/math/CUMathBase.h>
+#include <cugl/math/CUVec2.h>
+#include <cugl/util/CUDebug.h>
+#include <vector>
+#include <cstddef>
+
+namespace cugl {
+
+// Forward references
+class Affine2;
+class AffineArray;
+
+/**
+ * This class is an array of 2d vectors in structure-of-arrays form.
+ *
+ * Most of the math classes in CUGL are designed to live on the stack, and
+ * an array of {@link Vec2} stores the coordinates interleaved.  That is the
+ * right layout for passing to OpenGL, but it is the wrong layout for
+ * processing thousands of vectors at once.  This class stores the x and y
+ * coordinates in separate 16 byte aligned arrays, and the bulk operations
+ * use SIMD instructions to process four vectors at a time.
+ *
+ * Conversion to and from an array of {@link Vec2} (or any interleaved
+ * layout, such as the positions of a vertex buffer) is done with the
+ * {@link #load} and {@link #store} methods.  These methods deinterleave
+ * in vector registers, and are much faster than copying one vector at a
+ * time.  If the application already stores its data in structure-of-arrays
+ * form, it can wrap those arrays in a view with no copy at all. A view never
+ * owns its storage, and so its size cannot be changed.
+ *
+ * Binary operations require that both arrays have the same size.  Unlike
+ * {@link Vec2}, the operations here modify the array in place and do not
+ * have an operator form.  This is to make the cost of each operation clear.
+ */
+class Vec2Array {
+private:
+    /** The raw allocation (nullptr if this is a view) */
+    void* _raw;
+    /** The x-coordinates */
+    float* _x;
+    /** The y-coordinates */
+    float* _y;
+    /** The number of vectors */
+    size_t _size;
+    /** The number of vectors that can be stored without reallocation */
+    size_t _capacity;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty vector array
+     */
+    Vec2Array() : _raw(nullptr), _x(nullptr), _y(nullptr), _size(0), _capacity(0) {}
+
+    /**
+     * Creates a vector array of the given size.
+     *
+     * All of the vectors are initialized to zero.
+     *
+     * @param size  The number of vectors
+     */
+    explicit Vec2Array(size_t size);
+
+    /**
+     * Creates a vector array with a copy of the given vectors.
+     *
+     * @param vecs  The vectors to copy
+     * @param size  The number of vectors
+     */
+    Vec2Array(const Vec2* vecs, size_t size);
+
+    /**
+     * Creates a vector array with a copy of the given vectors.
+     *
+     * @param vecs  The vectors to copy
+     */
+    explicit Vec2Array(const std::vector<Vec2>& vecs) : Vec2Array(vecs.data(),vecs.size()) {}
+
+    /**
+     * Creates a view of the given coordinate arrays.
+     *
+     * The view does not copy the arrays, and it does not take ownership of
+     * them.  They must outlive this view.  The arrays do not need to be
+     * aligned.  A view cannot be resized.
+     *
+     * @param x     The x-coordinates
+     * @param y     The y-coordinates
+     * @param size  The number of vectors
+     */
+    Vec2Array(float* x, float* y, size_t size) :
+    _raw(nullptr), _x(x), _y(y), _size(size), _capacity(size) {}
+
+    /**
+     * Creates a copy of the given vector array.
+     *
+     * The copy always owns its storage, even if the original is a view.
+     *
+     * @param array The array to copy
+     */
+    Vec2Array(const Vec2Array& array);
+
+    /**
+     * Creates a vector array with the resources of the original.
+     *
+     * @param array The array to take from
+     */
+    Vec2Array(Vec2Array&& array);
+
+    /**
+     * Deletes this vector array, releasing all resources.
+     */
+    ~Vec2Array();
+
+    /**
+     * Sets this array to be a copy of the given one.
+     *
+     * If this array is a view, the array must have the same size, and the
+     * coordinates are copied into the viewed arrays.
+     *
+     * @param array The array to copy
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& operator=(const Vec2Array& array);
+
+    /**
+     * Sets this array to have the resources of the given one.
+     *
+     * @param array The array to take from
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& operator=(Vec2Array&& array);
+
+
+#pragma mark -
+#pragma mark Storage
+    /**
+     * Returns the number of vectors in this array.
+     *
+     * @return the number of vectors in this array.
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * Returns the number of vectors that can be stored without reallocation.
+     *
+     * @return the number of vectors that can be stored without reallocation.
+     */
+    size_t capacity() const { return _capacity; }
+
+    /**
+     * Returns true if this array is a view of storage owned by someone else.
+     *
+     * @return true if this array is a view of storage owned by someone else.
+     */
+    bool isView() const { return _raw == nullptr && _x != nullptr; }
+
+    /**
+     * Ensures that this array can store the given number of vectors.
+     *
+     * This method may not be called on a view.
+     *
+     * @param capacity  The number of vectors to reserve
+     */
+    void reserve(size_t capacity);
+
+    /**
+     * Changes the number of vectors in this array.
+     *
+     * Any new vectors are initialized to zero.  This method may not be
+     * called on a view.
+     *
+     * @param size  The new number of vectors
+     */
+    void resize(size_t size);
+
+    /**
+     * Removes all vectors from this array.
+     *
+     * This does not release the storage.  This method may not be called on
+     * a view.
+     */
+    void clear() { resize(0); }
+
+    /**
+     * Appends a vector to the end of this array.
+     *
+     * This method may not be called on a view.
+     *
+     * @param v     The vector to append
+     */
+    void append(const Vec2& v);
+
+
+#pragma mark -
+#pragma mark Access
+    /**
+     * Returns the x-coordinates of this array.
+     *
+     * @return the x-coordinates of this array.
+     */
+    float* x() { return _x; }
+
+    /**
+     * Returns the x-coordinates of this array.
+     *
+     * @return the x-coordinates of this array.
+     */
+    const float* x() const { return _x; }
+
+    /**
+     * Returns the y-coordinates of this array.
+     *
+     * @return the y-coordinates of this array.
+     */
+    float* y() { return _y; }
+
+    /**
+     * Returns the y-coordinates of this array.
+     *
+     * @return the y-coordinates of this array.
+     */
+    const float* y() const { return _y; }
+
+    /**
+     * Returns the vector at the given position.
+     *
+     * @param index The vector position
+     *
+     * @return the vector at the given position.
+     */
+    Vec2 get(size_t index) const {
+        CUAssertLog(index < _size, "Index %zu is out of bounds", index);
+        return Vec2(_x[index],_y[index]);
+    }
+
+    /**
+     * Sets the vector at the given position.
+     *
+     * @param index The vector position
+     * @param v     The new vector value
+     */
+    void set(size_t index, const Vec2& v) {
+        CUAssertLog(index < _size, "Index %zu is out of bounds", index);
+        _x[index] = v.x;
+        _y[index] = v.y;
+    }
+
+
+#pragma mark -
+#pragma mark Conversion
+    /**
+     * Sets this array to a copy of the given vectors.
+     *
+     * If this array is a view, the number of vectors must be the same as
+     * the size of the view.  Otherwise, the array is resized.
+     *
+     * @param vecs  The vectors to copy
+     * @param size  The number of vectors
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& load(const Vec2* vecs, size_t size) {
+        return load((const float*)vecs,size,2);
+    }
+
+    /**
+     * Sets this array to a copy of the given interleaved coordinates.
+     *
+     * The stride is the number of floats between consecutive vectors, and
+     * must be at least 2.  This allows the array to load the positions
+     * directly from a vertex buffer.  If this array is a view, the number
+     * of vectors must be the same as the size of the view.  Otherwise, the
+     * array is resized.
+     *
+     * @param data      The interleaved coordinates
+     * @param size      The number of vectors
+     * @param stride    The number of floats between consecutive vectors
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& load(const float* data, size_t size, size_t stride);
+
+    /**
+     * Stores the vectors of this array in the given buffer.
+     *
+     * The buffer must have room for {@link #size} vectors.
+     *
+     * @param vecs  The buffer to store the vectors
+     */
+    void store(Vec2* vecs) const {
+        store((float*)vecs,2);
+    }
+
+    /**
+     * Stores the vectors of this array as interleaved coordinates.
+     *
+     * The stride is the number of floats between consecutive vectors, and
+     * must be at least 2.  Any floats between vectors are left unchanged,
+     * so this method can write positions directly into a vertex buffer.
+     *
+     * @param data      The buffer to store the coordinates
+     * @param stride    The number of floats between consecutive vectors
+     */
+    void store(float* data, size_t stride) const;
+
+
+#pragma mark -
+#pragma mark Arithmetic
+    /**
+     * Adds the given array to this one in place.
+     *
+     * @param array The array to add
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& add(const Vec2Array& array);
+
+    /**
+     * Adds the given vector to every vector in this array.
+     *
+     * @param v     The vector to add
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& add(const Vec2& v);
+
+    /**
+     * Subtracts the given array from this one in place.
+     *
+     * @param array The array to subtract
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& subtract(const Vec2Array& array);
+
+    /**
+     * Subtracts the given vector from every vector in this array.
+     *
+     * @param v     The vector to subtract
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& subtract(const Vec2& v) {
+        return add(-v);
+    }
+
+    /**
+     * Scales every vector in this array uniformly.
+     *
+     * @param s     The scalar
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& scale(float s);
+
+    /**
+     * Scales each vector in this array by its own scalar.
+     *
+     * There must be one scalar for each vector in this array.  This is
+     * useful for applying per-particle drag.
+     *
+     * @param s     The scalars
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& scale(const float* s);
+
+    /**
+     * Adds the given array, scaled by s, to this one in place.
+     *
+     * This is the update step for explicit integration, as in
+     * positions.addScaled(velocities,dt).
+     *
+     * @param array The array to add
+     * @param s     The scalar for the added array
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& addScaled(const Vec2Array& array, float s);
+
+    /**
+     * Linearly interpolates this array towards the given one in place.
+     *
+     * If alpha is 0, the array is unchanged.  If alpha is 1, this array is
+     * a copy of the other.
+     *
+     * @param array The array to interpolate towards
+     * @param alpha The interpolation value
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& lerp(const Vec2Array& array, float alpha);
+
+    /**
+     * Normalizes every vector in this array.
+     *
+     * As with {@link Vec2#normalize}, a vector with (nearly) zero length
+     * is left unchanged.
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& normalize();
+
+
+#pragma mark -
+#pragma mark Queries
+    /**
+     * Stores the dot product of each vector with its partner in array.
+     *
+     * The output buffer must have room for {@link #size} values.
+     *
+     * @param array     The array of partner vectors
+     * @param output    The buffer to store the dot products
+     */
+    void dot(const Vec2Array& array, float* output) const;
+
+    /**
+     * Stores the dot product of each vector with v.
+     *
+     * The output buffer must have room for {@link #size} values.
+     *
+     * @param v         The vector to dot with
+     * @param output    The buffer to store the dot products
+     */
+    void dot(const Vec2& v, float* output) const;
+
+    /**
+     * Stores the length of each vector.
+     *
+     * The output buffer must have room for {@link #size} values.
+     *
+     * @param output    The buffer to store the lengths
+     */
+    void length(float* output) const;
+
+    /**
+     * Stores the squared length of each vector.
+     *
+     * This method is faster than {@link #length}, and should be preferred
+     * when only comparing lengths.  The output buffer must have room for
+     * {@link #size} values.
+     *
+     * @param output    The buffer to store the squared lengths
+     */
+    void lengthSquared(float* output) const;
+
+
+#pragma mark -
+#pragma mark Transforms
+    /**
+     * Transforms every vector in this array by the given transform.
+     *
+     * The vectors are treated as points, and so are affected by the
+     * translation.
+     *
+     * @param transform The affine transform
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& transform(const Affine2& transform);
+
+    /**
+     * Transforms each vector in this array by its own transform.
+     *
+     * There must be one transform for each vector in this array.  The
+     * vectors are treated as points, and so are affected by the translation.
+     *
+     * @param transforms    The affine transforms
+     *
+     * @return a reference to this array for chaining.
+     */
+    Vec2Array& transform(const AffineArray& transforms);
+};
+
+}
+
+#endif /* __CU_VEC2_ARRAY_H__ */
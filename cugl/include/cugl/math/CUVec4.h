@@ -43,9 +43,6 @@
     #define VIMAGE_H
     #include <Accelerate/Accelerate.h>
 #endif
-#ifdef CU_MATH_VECTOR_SSE
-    #include <xmmintrin.h>
-#endif
 
 #include <math.h>
 #include <functional>
@@ -88,20 +85,6 @@ public:
         };
         vFloat v;
     };
-#elif defined CU_MATH_VECTOR_SSE
-	__declspec(align(16)) union {
-        struct {
-            /** The x-coordinate. */
-            float x;
-            /** The y-coordinate. */
-            float y;
-            /** The z-coordinate. */
-            float z;
-            /** The w-coordinate. */
-            float w;
-        };
-        __m128 v;
-    };
 #else
     /** The x-coordinate. */
     float x;
@@ -37,9 +37,13 @@
 #include "CUMat4.h"
 #include "CUAffine2.h"
 #include "CUColor4.h"
+#include "CUVec2Array.h"
+#include "CUColor4Array.h"
+#include "CUAffineArray.h"
 #include "CUSize.h"
 #include "CURect.h"
 #include "CUPolynomial.h"
+#include "CUSmallPolynomial.h"
 #include "CUPoly2.h"
 #include "CUCubicSpline.h"
 #include "CURay.h"
@@ -43,6 +43,8 @@
 
 /** The default tolerance for the polygon approximation functions */
 #define DEFAULT_TOLERANCE   0.25
+/** The maximum number of line segments when flattening a single bezier */
+#define MAX_FLATTEN_SEGMENTS    1024
 
 namespace cugl {
 
@@ -66,6 +68,12 @@ namespace cugl {
  * to the spline, and it is unsafe to modify the spline while the calculation
  * is ongoing.  If you do multithread the calculation, you should force the
  * user to copy the spline first.
+ *
+ * If you are animating a large number of splines every frame, you should
+ * use {@link #flatten} instead of the calculate-materialize cycle.  That
+ * method writes directly to storage provided by the caller, and picks the
+ * number of segments for each bezier from its curvature.  It does not
+ * allocate any memory, and it does not require {@link #calculate}.
  */
 class CubicSplineApproximator {
 #pragma mark Values
@@ -133,7 +141,7 @@ public:
     /**
      * Deletes this spline approximator, releasing all resources.
      */
-    ~CubicSplineApproximator();
+    ~CubicSplineApproximator() {}
     
 
 #pragma mark -
@@ -239,6 +247,40 @@ public:
      * @return a reference to the buffer for chaining.
      */
     Poly2* getPath(Poly2* buffer) const;
+    
+    /**
+     * Stores a polyline approximating this spline in the given storage.
+     *
+     * Unlike {@link #getPath}, this method does not use the results of
+     * {@link #calculate}.  Instead, it flattens each bezier segment of the
+     * spline directly, choosing the number of line segments from the
+     * curvature of that bezier (using Wang's formula).  The result is
+     * guaranteed to be within tolerance of the true curve.  The points are
+     * then computed with forward differencing.
+     *
+     * The tolerance is measured in the coordinate space of the spline. To
+     * flatten with respect to a screen-space tolerance, divide that tolerance
+     * by the scale of the transform used to draw the spline.
+     *
+     * The result is a sequence of points along the spline.  If the spline
+     * is open, the last point is the end of the spline. If it is closed,
+     * the last point is omitted, as it is the same as the first. If params
+     * is not null, it will store the spline parameter for each point.
+     *
+     * This method does not allocate memory.  If the capacity is too small
+     * to hold the result, this method will write nothing.  In either case,
+     * it returns the number of points required.  Hence you can call this
+     * method with a null buffer to determine the size of the storage.
+     *
+     * @param  buffer       The storage for the points
+     * @param  capacity     The number of points the buffer (and params) can hold
+     * @param  tolerance    The maximum distance from the true curve
+     * @param  params       Optional storage for the point parameters
+     *
+     * @return the number of points required for the approximation.
+     */
+    size_t flatten(Vec2* buffer, size_t capacity, float tolerance=DEFAULT_TOLERANCE,
+                   float* params=nullptr) const;
 
     /**
      * Returns a list of parameters for a polygon approximation
@@ -277,7 +319,7 @@ public:
      *
      * @return the number of elements added to the buffer
      */
-    size_t getParameters(std::vector<float> buffer);
+    size_t getParameters(std::vector<float>& buffer) const;
     
     /**
      * Returns a list of tangents for a polygon approximation
@@ -316,7 +358,7 @@ public:
      *
      * @return the number of elements added to the buffer
      */
-    size_t getTangents(std::vector<Vec2> buffer);
+    size_t getTangents(std::vector<Vec2>& buffer) const;
 
     /**
      * Stores tangent data for the approximation in the buffer.
@@ -337,7 +379,7 @@ public:
      *
      * @return the number of elements added to the buffer
      */
-    Poly2* getTangents(Poly2* buffer);
+    Poly2* getTangents(Poly2* buffer) const;
 
     /**
      * Returns a list of normals for a polygon approximation
@@ -376,7 +418,7 @@ public:
      *
      * @return the number of elements added to the buffer
      */
-    size_t getNormals(std::vector<Vec2> buffer);
+    size_t getNormals(std::vector<Vec2>& buffer) const;
 
     /**
      * Stores normal data for the approximation in the buffer.
@@ -398,7 +440,7 @@ public:
      *
      * @return the number of elements added to the buffer
      */
-    Poly2* getNormals(Poly2* buffer);
+    Poly2* getNormals(Poly2* buffer) const;
     
     /**
      * Returns a Poly2 representing handles for the anchor points
@@ -542,8 +584,10 @@ private:
      * de Castlejau's algorithm and stores the data in the buffer.  You 
      * will never call this method directly.
      *
-     * @param  src          the control point list for the bezier
-     * @param  soff         the offset into the control point list
+     * The subdivision is performed on the stack, so this method only allocates
+     * memory if the output buffers must grow.
+     *
+     * @param  src          the four control points for the bezier
      * @param  tp           the parameter to split at
      * @param  tolerance    the error tolerance of the stopping condition
      * @param  criterion    the stopping condition criterion
@@ -551,8 +595,7 @@ private:
      *
      * @return The number of (anchor) points generated by this recursive call.
      */
-    int generate(const std::vector<Vec2>& src, int soff, float tp,
-                 float tolerance, Criterion criterion, int depth);
+    int generate(const Vec2* src, float tp, float tolerance, Criterion criterion, int depth);
 
     /**
      * Returns the currently "active" control points.
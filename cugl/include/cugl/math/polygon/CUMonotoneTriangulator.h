@@ -0,0 +1,395 @@
+//
+//  CUMonotoneTriangulator.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for a sweep-line triangulator.  It partitions the
+//  polygon into y-monotone pieces in a single sweep, and then triangulates
+//  each piece in linear time.  This makes it O(n log n), as opposed to the
+//  ear clipping of SimpleTriangulator, and it supports polygons with holes.
+//  It is the triangulator to use for large outlines, such as level geometry.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  The algorithm is the classic one from "Computational Geometry: Algorithms
+//  and Applications" by de Berg, Cheong, van Kreveld, and Overmars.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+
+#ifndef __CU_MONOTONE_TRIANGULATOR_H__
+#define __CU_MONOTONE_TRIANGULATOR_H__
+
+#include <cugl/math/CUPoly2.h>
+#include <cugl/math/CUVec2.h>
+#include <vector>
+
+namespace cugl {
+    
+/**
+ * This class is a factory for producing solid Poly2 objects from a set of vertices.
+ *
+ * This triangulator is an alternative to {@link SimpleTriangulator} for large
+ * polygons.  Ear clipping rescans the polygon for an ear after every cut, so
+ * it is quadratic (or worse) in the number of vertices.  This triangulator
+ * uses a sweep line to partition the polygon into y-monotone pieces, and then
+ * triangulates each piece with a single pass.  The result is O(n log n), which
+ * makes a difference once the outline has more than a few hundred vertices.
+ *
+ * In addition, this triangulator supports holes.  The outer boundary is set
+ * with the initialization methods, and each hole is added with {@link addHole}.
+ * The boundary and the holes may be in either orientation.  However, the holes
+ * must lie inside the boundary, and no two rings may intersect or touch.  As
+ * with SimpleTriangulator, the polygon may not have self-intersections.
+ *
+ * The triangulation indices refer to the vertices of the outer boundary,
+ * followed by the vertices of each hole, in the order that the holes were
+ * added.  This is exactly the vertex list of the materialized polygon.
+ *
+ * As with all factories, the methods are broken up into three phases:
+ * initialization, calculation, and materialization.  To use the factory, you
+ * first set the data (in this case a set of vertices or another Poly2) with the
+ * initialization methods.  You then call the calculation method.  Finally,
+ * you use the materialization methods to access the data in several different
+ * ways.
+ *
+ * This division allows us to support multithreaded calculation if the data
+ * generation takes too long.  However, note that this factory is not thread
+ * safe in that you cannot access data while it is still in mid-calculation.
+ */
+class MonotoneTriangulator {
+#pragma mark Values
+private:
+    /**
+     * Enumeration of vertex types (for the sweep line)
+     *
+     * A vertex type is classified by the position of its two neighbors relative
+     * to the sweep line, and by whether the interior angle is convex.  These are
+     * the vertices where the boundary changes vertical direction.
+     */
+    enum VertexType {
+        /** Both neighbors are below, and the interior angle is convex */
+        START,
+        /** Both neighbors are below, and the interior angle is reflex */
+        SPLIT,
+        /** Both neighbors are above, and the interior angle is convex */
+        END,
+        /** Both neighbors are above, and the interior angle is reflex */
+        MERGE,
+        /** One neighbor is above, and the other is below */
+        REGULAR
+    };
+
+    /** The vertices of the outer boundary, followed by those of each hole */
+    std::vector<Vec2> _input;
+    /** The position of the first vertex of each hole in the input */
+    std::vector<Uint32> _holes;
+    /** The next vertex along each boundary, with the interior on the left */
+    std::vector<Uint32> _next;
+    /** The previous vertex along each boundary, with the interior on the left */
+    std::vector<Uint32> _prev;
+    /** The classification type of each vertex for the sweep */
+    std::vector<VertexType> _types;
+    /** The diagonals partitioning the polygon into monotone pieces (as pairs) */
+    std::vector<Uint32> _diagonals;
+    /** The output results of the triangulation */
+    std::vector<Uint32> _output;
+    /** Whether or not the calculation has been run */
+    bool _calculated;
+
+    
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a triangulator with no vertex data.
+     */
+    MonotoneTriangulator() : _calculated(false) {}
+
+    /**
+     * Creates a triangulator with the given vertex data.
+     *
+     * The vertices define the outer boundary of the polygon.  The vertex data
+     * is copied.  The triangulator does not retain any references to the
+     * original data.
+     * 
+     * @param points    The vertices to triangulate
+     */
+    MonotoneTriangulator(const std::vector<Vec2>& points) : _calculated(false) { _input = points; }
+
+    /**
+     * Creates a triangulator with the given vertex data.
+     *
+     * The vertices define the outer boundary of the polygon.  The triangulator
+     * only uses the vertex data from the polygon.  It ignores any existing
+     * indices.
+     *
+     * The vertex data is copied.  The triangulator does not retain any
+     * references to the original data.
+     *
+     * @param poly    The vertices to triangulate
+     */
+    MonotoneTriangulator(const Poly2& poly) :  _calculated(false) { _input = poly._vertices; }
+
+    /**
+     * Deletes this triangulator, releasing all resources.
+     */
+    ~MonotoneTriangulator() {}
+
+#pragma mark -
+#pragma mark Initialization
+    /**
+     * Sets the outer boundary for this triangulator.
+     *
+     * The triangulator only uses the vertex data from the polygon.  It ignores
+     * any existing indices.  Any holes previously added are removed.
+     *
+     * The vertex data is copied.  The triangulator does not retain any
+     * references to the original data.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param poly    The vertices to triangulate
+     */
+    void set(const Poly2& poly) {
+        clear();
+        _input = poly._vertices;
+    }
+
+    /**
+     * Sets the outer boundary for this triangulator.
+     *
+     * Any holes previously added are removed.  The vertex data is copied.
+     * The triangulator does not retain any references to the original data.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param points    The vertices to triangulate
+     */
+    void set(const std::vector<Vec2>& points) {
+        clear();
+        _input = points;
+    }
+    
+    /**
+     * Adds a hole to the polygon.
+     *
+     * The hole must lie strictly inside the outer boundary, and it may not
+     * intersect any other hole.  Holes with fewer than three vertices are
+     * ignored.  The vertex data is copied.  The triangulator does not retain
+     * any references to the original data.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param points    The vertices of the hole
+     */
+    void addHole(const std::vector<Vec2>& points);
+    
+    /**
+     * Adds a hole to the polygon.
+     *
+     * The triangulator only uses the vertex data from the polygon.  It ignores
+     * any existing indices.  The hole must lie strictly inside the outer
+     * boundary, and it may not intersect any other hole.  The vertex data is
+     * copied.  The triangulator does not retain any references to the original
+     * data.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param poly    The vertices of the hole
+     */
+    void addHole(const Poly2& poly) {
+        addHole(poly._vertices);
+    }
+    
+    /**
+     * Clears all internal data, but still maintains the initial vertex data.
+     */
+    void reset() {
+        _calculated = false;
+        _output.clear(); _next.clear(); _prev.clear(); _types.clear(); _diagonals.clear();
+    }
+    
+    /**
+     * Clears all internal data, the initial vertex data.
+     *
+     * When this method is called, you will need to set a new vertices before
+     * calling calculate.
+     */
+    void clear() {
+        reset();
+        _input.clear(); _holes.clear();
+    }
+    
+#pragma mark -
+#pragma mark Calculation
+    /**
+     * Performs a triangulation of the current vertex data.
+     */
+    void calculate();
+    
+#pragma mark -
+#pragma mark Materialization
+    /**
+     * Returns a list of indices representing the triangulation.
+     *
+     * The indices represent positions in the vertex list of the outer boundary
+     * followed by each hole.  If you have modified those lists, these indices
+     * may no longer be valid.
+     *
+     * The triangulator does not retain a reference to the returned list; it
+     * is safe to modify it.
+     *
+     * If the calculation is not yet performed, this method will return the
+     * empty list.
+     *
+     * @return a list of indices representing the triangulation.
+     */
+    std::vector<Uint32> getTriangulation();
+
+    /**
+     * Stores the triangulation indices in the given buffer.
+     *
+     * The indices represent positions in the vertex list of the outer boundary
+     * followed by each hole.  If you have modified those lists, these indices
+     * may no longer be valid.
+     *
+     * The indices will be appended to the provided vector. You should clear 
+     * the vector first if you do not want to preserve the original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @return the number of elements added to the buffer
+     */
+    size_t getTriangulation(std::vector<Uint32>& buffer);
+
+    /**
+     * Returns a polygon representing the triangulation.
+     *
+     * The polygon contains the vertices of the outer boundary and every hole,
+     * together with the new indices defining a solid shape.  The triangulator
+     * does not maintain references to this polygon and it is safe to modify it.
+     *
+     * If the calculation is not yet performed, this method will return the
+     * empty polygon.
+     *
+     * @return a polygon representing the triangulation.
+     */
+    Poly2 getPolygon();
+    
+    /**
+     * Stores the triangulation in the given buffer.
+     *
+     * This method will add both the vertices (of the outer boundary and every
+     * hole), and the corresponding indices to the new buffer.  If the buffer
+     * is not empty, the indices will be adjusted accordingly. You should clear
+     * the buffer first if you do not want to preserve the original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @param buffer    The buffer to store the triangulated polygon
+     *
+     * @return a reference to the buffer for chaining.
+     */
+    Poly2* getPolygon(Poly2* buffer);
+
+#pragma mark -
+#pragma mark Internal Data Generation
+private:
+    /**
+     * Returns true if vertex a is above vertex b in the sweep order.
+     *
+     * The sweep moves from top to bottom.  Vertices at the same height are
+     * ordered left to right, which is the same as rotating the plane by an
+     * infinitesimal amount.  Hence no two vertices are at the same height.
+     *
+     * @param a     The first vertex index
+     * @param b     The second vertex index
+     *
+     * @return true if vertex a is above vertex b in the sweep order.
+     */
+    bool isAbove(Uint32 a, Uint32 b) const;
+    
+    /**
+     * Links the vertices of each boundary so that the interior is on the left.
+     *
+     * This method makes the outer boundary counterclockwise and each hole
+     * clockwise, regardless of the orientation of the input.
+     */
+    void linkBoundaries();
+    
+    /**
+     * Classifies each vertex according to its neighbors.
+     *
+     * The classification determines how the sweep line handles the vertex.
+     */
+    void classifyVertices();
+    
+    /**
+     * Computes the diagonals that partition the polygon into monotone pieces.
+     *
+     * This is a sweep from top to bottom.  The sweep status is a balanced tree
+     * of the edges with the interior to their right, ordered by where they
+     * cross the sweep line.  Each split or merge vertex gets a diagonal to the
+     * closest vertex that resolves it.
+     */
+    void computeDiagonals();
+    
+    /**
+     * Triangulates each of the monotone pieces.
+     *
+     * The pieces are the faces of the boundary edges and the diagonals.  This
+     * method walks each face, and then triangulates it.
+     */
+    void computeTriangulation();
+    
+    /**
+     * Triangulates a single y-monotone polygon.
+     *
+     * The polygon is given as a list of vertex indices, with the interior on
+     * the left.  This is the linear time stack algorithm, which processes the
+     * vertices in sweep order and cuts off triangles as soon as possible.
+     *
+     * @param face  The vertex indices of the monotone polygon
+     */
+    void triangulateMonotone(const std::vector<Uint32>& face);
+    
+    /**
+     * Adds the given triangle to the output, unless it is degenerate.
+     *
+     * Colinear triangles will crash OpenGL, so we remove them.
+     *
+     * @param a     The first vertex index
+     * @param b     The second vertex index
+     * @param c     The third vertex index
+     */
+    void addTriangle(Uint32 a, Uint32 b, Uint32 c);
+    
+};
+
+}
+
+#endif /* __CU_MONOTONE_TRIANGULATOR_H__ */
@@ -47,11 +47,14 @@
 #include <cugl/math/CUPoly2.h>
 #include <cugl/math/CUVec2.h>
 #include <vector>
+#include <memory>
 
 namespace cugl {
 
 // Forward reference to the opaque data class.
 class KivyData;
+// Forward reference to the thread pool for parallel extrusion.
+class ThreadPool;
     
 /**
  * The types of joints supported in an extrusion.
@@ -114,6 +117,13 @@ enum class PathCap :int {
  * generation takes too long.  However, note that this factory is not thread
  * safe in that you cannot access data while it is still in mid-calculation.
  *
+ * This factory also supports paths that change every frame.  If you add
+ * points to an open path with {@link append}, the next calculation only
+ * extrudes the new segments.  The output buffers are reused between
+ * calculations, so a growing path does not reallocate them every frame.
+ * For long paths that do not change, the calculation can be split into
+ * chunks processed in parallel by a {@link ThreadPool}.
+ *
  * CREDITS: This code is ported from the Kivy implementation of Line in package
  * kivy.vertex_instructions.  We believe that this port is acceptable within
  * the scope of the Kivy license.  There are no specific credits in that file,
@@ -137,17 +147,32 @@ private:
     /** The output results of extruded vertices */
     std::vector<Vec2> _outverts;
     /** The output results of extruded indices */
-    std::vector<unsigned short> _outindx;
+    std::vector<Uint32> _outindx;
     /** Whether or not the calculation has been run */
     bool _calculated;
     
+    /** The algorithm state before the end caps (for incremental extrusion) */
+    std::shared_ptr<KivyData> _state;
+    /** The number of input points extruded in the saved state */
+    size_t _extruded;
+    /** The number of output vertices before the end caps */
+    size_t _capverts;
+    /** The number of output indices before the end caps */
+    size_t _capindx;
+    /** The stroke width of the saved state */
+    float _stroke;
+    /** The joint type of the saved state */
+    PathJoint _joint;
+    /** The cap type of the saved state */
+    PathCap _cap;
+    
 #pragma mark -
 #pragma mark Constructors
 public:
     /**
      * Creates an extruder with no vertex data.
      */
-    PathExtruder() {}
+    PathExtruder() : _closed(false), _calculated(false), _extruded(0) {}
     
     /**
      * Creates an extruder with the given vertex data.
@@ -158,7 +183,7 @@ public:
      * @param points    The vertices to extrude
      * @param closed    Whether the path is closed
      */
-    PathExtruder(const std::vector<Vec2>& points, bool closed) : _calculated(false) {
+    PathExtruder(const std::vector<Vec2>& points, bool closed) : _calculated(false), _extruded(0) {
         _input = points; _closed = closed;
     }
     
@@ -174,7 +199,10 @@ public:
      *
      * @param poly    The vertices to extrude
      */
-    PathExtruder(const Poly2& poly) :  _calculated(false) { _input = poly._vertices; }
+    PathExtruder(const Poly2& poly) :  _calculated(false), _extruded(0) {
+        _input = poly._vertices;
+        _closed = poly._indices.size() == poly._vertices.size()*2;
+    }
     
     /**
      * Deletes this extruder, releasing all resources.
@@ -218,12 +246,45 @@ public:
         _closed = closed;
     }
     
+    /**
+     * Adds a point to the end of the path.
+     *
+     * Unlike the other initialization methods, this method does not reset
+     * the internal data.  If the path is open, the next calculation only
+     * extrudes the new segment (provided that the stroke, joint, and cap
+     * do not change).  However, you will still need to reperform the
+     * calculation before accessing data.
+     *
+     * @param point     The point to add
+     */
+    void append(const Vec2& point) {
+        _calculated = false;
+        _input.push_back(point);
+    }
+    
+    /**
+     * Adds the given points to the end of the path.
+     *
+     * Unlike the other initialization methods, this method does not reset
+     * the internal data.  If the path is open, the next calculation only
+     * extrudes the new segments (provided that the stroke, joint, and cap
+     * do not change).  However, you will still need to reperform the
+     * calculation before accessing data.
+     *
+     * @param points    The points to add
+     */
+    void append(const std::vector<Vec2>& points) {
+        _calculated = false;
+        _input.insert(_input.end(), points.begin(), points.end());
+    }
+    
     /**
      * Clears all internal data, but still maintains the initial vertex data.
      */
     void reset() {
         _calculated = false;
         _outverts.clear(); _outindx.clear();
+        _state = nullptr;
     }
     
     /**
@@ -233,8 +294,8 @@ public:
      * calling calculate.
      */
     void clear() {
-        _calculated = false;
-        _input.clear(); _outverts.clear(); _outindx.clear();
+        reset();
+        _input.clear();
     }
     
 #pragma mark -
@@ -259,11 +320,24 @@ public:
      *
      *      http://kivy.org/docs/_images/line-instruction.png
      *
+     * If the path is open, and the only change since the last calculation is
+     * points added with {@link append}, this method only extrudes the new
+     * segments.  It removes the old end caps, extends the path, and recreates
+     * the caps.  The stroke, joint, and cap must be the same as the last
+     * calculation.  This is the efficient way to extrude a growing path, such
+     * as a trail.
+     *
+     * If a thread pool is provided, and the path is long, then the path is split
+     * into chunks that are extruded in parallel.  This method still blocks until
+     * the extrusion is complete.
+     *
      * @param stroke    The stroke width of the extrusion
      * @param joint     The extrusion joint type.
      * @param cap       The extrusion cap type.
+     * @param pool      The thread pool for a parallel extrusion (optional)
      */
-    void calculate(float stroke, PathJoint joint=PathJoint::ROUND, PathCap cap = PathCap::ROUND);
+    void calculate(float stroke, PathJoint joint=PathJoint::ROUND, PathCap cap = PathCap::ROUND,
+                   const std::shared_ptr<ThreadPool>& pool = nullptr);
     
 #pragma mark -
 #pragma mark Materialization
@@ -317,11 +391,53 @@ private:
      */
     unsigned int computeSize(PathJoint joint, PathCap cap, unsigned int* vcount, unsigned int* icount);
     
+    /**
+     * Extrudes the segments in the given range.
+     *
+     * Segment ii is the line segment from input point ii to the next one.  The
+     * joint at the start of each segment is created with the segment.  The new
+     * vertices and indices are appended to the buffers in data.
+     *
+     * @param first     The first segment to extrude
+     * @param last      The segment after the last one to extrude
+     * @param data      The data necessary to run the Kivy algorithm.
+     */
+    void extrudeRange(unsigned int first, unsigned int last, KivyData* data);
+    
+    /**
+     * Extrudes the segments in the given range as an independent chunk.
+     *
+     * This method is the same as {@link extrudeRange}, except that it first
+     * extrudes the segment before the range (when there is one).  The joint
+     * at the start of the range needs this segment.  The extra four vertices
+     * and six indices are at the start of the buffers, and they are removed
+     * when the chunks are stitched together.
+     *
+     * @param first     The first segment to extrude
+     * @param last      The segment after the last one to extrude
+     * @param data      The data necessary to run the Kivy algorithm.
+     */
+    void extrudeChunk(unsigned int first, unsigned int last, KivyData* data);
+    
+    /**
+     * Extrudes all of the segments in parallel chunks.
+     *
+     * The segments are split into chunks which are extruded on the threads of
+     * the pool (and on the calling thread).  The chunks are then stitched
+     * together in order.  The result is identical to extruding the segments
+     * in a single pass.  This method blocks until all chunks are complete.
+     *
+     * @param count     The number of generating points in the path.
+     * @param data      The data necessary to run the Kivy algorithm.
+     * @param pool      The thread pool for the chunks
+     */
+    void extrudeParallel(unsigned int count, KivyData* data, const std::shared_ptr<ThreadPool>& pool);
+    
     /**
      * Creates the extruded line segment from a to b.
      *
-     * The new vertices are appended to _outvert, while the new _indices are 
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param a     The start of the line segment
      * @param b     The end of the line segment.
@@ -332,8 +448,8 @@ private:
     /**
      * Creates a joint immediately before point a.
      *
-     * The new vertices are appended to _outvert, while the new _indices are
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param a         The generating point after the joint.
      * @param data      The data necessary to run the Kivy algorithm.
@@ -345,8 +461,8 @@ private:
     /**
      * Creates a mitre joint immediately before point a.
      *
-     * The new vertices are appended to _outvert, while the new _indices are
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param a         The generating point after the joint.
      * @param jangle    The joint angle
@@ -359,8 +475,8 @@ private:
     /**
      * Creates a bevel joint immediately before point a.
      *
-     * The new vertices are appended to _outvert, while the new _indices are
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param a         The generating point after the joint.
      * @param jangle    The joint angle
@@ -373,8 +489,8 @@ private:
     /**
      * Creates a round joint immediately before point a.
      *
-     * The new vertices are appended to _outvert, while the new _indices are
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param a         The generating point after the joint.
      * @param jangle    The joint angle
@@ -387,8 +503,8 @@ private:
     /**
      * Creates the caps on the two ends of the open path.
      *
-     * The new vertices are appended to _outvert, while the new _indices are
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param count     The number of generating points in the path.
      * @param data      The data necessary to run the Kivy algorithm.
@@ -398,8 +514,8 @@ private:
     /**
      * Creates square caps on the two ends of the open path.
      *
-     * The new vertices are appended to _outvert, while the new _indices are
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param count     The number of generating points in the path.
      * @param data      The data necessary to run the Kivy algorithm.
@@ -409,8 +525,8 @@ private:
     /**
      * Creates round caps on the two ends of the open path.
      *
-     * The new vertices are appended to _outvert, while the new _indices are
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param count     The number of generating points in the path.
      * @param data      The data necessary to run the Kivy algorithm.
@@ -420,8 +536,8 @@ private:
     /**
      * Creates the final joint at the end of a closed path.
      *
-     * The new vertices are appended to _outvert, while the new _indices are
-     * appended to _outindx.
+     * The new vertices are appended to the vertex buffer of data, while the
+     * new indices are appended to its index buffer.
      *
      * @param data      The data necessary to run the Kivy algorithm.
      *
@@ -81,7 +81,7 @@ private:
     /** The set of vertices to use in the calculation */
     std::vector<Vec2> _input;
     /** The output results of the path traversal */
-    std::vector<unsigned short> _output;
+    std::vector<Uint32> _output;
     /** Whether or not the calculation has been run */
     bool _calculated;
     
@@ -207,7 +207,7 @@ public:
      *
      * @return a list of indices representing the path outline.
      */
-    std::vector<unsigned short> getPath();
+    std::vector<Uint32> getPath();
     
     /**
      * Stores the path outline indices in the given buffer.
@@ -222,7 +222,7 @@ public:
      *
      * @return the number of elements added to the buffer
      */
-    size_t getPath(std::vector<unsigned short>& buffer);
+    size_t getPath(std::vector<Uint32>& buffer);
     
     /**
      * Returns a polygon representing the path outline.
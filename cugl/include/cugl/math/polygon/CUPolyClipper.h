@@ -0,0 +1,427 @@
+//
+//  CUPolyClipper.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for performing boolean operations (union,
+//  intersection, difference) and offsets on polygon outlines.  The factory
+//  maintains a shape, and each operation modifies that shape in place.  This
+//  makes it suitable for destructible terrain or fog-of-war, where a large
+//  shape is repeatedly edited by small ones.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+
+#ifndef __CU_POLY_CLIPPER_H__
+#define __CU_POLY_CLIPPER_H__
+
+#include <cugl/math/CUPoly2.h>
+#include <cugl/math/CUVec2.h>
+#include <cugl/util/CUDebug.h>
+#include <vector>
+
+/** The default number of snapping grid points per unit */
+#define DEFAULT_CLIPPER_RESOLUTION  256.0f
+
+namespace cugl {
+
+/**
+ * This class is a factory for boolean operations and offsets on polygons.
+ *
+ * The factory maintains a shape, which is a collection of closed contours.
+ * Outer boundaries are counter-clockwise, while holes are clockwise, so that
+ * the interior is always on the left.  You set the initial shape with the
+ * initialization methods, and then apply operations to it with the calculation
+ * methods.  Each operation modifies the shape in place, and the result is
+ * again a valid shape.  You can access the shape at any time with the
+ * materialization methods.
+ *
+ * The operations are computed on a snapping grid.  Every vertex (including
+ * the intersection points) is rounded to the nearest grid point, and all of
+ * the geometric predicates are computed exactly on those integer coordinates.
+ * This makes the operations robust to degeneracies such as shared edges and
+ * touching vertices.  The resolution of this grid is the number of grid points
+ * per unit, and it limits the size of the coordinates: the coordinates times
+ * the resolution must be less than 2^30 in absolute value.
+ *
+ * Input contours are interpreted with the nonzero fill rule, so they may be
+ * in either orientation and may intersect themselves and each other.  When
+ * setting a solid Poly2, the shape is the union of its triangles.  When
+ * setting a path Poly2, the index pairs are the (directed) contour edges.
+ *
+ * By default, operations are incremental.  Only the shape edges in the
+ * vertical slab spanned by the clip polygon (its range of x-coordinates) are
+ * clipped. The rest of the shape is copied unchanged, and contours outside of
+ * the slab are not even relinked.  For small edits to a large shape, this is much faster
+ * than processing the entire shape.  You can disable this behavior with
+ * {@link #setIncremental}, which is primarily useful for testing.
+ *
+ * The contours may be used with {@link PathOutliner} or {@link PathExtruder}
+ * directly, and {@link #getPolygon} triangulates the shape (with holes) using
+ * a {@link MonotoneTriangulator}.
+ */
+class PolyClipper {
+public:
+    /**
+     * The boolean operations supported by this factory.
+     *
+     * In each case, the current shape is the first operand, and the clip
+     * polygon is the second.
+     */
+    enum class Operation {
+        /** The points in either the shape or the clip polygon */
+        UNION,
+        /** The points in both the shape and the clip polygon */
+        INTERSECTION,
+        /** The points in the shape that are not in the clip polygon */
+        DIFFERENCE,
+        /** The points in exactly one of the shape and the clip polygon */
+        XOR
+    };
+
+#pragma mark Values
+private:
+    /** The contour points of the shape, as interleaved grid coordinates */
+    std::vector<Sint64> _points;
+    /** The position of the first point of each contour (plus the end) */
+    std::vector<Uint32> _starts;
+    /** The bounding box (min x, min y, max x, max y) of each contour */
+    std::vector<Sint64> _bounds;
+    /** The number of grid points per unit */
+    float _resolution;
+    /** Whether operations only process the region near the clip polygon */
+    bool _incremental;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a clipper with an empty shape.
+     */
+    PolyClipper() : _resolution(DEFAULT_CLIPPER_RESOLUTION), _incremental(true) {
+        _starts.push_back(0);
+    }
+
+    /**
+     * Creates a clipper with the given contour as its shape.
+     *
+     * The contour may be in either orientation, and may intersect itself.
+     * The vertex data is copied. The clipper does not retain any references
+     * to the original data.
+     *
+     * @param points    The contour vertices
+     */
+    PolyClipper(const std::vector<Vec2>& points) : PolyClipper() {
+        set(points);
+    }
+
+    /**
+     * Creates a clipper with the given polygon as its shape.
+     *
+     * If the polygon is solid, the shape is the union of its triangles. If
+     * it is a path, the index pairs are the contour edges.  Otherwise, the
+     * vertices are treated as a single contour.  The vertex data is copied.
+     * The clipper does not retain any references to the original data.
+     *
+     * @param poly      The polygon for the initial shape
+     */
+    PolyClipper(const Poly2& poly) : PolyClipper() {
+        set(poly);
+    }
+
+    /**
+     * Deletes this clipper, releasing all resources.
+     */
+    ~PolyClipper() {}
+
+
+#pragma mark -
+#pragma mark Initialization
+    /**
+     * Sets the shape of this clipper to the given contour.
+     *
+     * The contour may be in either orientation, and may intersect itself.
+     * The vertex data is copied. The clipper does not retain any references
+     * to the original data.
+     *
+     * @param points    The contour vertices
+     */
+    void set(const std::vector<Vec2>& points);
+
+    /**
+     * Sets the shape of this clipper to the given polygon.
+     *
+     * If the polygon is solid, the shape is the union of its triangles. If
+     * it is a path, the index pairs are the contour edges.  Otherwise, the
+     * vertices are treated as a single contour.  The vertex data is copied.
+     * The clipper does not retain any references to the original data.
+     *
+     * @param poly      The polygon for the shape
+     */
+    void set(const Poly2& poly);
+
+    /**
+     * Sets the shape of this clipper to the given contours.
+     *
+     * The contours are interpreted with the nonzero fill rule.  Hence holes
+     * must have the opposite orientation of their boundary.  The vertex data
+     * is copied. The clipper does not retain any references to the original
+     * data.
+     *
+     * @param contours  The shape contours
+     */
+    void set(const std::vector<std::vector<Vec2>>& contours);
+
+    /**
+     * Clears the shape of this clipper, making it empty.
+     */
+    void clear() {
+        _points.clear(); _bounds.clear();
+        _starts.clear(); _starts.push_back(0);
+    }
+
+    /**
+     * Returns the number of snapping grid points per unit
+     *
+     * All vertices are rounded to this grid.  This value is fixed when the
+     * shape is set, and so changing it does not affect the current shape.
+     *
+     * @return the number of snapping grid points per unit
+     */
+    float getResolution() const { return _resolution; }
+
+    /**
+     * Sets the number of snapping grid points per unit
+     *
+     * All vertices are rounded to this grid.  The coordinates times the
+     * resolution must be less than 2^30 in absolute value.  Changing the
+     * resolution clears the current shape.
+     *
+     * @param resolution    The number of snapping grid points per unit
+     */
+    void setResolution(float resolution) {
+        CUAssertLog(resolution > 0, "Resolution %f is not positive", resolution);
+        _resolution = resolution;
+        clear();
+    }
+
+    /**
+     * Returns true if operations only process the region near the clip polygon
+     *
+     * When true, operations only process the shape edges in the vertical
+     * slab spanned by the clip polygon. Otherwise, every
+     * operation processes the entire shape.  The results are the same.
+     *
+     * @return true if operations only process the region near the clip polygon
+     */
+    bool isIncremental() const { return _incremental; }
+
+    /**
+     * Sets whether operations only process the region near the clip polygon
+     *
+     * When true, operations only process the shape edges in the vertical
+     * slab spanned by the clip polygon. Otherwise, every
+     * operation processes the entire shape.  The results are the same.
+     *
+     * @param value Whether operations only process the region near the clip polygon
+     */
+    void setIncremental(bool value) { _incremental = value; }
+
+
+#pragma mark -
+#pragma mark Calculation
+    /**
+     * Applies the boolean operation with the given clip contour to the shape
+     *
+     * The contour may be in either orientation, and may intersect itself.
+     * The shape is the first operand of the operation.
+     *
+     * @param op        The boolean operation
+     * @param clip      The clip contour
+     */
+    void calculate(Operation op, const std::vector<Vec2>& clip);
+
+    /**
+     * Applies the boolean operation with the given clip polygon to the shape
+     *
+     * The clip polygon is interpreted just as in {@link #set}. The shape is
+     * the first operand of the operation.
+     *
+     * @param op        The boolean operation
+     * @param clip      The clip polygon
+     */
+    void calculate(Operation op, const Poly2& clip);
+
+    /**
+     * Offsets the boundary of the shape by the given distance
+     *
+     * A positive distance grows the shape, while a negative one shrinks it.
+     * The offset has rounded corners, approximated by line segments so that
+     * the error is at most tolerance.  This operation always processes the
+     * entire shape.
+     *
+     * @param distance  The offset distance
+     * @param tolerance The error tolerance of the rounded corners
+     */
+    void offset(float distance, float tolerance=0.25f);
+
+
+#pragma mark -
+#pragma mark Materialization
+    /**
+     * Returns the number of contours in the shape
+     *
+     * @return the number of contours in the shape
+     */
+    size_t getContourCount() const { return _starts.size()-1; }
+
+    /**
+     * Returns the contours of the shape
+     *
+     * Outer boundaries are counter-clockwise, while holes are clockwise.
+     * Each contour is closed (the last vertex connects to the first) and
+     * does not repeat its first vertex.
+     *
+     * @return the contours of the shape
+     */
+    std::vector<std::vector<Vec2>> getContours() const;
+
+    /**
+     * Stores the contours of the shape in the given buffer
+     *
+     * Outer boundaries are counter-clockwise, while holes are clockwise.
+     * Each contour is closed (the last vertex connects to the first) and
+     * does not repeat its first vertex.
+     *
+     * The contours will be appended to the buffer.  You should clear the
+     * buffer first if you do not want to preserve the original data.
+     *
+     * @param buffer    The buffer to store the contours
+     *
+     * @return the number of contours added to the buffer
+     */
+    size_t getContours(std::vector<std::vector<Vec2>>& buffer) const;
+
+    /**
+     * Returns the signed area of the shape
+     *
+     * This is the area of the outer boundaries minus the area of the holes.
+     *
+     * @return the signed area of the shape
+     */
+    double getArea() const;
+
+    /**
+     * Returns a path polygon outlining the shape
+     *
+     * The indices form closed paths around each contour. Hence this Poly2
+     * may be drawn as a wireframe.
+     *
+     * @return a path polygon outlining the shape
+     */
+    Poly2 getOutline() const;
+
+    /**
+     * Stores a path polygon outlining the shape in the given buffer
+     *
+     * The indices form closed paths around each contour. Hence this Poly2
+     * may be drawn as a wireframe.  If the buffer is not empty, the indices
+     * will be adjusted accordingly. You should clear the buffer first if you
+     * do not want to preserve the original data.
+     *
+     * @param buffer    The buffer to store the outline
+     *
+     * @return a reference to the buffer for chaining.
+     */
+    Poly2* getOutline(Poly2* buffer) const;
+
+    /**
+     * Returns a solid polygon triangulating the shape
+     *
+     * Each outer boundary is triangulated together with the holes that it
+     * contains, using a {@link MonotoneTriangulator}.
+     *
+     * @return a solid polygon triangulating the shape
+     */
+    Poly2 getPolygon() const;
+
+    /**
+     * Stores a solid polygon triangulating the shape in the given buffer
+     *
+     * Each outer boundary is triangulated together with the holes that it
+     * contains, using a {@link MonotoneTriangulator}.  If the buffer is not
+     * empty, the indices will be adjusted accordingly. You should clear the
+     * buffer first if you do not want to preserve the original data.
+     *
+     * @param buffer    The buffer to store the triangulation
+     *
+     * @return a reference to the buffer for chaining.
+     */
+    Poly2* getPolygon(Poly2* buffer) const;
+
+
+#pragma mark -
+#pragma mark Internal Data Generation
+private:
+    /**
+     * Appends the directed edges of the given polygon to the buffer
+     *
+     * Each edge is stored as four grid coordinates: the x and y coordinates
+     * of the start, followed by those of the end. Solid polygons contribute
+     * their triangles (in counter-clockwise order), path polygons contribute
+     * their index pairs, and other polygons are treated as a single contour.
+     *
+     * @param poly      The polygon to convert
+     * @param edges     The buffer to store the edges
+     */
+    void gather(const Poly2& poly, std::vector<Sint64>& edges) const;
+
+    /**
+     * Appends the directed edges of the given contour to the buffer
+     *
+     * Each edge is stored as four grid coordinates: the x and y coordinates
+     * of the start, followed by those of the end.
+     *
+     * @param points    The contour vertices
+     * @param edges     The buffer to store the edges
+     */
+    void gather(const std::vector<Vec2>& points, std::vector<Sint64>& edges) const;
+
+    /**
+     * Applies the boolean operation with the given clip edges to the shape
+     *
+     * Each clip edge is stored as four grid coordinates, as in {@link #gather}.
+     * This is the primary calculation method.  If incremental is true, only the
+     * shape edges in the vertical slab spanned by the clip edges are processed.
+     *
+     * @param op            The boolean operation
+     * @param clip          The clip edges
+     * @param incremental   Whether to process only the region near the clip
+     */
+    void apply(Operation op, const std::vector<Sint64>& clip, bool incremental);
+};
+
+}
+
+#endif /* __CU_POLY_CLIPPER_H__ */
@@ -87,9 +87,9 @@ private:
     /** The classification type of each vertex in the triangulation */
     std::vector<VertexType> _types;
     /** A naive, intermediate triangulation.  The final triangulation builds from this */
-    std::vector<unsigned short> _naive;
+    std::vector<Uint32> _naive;
     /** The output results of the triangulation */
-    std::vector<unsigned short> _output;
+    std::vector<Uint32> _output;
     /** Whether or not the calculation has been run */
     bool _calculated;
 
@@ -208,7 +208,7 @@ public:
      *
      * @return a list of indices representing the triangulation.
      */
-    std::vector<unsigned short> getTriangulation();
+    std::vector<Uint32> getTriangulation();
 
     /**
      * Stores the triangulation indices in the given buffer.
@@ -223,7 +223,7 @@ public:
      *
      * @return the number of elements added to the buffer
      */
-    size_t getTriangulation(std::vector<unsigned short>& buffer);
+    size_t getTriangulation(std::vector<Uint32>& buffer);
 
     /**
      * Returns a polygon representing the triangulation.
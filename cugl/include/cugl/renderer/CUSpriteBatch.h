@@ -200,6 +200,8 @@ public:
      * before continuing to draw. You should tune your system to have the 
      * appropriate capacity.  To small a capacity will cause the system to
      * thrash.  However, too large a capacity could stall on memory transfers.
+     * A single mesh larger than the capacity will grow the buffers, so that
+     * it is still drawn in one piece.
      *
      * The sprite batch begins with the default blank texture, and color white.
      * The perspective matrix is the identity.
@@ -219,6 +221,8 @@ public:
      * before continuing to draw. You should tune your system to have the
      * appropriate capacity.  To small a capacity will cause the system to
      * thrash.  However, too large a capacity could stall on memory transfers.
+     * A single mesh larger than the capacity will grow the buffers, so that
+     * it is still drawn in one piece.
      *
      * The sprite batch begins with the default blank texture, and color white.
      * The perspective matrix is the identity.
@@ -258,6 +262,8 @@ public:
      * before continuing to draw. You should tune your system to have the
      * appropriate capacity.  To small a capacity will cause the system to
      * thrash.  However, too large a capacity could stall on memory transfers.
+     * A single mesh larger than the capacity will grow the buffers, so that
+     * it is still drawn in one piece.
      *
      * The sprite batch begins with the default blank texture, and color white.
      * The perspective matrix is the identity.
@@ -765,6 +771,34 @@ public:
               const Mat4& transform, bool tint = true) {
         fill(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
     }
+    
+    /**
+     * Fills the triangulated vertices with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other fill methods.  The texture no longer needs to be
+     * drawn uniformly over the shape. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The triangulation will be determined by the given indices. If necessary,
+     * these can be generated via one of the triangulation factories
+     * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+     * This is the index format of {@link Poly2} and the polygon tools.
+     *
+     * @param vertices  The list of vertices
+     * @param indices   The triangulation list
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void fill(const std::vector<Vertex2>& vertices, const std::vector<Uint32>& indices,
+              const Mat4& transform, bool tint = true) {
+        fill(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
+    }
 
     /**
      * Fills the triangulated vertices with the current texture.
@@ -790,6 +824,34 @@ public:
               const Affine2& transform, bool tint = true) {
         fill(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
     }
+    
+    /**
+     * Fills the triangulated vertices with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other fill methods.  The texture no longer needs to be
+     * drawn uniformly over the shape. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The triangulation will be determined by the given indices. If necessary,
+     * these can be generated via one of the triangulation factories
+     * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+     * This is the index format of {@link Poly2} and the polygon tools.
+     *
+     * @param vertices  The list of vertices
+     * @param indices   The triangulation list
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void fill(const std::vector<Vertex2>& vertices, const std::vector<Uint32>& indices,
+              const Affine2& transform, bool tint = true) {
+        fill(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
+    }
 
     /**
      * Fills the triangulated vertices with the current texture.
@@ -818,6 +880,37 @@ public:
     void fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
               const unsigned short* indices, unsigned int isize, unsigned int ioffset,
               const Mat4& transform, bool tint = true);
+    
+    /**
+     * Fills the triangulated vertices with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other fill methods.  The texture no longer needs to be
+     * drawn uniformly over the shape. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The triangulation will be determined by the given indices. If necessary,
+     * these can be generated via one of the triangulation factories
+     * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+     * This is the index format of {@link Poly2} and the polygon tools.
+     *
+     * @param vertices  The array of vertices
+     * @param vsize     The size of the vertex array
+     * @param voffset   The first element of the vertex array
+     * @param indices   The triangulation array
+     * @param isize     The size of the index array
+     * @param ioffset   The first element of the index array
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+              const Uint32* indices, unsigned int isize, unsigned int ioffset,
+              const Mat4& transform, bool tint = true);
 
     /**
      * Fills the triangulated vertices with the current texture.
@@ -846,6 +939,37 @@ public:
     void fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
               const unsigned short* indices, unsigned int isize, unsigned int ioffset,
               const Affine2& transform, bool tint = true);
+    
+    /**
+     * Fills the triangulated vertices with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other fill methods.  The texture no longer needs to be
+     * drawn uniformly over the shape. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The triangulation will be determined by the given indices. If necessary,
+     * these can be generated via one of the triangulation factories
+     * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+     * This is the index format of {@link Poly2} and the polygon tools.
+     *
+     * @param vertices  The array of vertices
+     * @param vsize     The size of the vertex array
+     * @param voffset   The first element of the vertex array
+     * @param indices   The triangulation array
+     * @param isize     The size of the index array
+     * @param ioffset   The first element of the index array
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+              const Uint32* indices, unsigned int isize, unsigned int ioffset,
+              const Affine2& transform, bool tint = true);
 
 #pragma mark -
 #pragma mark Outlines
@@ -1101,6 +1225,34 @@ public:
         outline(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
     }
     
+    /**
+     * Outlines the vertex path with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other outline methods.  The texture no longer needs to be
+     * drawn uniformly over the wireframe. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The vertex path will be determined by the provided indices. The indices
+     * should be a multiple of two, preferably generated by the factories
+     * {@link PathOutliner} or {@link CubicSplineApproximator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+     * This is the index format of {@link Poly2} and the polygon tools.
+     *
+     * @param vertices  The list of vertices
+     * @param indices   The triangulation list
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void outline(const std::vector<Vertex2>& vertices, const std::vector<Uint32>& indices,
+                 const Mat4& transform, bool tint = true) {
+        outline(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
+    }
+    
     /**
      * Outlines the vertex path with the current texture.
      *
@@ -1126,6 +1278,34 @@ public:
         outline(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
     }
     
+    /**
+     * Outlines the vertex path with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other outline methods.  The texture no longer needs to be
+     * drawn uniformly over the wireframe. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The vertex path will be determined by the provided indices. The indices
+     * should be a multiple of two, preferably generated by the factories
+     * {@link PathOutliner} or {@link CubicSplineApproximator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+     * This is the index format of {@link Poly2} and the polygon tools.
+     *
+     * @param vertices  The list of vertices
+     * @param indices   The triangulation list
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void outline(const std::vector<Vertex2>& vertices, const std::vector<Uint32>& indices,
+                 const Affine2& transform, bool tint = true) {
+        outline(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
+    }
+    
     /**
      * Outlines the vertex path with the current texture.
      *
@@ -1154,6 +1334,37 @@ public:
                  const unsigned short* indices, unsigned int isize, unsigned int ioffset,
                  const Mat4& transform, bool tint = true);
     
+    /**
+     * Outlines the vertex path with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other outline methods.  The texture no longer needs to be
+     * drawn uniformly over the wireframe. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The vertex path will be determined by the provided indices. The indices
+     * should be a multiple of two, preferably generated by the factories
+     * {@link PathOutliner} or {@link CubicSplineApproximator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+     * This is the index format of {@link Poly2} and the polygon tools.
+     *
+     * @param vertices  The array of vertices
+     * @param vsize     The size of the vertex array
+     * @param voffset   The first element of the vertex array
+     * @param indices   The triangulation array
+     * @param isize     The size of the index array
+     * @param ioffset   The first element of the index array
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void outline(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                 const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                 const Mat4& transform, bool tint = true);
+    
     /**
      * Outlines the vertex path with the current texture.
      *
@@ -1182,6 +1393,37 @@ public:
                  const unsigned short* indices, unsigned int isize, unsigned int ioffset,
                  const Affine2& transform, bool tint = true);
     
+    /**
+     * Outlines the vertex path with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other outline methods.  The texture no longer needs to be
+     * drawn uniformly over the wireframe. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The vertex path will be determined by the provided indices. The indices
+     * should be a multiple of two, preferably generated by the factories
+     * {@link PathOutliner} or {@link CubicSplineApproximator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+     * This is the index format of {@link Poly2} and the polygon tools.
+     *
+     * @param vertices  The array of vertices
+     * @param vsize     The size of the vertex array
+     * @param voffset   The first element of the vertex array
+     * @param indices   The triangulation array
+     * @param isize     The size of the index array
+     * @param ioffset   The first element of the index array
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void outline(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                 const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                 const Affine2& transform, bool tint = true);
+    
 #pragma mark -
 #pragma mark Convenience Methods
     /**
@@ -1907,6 +2149,89 @@ private:
                          const unsigned short* indices, unsigned int isize, unsigned int ioffset,
                          bool solid, bool tint = true);
 
+    /**
+     * Returns the number of vertices added to the drawing buffer.
+     *
+     * This method adds the given vertices and indices to the drawing buffer,
+     * but does not draw them.  You must call flush() to draw the mesh.
+     *
+     * @param vertices  The vertices to add to the buffer
+     * @param vsize     The number of vertices to add
+     * @param voffset   The position of the first vertex to add
+     * @param indices   The indices to add to the buffer
+     * @param isize     The number of indices to add
+     * @param ioffset   The position of the first index to add
+     * @param solid     Whether the vertex mesh is to be filled
+     * @param tint      Whether to tint with the active color
+     *
+     * @return the number of vertices added to the drawing buffer.
+     */
+    unsigned int prepare(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                         const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                         bool solid, bool tint = true);
+
+    /**
+     * Returns the number of vertices added to the drawing buffer.
+     *
+     * This method is the shared implementation of prepare for both index
+     * widths.  It adds the given vertices and indices to the drawing buffer,
+     * but does not draw them.  You must call flush() to draw the mesh.
+     *
+     * @param vertices  The vertices to add to the buffer
+     * @param vsize     The number of vertices to add
+     * @param voffset   The position of the first vertex to add
+     * @param indices   The indices to add to the buffer
+     * @param isize     The number of indices to add
+     * @param ioffset   The position of the first index to add
+     * @param solid     Whether the vertex mesh is to be filled
+     * @param tint      Whether to tint with the active color
+     *
+     * @return the number of vertices added to the drawing buffer.
+     */
+    template <typename T>
+    unsigned int prepareMesh(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                             const T* indices, unsigned int isize, unsigned int ioffset,
+                             bool solid, bool tint);
+
+    /**
+     * Ensures that the drawing buffer has room for the given mesh.
+     *
+     * If the mesh does not fit in the remaining space, the sprite batch will
+     * flush.  If the mesh is larger than the entire buffer, the buffer is grown
+     * to fit it.  That way a large mesh is always drawn in one piece, instead
+     * of overflowing the buffer.
+     *
+     * @param vsize     The number of vertices to add
+     * @param isize     The number of indices to add
+     */
+    void reserve(unsigned int vsize, unsigned int isize);
+
+    /**
+     * Transforms the positions of the most recently prepared vertices.
+     *
+     * The vertices are the last count vertices in the drawing buffer, which
+     * are the ones added by the previous call to prepare.  The positions are
+     * transformed in bulk, which is much faster than transforming each one
+     * individually on vectorized platforms.
+     *
+     * @param transform The coordinate transform
+     * @param count     The number of vertices to transform
+     */
+    void transformVertices(const Mat4& transform, unsigned int count);
+
+    /**
+     * Transforms the positions of the most recently prepared vertices.
+     *
+     * The vertices are the last count vertices in the drawing buffer, which
+     * are the ones added by the previous call to prepare.  The positions are
+     * transformed in bulk, which is much faster than transforming each one
+     * individually on vectorized platforms.
+     *
+     * @param transform The coordinate transform
+     * @param count     The number of vertices to transform
+     */
+    void transformVertices(const Affine2& transform, unsigned int count);
+
 };
 
 }
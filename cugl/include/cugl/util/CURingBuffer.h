@@ -0,0 +1,212 @@
+//
+//  CURingBuffer.h
+//  Cornell University Game Library (CUGL)
+//
+//  This header provides a template for a lock-free ring buffer.  The ring
+//  buffer is safe to use between exactly two threads: one thread that only
+//  writes to the buffer and one thread that only reads from it.  This is the
+//  classic way to send commands to a real-time thread (such as an audio
+//  callback) without ever blocking on a mutex.
+//
+//  This is not a class. It is a class template. Templates do not have cpp
+//  files. They only have a header file.  When you include the header, it
+//  compiles the specific template used by your program. Hence all of the code
+//  for this templated class is in this header.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_RING_BUFFER_H__
+#define __CU_RING_BUFFER_H__
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark RingBuffer Template
+
+/**
+ * Template for a lock-free, single-producer single-consumer ring buffer
+ *
+ * A ring buffer is a fixed capacity FIFO queue.  It is safe to use this
+ * class from two threads at once, provided that one thread only calls
+ * {@link push()} and the other thread only calls {@link pop()} (or
+ * {@link peek()}).  Neither operation ever blocks or allocates memory,
+ * which makes this class safe to use inside of a real-time callback.
+ *
+ * The elements must be copyable and should be small.  They are copied
+ * into and out of the buffer by value.
+ *
+ * The capacity is rounded up to the next power of two.  A push to a full
+ * buffer fails (returning false) rather than overwriting the oldest element.
+ */
+template <class T>
+class RingBuffer {
+private:
+    /** The element storage */
+    std::unique_ptr<T[]> _data;
+    /** The capacity mask (capacity-1) */
+    size_t _mask;
+    /** The position of the next element to read (owned by the consumer) */
+    std::atomic<size_t> _head;
+    /** The position of the next element to write (owned by the producer) */
+    std::atomic<size_t> _tail;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a new ring buffer with no capacity.
+     *
+     * You must initialize this ring buffer before use.
+     */
+    RingBuffer() : _mask(0), _head(0), _tail(0) { }
+
+    /**
+     * Deletes this ring buffer, releasing all memory.
+     */
+    ~RingBuffer() { dispose(); }
+
+    /**
+     * Disposes this ring buffer, releasing all memory.
+     *
+     * This method is not thread safe, and should only be called when neither
+     * the producer nor the consumer is active.
+     */
+    void dispose() {
+        _data.reset();
+        _mask = 0;
+        _head.store(0);
+        _tail.store(0);
+    }
+
+    /**
+     * Initializes a ring buffer with the given capacity.
+     *
+     * The capacity is rounded up to the nearest power of two.
+     *
+     * @param capacity  The number of elements the buffer can hold
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(size_t capacity) {
+        if (_data != nullptr || capacity == 0) {
+            return false;
+        }
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _data.reset(new T[size]);
+        _mask = size-1;
+        _head.store(0);
+        _tail.store(0);
+        return true;
+    }
+
+#pragma mark Queue Operations
+    /**
+     * Returns the capacity of this ring buffer.
+     *
+     * @return the capacity of this ring buffer.
+     */
+    size_t capacity() const { return _mask+1; }
+
+    /**
+     * Returns the number of elements in this ring buffer.
+     *
+     * This value is only a snapshot if the other thread is active.
+     *
+     * @return the number of elements in this ring buffer.
+     */
+    size_t size() const {
+        return _tail.load(std::memory_order_acquire)-_head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Returns true if this ring buffer is empty.
+     *
+     * This value is only a snapshot if the other thread is active.
+     *
+     * @return true if this ring buffer is empty.
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * Adds an element to the end of this ring buffer.
+     *
+     * This method should only be called by the producer thread.
+     *
+     * @param value The element to add
+     *
+     * @return true if there was room for the element
+     */
+    bool push(const T& value) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail-_head.load(std::memory_order_acquire) > _mask) {
+            return false;
+        }
+        _data[tail & _mask] = value;
+        _tail.store(tail+1,std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes an element from the front of this ring buffer.
+     *
+     * This method should only be called by the consumer thread.
+     *
+     * @param value The element to store the result
+     *
+     * @return true if there was an element to remove
+     */
+    bool pop(T& value) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = _data[head & _mask];
+        _head.store(head+1,std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns a pointer to the element at the front of this ring buffer.
+     *
+     * This method should only be called by the consumer thread.  The element
+     * remains in the buffer.  If the buffer is empty, this returns nullptr.
+     *
+     * @return a pointer to the element at the front of this ring buffer.
+     */
+    const T* peek() const {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &_data[head & _mask];
+    }
+};
+
+}
+
+#endif /* __CU_RING_BUFFER_H__ */
@@ -34,5 +34,6 @@
 #include "CUFreeList.h"
 #include "CUGreedyFreeList.h"
 #include "CUThreadPool.h"
+#include "CURingBuffer.h"
 
 #endif /* __CU_UTIL_PKG_H__ */
@@ -39,6 +39,7 @@
 //  Author: Walker White
 //  Version: 7/6/16
 #include <cugl/2d/CULabel.h>
+#include <cugl/2d/CUTextBatch.h>
 #include <cugl/assets/CUSceneLoader.h>
 #include <cugl/assets/CUAssetManager.h>
 
@@ -86,6 +87,7 @@ void Label::dispose() {
     _valign = VAlign::BOTTOM;
     _padding = Vec2::ZERO;
     _rendered = false;
+    _textbatch = nullptr;
     Node::dispose();
 }
 
@@ -512,12 +514,18 @@ void Label::setBackground(Color4 color) {
  * correct.  In addition, this method does not need to check for visibility,
  * as it is guaranteed to only be called when the node is visible.
  *
+ * If this label has a text batch, the text is added to that batch
+ * instead of being drawn immediately.
+ *
  * @param batch     The SpriteBatch to draw with.
  * @param matrix    The global transformation matrix.
  * @param tint      The tint to blend with the Node color.
  */
 void Label::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
-    if (!_rendered) {
+    if (_textbatch != nullptr) {
+        _textbatch->add(this, transform, tint);
+        return;
+    } else if (!_rendered) {
         generateRenderData();
     }
 
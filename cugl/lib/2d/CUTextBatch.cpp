@@ -0,0 +1,327 @@
+//
+//  CUTextBatch.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a batch for rendering the text of many labels at
+//  once.  Normally each label sets its own texture and pushes its own mesh
+//  to the SpriteBatch.  When labels with different fonts are interleaved with
+//  other sprites, this causes the SpriteBatch to flush repeatedly.  This class
+//  gathers the glyph quads of many labels, grouped by texture page, and then
+//  emits each page as a single mesh.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/2d/CUTextBatch.h>
+#include <cugl/2d/CULabel.h>
+#include <cugl/2d/CUFont.h>
+#include <cugl/renderer/CUSpriteBatch.h>
+#include <cugl/renderer/CUTexture.h>
+#include <algorithm>
+
+using namespace cugl;
+
+/** The maximum number of vertices in a single mesh (so it fits in a default SpriteBatch) */
+#define MESH_CAPACITY DEFAULT_CAPACITY
+
+#pragma mark Constructors
+/**
+ * Creates an uninitialized text batch.
+ *
+ * You must initialize this batch before use.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+TextBatch::TextBatch() :
+_pagesize(0),
+_lastBuffer(0),
+_naiveCalls(0),
+_labelCount(0),
+_blendEquation(GL_FUNC_ADD),
+_srcFactor(GL_SRC_ALPHA),
+_dstFactor(GL_ONE_MINUS_SRC_ALPHA),
+_initialized(false) {
+}
+
+/**
+ * Disposes all of the resources used by this batch.
+ *
+ * A disposed batch can be safely reinitialized.
+ */
+void TextBatch::dispose() {
+    _pages.clear();
+    _pagemap.clear();
+    _scratch.clear();
+    _pagesize = 0;
+    _lastBuffer = 0;
+    _naiveCalls = 0;
+    _labelCount = 0;
+    _blendEquation = GL_FUNC_ADD;
+    _srcFactor = GL_SRC_ALPHA;
+    _dstFactor = GL_ONE_MINUS_SRC_ALPHA;
+    _initialized = false;
+}
+
+/**
+ * Initializes an empty text batch.
+ *
+ * The batch uses the standard alpha blending of a {@link Label}.
+ *
+ * @return true if initialization was successful.
+ */
+bool TextBatch::init() {
+    if (_initialized) {
+        CUAssertLog(false, "Text batch is already initialized");
+        return false;
+    }
+    _initialized = true;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Batching
+/**
+ * Adds the text of the given label to this batch.
+ *
+ * The label vertices are transformed by the given matrix and tinted by
+ * the given color as they are added. The matrix should be the global
+ * transform of the label (e.g. the value passed to {@link Node#draw}).
+ * If the label has a background color, the background panel is added
+ * as well.
+ *
+ * @param label     The label to add
+ * @param transform The global transformation matrix
+ * @param tint      The tint to blend with the label colors
+ */
+void TextBatch::add(Label* label, const Mat4& transform, Color4 tint) {
+    if (label == nullptr) {
+        return;
+    } else if (!label->_rendered) {
+        label->generateRenderData();
+    }
+
+    size_t offset = 0;
+    if (label->_background != Color4::CLEAR) {
+        Page& backing = acquire(SpriteBatch::getBlankTexture());
+        append(backing, label->_vertices.data(), 4, transform, tint);
+        offset = 4;
+    }
+
+    if (label->_vertices.size() > offset && label->_texture != nullptr) {
+        Page& glyphs = acquire(label->_texture);
+        append(glyphs, label->_vertices.data()+offset, label->_vertices.size()-offset, transform, tint);
+    }
+    _labelCount++;
+}
+
+/**
+ * Adds a single line of text to this batch without a label.
+ *
+ * The text is laid out with the font starting at the given origin, which
+ * is the bottom left corner of the text bounds. The glyphs are then
+ * transformed by the given matrix and colored with the given color.
+ *
+ * This method is useful for transient text like damage numbers, which
+ * do not warrant a scene graph node.
+ *
+ * @param font      The font to render the text
+ * @param text      The text to render
+ * @param origin    The bottom left corner of the text bounds
+ * @param transform The global transformation matrix
+ * @param color     The text color
+ */
+void TextBatch::add(const std::shared_ptr<Font>& font, const std::string& text, const Vec2& origin,
+                    const Mat4& transform, Color4 color) {
+    CUAssertLog(font != nullptr, "The font is undefined");
+    _scratch.clear();
+    std::shared_ptr<Texture> texture = font->getQuads(text, origin, _scratch);
+    if (texture != nullptr && !_scratch.empty()) {
+        Page& glyphs = acquire(texture);
+        append(glyphs, _scratch.data(), _scratch.size(), transform, color);
+    }
+    _labelCount++;
+}
+
+/**
+ * Draws all the text in this batch to the given SpriteBatch.
+ *
+ * Each texture page is drawn as a single mesh (unless it exceeds the
+ * vertex capacity of a default SpriteBatch).  The page of background
+ * panels is drawn first, so that the glyphs are on top of every panel.
+ * The SpriteBatch must be active. The text is not cleared afterwards,
+ * so the same batch may be drawn several times.  Call {@link clear} to
+ * start a new pass.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ */
+void TextBatch::draw(const std::shared_ptr<SpriteBatch>& batch) {
+    if (_pagesize == 0) {
+        return;
+    }
+
+    batch->setBlendEquation(_blendEquation);
+    batch->setBlendFunc(_srcFactor, _dstFactor);
+    batch->setColor(Color4::WHITE);
+
+    // Pages are in order of first use, so the backgrounds must go first
+    auto it = _pagemap.find(SpriteBatch::getBlankTexture()->getBuffer());
+    size_t backing = (it == _pagemap.end() ? _pagesize : it->second);
+    if (backing < _pagesize) {
+        drawPage(batch,_pages[backing]);
+    }
+    for(size_t ii = 0; ii < _pagesize; ii++) {
+        if (ii != backing) {
+            drawPage(batch,_pages[ii]);
+        }
+    }
+}
+
+/**
+ * Removes all text from this batch.
+ *
+ * The page buffers are retained (but emptied), so that subsequent
+ * passes do not need to allocate any memory.
+ */
+void TextBatch::clear() {
+    for(size_t ii = 0; ii < _pagesize; ii++) {
+        Page& page = _pages[ii];
+        page.texture = nullptr;
+        page.vertices.clear();
+        page.indices.clear();
+        page.vsplits.clear();
+        page.isplits.clear();
+    }
+    _pagemap.clear();
+    _pagesize = 0;
+    _lastBuffer = 0;
+    _naiveCalls = 0;
+    _labelCount = 0;
+}
+
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Returns the page for the given texture, creating it if necessary.
+ *
+ * This method also updates the estimate of unbatched draw calls.
+ *
+ * @param texture   The page texture
+ *
+ * @return the page for the given texture
+ */
+TextBatch::Page& TextBatch::acquire(const std::shared_ptr<Texture>& texture) {
+    GLuint buffer = texture->getBuffer();
+    if (buffer != _lastBuffer) {
+        _naiveCalls++;
+        _lastBuffer = buffer;
+    }
+
+    auto it = _pagemap.find(buffer);
+    if (it != _pagemap.end()) {
+        return _pages[it->second];
+    }
+
+    if (_pagesize == _pages.size()) {
+        _pages.emplace_back();
+    }
+    Page& page = _pages[_pagesize];
+    page.texture = texture;
+    _pagemap[buffer] = _pagesize++;
+    return page;
+}
+
+/**
+ * Appends the given quads to the page, transforming and tinting them.
+ *
+ * The vertices are assumed to be quads, in the order produced by
+ * {@link Font#getQuads}. If the page exceeds the mesh capacity, a new
+ * mesh is started in the same page, and the quads are split between them.
+ *
+ * @param page      The page to append to
+ * @param vertices  The vertices to add
+ * @param vsize     The number of vertices to add
+ * @param transform The global transformation matrix
+ * @param tint      The color tint
+ */
+void TextBatch::append(Page& page, const Vertex2* vertices, size_t vsize, const Mat4& transform, Color4 tint) {
+    CUAssertLog(vsize % 4 == 0, "Text vertices are not quads: %zu", vsize);
+    while (vsize > 0) {
+        if (page.vsplits.empty() || page.vertices.size()-page.vsplits.back() == MESH_CAPACITY) {
+            page.vsplits.push_back(page.vertices.size());
+            page.isplits.push_back(page.indices.size());
+        }
+
+        size_t vstart = page.vertices.size();
+        size_t mstart = vstart-page.vsplits.back();
+        size_t amount = std::min(vsize,(size_t)MESH_CAPACITY-mstart);
+        page.vertices.resize(vstart+amount);
+        Vertex2* dest = page.vertices.data()+vstart;
+        Mat4::transform(transform,&(vertices->position),sizeof(Vertex2),
+                        &(dest->position),sizeof(Vertex2),amount);
+        for(size_t ii = 0; ii < amount; ii++) {
+            dest[ii].color = vertices[ii].color*tint;
+            dest[ii].texcoord = vertices[ii].texcoord;
+        }
+
+        page.indices.reserve(page.indices.size()+(amount/4)*6);
+        for(size_t jj = mstart; jj < mstart+amount; jj += 4) {
+            unsigned short base = (unsigned short)jj;
+            page.indices.push_back(base  ); page.indices.push_back(base+1); page.indices.push_back(base+2);
+            page.indices.push_back(base+2); page.indices.push_back(base+3); page.indices.push_back(base  );
+        }
+        vertices += amount;
+        vsize -= amount;
+    }
+}
+
+/**
+ * Draws the meshes of a single page to the given SpriteBatch.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ * @param page      The page to draw
+ */
+void TextBatch::drawPage(const std::shared_ptr<SpriteBatch>& batch, const Page& page) {
+    batch->setTexture(page.texture);
+    for(size_t jj = 0; jj < page.vsplits.size(); jj++) {
+        size_t vstart = page.vsplits[jj];
+        size_t istart = page.isplits[jj];
+        size_t vend = (jj+1 < page.vsplits.size() ? page.vsplits[jj+1] : page.vertices.size());
+        size_t iend = (jj+1 < page.isplits.size() ? page.isplits[jj+1] : page.indices.size());
+        batch->fill(page.vertices.data(),(unsigned int)(vend-vstart),(unsigned int)vstart,
+                    page.indices.data(), (unsigned int)(iend-istart),(unsigned int)istart,
+                    Mat4::IDENTITY,false);
+    }
+}
@@ -34,6 +34,7 @@
 #include <algorithm>
 #include <cugl/2d/CUTexturedNode.h>
 #include <cugl/util/CUStrings.h>
+#include <cugl/math/CUAffine2.h>
 #include <cugl/assets/CUSceneLoader.h>
 #include <cugl/assets/CUAssetManager.h>
 #include <sstream>
@@ -283,7 +284,7 @@ bool TexturedNode::initWithData(const SceneLoader* loader, const std::shared_ptr
 
     // Get the geometry
     std::vector<Vec2> vertices;
-    std::vector<unsigned short> indices;
+    std::vector<Uint32> indices;
 
     if (data->has("polygon")) {
         JsonValue* poly = data->get("polygon").get();
@@ -461,12 +462,16 @@ void TexturedNode::generateRenderData() {
     }
 
     Vec2 offset = _polygon.getBounds().origin;
-    for(auto it = _polygon.getVertices().begin(); it != _polygon.getVertices().end(); ++it) {
-        temp.position = *it*scale;
-        if (!_absolute) {
-            temp.position -= offset*scale;
-        }
-        
+    Affine2 local;
+    Affine2::createScale(scale,&local);
+    if (!_absolute) {
+        local.offset = -offset*scale;
+    }
+
+    const std::vector<Vec2>& vertices = _polygon.getVertices();
+    size_t vstart = _vertices.size();
+    _vertices.reserve(vstart+vertices.size());
+    for(auto it = vertices.begin(); it != vertices.end(); ++it) {
         float s = (it->x)/tsize.width;
         float t = (it->y)/tsize.height;
         if (_flipHorizontal) { s = 1-s; }
@@ -477,6 +482,12 @@ void TexturedNode::generateRenderData() {
         _vertices.push_back(temp);
     }
     
+    // Position the vertices in bulk
+    if (!vertices.empty()) {
+        Affine2::transform(local,vertices.data(),sizeof(Vec2),
+                           &(_vertices[vstart].position),sizeof(Vertex2),vertices.size());
+    }
+    
     _rendered = true;
 }
 
@@ -160,7 +160,7 @@ bool WireNode::initWithData(const SceneLoader* loader, const std::shared_ptr<Jso
     
     // Get the geometry
     std::vector<Vec2> vertices;
-    std::vector<unsigned short> indices;
+    std::vector<Uint32> indices;
     
     if (data->has("polygon")) {
         JsonValue* poly = data->get("polygon").get();
@@ -109,7 +109,7 @@ void BoxObstacle::resize(const Size& size) {
 void BoxObstacle::resetDebug() {
     Poly2 poly(Rect(Vec2::ZERO,_dimension));
 
-    unsigned short indx[8] = { 0, 1, 1, 2, 2, 3, 3, 0 };
+    Uint32 indx[8] = { 0, 1, 1, 2, 2, 3, 3, 0 };
     poly.setIndices(indx, 8);
     if (_debug == nullptr) {
         _debug = cugl::WireNode::allocWithPoly(poly);
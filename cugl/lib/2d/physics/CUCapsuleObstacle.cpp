@@ -288,7 +288,7 @@ void CapsuleObstacle::resetDebug() {
     
     // Create polygon
     Poly2 poly(vertices);
-    std::vector<unsigned short> indx;
+    std::vector<Uint32> indx;
     for(int ii = 0;  ii < vertices.size(); ii++) {
         indx.push_back(ii);
         indx.push_back(ii+1 == vertices.size() ? 0 : ii+1);
@@ -363,7 +363,7 @@ Poly2 ObstacleSelector::hatchPoly() const {
     verts[2].set(-_size.width/2,-_size.height/2);
     verts[3].set(_size.width/2,_size.height/2);
 
-    unsigned short indx[12] = { 0,3,3,1,1,2,2,0,0,1,2,3 };
+    Uint32 indx[12] = { 0,3,3,1,1,2,2,0,0,1,2,3 };
     
     Poly2 poly(verts,4,indx,12);
     poly.setType(Poly2::Type::PATH);
@@ -130,7 +130,7 @@ void PolygonObstacle::resetShapes() {
     b2Vec2 triangle[3];
     for(int ii = 0; ii < ntris; ii++) {
         for(int jj = 0; jj < 3; jj++) {
-            unsigned short ind = _polygon.getIndices()[3*ii+jj];
+            Uint32 ind = _polygon.getIndices()[3*ii+jj];
             Vec2 temp = _polygon.getVertices()[ind]-pos;
             triangle[jj].x = temp.x;
             triangle[jj].y = temp.y;
@@ -0,0 +1,341 @@
+//
+//  CUAudioBus.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a submix bus for the software mixer.  Buses form a
+//  tree rooted at the master bus.  Every sound effect voice is routed to a
+//  bus, and every bus other than master is mixed into its parent.  A bus has
+//  its own gain and an ordered chain of DSP nodes, which are applied to the
+//  submix before the gain.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/audio/CUAudioBus.h>
+#include <cugl/util/CUDebug.h>
+#include "CUAudioSIMD.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+using namespace cugl;
+using namespace cugl::simd;
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a degenerate bus with no buffer.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioBus::AudioBus() :
+_index(0),
+_parent(0),
+_gain(1.0f),
+_level(0.0f),
+_current(1.0f),
+_touched(false),
+_chain(nullptr),
+_blocks(0),
+_raw(nullptr),
+_buffer(nullptr),
+_capacity(0) {
+}
+
+/**
+ * Disposes all resources allocated for this bus.
+ *
+ * The bus must not be in use by the audio thread when this is called.
+ */
+void AudioBus::dispose() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _nodes.clear();
+    delete _chain.exchange(nullptr);
+    for(auto it = _retired.begin(); it != _retired.end(); ++it) {
+        delete it->second;
+    }
+    _retired.clear();
+    if (_raw != nullptr) {
+        free(_raw);
+        _raw = nullptr;
+    }
+    _buffer = nullptr;
+    _capacity = 0;
+    _touched = false;
+}
+
+/**
+ * Initializes a bus with the given name and position in the tree.
+ *
+ * A bus whose parent is its own index is a root (master) bus.
+ *
+ * @param name      The bus name
+ * @param index     The bus index in the mixer
+ * @param parent    The index of the parent bus
+ * @param capacity  The maximum block size in frames
+ *
+ * @return true if initialization was successful.
+ */
+bool AudioBus::init(const std::string& name, Uint32 index, Uint32 parent, Uint32 capacity) {
+    if (_raw != nullptr) {
+        CUAssertLog(false, "Audio bus is already initialized");
+        return false;
+    } else if (capacity == 0) {
+        CUAssertLog(false, "Audio bus must have a positive capacity");
+        return false;
+    } else if (parent > index) {
+        CUAssertLog(false, "The parent of a bus must come before it");
+        return false;
+    }
+
+    size_t size = capacity*2*sizeof(float);
+    _raw = malloc(size+15);
+    if (_raw == nullptr) {
+        return false;
+    }
+    _buffer = align16(_raw);
+    std::memset(_buffer,0,size);
+    _capacity = capacity;
+    _name   = name;
+    _index  = index;
+    _parent = parent;
+    _gain.store(1.0f);
+    _current = 1.0f;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Node Chain
+/**
+ * Returns the number of nodes in this bus.
+ *
+ * @return the number of nodes in this bus.
+ */
+size_t AudioBus::getNodeCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nodes.size();
+}
+
+/**
+ * Returns the node at the given position.
+ *
+ * @param pos   The node position
+ *
+ * @return the node at the given position.
+ */
+std::shared_ptr<AudioNode> AudioBus::getNode(size_t pos) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    CUAssertLog(pos < _nodes.size(), "Node position %zu is out of range", pos);
+    return _nodes[pos];
+}
+
+/**
+ * Returns the first node with the given name (or nullptr).
+ *
+ * @param name  The node name
+ *
+ * @return the first node with the given name (or nullptr).
+ */
+std::shared_ptr<AudioNode> AudioBus::getNode(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(auto it = _nodes.begin(); it != _nodes.end(); ++it) {
+        if ((*it)->getName() == name) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Appends a node to the end of the chain.
+ *
+ * @param node  The node to append
+ */
+void AudioBus::addNode(const std::shared_ptr<AudioNode>& node) {
+    CUAssertLog(node != nullptr, "Attempt to add a null node");
+    std::lock_guard<std::mutex> lock(_mutex);
+    _nodes.push_back(node);
+    publish();
+}
+
+/**
+ * Inserts a node at the given position in the chain.
+ *
+ * @param pos   The position to insert at
+ * @param node  The node to insert
+ */
+void AudioBus::insertNode(size_t pos, const std::shared_ptr<AudioNode>& node) {
+    CUAssertLog(node != nullptr, "Attempt to add a null node");
+    std::lock_guard<std::mutex> lock(_mutex);
+    pos = std::min(pos,_nodes.size());
+    _nodes.insert(_nodes.begin()+pos,node);
+    publish();
+}
+
+/**
+ * Removes a node from the chain.
+ *
+ * @param node  The node to remove
+ *
+ * @return true if the node was in the chain
+ */
+bool AudioBus::removeNode(const std::shared_ptr<AudioNode>& node) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = std::find(_nodes.begin(),_nodes.end(),node);
+    if (it == _nodes.end()) {
+        return false;
+    }
+    _nodes.erase(it);
+    publish();
+    return true;
+}
+
+/**
+ * Removes all nodes from the chain.
+ */
+void AudioBus::clearNodes() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _nodes.clear();
+    publish();
+}
+
+/**
+ * Publishes a copy of the node chain to the audio thread.
+ *
+ * The replaced copy is deleted once the audio thread has finished a
+ * block without it.  This method must be called while holding the lock.
+ */
+void AudioBus::publish() {
+    NodeChain* chain = _nodes.empty() ? nullptr : new NodeChain(_nodes);
+    NodeChain* prior = _chain.exchange(chain);
+
+    // A block that read the prior chain has ended once the count passes this
+    Uint64 blocks = _blocks.load();
+    for(auto it = _retired.begin(); it != _retired.end(); ) {
+        if (it->first < blocks) {
+            delete it->second;
+            it = _retired.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (prior != nullptr) {
+        _retired.push_back(std::make_pair(blocks,prior));
+    }
+}
+
+
+#pragma mark -
+#pragma mark Profiling
+/**
+ * Returns a report of the CPU cost of each node in this bus.
+ *
+ * There is one line per node, with the average cost per block in
+ * microseconds and the load as a percentage of one core.
+ *
+ * @return a report of the CPU cost of each node in this bus.
+ */
+std::string AudioBus::getProfile() const {
+    char line[256];
+    float level = getLevel();
+    float db = level > 0 ? 20.0f*std::log10(level) : -INFINITY;
+    std::snprintf(line,sizeof(line),"bus %-12s gain %.2f level %6.1f dB\n",
+                  _name.c_str(),getGain(),db);
+    std::string result = line;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(auto it = _nodes.begin(); it != _nodes.end(); ++it) {
+        std::snprintf(line,sizeof(line),"  %-14s %9.2f us/block %7.3f%% load%s\n",
+                      (*it)->getName().c_str(),(*it)->getCost(),100*(*it)->getLoad(),
+                      (*it)->isBypassed() ? " (bypassed)" : "");
+        result += line;
+    }
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Mixing (Audio Thread)
+/**
+ * Clears the submix buffer for a new block.
+ *
+ * @param frames    The number of frames in the block
+ */
+void AudioBus::clear(Uint32 frames) {
+    std::memset(_buffer,0,frames*2*sizeof(float));
+    _touched = false;
+}
+
+/**
+ * Processes the submix and adds it to the given output.
+ *
+ * This applies the node chain and then the gain.  If the bus is silent
+ * and has no nodes, it does nothing and returns false.
+ *
+ * @param output    The output buffer (interleaved stereo)
+ * @param frames    The number of frames in the block
+ *
+ * @return true if anything was added to the output
+ */
+bool AudioBus::process(float* output, Uint32 frames) {
+    const NodeChain* chain = _chain.load();
+    float target = _gain.load(std::memory_order_relaxed);
+    if (!_touched && chain == nullptr) {
+        _current = target;
+        _level.store(0.0f,std::memory_order_relaxed);
+        _blocks.fetch_add(1);
+        return false;
+    }
+
+    if (chain != nullptr) {
+        for(auto it = chain->begin(); it != chain->end(); ++it) {
+            (*it)->render(_buffer,frames);
+        }
+    }
+    // The chain may be deleted once the count passes its replacement
+    _blocks.fetch_add(1);
+
+    float step = (target-_current)/frames;
+    float gains[2] = { _current, _current };
+    float steps[2] = { step, step };
+    mix_stereo(output,_buffer,frames,gains,steps);
+
+    float rms = std::sqrt(sum_squares(_buffer,2*frames)/(2*frames));
+    _level.store(rms*0.5f*(_current+target),std::memory_order_relaxed);
+    _current = target;
+    return true;
+}
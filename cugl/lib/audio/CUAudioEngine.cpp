@@ -59,16 +59,25 @@ AudioEngine* AudioEngine::_gEngine = nullptr;
  * the mixer graph for the sound effect channels.  The provided parameter
  * indicates the number of simultaneously supported sounds.
  *
+ * If offline is true, the engine does not open an audio device, and only
+ * advances when {@link render} is called.
+ *
  * @param channels  The maximum number of sound effect channels to support
+ * @param offline   Whether to render offline
  *
  * @return true if the audio engine was successfully initialized.
  */
-bool AudioEngine::init(unsigned int channels) {
+bool AudioEngine::init(unsigned int channels, bool offline) {
     CUAssertLog(channels, "The number of channels must be non-zero");
     
-    if (!cugl::impl::AudioStart(AUDIO_FREQUENCY, channels, AUDIO_OUTPUT_CHANNELS)) {
+    if (offline) {
+        if (!cugl::impl::AudioStartOffline(AUDIO_FREQUENCY, channels, AUDIO_OUTPUT_CHANNELS)) {
+            return false;
+        }
+    } else if (!cugl::impl::AudioStart(AUDIO_FREQUENCY, channels, AUDIO_OUTPUT_CHANNELS)) {
         return false;
     }
+    _offline = offline;
     
     _capacity = channels;
     for(int ii = 0; ii < _capacity; ii++) {
@@ -77,7 +86,18 @@ bool AudioEngine::init(unsigned int channels) {
     }
     _mqueue = MusicQueue::alloc();
     
-    // Initialize callbacks here
+    // Popped from the back, so channel 0 is used first
+    for(int ii = _capacity-1; ii >= 0; ii--) {
+        _freelist.push_back(ii);
+    }
+    
+    // Initialize callbacks here (offline engines update in render)
+    if (!_offline && Application::get()) {
+        _scheduler = Application::get()->schedule([this] {
+            updateVirtuals();
+            return true;
+        });
+    }
     return true;
 }
 
@@ -89,9 +109,23 @@ bool AudioEngine::init(unsigned int channels) {
  */
 void AudioEngine::dispose() {
     if (_capacity) {
+        if (_scheduler && Application::get()) {
+            Application::get()->unschedule(_scheduler);
+        }
+        _scheduler = 0;
         _mqueue = nullptr;
         _channels.clear();
+        _slots.clear();
+        _unused.clear();
+        _keys.clear();
+        _equeue.clear();
+        _audible = 0;
+        _virtual = 0;
+        _freelist.clear();
+        _stoplist.clear();
+        _shadowlist.clear();
         _capacity = 0;
+        _offline  = false;
         
         cugl::impl::AudioStop();
     }
@@ -103,10 +137,10 @@ void AudioEngine::dispose() {
 /**
  * Callback function for when a music channel finishes
  *
- * This method is called when the active music completes.  If there is any
- * music waiting in the queue, it plays it immediately (using the second
- * channel for a smooth transition).  Otherwise, it sets _musicData to
- * nullptr.
+ * This method is called when the active music completes.  If the next
+ * music in the queue has already taken over (because it was cued), it
+ * becomes the active music.  Otherwise, if there is any music waiting in
+ * the queue, it plays it immediately.
  *
  * This method is never intended to be accessed by general users.  It is
  * only publicly visible because this makes our cross-platform code cleaner.
@@ -118,7 +152,7 @@ void AudioEngine::gcMusic(bool status) {
         return;
     }
     std::shared_ptr<Music> prev = _mqueue->getCurrent();
-    _mqueue->advance();
+    _mqueue->complete();
     if (_musicCB) {
         _musicCB(prev.get(),status);
     }
@@ -145,37 +179,439 @@ void AudioEngine::gcEffect(int id, bool status) {
         return;
     }
     
-    std::string key = channel->getPrimaryKey();
-    removeKey(key);
+    EffectHandle handle = channel->getPrimaryHandle();
+    Effect* effect = lookup(handle);
+    std::string key;
+    if (effect != nullptr && effect->channel == id) {
+        key = effect->key;
+        removeEffect(handle);
+    } else {
+        handle = 0;
+    }
     if (channel->attached() == 2) {
         channel->advance();
     } else {
         channel->clear();
+        _freelist.push_back(id);
+    }
+    if (handle) {
+        if (_soundCB && !key.empty()) {
+            _soundCB(key,status);
+        }
+        if (_handleCB) {
+            _handleCB(handle,status);
+        }
+    }
+}
+
+/**
+ * Returns the effect for the given handle, or nullptr if it is invalid.
+ *
+ * A handle is invalid if its effect has completed, even if the slot has
+ * been reused since.
+ *
+ * @param handle    The effect handle
+ *
+ * @return the effect for the given handle, or nullptr if it is invalid.
+ */
+AudioEngine::Effect* AudioEngine::lookup(EffectHandle handle) {
+    Uint32 slot = (Uint32)(handle & 0xFFFFFFFF);
+    Uint32 generation = (Uint32)(handle >> 32);
+    if (slot >= _slots.size() || !_slots[slot].active || _slots[slot].generation != generation) {
+        return nullptr;
     }
-    if (_soundCB) {
-        _soundCB(key,status);
+    return &_slots[slot];
+}
+
+/**
+ * Returns the effect for the given handle, or nullptr if it is invalid.
+ *
+ * A handle is invalid if its effect has completed, even if the slot has
+ * been reused since.
+ *
+ * @param handle    The effect handle
+ *
+ * @return the effect for the given handle, or nullptr if it is invalid.
+ */
+const AudioEngine::Effect* AudioEngine::lookup(EffectHandle handle) const {
+    Uint32 slot = (Uint32)(handle & 0xFFFFFFFF);
+    Uint32 generation = (Uint32)(handle >> 32);
+    if (slot >= _slots.size() || !_slots[slot].active || _slots[slot].generation != generation) {
+        return nullptr;
     }
+    return &_slots[slot];
+}
 
+/**
+ * Returns the handle for the given key, or 0 if there is none.
+ *
+ * @param key   The reference key for the sound effect
+ *
+ * @return the handle for the given key, or 0 if there is none.
+ */
+EffectHandle AudioEngine::lookup(const std::string& key) const {
+    auto it = _keys.find(key);
+    return it == _keys.end() ? 0 : it->second;
 }
 
 /**
- * Purges this key from the list of active effects.
+ * Purges this effect from the list of active effects.
  *
  * This method is not the same as stopping the channel. A channel may play a
- * little longer after the key is removed.  This is simply a clean-up method.
+ * little longer after the effect is removed.  This is simply a clean-up
+ * method.  The slot is released, invalidating the handle.
  *
- * @remove key  The key to purge from the list of active effects.
+ * @param handle    The effect to purge from the list of active effects.
  */
-void AudioEngine::removeKey(std::string key) {
-    _effects.erase(key);
-    for(auto it = _equeue.begin(); it != _equeue.end(); ) {
-        if (*it == key) {
-            it = _equeue.erase(it);
-            break;
-        } else {
-            it++;
+void AudioEngine::removeEffect(EffectHandle handle) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    
+    if (effect->channel == -1) {
+        _virtual--;
+    } else {
+        _audible--;
+    }
+    if (!effect->key.empty()) {
+        auto it = _keys.find(effect->key);
+        if (it != _keys.end() && it->second == handle) {
+            _keys.erase(it);
+        }
+    }
+    
+    effect->active  = false;
+    effect->channel = -1;
+    effect->key.clear();
+    effect->sound = nullptr;
+    effect->generation = nextGeneration(effect->generation);
+    _unused.push_back((Uint32)(handle & 0xFFFFFFFF));
+}
+
+/**
+ * Returns a channel available for a new sound effect, or -1 if none.
+ *
+ * Channels with no attached assets are preferred.  Otherwise this
+ * method returns a stopped channel that is still waiting to detach.  In
+ * that case, shadow is set to true, and the new asset must be attached
+ * as a shadow asset.
+ *
+ * @param shadow    Whether the new asset must be a shadow asset
+ *
+ * @return a channel available for a new sound effect, or -1 if none.
+ */
+int AudioEngine::acquireChannel(bool& shadow) {
+    // The lists are lazily cleaned; entries may be stale
+    while (!_freelist.empty()) {
+        int id = _freelist.back();
+        _freelist.pop_back();
+        if (!_channels[id]->attached()) {
+            shadow = false;
+            return id;
+        }
+    }
+    while (!_stoplist.empty()) {
+        int id = _stoplist.back();
+        _stoplist.pop_back();
+        if (_channels[id]->isStopped() && _channels[id]->attached() == 1) {
+            shadow = true;
+            return id;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Starts a sound effect on the given channel.
+ *
+ * A shadow asset starts once the stopped asset has had a chance to
+ * fade out.  Normally this is the next animation frame.  For an offline
+ * engine, it is the start of the next call to {@link render}.
+ *
+ * @param id        The channel to play on
+ * @param shadow    Whether to attach the sound as a shadow asset
+ * @param handle    The handle for the sound effect
+ * @param sound     The sound effect to play
+ * @param volume    The sound effect volume
+ * @param loop      Whether to loop the sound effect continuously
+ * @param time      The position (in seconds) to start playback
+ */
+void AudioEngine::startChannel(int id, bool shadow, EffectHandle handle, const std::shared_ptr<Sound>& sound,
+                               float volume, bool loop, double time) {
+    std::shared_ptr<SoundChannel> thechannel = _channels[id];
+    Effect* effect = lookup(handle);
+    effect->channel = id;
+    effect->sound = nullptr;
+    applyEmitter(*effect);
+    thechannel->setBus(effect->bus);
+    thechannel->attach(handle,sound,volume,loop);
+    if (time > 0) {
+        thechannel->setCurrentTime((float)time);
+    }
+    if (!shadow) {
+        thechannel->play();
+    } else if (_offline) {
+        _shadowlist.push_back(id);
+    } else if (Application::get()) {
+        Application::get()->schedule([=] {
+            if (thechannel->attached() == 2) {
+                thechannel->advance();
+            }
+            return false;
+        });
+    } else {
+        // There is no animation frame to wait for
+        thechannel->advance();
+    }
+    _audible++;
+}
+
+/**
+ * Returns the audibility (volume times attenuation) of the given effect.
+ *
+ * @param effect    The sound effect
+ *
+ * @return the audibility (volume times attenuation) of the given effect.
+ */
+float AudioEngine::getAudibility(const Effect& effect) const {
+    float gain = effect.attenuation*getDistanceGain(effect);
+    if (effect.channel == -1) {
+        return effect.volume*gain;
+    }
+    return _channels[effect.channel]->getVolume()*gain;
+}
+
+/**
+ * Returns the distance attenuation of the given effect.
+ *
+ * This is a scalar version of the computation performed by the mixer,
+ * and is used to rank effects.  It is 1 for effects without a position.
+ *
+ * @param effect    The sound effect
+ *
+ * @return the distance attenuation of the given effect.
+ */
+float AudioEngine::getDistanceGain(const Effect& effect) const {
+    if (!effect.positional) {
+        return 1.0f;
+    }
+    float dist = effect.position.distance(_listenerPos);
+    float clamped = std::max(std::min(dist,effect.maximum),effect.reference);
+    switch (_model) {
+        case DistanceModel::NONE:
+            return 1.0f;
+        case DistanceModel::INVERSE:
+            return effect.reference/(effect.reference+effect.rolloff*(clamped-effect.reference));
+        case DistanceModel::LINEAR:
+        {
+            float range = std::max(effect.maximum-effect.reference,1e-6f);
+            float gain  = 1.0f-effect.rolloff*(clamped-effect.reference)/range;
+            return std::max(std::min(gain,1.0f),0.0f);
+        }
+        case DistanceModel::EXPONENTIAL:
+            return std::pow(clamped/effect.reference,-effect.rolloff);
+    }
+    return 1.0f;
+}
+
+/**
+ * Sends the emitter of the given effect to its channel.
+ *
+ * Effects without a position clear the emitter of the channel.
+ *
+ * @param effect    The sound effect (which must have a channel)
+ */
+void AudioEngine::applyEmitter(const Effect& effect) {
+    std::shared_ptr<SoundChannel> channel = _channels[effect.channel];
+    if (effect.positional) {
+        channel->setEmitter(effect.position,effect.velocity,
+                            effect.reference,effect.maximum,effect.rolloff);
+    } else {
+        channel->clearEmitter();
+    }
+}
+
+/**
+ * Returns the lowest ranked effect with a channel, or 0 if none.
+ *
+ * Only effects that are outranked by the given priority and audibility
+ * are considered, unless force is true.  Ties are broken in favor of
+ * stealing from the oldest effect.
+ *
+ * @param priority  The priority of the effect that needs a channel
+ * @param volume    The audibility of the effect that needs a channel
+ * @param force     Whether to consider all effects
+ *
+ * @return the lowest ranked effect with a channel, or 0 if none.
+ */
+EffectHandle AudioEngine::findVictim(Sint32 priority, float volume, bool force) const {
+    EffectHandle result = 0;
+    Sint32 lowp = priority;
+    float  lowv = volume;
+    for(auto it = _equeue.begin(); it != _equeue.end(); ++it) {
+        const Effect* effect = lookup(*it);
+        // Skip stale handles, virtual effects and channels waiting on a shadow asset
+        if (effect == nullptr || effect->channel == -1 || _channels[effect->channel]->attached() != 1) {
+            continue;
+        }
+        float v = getAudibility(*effect);
+        if ((force && result == 0) || outranks(lowp,lowv,effect->priority,v)) {
+            result = *it;
+            lowp = effect->priority;
+            lowv = v;
+        }
+    }
+    return result;
+}
+
+/**
+ * Moves an effect from its channel to the virtual effects.
+ *
+ * The channel is stopped, but the effect remains active and keeps
+ * track of its playback position.
+ *
+ * @param effect    The sound effect
+ *
+ * @return the channel freed by this effect
+ */
+int AudioEngine::virtualize(Effect& effect) {
+    int id = effect.channel;
+    std::shared_ptr<SoundChannel> channel = _channels[id];
+    effect.sound   = channel->getPrimary();
+    effect.volume  = channel->getVolume();
+    effect.loop    = channel->getLoop();
+    effect.paused  = channel->isPaused();
+    effect.elapsed = channel->getCurrentTime();
+    markEffect(effect);
+    effect.channel = -1;
+    channel->stop();
+    _audible--;
+    _virtual++;
+    return id;
+}
+
+/**
+ * Records the current time as the reference for the effect position.
+ *
+ * The position of a virtual effect is measured from this time.
+ *
+ * @param effect    The sound effect
+ */
+void AudioEngine::markEffect(Effect& effect) const {
+    effect.marked.mark();
+    effect.clock = impl::AudioGetClock();
+}
+
+/**
+ * Returns the current playback position of a virtual effect in seconds.
+ *
+ * For effects that do not loop, this value may exceed the duration.
+ * An offline engine measures this position with the audio clock, so
+ * that it only advances when the engine is rendered.
+ *
+ * @param effect    The virtual effect
+ *
+ * @return the current playback position of a virtual effect in seconds.
+ */
+double AudioEngine::getVirtualTime(const Effect& effect) const {
+    if (effect.paused) {
+        return effect.elapsed;
+    }
+    double time = effect.elapsed;
+    if (_offline) {
+        time += (impl::AudioGetClock()-effect.clock)/(double)impl::AudioGetSampleRate();
+    } else {
+        Timestamp now;
+        time += Timestamp::ellapsedMillis(effect.marked,now)/1000.0;
+    }
+    double duration = effect.sound->getDuration();
+    if (effect.loop && duration > 0) {
+        time = fmod(time,duration);
+    }
+    return time;
+}
+
+/**
+ * Updates the virtual effects, moving the most audible ones to channels.
+ *
+ * This method also garbage collects any virtual effects that would
+ * have completed by now.  It is called once every animation frame.
+ */
+void AudioEngine::updateVirtuals() {
+    if (_virtual == 0) {
+        return;
+    }
+    
+    // Collect the effects that finished while inaudible
+    for(Uint32 ii = 0; ii < _slots.size(); ii++) {
+        const Effect& effect = _slots[ii];
+        if (effect.active && effect.channel == -1 && !effect.loop &&
+            getVirtualTime(effect) >= effect.sound->getDuration()) {
+            EffectHandle handle = handleOf(ii);
+            std::string key = effect.key;
+            removeEffect(handle);
+            if (_soundCB && !key.empty()) {
+                _soundCB(key,true);
+            }
+            if (_handleCB) {
+                _handleCB(handle,true);
+            }
+        }
+    }
+    
+    // Promote the best virtual effects while they outrank a playing effect
+    while (_virtual > 0) {
+        Uint32 best = (Uint32)_slots.size();
+        Sint32 bestp = 0;
+        float  bestv = 0;
+        for(Uint32 ii = 0; ii < _slots.size(); ii++) {
+            const Effect& effect = _slots[ii];
+            if (!effect.active || effect.channel != -1 || effect.paused) {
+                continue;
+            }
+            float v = getAudibility(effect);
+            if (best == _slots.size() || outranks(effect.priority,v,bestp,bestv)) {
+                best  = ii;
+                bestp = effect.priority;
+                bestv = v;
+            }
+        }
+        if (best == _slots.size()) {
+            return;
+        }
+        
+        bool shadow = false;
+        int audioID = acquireChannel(shadow);
+        if (audioID == -1) {
+            EffectHandle victim = findVictim(bestp,bestv,false);
+            if (victim == 0) {
+                return;
+            }
+            audioID = virtualize(*lookup(victim));
+            shadow = true;
+        }
+        
+        Effect& effect = _slots[best];
+        std::shared_ptr<Sound> sound = effect.sound;
+        _virtual--;
+        startChannel(audioID,shadow,handleOf(best),sound,effect.volume,effect.loop,getVirtualTime(effect));
+    }
+}
+
+/**
+ * Starts the shadow assets waiting on channels of an offline engine.
+ *
+ * This takes the place of the callback that a realtime engine
+ * schedules with the {@link Application}.
+ */
+void AudioEngine::advanceShadows() {
+    for(auto it = _shadowlist.begin(); it != _shadowlist.end(); ++it) {
+        if (_channels[*it]->attached() == 2) {
+            _channels[*it]->advance();
         }
     }
+    _shadowlist.clear();
 }
 
 
@@ -208,6 +644,34 @@ void AudioEngine::start(unsigned int channels) {
     }
 }
 
+/**
+ * Starts the singleton audio engine without an audio device.
+ *
+ * An offline engine behaves like a normal engine, except that time only
+ * advances when {@link render} is called.  Completion callbacks are
+ * invoked inside of that method, so the behavior of the engine is
+ * deterministic.  This is intended for automated tests and benchmarks
+ * (see {@link AudioRecorder}).
+ *
+ * Offline rendering requires the SDL audio backend.  On other backends,
+ * this method fails and get() will continue to return nullptr.  Calling
+ * the method while an engine is running (without calling stop) will have
+ * no effect.
+ *
+ * @param channels  The maximum number of sound effect channels to support
+ */
+void AudioEngine::startOffline(unsigned int channels) {
+    if (_gEngine != nullptr) {
+        return;
+    }
+    _gEngine = new AudioEngine();
+    if (!_gEngine->init(channels,true)) {
+        delete _gEngine;
+        _gEngine = nullptr;
+        CULogError("Offline sound engine failed to initialize");
+    }
+}
+
 /**
  * Stops the singleton audio engine, releasing all resources.
  *
@@ -227,6 +691,51 @@ void AudioEngine::stop() {
 }
 
 
+#pragma mark -
+#pragma mark Offline Rendering
+/**
+ * Returns the sample rate of the engine output.
+ *
+ * @return the sample rate of the engine output.
+ */
+Uint32 AudioEngine::getSampleRate() const {
+    return impl::AudioGetSampleRate();
+}
+
+/**
+ * Returns the number of channels of the engine output.
+ *
+ * @return the number of channels of the engine output.
+ */
+Uint32 AudioEngine::getOutputChannels() const {
+    return impl::AudioGetOutputChannels();
+}
+
+/**
+ * Advances an offline engine by the given number of frames.
+ *
+ * The output is interleaved floats, with {@link getOutputChannels}
+ * samples per frame.  The previous contents of the buffer are replaced.
+ * Any completion callbacks are invoked (and virtual effects are updated)
+ * before this method returns.  Sounds that took over the channel of
+ * another sound since the last call start on the first frame.
+ *
+ * This method may only be called on an offline engine.
+ *
+ * @param output    The output buffer
+ * @param frames    The number of frames to render
+ */
+void AudioEngine::render(float* output, Uint32 frames) {
+    CUAssertLog(_offline, "Only an offline audio engine may be rendered");
+    if (!_offline) {
+        return;
+    }
+    advanceShadows();
+    impl::AudioRender(output,frames);
+    updateVirtuals();
+}
+
+
 #pragma mark -
 #pragma mark Music Management
 /**
@@ -254,10 +763,52 @@ void AudioEngine::stop() {
  * @param fade      The number of seconds to fade in
  */
 void AudioEngine::playMusic(const std::shared_ptr<Music>& music, bool loop, float volume, float fade) {
+    impl::AudioPoll();
+    // The queue is empty after a stop, so this plays immediately
     _mqueue->stop();
     float vol = (volume >= 0 ? volume : music->getVolume());
     _mqueue->enqueue(music,vol,loop,fade);
-    _mqueue->play();
+}
+
+/**
+ * Plays given music asset as a background track at the given clock time.
+ *
+ * This method is the same as {@link playMusic}, except that the music
+ * is silent until the audio clock (see {@link getClock}) reaches the
+ * given time.  The music then starts on that exact audio frame, which
+ * makes it possible to synchronize music with gameplay.  If the time has
+ * already passed, the music starts immediately.  The music asset
+ * replaces any active music immediately, not at the scheduled time.
+ *
+ * Not all platforms can start music on an exact audio frame.  On those
+ * platforms, the start time is only accurate to an animation frame.
+ *
+ * @param music     The music asset to play
+ * @param time      The audio clock time to start playback
+ * @param loop      Whether to loop the music continuously
+ * @param volume    The music volume (< 0 to use asset default volume)
+ * @param fade      The number of seconds to fade in
+ */
+void AudioEngine::scheduleMusic(const std::shared_ptr<Music>& music, Uint64 time, bool loop,
+                                float volume, float fade) {
+    impl::AudioPoll();
+    _mqueue->stop();
+    float vol = (volume >= 0 ? volume : music->getVolume());
+    _mqueue->enqueue(music,vol,loop,fade,time);
+}
+
+/**
+ * Returns the audio clock, in audio frames.
+ *
+ * The audio clock is the number of frames rendered by the audio device
+ * since the engine started.  It is updated by the audio thread, so it
+ * is not tied to the animation frame rate.  Divide by {@link getSampleRate}
+ * to convert it to seconds.  This is the time base for {@link scheduleMusic}.
+ *
+ * @return the audio clock, in audio frames.
+ */
+Uint64 AudioEngine::getClock() const {
+    return impl::AudioGetClock();
 }
 
 /**
@@ -533,9 +1084,14 @@ void AudioEngine::resumeMusic() {
  * If the queue is empty and there is no active music, this method will
  * play the music immediately.  Otherwise, it will add the music to the
  * queue, and it will play as soon as it is removed from the queue.
+ * Queued music starts on the audio frame after the previous track ends,
+ * so there is no gap between tracks.
  *
  * When it begins playing, it will start at full volume unless you
- * provide a number of seconds to fade in. Note that looping a song will
+ * provide a number of seconds to fade in.  If the music follows another
+ * track, the fade is a crossfade: the music starts that many seconds
+ * before the end of the previous track, and the two overlap.  Not all
+ * platforms support crossfades.  Note that looping a song will
  * cause it to block the queue indefinitely until you turn off looping for
  * that asset {@see setLoop}. This can be desired behavior, as it gives you
  * a way to control the speed of the queue processing.
@@ -543,12 +1099,13 @@ void AudioEngine::resumeMusic() {
  * @param music     The music asset to queue
  * @param loop      Whether to loop the music continuously
  * @param volume    The music volume (< 0 to use asset default volume)
- * @param fade      The number of seconds to fade in
+ * @param fade      The number of seconds to fade in (or crossfade)
  */
 void AudioEngine::queueMusic(const std::shared_ptr<Music>& music, bool loop, float volume, float fade) {
     if (_mqueue == nullptr) {
         return;
     }
+    impl::AudioPoll();
     float vol = (volume >= 0 ? volume : music->getVolume());
     _mqueue->enqueue(music,vol,loop,fade);
     if (_mqueue->isStopped()) {
@@ -603,29 +1160,37 @@ void AudioEngine::advanceMusicQueue(unsigned int steps) {
 /**
  * Plays the given sound effect, and associates it with the specified key.
  *
- * Sound effects are associated with a reference key.  This allows the
- * application to easily reference the sound state without having to
+ * Sound effects are associated with a reference key.  This allows the 
+ * application to easily reference the sound state without having to 
  * internally manage pointers to the audio channel.
  *
- * If the key is already associated with an active sound channel, this
- * method will stop the existing sound and replace it with this one.  It
+ * If the key is already associated with an active sound channel, this 
+ * method will stop the existing sound and replace it with this one.  It 
  * is the responsibility of the application layer to manage key usage.
  *
- * There are a limited number of channels available for sound effects.  If
- * you go over the number available, the sound will not play unless force
- * is true. In that case, it will grab the channel from the longest playing
- * sound effect.
+ * There are a limited number of channels available for sound effects.  If 
+ * you go over the number available, the sound will take the channel of the
+ * lowest ranked sound effect, provided that this sound outranks it.  Sounds
+ * are ranked first by priority and then by audibility (volume times
+ * attenuation).  The displaced sound is not stopped.  It becomes a virtual
+ * effect that keeps track of its position, and will get a channel back
+ * once one is available.  If this sound does not outrank any playing
+ * sound, it starts as a virtual effect itself, unless force is true.  In
+ * that case, it will grab the channel from the lowest ranked sound effect.
  *
  * @param  key      The reference key for the sound effect
  * @param  sound    The sound effect to play
  * @param  loop     Whether to loop the sound effect continuously
  * @param  volume   The sound effect (< 0 to use asset default volume)
- * @param  force    Whether to force another sound to stop.
+ * @param  force    Whether to force another sound off its channel.
+ * @param  priority The sound priority (higher values are more important)
  *
- * @return true if there was an available channel for the sound
+ * @return true if the sound effect is active
  */
 bool AudioEngine::playEffect(const std::string& key, const std::shared_ptr<Sound>& sound,
-                             bool loop, float volume, bool force) {
+                             bool loop, float volume, bool force, Sint32 priority) {
+    // Without an application, completed sounds are only collected here
+    impl::AudioPoll();
     if (isActiveEffect(key)) {
         if (force) {
             stopEffect(key);
@@ -635,68 +1200,170 @@ bool AudioEngine::playEffect(const std::string& key, const std::shared_ptr<Sound
         }
     }
     
-    bool shadow = false;
-    int audioID = -1;
-    for(auto it = _channels.begin(); audioID == -1 && it != _channels.end(); ++it) {
-        if (!(*it)->attached()) {
-            audioID = (*it)->getId();
-        }
+    EffectHandle handle = playEffect(sound,loop,volume,force,priority);
+    lookup(handle)->key = key;
+    _keys[key] = handle;
+    return true;
+}
+
+/**
+ * Plays the given sound effect, returning a handle to reference it.
+ *
+ * Unlike the keyed version of this method, the sound effect is anonymous.
+ * The returned handle is the only way to reference it.  Handles are cheaper
+ * than keys, as they do not require any string hashing or allocation.  They
+ * are also safe to use after the sound completes; the engine will ignore
+ * any handle that no longer refers to an active sound effect.
+ *
+ * There are a limited number of channels available for sound effects.  If
+ * you go over the number available, the sound will take the channel of the
+ * lowest ranked sound effect, provided that this sound outranks it.  Sounds
+ * are ranked first by priority and then by audibility (volume times
+ * attenuation).  The displaced sound is not stopped.  It becomes a virtual
+ * effect that keeps track of its position, and will get a channel back
+ * once one is available.  If this sound does not outrank any playing
+ * sound, it starts as a virtual effect itself, unless force is true.  In
+ * that case, it will grab the channel from the lowest ranked sound effect.
+ *
+ * @param  sound    The sound effect to play
+ * @param  loop     Whether to loop the sound effect continuously
+ * @param  volume   The sound effect (< 0 to use asset default volume)
+ * @param  force    Whether to force another sound off its channel.
+ * @param  priority The sound priority (higher values are more important)
+ *
+ * @return the handle for the sound effect (0 if it failed to play)
+ */
+EffectHandle AudioEngine::playEffect(const std::shared_ptr<Sound>& sound, bool loop,
+                                     float volume, bool force, Sint32 priority) {
+    CUAssertLog(sound, "The sound effect is undefined");
+    impl::AudioPoll();
+    float vol = (volume >= 0 ? volume : sound->getVolume());
+    
+    Uint32 slot;
+    if (_unused.empty()) {
+        slot = (Uint32)_slots.size();
+        _slots.emplace_back();
+        _slots.back().generation = 1;
+    } else {
+        slot = _unused.front();
+        _unused.pop_front();
     }
     
-    // Search for those queued for deletion if necessary
-    for(auto it = _channels.begin(); audioID == -1 && it != _channels.end(); ++it) {
-        if ((*it)->isStopped() && (*it)->attached() == 1) {
-            audioID = (*it)->getId();
-            shadow = true;
+    Effect& effect = _slots[slot];
+    effect.active  = true;
+    effect.channel = -1;
+    effect.priority = priority;
+    effect.attenuation = 1.0f;
+    effect.positional = false;
+    effect.position = Vec2::ZERO;
+    effect.velocity = Vec2::ZERO;
+    effect.reference = 1.0f;
+    effect.maximum = FLT_MAX;
+    effect.rolloff = 1.0f;
+    effect.bus     = AudioBus::SOUND;
+    effect.sound   = sound;
+    effect.volume  = vol;
+    effect.loop    = loop;
+    effect.paused  = false;
+    effect.elapsed = 0;
+    markEffect(effect);
+    
+    // The play order is lazily cleaned; purge stale handles once they dominate
+    if (_equeue.size() > 2*(_audible+_virtual)+_capacity) {
+        for(auto it = _equeue.begin(); it != _equeue.end(); ) {
+            if (lookup(*it) == nullptr) {
+                it = _equeue.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
+    EffectHandle handle = handleOf(slot);
+    _equeue.push_back(handle);
     
+    bool shadow = false;
+    int audioID = acquireChannel(shadow);
     if (audioID == -1) {
-        if (force) {
-            std::string altkey = _equeue.front();
-            audioID = _effects[altkey];
-            stopEffect(altkey);
-        } else {
-            // Fail if nothing available
-            CULogError("No available sound channels");
-            return false;
+        EffectHandle victim = findVictim(priority,vol,force);
+        if (victim == 0) {
+            // Start inaudible, and wait for a channel
+            _virtual++;
+            return handle;
         }
+        audioID = virtualize(*lookup(victim));
+        shadow = true;
     }
     
-    float vol = (volume >= 0 ? volume : sound->getVolume());
-    if (shadow) {
-        std::shared_ptr<SoundChannel> thechannel = _channels[audioID];
-        thechannel->attach(key,sound,vol,loop);
-        Application::get()->schedule([=] {
-            if (thechannel->attached() == 2) {
-                thechannel->advance();
-            }
-            return false;
-        });
-    } else {
-        _channels[audioID]->attach(key,sound,vol,loop);
-        _channels[audioID]->play();
-    }
-    _effects.emplace(key,audioID);
-    _equeue.push_back(key);
-    return true;
+    startChannel(audioID,shadow,handle,sound,vol,loop,0);
+    return handle;
 }
 
 /**
- * Returns the current state of the sound effect for the given key.
+ * Returns true if the handle is associated with a virtual effect.
  *
- * If there is no sound effect for the given key, it returns State::INACTIVE.
+ * A virtual effect is active but does not have a channel.  It keeps
+ * track of its playback position so that it can resume when it gets
+ * a channel back.
  *
- * @param  key      the reference key for the sound effect
+ * If the handle is no longer valid (e.g. the sound has completed), this
+ * method returns false.
  *
- * @return the current state of the sound effect for the given key.
+ * @param  handle   the handle for the sound effect
+ *
+ * @return true if the handle is associated with a virtual effect.
  */
-AudioEngine::State AudioEngine::getEffectState(const std::string& key) const {
-    if (_effects.find(key) == _effects.end()) {
+bool AudioEngine::isVirtualEffect(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    return effect != nullptr && effect->channel == -1;
+}
+
+/**
+ * Returns true if the handle is associated with an active sound effect.
+ *
+ * Virtual effects are considered active.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this
+ * method returns false.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return true if the handle is associated with an active sound effect.
+ */
+bool AudioEngine::isActiveEffect(EffectHandle handle) const {
+    return lookup(handle) != nullptr;
+}
+
+/**
+ * Returns the current state of the sound effect for the given key.
+ *
+ * If there is no sound effect for the given key, it returns State::INACTIVE.
+ *
+ * @param  key      the reference key for the sound effect
+ *
+ * @return the current state of the sound effect for the given key.
+ */
+AudioEngine::State AudioEngine::getEffectState(const std::string& key) const {
+    return getEffectState(lookup(key));
+}
+
+/**
+ * Returns the current state of the sound effect for the given handle.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), it returns
+ * State::INACTIVE.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the current state of the sound effect for the given handle.
+ */
+AudioEngine::State AudioEngine::getEffectState(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    if (effect == nullptr) {
         return State::INACTIVE;
+    } else if (effect->channel == -1) {
+        return effect->paused ? State::PAUSED : State::PLAYING;
     }
-    int id = _effects.at(key);
-    return _channels.at(id)->isPaused() ? State::PAUSED : State::PLAYING;
+    return _channels[effect->channel]->isPaused() ? State::PAUSED : State::PLAYING;
 }
 
 /**
@@ -709,11 +1376,28 @@ AudioEngine::State AudioEngine::getEffectState(const std::string& key) const {
  * @return true if the sound effect is in a continuous loop.
  */
 bool AudioEngine::isEffectLoop(const std::string& key) const {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
+    return isEffectLoop(lookup(key));
+}
 
-    int id = _effects.at(key);
-    return _channels.at(id)->getLoop();
+/**
+ * Returns true if the sound effect is in a continuous loop.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return true if the sound effect is in a continuous loop.
+ */
+bool AudioEngine::isEffectLoop(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    CUAssertLog(effect, "There is no active sound for handle %llx",(unsigned long long)handle);
+    if (effect->channel == -1) {
+        return effect->loop;
+    }
+    return _channels[effect->channel]->getLoop();
 }
 
 /**
@@ -727,10 +1411,27 @@ bool AudioEngine::isEffectLoop(const std::string& key) const {
  * @return the sound asset attached to the given key.
  */
 const Sound* AudioEngine::currentEffect(const std::string& key) const {
-    if (_effects.find(key) == _effects.end()) {
+    return currentEffect(lookup(key));
+}
+
+/**
+ * Returns the sound asset attached to the given handle.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * returns nullptr.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the sound asset attached to the given handle.
+ */
+const Sound* AudioEngine::currentEffect(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    if (effect == nullptr) {
         return nullptr;
+    } else if (effect->channel == -1) {
+        return effect->sound.get();
     }
-    SoundChannel* channel = _channels.at(_effects.at(key)).get();
+    SoundChannel* channel = _channels[effect->channel].get();
     if (channel->getShadow()) {
         return channel->getShadow().get();
     }
@@ -746,11 +1447,32 @@ const Sound* AudioEngine::currentEffect(const std::string& key) const {
  * @param  loop     whether the sound effect is in a continuous loop
  */
 void AudioEngine::setEffectLoop(const std::string& key, bool loop) {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
+    setEffectLoop(lookup(key),loop);
+}
 
-    int id = _effects.at(key);
-    _channels[id]->setLoop(loop);
+/**
+ * Sets whether the sound effect is in a continuous loop.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  loop     whether the sound effect is in a continuous loop
+ */
+void AudioEngine::setEffectLoop(EffectHandle handle, bool loop) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    if (effect->channel == -1) {
+        effect->elapsed = getVirtualTime(*effect);
+        markEffect(*effect);
+        effect->loop = loop;
+        return;
+    }
+    _channels[effect->channel]->setLoop(loop);
 }
 
 /**
@@ -763,11 +1485,28 @@ void AudioEngine::setEffectLoop(const std::string& key, bool loop) {
  * @return the current volume of the sound effect
  */
 float AudioEngine::getEffectVolume(const std::string& key) const {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
+    return getEffectVolume(lookup(key));
+}
 
-    int id = _effects.at(key);
-    return _channels.at(id)->getVolume();
+/**
+ * Returns the current volume of the sound effect.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the current volume of the sound effect.
+ */
+float AudioEngine::getEffectVolume(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    CUAssertLog(effect, "There is no active sound for handle %llx",(unsigned long long)handle);
+    if (effect->channel == -1) {
+        return effect->volume;
+    }
+    return _channels[effect->channel]->getVolume();
 }
 
 /**
@@ -779,11 +1518,192 @@ float AudioEngine::getEffectVolume(const std::string& key) const {
  * @param  volume   the current volume of the sound effect
  */
 void AudioEngine::setEffectVolume(const std::string& key, float volume) {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    setEffectVolume(lookup(key),volume);
+}
+
+/**
+ * Sets the current volume of the sound effect.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  volume   the current volume of the sound effect
+ */
+void AudioEngine::setEffectVolume(EffectHandle handle, float volume) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    if (effect->channel == -1) {
+        effect->volume = volume;
+        return;
+    }
+    _channels[effect->channel]->setVolume(volume);
+}
+
+/**
+ * Returns the priority of the given sound effect.
+ *
+ * Effects with higher priority always outrank effects with lower
+ * priority when competing for a channel.
+ *
+ * If the key does not correspond to an active effect, this method 
+ * raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ *
+ * @return the priority of the given sound effect.
+ */
+Sint32 AudioEngine::getEffectPriority(const std::string& key) const {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    return getEffectPriority(lookup(key));
+}
+
+/**
+ * Returns the priority of the given sound effect.
+ *
+ * Effects with higher priority always outrank effects with lower
+ * priority when competing for a channel.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the priority of the given sound effect.
+ */
+Sint32 AudioEngine::getEffectPriority(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    CUAssertLog(effect, "There is no active sound for handle %llx",(unsigned long long)handle);
+    return effect->priority;
+}
+
+/**
+ * Sets the priority of the given sound effect.
+ *
+ * Effects with higher priority always outrank effects with lower
+ * priority when competing for a channel. The channels are reassigned
+ * at the next animation frame.
+ *
+ * If the key does not correspond to an active effect, this method 
+ * raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ * @param  priority the sound priority
+ */
+void AudioEngine::setEffectPriority(const std::string& key, Sint32 priority) {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    setEffectPriority(lookup(key),priority);
+}
+
+/**
+ * Sets the priority of the given sound effect.
+ *
+ * Effects with higher priority always outrank effects with lower
+ * priority when competing for a channel. The channels are reassigned
+ * at the next animation frame.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  priority the sound priority
+ */
+void AudioEngine::setEffectPriority(EffectHandle handle, Sint32 priority) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    effect->priority = priority;
+}
+
+/**
+ * Returns the attenuation of the given sound effect.
+ *
+ * The attenuation is a game-specific factor (such as distance from the
+ * listener) that is multiplied with the volume to determine how audible
+ * a sound is.  It does not change the volume of the sound, but it is
+ * used to rank sounds of equal priority.  The default is 1.
+ *
+ * If the key does not correspond to an active effect, this method 
+ * raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ *
+ * @return the attenuation of the given sound effect.
+ */
+float AudioEngine::getEffectAttenuation(const std::string& key) const {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    return getEffectAttenuation(lookup(key));
+}
+
+/**
+ * Returns the attenuation of the given sound effect.
+ *
+ * The attenuation is a game-specific factor (such as distance from the
+ * listener) that is multiplied with the volume to determine how audible
+ * a sound is.  The default is 1.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the attenuation of the given sound effect.
+ */
+float AudioEngine::getEffectAttenuation(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    CUAssertLog(effect, "There is no active sound for handle %llx",(unsigned long long)handle);
+    return effect->attenuation;
+}
+
+/**
+ * Sets the attenuation of the given sound effect.
+ *
+ * The attenuation is a game-specific factor (such as distance from the
+ * listener) that is multiplied with the volume to determine how audible
+ * a sound is.  It does not change the volume of the sound, but it is
+ * used to rank sounds of equal priority.  The channels are reassigned
+ * at the next animation frame.
+ *
+ * If the key does not correspond to an active effect, this method 
+ * raises an error.
+ *
+ * @param  key          the reference key for the sound effect
+ * @param  attenuation  the attenuation factor
+ */
+void AudioEngine::setEffectAttenuation(const std::string& key, float attenuation) {
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
+    setEffectAttenuation(lookup(key),attenuation);
+}
 
-    int id = _effects.at(key);
-    _channels[id]->setVolume(volume);
+/**
+ * Sets the attenuation of the given sound effect.
+ *
+ * The attenuation is a game-specific factor (such as distance from the
+ * listener) that is multiplied with the volume to determine how audible
+ * a sound is.  The channels are reassigned at the next animation frame.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  attenuation  the attenuation factor
+ */
+void AudioEngine::setEffectAttenuation(EffectHandle handle, float attenuation) {
+    CUAssertLog(attenuation >= 0, "The attenuation %.3f is negative",attenuation);
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    effect->attenuation = attenuation;
 }
 
 /**
@@ -799,11 +1719,28 @@ void AudioEngine::setEffectVolume(const std::string& key, float volume) {
  * @return the duration of the sound effect, in seconds.
  */
 float AudioEngine::getEffectDuration(const std::string& key) const {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    return _channels.at(id)->getDuration();
+    return getEffectDuration(lookup(key));
+}
+
+/**
+ * Returns the duration of the sound effect, in seconds.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the duration of the sound effect, in seconds.
+ */
+float AudioEngine::getEffectDuration(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    CUAssertLog(effect, "There is no active sound for handle %llx",(unsigned long long)handle);
+    if (effect->channel == -1) {
+        return (float)effect->sound->getDuration();
+    }
+    return _channels[effect->channel]->getDuration();
 }
 
 /**
@@ -821,11 +1758,28 @@ float AudioEngine::getEffectDuration(const std::string& key) const {
  * @return the elapsed time of the sound effect, in seconds
  */
 float AudioEngine::getEffectElapsed(const std::string& key) const {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
+    return getEffectElapsed(lookup(key));
+}
 
-    int id = _effects.at(key);
-    return _channels.at(id)->getCurrentTime();
+/**
+ * Returns the elapsed time of the sound effect, in seconds
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the elapsed time of the sound effect, in seconds
+ */
+float AudioEngine::getEffectElapsed(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    CUAssertLog(effect, "There is no active sound for handle %llx",(unsigned long long)handle);
+    if (effect->channel == -1) {
+        return (float)getVirtualTime(*effect);
+    }
+    return _channels[effect->channel]->getCurrentTime();
 }
 
 /**
@@ -843,12 +1797,29 @@ float AudioEngine::getEffectElapsed(const std::string& key) const {
  * @return the time remaining for the sound effect, in seconds
  */
 float AudioEngine::getEffectRemaining(const std::string& key) const {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    float duration = _channels.at(id)->getDuration();
-    return duration - _channels.at(id)->getCurrentTime();
+    return getEffectRemaining(lookup(key));
+}
+
+/**
+ * Returns the time remaining for the sound effect, in seconds
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the time remaining for the sound effect, in seconds
+ */
+float AudioEngine::getEffectRemaining(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    CUAssertLog(effect, "There is no active sound for handle %llx",(unsigned long long)handle);
+    if (effect->channel == -1) {
+        return (float)(effect->sound->getDuration()-getVirtualTime(*effect));
+    }
+    SoundChannel* channel = _channels[effect->channel].get();
+    return channel->getDuration()-channel->getCurrentTime();
 }
 
 /**
@@ -865,11 +1836,31 @@ float AudioEngine::getEffectRemaining(const std::string& key) const {
  * @param  time     the new position of the sound effect
  */
 void AudioEngine::setEffectElapsed(const std::string& key, float time) {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    _channels.at(id)->setCurrentTime(time);
+    setEffectElapsed(lookup(key),time);
+}
+
+/**
+ * Sets the elapsed time of the sound effect, in seconds
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  time     the new position of the sound effect
+ */
+void AudioEngine::setEffectElapsed(EffectHandle handle, float time) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    if (effect->channel == -1) {
+        effect->elapsed = time;
+        markEffect(*effect);
+        return;
+    }
+    _channels[effect->channel]->setCurrentTime(time);
 }
 
 /**
@@ -886,12 +1877,32 @@ void AudioEngine::setEffectElapsed(const std::string& key, float time) {
  * @param  time     the new time remaining for the sound effect
  */
 void AudioEngine::setEffectRemaining(const std::string& key, float time) {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    float duration = _channels.at(id)->getDuration();
-    _channels.at(id)->setCurrentTime(duration-time);
+    setEffectRemaining(lookup(key),time);
+}
+
+/**
+ * Sets the time remaining for the sound effect, in seconds
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  time     the new time remaining for the sound effect
+ */
+void AudioEngine::setEffectRemaining(EffectHandle handle, float time) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    if (effect->channel == -1) {
+        effect->elapsed = effect->sound->getDuration()-time;
+        markEffect(*effect);
+        return;
+    }
+    SoundChannel* channel = _channels[effect->channel].get();
+    channel->setCurrentTime(channel->getDuration()-time);
 }
 
 /**
@@ -904,12 +1915,32 @@ void AudioEngine::setEffectRemaining(const std::string& key, float time) {
  * @param  key      the reference key for the sound effect
  */
 void AudioEngine::stopEffect(const std::string& key) {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    _channels.at(id)->stop();
-    removeKey(key);
+    stopEffect(lookup(key));
+}
+
+/**
+ * Stops the sound effect for the given handle, removing it.
+ *
+ * The effect will be removed from the audio engine entirely. You will need
+ * to add it again if you wish to replay it.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ */
+void AudioEngine::stopEffect(EffectHandle handle) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    if (effect->channel != -1) {
+        _channels[effect->channel]->stop();
+        _stoplist.push_back(effect->channel);
+    }
+    removeEffect(handle);
 }
 
 /**
@@ -920,12 +1951,33 @@ void AudioEngine::stopEffect(const std::string& key) {
  * @param  key      the reference key for the sound effect
  */
 void AudioEngine::pauseEffect(const std::string& key) {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    CUAssertLog(!_channels.at(id)->isPaused(), "The sound for that effect is already paused");
-    _channels.at(id)->pause();
+    pauseEffect(lookup(key));
+}
+
+/**
+ * Pauses the sound effect for the given handle.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ */
+void AudioEngine::pauseEffect(EffectHandle handle) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    if (effect->channel == -1) {
+        CUAssertLog(!effect->paused, "The sound for that effect is already paused");
+        effect->elapsed = getVirtualTime(*effect);
+        effect->paused = true;
+        return;
+    }
+    SoundChannel* channel = _channels[effect->channel].get();
+    CUAssertLog(!channel->isPaused(), "The sound for that effect is already paused");
+    channel->pause();
 }
 
 /**
@@ -936,12 +1988,33 @@ void AudioEngine::pauseEffect(const std::string& key) {
  * @param  key      the reference key for the sound effect
  */
 void AudioEngine::resumeEffect(std::string key) {
-    CUAssertLog(_effects.find(key) != _effects.end(),
+    CUAssertLog(isActiveEffect(key),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    CUAssertLog(_channels.at(id)->isPaused(), "The sound for that effect is not paused");
-    _channels.at(id)->resume();
+    resumeEffect(lookup(key));
+}
+
+/**
+ * Resumes the sound effect for the given handle.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this method
+ * does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ */
+void AudioEngine::resumeEffect(EffectHandle handle) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    if (effect->channel == -1) {
+        CUAssertLog(effect->paused, "The sound for that effect is not paused");
+        markEffect(*effect);
+        effect->paused = false;
+        return;
+    }
+    SoundChannel* channel = _channels[effect->channel].get();
+    CUAssertLog(channel->isPaused(), "The sound for that effect is not paused");
+    channel->resume();
 }
 
 /**
@@ -953,9 +2026,14 @@ void AudioEngine::stopAllEffects() {
     for(auto it = _channels.begin(); it != _channels.end(); ++it) {
         if (!(*it)->isStopped()) {
             (*it)->stop();
+            _stoplist.push_back((*it)->getId());
+        }
+    }
+    for(Uint32 ii = 0; ii < _slots.size(); ii++) {
+        if (_slots[ii].active) {
+            removeEffect(handleOf(ii));
         }
     }
-    _effects.clear();
     _equeue.clear();
 }
 
@@ -970,6 +2048,12 @@ void AudioEngine::pauseAllEffects() {
             (*it)->pause();
         }
     }
+    for(auto it = _slots.begin(); it != _slots.end(); ++it) {
+        if (it->active && it->channel == -1 && !it->paused) {
+            it->elapsed = getVirtualTime(*it);
+            it->paused = true;
+        }
+    }
 }
 
 /**
@@ -981,6 +2065,413 @@ void AudioEngine::resumeAllEffects() {
             (*it)->resume();
         }
     }
+    for(auto it = _slots.begin(); it != _slots.end(); ++it) {
+        if (it->active && it->channel == -1 && it->paused) {
+            markEffect(*it);
+            it->paused = false;
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Positional Audio
+/**
+ * Sets the position and velocity of the listener.
+ *
+ * Positional sound effects are attenuated by their distance to the
+ * listener, and are panned by their horizontal offset from it.  The
+ * gains of all positional effects are recomputed by the mixer once per
+ * audio block, so there is no need to update the effects when only the
+ * listener moves.
+ *
+ * The velocity is only used for doppler.  It should be in the same units
+ * per second as the speed of sound.
+ *
+ * @param position  The listener position
+ * @param velocity  The listener velocity
+ */
+void AudioEngine::setListener(const Vec2& position, const Vec2& velocity) {
+    _listenerPos = position;
+    _listenerVel = velocity;
+    impl::AudioSetListener(position.x,position.y,velocity.x,velocity.y);
+}
+
+/**
+ * Sets the distance attenuation model for positional effects.
+ *
+ * The default model is {@link DistanceModel#INVERSE}.
+ *
+ * @param model The distance attenuation model
+ */
+void AudioEngine::setDistanceModel(DistanceModel model) {
+    _model = model;
+    impl::AudioSetDistanceModel(model);
+}
+
+/**
+ * Sets the doppler parameters for positional effects.
+ *
+ * Doppler shifts the pitch of an effect according to the velocities of
+ * the effect and the listener.  A factor of 0 (the default) disables
+ * doppler; larger values exaggerate the effect.  The speed of sound
+ * should be in the same units as the velocities.  The pitch shift is
+ * clamped to one octave in either direction.
+ *
+ * Doppler is not applied to streamed sounds, or on platforms that do not
+ * support it (such as AVFoundation).
+ *
+ * @param factor    The doppler factor
+ * @param speed     The speed of sound
+ */
+void AudioEngine::setDoppler(float factor, float speed) {
+    CUAssertLog(speed > 0, "The speed of sound %.3f is not positive",speed);
+    _doppler = factor > 0 ? factor : 0;
+    _speed = speed;
+    impl::AudioSetDoppler(_doppler,_speed);
+}
+
+/**
+ * Sets the position and velocity of the given sound effect.
+ *
+ * This makes the effect positional.  Its gain is attenuated by its
+ * distance to the listener, and it is panned (with equal power) by its
+ * horizontal offset from the listener.  This gain is multiplied with the
+ * volume of the effect.  Positional effects also rank by this gain when
+ * competing for a channel.
+ *
+ * If the key does not correspond to an active effect, this method
+ * raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ * @param  position the effect position
+ * @param  velocity the effect velocity (for doppler)
+ */
+void AudioEngine::setEffectPosition(const std::string& key, const Vec2& position, const Vec2& velocity) {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    setEffectPosition(lookup(key),position,velocity);
+}
+
+/**
+ * Sets the position and velocity of the given sound effect.
+ *
+ * This makes the effect positional.  Its gain is attenuated by its
+ * distance to the listener, and it is panned (with equal power) by its
+ * horizontal offset from the listener.  This gain is multiplied with the
+ * volume of the effect.  Positional effects also rank by this gain when
+ * competing for a channel.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this
+ * method does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  position the effect position
+ * @param  velocity the effect velocity (for doppler)
+ */
+void AudioEngine::setEffectPosition(EffectHandle handle, const Vec2& position, const Vec2& velocity) {
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    effect->positional = true;
+    effect->position = position;
+    effect->velocity = velocity;
+    if (effect->channel != -1) {
+        applyEmitter(*effect);
+    }
+}
+
+/**
+ * Returns the position of the given sound effect.
+ *
+ * If the effect is not positional, this returns the origin.
+ *
+ * If the key does not correspond to an active effect, this method
+ * raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ *
+ * @return the position of the given sound effect.
+ */
+Vec2 AudioEngine::getEffectPosition(const std::string& key) const {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    return getEffectPosition(lookup(key));
+}
+
+/**
+ * Returns the position of the given sound effect.
+ *
+ * If the effect is not positional, this returns the origin.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this
+ * method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the position of the given sound effect.
+ */
+Vec2 AudioEngine::getEffectPosition(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    CUAssertLog(effect, "There is no active sound for handle %llx",(unsigned long long)handle);
+    return effect->position;
+}
+
+/**
+ * Returns true if the given sound effect is positional.
+ *
+ * An effect becomes positional once it is given a position.
+ *
+ * If the key does not correspond to an active effect, this method
+ * raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ *
+ * @return true if the given sound effect is positional.
+ */
+bool AudioEngine::isEffectPositional(const std::string& key) const {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    return isEffectPositional(lookup(key));
+}
+
+/**
+ * Returns true if the given sound effect is positional.
+ *
+ * An effect becomes positional once it is given a position.  If the
+ * handle is no longer valid (e.g. the sound has completed), this method
+ * returns false.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return true if the given sound effect is positional.
+ */
+bool AudioEngine::isEffectPositional(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    return effect != nullptr && effect->positional;
+}
+
+/**
+ * Sets the attenuation range of the given sound effect.
+ *
+ * The reference distance is the distance at which the effect is heard
+ * at full volume.  The maximum distance is the distance beyond which
+ * the effect is attenuated no further.  The rolloff scales the rate of
+ * attenuation in between.  The defaults are 1, infinity, and 1.  This
+ * range only matters once the effect is positional.
+ *
+ * If the key does not correspond to an active effect, this method
+ * raises an error.
+ *
+ * @param  key          the reference key for the sound effect
+ * @param  reference    the reference distance (must be positive)
+ * @param  maximum      the maximum distance
+ * @param  rolloff      the rolloff factor
+ */
+void AudioEngine::setEffectRange(const std::string& key, float reference, float maximum, float rolloff) {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    setEffectRange(lookup(key),reference,maximum,rolloff);
+}
+
+/**
+ * Sets the attenuation range of the given sound effect.
+ *
+ * The reference distance is the distance at which the effect is heard
+ * at full volume.  The maximum distance is the distance beyond which
+ * the effect is attenuated no further.  The rolloff scales the rate of
+ * attenuation in between.  The defaults are 1, infinity, and 1.  This
+ * range only matters once the effect is positional.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this
+ * method does nothing.
+ *
+ * @param  handle       the handle for the sound effect
+ * @param  reference    the reference distance (must be positive)
+ * @param  maximum      the maximum distance
+ * @param  rolloff      the rolloff factor
+ */
+void AudioEngine::setEffectRange(EffectHandle handle, float reference, float maximum, float rolloff) {
+    CUAssertLog(reference > 0, "The reference distance %.3f is not positive",reference);
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    effect->reference = reference;
+    effect->maximum = std::max(maximum,reference);
+    effect->rolloff = std::max(rolloff,0.0f);
+    if (effect->positional && effect->channel != -1) {
+        applyEmitter(*effect);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Audio Buses
+/**
+ * Returns the number of buses in this engine.
+ *
+ * Every engine starts with four buses: master, music, sound, and voice.
+ * The master bus is the root of the bus tree, and the other three are
+ * its children.
+ *
+ * @return the number of buses in this engine.
+ */
+Uint32 AudioEngine::getBusCount() const {
+    return impl::AudioGetBusCount();
+}
+
+/**
+ * Returns the bus with the given index.
+ *
+ * The indices of the standard buses are the constants of {@link AudioBus}.
+ * If there is no such bus, this method returns nullptr.
+ *
+ * @param index     the bus index
+ *
+ * @return the bus with the given index.
+ */
+std::shared_ptr<AudioBus> AudioEngine::getBus(Uint32 index) const {
+    return impl::AudioGetBus(index);
+}
+
+/**
+ * Returns the bus with the given name.
+ *
+ * If there is no such bus, this method returns nullptr.
+ *
+ * @param name      the bus name
+ *
+ * @return the bus with the given name.
+ */
+std::shared_ptr<AudioBus> AudioEngine::getBus(const std::string& name) const {
+    Uint32 count = impl::AudioGetBusCount();
+    for(Uint32 ii = 0; ii < count; ii++) {
+        std::shared_ptr<AudioBus> bus = impl::AudioGetBus(ii);
+        if (bus != nullptr && bus->getName() == name) {
+            return bus;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Returns a newly created bus that mixes into the given parent.
+ *
+ * If the parent is nullptr, the new bus mixes into the master bus.  Buses
+ * can never be removed, so they should be created at initialization.
+ *
+ * @param name      the bus name
+ * @param parent    the parent bus
+ *
+ * @return a newly created bus that mixes into the given parent.
+ */
+std::shared_ptr<AudioBus> AudioEngine::addBus(const std::string& name, const std::shared_ptr<AudioBus>& parent) {
+    Uint32 index = parent == nullptr ? AudioBus::MASTER : parent->getIndex();
+    CUAssertLog(parent == nullptr || impl::AudioGetBus(index) == parent,
+                "Bus '%s' does not belong to this engine",parent->getName().c_str());
+    return impl::AudioAddBus(name,index);
+}
+
+/**
+ * Returns the bus for the given sound effect.
+ *
+ * If the key does not correspond to an active effect, this method
+ * raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ *
+ * @return the bus for the given sound effect.
+ */
+std::shared_ptr<AudioBus> AudioEngine::getEffectBus(const std::string& key) const {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    return getEffectBus(lookup(key));
+}
+
+/**
+ * Returns the bus for the given sound effect.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this
+ * method returns nullptr.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the bus for the given sound effect.
+ */
+std::shared_ptr<AudioBus> AudioEngine::getEffectBus(EffectHandle handle) const {
+    const Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return nullptr;
+    }
+    return impl::AudioGetBus(effect->bus);
+}
+
+/**
+ * Routes the given sound effect to a bus.
+ *
+ * Sound effects are routed to the sound bus by default.  The change is
+ * immediate, even if the effect is playing.
+ *
+ * If the key does not correspond to an active effect, this method
+ * raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ * @param  bus      the bus for the sound effect
+ */
+void AudioEngine::setEffectBus(const std::string& key, const std::shared_ptr<AudioBus>& bus) {
+    CUAssertLog(isActiveEffect(key),
+                "There is no active sound with key '%s'",key.c_str());
+    setEffectBus(lookup(key),bus);
+}
+
+/**
+ * Routes the given sound effect to a bus.
+ *
+ * Sound effects are routed to the sound bus by default.  The change is
+ * immediate, even if the effect is playing.
+ *
+ * If the handle is no longer valid (e.g. the sound has completed), this
+ * method does nothing.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  bus      the bus for the sound effect
+ */
+void AudioEngine::setEffectBus(EffectHandle handle, const std::shared_ptr<AudioBus>& bus) {
+    CUAssertLog(bus != nullptr, "Attempt to route an effect to a null bus");
+    CUAssertLog(impl::AudioGetBus(bus->getIndex()) == bus,
+                "Bus '%s' does not belong to this engine",bus->getName().c_str());
+    Effect* effect = lookup(handle);
+    if (effect == nullptr) {
+        return;
+    }
+    effect->bus = bus->getIndex();
+    if (effect->channel != -1) {
+        _channels[effect->channel]->setBus(effect->bus);
+    }
+}
+
+/**
+ * Returns a report of the CPU cost of the bus graph.
+ *
+ * The report lists every bus, together with the average cost of each
+ * of its nodes (in microseconds per block) and their load (as a
+ * percentage of a single core).  This is intended for tuning effect
+ * chains during development.
+ *
+ * @return a report of the CPU cost of the bus graph.
+ */
+std::string AudioEngine::getProfile() const {
+    std::string result;
+    Uint32 count = impl::AudioGetBusCount();
+    for(Uint32 ii = 0; ii < count; ii++) {
+        std::shared_ptr<AudioBus> bus = impl::AudioGetBus(ii);
+        if (bus != nullptr) {
+            result += bus->getProfile();
+        }
+    }
+    return result;
 }
 
 
@@ -0,0 +1,829 @@
+//
+//  CUAudioNode.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the DSP nodes that may be inserted into an audio bus.
+//  A node processes a block of interleaved stereo audio in place.  Blocks are
+//  never larger than the mixer block size, so nodes can size their scratch
+//  memory at initialization and never allocate on the audio thread.
+//
+//  Recursive filters (the biquad and the reverb combs) cannot be vectorized
+//  across time, so they vectorize across channels where possible.  All of
+//  the gain stages use the shared SIMD kernels.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/audio/CUAudioNode.h>
+#include <cugl/audio/CUAudioBus.h>
+#include <cugl/util/CUDebug.h>
+#include "CUAudioSIMD.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+using namespace cugl;
+using namespace cugl::simd;
+
+/** The maximum block size of a reverb (the mixer block size) */
+#define REVERB_BLOCK_FRAMES 512
+/** The number of frames between compressor gain updates */
+#define COMPRESSOR_SEGMENT  16
+/** Values smaller than this in filter state are flushed to zero */
+#define DENORMAL_LIMIT      1e-15f
+
+/**
+ * Returns the linear gain for the given decibels
+ *
+ * @param db    The gain in decibels
+ *
+ * @return the linear gain for the given decibels
+ */
+static float db_to_gain(float db) {
+    return std::pow(10.0f,db/20.0f);
+}
+
+/**
+ * Returns the one-pole smoothing coefficient for the given time constant
+ *
+ * @param time      The time constant in seconds
+ * @param frames    The number of frames per update
+ * @param rate      The sample rate
+ *
+ * @return the one-pole smoothing coefficient for the given time constant
+ */
+static float smoothing(float time, Uint32 frames, Uint32 rate) {
+    return time > 0 ? std::exp(-(float)frames/(time*rate)) : 0.0f;
+}
+
+
+#pragma mark -
+#pragma mark Audio Node
+/**
+ * Creates a degenerate node with no sample rate.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioNode::AudioNode() :
+_rate(0),
+_bypass(false),
+_nanos(0),
+_frames(0),
+_blocks(0) {
+}
+
+/**
+ * Disposes any resources allocated for this node.
+ *
+ * The node must not be attached to a bus when this is called.
+ */
+void AudioNode::dispose() {
+    _rate = 0;
+    _bypass.store(false);
+    resetCost();
+}
+
+/**
+ * Initializes a node with the given name and sample rate.
+ *
+ * @param name  The node name
+ * @param rate  The sample rate in HZ
+ *
+ * @return true if initialization was successful.
+ */
+bool AudioNode::init(const std::string& name, Uint32 rate) {
+    if (_rate != 0) {
+        CUAssertLog(false, "Audio node is already initialized");
+        return false;
+    } else if (rate == 0) {
+        CUAssertLog(false, "Audio node must have a positive sample rate");
+        return false;
+    }
+    _name = name;
+    _rate = rate;
+    return true;
+}
+
+/**
+ * Returns the average processing time per block in microseconds.
+ *
+ * @return the average processing time per block in microseconds.
+ */
+double AudioNode::getCost() const {
+    Uint64 blocks = _blocks.load(std::memory_order_relaxed);
+    if (blocks == 0) {
+        return 0;
+    }
+    return _nanos.load(std::memory_order_relaxed)/(1000.0*blocks);
+}
+
+/**
+ * Returns the ratio of processing time to audio time.
+ *
+ * This is the fraction of a single core this node would use in real
+ * time.
+ *
+ * @return the ratio of processing time to audio time.
+ */
+double AudioNode::getLoad() const {
+    Uint64 frames = _frames.load(std::memory_order_relaxed);
+    if (frames == 0 || _rate == 0) {
+        return 0;
+    }
+    double audio = frames/(double)_rate;
+    return _nanos.load(std::memory_order_relaxed)/(1.0e9*audio);
+}
+
+/**
+ * Resets the profiling statistics of this node.
+ */
+void AudioNode::resetCost() {
+    _nanos.store(0);
+    _frames.store(0);
+    _blocks.store(0);
+}
+
+/**
+ * Processes a block of audio in place, recording the time spent.
+ *
+ * This method should only be called on the audio thread.  If the node
+ * is bypassed, the block is unchanged.
+ *
+ * @param buffer    The audio block (interleaved stereo)
+ * @param frames    The number of frames in the block
+ */
+void AudioNode::render(float* buffer, Uint32 frames) {
+    if (_bypass.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    process(buffer,frames);
+    auto end = std::chrono::steady_clock::now();
+    Uint64 nanos = (Uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count();
+    _nanos.fetch_add(nanos,std::memory_order_relaxed);
+    _frames.fetch_add(frames,std::memory_order_relaxed);
+    _blocks.fetch_add(1,std::memory_order_relaxed);
+}
+
+
+#pragma mark -
+#pragma mark Biquad Filter
+/**
+ * Creates a degenerate filter.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+BiquadNode::BiquadNode() : AudioNode(),
+_type(Type::LOWPASS),
+_frequency(0),
+_quality(0.70710678f),
+_gain(0),
+_dirty(true) {
+    std::memset(_coeff,0,sizeof(_coeff));
+    std::memset(_state,0,sizeof(_state));
+    _coeff[0] = 1;
+}
+
+/**
+ * Initializes a filter with the given parameters.
+ *
+ * @param rate      The sample rate in HZ
+ * @param type      The filter shape
+ * @param frequency The cutoff or center frequency in HZ
+ * @param quality   The filter quality (0.7071 is maximally flat)
+ * @param gain      The gain in decibels (PEAK and shelf filters only)
+ *
+ * @return true if initialization was successful.
+ */
+bool BiquadNode::init(Uint32 rate, Type type, float frequency, float quality, float gain) {
+    if (!AudioNode::init("biquad",rate)) {
+        return false;
+    }
+    _type.store(type);
+    setFrequency(frequency);
+    setQuality(quality);
+    setGain(gain);
+    update();
+    return true;
+}
+
+/**
+ * Sets the filter shape.
+ *
+ * @param type  The filter shape
+ */
+void BiquadNode::setType(Type type) {
+    _type.store(type);
+    _dirty.store(true,std::memory_order_release);
+}
+
+/**
+ * Sets the cutoff or center frequency in HZ.
+ *
+ * The frequency is clamped below the Nyquist limit.
+ *
+ * @param frequency The cutoff or center frequency in HZ
+ */
+void BiquadNode::setFrequency(float frequency) {
+    float limit = 0.49f*_rate;
+    frequency = frequency < 1 ? 1 : (frequency > limit ? limit : frequency);
+    _frequency.store(frequency);
+    _dirty.store(true,std::memory_order_release);
+}
+
+/**
+ * Sets the filter quality.
+ *
+ * A quality of 0.7071 is maximally flat.  Larger values produce a
+ * resonant peak at the cutoff.
+ *
+ * @param quality   The filter quality
+ */
+void BiquadNode::setQuality(float quality) {
+    _quality.store(quality < 0.01f ? 0.01f : quality);
+    _dirty.store(true,std::memory_order_release);
+}
+
+/**
+ * Sets the gain in decibels.
+ *
+ * This is only used by PEAK and shelf filters.
+ *
+ * @param gain  The gain in decibels
+ */
+void BiquadNode::setGain(float gain) {
+    _gain.store(gain);
+    _dirty.store(true,std::memory_order_release);
+}
+
+/**
+ * Recomputes the filter coefficients from the parameters.
+ */
+void BiquadNode::update() {
+    const float pi = 3.14159265f;
+    float omega = 2*pi*_frequency.load()/_rate;
+    float cosw  = std::cos(omega);
+    float alpha = std::sin(omega)/(2*_quality.load());
+    float amp   = std::pow(10.0f,_gain.load()/40.0f);
+    float shelf = 2*std::sqrt(amp)*alpha;
+
+    float b0 = 1, b1 = 0, b2 = 0;
+    float a0 = 1, a1 = 0, a2 = 0;
+    switch (_type.load()) {
+        case Type::LOWPASS:
+            b0 = (1-cosw)/2; b1 = 1-cosw; b2 = (1-cosw)/2;
+            a0 = 1+alpha;    a1 = -2*cosw; a2 = 1-alpha;
+            break;
+        case Type::HIGHPASS:
+            b0 = (1+cosw)/2; b1 = -(1+cosw); b2 = (1+cosw)/2;
+            a0 = 1+alpha;    a1 = -2*cosw;   a2 = 1-alpha;
+            break;
+        case Type::BANDPASS:
+            b0 = alpha;      b1 = 0;       b2 = -alpha;
+            a0 = 1+alpha;    a1 = -2*cosw; a2 = 1-alpha;
+            break;
+        case Type::NOTCH:
+            b0 = 1;          b1 = -2*cosw; b2 = 1;
+            a0 = 1+alpha;    a1 = -2*cosw; a2 = 1-alpha;
+            break;
+        case Type::PEAK:
+            b0 = 1+alpha*amp; b1 = -2*cosw; b2 = 1-alpha*amp;
+            a0 = 1+alpha/amp; a1 = -2*cosw; a2 = 1-alpha/amp;
+            break;
+        case Type::LOWSHELF:
+            b0 = amp*((amp+1)-(amp-1)*cosw+shelf);
+            b1 = 2*amp*((amp-1)-(amp+1)*cosw);
+            b2 = amp*((amp+1)-(amp-1)*cosw-shelf);
+            a0 = (amp+1)+(amp-1)*cosw+shelf;
+            a1 = -2*((amp-1)+(amp+1)*cosw);
+            a2 = (amp+1)+(amp-1)*cosw-shelf;
+            break;
+        case Type::HIGHSHELF:
+            b0 = amp*((amp+1)+(amp-1)*cosw+shelf);
+            b1 = -2*amp*((amp-1)+(amp+1)*cosw);
+            b2 = amp*((amp+1)+(amp-1)*cosw-shelf);
+            a0 = (amp+1)-(amp-1)*cosw+shelf;
+            a1 = 2*((amp-1)-(amp+1)*cosw);
+            a2 = (amp+1)-(amp-1)*cosw-shelf;
+            break;
+    }
+    _coeff[0] = b0/a0;
+    _coeff[1] = b1/a0;
+    _coeff[2] = b2/a0;
+    _coeff[3] = a1/a0;
+    _coeff[4] = a2/a0;
+}
+
+/**
+ * Filters a block of audio in place.
+ *
+ * @param buffer    The audio block (interleaved stereo)
+ * @param frames    The number of frames in the block
+ */
+void BiquadNode::process(float* buffer, Uint32 frames) {
+    if (_dirty.exchange(false,std::memory_order_acquire)) {
+        update();
+    }
+    // Transposed direct form II, with one channel per lane
+#if defined (CU_AUDIO_SSE)
+    __m128 b0 = _mm_set1_ps(_coeff[0]);
+    __m128 b1 = _mm_set1_ps(_coeff[1]);
+    __m128 b2 = _mm_set1_ps(_coeff[2]);
+    __m128 a1 = _mm_set1_ps(_coeff[3]);
+    __m128 a2 = _mm_set1_ps(_coeff[4]);
+    __m128 z1 = _mm_setr_ps(_state[0],_state[1],0,0);
+    __m128 z2 = _mm_setr_ps(_state[2],_state[3],0,0);
+    for(Uint32 ii = 0; ii < frames; ii++) {
+        double* frame = (double*)(buffer+2*ii);
+        __m128 x = _mm_castpd_ps(_mm_load_sd(frame));
+        __m128 y = _mm_add_ps(_mm_mul_ps(b0,x),z1);
+        z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1,x),_mm_mul_ps(a1,y)),z2);
+        z2 = _mm_sub_ps(_mm_mul_ps(b2,x),_mm_mul_ps(a2,y));
+        _mm_store_sd(frame,_mm_castps_pd(y));
+    }
+    float state[8];
+    _mm_storeu_ps(state,z1);
+    _mm_storeu_ps(state+4,z2);
+    _state[0] = state[0]; _state[1] = state[1];
+    _state[2] = state[4]; _state[3] = state[5];
+#elif defined (CU_AUDIO_NEON)
+    float32x2_t b0 = vdup_n_f32(_coeff[0]);
+    float32x2_t b1 = vdup_n_f32(_coeff[1]);
+    float32x2_t b2 = vdup_n_f32(_coeff[2]);
+    float32x2_t a1 = vdup_n_f32(_coeff[3]);
+    float32x2_t a2 = vdup_n_f32(_coeff[4]);
+    float32x2_t z1 = vld1_f32(_state);
+    float32x2_t z2 = vld1_f32(_state+2);
+    for(Uint32 ii = 0; ii < frames; ii++) {
+        float32x2_t x = vld1_f32(buffer+2*ii);
+        float32x2_t y = vmla_f32(z1,b0,x);
+        z1 = vadd_f32(vmls_f32(vmul_f32(b1,x),a1,y),z2);
+        z2 = vmls_f32(vmul_f32(b2,x),a2,y);
+        vst1_f32(buffer+2*ii,y);
+    }
+    vst1_f32(_state,z1);
+    vst1_f32(_state+2,z2);
+#else
+    const float b0 = _coeff[0], b1 = _coeff[1], b2 = _coeff[2];
+    const float a1 = _coeff[3], a2 = _coeff[4];
+    for(Uint32 ii = 0; ii < frames; ii++) {
+        for(Uint32 ch = 0; ch < 2; ch++) {
+            float x = buffer[2*ii+ch];
+            float y = b0*x+_state[ch];
+            _state[ch]   = b1*x-a1*y+_state[ch+2];
+            _state[ch+2] = b2*x-a2*y;
+            buffer[2*ii+ch] = y;
+        }
+    }
+#endif
+    // Flush the state so that silence does not decay into denormals
+    for(Uint32 ii = 0; ii < 4; ii++) {
+        if (std::fabs(_state[ii]) < DENORMAL_LIMIT) {
+            _state[ii] = 0;
+        }
+    }
+}
+
+/**
+ * Clears the filter state.
+ */
+void BiquadNode::reset() {
+    std::memset(_state,0,sizeof(_state));
+}
+
+
+#pragma mark -
+#pragma mark Compressor
+/**
+ * Creates a degenerate compressor.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+CompressorNode::CompressorNode() : AudioNode(),
+_threshold(0),
+_ratio(1),
+_attack(0),
+_release(0),
+_makeup(0),
+_reduction(0),
+_envelope(0),
+_current(1) {
+}
+
+/**
+ * Initializes a compressor with the given parameters.
+ *
+ * @param rate      The sample rate in HZ
+ * @param threshold The threshold in decibels
+ * @param ratio     The compression ratio
+ * @param attack    The attack time in seconds
+ * @param release   The release time in seconds
+ * @param makeup    The makeup gain in decibels
+ *
+ * @return true if initialization was successful.
+ */
+bool CompressorNode::init(Uint32 rate, float threshold, float ratio,
+                          float attack, float release, float makeup) {
+    if (!AudioNode::init("compressor",rate)) {
+        return false;
+    }
+    setThreshold(threshold);
+    setRatio(ratio);
+    setAttack(attack);
+    setRelease(release);
+    setMakeup(makeup);
+    return true;
+}
+
+/**
+ * Returns a newly allocated limiter with the given ceiling.
+ *
+ * A limiter is a compressor with an infinite ratio and no attack.
+ *
+ * @param rate      The sample rate in HZ
+ * @param ceiling   The output ceiling in decibels
+ * @param release   The release time in seconds
+ *
+ * @return a newly allocated limiter with the given ceiling.
+ */
+std::shared_ptr<CompressorNode> CompressorNode::allocLimiter(Uint32 rate, float ceiling, float release) {
+    std::shared_ptr<CompressorNode> result = alloc(rate,ceiling,INFINITY,0.0f,release,0.0f);
+    if (result != nullptr) {
+        result->setName("limiter");
+    }
+    return result;
+}
+
+/**
+ * Compresses a block of audio in place.
+ *
+ * @param buffer    The audio block (interleaved stereo)
+ * @param frames    The number of frames in the block
+ */
+void CompressorNode::process(float* buffer, Uint32 frames) {
+    const float threshold = db_to_gain(_threshold.load(std::memory_order_relaxed));
+    const float slope  = 1.0f/_ratio.load(std::memory_order_relaxed)-1.0f;
+    const float attack = _attack.load(std::memory_order_relaxed);
+    const float makeup = db_to_gain(_makeup.load(std::memory_order_relaxed));
+    const float acoeff = smoothing(attack,COMPRESSOR_SEGMENT,_rate);
+    const float rcoeff = smoothing(_release.load(std::memory_order_relaxed),COMPRESSOR_SEGMENT,_rate);
+
+    for(Uint32 pos = 0; pos < frames; pos += COMPRESSOR_SEGMENT) {
+        Uint32 amount = frames-pos < COMPRESSOR_SEGMENT ? frames-pos : COMPRESSOR_SEGMENT;
+        float* segment = buffer+2*pos;
+        float peak = peak_abs(segment,2*amount);
+        float coeff = peak > _envelope ? acoeff : rcoeff;
+        _envelope = peak+coeff*(_envelope-peak);
+
+        float target = 1.0f;
+        if (_envelope > threshold) {
+            target = std::pow(_envelope/threshold,slope);
+        }
+        // With no attack, reductions are immediate so that we never overshoot
+        if (attack == 0 && target < _current) {
+            _current = target;
+        }
+        float step = (target-_current)/amount;
+        scale_stereo(segment,amount,_current*makeup,step*makeup);
+        _current = target;
+    }
+    if (_envelope < DENORMAL_LIMIT) {
+        _envelope = 0;
+    }
+    _reduction.store(-20.0f*std::log10(_current),std::memory_order_relaxed);
+}
+
+/**
+ * Clears the envelope of this compressor.
+ */
+void CompressorNode::reset() {
+    _envelope = 0;
+    _current  = 1;
+    _reduction.store(0);
+}
+
+
+#pragma mark -
+#pragma mark Reverb
+/** The comb filter lengths at 44.1 kHz (left channel) */
+static const Uint32 COMB_TUNING[4] = { 1116, 1188, 1277, 1356 };
+/** The allpass filter lengths at 44.1 kHz (left channel) */
+static const Uint32 PASS_TUNING[2] = { 556, 441 };
+/** The extra delay of the right channel at 44.1 kHz */
+#define REVERB_SPREAD   23
+/** The input gain of the reverb */
+#define REVERB_INPUT    0.015f
+/** The output gain of the reverb wet signal */
+#define REVERB_OUTPUT   6.0f
+
+/**
+ * Creates a degenerate reverb.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+ReverbNode::ReverbNode() : AudioNode(),
+_size(0.5f),
+_damping(0.5f),
+_wet(0.25f),
+_dry(1.0f),
+_memory(nullptr),
+_scratch(nullptr) {
+    std::memset(_combs,0,sizeof(_combs));
+    std::memset(_comblen,0,sizeof(_comblen));
+    std::memset(_combpos,0,sizeof(_combpos));
+    std::memset(_combstore,0,sizeof(_combstore));
+    std::memset(_passes,0,sizeof(_passes));
+    std::memset(_passlen,0,sizeof(_passlen));
+    std::memset(_passpos,0,sizeof(_passpos));
+}
+
+/**
+ * Disposes the delay lines of this reverb.
+ */
+void ReverbNode::dispose() {
+    if (_memory != nullptr) {
+        free(_memory);
+        _memory = nullptr;
+    }
+    _scratch = nullptr;
+    std::memset(_combs,0,sizeof(_combs));
+    std::memset(_passes,0,sizeof(_passes));
+    AudioNode::dispose();
+}
+
+/**
+ * Initializes a reverb with the given parameters.
+ *
+ * @param rate      The sample rate in HZ
+ * @param size      The room size (0 to 1)
+ * @param damping   The high frequency damping (0 to 1)
+ * @param wet       The wet (reverberated) level
+ * @param dry       The dry (original) level
+ *
+ * @return true if initialization was successful.
+ */
+bool ReverbNode::init(Uint32 rate, float size, float damping, float wet, float dry) {
+    if (!AudioNode::init("reverb",rate)) {
+        return false;
+    }
+
+    // Scale the classic tunings to our sample rate
+    double scale = rate/44100.0;
+    size_t total = 2*REVERB_BLOCK_FRAMES;
+    for(Uint32 ii = 0; ii < 8; ii++) {
+        Uint32 length = COMB_TUNING[ii % 4]+(ii < 4 ? 0 : REVERB_SPREAD);
+        _comblen[ii] = (Uint32)(length*scale) > 0 ? (Uint32)(length*scale) : 1;
+        total += _comblen[ii];
+    }
+    for(Uint32 ii = 0; ii < 4; ii++) {
+        Uint32 length = PASS_TUNING[ii % 2]+(ii < 2 ? 0 : REVERB_SPREAD);
+        _passlen[ii] = (Uint32)(length*scale) > 0 ? (Uint32)(length*scale) : 1;
+        total += _passlen[ii];
+    }
+
+    _memory = (float*)malloc(total*sizeof(float));
+    if (_memory == nullptr) {
+        AudioNode::dispose();
+        return false;
+    }
+    float* next = _memory;
+    _scratch = next;
+    next += 2*REVERB_BLOCK_FRAMES;
+    for(Uint32 ii = 0; ii < 8; ii++) {
+        _combs[ii] = next;
+        next += _comblen[ii];
+    }
+    for(Uint32 ii = 0; ii < 4; ii++) {
+        _passes[ii] = next;
+        next += _passlen[ii];
+    }
+    reset();
+    setSize(size);
+    setDamping(damping);
+    setWet(wet);
+    setDry(dry);
+    return true;
+}
+
+/**
+ * Sets the room size (0 to 1).
+ *
+ * Larger rooms have longer tails.
+ *
+ * @param size  The room size (0 to 1)
+ */
+void ReverbNode::setSize(float size) {
+    _size.store(size < 0 ? 0 : (size > 1 ? 1 : size));
+}
+
+/**
+ * Sets the high frequency damping (0 to 1).
+ *
+ * @param damping   The high frequency damping (0 to 1)
+ */
+void ReverbNode::setDamping(float damping) {
+    _damping.store(damping < 0 ? 0 : (damping > 1 ? 1 : damping));
+}
+
+/**
+ * Applies reverb to a block of audio in place.
+ *
+ * @param buffer    The audio block (interleaved stereo)
+ * @param frames    The number of frames in the block
+ */
+void ReverbNode::process(float* buffer, Uint32 frames) {
+    CUAssertLog(frames <= REVERB_BLOCK_FRAMES, "Block of %d frames is too large", frames);
+    const float feedback = _size.load(std::memory_order_relaxed)*0.28f+0.7f;
+    const float damp1 = _damping.load(std::memory_order_relaxed)*0.4f;
+    const float damp2 = 1-damp1;
+
+    for(Uint32 ii = 0; ii < frames; ii++) {
+        // The tiny offset keeps the feedback loops out of denormals
+        float input = (buffer[2*ii]+buffer[2*ii+1])*REVERB_INPUT+1e-18f;
+        for(Uint32 ch = 0; ch < 2; ch++) {
+            float sum = 0;
+            for(Uint32 jj = 4*ch; jj < 4*ch+4; jj++) {
+                float* line = _combs[jj];
+                Uint32 pos  = _combpos[jj];
+                float out = line[pos];
+                _combstore[jj] = out*damp2+_combstore[jj]*damp1;
+                line[pos] = input+_combstore[jj]*feedback;
+                _combpos[jj] = pos+1 < _comblen[jj] ? pos+1 : 0;
+                sum += out;
+            }
+            for(Uint32 jj = 2*ch; jj < 2*ch+2; jj++) {
+                float* line = _passes[jj];
+                Uint32 pos  = _passpos[jj];
+                float delayed = line[pos];
+                line[pos] = sum+delayed*0.5f;
+                _passpos[jj] = pos+1 < _passlen[jj] ? pos+1 : 0;
+                sum = delayed-sum;
+            }
+            _scratch[2*ii+ch] = sum;
+        }
+    }
+
+    // Blend the wet and dry signals
+    const float wet = _wet.load(std::memory_order_relaxed)*REVERB_OUTPUT;
+    const float dry = _dry.load(std::memory_order_relaxed);
+    Uint32 ii = 0;
+    Uint32 size = 2*frames;
+#if AUDIO_LANES == 4
+    lane_t wv = lane_set(wet);
+    lane_t dv = lane_set(dry);
+    for(; ii+4 <= size; ii += 4) {
+        lane_t mix = lane_add(lane_mul(lane_loadu(buffer+ii),dv),lane_mul(lane_loadu(_scratch+ii),wv));
+        lane_storeu(buffer+ii,mix);
+    }
+#endif
+    for(; ii < size; ii++) {
+        buffer[ii] = buffer[ii]*dry+_scratch[ii]*wet;
+    }
+}
+
+/**
+ * Clears the delay lines of this reverb.
+ */
+void ReverbNode::reset() {
+    for(Uint32 ii = 0; ii < 8; ii++) {
+        if (_combs[ii] != nullptr) {
+            std::memset(_combs[ii],0,_comblen[ii]*sizeof(float));
+        }
+        _combpos[ii] = 0;
+        _combstore[ii] = 0;
+    }
+    for(Uint32 ii = 0; ii < 4; ii++) {
+        if (_passes[ii] != nullptr) {
+            std::memset(_passes[ii],0,_passlen[ii]*sizeof(float));
+        }
+        _passpos[ii] = 0;
+    }
+}
+
+
+#pragma mark -
+#pragma mark Ducker
+/**
+ * Creates a degenerate ducker.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+DuckerNode::DuckerNode() : AudioNode(),
+_key(nullptr),
+_threshold(-40.0f),
+_depth(12.0f),
+_attack(0.05f),
+_release(0.5f),
+_current(1) {
+}
+
+/**
+ * Disposes the key of this ducker.
+ */
+void DuckerNode::dispose() {
+    _key.store(nullptr);
+    _keyref = nullptr;
+    AudioNode::dispose();
+}
+
+/**
+ * Initializes a ducker with the given parameters.
+ *
+ * @param rate      The sample rate in HZ
+ * @param key       The key bus
+ * @param threshold The key threshold in decibels
+ * @param depth     The gain reduction in decibels
+ * @param attack    The attack time in seconds
+ * @param release   The release time in seconds
+ *
+ * @return true if initialization was successful.
+ */
+bool DuckerNode::init(Uint32 rate, const std::shared_ptr<AudioBus>& key, float threshold,
+                      float depth, float attack, float release) {
+    if (!AudioNode::init("ducker",rate)) {
+        return false;
+    }
+    setKey(key);
+    setThreshold(threshold);
+    setDepth(depth);
+    setAttack(attack);
+    setRelease(release);
+    return true;
+}
+
+/**
+ * Sets the key bus.
+ *
+ * The key bus must belong to the same mixer as the bus of this node.
+ *
+ * @param key   The key bus
+ */
+void DuckerNode::setKey(const std::shared_ptr<AudioBus>& key) {
+    // Buses live as long as their mixer, so the raw pointer stays valid
+    _key.store(key.get(),std::memory_order_release);
+    _keyref = key;
+}
+
+/**
+ * Ducks a block of audio in place.
+ *
+ * @param buffer    The audio block (interleaved stereo)
+ * @param frames    The number of frames in the block
+ */
+void DuckerNode::process(float* buffer, Uint32 frames) {
+    AudioBus* key = _key.load(std::memory_order_acquire);
+    float level = key != nullptr ? key->getLevel() : 0.0f;
+    float threshold = db_to_gain(_threshold.load(std::memory_order_relaxed));
+    float target = 1.0f;
+    if (level > threshold) {
+        target = db_to_gain(-_depth.load(std::memory_order_relaxed));
+    }
+    float time = target < _current ? _attack.load(std::memory_order_relaxed)
+                                   : _release.load(std::memory_order_relaxed);
+    float next = target+(_current-target)*smoothing(time,frames,_rate);
+    scale_stereo(buffer,frames,_current,(next-_current)/frames);
+    _current = next;
+}
+
+/**
+ * Restores the ducker to unity gain.
+ */
+void DuckerNode::reset() {
+    _current = 1;
+}
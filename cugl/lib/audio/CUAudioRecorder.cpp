@@ -0,0 +1,286 @@
+//
+//  CUAudioRecorder.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a recorder for offline audio.  A recorder pulls
+//  fixed-size blocks from an audio source and (optionally) keeps a copy of
+//  everything that it pulled.  The captured audio can then be encoded as a
+//  WAV file, either for listening or for byte-for-byte comparison in tests.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/audio/CUAudioRecorder.h>
+#include <cugl/audio/CUAudioEngine.h>
+#include <cugl/io/CUBinaryWriter.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+using namespace cugl;
+
+/** The size of the RIFF/WAVE header (with a plain fmt chunk) */
+#define WAV_HEADER_SIZE 44
+/** The WAV format tag for integer PCM */
+#define WAV_FORMAT_PCM   1
+/** The WAV format tag for float PCM */
+#define WAV_FORMAT_FLOAT 3
+
+#pragma mark -
+#pragma mark WAV Helpers
+/**
+ * Writes the given 16-bit value in little-endian order
+ *
+ * @param data  The output position
+ * @param value The value to write
+ *
+ * @return the next output position
+ */
+static Uint8* write_le16(Uint8* data, Uint16 value) {
+    data[0] = (Uint8)(value & 0xff);
+    data[1] = (Uint8)(value >> 8);
+    return data+2;
+}
+
+/**
+ * Writes the given 32-bit value in little-endian order
+ *
+ * @param data  The output position
+ * @param value The value to write
+ *
+ * @return the next output position
+ */
+static Uint8* write_le32(Uint8* data, Uint32 value) {
+    data[0] = (Uint8)(value & 0xff);
+    data[1] = (Uint8)((value >> 8) & 0xff);
+    data[2] = (Uint8)((value >> 16) & 0xff);
+    data[3] = (Uint8)(value >> 24);
+    return data+4;
+}
+
+/**
+ * Writes the given four character tag
+ *
+ * @param data  The output position
+ * @param tag   The tag to write
+ *
+ * @return the next output position
+ */
+static Uint8* write_tag(Uint8* data, const char* tag) {
+    std::memcpy(data, tag, 4);
+    return data+4;
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a degenerate recorder with no source.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioRecorder::AudioRecorder() :
+_source(nullptr),
+_channels(0),
+_rate(0),
+_capture(true) {
+}
+
+/**
+ * Disposes all resources allocated for this recorder.
+ *
+ * The recording is lost when this method is called.
+ */
+void AudioRecorder::dispose() {
+    _source = nullptr;
+    _channels = 0;
+    _rate = 0;
+    _capture = true;
+    _block.clear();
+    _samples.clear();
+}
+
+/**
+ * Initializes a recorder for the offline audio engine.
+ *
+ * The audio engine must have been started with
+ * {@link AudioEngine#startOffline}.  Every call to {@link advance} will
+ * render the engine.
+ *
+ * @return true if initialization was successful.
+ */
+bool AudioRecorder::init() {
+    AudioEngine* engine = AudioEngine::get();
+    if (engine == nullptr || !engine->isOffline()) {
+        CUAssertLog(false, "The audio engine is not rendering offline");
+        return false;
+    }
+    return init(engine->getOutputChannels(), engine->getSampleRate(),
+                [](float* buffer, Uint32 frames) {
+        AudioEngine* engine = AudioEngine::get();
+        if (engine != nullptr) {
+            engine->render(buffer, frames);
+        }
+    });
+}
+
+/**
+ * Initializes a recorder for the given source.
+ *
+ * @param channels  The number of channels per frame
+ * @param rate      The sample rate
+ * @param source    The audio source
+ *
+ * @return true if initialization was successful.
+ */
+bool AudioRecorder::init(Uint32 channels, Uint32 rate, const Source& source) {
+    if (_source != nullptr) {
+        CUAssertLog(false, "Recorder is already initialized");
+        return false;
+    } else if (!channels || !rate || source == nullptr) {
+        CUAssertLog(false, "Recorder requires a source, channels and rate");
+        return false;
+    }
+    _source = source;
+    _channels = channels;
+    _rate = rate;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Recording
+/**
+ * Renders the given number of frames from the source
+ *
+ * The returned block is owned by this recorder, and is only valid until
+ * the next call to this method.  If capture is enabled, the block is also
+ * appended to the recording.
+ *
+ * @param frames    The number of frames to render
+ *
+ * @return the rendered block of interleaved samples
+ */
+const float* AudioRecorder::advance(Uint32 frames) {
+    CUAssertLog(_source != nullptr, "Recorder is not initialized");
+    size_t size = (size_t)frames*_channels;
+    if (_block.size() < size) {
+        _block.resize(size);
+    }
+    std::fill(_block.begin(), _block.begin()+size, 0.0f);
+    if (_source != nullptr) {
+        _source(_block.data(), frames);
+    }
+    if (_capture) {
+        _samples.insert(_samples.end(), _block.begin(), _block.begin()+size);
+    }
+    return _block.data();
+}
+
+/**
+ * Saves the recording to the given WAV file.
+ *
+ * If floats is true, the file uses 32-bit float samples.  Otherwise the
+ * samples are clamped and converted to 16-bit integers.
+ *
+ * @param file      The path of the WAV file
+ * @param floats    Whether to encode the samples as floats
+ *
+ * @return true if the file was successfully written.
+ */
+bool AudioRecorder::save(const std::string& file, bool floats) const {
+    std::shared_ptr<BinaryWriter> writer = BinaryWriter::alloc(file);
+    if (writer == nullptr) {
+        CULogError("Could not open '%s' for writing", file.c_str());
+        return false;
+    }
+    
+    std::vector<Uint8> data = encode(floats);
+    writer->write(data.data(), data.size());
+    writer->close();
+    return true;
+}
+
+/**
+ * Encodes the given samples as a WAV file.
+ *
+ * The samples should be interleaved, with the given number of channels
+ * per frame.  If floats is true, the file uses 32-bit float samples.
+ * Otherwise the samples are clamped and converted to 16-bit integers.
+ * The previous contents of the output vector are replaced.
+ *
+ * @param samples   The interleaved samples
+ * @param frames    The number of frames
+ * @param channels  The number of channels per frame
+ * @param rate      The sample rate
+ * @param floats    Whether to encode the samples as floats
+ * @param output    The vector to store the encoded file
+ */
+void AudioRecorder::encode(const float* samples, Uint64 frames, Uint32 channels,
+                           Uint32 rate, bool floats, std::vector<Uint8>& output) {
+    Uint32 width = floats ? sizeof(float) : sizeof(Sint16);
+    Uint64 total = frames*channels;
+    Uint32 bytes = (Uint32)(total*width);
+    output.resize(WAV_HEADER_SIZE+bytes);
+    
+    Uint8* data = output.data();
+    data = write_tag(data, "RIFF");
+    data = write_le32(data, WAV_HEADER_SIZE-8+bytes);
+    data = write_tag(data, "WAVE");
+    data = write_tag(data, "fmt ");
+    data = write_le32(data, 16);
+    data = write_le16(data, floats ? WAV_FORMAT_FLOAT : WAV_FORMAT_PCM);
+    data = write_le16(data, (Uint16)channels);
+    data = write_le32(data, rate);
+    data = write_le32(data, rate*channels*width);
+    data = write_le16(data, (Uint16)(channels*width));
+    data = write_le16(data, (Uint16)(8*width));
+    data = write_tag(data, "data");
+    data = write_le32(data, bytes);
+    
+    if (floats) {
+        for(Uint64 ii = 0; ii < total; ii++) {
+            Uint32 bits;
+            std::memcpy(&bits, samples+ii, sizeof(float));
+            data = write_le32(data, bits);
+        }
+    } else {
+        for(Uint64 ii = 0; ii < total; ii++) {
+            float value = std::min(1.0f,std::max(-1.0f,samples[ii]));
+            Sint16 sample = (Sint16)std::lrint(value*32767.0f);
+            data = write_le16(data, (Uint16)sample);
+        }
+    }
+}
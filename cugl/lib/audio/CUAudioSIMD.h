@@ -0,0 +1,479 @@
+//
+//  CUAudioSIMD.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the vector primitives shared by the software mixer
+//  and the DSP nodes.  Everything is written against a small set of lane
+//  wrappers, which use SSE on x86 and NEON on ARM, with a scalar fallback
+//  for everything else.  All audio buffers are interleaved stereo floats.
+//
+//  This file is an internal header.  It is not accessible by general users
+//  of the CUGL API.  Because all of the functions are inline, it has no
+//  associated cpp file.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_AUDIO_SIMD_H__
+#define __CU_AUDIO_SIMD_H__
+#include <cugl/base/CUBase.h>
+#include <cstdint>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CU_AUDIO_SSE
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define CU_AUDIO_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace cugl {
+namespace simd {
+
+#pragma mark -
+#pragma mark Lanes
+#if defined (CU_AUDIO_SSE)
+/** The number of floats in a lane */
+#define AUDIO_LANES 4
+typedef __m128 lane_t;
+static inline lane_t lane_set(float v)        { return _mm_set1_ps(v); }
+static inline lane_t lane_load(const float* p) { return _mm_load_ps(p); }
+static inline lane_t lane_loadu(const float* p) { return _mm_loadu_ps(p); }
+static inline void lane_store(float* p, lane_t a) { _mm_store_ps(p,a); }
+static inline void lane_storeu(float* p, lane_t a) { _mm_storeu_ps(p,a); }
+static inline lane_t lane_add(lane_t a, lane_t b) { return _mm_add_ps(a,b); }
+static inline lane_t lane_sub(lane_t a, lane_t b) { return _mm_sub_ps(a,b); }
+static inline lane_t lane_mul(lane_t a, lane_t b) { return _mm_mul_ps(a,b); }
+static inline lane_t lane_div(lane_t a, lane_t b) { return _mm_div_ps(a,b); }
+static inline lane_t lane_min(lane_t a, lane_t b) { return _mm_min_ps(a,b); }
+static inline lane_t lane_max(lane_t a, lane_t b) { return _mm_max_ps(a,b); }
+static inline lane_t lane_sqrt(lane_t a)          { return _mm_sqrt_ps(a); }
+static inline lane_t lane_abs(lane_t a) {
+    return _mm_and_ps(a,_mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+}
+static inline float lane_hsum(lane_t a) {
+    __m128 s = _mm_add_ps(a,_mm_movehl_ps(a,a));
+    s = _mm_add_ss(s,_mm_shuffle_ps(s,s,1));
+    return _mm_cvtss_f32(s);
+}
+static inline float lane_hmax(lane_t a) {
+    __m128 s = _mm_max_ps(a,_mm_movehl_ps(a,a));
+    s = _mm_max_ss(s,_mm_shuffle_ps(s,s,1));
+    return _mm_cvtss_f32(s);
+}
+#elif defined (CU_AUDIO_NEON)
+/** The number of floats in a lane */
+#define AUDIO_LANES 4
+typedef float32x4_t lane_t;
+static inline lane_t lane_set(float v)        { return vdupq_n_f32(v); }
+static inline lane_t lane_load(const float* p) { return vld1q_f32(p); }
+static inline lane_t lane_loadu(const float* p) { return vld1q_f32(p); }
+static inline void lane_store(float* p, lane_t a) { vst1q_f32(p,a); }
+static inline void lane_storeu(float* p, lane_t a) { vst1q_f32(p,a); }
+static inline lane_t lane_add(lane_t a, lane_t b) { return vaddq_f32(a,b); }
+static inline lane_t lane_sub(lane_t a, lane_t b) { return vsubq_f32(a,b); }
+static inline lane_t lane_mul(lane_t a, lane_t b) { return vmulq_f32(a,b); }
+static inline lane_t lane_min(lane_t a, lane_t b) { return vminq_f32(a,b); }
+static inline lane_t lane_max(lane_t a, lane_t b) { return vmaxq_f32(a,b); }
+static inline lane_t lane_abs(lane_t a)           { return vabsq_f32(a); }
+static inline lane_t lane_div(lane_t a, lane_t b) {
+    // Reciprocal estimate with two Newton-Raphson refinements
+    lane_t r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b,r),r);
+    r = vmulq_f32(vrecpsq_f32(b,r),r);
+    return vmulq_f32(a,r);
+}
+static inline lane_t lane_sqrt(lane_t a) {
+    // Inputs are strictly positive, so x*rsqrt(x) is safe
+    lane_t e = vrsqrteq_f32(a);
+    e = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a,e),e),e);
+    e = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a,e),e),e);
+    return vmulq_f32(a,e);
+}
+static inline float lane_hsum(lane_t a) {
+    float32x2_t s = vadd_f32(vget_low_f32(a),vget_high_f32(a));
+    return vget_lane_f32(vpadd_f32(s,s),0);
+}
+static inline float lane_hmax(lane_t a) {
+    float32x2_t s = vmax_f32(vget_low_f32(a),vget_high_f32(a));
+    return vget_lane_f32(vpmax_f32(s,s),0);
+}
+#else
+/** The number of floats in a lane */
+#define AUDIO_LANES 1
+typedef float lane_t;
+static inline lane_t lane_set(float v)        { return v; }
+static inline lane_t lane_load(const float* p) { return *p; }
+static inline lane_t lane_loadu(const float* p) { return *p; }
+static inline void lane_store(float* p, lane_t a) { *p = a; }
+static inline void lane_storeu(float* p, lane_t a) { *p = a; }
+static inline lane_t lane_add(lane_t a, lane_t b) { return a+b; }
+static inline lane_t lane_sub(lane_t a, lane_t b) { return a-b; }
+static inline lane_t lane_mul(lane_t a, lane_t b) { return a*b; }
+static inline lane_t lane_div(lane_t a, lane_t b) { return a/b; }
+static inline lane_t lane_min(lane_t a, lane_t b) { return a < b ? a : b; }
+static inline lane_t lane_max(lane_t a, lane_t b) { return a > b ? a : b; }
+static inline lane_t lane_sqrt(lane_t a)          { return std::sqrt(a); }
+static inline lane_t lane_abs(lane_t a)           { return std::fabs(a); }
+static inline float lane_hsum(lane_t a)           { return a; }
+static inline float lane_hmax(lane_t a)           { return a; }
+#endif
+
+/**
+ * Returns the sine and cosine of angles in the range [-pi/4,pi/4]
+ *
+ * This uses a short Taylor series, which is accurate to about 1e-6 in
+ * this range.
+ *
+ * @param x         The angles
+ * @param sine      The sines (output)
+ * @param cosine    The cosines (output)
+ */
+static inline void lane_sincos(lane_t x, lane_t& sine, lane_t& cosine) {
+    lane_t x2 = lane_mul(x,x);
+    lane_t s = lane_set(-1.0f/5040.0f);
+    s = lane_add(lane_set(1.0f/120.0f),lane_mul(x2,s));
+    s = lane_add(lane_set(-1.0f/6.0f), lane_mul(x2,s));
+    s = lane_add(lane_set(1.0f),       lane_mul(x2,s));
+    sine = lane_mul(x,s);
+    lane_t c = lane_set(-1.0f/720.0f);
+    c = lane_add(lane_set(1.0f/24.0f),lane_mul(x2,c));
+    c = lane_add(lane_set(-0.5f),     lane_mul(x2,c));
+    cosine = lane_add(lane_set(1.0f), lane_mul(x2,c));
+}
+
+
+#pragma mark -
+#pragma mark Buffer Kernels
+/**
+ * Returns a pointer aligned to a 16 byte boundary
+ *
+ * @param raw   The raw allocation (with at least 15 bytes of padding)
+ *
+ * @return a pointer aligned to a 16 byte boundary
+ */
+static inline float* align16(void* raw) {
+    return (float*)(((uintptr_t)raw+15) & ~(uintptr_t)15);
+}
+
+/**
+ * Scales a stereo buffer in place with a linear gain ramp.
+ *
+ * The gain of frame i is gain+i*step (in both channels).
+ *
+ * @param buffer    The buffer (interleaved stereo)
+ * @param frames    The number of frames to scale
+ * @param gain      The gain of the first frame
+ * @param step      The per-frame gain increment
+ */
+static inline void scale_stereo(float* buffer, Uint32 frames, float gain, float step) {
+    Uint32 ii = 0;
+#if AUDIO_LANES == 4
+    float start[4] = { gain, gain, gain+step, gain+step };
+    lane_t g = lane_loadu(start);
+    lane_t d = lane_set(2*step);
+    for(; ii+2 <= frames; ii += 2) {
+        lane_storeu(buffer+2*ii,lane_mul(lane_loadu(buffer+2*ii),g));
+        g = lane_add(g,d);
+    }
+#endif
+    for(; ii < frames; ii++) {
+        float g = gain+ii*step;
+        buffer[2*ii  ] *= g;
+        buffer[2*ii+1] *= g;
+    }
+}
+
+/**
+ * Returns the sum of the squares of the given samples.
+ *
+ * @param buffer    The samples
+ * @param size      The number of samples (not frames)
+ *
+ * @return the sum of the squares of the given samples.
+ */
+static inline float sum_squares(const float* buffer, Uint32 size) {
+    Uint32 ii = 0;
+    float result = 0;
+#if AUDIO_LANES == 4
+    lane_t acc = lane_set(0);
+    for(; ii+4 <= size; ii += 4) {
+        lane_t v = lane_loadu(buffer+ii);
+        acc = lane_add(acc,lane_mul(v,v));
+    }
+    result = lane_hsum(acc);
+#endif
+    for(; ii < size; ii++) {
+        result += buffer[ii]*buffer[ii];
+    }
+    return result;
+}
+
+/**
+ * Returns the largest absolute value of the given samples.
+ *
+ * @param buffer    The samples
+ * @param size      The number of samples (not frames)
+ *
+ * @return the largest absolute value of the given samples.
+ */
+static inline float peak_abs(const float* buffer, Uint32 size) {
+    Uint32 ii = 0;
+    float result = 0;
+#if AUDIO_LANES == 4
+    lane_t acc = lane_set(0);
+    for(; ii+4 <= size; ii += 4) {
+        acc = lane_max(acc,lane_abs(lane_loadu(buffer+ii)));
+    }
+    result = lane_hmax(acc);
+#endif
+    for(; ii < size; ii++) {
+        float v = std::fabs(buffer[ii]);
+        result = v > result ? v : result;
+    }
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Mixing Kernels
+/** The scale factor converting floats to 16-bit samples */
+#define MIXER_S16_SCALE 32767.0f
+
+/**
+ * Adds a stereo source to a stereo output with a linear gain ramp.
+ *
+ * The gain of frame i in channel c is gains[c]+i*steps[c].
+ *
+ * @param out       The output buffer (interleaved stereo)
+ * @param src       The source buffer (interleaved stereo)
+ * @param frames    The number of frames to mix
+ * @param gains     The gain of the first frame (left and right)
+ * @param steps     The per-frame gain increment (left and right)
+ */
+static inline void mix_stereo(float* out, const float* src, Uint32 frames, const float* gains, const float* steps) {
+    Uint32 ii = 0;
+#if defined (CU_AUDIO_SSE)
+    __m128 g = _mm_setr_ps(gains[0],gains[1],gains[0]+steps[0],gains[1]+steps[1]);
+    __m128 d = _mm_setr_ps(2*steps[0],2*steps[1],2*steps[0],2*steps[1]);
+    for(; ii+2 <= frames; ii += 2) {
+        __m128 s = _mm_loadu_ps(src+2*ii);
+        __m128 o = _mm_loadu_ps(out+2*ii);
+        _mm_storeu_ps(out+2*ii,_mm_add_ps(o,_mm_mul_ps(s,g)));
+        g = _mm_add_ps(g,d);
+    }
+#elif defined (CU_AUDIO_NEON)
+    float32x4_t g = {gains[0],gains[1],gains[0]+steps[0],gains[1]+steps[1]};
+    float32x4_t d = {2*steps[0],2*steps[1],2*steps[0],2*steps[1]};
+    for(; ii+2 <= frames; ii += 2) {
+        float32x4_t s = vld1q_f32(src+2*ii);
+        float32x4_t o = vld1q_f32(out+2*ii);
+        vst1q_f32(out+2*ii,vmlaq_f32(o,s,g));
+        g = vaddq_f32(g,d);
+    }
+#endif
+    for(; ii < frames; ii++) {
+        out[2*ii  ] += src[2*ii  ]*(gains[0]+ii*steps[0]);
+        out[2*ii+1] += src[2*ii+1]*(gains[1]+ii*steps[1]);
+    }
+}
+
+/**
+ * Adds a mono source to a stereo output with a linear gain ramp.
+ *
+ * The gain of frame i in channel c is gains[c]+i*steps[c].  The source is
+ * copied to both channels of the output.
+ *
+ * @param out       The output buffer (interleaved stereo)
+ * @param src       The source buffer (mono)
+ * @param frames    The number of frames to mix
+ * @param gains     The gain of the first frame (left and right)
+ * @param steps     The per-frame gain increment (left and right)
+ */
+static inline void mix_mono(float* out, const float* src, Uint32 frames, const float* gains, const float* steps) {
+    Uint32 ii = 0;
+#if defined (CU_AUDIO_SSE)
+    __m128 glo = _mm_setr_ps(gains[0],gains[1],gains[0]+steps[0],gains[1]+steps[1]);
+    __m128 d = _mm_setr_ps(2*steps[0],2*steps[1],2*steps[0],2*steps[1]);
+    __m128 ghi = _mm_add_ps(glo,d);
+    d = _mm_add_ps(d,d);
+    for(; ii+4 <= frames; ii += 4) {
+        __m128 s  = _mm_loadu_ps(src+ii);
+        __m128 lo = _mm_mul_ps(_mm_unpacklo_ps(s,s),glo);
+        __m128 hi = _mm_mul_ps(_mm_unpackhi_ps(s,s),ghi);
+        _mm_storeu_ps(out+2*ii,  _mm_add_ps(_mm_loadu_ps(out+2*ii),  lo));
+        _mm_storeu_ps(out+2*ii+4,_mm_add_ps(_mm_loadu_ps(out+2*ii+4),hi));
+        glo = _mm_add_ps(glo,d);
+        ghi = _mm_add_ps(ghi,d);
+    }
+#elif defined (CU_AUDIO_NEON)
+    float32x4_t glo = {gains[0],gains[1],gains[0]+steps[0],gains[1]+steps[1]};
+    float32x4_t d = {2*steps[0],2*steps[1],2*steps[0],2*steps[1]};
+    float32x4_t ghi = vaddq_f32(glo,d);
+    d = vaddq_f32(d,d);
+    for(; ii+4 <= frames; ii += 4) {
+        float32x4_t s = vld1q_f32(src+ii);
+        float32x4x2_t z = vzipq_f32(s,s);
+        vst1q_f32(out+2*ii,  vmlaq_f32(vld1q_f32(out+2*ii),  z.val[0],glo));
+        vst1q_f32(out+2*ii+4,vmlaq_f32(vld1q_f32(out+2*ii+4),z.val[1],ghi));
+        glo = vaddq_f32(glo,d);
+        ghi = vaddq_f32(ghi,d);
+    }
+#endif
+    for(; ii < frames; ii++) {
+        out[2*ii  ] += src[ii]*(gains[0]+ii*steps[0]);
+        out[2*ii+1] += src[ii]*(gains[1]+ii*steps[1]);
+    }
+}
+
+/**
+ * Adds interleaved floats to interleaved 16-bit samples with saturation.
+ *
+ * @param out       The output buffer
+ * @param src       The source buffer
+ * @param size      The number of samples (not frames)
+ */
+static inline void add_s16(Sint16* out, const float* src, Uint32 size) {
+    Uint32 ii = 0;
+#if defined (CU_AUDIO_SSE)
+    __m128 scale = _mm_set1_ps(MIXER_S16_SCALE);
+    __m128 upper = _mm_set1_ps(32767.0f);
+    __m128 lower = _mm_set1_ps(-32768.0f);
+    for(; ii+8 <= size; ii += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src+ii),  scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src+ii+4),scale);
+        a = _mm_max_ps(_mm_min_ps(a,upper),lower);
+        b = _mm_max_ps(_mm_min_ps(b,upper),lower);
+        __m128i p = _mm_packs_epi32(_mm_cvtps_epi32(a),_mm_cvtps_epi32(b));
+        __m128i o = _mm_loadu_si128((const __m128i*)(out+ii));
+        _mm_storeu_si128((__m128i*)(out+ii),_mm_adds_epi16(o,p));
+    }
+#elif defined (CU_AUDIO_NEON)
+    float32x4_t scale = vdupq_n_f32(MIXER_S16_SCALE);
+    for(; ii+8 <= size; ii += 8) {
+        int32x4_t a = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src+ii),  scale));
+        int32x4_t b = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src+ii+4),scale));
+        int16x8_t p = vcombine_s16(vqmovn_s32(a),vqmovn_s32(b));
+        vst1q_s16(out+ii,vqaddq_s16(vld1q_s16(out+ii),p));
+    }
+#endif
+    for(; ii < size; ii++) {
+        float v = out[ii]+src[ii]*MIXER_S16_SCALE;
+        v = (v > 32767.0f ? 32767.0f : (v < -32768.0f ? -32768.0f : v));
+        out[ii] = (Sint16)v;
+    }
+}
+
+/**
+ * Adds interleaved floats to interleaved floats.
+ *
+ * @param out       The output buffer
+ * @param src       The source buffer
+ * @param size      The number of samples (not frames)
+ */
+static inline void add_f32(float* out, const float* src, Uint32 size) {
+    Uint32 ii = 0;
+#if defined (CU_AUDIO_SSE)
+    for(; ii+4 <= size; ii += 4) {
+        _mm_storeu_ps(out+ii,_mm_add_ps(_mm_loadu_ps(out+ii),_mm_loadu_ps(src+ii)));
+    }
+#elif defined (CU_AUDIO_NEON)
+    for(; ii+4 <= size; ii += 4) {
+        vst1q_f32(out+ii,vaddq_f32(vld1q_f32(out+ii),vld1q_f32(src+ii)));
+    }
+#endif
+    for(; ii < size; ii++) {
+        out[ii] += src[ii];
+    }
+}
+
+
+#pragma mark -
+#pragma mark Conversion Kernels
+/**
+ * Returns the dot product of two sample arrays.
+ *
+ * This is the inner loop of the resampling filter.
+ *
+ * @param a         The first array
+ * @param b         The second array
+ * @param size      The number of samples
+ *
+ * @return the dot product of two sample arrays.
+ */
+static inline float dot_f32(const float* a, const float* b, Uint32 size) {
+    Uint32 ii = 0;
+    float result = 0;
+#if AUDIO_LANES == 4
+    lane_t acc0 = lane_set(0);
+    lane_t acc1 = lane_set(0);
+    for(; ii+8 <= size; ii += 8) {
+        acc0 = lane_add(acc0,lane_mul(lane_loadu(a+ii),  lane_loadu(b+ii)));
+        acc1 = lane_add(acc1,lane_mul(lane_loadu(a+ii+4),lane_loadu(b+ii+4)));
+    }
+    for(; ii+4 <= size; ii += 4) {
+        acc0 = lane_add(acc0,lane_mul(lane_loadu(a+ii),lane_loadu(b+ii)));
+    }
+    result = lane_hsum(lane_add(acc0,acc1));
+#endif
+    for(; ii < size; ii++) {
+        result += a[ii]*b[ii];
+    }
+    return result;
+}
+
+/**
+ * Converts 16-bit samples to floats in the range [-1,1].
+ *
+ * @param out       The output buffer
+ * @param src       The source buffer
+ * @param size      The number of samples (not frames)
+ */
+static inline void s16_to_f32(float* out, const Sint16* src, Uint32 size) {
+    Uint32 ii = 0;
+#if defined (CU_AUDIO_SSE)
+    __m128 scale = _mm_set1_ps(1.0f/32768.0f);
+    for(; ii+8 <= size; ii += 8) {
+        __m128i s  = _mm_loadu_si128((const __m128i*)(src+ii));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s,s),16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s,s),16);
+        _mm_storeu_ps(out+ii,  _mm_mul_ps(_mm_cvtepi32_ps(lo),scale));
+        _mm_storeu_ps(out+ii+4,_mm_mul_ps(_mm_cvtepi32_ps(hi),scale));
+    }
+#elif defined (CU_AUDIO_NEON)
+    float32x4_t scale = vdupq_n_f32(1.0f/32768.0f);
+    for(; ii+8 <= size; ii += 8) {
+        int16x8_t s = vld1q_s16(src+ii);
+        vst1q_f32(out+ii,  vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), scale));
+        vst1q_f32(out+ii+4,vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))),scale));
+    }
+#endif
+    for(; ii < size; ii++) {
+        out[ii] = src[ii]/32768.0f;
+    }
+}
+
+}
+}
+
+#endif /* __CU_AUDIO_SIMD_H__ */
@@ -63,6 +63,7 @@ bool MusicQueue::init() {
     _player  = impl::AudioAllocBackground();
     _paused  = false;
     _playing = false;
+    _cued    = false;
     
     return _player;
 }
@@ -100,7 +101,12 @@ void MusicQueue::dispose() {
  * play the music immediately.  Otherwise, it will add the music to the
  * queue, and it will play as soon as it is removed from the queue.
  * When it begins playing, it will start at full volume unless you
- * provide a number of seconds to fade in.
+ * provide a number of seconds to fade in.  If the music follows another
+ * track in the queue, the fade is a crossfade with the end of that track.
+ *
+ * If the music plays immediately, it may be scheduled to start at a
+ * later time of the audio clock.  The time is ignored for music that
+ * waits in the queue.
  *
  * Note that looping a song will cause it to block the queue indefinitely
  * until you turn off looping for that asset {@see setLoop}. This can be
@@ -111,14 +117,17 @@ void MusicQueue::dispose() {
  * @param volume    The music volume
  * @param loop      Whether to loop the music continuously
  * @param fade      The number of seconds to fade in
+ * @param time      The audio clock time to start (0 for immediately)
  */
-void MusicQueue::enqueue(const std::shared_ptr<Music>& music, float volume, bool loop, float fade) {
+void MusicQueue::enqueue(const std::shared_ptr<Music>& music, float volume, bool loop,
+                         float fade, Uint64 time) {
     if (_music == nullptr) {
         _music = music;
         _backgd = music;
         _settings.volume = volume;
         _settings.fade = fade;
         _settings.loop = loop;
+        _settings.time = time;
         play();
         return;
     }
@@ -127,8 +136,10 @@ void MusicQueue::enqueue(const std::shared_ptr<Music>& music, float volume, bool
     set.volume = volume;
     set.fade = fade;
     set.loop = loop;
+    set.time = 0;
     _mqueue.push_back(music);
     _squeue.push_back(set);
+    cue();
 }
 
 /**
@@ -138,7 +149,7 @@ void MusicQueue::enqueue(const std::shared_ptr<Music>& music, float volume, bool
  */
 const std::vector<const Music*> MusicQueue::getQueue() const {
     std::vector<const Music*> result;
-    for(auto it = _mqueue.begin(); it != _mqueue.begin(); ++it) {
+    for(auto it = _mqueue.begin(); it != _mqueue.end(); ++it) {
         Music* packet = it->get();
         result.push_back(packet);
     }
@@ -166,7 +177,9 @@ void MusicQueue::advance(unsigned int steps) {
         pos--;
     }
     if (pos >= 0) {
+        // Halting the player also removes its cue
         _music = nullptr;
+        _cued  = false;
         if (impl::AudioBackgroundPlaying(_player)) {
             impl::AudioHaltBackground(_player);
         }
@@ -182,10 +195,62 @@ void MusicQueue::advance(unsigned int steps) {
  * only clears pending music assets from the queue.
  */
 void MusicQueue::clear() {
+    uncue();
     _mqueue.clear();
     _squeue.clear();
 }
 
+/**
+ * Updates the queue when the active music asset completes.
+ *
+ * If the next asset in the queue was cued, and has already taken over
+ * the player, this method makes it the active asset and cues the asset
+ * after it.  Otherwise, this method advances the queue as normal.
+ *
+ * This method should only be called by the audio engine.
+ */
+void MusicQueue::complete() {
+    if (_cued && impl::AudioBackgroundPlaying(_player)) {
+        _music = _mqueue.front();
+        _backgd = _music;
+        _settings = _squeue.front();
+        _mqueue.pop_front();
+        _squeue.pop_front();
+        _cued = false;
+        cue();
+    } else {
+        // The cue (if any) was too late; play the next asset the usual way
+        _cued = false;
+        advance();
+    }
+}
+
+/**
+ * Cues the front of the queue to follow the active asset.
+ *
+ * This method does nothing if the queue is empty, or if the front of the
+ * queue is already cued.
+ */
+void MusicQueue::cue() {
+    if (_cued || _mqueue.empty() || !impl::AudioBackgroundPlaying(_player)) {
+        return;
+    }
+    const MusicSettings& next = _squeue.front();
+    Uint32 millis = (Uint32)(next.fade*1000);
+    impl::AudioQueueBackground(_player, _mqueue.front()->_buffer, next.loop, next.volume, millis);
+    _cued = true;
+}
+
+/**
+ * Removes the cue (if any) from the player.
+ */
+void MusicQueue::uncue() {
+    if (_cued) {
+        impl::AudioQueueBackground(_player, nullptr, false, 0);
+        _cued = false;
+    }
+}
+
 
 #pragma mark -
 #pragma mark Playback Control
@@ -197,15 +262,21 @@ void MusicQueue::play() {
         return;
     }
     
+    // A new play replaces any cue on the player
+    _cued = false;
     impl::AudioSetBackgroundVolume(_player, _settings.volume);
-    if (_settings.fade > 0) {
-        Uint32 millis = (Uint32)(_settings.fade*1000);
+    Uint32 millis = (Uint32)(_settings.fade*1000);
+    if (_settings.time > 0) {
+        impl::AudioScheduleBackground(_player, _music->_buffer, _settings.loop, _settings.time, millis);
+        _settings.time = 0;
+    } else if (_settings.fade > 0) {
         impl::AudioFadeInBackground(_player, _music->_buffer, _settings.loop, 0, millis);
     } else {
         impl::AudioPlayBackground(_player, _music->_buffer, _settings.loop);
     }
     
     _playing = true;
+    cue();
 }
 
 /**
@@ -263,6 +334,8 @@ bool MusicQueue::resume() {
  * @param fade  The number of seconds to fade out
  */
 void MusicQueue::stop(float fade) {
+    // Clear first, so that the halt does not advance the queue
+    clear();
     if (fade > 0) {
         impl::AudioFadeOutBackground(_player, (Uint32)(fade*1000));
     } else {
@@ -270,7 +343,6 @@ void MusicQueue::stop(float fade) {
     }
     _music = nullptr;
     _playing = false;
-    clear();
 }
 
 
@@ -78,6 +78,8 @@ typedef struct {
     float fade;
     /** Whether to loop the music */
     bool  loop;
+    /** The audio clock time to start the music (0 for immediately) */
+    Uint64 time;
 } MusicSettings;
 
     
@@ -93,7 +95,9 @@ typedef struct {
  * In general, there is usually only one music queue at a time, representing 
  * the application background music.  The queue allows the user to queue up
  * additional tracks ahead of time so that transition from one song to another
- * is seamless.
+ * is seamless.  The next track in the queue is always cued on the player, so
+ * that it starts on the audio frame after the active track ends (or overlaps
+ * the end of the active track, if it has a fade).
  *
  * IMPORTANT: For best performance, it is absolutely crucial that all music
  * have exactly the same format. The same file format, the same sampling rate,
@@ -116,6 +120,8 @@ private:
     bool  _playing;
     /** Whether the player is paused (but may still be active) */
     bool  _paused;
+    /** Whether the front of the queue is cued to follow the active asset */
+    bool  _cued;
 
     /** The queue for subsequent music loops */
     std::deque<std::shared_ptr<Music>> _mqueue;
@@ -135,7 +141,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
      * the heap, use one of the static constructors instead.
      */
-    MusicQueue() : _player(nullptr) {}
+    MusicQueue() : _player(nullptr), _cued(false) {}
     
     /**
      * Disposes of this playback queue, detaching it from the audio engine.
@@ -194,7 +200,12 @@ public:
      * play the music immediately.  Otherwise, it will add the music to the
      * queue, and it will play as soon as it is removed from the queue.
      * When it begins playing, it will start at full volume unless you
-     * provide a number of seconds to fade in.
+     * provide a number of seconds to fade in.  If the music follows another
+     * track in the queue, the fade is a crossfade with the end of that track.
+     *
+     * If the music plays immediately, it may be scheduled to start at a
+     * later time of the audio clock.  The time is ignored for music that
+     * waits in the queue.
      *
      * Note that looping a song will cause it to block the queue indefinitely
      * until you turn off looping for that asset {@see setLoop}. This can be
@@ -205,8 +216,10 @@ public:
      * @param volume    The music volume
      * @param loop      Whether to loop the music continuously
      * @param fade      The number of seconds to fade in
+     * @param time      The audio clock time to start (0 for immediately)
      */
-    void enqueue(const std::shared_ptr<Music>& music, float volume=1.0f, bool loop=false, float fade=0.0f);
+    void enqueue(const std::shared_ptr<Music>& music, float volume=1.0f, bool loop=false,
+                 float fade=0.0f, Uint64 time=0);
     
     /**
      * Returns the size of the music queue
@@ -256,7 +269,33 @@ public:
      */
     void clear();
     
+    /**
+     * Updates the queue when the active music asset completes.
+     *
+     * If the next asset in the queue was cued, and has already taken over
+     * the player, this method makes it the active asset and cues the asset
+     * after it.  Otherwise, this method advances the queue as normal.
+     *
+     * This method should only be called by the audio engine.
+     */
+    void complete();
+    
     
+private:
+    /**
+     * Cues the front of the queue to follow the active asset.
+     *
+     * This method does nothing if the queue is empty, or if the front of the
+     * queue is already cued.
+     */
+    void cue();
+    
+    /**
+     * Removes the cue (if any) from the player.
+     */
+    void uncue();
+    
+public:
 #pragma mark -
 #pragma mark Playback Control
     /**
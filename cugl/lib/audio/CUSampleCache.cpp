@@ -0,0 +1,325 @@
+//
+//  CUSampleCache.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a cache of decoded sound assets.  Sounds are keyed by
+//  the contents of their file (and the output sample rate), so the same file
+//  loaded under two different keys shares a single PCM buffer.  Sounds that
+//  do not match the output sample rate are resampled exactly once, when they
+//  are loaded, so the mixer never has to convert a sound when it plays it.
+//
+//  The resampling filter uses SSE on x86 and NEON on ARM, with a scalar
+//  fallback for everything else.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include "CUSampleCache.h"
+#include "CUAudioSIMD.h"
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+using namespace cugl;
+using namespace cugl::simd;
+
+/** The FNV-1a offset basis */
+#define FNV_OFFSET  14695981039346656037ULL
+/** The FNV-1a prime */
+#define FNV_PRIME   1099511628211ULL
+
+#pragma mark -
+#pragma mark Helpers
+/**
+ * Returns the resampling filter at the given offset
+ *
+ * The filter is a sinc with the given cutoff (as a fraction of the input
+ * Nyquist frequency), with a Blackman window of the given half-width.
+ *
+ * @param x         The offset in input samples
+ * @param cutoff    The cutoff frequency
+ * @param half      The half-width of the window in input samples
+ *
+ * @return the resampling filter at the given offset
+ */
+static double resample_filter(double x, double cutoff, double half) {
+    const double pi = 3.14159265358979323846;
+    if (std::fabs(x) >= half) {
+        return 0.0;
+    }
+    double u = x/half;
+    double window = 0.42+0.5*std::cos(pi*u)+0.08*std::cos(2*pi*u);
+    double y = pi*cutoff*x;
+    double sinc = (std::fabs(y) < 1e-9 ? 1.0 : std::sin(y)/y);
+    return cutoff*sinc*window;
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes this sample cache, releasing all resources.
+ *
+ * Any buffers still in use by sounds (or the mixer) remain valid, but
+ * they are no longer shared with new sounds.
+ */
+void SampleCache::dispose() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _bytes = 0;
+    _rate = 0;
+}
+
+/**
+ * Initializes an empty sample cache for the given output rate.
+ *
+ * @param rate  The output sample rate in HZ
+ *
+ * @return true if initialization was successful.
+ */
+bool SampleCache::init(Uint32 rate) {
+    if (_rate != 0) {
+        CUAssertLog(false, "Sample cache is already initialized");
+        return false;
+    } else if (rate == 0) {
+        return false;
+    }
+    _rate = rate;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Cache Access
+/**
+ * Returns the cache key for the given file contents.
+ *
+ * The key is a 64-bit FNV-1a hash of the contents and the output rate.
+ *
+ * @param data  The (compressed) file contents
+ *
+ * @return the cache key for the given file contents.
+ */
+Uint64 SampleCache::getKey(const std::string& data) const {
+    Uint64 hash = FNV_OFFSET;
+    const Uint8* bytes = (const Uint8*)data.data();
+    for(size_t ii = 0; ii < data.size(); ii++) {
+        hash = (hash ^ bytes[ii])*FNV_PRIME;
+    }
+    for(Uint32 ii = 0; ii < 4; ii++) {
+        hash = (hash ^ ((_rate >> (8*ii)) & 0xff))*FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Returns the decoded samples for the given key (or nullptr)
+ *
+ * If the key is in the cache, this method adds a reference to the entry.
+ * That reference must be removed with {@link release}.
+ *
+ * @param key   The cache key
+ *
+ * @return the decoded samples for the given key (or nullptr)
+ */
+std::shared_ptr<PCMBuffer> SampleCache::acquire(Uint64 key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return nullptr;
+    }
+    it->second.refs++;
+    return it->second.buffer;
+}
+
+/**
+ * Adds the decoded samples to the cache, returning the cached buffer.
+ *
+ * The buffer should already be at the output rate.  If another thread
+ * inserted the same key first, this method returns the existing buffer
+ * and the given one should be discarded.  In either case, this method
+ * adds a reference to the entry, which must be removed with
+ * {@link release}.
+ *
+ * @param key       The cache key
+ * @param buffer    The decoded samples
+ *
+ * @return the cached buffer for the given key.
+ */
+std::shared_ptr<PCMBuffer> SampleCache::insert(Uint64 key, const std::shared_ptr<PCMBuffer>& buffer) {
+    if (buffer == nullptr) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        it->second.refs++;
+        return it->second.buffer;
+    }
+    Entry entry;
+    entry.buffer = buffer;
+    entry.refs = 1;
+    _entries.emplace(key,entry);
+    _bytes += buffer->getSize();
+    return buffer;
+}
+
+/**
+ * Removes a reference to the entry for the given key.
+ *
+ * The entry is removed from the cache when it has no more references.
+ *
+ * @param key   The cache key
+ */
+void SampleCache::release(Uint64 key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return;
+    }
+    if (--(it->second.refs) == 0) {
+        _bytes -= it->second.buffer->getSize();
+        _entries.erase(it);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Statistics
+/**
+ * Returns the number of sound assets using the entry for the given key.
+ *
+ * @param key   The cache key
+ *
+ * @return the number of sound assets using the entry for the given key.
+ */
+Uint32 SampleCache::getShareCount(Uint64 key) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(key);
+    return (it == _entries.end() ? 0 : it->second.refs);
+}
+
+/**
+ * Returns the number of distinct entries in this cache.
+ *
+ * @return the number of distinct entries in this cache.
+ */
+size_t SampleCache::getSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+/**
+ * Returns the total size of the cached samples in bytes.
+ *
+ * Shared entries are only counted once.
+ *
+ * @return the total size of the cached samples in bytes.
+ */
+size_t SampleCache::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes;
+}
+
+
+#pragma mark -
+#pragma mark Resampling
+/**
+ * Returns a copy of the buffer resampled to the given rate.
+ *
+ * The filter is a Blackman-windowed sinc with {@link RESAMPLE_HALF_TAPS}
+ * zero crossings on either side, interpolated from a table of
+ * {@link RESAMPLE_PHASES} fractional positions.  When the rate is lowered,
+ * the cutoff is lowered with it to prevent aliasing.  The channel count
+ * is unchanged.  If the buffer is already at the given rate, it is
+ * returned as is.
+ *
+ * This method is expensive, and is intended to be called once per sound
+ * when the sound is loaded.
+ *
+ * @param source    The buffer to resample
+ * @param rate      The new sample rate in HZ
+ *
+ * @return a copy of the buffer resampled to the given rate.
+ */
+std::shared_ptr<PCMBuffer> SampleCache::resample(const std::shared_ptr<PCMBuffer>& source, Uint32 rate) {
+    if (source == nullptr || rate == 0 || source->getRate() == 0 || source->getRate() == rate) {
+        return source;
+    }
+    
+    Uint32 inrate = source->getRate();
+    Uint32 chans  = source->getChannels();
+    Uint64 inframes  = source->getFrames();
+    Uint64 outframes = (inframes*rate+inrate-1)/inrate;
+    std::shared_ptr<PCMBuffer> result = PCMBuffer::alloc(chans,outframes,rate);
+    if (result == nullptr || outframes == 0) {
+        return result;
+    }
+    
+    // Lowering the rate lowers the cutoff, which needs a wider window
+    double cutoff = (rate < inrate ? (double)rate/inrate : 1.0);
+    Uint32 half = (Uint32)std::ceil(RESAMPLE_HALF_TAPS/cutoff);
+    Uint32 taps = (2*half+3) & ~3;
+    
+    // Row p holds the filter for a position p/RESAMPLE_PHASES past a sample
+    std::vector<float> table((RESAMPLE_PHASES+1)*taps);
+    for(Uint32 pp = 0; pp <= RESAMPLE_PHASES; pp++) {
+        float* row = table.data()+pp*taps;
+        double frac = (double)pp/RESAMPLE_PHASES;
+        double total = 0;
+        for(Uint32 kk = 0; kk < taps; kk++) {
+            double value = resample_filter((double)kk-half+1-frac,cutoff,half);
+            row[kk] = (float)value;
+            total += value;
+        }
+        // Normalize so that DC passes through with unit gain
+        for(Uint32 kk = 0; kk < taps; kk++) {
+            row[kk] = (float)(row[kk]/total);
+        }
+    }
+    
+    // Each channel is filtered separately from a zero-padded copy
+    std::vector<float> padded(inframes+2*taps);
+    const float* input = source->getData();
+    float* output = result->getData();
+    for(Uint32 ch = 0; ch < chans; ch++) {
+        std::fill(padded.begin(),padded.end(),0.0f);
+        for(Uint64 ii = 0; ii < inframes; ii++) {
+            padded[ii+taps] = input[ii*chans+ch];
+        }
+        
+        for(Uint64 jj = 0; jj < outframes; jj++) {
+            Uint64 numer = jj*inrate;
+            Uint64 index = numer/rate;
+            float phase  = (float)(numer % rate)*RESAMPLE_PHASES/rate;
+            Uint32 pp = (Uint32)phase;
+            float  tt = phase-pp;
+            
+            const float* window = padded.data()+index+taps-half+1;
+            float a = dot_f32(window,table.data()+pp*taps,taps);
+            float b = dot_f32(window,table.data()+(pp+1)*taps,taps);
+            output[jj*chans+ch] = a+(b-a)*tt;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,259 @@
+//
+//  CUSampleCache.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a cache of decoded sound assets.  Sounds are keyed by
+//  the contents of their file (and the output sample rate), so the same file
+//  loaded under two different keys shares a single PCM buffer.  Sounds that
+//  do not match the output sample rate are resampled exactly once, when they
+//  are loaded, so the mixer never has to convert a sound when it plays it.
+//
+//  All of the methods of the cache are thread safe, as sounds are normally
+//  loaded on a worker thread of the asset manager.
+//
+//  This file is an internal header.  It is not accessible by general users
+//  of the CUGL API.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_SAMPLE_CACHE_H__
+#define __CU_SAMPLE_CACHE_H__
+#include <cugl/base/CUBase.h>
+#include "CUSoundMixer.h"
+#include <unordered_map>
+#include <string>
+#include <mutex>
+
+/** The number of input samples on each side of the resampling filter */
+#define RESAMPLE_HALF_TAPS  16
+/** The number of fractional positions in the resampling filter table */
+#define RESAMPLE_PHASES     256
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Sample Cache
+/**
+ * A content-keyed cache of decoded sound assets.
+ *
+ * Each entry in the cache is a PCM buffer in the output sample rate.  The
+ * key of an entry is a hash of the (compressed) file contents and the output
+ * rate.  Hence two sound assets loaded from the same file, or from identical
+ * files with different names, share the same decoded samples.
+ *
+ * Entries are reference counted by the sound assets that use them.  Every
+ * successful call to {@link acquire} or {@link insert} must be balanced by
+ * a call to {@link release}.  An entry is removed from the cache when its
+ * last sound is released.  The mixer keeps its own reference to any buffer
+ * it is playing, so it is safe to release a sound at any time.
+ *
+ * This class also provides the resampler used to convert sounds to the
+ * output rate.  It is a windowed sinc filter, and so is much higher quality
+ * than the linear interpolation used by SDL_mixer.
+ */
+class SampleCache {
+private:
+    /** This macro disables the copy constructor (not allowed on caches) */
+    CU_DISALLOW_COPY_AND_ASSIGN(SampleCache);
+
+    /**
+     * A single decoded sound in the cache
+     */
+    struct Entry {
+        /** The decoded samples */
+        std::shared_ptr<PCMBuffer> buffer;
+        /** The number of sound assets using this entry */
+        Uint32 refs;
+    };
+
+    /** The cache entries, keyed by content */
+    std::unordered_map<Uint64,Entry> _entries;
+    /** The mutex protecting the cache entries */
+    mutable std::mutex _mutex;
+    /** The output sample rate */
+    Uint32 _rate;
+    /** The total size of all of the cached samples in bytes */
+    size_t _bytes;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized sample cache.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    SampleCache() : _rate(0), _bytes(0) {}
+
+    /**
+     * Deletes this sample cache, releasing all resources.
+     */
+    ~SampleCache() { dispose(); }
+
+    /**
+     * Disposes this sample cache, releasing all resources.
+     *
+     * Any buffers still in use by sounds (or the mixer) remain valid, but
+     * they are no longer shared with new sounds.
+     */
+    void dispose();
+
+    /**
+     * Initializes an empty sample cache for the given output rate.
+     *
+     * @param rate  The output sample rate in HZ
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 rate);
+
+    /**
+     * Returns a newly allocated sample cache for the given output rate.
+     *
+     * @param rate  The output sample rate in HZ
+     *
+     * @return a newly allocated sample cache for the given output rate.
+     */
+    static std::shared_ptr<SampleCache> alloc(Uint32 rate) {
+        std::shared_ptr<SampleCache> result = std::make_shared<SampleCache>();
+        return (result->init(rate) ? result : nullptr);
+    }
+
+#pragma mark Cache Access
+    /**
+     * Returns the cache key for the given file contents.
+     *
+     * The key is a 64-bit FNV-1a hash of the contents and the output rate.
+     *
+     * @param data  The (compressed) file contents
+     *
+     * @return the cache key for the given file contents.
+     */
+    Uint64 getKey(const std::string& data) const;
+
+    /**
+     * Returns the decoded samples for the given key (or nullptr)
+     *
+     * If the key is in the cache, this method adds a reference to the entry.
+     * That reference must be removed with {@link release}.
+     *
+     * @param key   The cache key
+     *
+     * @return the decoded samples for the given key (or nullptr)
+     */
+    std::shared_ptr<PCMBuffer> acquire(Uint64 key);
+
+    /**
+     * Adds the decoded samples to the cache, returning the cached buffer.
+     *
+     * The buffer should already be at the output rate.  If another thread
+     * inserted the same key first, this method returns the existing buffer
+     * and the given one should be discarded.  In either case, this method
+     * adds a reference to the entry, which must be removed with
+     * {@link release}.
+     *
+     * @param key       The cache key
+     * @param buffer    The decoded samples
+     *
+     * @return the cached buffer for the given key.
+     */
+    std::shared_ptr<PCMBuffer> insert(Uint64 key, const std::shared_ptr<PCMBuffer>& buffer);
+
+    /**
+     * Removes a reference to the entry for the given key.
+     *
+     * The entry is removed from the cache when it has no more references.
+     *
+     * @param key   The cache key
+     */
+    void release(Uint64 key);
+
+#pragma mark Statistics
+    /**
+     * Returns the number of sound assets using the entry for the given key.
+     *
+     * @param key   The cache key
+     *
+     * @return the number of sound assets using the entry for the given key.
+     */
+    Uint32 getShareCount(Uint64 key) const;
+
+    /**
+     * Returns the number of distinct entries in this cache.
+     *
+     * @return the number of distinct entries in this cache.
+     */
+    size_t getSize() const;
+
+    /**
+     * Returns the total size of the cached samples in bytes.
+     *
+     * Shared entries are only counted once.
+     *
+     * @return the total size of the cached samples in bytes.
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Returns the output sample rate of this cache.
+     *
+     * @return the output sample rate of this cache.
+     */
+    Uint32 getRate() const { return _rate; }
+
+#pragma mark Resampling
+    /**
+     * Returns a copy of the buffer resampled to the given rate.
+     *
+     * The filter is a Blackman-windowed sinc with {@link RESAMPLE_HALF_TAPS}
+     * zero crossings on either side, interpolated from a table of
+     * {@link RESAMPLE_PHASES} fractional positions.  When the rate is lowered,
+     * the cutoff is lowered with it to prevent aliasing.  The channel count
+     * is unchanged.  If the buffer is already at the given rate, it is
+     * returned as is.
+     *
+     * This method is expensive, and is intended to be called once per sound
+     * when the sound is loaded.
+     *
+     * @param source    The buffer to resample
+     * @param rate      The new sample rate in HZ
+     *
+     * @return a copy of the buffer resampled to the given rate.
+     */
+    static std::shared_ptr<PCMBuffer> resample(const std::shared_ptr<PCMBuffer>& source, Uint32 rate);
+};
+
+}
+
+#endif /* __CU_SAMPLE_CACHE_H__ */
@@ -53,6 +53,9 @@
 
 using namespace cugl;
 
+/** The default stream threshold (4 MB) */
+Uint64 Sound::_threshold = 4*1024*1024;
+
 /**
  * Deletes the sound resources and resets all attributes.
  *
@@ -81,7 +84,7 @@ bool Sound::init(const std::string& source) {
     CUAssertLog(AudioEngine::get(), "AudioEngine must be initialized before loading sound assets");
 
     _source = source;
-    _buffer = cugl::impl::AudioLoadBuffer(source.c_str());
+    _buffer = cugl::impl::AudioLoadBuffer(source.c_str(),_threshold);
     return (bool)_buffer;
 }
 
@@ -130,6 +133,48 @@ Uint32 Sound::getChannels() const {
     return (_buffer ? cugl::impl::AudioGetBufferChannels(_buffer) : 0);
 }
 
+/**
+ * Returns true if this sound asset is streamed.
+ *
+ * A streamed sound is kept compressed in memory, and is decoded on a
+ * background thread during playback.  Streamed sounds use much less
+ * memory, at the cost of some CPU time whenever they are played.
+ *
+ * @return true if this sound asset is streamed.
+ */
+bool Sound::isStreaming() const {
+    return (_buffer ? cugl::impl::AudioIsBufferStreaming(_buffer) : false);
+}
+
+/**
+ * Returns the memory used by this sound asset in bytes.
+ *
+ * For a sound in memory, this is the size of the decoded samples.  For
+ * a streamed sound, this is the size of the compressed file.  The decoded
+ * samples may be shared with other sound assets loaded from identical
+ * files (see {@link getShareCount}), in which case the memory is only
+ * used once for all of them.
+ *
+ * @return the memory used by this sound asset in bytes.
+ */
+size_t Sound::getMemoryUsage() const {
+    return (_buffer ? cugl::impl::AudioGetBufferMemory(_buffer) : 0);
+}
+
+/**
+ * Returns the number of sound assets sharing the samples of this one.
+ *
+ * Sound assets loaded from files with identical contents share a single
+ * copy of the decoded samples.  This count includes this sound asset, so
+ * a value of 1 means that the samples are not shared.  This is only
+ * supported by the SDL audio backend.
+ *
+ * @return the number of sound assets sharing the samples of this one.
+ */
+Uint32 Sound::getShareCount() const {
+    return (_buffer ? cugl::impl::AudioGetBufferShares(_buffer) : 0);
+}
+
 /**
  * Sets the default volume of this sound asset.
  *
@@ -71,9 +71,11 @@ _channel(-1),
 _player(nullptr),
 _playing(false),
 _paused(false),
+_primaryHandle(0),
 _primaryLoop(false),
 _primaryVolume(0.0f),
 _primaryTime(0),
+_shadowHandle(0),
 _shadowLoop(false),
 _shadowVolume(0.0f),
 _shadowTime(0),
@@ -139,28 +141,28 @@ void SoundChannel::dispose() {
  * become the primary one.  If it already has an asset, it will become the
  * shadow asset.  Otherwise, it will raise an error.
  *
- * The channels keeps track of the key for asset management.  This is
- * used by the {@link AudioEngine} for garbage collection.
+ * The channels keeps track of the effect handle for asset management.
+ * This is used by the {@link AudioEngine} for garbage collection.
  *
- * @param  key      the key for this playback instance
+ * @param  handle   the effect handle for this playback instance
  * @param  asset    the sound asset to play
  * @param  volume   the volume ot play the sound
  * @param  loop     whether to loop the sound indefinitely
  */
-void SoundChannel::attach(const std::string& key, const std::shared_ptr<Sound>& asset, float volume, bool loop) {
+void SoundChannel::attach(EffectHandle handle, const std::shared_ptr<Sound>& asset, float volume, bool loop) {
     CUAssertLog(_primary == nullptr || _shadow == nullptr, "Attaching to an occupied audio channel");
     
     if (_primary == nullptr) {
         _playing = false;
         _paused  = false;
         _primary = asset;
-        _primaryKey = key;
+        _primaryHandle = handle;
         _primaryLoop = loop;
         _primaryVolume = volume;
         _primaryTime = 0;
     } else {
         _shadow = asset;
-        _shadowKey = key;
+        _shadowHandle = handle;
         _shadowLoop = loop;
         _shadowVolume = volume;
         _shadowTime = 0;
@@ -182,13 +184,13 @@ void SoundChannel::advance() {
         _playing = false;
         _paused  = false;
         _primary = _shadow;
-        _primaryKey = _shadowKey;
+        _primaryHandle = _shadowHandle;
         _primaryLoop   = _shadowLoop;
         _primaryVolume = _shadowVolume;
         _primaryTime   = _shadowTime;
         
         _shadow = nullptr;
-        _shadowKey = "";
+        _shadowHandle = 0;
         _shadowLoop = false;
         _shadowVolume = 0.0;
         _shadowTime = 0;
@@ -212,13 +214,13 @@ void SoundChannel::clear() {
     _playing = false;
     _paused  = false;
     _primary = nullptr;
-    _primaryKey = "";
+    _primaryHandle = 0;
     _primaryLoop = false;
     _primaryVolume = 0.0;
     _primaryTime = 0;
     
     _shadow = nullptr;
-    _shadowKey = "";
+    _shadowHandle = 0;
     _shadowLoop = false;
     _shadowVolume = 0.0;
     _shadowTime = 0;
@@ -430,3 +432,44 @@ void SoundChannel::setLoop(bool loop) {
     _primaryLoop = loop;
     impl::AudioSetChannelLoop(_player,loop);
 }
+
+/**
+ * Sets the 2D emitter for this channel.
+ *
+ * The gain and pan of the channel are computed from the emitter position
+ * relative to the listener of the audio engine.  Unlike the other
+ * attributes, the emitter belongs to the channel and not the asset, so
+ * it applies to the shadow asset as well.  It persists until cleared.
+ *
+ * @param  position     the emitter position
+ * @param  velocity     the emitter velocity (for doppler)
+ * @param  reference    the reference distance
+ * @param  maximum      the maximum distance
+ * @param  rolloff      the rolloff factor
+ */
+void SoundChannel::setEmitter(const Vec2& position, const Vec2& velocity,
+                              float reference, float maximum, float rolloff) {
+    impl::AudioSetChannelEmitter(_player,true,position.x,position.y,velocity.x,velocity.y,
+                                 reference,maximum,rolloff);
+}
+
+/**
+ * Removes the 2D emitter from this channel.
+ *
+ * The channel will return to an unattenuated, centered pan.
+ */
+void SoundChannel::clearEmitter() {
+    impl::AudioSetChannelEmitter(_player,false,0,0,0,0,1,1,1);
+}
+
+/**
+ * Routes this channel to the given bus.
+ *
+ * Like the emitter, the bus belongs to the channel and not the asset,
+ * so it applies to the shadow asset as well.
+ *
+ * @param  bus  the bus index
+ */
+void SoundChannel::setBus(Uint32 bus) {
+    impl::AudioSetChannelBus(_player,bus);
+}
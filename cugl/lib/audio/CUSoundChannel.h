@@ -47,6 +47,7 @@
 #ifndef __CU_SOUND_CHANNEL_H__
 #define __CU_SOUND_CHANNEL_H__
 #include <cugl/audio/CUSound.h>
+#include <cugl/audio/CUAudioEngine.h>
 
 namespace cugl {
    
@@ -111,8 +112,8 @@ private:
     
     /** The primary asset currently attached to this player for use */
     std::shared_ptr<Sound> _primary;
-    /** The key associated with the primary asset */
-    std::string _primaryKey;
+    /** The effect handle associated with the primary asset */
+    EffectHandle _primaryHandle;
     /** Whether to loop the primary asset */
     bool  _primaryLoop;
     /** The volume for the primary asset */
@@ -124,8 +125,8 @@ private:
     
     /** A queued asset to play immediately once the current one is detached */
     std::shared_ptr<Sound> _shadow;
-    /** The key associated with the shadow asset */
-    std::string _shadowKey;
+    /** The effect handle associated with the shadow asset */
+    EffectHandle _shadowHandle;
     /** Whether to loop the shadow asset */
     bool  _shadowLoop;
     /** The volume for the shadow asset */
@@ -209,38 +210,15 @@ public:
      * become the primary one.  If it already has an asset, it will become the
      * shadow asset.  Otherwise, it will raise an error.
      *
-     * The channels keeps track of the key for asset management.  This is
-     * used by the {@link AudioEngine} for garbage collection.
+     * The channels keeps track of the effect handle for asset management.
+     * This is used by the {@link AudioEngine} for garbage collection.
      *
-     * @param  key      the key for this playback instance
+     * @param  handle   the effect handle for this playback instance
      * @param  asset    the sound asset to play
      * @param  volume   the volume ot play the sound
      * @param  loop     whether to loop the sound indefinitely
      */
-    void attach(const std::string& key, const std::shared_ptr<Sound>& asset, float volume=1.0, bool loop=false);
-    
-    /**
-     * Attaches an asset and readies it with the given volume and loop setting.
-     *
-     * A channel may have at most two assets attached: the primary and the
-     * shadow asset.  The primary asset may be played immediately.  The shadow
-     * asset cannot be played until the {@link advance} method is called.
-     *
-     * If this channel has no attached assets, then the attached asset will
-     * become the primary one.  If it already has an asset, it will become the
-     * shadow asset.  Otherwise, it will raise an error.
-     *
-     * The channels keeps track of the key for asset management.  This is
-     * used by the {@link AudioEngine} for garbage collection.
-     *
-     * @param  key      the key for this playback instance
-     * @param  asset    the sound asset to play
-     * @param  volume   the volume ot play the sound
-     * @param  loop     whether to loop the sound indefinitely
-     */
-    void attach(const char* key, const std::shared_ptr<Sound>& asset, float volume=1.0, bool loop=false) {
-        attach(std::string(key),asset,volume,loop);
-    }
+    void attach(EffectHandle handle, const std::shared_ptr<Sound>& asset, float volume=1.0, bool loop=false);
     
     /**
      * Swaps in the shadow asset, provided that there is one.
@@ -270,11 +248,11 @@ public:
     }
     
     /**
-     * Returns the key identifier for the primary asset
+     * Returns the effect handle for the primary asset
      *
-     * @return the key identifier for the primary asset
+     * @return the effect handle for the primary asset
      */
-    const std::string& getPrimaryKey() const { return _primaryKey; }
+    EffectHandle getPrimaryHandle() const { return _primaryHandle; }
     
     /**
      * Returns a reference to the primary asset
@@ -291,11 +269,11 @@ public:
     std::shared_ptr<Sound> getPrimary() { return _primary; }
     
     /**
-     * Returns the key identifier for the shadow asset
+     * Returns the effect handle for the shadow asset
      *
-     * @return the key identifier for the shadow asset
+     * @return the effect handle for the shadow asset
      */
-    const std::string& getShadowKey() const { return _shadowKey; }
+    EffectHandle getShadowHandle() const { return _shadowHandle; }
     
     /**
      * Returns a reference to the shadow asset
@@ -476,6 +454,40 @@ public:
      */
     void setLoop(bool loop);
     
+    /**
+     * Sets the 2D emitter for this channel.
+     *
+     * The gain and pan of the channel are computed from the emitter position
+     * relative to the listener of the audio engine.  Unlike the other
+     * attributes, the emitter belongs to the channel and not the asset, so
+     * it applies to the shadow asset as well.  It persists until cleared.
+     *
+     * @param  position     the emitter position
+     * @param  velocity     the emitter velocity (for doppler)
+     * @param  reference    the reference distance
+     * @param  maximum      the maximum distance
+     * @param  rolloff      the rolloff factor
+     */
+    void setEmitter(const Vec2& position, const Vec2& velocity,
+                    float reference, float maximum, float rolloff);
+    
+    /**
+     * Removes the 2D emitter from this channel.
+     *
+     * The channel will return to an unattenuated, centered pan.
+     */
+    void clearEmitter();
+    
+    /**
+     * Routes this channel to the given bus.
+     *
+     * Like the emitter, the bus belongs to the channel and not the asset,
+     * so it applies to the shadow asset as well.
+     *
+     * @param  bus  the bus index
+     */
+    void setBus(Uint32 bus);
+    
     /** Allow the AudioEngine access to the player */
     friend class AudioEngine;
 };
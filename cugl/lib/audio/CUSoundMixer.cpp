@@ -0,0 +1,1856 @@
+//
+//  CUSoundMixer.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a software mixer for sound effects.  The mixer owns a
+//  fixed number of voices, each of which plays an in-memory PCM buffer or a
+//  decoded stream.  The mixer is designed to be run inside of an audio callback, and so it never
+//  blocks or allocates memory once initialized.  All playback commands are
+//  sent from the main thread through a lock-free ring buffer, and all
+//  completion notices come back through a second ring buffer.
+//
+//  The inner loops use SSE on x86 and NEON on ARM, with a scalar fallback
+//  for everything else.  This includes the positional audio, which computes
+//  the gains of every emitter in a single vectorized pass per block.
+//
+//  Voices are mixed into the buffers of their buses.  The buses are then
+//  processed from the leaves of the bus tree up to the master bus, which
+//  produces the final block.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include "CUSoundMixer.h"
+#include "CUSoundStream.h"
+#include "CUAudioSIMD.h"
+#include <cugl/util/CUDebug.h>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+
+using namespace cugl;
+using namespace cugl::simd;
+
+/** The rows of the emitter data (each row has one value per voice) */
+#define EMIT_X          0
+#define EMIT_Y          1
+#define EMIT_VX         2
+#define EMIT_VY         3
+#define EMIT_REFERENCE  4
+#define EMIT_MAXIMUM    5
+#define EMIT_ROLLOFF    6
+#define EMIT_MASK       7
+#define EMIT_LEFT       8
+#define EMIT_RIGHT      9
+#define EMIT_PITCH      10
+#define EMIT_ROWS       11
+
+/** The doppler pitch limits (one octave) */
+#define DOPPLER_MIN     0.5f
+#define DOPPLER_MAX     2.0f
+/** A small distance to prevent division by zero */
+#define SPATIAL_EPSILON 1e-6f
+/** The input bus value when the output is not routed through a bus */
+#define MIXER_NO_INPUT  0xffffffff
+/** The most notices a single command can send for sounds it did not start */
+#define NOTICE_SLACK    8
+
+
+#pragma mark -
+#pragma mark Helpers
+/**
+ * Returns the retention key for a play instance
+ *
+ * @param voice The voice index
+ * @param stamp The play instance
+ *
+ * @return the retention key for a play instance
+ */
+static Uint64 retain_key(Uint32 voice, Uint32 stamp) {
+    return (((Uint64)voice) << 32) | stamp;
+}
+
+
+#pragma mark -
+#pragma mark PCM Buffer
+/**
+ * Releases the sample data of this buffer.
+ */
+void PCMBuffer::dispose() {
+    if (_raw != nullptr) {
+        free(_raw);
+        _raw = nullptr;
+    }
+    _data = nullptr;
+    _channels = 0;
+    _frames = 0;
+    _rate = 0;
+}
+
+/**
+ * Initializes a silent buffer of the given size.
+ *
+ * @param channels  The number of channels (1 or 2)
+ * @param frames    The number of audio frames
+ * @param rate      The sample rate in HZ
+ *
+ * @return true if initialization was successful.
+ */
+bool PCMBuffer::init(Uint32 channels, Uint64 frames, Uint32 rate) {
+    if (_raw != nullptr) {
+        CUAssertLog(false, "PCM buffer is already initialized");
+        return false;
+    } else if (channels < 1 || channels > 2) {
+        CUAssertLog(false, "PCM buffers must be mono or stereo");
+        return false;
+    }
+    size_t size = (size_t)(frames*channels*sizeof(float));
+    _raw = malloc(size+15);
+    if (_raw == nullptr) {
+        return false;
+    }
+    _data = align16(_raw);
+    std::memset(_data,0,size);
+    _channels = channels;
+    _frames = frames;
+    _rate = rate;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a degenerate mixer with no voices.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+SoundMixer::SoundMixer() :
+_capacity(0),
+_rate(0),
+_mixraw(nullptr),
+_mixbuffer(nullptr),
+_spatraw(nullptr),
+_spatial(nullptr),
+_stride(0),
+_emitters(0),
+_model(AudioEngine::DistanceModel::INVERSE),
+_doppler(0),
+_speed(343.3f),
+_buscount(0),
+_input(MIXER_NO_INPUT),
+_inraw(nullptr),
+_inbuffer(nullptr),
+_clock(0),
+_counter(0),
+_current(true) {
+    std::memset(_listener,0,sizeof(_listener));
+}
+
+/**
+ * Disposes this mixer, releasing all resources.
+ *
+ * The mixer must not be in use by the audio thread when this is called.
+ */
+void SoundMixer::dispose() {
+    _voices.clear();
+    _tails.clear();
+    _commands.dispose();
+    _notices.dispose();
+    _positions.reset();
+    _acks.reset();
+    _stamps.clear();
+    _cues.clear();
+    _serials.clear();
+    _pending.clear();
+    _playing.clear();
+    _paused.clear();
+    _retained.clear();
+    _streams.clear();
+    if (_mixraw != nullptr) {
+        free(_mixraw);
+        _mixraw = nullptr;
+    }
+    _mixbuffer = nullptr;
+    if (_spatraw != nullptr) {
+        free(_spatraw);
+        _spatraw = nullptr;
+    }
+    _spatial  = nullptr;
+    _stride   = 0;
+    _emitters = 0;
+    if (_inraw != nullptr) {
+        free(_inraw);
+        _inraw = nullptr;
+    }
+    _inbuffer = nullptr;
+    _input.store(MIXER_NO_INPUT);
+    for(Uint32 ii = 0; ii < _buscount.load(); ii++) {
+        _buses[ii]->dispose();
+    }
+    _buses.clear();
+    _buscount.store(0);
+    _clock.store(0);
+    _counter  = 0;
+    _capacity = 0;
+    _rate = 0;
+}
+
+/**
+ * Initializes a mixer with the given number of voices.
+ *
+ * @param voices    The number of simultaneous voices
+ * @param rate      The output sample rate
+ *
+ * @return true if initialization was successful.
+ */
+bool SoundMixer::init(Uint32 voices, Uint32 rate) {
+    if (_capacity > 0) {
+        CUAssertLog(false, "Sound mixer is already initialized");
+        return false;
+    } else if (voices == 0) {
+        CUAssertLog(false, "Sound mixer must have at least one voice");
+        return false;
+    }
+
+    _mixraw = malloc(MIXER_BLOCK_FRAMES*MIXER_CHANNELS*sizeof(float)+15);
+    if (_mixraw == nullptr) {
+        return false;
+    }
+    _mixbuffer = align16(_mixraw);
+
+    // Emitter rows are padded to a multiple of 4 so every row is aligned
+    _stride = (voices+3) & ~3u;
+    _spatraw = malloc(_stride*EMIT_ROWS*sizeof(float)+15);
+    if (_spatraw == nullptr) {
+        free(_mixraw);
+        _mixraw = nullptr;
+        _mixbuffer = nullptr;
+        return false;
+    }
+    _spatial = align16(_spatraw);
+    std::memset(_spatial,0,_stride*EMIT_ROWS*sizeof(float));
+    _inraw = malloc(MIXER_BLOCK_FRAMES*MIXER_CHANNELS*sizeof(float)+15);
+    if (_inraw == nullptr) {
+        dispose();
+        return false;
+    }
+    _inbuffer = align16(_inraw);
+    for(Uint32 ii = 0; ii < _stride; ii++) {
+        _spatial[EMIT_REFERENCE*_stride+ii] = 1.0f;
+        _spatial[EMIT_MAXIMUM*_stride+ii] = FLT_MAX;
+        _spatial[EMIT_ROLLOFF*_stride+ii] = 1.0f;
+        _spatial[EMIT_LEFT*_stride+ii]  = 1.0f;
+        _spatial[EMIT_RIGHT*_stride+ii] = 1.0f;
+        _spatial[EMIT_PITCH*_stride+ii] = 1.0f;
+    }
+    _emitters = 0;
+
+    // The standard buses (allocated up front so adding one never reallocates)
+    const char* names[] = { "master", "music", "sound", "voice" };
+    _buses.resize(MIXER_MAX_BUSES);
+    for(Uint32 ii = AudioBus::MASTER; ii <= AudioBus::VOICE; ii++) {
+        auto bus = AudioBus::alloc(names[ii],ii,AudioBus::MASTER,MIXER_BLOCK_FRAMES);
+        if (bus == nullptr) {
+            dispose();
+            return false;
+        }
+        _buses[ii] = bus;
+        _buscount.store(ii+1);
+    }
+
+    _capacity = voices;
+    _rate = rate;
+    _voices.resize(voices);
+    _tails.resize(voices);
+    for(Uint32 ii = 0; ii < voices; ii++) {
+        _voices[ii].bus = AudioBus::SOUND;
+    }
+    _commands.init(voices*16 < 256 ? 256 : voices*16);
+    _notices.init(voices*16 < 256 ? 256 : voices*16);
+
+    _positions.reset(new std::atomic<Uint64>[voices]);
+    _acks.reset(new std::atomic<Uint32>[voices]);
+    for(Uint32 ii = 0; ii < voices; ii++) {
+        _positions[ii].store(0);
+        _acks[ii].store(0);
+    }
+
+    _stamps.resize(voices,0);
+    _cues.resize(voices,0);
+    _serials.resize(voices,0);
+    _pending.resize(voices,0);
+    _playing.resize(voices,false);
+    _paused.resize(voices,false);
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Playback (Main Thread)
+/**
+ * Plays a buffer on the given voice.
+ *
+ * If the voice is already playing, the previous sound is stopped and a
+ * (manual) completion notice is sent for it, just as if {@link stop} had
+ * been called first.
+ *
+ * If time is non-zero, the sound is silent until the sample clock reaches
+ * that time (see {@link getTime}), and starts on that exact frame.  If the
+ * time has already passed, the sound starts as soon as possible.  If fade
+ * is non-zero, the sound fades in over that many frames.
+ *
+ * @param voice     The voice to play on
+ * @param buffer    The buffer to play
+ * @param volume    The volume (0 to 1)
+ * @param loop      Whether to loop the buffer
+ * @param frame     The frame to start playback
+ * @param time      The clock time to start playback (0 for immediately)
+ * @param fade      The number of frames to fade in
+ */
+void SoundMixer::play(Uint32 voice, const std::shared_ptr<PCMBuffer>& buffer, float volume, bool loop,
+                      Uint64 frame, Uint64 time, Uint32 fade) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    CUAssertLog(buffer != nullptr, "Attempt to play a null buffer");
+    Uint32 stamp  = ++_counter;
+    Uint32 serial = ++_serials[voice];
+    _stamps[voice]  = stamp;
+    _cues[voice]    = 0;
+    _pending[voice] = frame;
+    _playing[voice] = true;
+    _paused[voice]  = false;
+    _retained[retain_key(voice,stamp)] = buffer;
+
+    Command command;
+    command.type = Type::PLAY;
+    command.voice = voice;
+    command.stamp = stamp;
+    command.serial = serial;
+    command.buffer = buffer.get();
+    command.stream = nullptr;
+    command.value = volume;
+    command.frame = frame;
+    command.time  = time;
+    command.fade  = fade;
+    command.flag  = loop;
+    send(command);
+}
+
+/**
+ * Plays a stream on the given voice.
+ *
+ * The stream should already be primed at the given frame (and registered
+ * with a {@link StreamService}), so that playback can start immediately.
+ * A stream may only be played on one voice at a time.
+ *
+ * If the voice is already playing, the previous sound is stopped and a
+ * (manual) completion notice is sent for it, just as if {@link stop} had
+ * been called first.
+ *
+ * If time is non-zero, the sound is silent until the sample clock reaches
+ * that time (see {@link getTime}), and starts on that exact frame.  If the
+ * time has already passed, the sound starts as soon as possible.  If fade
+ * is non-zero, the sound fades in over that many frames.
+ *
+ * @param voice     The voice to play on
+ * @param stream    The stream to play
+ * @param volume    The volume (0 to 1)
+ * @param loop      Whether to loop the stream
+ * @param frame     The frame to start playback
+ * @param time      The clock time to start playback (0 for immediately)
+ * @param fade      The number of frames to fade in
+ */
+void SoundMixer::play(Uint32 voice, const std::shared_ptr<SoundStream>& stream, float volume, bool loop,
+                      Uint64 frame, Uint64 time, Uint32 fade) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    CUAssertLog(stream != nullptr, "Attempt to play a null stream");
+    Uint32 stamp  = ++_counter;
+    Uint32 serial = ++_serials[voice];
+    _stamps[voice]  = stamp;
+    _cues[voice]    = 0;
+    _pending[voice] = frame;
+    _playing[voice] = true;
+    _paused[voice]  = false;
+    _streams[retain_key(voice,stamp)] = stream;
+
+    Command command;
+    command.type = Type::PLAY;
+    command.voice = voice;
+    command.stamp = stamp;
+    command.serial = serial;
+    command.buffer = nullptr;
+    command.stream = stream.get();
+    command.value = volume;
+    command.frame = frame;
+    command.time  = time;
+    command.fade  = fade;
+    command.flag  = loop;
+    send(command);
+}
+
+/**
+ * Cues a buffer to follow the current sound on the given voice.
+ *
+ * When the current sound reaches its end, the cued buffer starts on the
+ * very next frame, from the beginning.  If fade is non-zero, the cued
+ * buffer instead starts that many frames before the end, and the two
+ * sounds are crossfaded.  A looping sound never reaches its end, so the
+ * cue waits until looping is turned off.
+ *
+ * The current sound sends a normal completion notice when the cued sound
+ * takes over.  Only one sound may be cued at a time, so this replaces
+ * any previous cue.  If the voice is not playing, this is the same as
+ * {@link play}.
+ *
+ * @param voice     The voice to cue
+ * @param buffer    The buffer to cue
+ * @param volume    The volume (0 to 1)
+ * @param loop      Whether to loop the buffer
+ * @param fade      The number of frames to crossfade
+ */
+void SoundMixer::cue(Uint32 voice, const std::shared_ptr<PCMBuffer>& buffer, float volume, bool loop, Uint32 fade) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    CUAssertLog(buffer != nullptr, "Attempt to cue a null buffer");
+    if (!_playing[voice]) {
+        play(voice,buffer,volume,loop,0,0,fade);
+        return;
+    }
+    Uint32 stamp = ++_counter;
+    _cues[voice] = stamp;
+    _retained[retain_key(voice,stamp)] = buffer;
+
+    Command command;
+    command.type = Type::CUE;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    command.cue   = stamp;
+    command.buffer = buffer.get();
+    command.stream = nullptr;
+    command.value = volume;
+    command.fade  = fade;
+    command.flag  = loop;
+    send(command);
+}
+
+/**
+ * Cues a stream to follow the current sound on the given voice.
+ *
+ * When the current sound reaches its end, the cued stream starts on the
+ * very next frame.  The stream should already be primed at frame 0 (and
+ * registered with a {@link StreamService}).  If fade is non-zero, the
+ * cued stream instead starts that many frames before the end, and the two
+ * sounds are crossfaded.  A looping sound never reaches its end, so the
+ * cue waits until looping is turned off.
+ *
+ * The current sound sends a normal completion notice when the cued sound
+ * takes over.  Only one sound may be cued at a time, so this replaces
+ * any previous cue.  If the voice is not playing, this is the same as
+ * {@link play}.
+ *
+ * @param voice     The voice to cue
+ * @param stream    The stream to cue
+ * @param volume    The volume (0 to 1)
+ * @param loop      Whether to loop the stream
+ * @param fade      The number of frames to crossfade
+ */
+void SoundMixer::cue(Uint32 voice, const std::shared_ptr<SoundStream>& stream, float volume, bool loop, Uint32 fade) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    CUAssertLog(stream != nullptr, "Attempt to cue a null stream");
+    if (!_playing[voice]) {
+        play(voice,stream,volume,loop,0,0,fade);
+        return;
+    }
+    Uint32 stamp = ++_counter;
+    _cues[voice] = stamp;
+    _streams[retain_key(voice,stamp)] = stream;
+
+    Command command;
+    command.type = Type::CUE;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    command.cue   = stamp;
+    command.buffer = nullptr;
+    command.stream = stream.get();
+    command.value = volume;
+    command.fade  = fade;
+    command.flag  = loop;
+    send(command);
+}
+
+/**
+ * Removes the cued sound (if any) from the given voice.
+ *
+ * If the cued sound has already taken over by the time the audio thread
+ * sees this command, it is stopped instead.
+ *
+ * @param voice     The voice to adjust
+ */
+void SoundMixer::uncue(Uint32 voice) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    if (_cues[voice] == 0) {
+        return;
+    }
+    Command command;
+    command.type = Type::UNCUE;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    command.cue   = _cues[voice];
+    send(command);
+    _cues[voice] = 0;
+}
+
+/**
+ * Stops the given voice.
+ *
+ * The voice will fade out over a short ramp.  A completion notice will
+ * be sent when the voice stops.
+ *
+ * @param voice     The voice to stop
+ */
+void SoundMixer::stop(Uint32 voice) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    if (!_playing[voice]) {
+        return;
+    }
+    Command command;
+    command.type = Type::STOP;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    send(command);
+}
+
+/**
+ * Stops the given voice after the given number of frames.
+ *
+ * @param voice     The voice to stop
+ * @param frames    The number of frames until the voice stops
+ */
+void SoundMixer::expire(Uint32 voice, Uint64 frames) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    if (!_playing[voice]) {
+        return;
+    }
+    Command command;
+    command.type = Type::EXPIRE;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    command.frame = frames;
+    send(command);
+}
+
+/**
+ * Fades out the given voice over the given number of frames.
+ *
+ * The voice stops when the fade completes, and sends a (manual)
+ * completion notice.  Any cued sound is discarded.
+ *
+ * @param voice     The voice to fade out
+ * @param frames    The number of frames to fade
+ */
+void SoundMixer::fadeOut(Uint32 voice, Uint32 frames) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    if (!_playing[voice]) {
+        return;
+    }
+    Command command;
+    command.type = Type::FADE;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    command.fade  = frames;
+    send(command);
+    _cues[voice] = 0;
+}
+
+/**
+ * Pauses the given voice.
+ *
+ * @param voice     The voice to pause
+ */
+void SoundMixer::pause(Uint32 voice) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    if (!_playing[voice] || _paused[voice]) {
+        return;
+    }
+    _paused[voice] = true;
+    Command command;
+    command.type = Type::PAUSE;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    send(command);
+}
+
+/**
+ * Resumes the given voice.
+ *
+ * @param voice     The voice to resume
+ */
+void SoundMixer::resume(Uint32 voice) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    if (!_playing[voice] || !_paused[voice]) {
+        return;
+    }
+    _paused[voice] = false;
+    Command command;
+    command.type = Type::RESUME;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    send(command);
+}
+
+/**
+ * Sets the volume of the given voice.
+ *
+ * The volume change is applied with a short ramp.
+ *
+ * @param voice     The voice to adjust
+ * @param volume    The volume (0 to 1)
+ */
+void SoundMixer::setVolume(Uint32 voice, float volume) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    Command command;
+    command.type = Type::VOLUME;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    command.value = volume;
+    send(command);
+}
+
+/**
+ * Sets whether the given voice loops.
+ *
+ * @param voice     The voice to adjust
+ * @param loop      Whether the voice loops
+ */
+void SoundMixer::setLoop(Uint32 voice, bool loop) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    Command command;
+    command.type = Type::LOOP;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    command.flag  = loop;
+    send(command);
+}
+
+/**
+ * Sets the frame position of the given voice.
+ *
+ * If the voice is audible, the old and new positions are crossfaded.
+ *
+ * @param voice     The voice to adjust
+ * @param frame     The new frame position
+ */
+void SoundMixer::setFrame(Uint32 voice, Uint64 frame) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    _pending[voice] = frame;
+    Command command;
+    command.type = Type::SEEK;
+    command.voice = voice;
+    command.stamp = _stamps[voice];
+    command.serial = ++_serials[voice];
+    command.frame = frame;
+    send(command);
+}
+
+/**
+ * Returns the frame position of the given voice.
+ *
+ * @param voice     The voice to query
+ *
+ * @return the frame position of the given voice.
+ */
+Uint64 SoundMixer::getFrame(Uint32 voice) const {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    if (_acks[voice].load(std::memory_order_acquire) != _serials[voice]) {
+        return _pending[voice];
+    }
+    return _positions[voice].load(std::memory_order_relaxed);
+}
+
+
+
+#pragma mark -
+#pragma mark Positional Audio (Main Thread)
+/**
+ * Attaches a 2D emitter to the given voice.
+ *
+ * The gain and pan of the voice will be computed from the position of
+ * the emitter relative to the listener.  The reference distance is the
+ * distance at which the attenuation is 1, while the maximum distance is
+ * the distance beyond which there is no further attenuation.  The rolloff
+ * scales the rate of attenuation.
+ *
+ * The emitter belongs to the voice, and so it applies to all sounds that
+ * are played on the voice until it is cleared.
+ *
+ * @param voice     The voice to adjust
+ * @param position  The emitter position
+ * @param velocity  The emitter velocity (for doppler)
+ * @param reference The reference distance
+ * @param maximum   The maximum distance
+ * @param rolloff   The rolloff factor
+ */
+void SoundMixer::setEmitter(Uint32 voice, const Vec2& position, const Vec2& velocity,
+                            float reference, float maximum, float rolloff) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    reference = reference > SPATIAL_EPSILON ? reference : SPATIAL_EPSILON;
+    Command command;
+    command.type  = Type::EMITTER;
+    command.voice = voice;
+    command.flag  = true;
+    command.params[0] = position.x;
+    command.params[1] = position.y;
+    command.params[2] = velocity.x;
+    command.params[3] = velocity.y;
+    command.params[4] = reference;
+    command.params[5] = maximum > reference ? maximum : reference;
+    command.params[6] = rolloff > 0 ? rolloff : 0;
+    send(command);
+}
+
+/**
+ * Removes the emitter from the given voice.
+ *
+ * The voice will return to an unattenuated, centered pan.
+ *
+ * @param voice     The voice to adjust
+ */
+void SoundMixer::clearEmitter(Uint32 voice) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    Command command;
+    command.type  = Type::EMITTER;
+    command.voice = voice;
+    command.flag  = false;
+    send(command);
+}
+
+/**
+ * Sets the position and velocity of the listener.
+ *
+ * @param position  The listener position
+ * @param velocity  The listener velocity (for doppler)
+ */
+void SoundMixer::setListener(const Vec2& position, const Vec2& velocity) {
+    Command command;
+    command.type  = Type::LISTENER;
+    command.voice = 0;
+    command.params[0] = position.x;
+    command.params[1] = position.y;
+    command.params[2] = velocity.x;
+    command.params[3] = velocity.y;
+    send(command);
+}
+
+/**
+ * Sets the distance attenuation model for all emitters.
+ *
+ * @param model     The distance attenuation model
+ */
+void SoundMixer::setDistanceModel(AudioEngine::DistanceModel model) {
+    Command command;
+    command.type  = Type::MODEL;
+    command.voice = 0;
+    command.frame = (Uint64)model;
+    send(command);
+}
+
+/**
+ * Sets the doppler parameters for all emitters.
+ *
+ * A factor of 0 disables doppler.  The speed of sound should be in the
+ * same units as the emitter velocities.
+ *
+ * @param factor    The doppler factor
+ * @param speed     The speed of sound
+ */
+void SoundMixer::setDoppler(float factor, float speed) {
+    Command command;
+    command.type  = Type::DOPPLER;
+    command.voice = 0;
+    command.params[0] = factor > 0 ? factor : 0;
+    command.params[1] = speed > SPATIAL_EPSILON ? speed : SPATIAL_EPSILON;
+    send(command);
+}
+
+
+#pragma mark -
+#pragma mark Bus Graph
+/**
+ * Returns the number of buses in this mixer.
+ *
+ * @return the number of buses in this mixer.
+ */
+Uint32 SoundMixer::getBusCount() const {
+    return _buscount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the bus with the given index.
+ *
+ * The indices of the standard buses are the constants of {@link AudioBus}.
+ * If there is no such bus, this method returns nullptr.
+ *
+ * @param index     The bus index
+ *
+ * @return the bus with the given index.
+ */
+std::shared_ptr<AudioBus> SoundMixer::getBus(Uint32 index) const {
+    return index < getBusCount() ? _buses[index] : nullptr;
+}
+
+/**
+ * Returns the bus with the given name.
+ *
+ * If there is no such bus, this method returns nullptr.
+ *
+ * @param name      The bus name
+ *
+ * @return the bus with the given name.
+ */
+std::shared_ptr<AudioBus> SoundMixer::getBus(const std::string& name) const {
+    Uint32 count = getBusCount();
+    for(Uint32 ii = 0; ii < count; ii++) {
+        if (_buses[ii]->getName() == name) {
+            return _buses[ii];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Returns a newly created bus that mixes into the given parent.
+ *
+ * Buses can never be removed, so this is intended for initialization.
+ * If the parent does not exist, or the mixer already has
+ * {@link MIXER_MAX_BUSES} buses, this method returns nullptr.
+ *
+ * The bus is published to the audio thread by the bus count, so the
+ * audio thread never sees a partially added bus.
+ *
+ * @param name      The bus name
+ * @param parent    The index of the parent bus
+ *
+ * @return a newly created bus that mixes into the given parent.
+ */
+std::shared_ptr<AudioBus> SoundMixer::addBus(const std::string& name, Uint32 parent) {
+    Uint32 count = getBusCount();
+    if (parent >= count) {
+        CUAssertLog(false, "Parent bus %d does not exist", parent);
+        return nullptr;
+    } else if (count >= MIXER_MAX_BUSES) {
+        CUAssertLog(false, "The mixer cannot have more than %d buses", MIXER_MAX_BUSES);
+        return nullptr;
+    }
+    auto bus = AudioBus::alloc(name,count,parent,MIXER_BLOCK_FRAMES);
+    if (bus != nullptr) {
+        _buses[count] = bus;
+        _buscount.store(count+1,std::memory_order_release);
+    }
+    return bus;
+}
+
+/**
+ * Routes the given voice to a bus.
+ *
+ * The bus belongs to the voice, and so it applies to all sounds that
+ * are played on the voice until it is changed.
+ *
+ * @param voice     The voice to adjust
+ * @param bus       The bus index
+ */
+void SoundMixer::setBus(Uint32 voice, Uint32 bus) {
+    CUAssertLog(voice < _capacity, "Voice %d is out of range", voice);
+    if (bus >= getBusCount()) {
+        CUAssertLog(false, "Bus %d does not exist", bus);
+        return;
+    }
+    Command command;
+    command.type  = Type::BUS;
+    command.voice = voice;
+    command.frame = bus;
+    send(command);
+}
+
+/**
+ * Routes the output buffer through the given bus.
+ *
+ * When an input bus is set, the {@link mix} methods no longer add to the
+ * output buffer.  Instead, the existing contents are mixed into the input
+ * bus (as if they were a voice), and the result of the bus graph replaces
+ * the contents of the buffer.
+ *
+ * @param bus       The bus index
+ */
+void SoundMixer::setInput(Uint32 bus) {
+    if (bus >= getBusCount()) {
+        CUAssertLog(false, "Bus %d does not exist", bus);
+        return;
+    }
+    _input.store(bus,std::memory_order_release);
+}
+
+/**
+ * Restores the mixer to adding directly to the output buffer.
+ */
+void SoundMixer::clearInput() {
+    _input.store(MIXER_NO_INPUT,std::memory_order_release);
+}
+
+
+#pragma mark -
+#pragma mark Notices (Main Thread)
+/**
+ * Processes all notices from the audio thread.
+ *
+ * The listener is called once for every sound that has completed since
+ * the last call, in order.  This method also releases any buffers that
+ * the audio thread is no longer using.
+ *
+ * @param listener  The callback for completed sounds
+ */
+void SoundMixer::poll(const Listener& listener) {
+    Notice notice;
+    while (_notices.pop(notice)) {
+        if (notice.release) {
+            _retained.erase(retain_key(notice.voice,notice.stamp));
+            _streams.erase(retain_key(notice.voice,notice.stamp));
+        } else {
+            _current = notice.stamp == _stamps[notice.voice];
+            if (_current) {
+                if (notice.next != 0) {
+                    // The cued sound took over; the voice is still playing
+                    _stamps[notice.voice] = notice.next;
+                    if (_cues[notice.voice] == notice.next) {
+                        _cues[notice.voice] = 0;
+                    }
+                } else {
+                    _playing[notice.voice] = false;
+                    _paused[notice.voice]  = false;
+                    _cues[notice.voice]    = 0;
+                }
+            }
+            if (listener) {
+                listener(notice.voice,notice.normal);
+            }
+        }
+    }
+    _current = true;
+}
+
+
+#pragma mark -
+#pragma mark Mixing (Audio Thread)
+/**
+ * Mixes the given number of frames into the output buffer.
+ *
+ * The output is interleaved stereo floats.  The result is added to the
+ * existing contents of the buffer, so it should be cleared beforehand
+ * if necessary.
+ *
+ * @param output    The output buffer
+ * @param frames    The number of frames to mix
+ */
+void SoundMixer::mix(float* output, Uint32 frames) {
+    mix(output,frames,MIXER_CHANNELS);
+}
+
+/**
+ * Mixes the given number of frames into the output buffer.
+ *
+ * The output is interleaved 16-bit integers with the given number of
+ * channels (1 or 2).  The result is added to the existing contents of
+ * the buffer with saturation.
+ *
+ * @param output    The output buffer
+ * @param frames    The number of frames to mix
+ * @param channels  The number of output channels
+ */
+void SoundMixer::mix(Sint16* output, Uint32 frames, Uint32 channels) {
+    while (frames > 0) {
+        Uint32 block = frames < MIXER_BLOCK_FRAMES ? frames : MIXER_BLOCK_FRAMES;
+        bool routed = capture(output,block,channels,1.0f/MIXER_S16_SCALE);
+        render(block,routed ? _inbuffer : nullptr);
+        if (channels == 2) {
+            add_s16(output,_mixbuffer,block*2);
+        } else {
+            for(Uint32 ii = 0; ii < block; ii++) {
+                _mixbuffer[ii] = 0.5f*(_mixbuffer[2*ii]+_mixbuffer[2*ii+1]);
+            }
+            add_s16(output,_mixbuffer,block);
+        }
+        output += block*channels;
+        frames -= block;
+    }
+}
+
+/**
+ * Mixes the given number of frames into the output buffer.
+ *
+ * The output is interleaved floats with the given number of channels
+ * (1 or 2).  The result is added to the existing contents of the buffer.
+ *
+ * @param output    The output buffer
+ * @param frames    The number of frames to mix
+ * @param channels  The number of output channels
+ */
+void SoundMixer::mix(float* output, Uint32 frames, Uint32 channels) {
+    while (frames > 0) {
+        Uint32 block = frames < MIXER_BLOCK_FRAMES ? frames : MIXER_BLOCK_FRAMES;
+        bool routed = capture(output,block,channels,1.0f);
+        render(block,routed ? _inbuffer : nullptr);
+        if (channels == 2) {
+            add_f32(output,_mixbuffer,block*2);
+        } else {
+            for(Uint32 ii = 0; ii < block; ii++) {
+                output[ii] += 0.5f*(_mixbuffer[2*ii]+_mixbuffer[2*ii+1]);
+            }
+        }
+        output += block*channels;
+        frames -= block;
+    }
+}
+
+/**
+ * Returns true if the output buffer is routed through a bus.
+ *
+ * If so, the given chunk of the output buffer is converted to the
+ * input buffer and then cleared.
+ *
+ * @param output    The output chunk
+ * @param frames    The number of frames in the chunk
+ * @param channels  The number of output channels
+ * @param scale     The factor to convert an output sample to a float
+ *
+ * @return true if the output buffer is routed through a bus.
+ */
+template <typename T>
+bool SoundMixer::capture(T* output, Uint32 frames, Uint32 channels, float scale) {
+    if (_input.load(std::memory_order_acquire) == MIXER_NO_INPUT) {
+        return false;
+    }
+    if (channels == 2) {
+        for(Uint32 ii = 0; ii < 2*frames; ii++) {
+            _inbuffer[ii] = output[ii]*scale;
+        }
+    } else {
+        for(Uint32 ii = 0; ii < frames; ii++) {
+            _inbuffer[2*ii] = _inbuffer[2*ii+1] = output[ii]*scale;
+        }
+    }
+    std::memset(output,0,frames*channels*sizeof(T));
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Sends a command to the audio thread.
+ *
+ * @param command   The command to send
+ */
+void SoundMixer::send(const Command& command) {
+    if (!_commands.push(command)) {
+        CULogError("Sound mixer command queue is full");
+    }
+}
+
+/**
+ * Sends a notice to the main thread (audio thread).
+ *
+ * The notice queue cannot overflow, as {@link process} stops accepting
+ * commands while it cannot hold every notice that may still be owed.
+ *
+ * @param notice    The notice to send
+ */
+void SoundMixer::notify(const Notice& notice) {
+    bool success = _notices.push(notice);
+    CUAssertLog(success, "Sound mixer notice queue is full");
+}
+
+/**
+ * Processes all pending commands (audio thread).
+ *
+ * Every play instance sends at most two notices (a completion and a
+ * release), and there can be at most three instances per voice (playing,
+ * cued, and fading out).  A command is only processed if the notice
+ * queue still has room for all of these, so notices are never lost.  If
+ * the main thread stops polling, commands wait in their queue instead.
+ */
+void SoundMixer::process() {
+    const Uint64 now = _clock.load(std::memory_order_relaxed);
+    const size_t reserve = 6*(size_t)_capacity+NOTICE_SLACK;
+    Command command;
+    while (_notices.size()+reserve <= _notices.capacity() && _commands.pop(command)) {
+        Voice& voice = _voices[command.voice];
+        switch (command.type) {
+            case Type::PLAY:
+                if (voice.active) {
+                    halt(command.voice,false);
+                }
+                voice.buffer = command.buffer;
+                voice.stream = command.stream;
+                voice.position = command.frame < duration(voice) ? command.frame : 0;
+                voice.stamp  = command.stamp;
+                voice.owner  = command.voice;
+                voice.volume = command.value;
+                voice.loop   = command.flag;
+                voice.active = true;
+                voice.paused = false;
+                voice.pausing  = false;
+                voice.stopping = false;
+                voice.expiring = false;
+                voice.seeking  = false;
+                voice.cued   = false;
+                voice.expire = 0;
+                voice.delay  = command.time > now ? command.time-now : 0;
+                voice.prior  = 0;
+                // Only ramp in if we start in the middle of the waveform
+                voice.gain = voice.position == 0 && command.fade == 0 ? voice.volume : 0.0f;
+                voice.step = 0;
+                voice.ramp = 0;
+                // Snap to the emitter pan on the first block
+                voice.left  = -1;
+                voice.right = -1;
+                voice.dleft  = 0;
+                voice.dright = 0;
+                voice.rate  = 1;
+                voice.phase = 0;
+                if (command.fade > 0) {
+                    ramp(voice,voice.volume,command.fade);
+                } else if (voice.position != 0) {
+                    ramp(voice,voice.volume);
+                }
+                _positions[command.voice].store(voice.position,std::memory_order_relaxed);
+                _acks[command.voice].store(command.serial,std::memory_order_release);
+                break;
+            case Type::SEEK:
+                if (voice.active && voice.stamp == command.stamp) {
+                    Uint64 frame = command.frame < duration(voice) ? command.frame : 0;
+                    bool audible = !voice.paused && (voice.gain > 0 || voice.ramp > 0);
+                    if (voice.stream != nullptr && audible) {
+                        // Streams cannot crossfade; seek once we have faded out
+                        voice.seeking = true;
+                        voice.seekto  = frame;
+                        ramp(voice,0);
+                    } else {
+                        if (voice.stream != nullptr) {
+                            voice.stream->seek(frame);
+                        } else if (!voice.paused && voice.gain > 0) {
+                            fade(voice);
+                        }
+                        voice.gain = 0;
+                        voice.seeking  = false;
+                        voice.position = frame;
+                        voice.phase = 0;
+                        if (!voice.paused && !voice.pausing) {
+                            ramp(voice,voice.volume);
+                        }
+                    }
+                }
+                _positions[command.voice].store(command.frame,std::memory_order_relaxed);
+                _acks[command.voice].store(command.serial,std::memory_order_release);
+                break;
+            case Type::EMITTER:
+            {
+                float* mask = _spatial+EMIT_MASK*_stride+command.voice;
+                if (command.flag) {
+                    for(Uint32 ii = 0; ii < EMIT_MASK; ii++) {
+                        _spatial[ii*_stride+command.voice] = command.params[ii];
+                    }
+                    _emitters += (*mask == 0 ? 1 : 0);
+                    *mask = 1.0f;
+                } else {
+                    _emitters -= (*mask != 0 ? 1 : 0);
+                    *mask = 0.0f;
+                    _spatial[EMIT_LEFT*_stride+command.voice]  = 1.0f;
+                    _spatial[EMIT_RIGHT*_stride+command.voice] = 1.0f;
+                    _spatial[EMIT_PITCH*_stride+command.voice] = 1.0f;
+                }
+            }
+                break;
+            case Type::LISTENER:
+                std::memcpy(_listener,command.params,sizeof(_listener));
+                break;
+            case Type::MODEL:
+                _model = (AudioEngine::DistanceModel)command.frame;
+                break;
+            case Type::DOPPLER:
+                _doppler = command.params[0];
+                _speed   = command.params[1];
+                break;
+            case Type::BUS:
+                voice.bus = (Uint32)command.frame;
+                break;
+            case Type::CUE:
+                if (voice.cued) {
+                    drop(voice);
+                }
+                if (voice.active && !voice.stopping &&
+                    (voice.stamp == command.stamp || voice.prior == command.stamp)) {
+                    voice.cued    = true;
+                    voice.cbuffer = command.buffer;
+                    voice.cstream = command.stream;
+                    voice.cstamp  = command.cue;
+                    voice.cvolume = command.value;
+                    voice.cloop   = command.flag;
+                    voice.cfade   = command.fade;
+                } else {
+                    // The sound to follow is already gone
+                    retire(command.voice,command.cue);
+                }
+                break;
+            case Type::UNCUE:
+                if (voice.cued && voice.cstamp == command.cue) {
+                    drop(voice);
+                } else if (voice.active && voice.stamp == command.cue) {
+                    // Too late; the cued sound has already taken over
+                    halt(command.voice,false);
+                }
+                break;
+            default:
+                if (!voice.active || (voice.stamp != command.stamp && voice.prior != command.stamp)) {
+                    break;
+                }
+                switch (command.type) {
+                    case Type::STOP:
+                        halt(command.voice,false);
+                        break;
+                    case Type::FADE:
+                        if (voice.cued) {
+                            drop(voice);
+                        }
+                        if (voice.paused) {
+                            halt(command.voice,false);
+                        } else {
+                            voice.stopping = true;
+                            voice.pausing  = false;
+                            voice.seeking  = false;
+                            ramp(voice,0,command.fade > 0 ? command.fade : MIXER_RAMP_FRAMES);
+                        }
+                        break;
+                    case Type::EXPIRE:
+                        voice.expiring = true;
+                        voice.expire = command.frame;
+                        break;
+                    case Type::PAUSE:
+                        if (!voice.paused) {
+                            voice.pausing = true;
+                            ramp(voice,0);
+                        }
+                        break;
+                    case Type::RESUME:
+                        if (voice.stopping) {
+                            break;
+                        }
+                        voice.paused  = false;
+                        voice.pausing = false;
+                        if (!voice.seeking) {
+                            ramp(voice,voice.volume);
+                        }
+                        break;
+                    case Type::VOLUME:
+                        voice.volume = command.value;
+                        if (!voice.paused && !voice.pausing && !voice.seeking && !voice.stopping) {
+                            ramp(voice,voice.volume);
+                        }
+                        break;
+                    case Type::LOOP:
+                        voice.loop = command.flag;
+                        break;
+                    default:
+                        break;
+                }
+                break;
+        }
+    }
+}
+
+/**
+ * Mixes a single block into the intermediate buffer (audio thread).
+ *
+ * If input is not nullptr, it is mixed into the input bus.
+ *
+ * @param frames    The number of frames (at most MIXER_BLOCK_FRAMES)
+ * @param input     The input block (interleaved stereo), or nullptr
+ */
+void SoundMixer::render(Uint32 frames, const float* input) {
+    process();
+    spatialize();
+    // Read after the commands, so that any bus they route to is visible
+    const Uint32 count = _buscount.load(std::memory_order_acquire);
+    for(Uint32 ii = 0; ii < count; ii++) {
+        _buses[ii]->clear(frames);
+    }
+    if (input != nullptr) {
+        Uint32 index = _input.load(std::memory_order_relaxed);
+        if (index < count) {
+            AudioBus* bus = _buses[index].get();
+            add_f32(bus->getBuffer(),input,frames*MIXER_CHANNELS);
+            bus->touch();
+        }
+    }
+
+    const float* lefts  = _spatial+EMIT_LEFT*_stride;
+    const float* rights = _spatial+EMIT_RIGHT*_stride;
+    const float* pitch  = _spatial+EMIT_PITCH*_stride;
+    for(Uint32 ii = 0; ii < _capacity; ii++) {
+        Voice& voice = _voices[ii];
+        if (voice.active) {
+            // Ramp the pan across the block to prevent zipper noise
+            if (voice.left < 0) {
+                voice.left  = lefts[ii];
+                voice.right = rights[ii];
+            }
+            voice.dleft  = (lefts[ii]-voice.left)/frames;
+            voice.dright = (rights[ii]-voice.right)/frames;
+            voice.rate   = pitch[ii];
+            Uint32 offset = 0;
+            bool alive = render(voice,frames,offset);
+            voice.left   = lefts[ii];
+            voice.right  = rights[ii];
+            voice.dleft  = 0;
+            voice.dright = 0;
+            if (!alive) {
+                halt(ii,!(voice.expiring && voice.expire == 0) && !voice.stopping,offset);
+            }
+            Uint64 position = voice.seeking ? voice.seekto : voice.position;
+            _positions[ii].store(position,std::memory_order_relaxed);
+        }
+    }
+    for(auto it = _tails.begin(); it != _tails.end(); ++it) {
+        Uint32 offset = 0;
+        if (it->active && !render(*it,frames,offset)) {
+            it->active = false;
+            retire(it->owner,it->stamp);
+        }
+    }
+
+    // Parents always precede their children, so submix in reverse order
+    for(Uint32 ii = count-1; ii > AudioBus::MASTER; ii--) {
+        AudioBus* bus = _buses[ii].get();
+        AudioBus* parent = _buses[bus->getParent()].get();
+        if (bus->process(parent->getBuffer(),frames)) {
+            parent->touch();
+        }
+    }
+    std::memset(_mixbuffer,0,frames*MIXER_CHANNELS*sizeof(float));
+    _buses[AudioBus::MASTER]->process(_mixbuffer,frames);
+    _clock.store(_clock.load(std::memory_order_relaxed)+frames,std::memory_order_release);
+}
+
+/**
+ * Mixes the given voice into the buffer of its bus (audio thread).
+ *
+ * The offset is set to the number of frames of the block that the voice
+ * has mixed.  If the voice stops early, this is the frame where it stopped.
+ *
+ * @param voice     The voice to mix
+ * @param frames    The number of frames to mix
+ * @param offset    The offset to store the frames mixed
+ *
+ * @return true if the voice is still active afterwards
+ */
+bool SoundMixer::render(Voice& voice, Uint32 frames, Uint32& offset) {
+    AudioBus* bus = _buses[voice.bus].get();
+    float* output = bus->getBuffer();
+    bus->touch();
+    Uint64 length = duration(voice);
+    Uint32 channels = voice.stream ? voice.stream->getChannels() : voice.buffer->getChannels();
+    bool resampled = voice.stream == nullptr && voice.rate != 1.0f;
+    offset = 0;
+    while (frames > 0) {
+        if (voice.stopping && voice.ramp == 0) {
+            return false;
+        } else if (voice.paused) {
+            return true;
+        } else if (voice.delay > 0) {
+            // Scheduled to start later (possibly in this block)
+            Uint32 skip = voice.delay < frames ? (Uint32)voice.delay : frames;
+            voice.delay -= skip;
+            output += skip*MIXER_CHANNELS;
+            offset += skip;
+            frames -= skip;
+            continue;
+        } else if (voice.expiring && voice.expire == 0) {
+            return false;
+        } else if (voice.cued && !voice.loop && !voice.pausing && !voice.seeking &&
+                   voice.position+voice.cfade >= length) {
+            follow(voice,offset);
+            length = duration(voice);
+            channels  = voice.stream ? voice.stream->getChannels() : voice.buffer->getChannels();
+            resampled = voice.stream == nullptr && voice.rate != 1.0f;
+            continue;
+        } else if (voice.position >= length) {
+            if (!voice.loop || length == 0) {
+                return false;
+            }
+            voice.position = 0;
+        }
+
+        Uint64 chunk = frames;
+        if (voice.expiring && voice.expire < chunk) {
+            chunk = voice.expire;
+        }
+        if (!resampled && length-voice.position < chunk) {
+            chunk = length-voice.position;
+        }
+        if (voice.cued && !voice.loop && length-voice.position-voice.cfade < chunk) {
+            // Stop at the frame where the cued sound takes over
+            chunk = length-voice.position-voice.cfade;
+        }
+        if (voice.ramp > 0 && voice.ramp < chunk) {
+            chunk = voice.ramp;
+        }
+
+        const float* source = nullptr;
+        if (voice.stream != nullptr) {
+            Uint32 available = voice.stream->acquire(&source);
+            if (available == 0) {
+                // Underrun; stay silent (and in place) until the decoder catches up
+                return true;
+            } else if (available < chunk) {
+                chunk = available;
+            }
+        } else {
+            source = voice.buffer->getData()+voice.position*channels;
+        }
+
+        // Combine the volume ramp with the pan ramp
+        Uint32 amount = (Uint32)chunk;
+        float left  = voice.left+voice.dleft*offset;
+        float right = voice.right+voice.dright*offset;
+        float gains[2] = { voice.gain*left, voice.gain*right };
+        float steps[2];
+        if (voice.dleft == 0 && voice.dright == 0) {
+            steps[0] = voice.step*left;
+            steps[1] = voice.step*right;
+        } else {
+            float gain = voice.gain+voice.step*amount;
+            steps[0] = (gain*(left+voice.dleft*amount)-gains[0])/amount;
+            steps[1] = (gain*(right+voice.dright*amount)-gains[1])/amount;
+        }
+
+        if (resampled) {
+            amount = resample(voice,output,amount,gains,steps);
+        } else {
+            if (voice.gain != 0 || voice.step != 0) {
+                if (channels == 2) {
+                    mix_stereo(output,source,amount,gains,steps);
+                } else {
+                    mix_mono(output,source,amount,gains,steps);
+                }
+            }
+            if (voice.stream != nullptr) {
+                voice.stream->consume(amount);
+            }
+            voice.position += amount;
+        }
+        if (voice.expiring) {
+            voice.expire -= amount;
+        }
+
+        if (voice.ramp > 0) {
+            voice.ramp -= amount;
+            voice.gain += voice.step*amount;
+            if (voice.ramp == 0) {
+                voice.gain = voice.target;
+                voice.step = 0;
+                if (voice.seeking) {
+                    voice.seeking  = false;
+                    voice.position = voice.seekto;
+                    voice.stream->seek(voice.seekto);
+                    if (!voice.pausing) {
+                        ramp(voice,voice.volume);
+                    }
+                }
+                if (voice.pausing) {
+                    voice.pausing = false;
+                    voice.paused  = true;
+                }
+            }
+        }
+        output += amount*MIXER_CHANNELS;
+        offset += amount;
+        frames -= amount;
+    }
+    return !(voice.stopping && voice.ramp == 0);
+}
+
+/**
+ * Mixes the given voice with a variable playback rate (audio thread).
+ *
+ * This is used for doppler, and is only supported for PCM buffers.  The
+ * method stops early if it reaches the end of a buffer that does not
+ * loop.  The gains are for the left and right channel respectively.
+ *
+ * @param voice     The voice to mix
+ * @param output    The output buffer (interleaved stereo)
+ * @param frames    The number of frames to mix
+ * @param gains     The gain of the first frame (left and right)
+ * @param steps     The per-frame gain increment (left and right)
+ *
+ * @return the number of frames mixed
+ */
+Uint32 SoundMixer::resample(Voice& voice, float* output, Uint32 frames, const float* gains, const float* steps) {
+    const float* data = voice.buffer->getData();
+    const Uint64 length = voice.buffer->getFrames();
+    const Uint32 channels = voice.buffer->getChannels();
+    Uint64 position = voice.position;
+    float phase = voice.phase;
+
+    Uint32 ii = 0;
+    for(; ii < frames; ii++) {
+        if (position >= length) {
+            if (!voice.loop) {
+                break;
+            }
+            position %= length;
+        }
+        // Linear interpolation with the next frame (wrapping if looped)
+        Uint64 next = position+1 < length ? position+1 : (voice.loop ? 0 : position);
+        float gl = gains[0]+ii*steps[0];
+        float gr = gains[1]+ii*steps[1];
+        if (channels == 2) {
+            const float* a = data+2*position;
+            const float* b = data+2*next;
+            output[2*ii  ] += (a[0]+phase*(b[0]-a[0]))*gl;
+            output[2*ii+1] += (a[1]+phase*(b[1]-a[1]))*gr;
+        } else {
+            float v = data[position]+phase*(data[next]-data[position]);
+            output[2*ii  ] += v*gl;
+            output[2*ii+1] += v*gr;
+        }
+        phase += voice.rate;
+        Uint32 whole = (Uint32)phase;
+        position += whole;
+        phase -= whole;
+    }
+    if (voice.loop && position >= length) {
+        position %= length;
+    }
+    voice.position = position;
+    voice.phase = phase;
+    return ii;
+}
+
+/**
+ * Computes the pan gains and pitch of every emitter (audio thread).
+ *
+ * The results are stored in the LEFT, RIGHT, and PITCH rows.  Voices
+ * without an emitter are masked, so that they always have unit values.
+ * Attenuation is folded into the pan gains using the clamped models of
+ * OpenAL, while panning uses an equal-power law on the horizontal offset.
+ */
+void SoundMixer::spatialize() {
+    if (_emitters == 0) {
+        return;
+    }
+    const Uint32 stride = _stride;
+    const float* xs     = _spatial+EMIT_X*stride;
+    const float* ys     = _spatial+EMIT_Y*stride;
+    const float* vxs    = _spatial+EMIT_VX*stride;
+    const float* vys    = _spatial+EMIT_VY*stride;
+    const float* refs   = _spatial+EMIT_REFERENCE*stride;
+    const float* maxs   = _spatial+EMIT_MAXIMUM*stride;
+    const float* rolls  = _spatial+EMIT_ROLLOFF*stride;
+    const float* masks  = _spatial+EMIT_MASK*stride;
+    float* lefts  = _spatial+EMIT_LEFT*stride;
+    float* rights = _spatial+EMIT_RIGHT*stride;
+    float* pitch  = _spatial+EMIT_PITCH*stride;
+
+    const lane_t one  = lane_set(1.0f);
+    const lane_t zero = lane_set(0.0f);
+    const lane_t tiny = lane_set(SPATIAL_EPSILON);
+    const lane_t quarter = lane_set(0.78539816f);
+    const lane_t halfroot = lane_set(0.70710678f);
+    const lane_t lx  = lane_set(_listener[0]);
+    const lane_t ly  = lane_set(_listener[1]);
+    const lane_t lvx = lane_set(_listener[2]);
+    const lane_t lvy = lane_set(_listener[3]);
+
+    const bool doppler = _doppler > 0;
+    const lane_t factor = lane_set(_doppler);
+    const lane_t speed  = lane_set(_speed);
+    const lane_t limit  = lane_set(doppler ? _speed/_doppler : 0.0f);
+    const lane_t lower  = lane_set(DOPPLER_MIN);
+    const lane_t upper  = lane_set(DOPPLER_MAX);
+
+    for(Uint32 ii = 0; ii < stride; ii += AUDIO_LANES) {
+        lane_t dx = lane_sub(lane_load(xs+ii),lx);
+        lane_t dy = lane_sub(lane_load(ys+ii),ly);
+        lane_t dist = lane_mul(dx,dx);
+        dist = lane_add(dist,lane_mul(dy,dy));
+        dist = lane_sqrt(lane_max(dist,lane_mul(tiny,tiny)));
+
+        lane_t ref  = lane_load(refs+ii);
+        lane_t maxd = lane_load(maxs+ii);
+        lane_t roll = lane_load(rolls+ii);
+        lane_t mask = lane_load(masks+ii);
+        lane_t clamped = lane_max(lane_min(dist,maxd),ref);
+
+        lane_t atten;
+        switch (_model) {
+            case AudioEngine::DistanceModel::NONE:
+                atten = one;
+                break;
+            case AudioEngine::DistanceModel::INVERSE:
+                atten = lane_add(ref,lane_mul(roll,lane_sub(clamped,ref)));
+                atten = lane_div(ref,atten);
+                break;
+            case AudioEngine::DistanceModel::LINEAR:
+                atten = lane_div(lane_mul(roll,lane_sub(clamped,ref)),
+                                 lane_max(lane_sub(maxd,ref),tiny));
+                atten = lane_max(lane_min(lane_sub(one,atten),one),zero);
+                break;
+            case AudioEngine::DistanceModel::EXPONENTIAL:
+            {
+                // There is no vector pow, so finish this model in scalar
+                alignas(16) float ratio[AUDIO_LANES];
+                lane_store(ratio,lane_div(clamped,ref));
+                for(Uint32 jj = 0; jj < AUDIO_LANES; jj++) {
+                    ratio[jj] = std::pow(ratio[jj],-rolls[ii+jj]);
+                }
+                atten = lane_load(ratio);
+            }
+                break;
+        }
+
+        // Equal-power pan on the horizontal offset (full pan past reference)
+        lane_t angle = lane_mul(lane_div(dx,lane_max(dist,ref)),quarter);
+        lane_t sine, cosine;
+        lane_sincos(angle,sine,cosine);
+        atten = lane_mul(atten,halfroot);
+        lane_t left  = lane_mul(atten,lane_sub(cosine,sine));
+        lane_t right = lane_mul(atten,lane_add(cosine,sine));
+        lane_store(lefts+ii, lane_add(one,lane_mul(mask,lane_sub(left,one))));
+        lane_store(rights+ii,lane_add(one,lane_mul(mask,lane_sub(right,one))));
+
+        if (doppler) {
+            // Project velocities onto the emitter to listener direction
+            lane_t inv = lane_div(one,dist);
+            lane_t ux = lane_mul(lane_sub(zero,dx),inv);
+            lane_t uy = lane_mul(lane_sub(zero,dy),inv);
+            lane_t vls = lane_add(lane_mul(ux,lvx),lane_mul(uy,lvy));
+            lane_t vss = lane_add(lane_mul(ux,lane_load(vxs+ii)),lane_mul(uy,lane_load(vys+ii)));
+            vls = lane_min(vls,limit);
+            vss = lane_min(vss,limit);
+            lane_t num = lane_max(lane_sub(speed,lane_mul(factor,vls)),tiny);
+            lane_t den = lane_max(lane_sub(speed,lane_mul(factor,vss)),tiny);
+            lane_t shift = lane_max(lane_min(lane_div(num,den),upper),lower);
+            lane_store(pitch+ii,lane_add(one,lane_mul(mask,lane_sub(shift,one))));
+        } else {
+            lane_store(pitch+ii,one);
+        }
+    }
+}
+
+/**
+ * Begins a gain ramp on the given voice.
+ *
+ * @param voice     The voice to ramp
+ * @param target    The target gain
+ * @param frames    The length of the ramp
+ */
+void SoundMixer::ramp(Voice& voice, float target, Uint32 frames) {
+    voice.target = target;
+    voice.ramp = frames;
+    voice.step = (target-voice.gain)/frames;
+}
+
+/**
+ * Starts the cued sound of the given voice (audio thread).
+ *
+ * The remainder of the current sound is moved to the tail pool, where
+ * it fades out in time with the fade in of the cued sound.
+ *
+ * @param voice     The voice to advance
+ * @param offset    The offset of the current frame within the block
+ */
+void SoundMixer::follow(Voice& voice, Uint32 offset) {
+    Uint64 length = duration(voice);
+    Uint64 remain = voice.position < length ? length-voice.position : 0;
+    if (remain > 0 && (voice.gain > 0 || voice.ramp > 0)) {
+        fade(voice,(Uint32)remain,offset);
+    }
+
+    Notice notice;
+    notice.voice = voice.owner;
+    notice.stamp = voice.stamp;
+    notice.release = false;
+    notice.normal  = true;
+    notice.next    = voice.cstamp;
+    notify(notice);
+
+    Uint32 stamp = voice.stamp;
+    voice.prior  = stamp;
+    voice.stamp  = voice.cstamp;
+    voice.buffer = voice.cbuffer;
+    voice.stream = voice.cstream;
+    voice.volume = voice.cvolume;
+    voice.loop   = voice.cloop;
+    voice.cued   = false;
+    voice.position = 0;
+    voice.phase    = 0;
+    voice.expiring = false;
+    voice.expire   = 0;
+    if (voice.cfade > 0) {
+        voice.gain = 0;
+        ramp(voice,voice.volume,voice.cfade);
+    } else {
+        voice.gain = voice.volume;
+        voice.step = 0;
+        voice.ramp = 0;
+    }
+    retire(voice.owner,stamp);
+}
+
+/**
+ * Discards the cued sound of the given voice (audio thread).
+ *
+ * @param voice     The voice to adjust
+ */
+void SoundMixer::drop(Voice& voice) {
+    voice.cued = false;
+    retire(voice.owner,voice.cstamp);
+}
+
+/**
+ * Returns the length of the sound on the given voice in frames.
+ *
+ * @param voice     The voice to query
+ *
+ * @return the length of the sound on the given voice in frames.
+ */
+Uint64 SoundMixer::duration(const Voice& voice) const {
+    return voice.stream ? voice.stream->getFrames() : voice.buffer->getFrames();
+}
+
+/**
+ * Stops the given voice, moving it to the tail pool (audio thread).
+ *
+ * The offset is the frame of the current block where the voice stopped,
+ * so that any fade out begins there.
+ *
+ * @param index     The voice index
+ * @param normal    Whether the voice completed normally
+ * @param offset    The offset of the current frame within the block
+ */
+void SoundMixer::halt(Uint32 index, bool normal, Uint32 offset) {
+    Voice& voice = _voices[index];
+    voice.active = false;
+    if (voice.cued) {
+        drop(voice);
+    }
+    if (!normal && !voice.paused && voice.gain > 0) {
+        fade(voice,MIXER_RAMP_FRAMES,offset);
+    }
+
+    Notice notice;
+    notice.voice = index;
+    notice.stamp = voice.stamp;
+    notice.release = false;
+    notice.normal  = normal;
+    notice.next    = 0;
+    notify(notice);
+    retire(index,voice.stamp);
+}
+
+/**
+ * Moves a copy of the voice to the tail pool to fade out.
+ *
+ * The delay is the number of frames of the current block that the voice
+ * has already mixed, so that the tail picks up where it left off.
+ *
+ * @param voice     The voice to copy
+ * @param frames    The length of the fade
+ * @param delay     The number of frames to wait before the fade
+ *
+ * @return true if there was room in the tail pool
+ */
+bool SoundMixer::fade(const Voice& voice, Uint32 frames, Uint32 delay) {
+    if (voice.delay > 0) {
+        // The voice never started, so there is nothing to hear
+        return false;
+    }
+    for(auto it = _tails.begin(); it != _tails.end(); ++it) {
+        if (!it->active) {
+            *it = voice;
+            it->active   = true;
+            it->loop     = false;
+            it->paused   = false;
+            it->pausing  = false;
+            it->expiring = false;
+            it->seeking  = false;
+            it->cued     = false;
+            it->stopping = true;
+            it->delay  = delay;
+            it->dleft  = 0;
+            it->dright = 0;
+            if (it->left < 0) {
+                it->left  = 1;
+                it->right = 1;
+            }
+            ramp(*it,0,frames);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Sends a release notice if no voice or tail still uses a play instance.
+ *
+ * @param owner     The voice index
+ * @param stamp     The play instance
+ */
+void SoundMixer::retire(Uint32 owner, Uint32 stamp) {
+    const Voice& voice = _voices[owner];
+    if (voice.active && voice.stamp == stamp) {
+        return;
+    }
+    for(auto it = _tails.begin(); it != _tails.end(); ++it) {
+        if (it->active && it->owner == owner && it->stamp == stamp) {
+            return;
+        }
+    }
+    Notice notice;
+    notice.voice = owner;
+    notice.stamp = stamp;
+    notice.release = true;
+    notice.normal  = false;
+    notice.next    = 0;
+    notify(notice);
+}
@@ -0,0 +1,1072 @@
+//
+//  CUSoundMixer.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a software mixer for sound effects and music.  The
+//  mixer owns a fixed number of voices, each of which plays an in-memory PCM
+//  buffer or a decoded stream (see CUSoundStream.h).  Playback may be
+//  scheduled against the sample clock of the mixer, and a voice may have a
+//  second sound cued to follow the first without a gap.
+//
+//  The mixer is designed to be run inside of an audio callback, and so it never
+//  blocks or allocates memory once initialized.  All playback commands are
+//  sent from the main thread through a lock-free ring buffer, and all
+//  completion notices come back through a second ring buffer.
+//
+//  This file is an internal header.  It is not accessible by general users
+//  of the CUGL API.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_SOUND_MIXER_H__
+#define __CU_SOUND_MIXER_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/util/CURingBuffer.h>
+#include <cugl/audio/CUAudioEngine.h>
+#include <cugl/audio/CUAudioBus.h>
+#include <cugl/math/CUVec2.h>
+#include <unordered_map>
+#include <functional>
+#include <vector>
+#include <atomic>
+
+/** The number of frames in a gain ramp (about 6ms at 44.1 kHz) */
+#define MIXER_RAMP_FRAMES   256
+/** The maximum number of frames processed in a single internal block */
+#define MIXER_BLOCK_FRAMES  512
+/** The number of output channels of the mixer (always stereo) */
+#define MIXER_CHANNELS      2
+/** The maximum number of buses in a mixer (including the standard buses) */
+#define MIXER_MAX_BUSES     64
+
+namespace cugl {
+
+class SoundStream;
+
+#pragma mark -
+#pragma mark PCM Buffer
+/**
+ * An in-memory buffer of decoded audio.
+ *
+ * The samples are stored as interleaved 32-bit floats in the range [-1,1].
+ * The buffer must be either mono or stereo.  The sample data is 16-byte
+ * aligned so that the mixer may use vector instructions to read it.
+ *
+ * Buffers are shared between the main thread and the audio thread.  The
+ * mixer guarantees that it keeps a reference to any buffer it is playing,
+ * so it is always safe to release a buffer on the main thread.
+ */
+class PCMBuffer {
+private:
+    /** The raw (unaligned) allocation */
+    void* _raw;
+    /** The aligned sample data */
+    float* _data;
+    /** The number of channels (1 or 2) */
+    Uint32 _channels;
+    /** The number of audio frames */
+    Uint64 _frames;
+    /** The sample rate in HZ */
+    Uint32 _rate;
+
+public:
+    /**
+     * Creates an empty PCM buffer.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    PCMBuffer() : _raw(nullptr), _data(nullptr), _channels(0), _frames(0), _rate(0) {}
+
+    /**
+     * Deletes this buffer, releasing all memory.
+     */
+    ~PCMBuffer() { dispose(); }
+
+    /**
+     * Releases the sample data of this buffer.
+     */
+    void dispose();
+
+    /**
+     * Initializes a silent buffer of the given size.
+     *
+     * @param channels  The number of channels (1 or 2)
+     * @param frames    The number of audio frames
+     * @param rate      The sample rate in HZ
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 channels, Uint64 frames, Uint32 rate);
+
+    /**
+     * Returns a newly allocated silent buffer of the given size.
+     *
+     * @param channels  The number of channels (1 or 2)
+     * @param frames    The number of audio frames
+     * @param rate      The sample rate in HZ
+     *
+     * @return a newly allocated silent buffer of the given size.
+     */
+    static std::shared_ptr<PCMBuffer> alloc(Uint32 channels, Uint64 frames, Uint32 rate) {
+        std::shared_ptr<PCMBuffer> result = std::make_shared<PCMBuffer>();
+        return (result->init(channels,frames,rate) ? result : nullptr);
+    }
+
+    /** Returns the interleaved sample data */
+    float* getData() { return _data; }
+
+    /** Returns the interleaved sample data */
+    const float* getData() const { return _data; }
+
+    /** Returns the number of channels (1 or 2) */
+    Uint32 getChannels() const { return _channels; }
+
+    /** Returns the number of audio frames */
+    Uint64 getFrames() const { return _frames; }
+
+    /** Returns the sample rate in HZ */
+    Uint32 getRate() const { return _rate; }
+
+    /** Returns the size of the sample data in bytes */
+    size_t getSize() const { return (size_t)(_frames*_channels*sizeof(float)); }
+};
+
+
+#pragma mark -
+#pragma mark Sound Mixer
+/**
+ * A software mixer for in-memory sound effects.
+ *
+ * The mixer has a fixed number of voices, identified by index.  Each voice
+ * plays a single {@link PCMBuffer} at a time.  All gain changes (including
+ * starting, stopping, pausing and seeking) are applied with a short linear
+ * ramp, so that there is no zipper noise or clicking.  Stopped voices are
+ * moved to a separate pool of tails so that they may fade out while the
+ * voice is reused.
+ *
+ * The methods of this class are split between two threads.  The playback
+ * methods ({@link play}, {@link stop}, {@link setVolume}, etc.) and the
+ * {@link poll} method must only be called on the main thread.  They never
+ * block; they simply push a command to the audio thread.  The {@link mix}
+ * methods must only be called on the audio thread (or on the main thread if
+ * there is no audio thread, as in offline rendering).
+ *
+ * Each voice may also have a 2D emitter, in which case its gain and stereo
+ * pan are computed from the position of the emitter relative to a single
+ * listener.  These gains are computed for all voices at once, in a single
+ * vectorized pass at the start of each block, and are ramped across the
+ * block.  If doppler is enabled, in-memory buffers are resampled to shift
+ * their pitch (streams are never resampled).  Emitters belong to the voice,
+ * not the sound, so they persist from one sound to the next.
+ *
+ * Every voice is routed to an {@link AudioBus}.  The buses form a tree rooted
+ * at the master bus, and each bus may apply a chain of DSP nodes to its
+ * submix before adding it to its parent.  The mixer starts with the four
+ * standard buses (master, music, sound, and voice), and every voice starts
+ * on the sound bus.  Like emitters, the bus belongs to the voice and not the
+ * sound.  The mixer may also route its output buffer through a bus before
+ * mixing (see {@link setInput}).  This allows other audio, such as music
+ * played by another library, to be processed by the bus graph.
+ *
+ * A voice may also play a {@link SoundStream}.  Streams cannot be read at
+ * two positions at once, so seeking a stream voice fades out, seeks, and
+ * then fades back in, rather than crossfading.  If a stream has not decoded
+ * far enough ahead, the voice is silent (but does not advance) until it has.
+ *
+ * The mixer keeps a sample clock, which is the number of frames mixed so far.
+ * A sound may be scheduled to start at an absolute time on this clock, in
+ * which case it starts on that exact frame, even if it is in the middle of a
+ * block.  A voice may also have a second sound cued to follow the current
+ * one (see {@link cue}).  The cued sound starts on the frame after the
+ * current sound ends, or crossfades with the end of the current sound.  This
+ * is how the music queue is made gapless.
+ *
+ * The mixer always mixes in stereo at a fixed sample rate.  The buffers are
+ * expected to already be at this sample rate; no resampling is performed at
+ * play time.
+ */
+class SoundMixer {
+public:
+    /**
+     * The callback for voice completion.
+     *
+     * The first parameter is the voice, and the second is true if the sound
+     * completed normally, or false if it was stopped manually.
+     */
+    typedef std::function<void(Uint32 voice, bool normal)> Listener;
+
+private:
+    /** The command types sent to the audio thread */
+    enum class Type : Uint8 {
+        PLAY, STOP, EXPIRE, PAUSE, RESUME, VOLUME, LOOP, SEEK,
+        EMITTER, LISTENER, MODEL, DOPPLER, BUS, CUE, UNCUE, FADE
+    };
+
+    /** A command from the main thread to the audio thread */
+    typedef struct {
+        /** The command type */
+        Type type;
+        /** The voice for this command */
+        Uint32 voice;
+        /** The play instance of the voice */
+        Uint32 stamp;
+        /** The play instance of the cued sound (CUE and UNCUE) */
+        Uint32 cue;
+        /** The position serial number (PLAY and SEEK) */
+        Uint32 serial;
+        /** The buffer to play (PLAY only) */
+        const PCMBuffer* buffer;
+        /** The stream to play (PLAY only) */
+        SoundStream* stream;
+        /** The volume (PLAY and VOLUME) */
+        float  value;
+        /** The frame position or frame count (PLAY, SEEK, EXPIRE) or bus (BUS) */
+        Uint64 frame;
+        /** The clock time to start (PLAY), or 0 to start immediately */
+        Uint64 time;
+        /** The number of frames to fade (PLAY, CUE, and FADE) */
+        Uint32 fade;
+        /** The loop setting (PLAY and LOOP) or emitter setting (EMITTER) */
+        bool   flag;
+        /** The spatial parameters (EMITTER, LISTENER, and DOPPLER) */
+        float  params[7];
+    } Command;
+
+    /** A notice from the audio thread to the main thread */
+    typedef struct {
+        /** The voice for this notice */
+        Uint32 voice;
+        /** The play instance of the voice */
+        Uint32 stamp;
+        /** Whether this notice releases the buffer (as opposed to ending play) */
+        bool   release;
+        /** Whether the voice completed normally */
+        bool   normal;
+        /** The play instance of the cued sound that followed (or 0) */
+        Uint32 next;
+    } Notice;
+
+    /** The playback state of a voice (audio thread only) */
+    typedef struct {
+        /** The buffer being played (or nullptr for a stream) */
+        const PCMBuffer* buffer;
+        /** The stream being played (or nullptr for a buffer) */
+        SoundStream* stream;
+        /** The current frame position */
+        Uint64 position;
+        /** The frame position of a deferred stream seek */
+        Uint64 seekto;
+        /** The number of frames until the voice expires */
+        Uint64 expire;
+        /** The number of frames to wait before starting */
+        Uint64 delay;
+        /** The play instance of the voice */
+        Uint32 stamp;
+        /** The play instance of the previous sound (for commands in flight) */
+        Uint32 prior;
+        /** The voice this state belongs to (for tails) */
+        Uint32 owner;
+        /** The bus this voice is routed to */
+        Uint32 bus;
+        /** The user-requested volume */
+        float  volume;
+        /** The current gain */
+        float  gain;
+        /** The target gain of the current ramp */
+        float  target;
+        /** The per-frame gain increment of the current ramp */
+        float  step;
+        /** The number of frames remaining in the current ramp */
+        Uint32 ramp;
+        /** The left pan gain at the start of this block (negative to snap) */
+        float  left;
+        /** The right pan gain at the start of this block */
+        float  right;
+        /** The per-frame left pan increment for this block */
+        float  dleft;
+        /** The per-frame right pan increment for this block */
+        float  dright;
+        /** The playback rate (for doppler) */
+        float  rate;
+        /** The fractional frame position (for doppler) */
+        float  phase;
+        /** Whether this voice is active */
+        bool   active;
+        /** Whether this voice loops */
+        bool   loop;
+        /** Whether this voice is paused (silent, not advancing) */
+        bool   paused;
+        /** Whether this voice will pause when the ramp completes */
+        bool   pausing;
+        /** Whether this voice will stop when the ramp completes */
+        bool   stopping;
+        /** Whether this voice has an expiration countdown */
+        bool   expiring;
+        /** Whether this voice will seek its stream when the ramp completes */
+        bool   seeking;
+        /** Whether this voice has a sound cued to follow */
+        bool   cued;
+        /** The cued buffer (or nullptr for a stream) */
+        const PCMBuffer* cbuffer;
+        /** The cued stream (or nullptr for a buffer) */
+        SoundStream* cstream;
+        /** The play instance of the cued sound */
+        Uint32 cstamp;
+        /** The volume of the cued sound */
+        float  cvolume;
+        /** Whether the cued sound loops */
+        bool   cloop;
+        /** The number of frames to crossfade into the cued sound */
+        Uint32 cfade;
+    } Voice;
+
+    /** The number of voices */
+    Uint32 _capacity;
+    /** The output sample rate */
+    Uint32 _rate;
+
+    /** The voices (audio thread only) */
+    std::vector<Voice> _voices;
+    /** The fading tails of stopped voices (audio thread only) */
+    std::vector<Voice> _tails;
+    /** The raw allocation for the mix buffer */
+    void*  _mixraw;
+    /** The aligned intermediate mix buffer (audio thread only) */
+    float* _mixbuffer;
+    /** The raw allocation for the emitter data */
+    void*  _spatraw;
+    /** The emitter data, as rows of per-voice values (audio thread only) */
+    float* _spatial;
+    /** The length of each emitter row (a multiple of 4) */
+    Uint32 _stride;
+    /** The number of voices with an emitter (audio thread only) */
+    Uint32 _emitters;
+    /** The listener position and velocity (audio thread only) */
+    float  _listener[4];
+    /** The distance attenuation model (audio thread only) */
+    AudioEngine::DistanceModel _model;
+    /** The doppler factor, or 0 if doppler is disabled (audio thread only) */
+    float  _doppler;
+    /** The speed of sound for doppler (audio thread only) */
+    float  _speed;
+
+    /** The bus graph, in topological order (never reallocated after init) */
+    std::vector<std::shared_ptr<AudioBus>> _buses;
+    /** The number of buses published to the audio thread */
+    std::atomic<Uint32> _buscount;
+    /** The bus that receives the output buffer (or MIXER_NO_INPUT) */
+    std::atomic<Uint32> _input;
+    /** The raw allocation for the input buffer */
+    void*  _inraw;
+    /** The aligned input buffer (audio thread only) */
+    float* _inbuffer;
+
+    /** The commands from the main thread */
+    RingBuffer<Command> _commands;
+    /** The notices from the audio thread */
+    RingBuffer<Notice>  _notices;
+
+    /** The sample clock (the number of frames mixed so far) */
+    std::atomic<Uint64> _clock;
+    /** The published frame position of each voice */
+    std::unique_ptr<std::atomic<Uint64>[]> _positions;
+    /** The last seek/play serial processed by the audio thread for each voice */
+    std::unique_ptr<std::atomic<Uint32>[]> _acks;
+
+    // Main thread state
+    /** The last play instance issued (unique across all voices) */
+    Uint32 _counter;
+    /** The play instance of each voice */
+    std::vector<Uint32> _stamps;
+    /** The play instance of the sound cued on each voice (or 0) */
+    std::vector<Uint32> _cues;
+    /** Whether the notice being reported by poll is for the current sound */
+    bool _current;
+    /** The seek/play serial of each voice */
+    std::vector<Uint32> _serials;
+    /** The pending frame position of each voice (until acknowledged) */
+    std::vector<Uint64> _pending;
+    /** Whether each voice is playing (from the main thread's perspective) */
+    std::vector<bool>   _playing;
+    /** Whether each voice is paused (from the main thread's perspective) */
+    std::vector<bool>   _paused;
+    /** The buffers retained on behalf of the audio thread */
+    std::unordered_map<Uint64,std::shared_ptr<PCMBuffer>> _retained;
+    /** The streams retained on behalf of the audio thread */
+    std::unordered_map<Uint64,std::shared_ptr<SoundStream>> _streams;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate mixer with no voices.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    SoundMixer();
+
+    /**
+     * Deletes this mixer, releasing all resources.
+     */
+    ~SoundMixer() { dispose(); }
+
+    /**
+     * Disposes this mixer, releasing all resources.
+     *
+     * The mixer must not be in use by the audio thread when this is called.
+     */
+    void dispose();
+
+    /**
+     * Initializes a mixer with the given number of voices.
+     *
+     * @param voices    The number of simultaneous voices
+     * @param rate      The output sample rate
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 voices, Uint32 rate);
+
+    /**
+     * Returns a newly allocated mixer with the given number of voices.
+     *
+     * @param voices    The number of simultaneous voices
+     * @param rate      The output sample rate
+     *
+     * @return a newly allocated mixer with the given number of voices.
+     */
+    static std::shared_ptr<SoundMixer> alloc(Uint32 voices, Uint32 rate) {
+        std::shared_ptr<SoundMixer> result = std::make_shared<SoundMixer>();
+        return (result->init(voices,rate) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the number of voices in this mixer.
+     *
+     * @return the number of voices in this mixer.
+     */
+    Uint32 getCapacity() const { return _capacity; }
+
+    /**
+     * Returns the output sample rate of this mixer.
+     *
+     * @return the output sample rate of this mixer.
+     */
+    Uint32 getRate() const { return _rate; }
+
+    /**
+     * Returns the sample clock of this mixer.
+     *
+     * The clock is the number of frames mixed so far.  It is updated by the
+     * audio thread at the end of every block, so the value is the time of
+     * the first frame of the next block.  Any sound scheduled at or before
+     * this time will start as soon as possible.
+     *
+     * @return the sample clock of this mixer.
+     */
+    Uint64 getTime() const { return _clock.load(std::memory_order_acquire); }
+
+#pragma mark Playback (Main Thread)
+    /**
+     * Plays a buffer on the given voice.
+     *
+     * If the voice is already playing, the previous sound is stopped and a
+     * (manual) completion notice is sent for it, just as if {@link stop} had
+     * been called first.
+     *
+     * If time is non-zero, the sound is silent until the sample clock reaches
+     * that time (see {@link getTime}), and starts on that exact frame.  If the
+     * time has already passed, the sound starts as soon as possible.  If fade
+     * is non-zero, the sound fades in over that many frames.
+     *
+     * @param voice     The voice to play on
+     * @param buffer    The buffer to play
+     * @param volume    The volume (0 to 1)
+     * @param loop      Whether to loop the buffer
+     * @param frame     The frame to start playback
+     * @param time      The clock time to start playback (0 for immediately)
+     * @param fade      The number of frames to fade in
+     */
+    void play(Uint32 voice, const std::shared_ptr<PCMBuffer>& buffer, float volume, bool loop,
+              Uint64 frame=0, Uint64 time=0, Uint32 fade=0);
+
+    /**
+     * Plays a stream on the given voice.
+     *
+     * The stream should already be primed at the given frame (and registered
+     * with a {@link StreamService}), so that playback can start immediately.
+     * A stream may only be played on one voice at a time.
+     *
+     * If the voice is already playing, the previous sound is stopped and a
+     * (manual) completion notice is sent for it, just as if {@link stop} had
+     * been called first.
+     *
+     * If time is non-zero, the sound is silent until the sample clock reaches
+     * that time (see {@link getTime}), and starts on that exact frame.  If the
+     * time has already passed, the sound starts as soon as possible.  If fade
+     * is non-zero, the sound fades in over that many frames.
+     *
+     * @param voice     The voice to play on
+     * @param stream    The stream to play
+     * @param volume    The volume (0 to 1)
+     * @param loop      Whether to loop the stream
+     * @param frame     The frame to start playback
+     * @param time      The clock time to start playback (0 for immediately)
+     * @param fade      The number of frames to fade in
+     */
+    void play(Uint32 voice, const std::shared_ptr<SoundStream>& stream, float volume, bool loop,
+              Uint64 frame=0, Uint64 time=0, Uint32 fade=0);
+
+    /**
+     * Cues a buffer to follow the current sound on the given voice.
+     *
+     * When the current sound reaches its end, the cued buffer starts on the
+     * very next frame, from the beginning.  If fade is non-zero, the cued
+     * buffer instead starts that many frames before the end, and the two
+     * sounds are crossfaded.  A looping sound never reaches its end, so the
+     * cue waits until looping is turned off.
+     *
+     * The current sound sends a normal completion notice when the cued sound
+     * takes over.  Only one sound may be cued at a time, so this replaces
+     * any previous cue.  If the voice is not playing, this is the same as
+     * {@link play}.
+     *
+     * @param voice     The voice to cue
+     * @param buffer    The buffer to cue
+     * @param volume    The volume (0 to 1)
+     * @param loop      Whether to loop the buffer
+     * @param fade      The number of frames to crossfade
+     */
+    void cue(Uint32 voice, const std::shared_ptr<PCMBuffer>& buffer, float volume, bool loop, Uint32 fade=0);
+
+    /**
+     * Cues a stream to follow the current sound on the given voice.
+     *
+     * When the current sound reaches its end, the cued stream starts on the
+     * very next frame.  The stream should already be primed at frame 0 (and
+     * registered with a {@link StreamService}).  If fade is non-zero, the
+     * cued stream instead starts that many frames before the end, and the two
+     * sounds are crossfaded.  A looping sound never reaches its end, so the
+     * cue waits until looping is turned off.
+     *
+     * The current sound sends a normal completion notice when the cued sound
+     * takes over.  Only one sound may be cued at a time, so this replaces
+     * any previous cue.  If the voice is not playing, this is the same as
+     * {@link play}.
+     *
+     * @param voice     The voice to cue
+     * @param stream    The stream to cue
+     * @param volume    The volume (0 to 1)
+     * @param loop      Whether to loop the stream
+     * @param fade      The number of frames to crossfade
+     */
+    void cue(Uint32 voice, const std::shared_ptr<SoundStream>& stream, float volume, bool loop, Uint32 fade=0);
+
+    /**
+     * Removes the cued sound (if any) from the given voice.
+     *
+     * If the cued sound has already taken over by the time the audio thread
+     * sees this command, it is stopped instead.
+     *
+     * @param voice     The voice to adjust
+     */
+    void uncue(Uint32 voice);
+
+    /**
+     * Returns true if the given voice has a sound cued to follow.
+     *
+     * This is the state as seen by the main thread.  The cue is cleared once
+     * the notice that it has taken over is processed by {@link poll}.
+     *
+     * @param voice     The voice to query
+     *
+     * @return true if the given voice has a sound cued to follow.
+     */
+    bool isCued(Uint32 voice) const { return _cues[voice] != 0; }
+
+    /**
+     * Stops the given voice.
+     *
+     * The voice will fade out over a short ramp.  A completion notice will
+     * be sent when the voice stops.
+     *
+     * @param voice     The voice to stop
+     */
+    void stop(Uint32 voice);
+
+    /**
+     * Stops the given voice after the given number of frames.
+     *
+     * @param voice     The voice to stop
+     * @param frames    The number of frames until the voice stops
+     */
+    void expire(Uint32 voice, Uint64 frames);
+
+    /**
+     * Fades out the given voice over the given number of frames.
+     *
+     * The voice stops when the fade completes, and sends a (manual)
+     * completion notice.  Any cued sound is discarded.
+     *
+     * @param voice     The voice to fade out
+     * @param frames    The number of frames to fade
+     */
+    void fadeOut(Uint32 voice, Uint32 frames);
+
+    /**
+     * Pauses the given voice.
+     *
+     * @param voice     The voice to pause
+     */
+    void pause(Uint32 voice);
+
+    /**
+     * Resumes the given voice.
+     *
+     * @param voice     The voice to resume
+     */
+    void resume(Uint32 voice);
+
+    /**
+     * Sets the volume of the given voice.
+     *
+     * The volume change is applied with a short ramp.
+     *
+     * @param voice     The voice to adjust
+     * @param volume    The volume (0 to 1)
+     */
+    void setVolume(Uint32 voice, float volume);
+
+    /**
+     * Sets whether the given voice loops.
+     *
+     * @param voice     The voice to adjust
+     * @param loop      Whether the voice loops
+     */
+    void setLoop(Uint32 voice, bool loop);
+
+    /**
+     * Sets the frame position of the given voice.
+     *
+     * If the voice is audible, the old and new positions are crossfaded.
+     * Stream voices fade out and back in instead.
+     *
+     * @param voice     The voice to adjust
+     * @param frame     The new frame position
+     */
+    void setFrame(Uint32 voice, Uint64 frame);
+
+    /**
+     * Returns the frame position of the given voice.
+     *
+     * @param voice     The voice to query
+     *
+     * @return the frame position of the given voice.
+     */
+    Uint64 getFrame(Uint32 voice) const;
+
+#pragma mark Positional Audio (Main Thread)
+    /**
+     * Attaches a 2D emitter to the given voice.
+     *
+     * The gain and pan of the voice will be computed from the position of
+     * the emitter relative to the listener.  The reference distance is the
+     * distance at which the attenuation is 1, while the maximum distance is
+     * the distance beyond which there is no further attenuation.  The rolloff
+     * scales the rate of attenuation.
+     *
+     * The emitter belongs to the voice, and so it applies to all sounds that
+     * are played on the voice until it is cleared.
+     *
+     * @param voice     The voice to adjust
+     * @param position  The emitter position
+     * @param velocity  The emitter velocity (for doppler)
+     * @param reference The reference distance
+     * @param maximum   The maximum distance
+     * @param rolloff   The rolloff factor
+     */
+    void setEmitter(Uint32 voice, const Vec2& position, const Vec2& velocity,
+                    float reference, float maximum, float rolloff);
+
+    /**
+     * Removes the emitter from the given voice.
+     *
+     * The voice will return to an unattenuated, centered pan.
+     *
+     * @param voice     The voice to adjust
+     */
+    void clearEmitter(Uint32 voice);
+
+    /**
+     * Sets the position and velocity of the listener.
+     *
+     * @param position  The listener position
+     * @param velocity  The listener velocity (for doppler)
+     */
+    void setListener(const Vec2& position, const Vec2& velocity);
+
+    /**
+     * Sets the distance attenuation model for all emitters.
+     *
+     * @param model     The distance attenuation model
+     */
+    void setDistanceModel(AudioEngine::DistanceModel model);
+
+    /**
+     * Sets the doppler parameters for all emitters.
+     *
+     * A factor of 0 disables doppler.  The speed of sound should be in the
+     * same units as the emitter velocities.
+     *
+     * @param factor    The doppler factor
+     * @param speed     The speed of sound
+     */
+    void setDoppler(float factor, float speed);
+
+    /**
+     * Returns true if the given voice is playing (or paused).
+     *
+     * This is the state as seen by the main thread.  A voice remains playing
+     * until its completion notice is processed by {@link poll}.
+     *
+     * @param voice     The voice to query
+     *
+     * @return true if the given voice is playing (or paused).
+     */
+    bool isPlaying(Uint32 voice) const { return _playing[voice]; }
+
+    /**
+     * Returns true if the given voice is paused.
+     *
+     * @param voice     The voice to query
+     *
+     * @return true if the given voice is paused.
+     */
+    bool isPaused(Uint32 voice) const { return _playing[voice] && _paused[voice]; }
+
+    /**
+     * Processes all notices from the audio thread.
+     *
+     * The listener is called once for every sound that has completed since
+     * the last call, in order.  This method also releases any buffers that
+     * the audio thread is no longer using.
+     *
+     * @param listener  The callback for completed sounds
+     */
+    void poll(const Listener& listener);
+
+    /**
+     * Returns true if the notice being reported is for the current sound.
+     *
+     * This method is only meaningful inside of a listener called by
+     * {@link poll}.  A notice is not current if its sound was replaced by a
+     * later call to {@link play} before the notice was processed.  A sound
+     * that was followed by a cued sound is still current.
+     *
+     * @return true if the notice being reported is for the current sound.
+     */
+    bool isNoticeCurrent() const { return _current; }
+
+#pragma mark Bus Graph
+    /**
+     * Returns the number of buses in this mixer.
+     *
+     * @return the number of buses in this mixer.
+     */
+    Uint32 getBusCount() const;
+
+    /**
+     * Returns the bus with the given index.
+     *
+     * The indices of the standard buses are the constants of {@link AudioBus}.
+     * If there is no such bus, this method returns nullptr.
+     *
+     * @param index     The bus index
+     *
+     * @return the bus with the given index.
+     */
+    std::shared_ptr<AudioBus> getBus(Uint32 index) const;
+
+    /**
+     * Returns the bus with the given name.
+     *
+     * If there is no such bus, this method returns nullptr.
+     *
+     * @param name      The bus name
+     *
+     * @return the bus with the given name.
+     */
+    std::shared_ptr<AudioBus> getBus(const std::string& name) const;
+
+    /**
+     * Returns a newly created bus that mixes into the given parent.
+     *
+     * Buses can never be removed, so this is intended for initialization.
+     * If the parent does not exist, or the mixer already has
+     * {@link MIXER_MAX_BUSES} buses, this method returns nullptr.
+     *
+     * @param name      The bus name
+     * @param parent    The index of the parent bus
+     *
+     * @return a newly created bus that mixes into the given parent.
+     */
+    std::shared_ptr<AudioBus> addBus(const std::string& name, Uint32 parent);
+
+    /**
+     * Routes the given voice to a bus.
+     *
+     * The bus belongs to the voice, and so it applies to all sounds that
+     * are played on the voice until it is changed.
+     *
+     * @param voice     The voice to adjust
+     * @param bus       The bus index
+     */
+    void setBus(Uint32 voice, Uint32 bus);
+
+    /**
+     * Routes the output buffer through the given bus.
+     *
+     * When an input bus is set, the {@link mix} methods no longer add to the
+     * output buffer.  Instead, the existing contents are mixed into the input
+     * bus (as if they were a voice), and the result of the bus graph replaces
+     * the contents of the buffer.
+     *
+     * @param bus       The bus index
+     */
+    void setInput(Uint32 bus);
+
+    /**
+     * Restores the mixer to adding directly to the output buffer.
+     */
+    void clearInput();
+
+#pragma mark Mixing (Audio Thread)
+    /**
+     * Mixes the given number of frames into the output buffer.
+     *
+     * The output is interleaved stereo floats.  The result is added to the
+     * existing contents of the buffer, so it should be cleared beforehand
+     * if necessary.
+     *
+     * @param output    The output buffer
+     * @param frames    The number of frames to mix
+     */
+    void mix(float* output, Uint32 frames);
+
+    /**
+     * Mixes the given number of frames into the output buffer.
+     *
+     * The output is interleaved 16-bit integers with the given number of
+     * channels (1 or 2).  The result is added to the existing contents of
+     * the buffer with saturation.
+     *
+     * @param output    The output buffer
+     * @param frames    The number of frames to mix
+     * @param channels  The number of output channels
+     */
+    void mix(Sint16* output, Uint32 frames, Uint32 channels);
+
+    /**
+     * Mixes the given number of frames into the output buffer.
+     *
+     * The output is interleaved floats with the given number of channels
+     * (1 or 2).  The result is added to the existing contents of the buffer.
+     *
+     * @param output    The output buffer
+     * @param frames    The number of frames to mix
+     * @param channels  The number of output channels
+     */
+    void mix(float* output, Uint32 frames, Uint32 channels);
+
+private:
+#pragma mark Internal Helpers
+    /**
+     * Sends a command to the audio thread.
+     *
+     * @param command   The command to send
+     */
+    void send(const Command& command);
+
+    /**
+     * Sends a notice to the main thread (audio thread).
+     *
+     * @param notice    The notice to send
+     */
+    void notify(const Notice& notice);
+
+    /**
+     * Processes all pending commands (audio thread).
+     *
+     * Commands are held back while the notice queue cannot hold every
+     * notice that the current sounds may still send.
+     */
+    void process();
+
+    /**
+     * Mixes a single block into the intermediate buffer (audio thread).
+     *
+     * If input is not nullptr, it is mixed into the input bus.
+     *
+     * @param frames    The number of frames (at most MIXER_BLOCK_FRAMES)
+     * @param input     The input block (interleaved stereo), or nullptr
+     */
+    void render(Uint32 frames, const float* input);
+
+    /**
+     * Returns true if the output buffer is routed through a bus.
+     *
+     * If so, the given chunk of the output buffer is converted to the
+     * input buffer and then cleared.
+     *
+     * @param output    The output chunk
+     * @param frames    The number of frames in the chunk
+     * @param channels  The number of output channels
+     * @param scale     The factor to convert an output sample to a float
+     *
+     * @return true if the output buffer is routed through a bus.
+     */
+    template <typename T>
+    bool capture(T* output, Uint32 frames, Uint32 channels, float scale);
+
+    /**
+     * Mixes the given voice into the buffer of its bus (audio thread).
+     *
+     * The offset is set to the number of frames of the block that the voice
+     * has mixed.  If the voice stops early, this is the frame where it stopped.
+     *
+     * @param voice     The voice to mix
+     * @param frames    The number of frames to mix
+     * @param offset    The offset to store the frames mixed
+     *
+     * @return true if the voice is still active afterwards
+     */
+    bool render(Voice& voice, Uint32 frames, Uint32& offset);
+
+    /**
+     * Mixes the given voice with a variable playback rate (audio thread).
+     *
+     * This is used for doppler, and is only supported for PCM buffers.  The
+     * method stops early if it reaches the end of a buffer that does not
+     * loop.  The gains are for the left and right channel respectively.
+     *
+     * @param voice     The voice to mix
+     * @param output    The output buffer (interleaved stereo)
+     * @param frames    The number of frames to mix
+     * @param gains     The gain of the first frame (left and right)
+     * @param steps     The per-frame gain increment (left and right)
+     *
+     * @return the number of frames mixed
+     */
+    Uint32 resample(Voice& voice, float* output, Uint32 frames, const float* gains, const float* steps);
+
+    /**
+     * Computes the pan gains and pitch of every emitter (audio thread).
+     */
+    void spatialize();
+
+    /**
+     * Begins a gain ramp on the given voice.
+     *
+     * @param voice     The voice to ramp
+     * @param target    The target gain
+     * @param frames    The length of the ramp
+     */
+    void ramp(Voice& voice, float target, Uint32 frames=MIXER_RAMP_FRAMES);
+
+    /**
+     * Starts the cued sound of the given voice (audio thread).
+     *
+     * The remainder of the current sound is moved to the tail pool, where
+     * it fades out in time with the fade in of the cued sound.
+     *
+     * @param voice     The voice to advance
+     * @param offset    The offset of the current frame within the block
+     */
+    void follow(Voice& voice, Uint32 offset);
+
+    /**
+     * Discards the cued sound of the given voice (audio thread).
+     *
+     * @param voice     The voice to adjust
+     */
+    void drop(Voice& voice);
+
+    /**
+     * Returns the length of the sound on the given voice in frames.
+     *
+     * @param voice     The voice to query
+     *
+     * @return the length of the sound on the given voice in frames.
+     */
+    Uint64 duration(const Voice& voice) const;
+
+    /**
+     * Stops the given voice, moving it to the tail pool (audio thread).
+     *
+     * The offset is the frame of the current block where the voice stopped,
+     * so that any fade out begins there.
+     *
+     * @param index     The voice index
+     * @param normal    Whether the voice completed normally
+     * @param offset    The offset of the current frame within the block
+     */
+    void halt(Uint32 index, bool normal, Uint32 offset=0);
+
+    /**
+     * Moves a copy of the voice to the tail pool to fade out.
+     *
+     * The delay is the number of frames of the current block that the voice
+     * has already mixed, so that the tail picks up where it left off.
+     *
+     * @param voice     The voice to copy
+     * @param frames    The length of the fade
+     * @param delay     The number of frames to wait before the fade
+     *
+     * @return true if there was room in the tail pool
+     */
+    bool fade(const Voice& voice, Uint32 frames=MIXER_RAMP_FRAMES, Uint32 delay=0);
+
+    /**
+     * Sends a release notice if no voice or tail still uses a play instance.
+     *
+     * @param owner     The voice index
+     * @param stamp     The play instance
+     */
+    void retire(Uint32 owner, Uint32 stamp);
+};
+
+}
+#endif /* __CU_SOUND_MIXER_H__ */
@@ -0,0 +1,817 @@
+//
+//  CUSoundStream.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides streaming sources for the software sound mixer.  A
+//  stream keeps its audio compressed, and decodes ahead of the play position
+//  into a small ring of chunks.  Decoding happens on a background thread (the
+//  stream service), so that the audio thread never touches the codec and never
+//  blocks.  This allows long sounds, such as ambient loops, to be played as
+//  sound effects without decompressing them entirely into memory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include "CUSoundStream.h"
+#include <cugl/util/CUDebug.h>
+#include <vorbis/vorbisfile.h>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+
+using namespace cugl;
+
+/** The number of milliseconds the decoder thread sleeps when idle */
+#define STREAM_IDLE_MILLIS  4
+
+#pragma mark -
+#pragma mark Vorbis Callbacks
+/**
+ * The codec state of a vorbis stream
+ *
+ * The read position is tracked here (and not in the shared asset) so that
+ * many instances may decode the same asset at once.
+ */
+typedef struct {
+    /** The vorbis decoder */
+    OggVorbis_File file;
+    /** The compressed asset */
+    const std::string* data;
+    /** The read position in the compressed asset */
+    size_t offset;
+    /** The logical bitstream of the last decode */
+    int bitstream;
+} VorbisState;
+
+/**
+ * Callback to read from a compressed asset in memory
+ *
+ * @param ptr       The output buffer
+ * @param size      The size of each element
+ * @param nmemb     The number of elements
+ * @param source    The codec state
+ *
+ * @return the number of elements read
+ */
+static size_t vorbis_read(void* ptr, size_t size, size_t nmemb, void* source) {
+    VorbisState* state = (VorbisState*)source;
+    if (size == 0) {
+        return 0;
+    }
+    size_t remain = state->data->size()-state->offset;
+    size_t amount = (nmemb*size < remain ? nmemb : remain/size);
+    std::memcpy(ptr,state->data->data()+state->offset,amount*size);
+    state->offset += amount*size;
+    return amount;
+}
+
+/**
+ * Callback to seek in a compressed asset in memory
+ *
+ * @param source    The codec state
+ * @param offset    The seek offset
+ * @param whence    The seek origin
+ *
+ * @return 0 if the seek was successful
+ */
+static int vorbis_seek(void* source, ogg_int64_t offset, int whence) {
+    VorbisState* state = (VorbisState*)source;
+    ogg_int64_t base = 0;
+    switch (whence) {
+        case SEEK_SET:
+            base = 0;
+            break;
+        case SEEK_CUR:
+            base = (ogg_int64_t)state->offset;
+            break;
+        case SEEK_END:
+            base = (ogg_int64_t)state->data->size();
+            break;
+        default:
+            return -1;
+    }
+    ogg_int64_t result = base+offset;
+    if (result < 0 || result > (ogg_int64_t)state->data->size()) {
+        return -1;
+    }
+    state->offset = (size_t)result;
+    return 0;
+}
+
+/**
+ * Callback to return the position in a compressed asset in memory
+ *
+ * @param source    The codec state
+ *
+ * @return the position in the compressed asset
+ */
+static long vorbis_tell(void* source) {
+    return (long)((VorbisState*)source)->offset;
+}
+
+/**
+ * Opens the vorbis decoder for the given codec state
+ *
+ * @param state     The codec state (with the data attribute set)
+ *
+ * @return true if the decoder was successfully opened
+ */
+static bool vorbis_open(VorbisState* state) {
+    ov_callbacks callbacks;
+    callbacks.read_func  = vorbis_read;
+    callbacks.seek_func  = vorbis_seek;
+    callbacks.close_func = nullptr;
+    callbacks.tell_func  = vorbis_tell;
+    state->offset = 0;
+    state->bitstream = 0;
+    return ov_open_callbacks(state,&(state->file),nullptr,0,callbacks) == 0;
+}
+
+
+#pragma mark -
+#pragma mark Sound Stream
+/**
+ * Creates an uninitialized stream.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors of a subclass instead.
+ */
+SoundStream::SoundStream() :
+_channels(0),
+_frames(0),
+_rate(0),
+_raw(nullptr),
+_data(nullptr),
+_request(0),
+_target(0),
+_underruns(0),
+_position(0),
+_decoded(0),
+_current(0),
+_front(STREAM_CHUNK_COUNT),
+_offset(0) {
+    std::memset(_epochs,0,sizeof(_epochs));
+    std::memset(_starts,0,sizeof(_starts));
+    std::memset(_counts,0,sizeof(_counts));
+}
+
+/**
+ * Initializes the decode buffers, priming them at the given audio frame.
+ *
+ * Subclasses should call this method once the codec is open and the
+ * attributes {@link _channels}, {@link _frames}, and {@link _rate} are
+ * set.  This method decodes the first few chunks synchronously, so that
+ * playback may start immediately.
+ *
+ * @param frame     The audio frame to start playback
+ *
+ * @return true if initialization was successful.
+ */
+bool SoundStream::initBuffers(Uint64 frame) {
+    if (_raw != nullptr) {
+        CUAssertLog(false, "Sound stream is already initialized");
+        return false;
+    } else if (_channels < 1 || _channels > 2 || _frames == 0) {
+        CUAssertLog(false, "Sound streams must be non-empty mono or stereo");
+        return false;
+    }
+
+    size_t size = STREAM_CHUNK_COUNT*STREAM_CHUNK_FRAMES*_channels*sizeof(float);
+    _raw = malloc(size+15);
+    if (_raw == nullptr) {
+        return false;
+    }
+    _data = (float*)(((uintptr_t)_raw+15) & ~(uintptr_t)15);
+    _filled.init(STREAM_CHUNK_COUNT);
+    _empty.init(STREAM_CHUNK_COUNT);
+    for(Uint32 ii = 0; ii < STREAM_CHUNK_COUNT; ii++) {
+        _empty.push(ii);
+    }
+
+    // Match the mixer, which restarts out of range positions
+    _position = frame < _frames ? frame : 0;
+    if (_position != 0 && !reposition(_position)) {
+        return false;
+    }
+
+    // No other thread has access yet, so we can prime directly
+    Uint32 index;
+    for(Uint32 ii = 0; ii < STREAM_PRIME_COUNT && _empty.pop(index); ii++) {
+        decodeChunk(index);
+        _filled.push(index);
+    }
+    return true;
+}
+
+/**
+ * Releases the decode buffers.
+ */
+void SoundStream::disposeBuffers() {
+    if (_raw != nullptr) {
+        free(_raw);
+        _raw = nullptr;
+    }
+    _data = nullptr;
+    _filled.dispose();
+    _empty.dispose();
+    _front = STREAM_CHUNK_COUNT;
+    _offset = 0;
+}
+
+/**
+ * Returns the number of bytes used by this stream instance.
+ *
+ * This includes the decode buffers, but not any data shared with other
+ * instances (such as the compressed asset).
+ *
+ * @return the number of bytes used by this stream instance.
+ */
+size_t SoundStream::getMemoryUsage() const {
+    size_t result = sizeof(SoundStream);
+    if (_raw != nullptr) {
+        result += STREAM_CHUNK_COUNT*STREAM_CHUNK_FRAMES*_channels*sizeof(float)+15;
+        result += 2*STREAM_CHUNK_COUNT*sizeof(Uint32);
+    }
+    return result;
+}
+
+/**
+ * Decodes audio into any consumed chunks.
+ *
+ * This method also performs any pending seek request.
+ *
+ * @return true if any work was performed
+ */
+bool SoundStream::fill() {
+    bool work = false;
+    Uint32 request = _request.load(std::memory_order_acquire);
+    if (request != _decoded) {
+        Uint64 target = _target.load(std::memory_order_relaxed);
+        _position = target < _frames ? target : 0;
+        reposition(_position);
+        _decoded = request;
+        work = true;
+    }
+
+    // Stop early if a new seek makes this work obsolete
+    Uint32 index;
+    while (_request.load(std::memory_order_acquire) == _decoded && _empty.pop(index)) {
+        decodeChunk(index);
+        _filled.push(index);
+        work = true;
+    }
+    return work;
+}
+
+/**
+ * Decodes the next chunk of audio into the given chunk slot.
+ *
+ * If the decoder is at the end of the asset, it wraps around to the
+ * beginning first.  A chunk never straddles the end of the asset.
+ *
+ * @param index     The chunk slot
+ */
+void SoundStream::decodeChunk(Uint32 index) {
+    if (_position >= _frames) {
+        reposition(0);
+        _position = 0;
+    }
+
+    float* output = _data+index*STREAM_CHUNK_FRAMES*_channels;
+    Uint32 want = STREAM_CHUNK_FRAMES;
+    if (_frames-_position < want) {
+        want = (Uint32)(_frames-_position);
+    }
+
+    Uint32 count = 0;
+    while (count < want) {
+        Uint32 amount = decode(output+count*_channels,want-count);
+        if (amount == 0) {
+            // Truncated asset; pad with silence so that positions stay exact
+            std::memset(output+count*_channels,0,(want-count)*_channels*sizeof(float));
+            amount = want-count;
+        }
+        count += amount;
+    }
+
+    _epochs[index] = _decoded;
+    _starts[index] = _position;
+    _counts[index] = count;
+    _position += count;
+}
+
+/**
+ * Returns the decoded audio at the current play position.
+ *
+ * The data pointer is set to interleaved floats, and the number of
+ * contiguous frames available is returned.  If no audio is decoded
+ * yet, this method returns 0 and records an underrun.
+ *
+ * @param data      Pointer to store the decoded audio
+ *
+ * @return the number of contiguous frames available
+ */
+Uint32 SoundStream::acquire(const float** data) {
+    while (true) {
+        if (_front == STREAM_CHUNK_COUNT) {
+            Uint32 index;
+            if (!_filled.pop(index)) {
+                _underruns.fetch_add(1,std::memory_order_relaxed);
+                return 0;
+            }
+            _front  = index;
+            _offset = 0;
+        }
+
+        // Discard audio decoded before the last seek
+        if (_epochs[_front] != _current || _offset >= _counts[_front]) {
+            release();
+            continue;
+        }
+
+        *data = _data+(_front*STREAM_CHUNK_FRAMES+_offset)*_channels;
+        return _counts[_front]-_offset;
+    }
+}
+
+/**
+ * Advances the play position by the given number of frames.
+ *
+ * The number of frames should not exceed the value of the last call to
+ * {@link acquire}.
+ *
+ * @param frames    The number of frames to advance
+ */
+void SoundStream::consume(Uint32 frames) {
+    if (_front == STREAM_CHUNK_COUNT) {
+        return;
+    }
+    _offset += frames;
+    if (_offset >= _counts[_front]) {
+        release();
+    }
+}
+
+/**
+ * Requests that decoding restart at the given audio frame.
+ *
+ * All audio decoded before the request is discarded.  The audio will be
+ * unavailable until the decoder thread performs the seek.
+ *
+ * @param frame     The audio frame to restart at
+ */
+void SoundStream::seek(Uint64 frame) {
+    release();
+    _current++;
+    _target.store(frame,std::memory_order_relaxed);
+    _request.store(_current,std::memory_order_release);
+}
+
+/**
+ * Returns the current chunk to the decoder (audio thread).
+ */
+void SoundStream::release() {
+    if (_front != STREAM_CHUNK_COUNT) {
+        _empty.push(_front);
+        _front  = STREAM_CHUNK_COUNT;
+        _offset = 0;
+    }
+}
+
+
+#pragma mark -
+#pragma mark Vorbis Stream
+/**
+ * Disposes this stream, releasing all resources.
+ */
+void VorbisStream::dispose() {
+    if (_vorbis != nullptr) {
+        VorbisState* state = (VorbisState*)_vorbis;
+        ov_clear(&(state->file));
+        delete state;
+        _vorbis = nullptr;
+    }
+    _source = nullptr;
+    disposeBuffers();
+}
+
+/**
+ * Initializes a stream for the given compressed asset.
+ *
+ * The stream is primed to start playback at the given audio frame.
+ *
+ * @param source    The compressed asset
+ * @param frame     The audio frame to start playback
+ *
+ * @return true if initialization was successful.
+ */
+bool VorbisStream::init(const std::shared_ptr<std::string>& source, Uint64 frame) {
+    if (_vorbis != nullptr) {
+        CUAssertLog(false, "Vorbis stream is already initialized");
+        return false;
+    } else if (source == nullptr) {
+        return false;
+    }
+
+    VorbisState* state = new VorbisState();
+    state->data = source.get();
+    if (!vorbis_open(state)) {
+        delete state;
+        return false;
+    }
+
+    vorbis_info* info = ov_info(&(state->file),-1);
+    ogg_int64_t total = ov_pcm_total(&(state->file),-1);
+    if (info == nullptr || total <= 0 || info->channels < 1 || info->channels > 2) {
+        ov_clear(&(state->file));
+        delete state;
+        return false;
+    }
+
+    _source   = source;
+    _vorbis   = state;
+    _channels = (Uint32)info->channels;
+    _rate     = (Uint32)info->rate;
+    _frames   = (Uint64)total;
+    if (!initBuffers(frame)) {
+        dispose();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads the format of a compressed asset without decoding it.
+ *
+ * @param source    The compressed asset
+ * @param channels  Pointer to store the number of channels
+ * @param frames    Pointer to store the number of audio frames
+ * @param rate      Pointer to store the sample rate
+ *
+ * @return true if the asset is a valid Ogg Vorbis file
+ */
+bool VorbisStream::probe(const std::shared_ptr<std::string>& source,
+                         Uint32* channels, Uint64* frames, Uint32* rate) {
+    if (source == nullptr) {
+        return false;
+    }
+    VorbisState state;
+    state.data = source.get();
+    if (!vorbis_open(&state)) {
+        return false;
+    }
+
+    vorbis_info* info = ov_info(&(state.file),-1);
+    ogg_int64_t total = ov_pcm_total(&(state.file),-1);
+    bool result = info != nullptr && total > 0;
+    if (result) {
+        *channels = (Uint32)info->channels;
+        *frames   = (Uint64)total;
+        *rate     = (Uint32)info->rate;
+    }
+    ov_clear(&(state.file));
+    return result;
+}
+
+/**
+ * Returns the compressed asset for the given file.
+ *
+ * @param file  The path (absolute or relative) for the asset
+ *
+ * @return the compressed asset for the given file (or nullptr)
+ */
+std::shared_ptr<std::string> VorbisStream::load(const char* file) {
+    SDL_RWops* stream = SDL_RWFromFile(file,"rb");
+    if (stream == nullptr) {
+        return nullptr;
+    }
+
+    Sint64 size = SDL_RWsize(stream);
+    std::shared_ptr<std::string> result = nullptr;
+    if (size > 0) {
+        result = std::make_shared<std::string>();
+        result->resize((size_t)size);
+        if (SDL_RWread(stream,&((*result)[0]),1,(size_t)size) != (size_t)size) {
+            result = nullptr;
+        }
+    }
+    SDL_RWclose(stream);
+    return result;
+}
+
+/**
+ * Decodes an entire compressed asset into the given buffer.
+ *
+ * The output is interleaved at the native format of the asset, as
+ * reported by {@link probe}.  The buffer must have room for the given
+ * number of frames.  This method is used to decode sounds that are too
+ * small to stream, and may be called from any thread.
+ *
+ * @param source    The compressed asset
+ * @param output    The output buffer
+ * @param frames    The capacity of the output buffer in frames
+ *
+ * @return the number of frames decoded
+ */
+Uint64 VorbisStream::decompress(const std::shared_ptr<std::string>& source, float* output, Uint64 frames) {
+    if (source == nullptr) {
+        return 0;
+    }
+    VorbisState state;
+    state.data = source.get();
+    if (!vorbis_open(&state)) {
+        return 0;
+    }
+    
+    vorbis_info* info = ov_info(&(state.file),-1);
+    int chans = (info == nullptr ? 0 : info->channels);
+    Uint64 total = 0;
+    while (chans >= 1 && chans <= 2 && total < frames) {
+        float** pcm = nullptr;
+        Uint64 want = frames-total;
+        long amount = ov_read_float(&(state.file),&pcm,(int)(want < 4096 ? want : 4096),&(state.bitstream));
+        if (amount == OV_HOLE) {
+            continue;
+        } else if (amount <= 0) {
+            break;
+        }
+        
+        float* dst = output+total*chans;
+        if (chans == 2) {
+            for(long ii = 0; ii < amount; ii++) {
+                dst[2*ii  ] = pcm[0][ii];
+                dst[2*ii+1] = pcm[1][ii];
+            }
+        } else {
+            std::memcpy(dst,pcm[0],amount*sizeof(float));
+        }
+        total += amount;
+    }
+    ov_clear(&(state.file));
+    return total;
+}
+
+/**
+ * Returns the number of bytes used by this stream instance.
+ *
+ * This includes the decode buffers and the codec state, but not the
+ * shared compressed asset.
+ *
+ * @return the number of bytes used by this stream instance.
+ */
+size_t VorbisStream::getMemoryUsage() const {
+    size_t result = SoundStream::getMemoryUsage()+sizeof(VorbisStream)-sizeof(SoundStream);
+    if (_vorbis != nullptr) {
+        // The decoder tables are allocated internally; this is a lower bound
+        result += sizeof(VorbisState);
+    }
+    return result;
+}
+
+/**
+ * Decodes audio frames from the current position of the codec.
+ *
+ * @param output    The output buffer
+ * @param frames    The maximum number of frames to decode
+ *
+ * @return the number of frames decoded
+ */
+Uint32 VorbisStream::decode(float* output, Uint32 frames) {
+    VorbisState* state = (VorbisState*)_vorbis;
+    float** pcm = nullptr;
+    long amount = ov_read_float(&(state->file),&pcm,(int)frames,&(state->bitstream));
+    while (amount == OV_HOLE) {
+        // Holes are recoverable; keep reading
+        amount = ov_read_float(&(state->file),&pcm,(int)frames,&(state->bitstream));
+    }
+    if (amount <= 0) {
+        return 0;
+    }
+
+    if (_channels == 2) {
+        const float* left  = pcm[0];
+        const float* right = pcm[1];
+        for(long ii = 0; ii < amount; ii++) {
+            output[2*ii  ] = left[ii];
+            output[2*ii+1] = right[ii];
+        }
+    } else {
+        std::memcpy(output,pcm[0],amount*sizeof(float));
+    }
+    return (Uint32)amount;
+}
+
+/**
+ * Moves the codec to the given audio frame.
+ *
+ * @param frame     The audio frame to move to
+ *
+ * @return true if the codec was successfully moved
+ */
+bool VorbisStream::reposition(Uint64 frame) {
+    VorbisState* state = (VorbisState*)_vorbis;
+    return ov_pcm_seek(&(state->file),(ogg_int64_t)frame) == 0;
+}
+
+
+#pragma mark -
+#pragma mark Stream Service
+/**
+ * Creates an inactive stream service.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+StreamService::StreamService() :
+#ifdef CU_SDL_THREADS
+_thread(nullptr),
+#endif
+_stop(false),
+_active(false),
+_inline(false) {
+}
+
+/**
+ * Stops the decoder thread and releases all streams.
+ */
+void StreamService::dispose() {
+    if (_active) {
+        {
+            std::unique_lock<std::mutex> lk(_mutex);
+            _stop = true;
+            _condition.notify_all();
+        }
+#ifdef CU_SDL_THREADS
+        int status;
+        SDL_WaitThread(_thread,&status);
+        _thread = nullptr;
+#else
+        _thread.join();
+#endif
+        _active = false;
+    }
+    _streams.clear();
+    _stop = false;
+    _inline = false;
+}
+
+/**
+ * Initializes the service, starting the decoder thread.
+ *
+ * If threaded is false, no thread is started, and the streams are
+ * only decoded when {@link pump} is called.
+ *
+ * @param threaded  Whether to decode on a background thread
+ *
+ * @return true if initialization was successful.
+ */
+bool StreamService::init(bool threaded) {
+    if (_active || _inline) {
+        CUAssertLog(false, "Stream service is already initialized");
+        return false;
+    }
+    _stop = false;
+    if (!threaded) {
+        _inline = true;
+        return true;
+    }
+#ifdef CU_SDL_THREADS
+    _thread = SDL_CreateThread(StreamService::sdlThreadFunc,"Audio Streams",(void*)this);
+    if (_thread == nullptr) {
+        return false;
+    }
+#else
+    _thread = std::thread(std::bind(&StreamService::run, this));
+#endif
+    _active = true;
+    return true;
+}
+
+/**
+ * Registers a stream with this service.
+ *
+ * @param stream    The stream to decode
+ */
+void StreamService::add(const std::shared_ptr<SoundStream>& stream) {
+    std::unique_lock<std::mutex> lk(_mutex);
+    _streams.push_back(stream);
+    _condition.notify_one();
+}
+
+/**
+ * Returns the number of streams registered with this service.
+ *
+ * Streams that have been released, but not yet purged by the decoder
+ * thread, are included in this count.
+ *
+ * @return the number of streams registered with this service.
+ */
+size_t StreamService::size() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    return _streams.size();
+}
+
+/**
+ * Decodes all registered streams on the calling thread.
+ *
+ * This method purges any released streams, and fills every consumed
+ * chunk of the others.  It may only be called on a service without a
+ * decoder thread, and it should be called on the same thread as the
+ * mixer.
+ */
+void StreamService::pump() {
+    CUAssertLog(_inline, "Stream service is decoded by its own thread");
+    std::unique_lock<std::mutex> lk(_mutex);
+    for(auto it = _streams.begin(); it != _streams.end(); ) {
+        std::shared_ptr<SoundStream> stream = it->lock();
+        if (stream == nullptr) {
+            it = _streams.erase(it);
+        } else {
+            stream->fill();
+            ++it;
+        }
+    }
+}
+
+/**
+ * The body function of the decoder thread.
+ */
+void StreamService::run() {
+    std::vector<std::shared_ptr<SoundStream>> active;
+    while (true) {
+        {   // Purge released streams and take references to the rest
+            std::unique_lock<std::mutex> lk(_mutex);
+            if (_stop) {
+                break;
+            }
+            active.clear();
+            for(auto it = _streams.begin(); it != _streams.end(); ) {
+                std::shared_ptr<SoundStream> stream = it->lock();
+                if (stream == nullptr) {
+                    it = _streams.erase(it);
+                } else {
+                    active.push_back(stream);
+                    ++it;
+                }
+            }
+        }
+
+        bool work = false;
+        for(auto it = active.begin(); it != active.end(); ++it) {
+            work = (*it)->fill() || work;
+        }
+        active.clear();
+
+        // The audio thread cannot signal us, so poll while streams are active
+        if (!work) {
+            std::unique_lock<std::mutex> lk(_mutex);
+            if (_stop) {
+                break;
+            }
+            _condition.wait_for(lk,std::chrono::milliseconds(STREAM_IDLE_MILLIS));
+        }
+    }
+}
+
+/**
+ * The body function of the decoder thread (for SDL threads).
+ *
+ * @param ptr   The stream service
+ *
+ * @return the thread status
+ */
+int StreamService::sdlThreadFunc(void* ptr) {
+    ((StreamService*)ptr)->run();
+    return 0;
+}
@@ -0,0 +1,552 @@
+//
+//  CUSoundStream.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides streaming sources for the software sound mixer.  A
+//  stream keeps its audio compressed, and decodes ahead of the play position
+//  into a small ring of chunks.  Decoding happens on a background thread (the
+//  stream service), so that the audio thread never touches the codec and never
+//  blocks.  This allows long sounds, such as ambient loops, to be played as
+//  sound effects without decompressing them entirely into memory.
+//
+//  Streams are sample accurate.  The decoder wraps around at the end of the
+//  file, so loops are seamless, and seeks are performed on exact audio frames.
+//
+//  This file is an internal header.  It is not accessible by general users
+//  of the CUGL API.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_SOUND_STREAM_H__
+#define __CU_SOUND_STREAM_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/util/CURingBuffer.h>
+#include <cugl/util/CUThreadPool.h>
+#include <condition_variable>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+
+/** The number of audio frames in a single decoded chunk */
+#define STREAM_CHUNK_FRAMES 2048
+/** The number of decoded chunks buffered ahead of the play position */
+#define STREAM_CHUNK_COUNT  8
+/** The number of chunks decoded synchronously before playback begins */
+#define STREAM_PRIME_COUNT  2
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Sound Stream
+/**
+ * An abstract streaming source for the software sound mixer.
+ *
+ * A sound stream is a single playback instance of a compressed asset.  It
+ * decodes ahead of the play position into a fixed ring of chunks.  The
+ * methods of this class are split between three threads.  The constructors
+ * are called on the main thread.  The {@link fill} method is only called by
+ * the decoder thread (see {@link StreamService}).  The methods {@link acquire},
+ * {@link consume}, and {@link seek} are only called by the audio thread.
+ * None of the audio thread methods block or allocate memory.
+ *
+ * The decoder wraps around to the beginning of the asset when it reaches the
+ * end, whether or not the sound is looping.  This makes looping seamless, and
+ * allows the loop setting to change at any time.  The mixer is responsible
+ * for discarding the wrapped audio if the sound does not loop.
+ *
+ * Subclasses implement the codec with the methods {@link decode} and
+ * {@link reposition}.  These methods are only called by one thread at a time.
+ */
+class SoundStream {
+protected:
+    /** The number of channels (1 or 2) */
+    Uint32 _channels;
+    /** The number of audio frames in the asset */
+    Uint64 _frames;
+    /** The sample rate in HZ */
+    Uint32 _rate;
+
+private:
+    /** The raw (unaligned) allocation for the chunks */
+    void*  _raw;
+    /** The aligned sample data for all the chunks */
+    float* _data;
+    /** The seek epoch of each chunk */
+    Uint32 _epochs[STREAM_CHUNK_COUNT];
+    /** The starting audio frame of each chunk */
+    Uint64 _starts[STREAM_CHUNK_COUNT];
+    /** The number of audio frames in each chunk */
+    Uint32 _counts[STREAM_CHUNK_COUNT];
+
+    /** The decoded chunks (decoder to audio thread) */
+    RingBuffer<Uint32> _filled;
+    /** The consumed chunks (audio to decoder thread) */
+    RingBuffer<Uint32> _empty;
+
+    /** The most recent seek request (audio to decoder thread) */
+    std::atomic<Uint32> _request;
+    /** The target frame of the most recent seek request */
+    std::atomic<Uint64> _target;
+    /** The number of times the audio thread ran out of decoded audio */
+    std::atomic<Uint32> _underruns;
+
+    // Decoder thread state
+    /** The next audio frame to decode */
+    Uint64 _position;
+    /** The seek epoch of the decoder */
+    Uint32 _decoded;
+
+    // Audio thread state
+    /** The seek epoch of the audio thread */
+    Uint32 _current;
+    /** The chunk currently being read (or STREAM_CHUNK_COUNT if none) */
+    Uint32 _front;
+    /** The read offset into the current chunk */
+    Uint32 _offset;
+
+#pragma mark Internal Helpers
+    /**
+     * Decodes the next chunk of audio into the given chunk slot.
+     *
+     * If the decoder is at the end of the asset, it wraps around to the
+     * beginning first.  A chunk never straddles the end of the asset.
+     *
+     * @param index     The chunk slot
+     */
+    void decodeChunk(Uint32 index);
+
+    /**
+     * Returns the current chunk to the decoder (audio thread).
+     */
+    void release();
+
+protected:
+#pragma mark Codec Methods
+    /**
+     * Decodes audio frames from the current position of the codec.
+     *
+     * The frames should be written as interleaved floats.  The method may
+     * decode fewer frames than requested, but it should only return 0 if
+     * there is no more audio (or the asset is corrupt).
+     *
+     * @param output    The output buffer
+     * @param frames    The maximum number of frames to decode
+     *
+     * @return the number of frames decoded
+     */
+    virtual Uint32 decode(float* output, Uint32 frames) = 0;
+
+    /**
+     * Moves the codec to the given audio frame.
+     *
+     * The next call to {@link decode} should start exactly at this frame.
+     *
+     * @param frame     The audio frame to move to
+     *
+     * @return true if the codec was successfully moved
+     */
+    virtual bool reposition(Uint64 frame) = 0;
+
+    /**
+     * Initializes the decode buffers, priming them at the given audio frame.
+     *
+     * Subclasses should call this method once the codec is open and the
+     * attributes {@link _channels}, {@link _frames}, and {@link _rate} are
+     * set.  This method decodes the first few chunks synchronously, so that
+     * playback may start immediately.
+     *
+     * @param frame     The audio frame to start playback
+     *
+     * @return true if initialization was successful.
+     */
+    bool initBuffers(Uint64 frame);
+
+    /**
+     * Releases the decode buffers.
+     */
+    void disposeBuffers();
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized stream.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors of a subclass instead.
+     */
+    SoundStream();
+
+    /**
+     * Deletes this stream, releasing all resources.
+     */
+    virtual ~SoundStream() { disposeBuffers(); }
+
+#pragma mark Attributes
+    /** Returns the number of channels (1 or 2) */
+    Uint32 getChannels() const { return _channels; }
+
+    /** Returns the number of audio frames in the asset */
+    Uint64 getFrames() const { return _frames; }
+
+    /** Returns the sample rate in HZ */
+    Uint32 getRate() const { return _rate; }
+
+    /**
+     * Returns the number of times playback ran out of decoded audio.
+     *
+     * An underrun is heard as a short gap.  This value should stay 0 unless
+     * the decoder thread is starved of CPU.
+     *
+     * @return the number of times playback ran out of decoded audio.
+     */
+    Uint32 getUnderruns() const { return _underruns.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns the number of bytes used by this stream instance.
+     *
+     * This includes the decode buffers, but not any data shared with other
+     * instances (such as the compressed asset).
+     *
+     * @return the number of bytes used by this stream instance.
+     */
+    virtual size_t getMemoryUsage() const;
+
+#pragma mark Decoding (Decoder Thread)
+    /**
+     * Decodes audio into any consumed chunks.
+     *
+     * This method also performs any pending seek request.
+     *
+     * @return true if any work was performed
+     */
+    bool fill();
+
+#pragma mark Playback (Audio Thread)
+    /**
+     * Returns the decoded audio at the current play position.
+     *
+     * The data pointer is set to interleaved floats, and the number of
+     * contiguous frames available is returned.  If no audio is decoded
+     * yet, this method returns 0 and records an underrun.
+     *
+     * @param data      Pointer to store the decoded audio
+     *
+     * @return the number of contiguous frames available
+     */
+    Uint32 acquire(const float** data);
+
+    /**
+     * Advances the play position by the given number of frames.
+     *
+     * The number of frames should not exceed the value of the last call to
+     * {@link acquire}.
+     *
+     * @param frames    The number of frames to advance
+     */
+    void consume(Uint32 frames);
+
+    /**
+     * Requests that decoding restart at the given audio frame.
+     *
+     * All audio decoded before the request is discarded.  The audio will be
+     * unavailable until the decoder thread performs the seek.
+     *
+     * @param frame     The audio frame to restart at
+     */
+    void seek(Uint64 frame);
+};
+
+
+#pragma mark -
+#pragma mark Vorbis Stream
+/**
+ * A streaming source for Ogg Vorbis assets.
+ *
+ * The compressed asset is shared between all instances, which only differ
+ * in their decoder state.  The asset is never decompressed in its entirety.
+ */
+class VorbisStream : public SoundStream {
+private:
+    /** The compressed asset */
+    std::shared_ptr<std::string> _source;
+    /** The codec state (opaque to avoid exposing the vorbis headers) */
+    void* _vorbis;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized stream.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    VorbisStream() : _vorbis(nullptr) {}
+
+    /**
+     * Deletes this stream, releasing all resources.
+     */
+    ~VorbisStream() { dispose(); }
+
+    /**
+     * Disposes this stream, releasing all resources.
+     */
+    void dispose();
+
+    /**
+     * Initializes a stream for the given compressed asset.
+     *
+     * The stream is primed to start playback at the given audio frame.
+     *
+     * @param source    The compressed asset
+     * @param frame     The audio frame to start playback
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(const std::shared_ptr<std::string>& source, Uint64 frame=0);
+
+    /**
+     * Returns a newly allocated stream for the given compressed asset.
+     *
+     * The stream is primed to start playback at the given audio frame.
+     *
+     * @param source    The compressed asset
+     * @param frame     The audio frame to start playback
+     *
+     * @return a newly allocated stream for the given compressed asset.
+     */
+    static std::shared_ptr<VorbisStream> alloc(const std::shared_ptr<std::string>& source, Uint64 frame=0) {
+        std::shared_ptr<VorbisStream> result = std::make_shared<VorbisStream>();
+        return (result->init(source,frame) ? result : nullptr);
+    }
+
+    /**
+     * Reads the format of a compressed asset without decoding it.
+     *
+     * @param source    The compressed asset
+     * @param channels  Pointer to store the number of channels
+     * @param frames    Pointer to store the number of audio frames
+     * @param rate      Pointer to store the sample rate
+     *
+     * @return true if the asset is a valid Ogg Vorbis file
+     */
+    static bool probe(const std::shared_ptr<std::string>& source,
+                      Uint32* channels, Uint64* frames, Uint32* rate);
+
+    /**
+     * Returns the compressed asset for the given file.
+     *
+     * @param file  The path (absolute or relative) for the asset
+     *
+     * @return the compressed asset for the given file (or nullptr)
+     */
+    static std::shared_ptr<std::string> load(const char* file);
+
+    /**
+     * Decodes an entire compressed asset into the given buffer.
+     *
+     * The output is interleaved at the native format of the asset, as
+     * reported by {@link probe}.  The buffer must have room for the given
+     * number of frames.  This method is used to decode sounds that are too
+     * small to stream, and may be called from any thread.
+     *
+     * @param source    The compressed asset
+     * @param output    The output buffer
+     * @param frames    The capacity of the output buffer in frames
+     *
+     * @return the number of frames decoded
+     */
+    static Uint64 decompress(const std::shared_ptr<std::string>& source, float* output, Uint64 frames);
+
+#pragma mark Attributes
+    /**
+     * Returns the number of bytes used by this stream instance.
+     *
+     * This includes the decode buffers and the codec state, but not the
+     * shared compressed asset.
+     *
+     * @return the number of bytes used by this stream instance.
+     */
+    size_t getMemoryUsage() const override;
+
+protected:
+#pragma mark Codec Methods
+    /**
+     * Decodes audio frames from the current position of the codec.
+     *
+     * @param output    The output buffer
+     * @param frames    The maximum number of frames to decode
+     *
+     * @return the number of frames decoded
+     */
+    Uint32 decode(float* output, Uint32 frames) override;
+
+    /**
+     * Moves the codec to the given audio frame.
+     *
+     * @param frame     The audio frame to move to
+     *
+     * @return true if the codec was successfully moved
+     */
+    bool reposition(Uint64 frame) override;
+};
+
+
+#pragma mark -
+#pragma mark Stream Service
+/**
+ * A background thread that decodes all active sound streams.
+ *
+ * Streams are registered with the service when they are created.  The
+ * service only keeps a weak reference to each stream, so a stream is
+ * removed automatically once the mixer releases it.  The thread sleeps
+ * whenever there is nothing to decode.
+ *
+ * A service may also be created without a thread.  In that case, the
+ * streams are only decoded when {@link pump} is called.  This is how an
+ * offline engine keeps its output independent of thread timing.
+ */
+class StreamService {
+private:
+    /** The decoder thread */
+#ifdef CU_SDL_THREADS
+    SDL_Thread* _thread;
+#else
+    std::thread _thread;
+#endif
+    /** The registered streams */
+    std::vector<std::weak_ptr<SoundStream>> _streams;
+    /** The mutex for the registered streams */
+    std::mutex _mutex;
+    /** The condition variable to wake the decoder thread */
+    std::condition_variable _condition;
+    /** Whether the decoder thread should stop */
+    bool _stop;
+    /** Whether the decoder thread is running */
+    bool _active;
+    /** Whether the streams are decoded by {@link pump} instead of a thread */
+    bool _inline;
+
+    /**
+     * The body function of the decoder thread.
+     */
+    void run();
+
+    /**
+     * The body function of the decoder thread (for SDL threads).
+     *
+     * @param ptr   The stream service
+     *
+     * @return the thread status
+     */
+    static int sdlThreadFunc(void* ptr);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an inactive stream service.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    StreamService();
+
+    /**
+     * Deletes this service, stopping the decoder thread.
+     */
+    ~StreamService() { dispose(); }
+
+    /**
+     * Stops the decoder thread and releases all streams.
+     */
+    void dispose();
+
+    /**
+     * Initializes the service, starting the decoder thread.
+     *
+     * If threaded is false, no thread is started, and the streams are
+     * only decoded when {@link pump} is called.
+     *
+     * @param threaded  Whether to decode on a background thread
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(bool threaded=true);
+
+    /**
+     * Returns a newly allocated stream service.
+     *
+     * If threaded is false, no thread is started, and the streams are
+     * only decoded when {@link pump} is called.
+     *
+     * @param threaded  Whether to decode on a background thread
+     *
+     * @return a newly allocated stream service.
+     */
+    static std::shared_ptr<StreamService> alloc(bool threaded=true) {
+        std::shared_ptr<StreamService> result = std::make_shared<StreamService>();
+        return (result->init(threaded) ? result : nullptr);
+    }
+
+#pragma mark Stream Management
+    /**
+     * Registers a stream with this service.
+     *
+     * @param stream    The stream to decode
+     */
+    void add(const std::shared_ptr<SoundStream>& stream);
+
+    /**
+     * Returns the number of streams registered with this service.
+     *
+     * Streams that have been released, but not yet purged by the decoder
+     * thread, are included in this count.
+     *
+     * @return the number of streams registered with this service.
+     */
+    size_t size();
+
+    /**
+     * Decodes all registered streams on the calling thread.
+     *
+     * This method purges any released streams, and fills every consumed
+     * chunk of the others.  It may only be called on a service without a
+     * decoder thread, and it should be called on the same thread as the
+     * mixer.
+     */
+    void pump();
+};
+
+}
+#endif /* __CU_SOUND_STREAM_H__ */
@@ -39,6 +39,8 @@
 #include <cugl/audio/CUMusic.h>
 #include <cugl/util/CUDebug.h>
 #include <algorithm>
+#include <cstring>
+#include <cmath>
 #include <string>
 #include <mutex>
 
@@ -108,6 +110,12 @@ struct AudioChannel {
     bool looping;
     /** Whether or not the channel is active playing */
     bool playing;
+    /** The volume before distance attenuation */
+    float volume;
+    /** Whether this channel has a 2D emitter */
+    bool positional;
+    /** The emitter position, reference, maximum and rolloff */
+    float emitter[5];
 };
 
 /**
@@ -152,6 +160,12 @@ struct AudioPlayer {
     float  fadeVolume;
     /** The volume at the end of the fade */
     float  goalVolume;
+    /** The music file queued to follow the current one (or nil) */
+    id<AVAudioFileSource> cued;
+    /** Whether the queued music file loops */
+    bool cueLoop;
+    /** The volume of the queued music file */
+    float cueVolume;
     /** A mutex lock for thread safety */
     std::mutex lock;
 };
@@ -171,6 +185,12 @@ struct AudioMixer {
     AudioPlayer* background;
     std::vector<AudioChannel*> channels;
     std::shared_ptr<cugl::ThreadPool> processor;
+    /** The listener position */
+    float listener[2];
+    /** The distance attenuation model */
+    cugl::AudioEngine::DistanceModel model;
+    /** The bus graph (for API compatibility; AVFoundation does the mixing) */
+    std::vector<std::shared_ptr<cugl::AudioBus>> buses;
 };
     
 /** The pointer to the engine root */
@@ -226,6 +246,8 @@ void InternalBuildChannels(int input) {
         channel->channel = ii;
         channel->looping = false;
         channel->timeStamp = 0;
+        channel->volume = 1.0f;
+        channel->positional = false;
         
         // Add it to the mixer graph
         // No format for now.  May change format later.
@@ -256,6 +278,7 @@ void InternalBuildBackground() {
     player->firstOffset  = 0;
     player->secndOffset  = 0;
     player->fadeLength   = 0;
+    player->cued = nil;
     
     // Add it to the mixer graph
     // No format for now.  May change format later.
@@ -356,6 +379,13 @@ bool AudioStart(int frequency, int input, int output) {
     CUAssertLog(input < 64, "A bug with iOS 11 prevents us from supporting more than 64 channels");
 
     _engine = new AudioMixer();
+    _engine->listener[0] = 0;
+    _engine->listener[1] = 0;
+    _engine->model = cugl::AudioEngine::DistanceModel::INVERSE;
+    const char* names[] = { "master", "music", "sound", "voice" };
+    for(Uint32 ii = AudioBus::MASTER; ii <= AudioBus::VOICE; ii++) {
+        _engine->buses.push_back(AudioBus::alloc(names[ii],ii,AudioBus::MASTER,BUFFER_SIZE));
+    }
     _engine->mixer = [[AVAudioEngine alloc] init];
     if (_engine->mixer != nil) {
         NSError* error = nil;
@@ -411,6 +441,88 @@ void AudioStop() {
     }
 }
 
+/**
+ * Initializes the audio engine without an audio device.
+ *
+ * AVFoundation manual rendering requires a different graph than the one
+ * used by this engine, so offline rendering is not supported on Apple
+ * platforms.  This function always fails.
+ *
+ * @param frequency The default sampling frequency
+ * @param input     The number of sound effect channels
+ * @param output    The number of output channels
+ */
+bool AudioStartOffline(int frequency, int input, int output) {
+    CULogError("Offline audio rendering is not supported on this platform");
+    return false;
+}
+
+/**
+ * Returns the sample rate of the audio output
+ *
+ * @return the sample rate of the audio output
+ */
+Uint32 AudioGetSampleRate() {
+    if (_engine == nullptr) {
+        return 0;
+    }
+    return (Uint32)[_engine->mixer.outputNode outputFormatForBus:0].sampleRate;
+}
+
+/**
+ * Returns the number of audio output channels
+ *
+ * @return the number of audio output channels
+ */
+Uint32 AudioGetOutputChannels() {
+    if (_engine == nullptr) {
+        return 0;
+    }
+    return (Uint32)[_engine->mixer.outputNode outputFormatForBus:0].channelCount;
+}
+
+/**
+ * Renders the given number of frames of an offline engine
+ *
+ * Offline rendering is not supported on Apple platforms, so this function
+ * only clears the buffer.
+ *
+ * @param output    The output buffer
+ * @param frames    The number of frames to render
+ */
+void AudioRender(float* output, Uint32 frames) {
+    CUAssertLog(false, "Offline audio rendering is not supported on this platform");
+    std::memset(output, 0, frames*AUDIO_OUTPUT_CHANNELS*sizeof(float));
+}
+
+/**
+ * Returns the audio clock, in audio frames
+ *
+ * The audio clock is the sample time of the last render of the output
+ * node.  It is the time base for scheduled music.
+ *
+ * @return the audio clock, in audio frames
+ */
+Uint64 AudioGetClock() {
+    if (_engine == nullptr) {
+        return 0;
+    }
+    AVAudioTime* time = _engine->mixer.outputNode.lastRenderTime;
+    if (time == nil || !time.sampleTimeValid || time.sampleTime < 0) {
+        return 0;
+    }
+    return (Uint64)time.sampleTime;
+}
+
+/**
+ * Delivers any pending completion callbacks
+ *
+ * The completion callbacks on Apple platforms are delivered by the audio
+ * players themselves, so this function does nothing.
+ */
+void AudioPoll() {
+}
+
 
 #pragma mark -
 #pragma mark Sound Assets
@@ -496,11 +608,15 @@ AVAudioPCMBuffer* InternalAllocPCMSnippet(AVAudioPCMBuffer* buffer,
  * M4A, FLAC) is platform-dependent.  If the function cannot decode the
  * file, it will return nullptr.
  *
- * @param file  The path (absolute or relative) for the sound asset
+ * AVFoundation buffers are always decoded in full, so the threshold is
+ * ignored on this platform.
+ *
+ * @param file      The path (absolute or relative) for the sound asset
+ * @param threshold The decoded size in bytes above which to stream
  *
  * @return an in-memory PCM buffer for the given audio asset
  */
-AudioBuffer* AudioLoadBuffer(const char* file) {
+AudioBuffer* AudioLoadBuffer(const char* file, Uint64 threshold) {
     CUAssertLog(file, "No audio file specified");
     @autoreleasepool { // Always do this in Objective-C++ if in doubt
         NSURL* url;
@@ -592,6 +708,46 @@ double AudioGetBufferSampleRate(AudioBuffer* source) {
     return source->pcmb.format.sampleRate;
 }
 
+/**
+ * Returns true if the given buffer is streamed
+ *
+ * AVFoundation buffers are never streamed.
+ *
+ * @param source    The PCM buffer
+ *
+ * @return true if the given buffer is streamed
+ */
+bool AudioIsBufferStreaming(AudioBuffer* source) {
+    return false;
+}
+
+/**
+ * Returns the memory used by the given buffer in bytes
+ *
+ * This is the size of the decoded samples, in the float processing format
+ * of AVFoundation.
+ *
+ * @param source    The PCM buffer
+ *
+ * @return the memory used by the given buffer in bytes
+ */
+size_t AudioGetBufferMemory(AudioBuffer* source) {
+    return (size_t)source->pcmb.frameCapacity*source->pcmb.format.channelCount*sizeof(float);
+}
+
+/**
+ * Returns the number of buffers sharing the data of the given buffer
+ *
+ * AVFoundation buffers are never shared.
+ *
+ * @param source    The PCM buffer
+ *
+ * @return the number of buffers sharing the data of the given buffer
+ */
+Uint32 AudioGetBufferShares(AudioBuffer* source) {
+    return 1;
+}
+
 #pragma mark -
 #pragma mark Music Assets
 /**
@@ -925,6 +1081,47 @@ bool AudioChannelPaused(AudioChannel* player) {
     return !player->node.isPlaying && player->playing;
 }
 
+/**
+ * Applies the volume and 2D emitter of a sound channel to its player node
+ *
+ * AVAudioEngine has no batched spatialization that matches the SDL backend,
+ * so this computes the attenuation and pan of a single channel on the main
+ * thread.  The player node applies its own pan law.
+ *
+ * @param player    The sound channel
+ */
+void InternalSpatialize(AudioChannel* player) {
+    if (!player->positional) {
+        player->node.volume = player->volume;
+        player->node.pan = 0.0f;
+        return;
+    }
+    float dx = player->emitter[0]-_engine->listener[0];
+    float dy = player->emitter[1]-_engine->listener[1];
+    float dist = std::sqrt(dx*dx+dy*dy);
+    float ref  = player->emitter[2];
+    float maxd = player->emitter[3];
+    float roll = player->emitter[4];
+    float clamped = std::max(std::min(dist,maxd),ref);
+    float atten = 1.0f;
+    switch (_engine->model) {
+        case cugl::AudioEngine::DistanceModel::NONE:
+            break;
+        case cugl::AudioEngine::DistanceModel::INVERSE:
+            atten = ref/(ref+roll*(clamped-ref));
+            break;
+        case cugl::AudioEngine::DistanceModel::LINEAR:
+            atten = 1-roll*(clamped-ref)/std::max(maxd-ref,1e-6f);
+            atten = std::max(std::min(atten,1.0f),0.0f);
+            break;
+        case cugl::AudioEngine::DistanceModel::EXPONENTIAL:
+            atten = std::pow(clamped/ref,-roll);
+            break;
+    }
+    player->node.volume = player->volume*atten;
+    player->node.pan = dx/std::max(dist,ref);
+}
+
 /**
  * Sets the volume for this sound channel
  *
@@ -935,7 +1132,8 @@ bool AudioChannelPaused(AudioChannel* player) {
  * @param volume   The volume (0 to 1) to play the asset
  */
 void AudioSetChannelVolume(AudioChannel* player, float volume) {
-    player->node.volume = volume;
+    player->volume = volume;
+    InternalSpatialize(player);
 }
 
 /**
@@ -1018,6 +1216,151 @@ void AudioSetChannelFrame(AudioChannel* player, Uint64 frame) {
     }
 }
 
+/**
+ * Sets the 2D emitter for the given sound channel
+ *
+ * If positional is false, the channel returns to an unattenuated, centered
+ * pan and the remaining arguments are ignored.  Otherwise, the gain and pan
+ * of the channel are computed from the emitter relative to the listener.
+ * The emitter persists across sound assets until it is cleared.
+ *
+ * This platform does not support doppler, so the velocity is ignored.
+ *
+ * @param player        The sound channel
+ * @param positional    Whether the channel has an emitter
+ * @param x             The emitter x-coordinate
+ * @param y             The emitter y-coordinate
+ * @param vx            The emitter x-velocity (for doppler)
+ * @param vy            The emitter y-velocity (for doppler)
+ * @param reference     The reference distance
+ * @param maximum       The maximum distance
+ * @param rolloff       The rolloff factor
+ */
+void AudioSetChannelEmitter(AudioChannel* player, bool positional, float x, float y,
+                            float vx, float vy, float reference, float maximum, float rolloff) {
+    player->positional = positional;
+    if (positional) {
+        reference = std::max(reference,1e-6f);
+        player->emitter[0] = x;
+        player->emitter[1] = y;
+        player->emitter[2] = reference;
+        player->emitter[3] = std::max(maximum,reference);
+        player->emitter[4] = std::max(rolloff,0.0f);
+    }
+    InternalSpatialize(player);
+}
+
+/**
+ * Routes the given sound channel to a bus
+ *
+ * This platform mixes with AVFoundation, and does not process the bus
+ * graph.  Hence this function does nothing.
+ *
+ * @param player    The sound channel
+ * @param bus       The bus index
+ */
+void AudioSetChannelBus(AudioChannel* player, Uint32 bus) {
+    // Buses are not processed by AVAudioEngine
+}
+
+
+#pragma mark -
+#pragma mark Positional Audio
+/**
+ * Sets the position and velocity of the listener
+ *
+ * This platform does not support doppler, so the velocity is ignored.
+ * Moving the listener recomputes every positional channel.
+ *
+ * @param x     The listener x-coordinate
+ * @param y     The listener y-coordinate
+ * @param vx    The listener x-velocity (for doppler)
+ * @param vy    The listener y-velocity (for doppler)
+ */
+void AudioSetListener(float x, float y, float vx, float vy) {
+    _engine->listener[0] = x;
+    _engine->listener[1] = y;
+    for(auto it = _engine->channels.begin(); it != _engine->channels.end(); ++it) {
+        if ((*it)->positional) {
+            InternalSpatialize(*it);
+        }
+    }
+}
+
+/**
+ * Sets the distance attenuation model for all emitters
+ *
+ * @param model The distance attenuation model
+ */
+void AudioSetDistanceModel(cugl::AudioEngine::DistanceModel model) {
+    _engine->model = model;
+    for(auto it = _engine->channels.begin(); it != _engine->channels.end(); ++it) {
+        if ((*it)->positional) {
+            InternalSpatialize(*it);
+        }
+    }
+}
+
+/**
+ * Sets the doppler parameters for all emitters
+ *
+ * This platform cannot shift pitch, so this function does nothing.
+ *
+ * @param factor    The doppler factor
+ * @param speed     The speed of sound
+ */
+void AudioSetDoppler(float factor, float speed) {
+    // Not supported by AVAudioPlayerNode without a varispeed unit
+}
+
+
+#pragma mark -
+#pragma mark Audio Buses
+/**
+ * Returns the number of buses in the audio engine
+ *
+ * @return the number of buses in the audio engine
+ */
+Uint32 AudioGetBusCount() {
+    return (Uint32)_engine->buses.size();
+}
+
+/**
+ * Returns the bus with the given index
+ *
+ * If there is no such bus, this function returns nullptr.
+ *
+ * @param index The bus index
+ *
+ * @return the bus with the given index
+ */
+std::shared_ptr<cugl::AudioBus> AudioGetBus(Uint32 index) {
+    return index < _engine->buses.size() ? _engine->buses[index] : nullptr;
+}
+
+/**
+ * Returns a newly created bus that mixes into the given parent
+ *
+ * This platform does not process the bus graph, so the bus exists only
+ * so that the engine API behaves the same on all platforms.
+ *
+ * @param name      The bus name
+ * @param parent    The index of the parent bus
+ *
+ * @return a newly created bus that mixes into the given parent
+ */
+std::shared_ptr<cugl::AudioBus> AudioAddBus(const std::string& name, Uint32 parent) {
+    if (parent >= _engine->buses.size()) {
+        return nullptr;
+    }
+    Uint32 index = (Uint32)_engine->buses.size();
+    auto bus = AudioBus::alloc(name,index,parent,BUFFER_SIZE);
+    if (bus != nullptr) {
+        _engine->buses.push_back(bus);
+    }
+    return bus;
+}
+
     
 #pragma mark -
 #pragma mark Background Music
@@ -1064,6 +1407,24 @@ void InternalAdvanceBackground(AudioPlayer* player, Uint64 stamp) {
             if (remains == 0 && player->looping) {
                 player->file.framePosition = 0;
                 remains = (AVAudioFrameCount)player->file.length;
+            } else if (remains == 0 && player->cued != nil) {
+                // Switch files with no gap; pages do not overlap, so no crossfade
+                [player->file release];
+                player->file = player->cued;
+                player->cued = nil;
+                player->file.framePosition = 0;
+                player->readFrame  = 0;
+                player->looping    = player->cueLoop;
+                player->volume     = player->cueVolume;
+                player->fadeLength = 0;
+                player->node.volume = player->volume;
+                remains = (AVAudioFrameCount)player->file.length;
+                cugl::Application::get()->schedule([=] {
+                    if (player->timeStamp == stamp) {
+                        cugl::AudioEngine::get()->gcMusic(true);
+                    }
+                    return false;
+                });
             } else if (remains == 0) {
                 cugl::Application::get()->schedule([=] {
                     if (player->timeStamp == stamp) {
@@ -1220,6 +1581,19 @@ bool InternalScheduleBackground(AudioPlayer* player, Uint64 start, Uint64 stamp)
     }
 }
 
+/**
+ * Releases the music file queued on the given player (if any).
+ *
+ * @param player    The music player
+ */
+void InternalClearCue(AudioPlayer* player) {
+    std::unique_lock<std::mutex> hold(player->lock);
+    if (player->cued != nil) {
+        [player->cued release];
+        player->cued = nil;
+    }
+}
+
 /**
  * Returns a music player allocated for use with the audio engine
  *
@@ -1245,6 +1619,7 @@ AudioPlayer* AudioAllocBackground() {
  */
 void AudioFreeBackground(AudioPlayer* player) {
     CUAssertLog(!player->playing, "Attempt to free an active music player");
+    InternalClearCue(player);
     [player->file release];
     player->file = nil;
 }
@@ -1266,6 +1641,7 @@ void AudioFreeBackground(AudioPlayer* player) {
  */
 void AudioPlayBackground(AudioPlayer* player, AudioStream* source, bool loop, Uint32 start) {
     player->timeStamp++;
+    InternalClearCue(player);
     
     if (player->node.playing) {
         [player->node stop];
@@ -1319,6 +1695,7 @@ void AudioPlayBackground(AudioPlayer* player, AudioStream* source, bool loop, Ui
  */
 void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop, Uint32 start, Uint32 fade) {
     player->timeStamp++;
+    InternalClearCue(player);
     
     if (player->node.playing) {
         [player->node stop];
@@ -1352,6 +1729,88 @@ void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop,
     }
 }
 
+/**
+ * Plays the music asset in the background at the given clock time.
+ *
+ * The song is silent until the audio clock (see {@link AudioGetClock})
+ * reaches the given time.  If the time has already passed, the song starts
+ * immediately.  When the audio halts it will call the gcMusic() method in
+ * AudioEngine.
+ *
+ * The music pages are scheduled from a worker thread, so we cannot start
+ * the node on an exact sample time.  Instead the start is delayed with an
+ * application timer, which is accurate to an animation frame.
+ *
+ * @param player    The music player
+ * @param source    The (streaming) audio asset
+ * @param loop      Whether to loop the given asset
+ * @param time      The audio clock time to start playback
+ * @param fade      The time (in milliseconds) to fade in playback
+ */
+void AudioScheduleBackground(AudioPlayer* player, AudioStream* source, bool loop, Uint64 time, Uint32 fade) {
+    Uint64 now  = AudioGetClock();
+    Uint32 rate = AudioGetSampleRate();
+    if (time <= now || rate == 0) {
+        if (fade > 0) {
+            AudioFadeInBackground(player, source, loop, 0, fade);
+        } else {
+            AudioPlayBackground(player, source, loop, 0);
+        }
+        return;
+    }
+    
+    Uint64 stamp = 0;
+    {
+        std::unique_lock<std::mutex> hold(player->lock);
+        player->timeStamp++;
+        player->node.volume = 0;
+        // DO NOT STOP.  THIS CAUSES CLIPPING
+        stamp = player->timeStamp;
+    }
+    InternalClearCue(player);
+    Uint32 millis = (Uint32)(((time-now)*1000)/rate);
+    cugl::Application::get()->schedule([=] {
+        if (player->timeStamp == stamp) {
+            if (fade > 0) {
+                AudioFadeInBackground(player, source, loop, 0, fade);
+            } else {
+                AudioPlayBackground(player, source, loop, 0);
+            }
+        }
+        return false;
+    }, millis);
+}
+
+/**
+ * Queues the music asset to follow the current background music.
+ *
+ * The asset starts when the current music runs out of pages, with no gap.
+ * AVFoundation does not let us overlap the pages of two files on the same
+ * node, so the fade is ignored and there is no crossfade.  The current music
+ * calls the gcMusic() method in AudioEngine (as completing normally) when
+ * the queued asset takes over.
+ *
+ * Only one asset may be queued at a time.  If source is nullptr, this
+ * cancels any queued asset.
+ *
+ * @param player    The music player
+ * @param source    The (streaming) audio asset, or nullptr to cancel
+ * @param loop      Whether to loop the given asset
+ * @param volume    The volume (0 to 1) to play the asset
+ * @param fade      The time (in milliseconds) to crossfade (ignored)
+ */
+void AudioQueueBackground(AudioPlayer* player, AudioStream* source, bool loop, float volume, Uint32 fade) {
+    InternalClearCue(player);
+    if (source == nullptr) {
+        return;
+    }
+    std::unique_lock<std::mutex> hold(player->lock);
+    player->cued = source->file;
+    [player->cued retain];
+    player->cueLoop   = loop;
+    player->cueVolume = volume;
+}
+
 /**
  * Halts the background music, garbage collecting the attached music asset.
  *
@@ -1360,6 +1819,7 @@ void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop,
  * @param player    The music player
  */
 void AudioHaltBackground(AudioPlayer* player) {
+    InternalClearCue(player);
     {
         std::unique_lock<std::mutex> hold(player->lock);
         player->timeStamp++;
@@ -9,6 +9,25 @@
 //  On Apple platforms, you can switch between solutions by defining/undefining
 //  the CU_AUDIO_AVFOUNDATION compiler variable.
 //
+//  Sound effects no longer use the SDL mixer channels.  Those channels are
+//  locked by SDL for every operation, and their completion callbacks run on
+//  the audio thread.  Instead, effects are decoded to float buffers and played
+//  by our own SoundMixer, which is attached as an SDL post-mix hook.  SDL mixer
+//  is now only used for decoding.  Background music plays on an extra voice of
+//  the SoundMixer, routed to the music bus.  This lets music be scheduled on
+//  the sample clock of the mixer, and lets queued tracks follow each other
+//  without a gap (or with a crossfade).
+//
+//  Sound assets are decoded at their native format, and resampled to the
+//  device rate with our own filter (SDL mixer only uses linear interpolation).
+//  Mono sounds stay mono, as the software mixer pans them itself.  Decoded
+//  sounds are shared through a cache keyed by file contents, so loading the
+//  same file under two different keys does not duplicate the samples.
+//
+//  Large OGG Vorbis effects are not decoded at all.  They are kept compressed
+//  in memory and streamed to the mixer, with a background thread decoding
+//  ahead of the play position.
+//
 //  CUGL zlib License:
 //      This software is provided 'as-is', without any express or implied
 //      warranty.  In no event will the authors be held liable for any damages
@@ -34,8 +53,15 @@
 #include "CUAudioEngine-impl.h"
 #include <cugl/audio/CUMusic.h>
 #include <cugl/audio/CUAudioEngine.h>
+#include <cugl/base/CUApplication.h>
 #include <cugl/util/CUDebug.h>
 #include <SDL/SDL_mixer.h>
+#include "../CUSoundMixer.h"
+#include "../CUSoundStream.h"
+#include "../CUSampleCache.h"
+#include "../CUAudioSIMD.h"
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 /** The mixer block size */
@@ -48,73 +74,74 @@ namespace impl {
 #pragma mark -
 #pragma mark Basic Data Types
 /**
- * Reference to the SDL mixer audio format.
+ * Reference to a decoded sound asset.
  *
- * We need this struct because Mix_Chunk does not carry along is audio format
- * information (which we need for duration calculations).  In addition, this 
- * allows us to unify SDL mixer with AVFoundation.
+ * The asset is decoded to the float format of the software mixer, at the
+ * device sample rate.  The buffer is shared with the mixer so that it may
+ * be released at any time.  It may also be shared with other sound assets
+ * with the same file contents, via the sample cache.
+ *
+ * A streaming asset has no PCM data.  Instead it stores the compressed file,
+ * which is decoded by a new stream each time the asset is played.
  */
 typedef struct AudioBuffer {
-    /** The SDL mixer representation of a PCM Buffer */
-    Mix_Chunk* chunk;
-    /** The data format (e.g. bytes) of a single audio frame */
-    Uint16 format;
+    /** The float PCM data for the software mixer */
+    std::shared_ptr<PCMBuffer> pcm;
+    /** The compressed OGG Vorbis data (streaming assets only) */
+    std::shared_ptr<std::string> source;
+    /** Whether this asset is streamed */
+    bool streaming;
     /** The number of audio frames in the buffer */
     Uint64 frames;
-    /** The number of audio channels (1, 2, 4 or 6) */
+    /** The number of audio channels (1 or 2) */
     Uint32 channels;
     /** The audio sample rate in HZ */
     double bitrate;
+    /** The key of the PCM data in the sample cache */
+    Uint64 key;
+    /** Whether the PCM data is in the sample cache */
+    bool cached;
 } AudioBuffer;
 
 /**
- * Reference to the SDL mixer music format.
+ * Reference to a music asset.
  *
- * This struct is really nothing more than Mix_Music.  We only need this to
- * unify SDL mixer with AVFoundation.
+ * Music is loaded just like a sound asset, except that OGG Vorbis files are
+ * always streamed (provided they match the device sample rate).  We keep the
+ * music type separately, as the buffer does not record the file format.
  */
 typedef struct AudioStream {
-    Mix_Music* music;
+    /** The sound asset for the music */
+    AudioBuffer* buffer;
+    /** The file format of the music */
+    cugl::Music::Type type;
 } AudioStream;
 
 /**
- * Reference to the SDL implementation of a sound channel.
+ * Reference to a voice of the software mixer.
  *
- * As with sound assets, SDL mixer does not carry along the audio format info
- * for each sound channel.  Therefore, we have added that in addition to the
- * channel id.  This allows us to unify SDL mixer with AVFoundation.
+ * The channel id is the voice index in the mixer.  We also track the volume,
+ * as the volume of a channel persists between sounds (as in SDL mixer).
  */
 typedef struct AudioChannel {
     /** The id for this player channel */
     Uint32 channel;
-    /** The data format (e.g. bytes) of a single audio frame */
-    Uint16 format;
-    /** The number of audio channels (1, 2, 4 or 6) */
-    Uint32 channels;
-    /** The audio sample rate in HZ */
-    double bitrate;
-    /** Whether or not this channel was terminated manually */
-    bool manual;
+    /** The volume of this channel */
+    float volume;
 } AudioChannel;
 
 /**
  * Reference to the SDL implementation of the music player.
  *
- * For the most part, we do not need any special information for a music
- * player, as it is bolted into the mixer.  However, we do need support
- * for rudimentary timing data, and that is included here.
+ * The music player is the last voice of the software mixer.  As with sound
+ * channels, we track the volume, as it persists between tracks.  All timing
+ * information comes from the mixer itself.
  */
 typedef struct AudioPlayer {
-    /** The currently attached music asset */
-    Mix_Music* music;
-    /** The SDL time stamp at which the music was paused */
-    Uint32 pauseTick;
-    /** The SDL time stamp at which the music was started */
-    Uint32 startTick;
-    /** The position (in milliseconds) in the song where it was last started */
-    Uint32 startTime;
-    /** Whether or not this channel was terminated manually */
-    bool manual;
+    /** The mixer voice for the music */
+    Uint32 voice;
+    /** The volume of the music */
+    float volume;
 } AudioPlayer;
 
 /**
@@ -124,8 +151,30 @@ typedef struct AudioPlayer {
  * channels that have been allocated so far.
  */
 typedef struct AudioMixer {
+    /** The background music player */
     AudioPlayer* background;
+    /** The allocated sound channels */
     std::vector< AudioChannel * > channels;
+    /** The software mixer for the sound channels */
+    std::shared_ptr<SoundMixer> effects;
+    /** The decoder for streaming assets (a thread unless offline) */
+    std::shared_ptr<StreamService> streams;
+    /** The shared decoded sound assets */
+    std::shared_ptr<SampleCache> samples;
+    /** The audio device format */
+    Uint16 format;
+    /** The number of audio device channels */
+    int outputs;
+    /** The audio device sample rate */
+    int frequency;
+    /** The scheduled callback for completion notices */
+    Uint32 poller;
+    /** Whether the completion notices are being polled (without a poller) */
+    bool polling;
+    /** Whether the sound effects are rendered offline (via AudioRender) */
+    bool offline;
+    /** Whether to restore the audio subsystem drivers on shutdown */
+    bool restore;
 } AudioMixer;
 
 /** The pointer to the engine root */
@@ -136,36 +185,102 @@ static AudioMixer* _engine;
 #pragma mark Internal Helpers
 
 /**
- * The SDL_Mixer callback parent for sound effects.
+ * The completion callback for sound effects and music.
+ *
+ * Unlike the SDL_Mixer callback, this function is called on the main thread
+ * when the mixer notices are polled.  The music voice comes after all of the
+ * sound channels.  A music track that was replaced by another play does not
+ * report its completion, as the music queue has already moved on.
  *
- * We needed the SDL_Mixer callback as a regular C function as SDL does not
- * play well with C++ closures.
+ * @param channel   The completed channel
+ * @param normal    Whether the channel completed normally
  */
-void InternalChannelDone(int channel) {
-    if (cugl::AudioEngine::get()) {
-        AudioChannel* player = _engine->channels[channel];
-        bool manual = player->manual;
-        player->manual = false;
-        cugl::AudioEngine::get()->gcEffect(channel,!manual);
+void InternalChannelDone(Uint32 channel, bool normal) {
+    if (cugl::AudioEngine::get() == nullptr) {
+        return;
+    } else if (channel < _engine->channels.size()) {
+        cugl::AudioEngine::get()->gcEffect(channel,normal);
+    } else if (_engine->effects->isNoticeCurrent()) {
+        cugl::AudioEngine::get()->gcMusic(normal);
     }
 }
 
 /**
- * The SDL_Mixer callback parent for music.
+ * The SDL_Mixer post-mix hook for sound effects.
+ *
+ * This function is called on the audio thread after SDL mixer has mixed
+ * the background music.  It adds the sound effects to the stream.
  *
- * We needed the SDL_Mixer callback as a regular C function as SDL does not
- * play well with C++ closures.
+ * @param udata     The AudioMixer
+ * @param stream    The audio stream
+ * @param len       The length of the stream in bytes
  */
-void InternalMusicFinished() {
-    if (cugl::AudioEngine::get()) {
-        AudioPlayer* player = _engine->background;
-        bool manual = player->manual;
-        player->manual = false;
-        player->music  = nullptr;
-        cugl::AudioEngine::get()->gcMusic(!manual);
+void InternalPostMix(void* udata, Uint8* stream, int len) {
+    AudioMixer* mixer = (AudioMixer*)udata;
+    Uint32 outputs = (Uint32)mixer->outputs;
+    if (mixer->format == AUDIO_S16SYS) {
+        mixer->effects->mix((Sint16*)stream,len/(outputs*sizeof(Sint16)),outputs);
+    } else if (mixer->format == AUDIO_F32SYS) {
+        mixer->effects->mix((float*)stream,len/(outputs*sizeof(float)),outputs);
     }
 }
 
+/**
+ * Initializes the mixer state for an open SDL_mixer device.
+ *
+ * If offline is true, the sound effects are not attached to the device,
+ * and are only mixed in {@link AudioRender}.  The streaming assets are also
+ * decoded there, instead of on a background thread.
+ *
+ * @param input     The number of sound effect channels
+ * @param offline   Whether to render the sound effects offline
+ *
+ * @return true if the mixer was successfully initialized.
+ */
+static bool InternalStart(int input, bool offline) {
+    int freq = 0;
+    Uint16 fmt = 0;
+    int chans = 0;
+    Mix_QuerySpec(&freq, &fmt, &chans);
+    if (chans < 1 || chans > 2 || (fmt != AUDIO_S16SYS && fmt != AUDIO_F32SYS)) {
+        CULogError("Unsupported audio device format");
+        Mix_CloseAudio();
+        return false;
+    }
+    
+    _engine = new AudioMixer();
+    _engine->background = nullptr;
+    _engine->format = fmt;
+    _engine->outputs = chans;
+    _engine->frequency = freq;
+    _engine->poller = 0;
+    _engine->polling = false;
+    _engine->offline = offline;
+    _engine->restore = false;
+    _engine->channels.resize(input, nullptr);
+    _engine->effects = SoundMixer::alloc(input+1, freq);
+    _engine->streams = StreamService::alloc(!offline);
+    _engine->samples = SampleCache::alloc(freq);
+    
+    // The extra voice is for music; SDL mixer does not play anything itself
+    _engine->effects->setBus(input, AudioBus::MUSIC);
+    Mix_AllocateChannels(0);
+    if (offline) {
+        return true;
+    }
+    
+    Mix_SetPostMix(InternalPostMix, _engine);
+    if (Application::get()) {
+        _engine->poller = Application::get()->schedule([] {
+            if (_engine != nullptr) {
+                _engine->effects->poll(InternalChannelDone);
+            }
+            return true;
+        });
+    }
+    return true;
+}
+
 /**
  * Initializes the audio engine for use.
  *
@@ -192,11 +307,43 @@ bool AudioStart(int frequency, int input, int output) {
     if (Mix_OpenAudio(frequency, MIX_DEFAULT_FORMAT, output, MIX_BLOCK_SIZE) == -1) {
         return false;
     }
-    _engine = new AudioMixer();
-    _engine->channels.resize(input, nullptr);
-    Mix_AllocateChannels(input);
-    Mix_ChannelFinished(InternalChannelDone);
-    Mix_HookMusicFinished(InternalMusicFinished);
+    return InternalStart(input, false);
+}
+
+/**
+ * Initializes the audio engine without an audio device.
+ *
+ * SDL_mixer still needs an open device to decode assets, so we open it on
+ * the dummy driver.  The sound effects are not attached to this device,
+ * and only advance when {@link AudioRender} is called.  Streaming assets
+ * are decoded in that function as well.  The original audio driver (if
+ * any) is restored when the engine is stopped.
+ *
+ * @param frequency The default sampling frequency
+ * @param input     The number of sound effect channels
+ * @param output    The number of output channels
+ */
+bool AudioStartOffline(int frequency, int input, int output) {
+    CUAssertLog(!_engine, "Audio engine has already been started");
+    bool restore = SDL_WasInit(SDL_INIT_AUDIO) != 0;
+    if (!restore && SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        CULogError("Could not initialize audio: %s",SDL_GetError());
+        return false;
+    }
+    
+    bool success = SDL_AudioInit("dummy") == 0;
+    success = success && Mix_OpenAudio(frequency, AUDIO_F32SYS, output, MIX_BLOCK_SIZE) != -1;
+    success = success && InternalStart(input, true);
+    if (!success) {
+        CULogError("Could not open offline audio: %s",SDL_GetError());
+        if (restore) {
+            SDL_AudioInit(nullptr);
+        } else {
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        }
+        return false;
+    }
+    _engine->restore = restore;
     return true;
 }
 
@@ -208,6 +355,10 @@ bool AudioStart(int frequency, int input, int output) {
  */
 void AudioStop() {
     CUAssertLog(_engine, "Audio engine is not currently active");
+    Mix_SetPostMix(nullptr, nullptr);
+    if (_engine->poller && Application::get()) {
+        Application::get()->unschedule(_engine->poller);
+    }
     if (_engine->background) {
         AudioFreeBackground(_engine->background);
     }
@@ -216,14 +367,316 @@ void AudioStop() {
             AudioFreeChannel(*it);
         }
     }
+    if (_engine->streams) {
+        _engine->streams->dispose();
+    }
+    if (_engine->samples) {
+        _engine->samples->dispose();
+    }
     
+    bool offline = _engine->offline;
+    bool restore = _engine->restore;
     delete _engine;
     _engine = nullptr;
     Mix_CloseAudio();
+    
+    // Put back the audio driver replaced by the offline engine
+    if (offline) {
+        if (restore) {
+            SDL_AudioInit(nullptr);
+        } else {
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        }
+    }
+}
+
+/**
+ * Returns the sample rate of the audio output
+ *
+ * @return the sample rate of the audio output
+ */
+Uint32 AudioGetSampleRate() {
+    return _engine ? (Uint32)_engine->frequency : 0;
+}
+
+/**
+ * Returns the number of audio output channels
+ *
+ * @return the number of audio output channels
+ */
+Uint32 AudioGetOutputChannels() {
+    return _engine ? (Uint32)_engine->outputs : 0;
+}
+
+/**
+ * Renders the given number of frames of an offline engine
+ *
+ * The output is interleaved floats, with one sample per output channel
+ * per frame.  The previous contents of the buffer are replaced.  Any
+ * completion callbacks are invoked before this function returns.
+ *
+ * The streams are decoded before each block is mixed, so a stream never
+ * runs dry (unless it seeks mid-block).  Hence the output only depends on
+ * the sequence of calls, and not on the timing of any thread.
+ *
+ * @param output    The output buffer
+ * @param frames    The number of frames to render
+ */
+void AudioRender(float* output, Uint32 frames) {
+    CUAssertLog(_engine && _engine->offline, "Audio engine is not rendering offline");
+    Uint32 outputs = (Uint32)_engine->outputs;
+    std::memset(output, 0, frames*outputs*sizeof(float));
+    for(Uint32 pos = 0; pos < frames; pos += MIX_BLOCK_SIZE) {
+        Uint32 amount = std::min(frames-pos,(Uint32)MIX_BLOCK_SIZE);
+        _engine->streams->pump();
+        _engine->effects->mix(output+pos*outputs, amount, outputs);
+    }
+    _engine->effects->poll(InternalChannelDone);
+}
+
+/**
+ * Returns the audio clock, in audio frames
+ *
+ * The audio clock is the number of frames rendered by the audio engine
+ * since it started.  It is the time base for scheduled music.
+ *
+ * @return the audio clock, in audio frames
+ */
+Uint64 AudioGetClock() {
+    return _engine ? _engine->effects->getTime() : 0;
+}
+
+/**
+ * Delivers any pending completion callbacks
+ *
+ * Completion callbacks are normally delivered by a function scheduled
+ * with the {@link Application}.  If there is no application, they are
+ * only delivered when this function is called.  This function does
+ * nothing if the callbacks are already scheduled.
+ */
+void AudioPoll() {
+    if (_engine == nullptr || _engine->offline || _engine->poller || _engine->polling) {
+        return;
+    }
+    // A callback may start another sound, which polls again
+    _engine->polling = true;
+    _engine->effects->poll(InternalChannelDone);
+    _engine->polling = false;
 }
 
 #pragma mark -
 #pragma mark Sound Assets
+/**
+ * Returns a streaming buffer for the given audio asset (or nullptr)
+ *
+ * The asset is only streamed if it is an OGG Vorbis file whose decoded size
+ * would exceed the threshold.  As streams are not resampled, the asset must
+ * also match the sample rate of the audio device.
+ *
+ * @param file      The path (absolute or relative) for the sound asset
+ * @param source    The contents of the sound asset file
+ * @param threshold The decoded size in bytes above which to stream
+ *
+ * @return a streaming buffer for the given audio asset (or nullptr)
+ */
+static AudioBuffer* InternalLoadStreaming(const char* file, const std::shared_ptr<std::string>& source,
+                                          Uint64 threshold) {
+    const char* suffix = std::strrchr(file,'.');
+    if (suffix == nullptr || SDL_strcasecmp(suffix,".ogg") != 0) {
+        return nullptr;
+    }
+    
+    Uint32 chans = 0;
+    Uint32 rate  = 0;
+    Uint64 frames = 0;
+    if (!VorbisStream::probe(source,&chans,&frames,&rate)) {
+        return nullptr;
+    } else if (chans < 1 || chans > 2 || rate != (Uint32)_engine->frequency) {
+        return nullptr;
+    } else if (frames*_engine->outputs*sizeof(float) <= threshold) {
+        return nullptr;
+    }
+    
+    AudioBuffer* buffer = new AudioBuffer();
+    buffer->source = source;
+    buffer->streaming = true;
+    buffer->channels = chans;
+    buffer->bitrate  = rate;
+    buffer->frames = frames;
+    buffer->key = 0;
+    buffer->cached = false;
+    return buffer;
+}
+
+/**
+ * Returns the WAV file decoded at its native format (or nullptr)
+ *
+ * Only mono and stereo files with 8, 16, or 32 bit samples are supported.
+ * All other files must be decoded by SDL mixer instead.
+ *
+ * @param source    The contents of the sound asset file
+ *
+ * @return the WAV file decoded at its native format (or nullptr)
+ */
+static std::shared_ptr<PCMBuffer> InternalDecodeWAV(const std::shared_ptr<std::string>& source) {
+    SDL_AudioSpec spec;
+    Uint8* data = nullptr;
+    Uint32 size = 0;
+    SDL_RWops* stream = SDL_RWFromConstMem(source->data(),(int)source->size());
+    if (SDL_LoadWAV_RW(stream,1,&spec,&data,&size) == nullptr) {
+        return nullptr;
+    } else if (spec.channels < 1 || spec.channels > 2) {
+        SDL_FreeWAV(data);
+        return nullptr;
+    }
+    
+    Uint32 chans  = spec.channels;
+    Uint32 points = size/(SDL_AUDIO_BITSIZE(spec.format)/8);
+    std::shared_ptr<PCMBuffer> pcm = nullptr;
+    switch (spec.format) {
+        case AUDIO_U8:
+            pcm = PCMBuffer::alloc(chans,points/chans,spec.freq);
+            for(Uint32 ii = 0; pcm && ii < pcm->getFrames()*chans; ii++) {
+                pcm->getData()[ii] = (data[ii]-128)/128.0f;
+            }
+            break;
+        case AUDIO_S16SYS:
+            pcm = PCMBuffer::alloc(chans,points/chans,spec.freq);
+            if (pcm) {
+                simd::s16_to_f32(pcm->getData(),(const Sint16*)data,(Uint32)(pcm->getFrames()*chans));
+            }
+            break;
+        case AUDIO_S32SYS:
+            pcm = PCMBuffer::alloc(chans,points/chans,spec.freq);
+            for(Uint32 ii = 0; pcm && ii < pcm->getFrames()*chans; ii++) {
+                pcm->getData()[ii] = (float)(((const Sint32*)data)[ii]/2147483648.0);
+            }
+            break;
+        case AUDIO_F32SYS:
+            pcm = PCMBuffer::alloc(chans,points/chans,spec.freq);
+            if (pcm) {
+                std::memcpy(pcm->getData(),data,pcm->getSize());
+            }
+            break;
+        default:
+            break;
+    }
+    SDL_FreeWAV(data);
+    return pcm;
+}
+
+/**
+ * Returns the OGG Vorbis file decoded at its native format (or nullptr)
+ *
+ * @param source    The contents of the sound asset file
+ *
+ * @return the OGG Vorbis file decoded at its native format (or nullptr)
+ */
+static std::shared_ptr<PCMBuffer> InternalDecodeVorbis(const std::shared_ptr<std::string>& source) {
+    Uint32 chans = 0;
+    Uint32 rate  = 0;
+    Uint64 frames = 0;
+    if (!VorbisStream::probe(source,&chans,&frames,&rate) || chans < 1 || chans > 2) {
+        return nullptr;
+    }
+    std::shared_ptr<PCMBuffer> pcm = PCMBuffer::alloc(chans,frames,rate);
+    if (pcm && VorbisStream::decompress(source,pcm->getData(),frames) == 0) {
+        return nullptr;
+    }
+    return pcm;
+}
+
+/**
+ * Returns the sound asset decoded by SDL mixer (or nullptr)
+ *
+ * SDL mixer converts the asset to the device format, so it needs no further
+ * conversion.  This is the fallback for all formats (such as MP3 and FLAC)
+ * that we cannot decode natively.
+ *
+ * @param source    The contents of the sound asset file
+ *
+ * @return the sound asset decoded by SDL mixer (or nullptr)
+ */
+static std::shared_ptr<PCMBuffer> InternalDecodeChunk(const std::shared_ptr<std::string>& source) {
+    SDL_RWops* stream = SDL_RWFromConstMem(source->data(),(int)source->size());
+    Mix_Chunk* data = Mix_LoadWAV_RW(stream,1);
+    if (!data) {
+        return nullptr;
+    }
+    
+    // Chunks are converted to audio device format...
+    Uint32 chans  = (Uint32)_engine->outputs;
+    Uint32 points = (data->alen / ((_engine->format & 0xFF)/8));
+    Uint64 frames = points/chans;
+    std::shared_ptr<PCMBuffer> pcm = PCMBuffer::alloc(chans,frames,_engine->frequency);
+    if (pcm == nullptr) {
+        Mix_FreeChunk(data);
+        return nullptr;
+    }
+    
+    // ...which we convert to float for the mixer
+    if (_engine->format == AUDIO_S16SYS) {
+        simd::s16_to_f32(pcm->getData(),(const Sint16*)data->abuf,(Uint32)(frames*chans));
+    } else {
+        std::memcpy(pcm->getData(),data->abuf,pcm->getSize());
+    }
+    Mix_FreeChunk(data);
+    return pcm;
+}
+
+/**
+ * Returns an in-memory PCM buffer for the given file contents
+ *
+ * The contents are first looked up in the sample cache.  If they are not
+ * there, they are decoded and resampled to the device rate, and then added
+ * to the cache.  This is the expensive part of loading a sound, and so it
+ * should happen on a worker thread (as it does in the asset manager).
+ *
+ * @param file      The path (absolute or relative) for the sound asset
+ * @param source    The contents of the sound asset file
+ * @param threshold The decoded size in bytes above which to stream
+ *
+ * @return an in-memory PCM buffer for the given file contents
+ */
+static AudioBuffer* InternalLoadBuffer(const char* file, const std::shared_ptr<std::string>& source,
+                                       Uint64 threshold) {
+    if (threshold > 0 && _engine->streams) {
+        AudioBuffer* buffer = InternalLoadStreaming(file, source, threshold);
+        if (buffer) {
+            return buffer;
+        }
+    }
+    
+    Uint64 key = _engine->samples->getKey(*source);
+    std::shared_ptr<PCMBuffer> pcm = _engine->samples->acquire(key);
+    if (pcm == nullptr) {
+        const char* suffix = std::strrchr(file,'.');
+        if (suffix != nullptr && SDL_strcasecmp(suffix,".wav") == 0) {
+            pcm = InternalDecodeWAV(source);
+        } else if (suffix != nullptr && SDL_strcasecmp(suffix,".ogg") == 0) {
+            pcm = InternalDecodeVorbis(source);
+        }
+        if (pcm == nullptr) {
+            pcm = InternalDecodeChunk(source);
+        }
+        pcm = SampleCache::resample(pcm, (Uint32)_engine->frequency);
+        if (pcm == nullptr) {
+            return nullptr;
+        }
+        pcm = _engine->samples->insert(key, pcm);
+    }
+    
+    AudioBuffer* buffer = new AudioBuffer();
+    buffer->pcm = pcm;
+    buffer->streaming = false;
+    buffer->channels = pcm->getChannels();
+    buffer->bitrate  = pcm->getRate();
+    buffer->frames = pcm->getFrames();
+    buffer->key = key;
+    buffer->cached = true;
+    return buffer;
+}
+
 /**
  * Returns an in-memory PCM buffer for the given audio asset
  *
@@ -236,40 +689,27 @@ void AudioStop() {
  * M4A, FLAC) is platform-dependent.  If the function cannot decode the
  * file, it will return nullptr.
  *
- * @param file  The path (absolute or relative) for the sound asset
+ * If the decoded asset would be larger than the given threshold, this
+ * function may choose to stream the asset instead.  In that case, the
+ * buffer keeps the compressed data, and decodes it at play time.  A
+ * threshold of 0 disables streaming.
+ *
+ * Decoded assets are shared by file contents.  Loading a file that is
+ * identical to one already loaded returns a new buffer referencing the
+ * same PCM data.
+ *
+ * @param file      The path (absolute or relative) for the sound asset
+ * @param threshold The decoded size in bytes above which to stream
  *
  * @return an in-memory PCM buffer for the given audio asset
  */
-AudioBuffer* AudioLoadBuffer(const char* file) {
-    Mix_Chunk* data = Mix_LoadWAV(file);
-    if (!data) {
+AudioBuffer* AudioLoadBuffer(const char* file, Uint64 threshold) {
+    CUAssertLog(_engine, "Audio engine is not currently active");
+    std::shared_ptr<std::string> source = VorbisStream::load(file);
+    if (source == nullptr) {
         return nullptr;
     }
-    
-    AudioBuffer* buffer = new AudioBuffer();
-    buffer->chunk = data;
-    
-    // Get the auxiliary information.
-    int freq = 0;
-    Uint16 fmt = 0;
-    int chans = 0;
-    
-    // Chunks are converted to audio device format...
-    if (!Mix_QuerySpec(&freq, &fmt, &chans)) {
-        // never called Mix_OpenAudio()?!
-        buffer->format = fmt;
-        buffer->channels = 0;
-        buffer->frames = 0;
-        buffer->bitrate = 0.0;
-    } else {
-        buffer->format = fmt;
-        buffer->channels = chans;
-        buffer->bitrate  = freq;
-        Uint32 points = (buffer->chunk->alen / ((fmt & 0xFF)/8));
-        buffer->frames = (points / chans);
-    }
-    
-    return buffer;
+    return InternalLoadBuffer(file, source, threshold);
 }
 
 /**
@@ -279,8 +719,11 @@ AudioBuffer* AudioLoadBuffer(const char* file) {
  */
 void AudioFreeBuffer(AudioBuffer* source) {
     if (source) {
-        Mix_FreeChunk(source->chunk);
-        source->chunk = nullptr;
+        if (source->cached && _engine && _engine->samples) {
+            _engine->samples->release(source->key);
+        }
+        source->pcm = nullptr;
+        source->source = nullptr;
         delete source;
     }
 }
@@ -318,6 +761,57 @@ double AudioGetBufferSampleRate(AudioBuffer* source) {
     return source->bitrate;
 }
 
+/**
+ * Returns true if the given buffer is streamed
+ *
+ * A streamed buffer keeps its audio compressed, and decodes it on a
+ * background thread during playback.
+ *
+ * @param source    The PCM buffer
+ *
+ * @return true if the given buffer is streamed
+ */
+bool AudioIsBufferStreaming(AudioBuffer* source) {
+    return source->streaming;
+}
+
+/**
+ * Returns the memory used by the given buffer in bytes
+ *
+ * For an in-memory buffer, this is the size of the decoded samples, which
+ * may be shared with other buffers (see {@link AudioGetBufferShares}).  For
+ * a streamed buffer, this is the size of the compressed data.
+ *
+ * @param source    The PCM buffer
+ *
+ * @return the memory used by the given buffer in bytes
+ */
+size_t AudioGetBufferMemory(AudioBuffer* source) {
+    if (source->streaming) {
+        return source->source ? source->source->size() : 0;
+    }
+    return source->pcm ? source->pcm->getSize() : 0;
+}
+
+/**
+ * Returns the number of buffers sharing the data of the given buffer
+ *
+ * Buffers with the same file contents share their decoded samples.  The
+ * result includes the given buffer, so a value of 1 means the data is not
+ * shared.
+ *
+ * @param source    The PCM buffer
+ *
+ * @return the number of buffers sharing the data of the given buffer
+ */
+Uint32 AudioGetBufferShares(AudioBuffer* source) {
+    if (source->cached && _engine && _engine->samples) {
+        Uint32 result = _engine->samples->getShareCount(source->key);
+        return result > 0 ? result : 1;
+    }
+    return 1;
+}
+
 #pragma mark -
 #pragma mark Music Assets
 /**
@@ -332,18 +826,46 @@ double AudioGetBufferSampleRate(AudioBuffer* source) {
  * M4A, FLAC) is platform-dependent.  If the function cannot decode the
  * file, it will return nullptr.
  *
+ * Music plays in the software mixer.  OGG Vorbis music is streamed if it
+ * matches the device sample rate.  All other music is decoded in memory.
+ *
  * @param file  The path (absolute or relative) for the sound asset
  *
  * @return an audio stream for the given music asset
  */
 AudioStream* AudioLoadStream(const char* file) {
-    Mix_Music* data = Mix_LoadMUS(file);
+    CUAssertLog(_engine, "Audio engine is not currently active");
+    std::shared_ptr<std::string> source = VorbisStream::load(file);
+    if (source == nullptr) {
+        return nullptr;
+    }
+    
+    AudioBuffer* data = nullptr;
+    if (_engine->streams) {
+        data = InternalLoadStreaming(file, source, 0);
+    }
+    if (!data) {
+        data = InternalLoadBuffer(file, source, 0);
+    }
     if (!data) {
         return nullptr;
     }
     
     AudioStream* buffer = new AudioStream();
-    buffer->music = data;
+    buffer->buffer = data;
+    buffer->type = cugl::Music::Type::UNSUPPORTED;
+    const char* suffix = std::strrchr(file,'.');
+    if (suffix == nullptr) {
+        return buffer;
+    } else if (SDL_strcasecmp(suffix,".mp3") == 0) {
+        buffer->type = cugl::Music::Type::MP3;
+    } else if (SDL_strcasecmp(suffix,".wav") == 0) {
+        buffer->type = cugl::Music::Type::WAV;
+    } else if (SDL_strcasecmp(suffix,".ogg") == 0) {
+        buffer->type = cugl::Music::Type::OGG;
+    } else if (SDL_strcasecmp(suffix,".flac") == 0) {
+        buffer->type = cugl::Music::Type::FLAC;
+    }
     return buffer;
 }
 
@@ -354,8 +876,8 @@ AudioStream* AudioLoadStream(const char* file) {
  */
 void AudioFreeStream(AudioStream* source) {
     if (source) {
-        Mix_FreeMusic(source->music);
-        source->music = nullptr;
+        AudioFreeBuffer(source->buffer);
+        source->buffer = nullptr;
         delete source;
     }
 }
@@ -371,7 +893,7 @@ void AudioFreeStream(AudioStream* source) {
  * @return the duration of the music asset in seconds
  */
 double AudioGetStreamDuration(AudioStream* source) {
-    return Mix_GetMusicDuration(source->music);
+    return source->buffer->frames/source->buffer->bitrate;
 }
 
 /**
@@ -382,25 +904,7 @@ double AudioGetStreamDuration(AudioStream* source) {
  * @return the music type of this audio stream
  */
 cugl::Music::Type AudioGetStreamType(AudioStream* source) {
-    cugl::Music::Type result = cugl::Music::Type::UNSUPPORTED;
-    switch (Mix_GetMusicType(source->music)) {
-        case MUS_MP3:
-            result = cugl::Music::Type::MP3;
-            break;
-        case MUS_WAV:
-            result = cugl::Music::Type::WAV;
-            break;
-        case MUS_OGG:
-            result = cugl::Music::Type::OGG;
-            break;
-        case MUS_FLAC:
-            result = cugl::Music::Type::FLAC;
-            break;
-        default:
-            result = cugl::Music::Type::UNSUPPORTED;
-            break;
-    }
-    return result;
+    return source->type;
 }
 
 
@@ -424,13 +928,13 @@ cugl::Music::Type AudioGetStreamType(AudioStream* source) {
  * @return a sound channel allocated for use with the audio engine
  */
 AudioChannel* AudioAllocChannel(int channel) {
-    CUAssertLog(channel >= 0 && channel < Mix_AllocateChannels(-1),
+    CUAssertLog(channel >= 0 && channel < (int)_engine->channels.size(),
                 "Channel %d is not a valid channel",channel);
     CUAssertLog(!_engine->channels[channel], "Audio channel is already allocated");
     AudioChannel* player = new AudioChannel();
     if (player) {
         player->channel = channel;
-        player->manual = false;
+        player->volume  = 1.0f;
     }
     _engine->channels[channel] = player;
     return player;
@@ -465,17 +969,17 @@ void AudioFreeChannel(AudioChannel* player) {
  * @param start     The audio frame to start playback
  */
 void AudioPlayChannel(AudioChannel* player, AudioBuffer* source, bool loop, Uint32 start) {
-    player->format   = source->format;
-    player->channels = source->channels;
-    player->bitrate  = source->bitrate;
-    
-    Mix_PlayChannel(player->channel, source->chunk, loop ? -1 : 0);
-    
-    // Adjust the byte offset if not at start
-    if (start > 0) {
-        // Convert frame to offset
-        Uint64 offset = start*((source->format & 0xFF)/8)*source->channels;
-        Mix_SetOffset(player->channel, (int)offset);
+    if (source->streaming) {
+        // Each play gets its own decoder, primed before it reaches the mixer
+        std::shared_ptr<SoundStream> stream = VorbisStream::alloc(source->source, start);
+        if (stream == nullptr) {
+            CULogError("Failed to open audio stream");
+            return;
+        }
+        _engine->streams->add(stream);
+        _engine->effects->play(player->channel, stream, player->volume, loop, start);
+    } else {
+        _engine->effects->play(player->channel, source->pcm, player->volume, loop, start);
     }
 }
 
@@ -487,8 +991,7 @@ void AudioPlayChannel(AudioChannel* player, AudioBuffer* source, bool loop, Uint
  * @param player    The sound channel
  */
 void AudioHaltChannel(AudioChannel* player) {
-    player->manual = true;
-    Mix_HaltChannel(player->channel);
+    _engine->effects->stop(player->channel);
 }
 
 /**
@@ -501,7 +1004,8 @@ void AudioHaltChannel(AudioChannel* player) {
  * @param millis    The number of millisecond before halting the asset
  */
 void AudioExpireChannel(AudioChannel* player, Uint32 millis) {
-    Mix_ExpireChannel(player->channel,millis);
+    Uint64 frames = ((Uint64)millis*_engine->frequency)/1000;
+    _engine->effects->expire(player->channel,frames);
 }
 
 /**
@@ -514,7 +1018,7 @@ void AudioExpireChannel(AudioChannel* player, Uint32 millis) {
  * @param player    The sound channel
  */
 void AudioPauseChannel(AudioChannel* player) {
-    Mix_Pause(player->channel);
+    _engine->effects->pause(player->channel);
 }
 
 /**
@@ -526,7 +1030,7 @@ void AudioPauseChannel(AudioChannel* player) {
  * @param player    The sound channel
  */
 void AudioResumeChannel(AudioChannel* player) {
-    Mix_Resume(player->channel);
+    _engine->effects->resume(player->channel);
 }
 
 /**
@@ -539,7 +1043,7 @@ void AudioResumeChannel(AudioChannel* player) {
  * @return true if this channel is actively playing.
  */
 bool AudioChannelPlaying(AudioChannel* player) {
-    return (bool)Mix_Playing(player->channel);
+    return _engine->effects->isPlaying(player->channel);
 }
 
 /**
@@ -553,7 +1057,7 @@ bool AudioChannelPlaying(AudioChannel* player) {
  * @return true if this channel is actively paused.
  */
 bool AudioChannelPaused(AudioChannel* player) {
-    return (bool)Mix_Paused(player->channel);
+    return _engine->effects->isPaused(player->channel);
 }
 
 /**
@@ -566,7 +1070,8 @@ bool AudioChannelPaused(AudioChannel* player) {
  * @param volume   The volume (0 to 1) to play the asset
  */
 void AudioSetChannelVolume(AudioChannel* player, float volume) {
-    Mix_Volume(player->channel,(int)(MIX_MAX_VOLUME*volume));
+    player->volume = volume;
+    _engine->effects->setVolume(player->channel,volume);
 }
 
 /**
@@ -581,7 +1086,7 @@ void AudioSetChannelVolume(AudioChannel* player, float volume) {
  * @param loop      Whether to loop the current attached asset
  */
 void AudioSetChannelLoop(AudioChannel* player, bool loop) {
-    Mix_SetLoop(player->channel, loop ? -1 : 0);
+    _engine->effects->setLoop(player->channel,loop);
 }
 
 /**
@@ -595,7 +1100,7 @@ void AudioSetChannelLoop(AudioChannel* player, bool loop) {
  * @return the current audio frame of the given sound channel
  */
 Uint64 AudioGetChannelFrame(AudioChannel* player) {
-    return Mix_GetOffset(player->channel);
+    return _engine->effects->getFrame(player->channel);
 }
 
 /**
@@ -608,13 +1113,154 @@ Uint64 AudioGetChannelFrame(AudioChannel* player) {
  * @param frame     The audio frame to jump to
  */
 void AudioSetChannelFrame(AudioChannel* player, Uint64 frame) {
-    Uint64 offset = frame*((player->format & 0xFF)/8)*player->channels;
-    Mix_SetOffset(player->channel,(int)offset);
+    _engine->effects->setFrame(player->channel,frame);
+}
+
+/**
+ * Sets the 2D emitter for the given sound channel
+ *
+ * If positional is false, the channel returns to an unattenuated, centered
+ * pan and the remaining arguments are ignored.  Otherwise, the gain and pan
+ * of the channel are computed from the emitter relative to the listener.
+ * The emitter persists across sound assets until it is cleared.
+ *
+ * @param player        The sound channel
+ * @param positional    Whether the channel has an emitter
+ * @param x             The emitter x-coordinate
+ * @param y             The emitter y-coordinate
+ * @param vx            The emitter x-velocity (for doppler)
+ * @param vy            The emitter y-velocity (for doppler)
+ * @param reference     The reference distance
+ * @param maximum       The maximum distance
+ * @param rolloff       The rolloff factor
+ */
+void AudioSetChannelEmitter(AudioChannel* player, bool positional, float x, float y,
+                            float vx, float vy, float reference, float maximum, float rolloff) {
+    if (positional) {
+        _engine->effects->setEmitter(player->channel,Vec2(x,y),Vec2(vx,vy),reference,maximum,rolloff);
+    } else {
+        _engine->effects->clearEmitter(player->channel);
+    }
+}
+
+/**
+ * Routes the given sound channel to a bus
+ *
+ * The bus persists across sound assets until it is changed.
+ *
+ * @param player    The sound channel
+ * @param bus       The bus index
+ */
+void AudioSetChannelBus(AudioChannel* player, Uint32 bus) {
+    _engine->effects->setBus(player->channel,bus);
+}
+
+
+#pragma mark -
+#pragma mark Positional Audio
+/**
+ * Sets the position and velocity of the listener
+ *
+ * @param x     The listener x-coordinate
+ * @param y     The listener y-coordinate
+ * @param vx    The listener x-velocity (for doppler)
+ * @param vy    The listener y-velocity (for doppler)
+ */
+void AudioSetListener(float x, float y, float vx, float vy) {
+    _engine->effects->setListener(Vec2(x,y),Vec2(vx,vy));
+}
+
+/**
+ * Sets the distance attenuation model for all emitters
+ *
+ * @param model The distance attenuation model
+ */
+void AudioSetDistanceModel(cugl::AudioEngine::DistanceModel model) {
+    _engine->effects->setDistanceModel(model);
+}
+
+/**
+ * Sets the doppler parameters for all emitters
+ *
+ * A factor of 0 disables doppler.
+ *
+ * @param factor    The doppler factor
+ * @param speed     The speed of sound
+ */
+void AudioSetDoppler(float factor, float speed) {
+    _engine->effects->setDoppler(factor,speed);
+}
+
+
+#pragma mark -
+#pragma mark Audio Buses
+/**
+ * Returns the number of buses in the audio engine
+ *
+ * @return the number of buses in the audio engine
+ */
+Uint32 AudioGetBusCount() {
+    return _engine->effects->getBusCount();
+}
+
+/**
+ * Returns the bus with the given index
+ *
+ * If there is no such bus, this function returns nullptr.
+ *
+ * @param index The bus index
+ *
+ * @return the bus with the given index
+ */
+std::shared_ptr<cugl::AudioBus> AudioGetBus(Uint32 index) {
+    return _engine->effects->getBus(index);
+}
+
+/**
+ * Returns a newly created bus that mixes into the given parent
+ *
+ * If the parent does not exist, this function returns nullptr.
+ *
+ * @param name      The bus name
+ * @param parent    The index of the parent bus
+ *
+ * @return a newly created bus that mixes into the given parent
+ */
+std::shared_ptr<cugl::AudioBus> AudioAddBus(const std::string& name, Uint32 parent) {
+    return _engine->effects->addBus(name,parent);
 }
 
 
 #pragma mark -
 #pragma mark Background Music
+/**
+ * Plays the music asset on the music voice of the software mixer.
+ *
+ * Streamed music gets its own decoder, primed before it reaches the mixer.
+ *
+ * @param player    The music player
+ * @param source    The (streaming) audio asset
+ * @param loop      Whether to loop the given asset
+ * @param frame     The audio frame to start playback
+ * @param time      The mixer clock time to start playback (0 for immediately)
+ * @param fade      The number of frames to fade in playback
+ */
+static void InternalPlayMusic(AudioPlayer* player, AudioStream* source, bool loop,
+                              Uint64 frame, Uint64 time, Uint32 fade) {
+    AudioBuffer* buffer = source->buffer;
+    if (buffer->streaming) {
+        std::shared_ptr<SoundStream> stream = VorbisStream::alloc(buffer->source, frame);
+        if (stream == nullptr) {
+            CULogError("Failed to open music stream");
+            return;
+        }
+        _engine->streams->add(stream);
+        _engine->effects->play(player->voice, stream, player->volume, loop, frame, time, fade);
+    } else {
+        _engine->effects->play(player->voice, buffer->pcm, player->volume, loop, frame, time, fade);
+    }
+}
+
 /**
  * Returns a music player allocated for use with the audio engine
  *
@@ -630,9 +1276,8 @@ AudioPlayer* AudioAllocBackground() {
     if (!_engine->background) {
         AudioPlayer* player = new AudioPlayer();
         if (player) {
-            player->music = nullptr;
-            player->pauseTick = 0;
-            player->startTick = 0;
+            player->voice  = (Uint32)_engine->channels.size();
+            player->volume = 1.0f;
         }
         _engine->background = player;
     }
@@ -668,22 +1313,8 @@ void AudioFreeBackground(AudioPlayer* player) {
  * @param start     The position (in milliseconds) to start playback
  */
 void AudioPlayBackground(AudioPlayer* player, AudioStream* source, bool loop, Uint32 start) {
-    // This is the only way we might still be playing.
-    if (Mix_FadingMusic()) {
-        player->manual = true;
-        Mix_HaltMusic();
-    }
-    
-    player->startTick = SDL_GetTicks();
-    player->pauseTick = 0;
-    player->startTime = start;
-    player->music = source->music;
-    
-    // Do this quietly
-    int volume = Mix_VolumeMusic(0);
-    Mix_PlayMusic(source->music,(loop ? -1 : 0));
-    Mix_SetMusicPosition(start/1000.0);
-    Mix_VolumeMusic(volume);
+    Uint64 frame = ((Uint64)start*_engine->frequency)/1000;
+    InternalPlayMusic(player, source, loop, frame, 0, 0);
 }
 
 /**
@@ -705,16 +1336,70 @@ void AudioPlayBackground(AudioPlayer* player, AudioStream* source, bool loop, Ui
  * @param source    The (streaming) audio asset
  * @param loop      Whether to loop the given asset
  * @param start     The position (in milliseconds) to start playback
- * @param start     The time (in milliseconds) to fade in playback
+ * @param fade      The time (in milliseconds) to fade in playback
  */
 void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop, Uint32 start, Uint32 fade) {
-    player->startTick = SDL_GetTicks();
-    player->pauseTick = 0;
-    player->startTime = start;
-    player->music = source->music;
+    Uint64 frame = ((Uint64)start*_engine->frequency)/1000;
+    Uint32 ramp  = (Uint32)(((Uint64)fade*_engine->frequency)/1000);
+    InternalPlayMusic(player, source, loop, frame, 0, ramp);
+}
 
-    Mix_FadeInMusic(source->music,(loop ? -1 : 0),fade);
-    Mix_SetMusicPosition(start/1000.0);
+/**
+ * Plays the music asset in the background at the given clock time.
+ *
+ * The song is silent until the audio clock (see {@link AudioGetClock})
+ * reaches the given time, and starts on that exact audio frame.  If the
+ * time has already passed, the song starts immediately.  When the audio
+ * halts it will call the gcMusic() method in AudioEngine.
+ *
+ * @param player    The music player
+ * @param source    The (streaming) audio asset
+ * @param loop      Whether to loop the given asset
+ * @param time      The audio clock time to start playback
+ * @param fade      The time (in milliseconds) to fade in playback
+ */
+void AudioScheduleBackground(AudioPlayer* player, AudioStream* source, bool loop, Uint64 time, Uint32 fade) {
+    Uint32 ramp = (Uint32)(((Uint64)fade*_engine->frequency)/1000);
+    InternalPlayMusic(player, source, loop, 0, time, ramp);
+}
+
+/**
+ * Queues the music asset to follow the current background music.
+ *
+ * The asset starts on the audio frame after the current music ends, with
+ * no gap.  If fade is non-zero, the asset instead starts fade milliseconds
+ * before the end of the current music, and the two are crossfaded.  The
+ * current music calls the gcMusic() method in AudioEngine (as completing
+ * normally) when the queued asset takes over.
+ *
+ * Only one asset may be queued at a time.  If source is nullptr, this
+ * cancels any queued asset.
+ *
+ * @param player    The music player
+ * @param source    The (streaming) audio asset, or nullptr to cancel
+ * @param loop      Whether to loop the given asset
+ * @param volume    The volume (0 to 1) to play the asset
+ * @param fade      The time (in milliseconds) to crossfade
+ */
+void AudioQueueBackground(AudioPlayer* player, AudioStream* source, bool loop, float volume, Uint32 fade) {
+    if (source == nullptr) {
+        _engine->effects->uncue(player->voice);
+        return;
+    }
+    
+    Uint32 ramp = (Uint32)(((Uint64)fade*_engine->frequency)/1000);
+    AudioBuffer* buffer = source->buffer;
+    if (buffer->streaming) {
+        std::shared_ptr<SoundStream> stream = VorbisStream::alloc(buffer->source, 0);
+        if (stream == nullptr) {
+            CULogError("Failed to open music stream");
+            return;
+        }
+        _engine->streams->add(stream);
+        _engine->effects->cue(player->voice, stream, volume, loop, ramp);
+    } else {
+        _engine->effects->cue(player->voice, buffer->pcm, volume, loop, ramp);
+    }
 }
 
 /**
@@ -725,8 +1410,7 @@ void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop,
  * @param player    The music player
  */
 void AudioHaltBackground(AudioPlayer* player) {
-    player->manual = true;
-    Mix_HaltMusic();
+    _engine->effects->stop(player->voice);
 }
 
 /**
@@ -740,7 +1424,8 @@ void AudioHaltBackground(AudioPlayer* player) {
  * @param millis    The number of millisecond before halting the asset
  */
 void AudioFadeOutBackground(AudioPlayer* player, Uint32 millis) {
-    Mix_FadeOutMusic(millis);
+    Uint32 ramp = (Uint32)(((Uint64)millis*_engine->frequency)/1000);
+    _engine->effects->fadeOut(player->voice, ramp);
 }
 
 /**
@@ -753,8 +1438,7 @@ void AudioFadeOutBackground(AudioPlayer* player, Uint32 millis) {
  * @param player    The music player
  */
 void AudioPauseBackground(AudioPlayer* player) {
-    player->pauseTick = SDL_GetTicks();
-    Mix_PauseMusic();
+    _engine->effects->pause(player->voice);
 }
 
 /**
@@ -766,9 +1450,7 @@ void AudioPauseBackground(AudioPlayer* player) {
  * @param player    The music player
  */
 void AudioResumeBackground(AudioPlayer* player) {
-    player->startTime = (Uint32)AudioGetBackgroundTime(player);
-    player->startTick = SDL_GetTicks();
-    Mix_ResumeMusic();
+    _engine->effects->resume(player->voice);
 }
 
 /**
@@ -781,7 +1463,7 @@ void AudioResumeBackground(AudioPlayer* player) {
  * @return true if the background music is actively playing.
  */
 bool AudioBackgroundPlaying(AudioPlayer* player) {
-    return (bool)Mix_PlayingMusic();
+    return _engine->effects->isPlaying(player->voice);
 }
 
 
@@ -795,7 +1477,7 @@ bool AudioBackgroundPlaying(AudioPlayer* player) {
  * @return true if the background music is actively paused.
  */
 bool AudioBackgroundPaused(AudioPlayer* player) {
-    return (bool)Mix_PausedMusic();
+    return _engine->effects->isPaused(player->voice);
 }
 
 /**
@@ -808,7 +1490,8 @@ bool AudioBackgroundPaused(AudioPlayer* player) {
  * @param volume    The volume (0 to 1) to play the asset
  */
 void AudioSetBackgroundVolume(AudioPlayer* player, float volume) {
-    Mix_VolumeMusic((int)(volume*MIX_MAX_VOLUME));
+    player->volume = volume;
+    _engine->effects->setVolume(player->voice, volume);
 }
 
 /**
@@ -823,55 +1506,39 @@ void AudioSetBackgroundVolume(AudioPlayer* player, float volume) {
  * @param loop      Whether to loop the current attached asset
  */
 void AudioSetBackgroundLoop(AudioPlayer* player, bool loop) {
-    Mix_SetMusicLoop(loop ? -1 : 0);
+    _engine->effects->setLoop(player->voice, loop);
 }
 
 /**
  * Returns the elapsed number of seconds of the audio stream
  *
  * If the music asset is playing in a loop, this function returns the
- * elapsed time since the beginning of the song.
+ * elapsed time since the beginning of the song.  The position comes from
+ * the mixer, so it is accurate to the last audio block.
  *
  * @param player    The music player
  *
  * @return the elapsed number of seconds of the audio stream
  */
 double AudioGetBackgroundTime(AudioPlayer* player) {
-    int millis = (int)(Mix_GetMusicDuration(player->music)*1000);
-
-    int offset = 0;
-    if (player->pauseTick >= player->startTick) {
-        offset = (player->pauseTick - player->startTick);
-    } else {
-        offset = (SDL_GetTicks()-player->startTick);
-    }
-    
-    // This handles loops properly
-    int result = (offset+player->startTime) % millis;
-    return result/1000.0;
+    return _engine->effects->getFrame(player->voice)/(double)_engine->frequency;
 }
 
 /**
- * Sets the loop option for this music player
+ * Sets the elapsed number of seconds of the audio stream
  *
- * This setting only affects the currently attached music asset.  If loop
- * is true, the music asset will continue to play indefinitely unless
- * stopped manually.  If it is set to false, it will terminate the asset
- * at the end of the natural loop point.
+ * This function will fast-forward or rewind the sound asset to the
+ * given position.  This function will not pause or halt playback.
  *
  * @param player    The music player
- * @param loop      Whether to loop the current attached asset
+ * @param time      The position to jump to
  */
 void  AudioSetBackgroundTime(AudioPlayer* player, double time) {
-    if (Mix_SetMusicPosition(time) != -1) {
-        player->startTick = SDL_GetTicks();
-        player->startTime = (Uint32)(time*1000);
-        if (Mix_PausedMusic()) {
-            player->pauseTick = player->startTick;
-        }
+    if (time < 0) {
+        CULogError("Failed to set music position to time %3.f",time);
         return;
     }
-    CULogError("Failed to set music position to time %3.f",time);
+    _engine->effects->setFrame(player->voice, (Uint64)(time*_engine->frequency));
 }
 
 
@@ -37,6 +37,8 @@
 #define __CU_AUDIO_ENGINE_IMPL_H__
 #include <cugl/base/CUBase.h>
 #include <cugl/audio/CUMusic.h>
+#include <cugl/audio/CUAudioEngine.h>
+#include <cugl/audio/CUAudioBus.h>
 
 namespace cugl {
 namespace impl {
@@ -104,6 +106,20 @@ namespace impl {
      */
     bool AudioStart(int frequency, int input, int output);
     
+    /**
+     * Initializes the audio engine without an audio device.
+     *
+     * An offline engine loads and plays assets like a normal engine, but the
+     * sound effects only advance when {@link AudioRender} is called.  This
+     * makes the output deterministic, and is intended for testing and
+     * benchmarking.  Not every platform supports offline rendering.
+     *
+     * @param frequency The default sampling frequency
+     * @param input     The number of sound effect channels
+     * @param output    The number of output channels
+     */
+    bool AudioStartOffline(int frequency, int input, int output);
+    
     /**
      * Stops the audio engine preventing it from further use.
      *
@@ -112,6 +128,52 @@ namespace impl {
      */
     void AudioStop();
     
+    /**
+     * Returns the sample rate of the audio output
+     *
+     * @return the sample rate of the audio output
+     */
+    Uint32 AudioGetSampleRate();
+    
+    /**
+     * Returns the number of audio output channels
+     *
+     * @return the number of audio output channels
+     */
+    Uint32 AudioGetOutputChannels();
+    
+    /**
+     * Renders the given number of frames of an offline engine
+     *
+     * The output is interleaved floats, with one sample per output channel
+     * per frame.  The previous contents of the buffer are replaced.  Any
+     * completion callbacks are invoked before this function returns.
+     *
+     * @param output    The output buffer
+     * @param frames    The number of frames to render
+     */
+    void AudioRender(float* output, Uint32 frames);
+    
+    /**
+     * Returns the audio clock, in audio frames
+     *
+     * The audio clock is the number of frames rendered by the audio engine
+     * since it started.  It is the time base for scheduled music.
+     *
+     * @return the audio clock, in audio frames
+     */
+    Uint64 AudioGetClock();
+    
+    /**
+     * Delivers any pending completion callbacks
+     *
+     * Completion callbacks are normally delivered by a function scheduled
+     * with the {@link Application}.  If there is no application, they are
+     * only delivered when this function is called.  This function does
+     * nothing if the callbacks are already scheduled.
+     */
+    void AudioPoll();
+    
     
 #pragma mark -
 #pragma mark Sound Assets
@@ -127,11 +189,17 @@ namespace impl {
      * M4A, FLAC) is platform-dependent.  If the function cannot decode the
      * file, it will return nullptr.
      *
-     * @param file  The path (absolute or relative) for the sound asset
+     * If the decoded asset would be larger than the given threshold, this
+     * function may choose to stream the asset instead.  In that case, the
+     * buffer keeps the compressed data, and decodes it at play time.  A
+     * threshold of 0 disables streaming.  Not all platforms support streaming.
+     *
+     * @param file      The path (absolute or relative) for the sound asset
+     * @param threshold The decoded size in bytes above which to stream
      *
      * @return an in-memory PCM buffer for the given audio asset
      */
-    AudioBuffer* AudioLoadBuffer(const char* file);
+    AudioBuffer* AudioLoadBuffer(const char* file, Uint64 threshold);
     
     /**
      * Frees the given PCM buffer, releasing all resources
@@ -167,6 +235,44 @@ namespace impl {
      */
     double AudioGetBufferSampleRate(AudioBuffer* source);
 
+    /**
+     * Returns true if the given buffer is streamed
+     *
+     * A streamed buffer keeps its audio compressed, and decodes it on a
+     * background thread during playback.
+     *
+     * @param source    The PCM buffer
+     *
+     * @return true if the given buffer is streamed
+     */
+    bool AudioIsBufferStreaming(AudioBuffer* source);
+
+    /**
+     * Returns the memory used by the given buffer in bytes
+     *
+     * For an in-memory buffer, this is the size of the decoded samples, which
+     * may be shared with other buffers (see {@link AudioGetBufferShares}).  For
+     * a streamed buffer, this is the size of the compressed data.
+     *
+     * @param source    The PCM buffer
+     *
+     * @return the memory used by the given buffer in bytes
+     */
+    size_t AudioGetBufferMemory(AudioBuffer* source);
+
+    /**
+     * Returns the number of buffers sharing the data of the given buffer
+     *
+     * Buffers with the same file contents share their decoded samples.  The
+     * result includes the given buffer, so a value of 1 means the data is not
+     * shared.  Not all platforms share sample data.
+     *
+     * @param source    The PCM buffer
+     *
+     * @return the number of buffers sharing the data of the given buffer
+     */
+    Uint32 AudioGetBufferShares(AudioBuffer* source);
+
     
 #pragma mark -
 #pragma mark Music Assets
@@ -375,6 +481,101 @@ namespace impl {
      */
     void   AudioSetChannelFrame(AudioChannel* player, Uint64 frame);
     
+    /**
+     * Sets the 2D emitter for the given sound channel
+     *
+     * If positional is false, the channel returns to an unattenuated, centered
+     * pan and the remaining arguments are ignored.  Otherwise, the gain and pan
+     * of the channel are computed from the emitter relative to the listener.
+     * The emitter persists across sound assets until it is cleared.
+     *
+     * @param player        The sound channel
+     * @param positional    Whether the channel has an emitter
+     * @param x             The emitter x-coordinate
+     * @param y             The emitter y-coordinate
+     * @param vx            The emitter x-velocity (for doppler)
+     * @param vy            The emitter y-velocity (for doppler)
+     * @param reference     The reference distance
+     * @param maximum       The maximum distance
+     * @param rolloff       The rolloff factor
+     */
+    void AudioSetChannelEmitter(AudioChannel* player, bool positional, float x, float y,
+                                float vx, float vy, float reference, float maximum, float rolloff);
+    
+    /**
+     * Routes the given sound channel to a bus
+     *
+     * The bus persists across sound assets until it is changed.
+     *
+     * @param player    The sound channel
+     * @param bus       The bus index
+     */
+    void AudioSetChannelBus(AudioChannel* player, Uint32 bus);
+
+    
+#pragma mark -
+#pragma mark Positional Audio
+    /**
+     * Sets the position and velocity of the listener
+     *
+     * @param x     The listener x-coordinate
+     * @param y     The listener y-coordinate
+     * @param vx    The listener x-velocity (for doppler)
+     * @param vy    The listener y-velocity (for doppler)
+     */
+    void AudioSetListener(float x, float y, float vx, float vy);
+    
+    /**
+     * Sets the distance attenuation model for all emitters
+     *
+     * @param model The distance attenuation model
+     */
+    void AudioSetDistanceModel(cugl::AudioEngine::DistanceModel model);
+    
+    /**
+     * Sets the doppler parameters for all emitters
+     *
+     * A factor of 0 disables doppler.  Platforms that cannot shift pitch
+     * ignore this setting.
+     *
+     * @param factor    The doppler factor
+     * @param speed     The speed of sound
+     */
+    void AudioSetDoppler(float factor, float speed);
+    
+    
+#pragma mark -
+#pragma mark Audio Buses
+    /**
+     * Returns the number of buses in the audio engine
+     *
+     * @return the number of buses in the audio engine
+     */
+    Uint32 AudioGetBusCount();
+    
+    /**
+     * Returns the bus with the given index
+     *
+     * If there is no such bus, this function returns nullptr.
+     *
+     * @param index The bus index
+     *
+     * @return the bus with the given index
+     */
+    std::shared_ptr<cugl::AudioBus> AudioGetBus(Uint32 index);
+    
+    /**
+     * Returns a newly created bus that mixes into the given parent
+     *
+     * If the parent does not exist, this function returns nullptr.
+     *
+     * @param name      The bus name
+     * @param parent    The index of the parent bus
+     *
+     * @return a newly created bus that mixes into the given parent
+     */
+    std::shared_ptr<cugl::AudioBus> AudioAddBus(const std::string& name, Uint32 parent);
+    
     
 #pragma mark -
 #pragma mark Background Music
@@ -441,6 +642,44 @@ namespace impl {
      */
     void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop, Uint32 start=0, Uint32 fade=0);
 
+    /**
+     * Plays the music asset in the background at the given clock time.
+     *
+     * The song is silent until the audio clock (see {@link AudioGetClock})
+     * reaches the given time, and starts on that exact audio frame.  If the
+     * time has already passed, the song starts immediately.  When the audio
+     * halts it will call the gcMusic() method in AudioEngine.
+     *
+     * Not all platforms can start the song on an exact audio frame.
+     *
+     * @param player    The music player
+     * @param source    The (streaming) audio asset
+     * @param loop      Whether to loop the given asset
+     * @param time      The audio clock time to start playback
+     * @param fade      The time (in milliseconds) to fade in playback
+     */
+    void AudioScheduleBackground(AudioPlayer* player, AudioStream* source, bool loop, Uint64 time, Uint32 fade=0);
+
+    /**
+     * Queues the music asset to follow the current background music.
+     *
+     * The asset starts on the audio frame after the current music ends, with
+     * no gap.  If fade is non-zero, the asset instead starts fade milliseconds
+     * before the end of the current music, and the two are crossfaded.  The
+     * current music calls the gcMusic() method in AudioEngine (as completing
+     * normally) when the queued asset takes over.
+     *
+     * Only one asset may be queued at a time.  If source is nullptr, this
+     * cancels any queued asset.  Not all platforms support crossfades.
+     *
+     * @param player    The music player
+     * @param source    The (streaming) audio asset, or nullptr to cancel
+     * @param loop      Whether to loop the given asset
+     * @param volume    The volume (0 to 1) to play the asset
+     * @param fade      The time (in milliseconds) to crossfade
+     */
+    void AudioQueueBackground(AudioPlayer* player, AudioStream* source, bool loop, float volume, Uint32 fade=0);
+
     /**
      * Halts the background music, garbage collecting the attached music asset.
      *
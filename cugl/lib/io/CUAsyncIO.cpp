@@ -0,0 +1,492 @@
+//
+//  CUAsyncIO.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a service for reading and writing files off of the
+//  main thread.  Requests are queued by priority and processed by a small
+//  pool of worker threads.  The results are available as futures, and can
+//  also be delivered to callbacks on the main thread (at the start of the
+//  next animation frame).
+//
+//  Writes are atomic: the data is written to a temporary file that replaces
+//  the original only once it is complete.  Requests are coalesced when they
+//  are still waiting in the queue, so a burst of saves to the same file only
+//  writes the file once.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/io/CUAsyncIO.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/base/CUApplication.h>
+#include <SDL/SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+#if !defined (__WINDOWS__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace cugl;
+
+/** The length of a request to read an entire file */
+#define ENTIRE_FILE std::numeric_limits<Uint64>::max()
+
+/** The suffix for temporary files during an atomic write */
+#define TEMP_SUFFIX ".tmp"
+
+#pragma mark -
+#pragma mark File Access
+/**
+ * Returns the contents of the given range of a file.
+ *
+ * The range is truncated if it extends past the end of the file.  This
+ * function returns nullptr if the file cannot be read, or if the offset
+ * is past the end of the file.
+ *
+ * @param path      The absolute path to the file
+ * @param offset    The offset of the first byte to read
+ * @param length    The maximum number of bytes to read
+ *
+ * @return the contents of the given range of a file.
+ */
+static std::shared_ptr<std::string> read_range(const std::string& path, Uint64 offset, Uint64 length) {
+    SDL_RWops* stream = SDL_RWFromFile(path.c_str(), "rb");
+    if (!stream) {
+        return nullptr;
+    }
+    
+    Sint64 size = SDL_RWsize(stream);
+    if (size < 0 || offset > (Uint64)size) {
+        SDL_RWclose(stream);
+        return nullptr;
+    }
+    if (offset && SDL_RWseek(stream, (Sint64)offset, RW_SEEK_SET) < 0) {
+        SDL_RWclose(stream);
+        return nullptr;
+    }
+
+    Uint64 amount = std::min(length,(Uint64)size-offset);
+    std::shared_ptr<std::string> result = std::make_shared<std::string>();
+    result->resize((size_t)amount);
+    size_t actual = amount ? SDL_RWread(stream, &((*result)[0]), 1, (size_t)amount) : 0;
+    result->resize(actual);
+    SDL_RWclose(stream);
+    return result;
+}
+
+/**
+ * Returns true if the data was written to the file atomically.
+ *
+ * The data is written to a temporary file, which is then flushed to disk
+ * and renamed to replace the original file.  If anything fails, the
+ * original file is untouched.
+ *
+ * @param path  The absolute path to the file
+ * @param data  The data to write
+ *
+ * @return true if the data was written to the file atomically.
+ */
+static bool write_atomic(const std::string& path, const std::string& data) {
+    std::string temp = path+TEMP_SUFFIX;
+    SDL_RWops* stream = SDL_RWFromFile(temp.c_str(), "wb");
+    if (!stream) {
+        return false;
+    }
+    
+    size_t amount = data.empty() ? 0 : SDL_RWwrite(stream, data.data(), 1, data.size());
+    bool success = SDL_RWclose(stream) == 0 && amount == data.size();
+#if defined (__WINDOWS__)
+    success = success && MoveFileExA(temp.c_str(), path.c_str(),
+                                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    if (success) {
+        // The data must reach the disk before the rename does
+        int fd = open(temp.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fsync(fd);
+            close(fd);
+        }
+        success = std::rename(temp.c_str(), path.c_str()) == 0;
+    }
+#endif
+    if (!success) {
+        std::remove(temp.c_str());
+    }
+    return success;
+}
+
+/**
+ * Returns true if request a should be processed after request b
+ *
+ * This is the comparison for the request heap.
+ *
+ * @param a The first request
+ * @param b The second request
+ *
+ * @return true if request a should be processed after request b
+ */
+template <typename T>
+static bool request_after(const std::shared_ptr<T>& a, const std::shared_ptr<T>& b) {
+    if (a->priority != b->priority) {
+        return a->priority < b->priority;
+    }
+    return a->order > b->order;
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Completes all pending requests and stops the worker threads.
+ *
+ * Requests are not abandoned, so that no save is ever lost.  You must
+ * reinitialize the service to use it again.
+ */
+void AsyncIO::dispose() {
+    if (_pool == nullptr) {
+        return;
+    }
+    wait();
+    _pool = nullptr;
+    _queue.clear();
+    _waiting.clear();
+    _active.clear();
+    _deferred.clear();
+    _order = 0;
+    _coalesced = 0;
+}
+
+/**
+ * Initializes an I/O service with the given number of worker threads.
+ *
+ * More than one thread allows writes to different files to proceed in
+ * parallel.  However, most storage devices gain little beyond a few
+ * threads.
+ *
+ * @param threads   The number of worker threads
+ *
+ * @return true if the service is initialized properly, false otherwise.
+ */
+bool AsyncIO::init(int threads) {
+    CUAssertLog(threads > 0, "The number of threads must be positive");
+    CUAssertLog(_pool == nullptr, "Service is already initialized");
+    _pool = ThreadPool::alloc(threads);
+    return _pool != nullptr;
+}
+
+
+#pragma mark -
+#pragma mark Reading
+/**
+ * Returns the future contents of the given file.
+ *
+ * If the file is a relative path, this method will look for the file
+ * in the application save directory {@see Application#getSaveDirectory()}.
+ *
+ * If callback is not nullptr, it will be executed on the main thread
+ * with the contents of the file.
+ *
+ * @param file      The path (absolute or relative) to the file
+ * @param callback  An optional callback for the file contents
+ * @param priority  The request priority
+ *
+ * @return the future contents of the given file.
+ */
+AsyncIO::ReadFuture AsyncIO::readFile(const Pathname& file, ReadCallback callback, int priority) {
+    return readRange(file,0,ENTIRE_FILE,callback,priority);
+}
+
+/**
+ * Returns the future contents of the given range of a file.
+ *
+ * The range is truncated if it extends past the end of the file.  If
+ * the offset is past the end of the file, the read fails.
+ *
+ * If the file is a relative path, this method will look for the file
+ * in the application save directory {@see Application#getSaveDirectory()}.
+ *
+ * If callback is not nullptr, it will be executed on the main thread
+ * with the contents of the range.
+ *
+ * @param file      The path (absolute or relative) to the file
+ * @param offset    The offset of the first byte to read
+ * @param length    The maximum number of bytes to read
+ * @param callback  An optional callback for the range contents
+ * @param priority  The request priority
+ *
+ * @return the future contents of the given range of a file.
+ */
+AsyncIO::ReadFuture AsyncIO::readRange(const Pathname& file, Uint64 offset, Uint64 length,
+                                       ReadCallback callback, int priority) {
+    std::shared_ptr<Request> request = std::make_shared<Request>();
+    request->write  = false;
+    request->path   = file.getAbsoluteName();
+    request->key    = request->path+"#"+std::to_string(offset)+":"+std::to_string(length);
+    request->offset = offset;
+    request->length = length;
+    request->priority = priority;
+    request->readFuture = request->reader.get_future().share();
+    return submit(request,callback,nullptr)->readFuture;
+}
+
+
+#pragma mark -
+#pragma mark Writing
+/**
+ * Returns the future result of atomically writing data to a file.
+ *
+ * The data replaces the contents of the file, which is created if it
+ * does not exist.  The data is moved into the request, so pass it with
+ * std::move to avoid a copy.
+ *
+ * If the file is a relative path, this method will write the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ *
+ * If callback is not nullptr, it will be executed on the main thread
+ * with the result of the write.
+ *
+ * @param file      The path (absolute or relative) to the file
+ * @param data      The data to write
+ * @param callback  An optional callback for the write result
+ * @param priority  The request priority
+ *
+ * @return the future result of atomically writing data to a file.
+ */
+AsyncIO::WriteFuture AsyncIO::writeFile(const Pathname& file, std::string data,
+                                        WriteCallback callback, int priority) {
+    std::shared_ptr<Request> request = std::make_shared<Request>();
+    request->write  = true;
+    request->path   = file.getAbsoluteName();
+    request->key    = request->path;
+    request->offset = 0;
+    request->length = 0;
+    request->priority = priority;
+    request->data = std::move(data);
+    request->writeFuture = request->writer.get_future().share();
+    return submit(request,nullptr,callback)->writeFuture;
+}
+
+
+#pragma mark -
+#pragma mark Synchronization
+/**
+ * Blocks until all pending requests are complete.
+ *
+ * This includes any requests made by other threads while waiting.
+ * Callbacks are not executed by this method; they are still delivered
+ * at the next animation frame.
+ */
+void AsyncIO::wait() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    _idle.wait(lk, [this] { return _pending == 0; });
+}
+
+/**
+ * Returns the number of requests that are not yet complete.
+ *
+ * @return the number of requests that are not yet complete.
+ */
+size_t AsyncIO::getPending() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    return _pending;
+}
+
+/**
+ * Returns the number of requests merged into another request.
+ *
+ * This value is a measure of how much work coalescing has saved.
+ *
+ * @return the number of requests merged into another request.
+ */
+Uint64 AsyncIO::getCoalesced() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    return _coalesced;
+}
+
+
+#pragma mark -
+#pragma mark Internal Methods
+/**
+ * Adds a request to the queue, coalescing it if possible.
+ *
+ * If the request is coalesced, this method returns the request that
+ * absorbed it.  Otherwise it returns the argument.
+ *
+ * @param request   The request to add
+ * @param rcallback The read callback (may be nullptr)
+ * @param wcallback The write callback (may be nullptr)
+ *
+ * @return the request that will satisfy this one
+ */
+std::shared_ptr<AsyncIO::Request> AsyncIO::submit(const std::shared_ptr<Request>& request,
+                                                  ReadCallback rcallback, WriteCallback wcallback) {
+    CUAssertLog(_pool != nullptr, "Service is not initialized");
+    std::shared_ptr<std::string> snapshot = nullptr;
+    std::shared_ptr<Request> result = request;
+    bool immediate = false;
+    {
+        std::unique_lock<std::mutex> lk(_mutex);
+        auto it = _waiting.find(request->key);
+        auto jt = request->write ? _waiting.end() : _waiting.find(request->path);
+        if (it != _waiting.end()) {
+            // Merge into the waiting request
+            result = it->second;
+            if (request->write) {
+                result->data = std::move(request->data);
+            }
+            if (request->priority > result->priority) {
+                result->priority = request->priority;
+                std::make_heap(_queue.begin(),_queue.end(),request_after<Request>);
+            }
+            _coalesced++;
+        } else if (jt != _waiting.end()) {
+            // Read the data that is waiting to be written
+            const std::string& data = jt->second->data;
+            Uint64 offset = std::min(request->offset,(Uint64)data.size());
+            Uint64 length = std::min(request->length,(Uint64)data.size()-offset);
+            if (request->offset <= data.size()) {
+                snapshot = std::make_shared<std::string>(data,(size_t)offset,(size_t)length);
+            }
+            immediate = true;
+            _coalesced++;
+        } else {
+            request->order = _order++;
+            _queue.push_back(request);
+            std::push_heap(_queue.begin(),_queue.end(),request_after<Request>);
+            _waiting[request->key] = request;
+            _pending++;
+            _pool->addTask([this] { this->process(); });
+        }
+        
+        if (rcallback != nullptr) {
+            result->readCallbacks.push_back(rcallback);
+        }
+        if (wcallback != nullptr) {
+            result->writeCallbacks.push_back(wcallback);
+        }
+    }
+    
+    if (immediate) {
+        resolve(request,snapshot);
+    }
+    return result;
+}
+
+/**
+ * Processes the request at the front of the queue.
+ *
+ * This method is executed on a worker thread.  There is one task in
+ * the thread pool for every request in the queue.
+ */
+void AsyncIO::process() {
+    std::shared_ptr<Request> request;
+    {
+        std::unique_lock<std::mutex> lk(_mutex);
+        std::pop_heap(_queue.begin(),_queue.end(),request_after<Request>);
+        request = _queue.back();
+        _queue.pop_back();
+        
+        // Requests on a file wait for any write to it (and writes wait for reads)
+        auto it = _active.find(request->path);
+        if (it != _active.end() && (request->write || it->second < 0)) {
+            _deferred.push_back(request);
+            return;
+        }
+        _waiting.erase(request->key);
+        if (request->write) {
+            _active[request->path] = -1;
+        } else {
+            _active[request->path]++;
+        }
+    }
+    
+    if (request->write) {
+        resolve(request,write_atomic(request->path,request->data));
+    } else {
+        resolve(request,read_range(request->path,request->offset,request->length));
+    }
+    
+    std::unique_lock<std::mutex> lk(_mutex);
+    auto it = _active.find(request->path);
+    if (request->write || it->second == 1) {
+        _active.erase(it);
+        // Requeue anything that was waiting on this file
+        for(auto jt = _deferred.begin(); jt != _deferred.end(); ) {
+            if ((*jt)->path == request->path) {
+                _queue.push_back(*jt);
+                std::push_heap(_queue.begin(),_queue.end(),request_after<Request>);
+                _pool->addTask([this] { this->process(); });
+                jt = _deferred.erase(jt);
+            } else {
+                jt++;
+            }
+        }
+    } else {
+        it->second--;
+    }
+    _pending--;
+    if (_pending == 0) {
+        _idle.notify_all();
+    }
+}
+
+/**
+ * Delivers the result of a read to the request futures and callbacks.
+ *
+ * @param request   The completed request
+ * @param data      The data read (or nullptr on failure)
+ */
+void AsyncIO::resolve(const std::shared_ptr<Request>& request,
+                      const std::shared_ptr<std::string>& data) {
+    request->reader.set_value(data);
+    if (!request->readCallbacks.empty() && Application::get()) {
+        std::vector<ReadCallback> callbacks = std::move(request->readCallbacks);
+        Application::get()->schedule([=](void) {
+            for(auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+                (*it)(data);
+            }
+            return false;
+        });
+    }
+}
+
+/**
+ * Delivers the result of a write to the request futures and callbacks.
+ *
+ * @param request   The completed request
+ * @param success   Whether the write was successful
+ */
+void AsyncIO::resolve(const std::shared_ptr<Request>& request, bool success) {
+    request->writer.set_value(success);
+    if (!request->writeCallbacks.empty() && Application::get()) {
+        std::vector<WriteCallback> callbacks = std::move(request->writeCallbacks);
+        Application::get()->schedule([=](void) {
+            for(auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+                (*it)(success);
+            }
+            return false;
+        });
+    }
+}
@@ -54,6 +54,8 @@
 #include <cugl/util/CUDebug.h>
 #include <cugl/base/CUApplication.h>
 #include <cugl/base/CUEndian.h>
+#include "CUIOSIMD.h"
+#include <algorithm>
 
 using namespace cugl;
 
@@ -106,6 +108,7 @@ bool BinaryReader::init(const Pathname& file, unsigned int capacity) {
     _scursor = 0;
     _capacity = capacity;
     _buffer = new char[_capacity];
+    _window = _buffer;
     _bufsize = 0;
     fill();
     
@@ -164,12 +167,55 @@ bool BinaryReader::initWithAsset(const char* file, unsigned int capacity) {
     _scursor = 0;
     _capacity = capacity;
     _buffer = new char[_capacity];
+    _window = _buffer;
     _bufsize = 0;
     fill();
     
     return _ssize >= 0;
 }
 
+/**
+ * Initializes a memory mapped reader for the given file.
+ *
+ * A mapped reader has no buffer.  Instead, the entire file is readable
+ * at once, and every read is just pointer arithmetic on the file.  This
+ * is the fastest way to read a large file.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool BinaryReader::initMapped(const Pathname& file) {
+    _mapping = MappedFile::alloc(file);
+    return attach();
+}
+
+/**
+ * Initializes a memory mapped reader for the given file.
+ *
+ * A mapped reader has no buffer.  Instead, the entire file is readable
+ * at once, and every read is just pointer arithmetic on the file.  If
+ * the asset cannot be mapped (e.g. it is inside of a packaged archive),
+ * the file is read into memory all at once.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file  the relative path to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool BinaryReader::initMappedWithAsset(const char* file) {
+    _mapping = MappedFile::allocWithAsset(file);
+    return attach();
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -180,15 +226,25 @@ bool BinaryReader::initWithAsset(const char* file, unsigned int capacity) {
  * if the stream has been closed.
  */
 void BinaryReader::reset() {
+    if (_mapped) {
+        if (_mapping == nullptr) {
+            _mapping = MappedFile::alloc(_name);
+            attach();
+        }
+        _bufoff = 0;
+        return;
+    }
     if (_stream) {
         close();
     }
     _stream = SDL_RWFromFile(_name.c_str(), "rb");
     _ssize  = SDL_RWsize(_stream);
     _buffer = new char[_capacity];
+    _window = _buffer;
     _bufsize = 0;
-    _bufoff  = 0;
+    _bufoff  = -1;
     _scursor = 0;
+    fill();
 }
 
 /**
@@ -208,6 +264,12 @@ void BinaryReader::close() {
         _buffer  = nullptr;
         _bufsize = 0;
     }
+    if (_mapping) {
+        _mapping = nullptr;
+        _bufsize = 0;
+        _scursor = 0;
+    }
+    _window = nullptr;
 }
 
 /**
@@ -221,9 +283,12 @@ void BinaryReader::close() {
  * @return true if there is enough data left to read
  */
 bool BinaryReader::ready(unsigned int bytes) const {
-    unsigned int remain = (unsigned int)(_bufsize-_bufoff);
+    if (_window == nullptr) {
+        return false;
+    }
+    Uint64 remain = _bufsize-_bufoff;
     if (remain < bytes) {
-        remain += (unsigned int)(_ssize-_scursor);
+        remain += (Uint64)(_ssize-_scursor);
         return remain >= bytes;
     }
     return true;
@@ -238,13 +303,13 @@ bool BinaryReader::ready(unsigned int bytes) const {
  * @param bytes The minimum number of bytes to ensure in the stream
  */
 void BinaryReader::fill(unsigned int bytes) {
-    if (!_bufoff || !_stream || _scursor == _ssize) {
+    if (!_stream || _scursor == _ssize || (_bufoff == 0 && _bufsize == _capacity)) {
         return;
     }
     
-    if (_bufoff == -1 || _bufoff+bytes > _bufsize) {
-        if (_bufoff < _bufsize) {
-            memcpy(_buffer, &(_buffer[_bufoff]), _bufsize-_bufoff);
+    if (_bufoff == -1 || (Uint64)_bufoff+bytes > _bufsize) {
+        if (_bufoff >= 0 && (Uint64)_bufoff < _bufsize) {
+            memmove(_buffer, &(_buffer[_bufoff]), _bufsize-_bufoff);
             _bufsize -= _bufoff;
         } else {
             _bufsize = 0;
@@ -252,9 +317,101 @@ void BinaryReader::fill(unsigned int bytes) {
         _bufoff   = 0;
     }
     
-    size_t amt = SDL_RWread(_stream, &_buffer[_bufsize], 1, _capacity-_bufsize);
-    _bufsize += (Uint32)amt;
+    size_t amt = readStream(&_buffer[_bufsize], _capacity-_bufsize);
+    _bufsize += amt;
     _scursor += amt;
+    _window = _buffer;
+}
+
+/**
+ * Returns the number of bytes read from the stream into the given buffer
+ *
+ * This is the only method that reads from the underlying stream.  The
+ * default implementation reads the bytes as is.  Subclasses may override
+ * it to decode the file (e.g. to decompress it) before it is buffered.
+ *
+ * @param dst       The buffer to store the bytes read
+ * @param length    The maximum number of bytes to read
+ *
+ * @return the number of bytes read from the stream into the given buffer
+ */
+size_t BinaryReader::readStream(void* dst, size_t length) {
+    return SDL_RWread(_stream, dst, 1, length);
+}
+
+/**
+ * Attaches this reader to the current memory mapping.
+ *
+ * The mapped file becomes the read window of this reader, and so no
+ * further reads from the file are necessary.
+ *
+ * @return true if the mapping is valid
+ */
+bool BinaryReader::attach() {
+    if (_mapping == nullptr) {
+        _window = nullptr;
+        return false;
+    }
+    _name    = _mapping->getName();
+    _mapped  = true;
+    _window  = _mapping->data();
+    _bufsize = _mapping->size();
+    _ssize   = (Sint64)_bufsize;
+    _scursor = _ssize;
+    _bufoff  = 0;
+    return true;
+}
+
+/**
+ * Reads a sequence of values from the stream, marshalling each one.
+ *
+ * The values are copied directly from the read window, and are converted
+ * from network order in bulk.  A buffered reader that must read more than
+ * a buffer's worth of data reads it straight into the array, bypassing
+ * the transfer buffer.
+ *
+ * @param buffer    The array to store the data when read
+ * @param count     The maximum number of values to read from the stream
+ * @param bytes     The size of each value in bytes
+ *
+ * @return the number of values read from the stream
+ */
+size_t BinaryReader::readArray(void* buffer, size_t count, unsigned int bytes) {
+    Uint8* output = (Uint8*)buffer;
+    size_t pos = 0;
+    while (pos < count) {
+        Uint64 available = _bufoff < 0 ? 0 : (_bufsize-_bufoff)/bytes;
+        if (available) {
+            size_t amount = (size_t)std::min<Uint64>(available,count-pos);
+            simd::marshall_copy(output+pos*bytes, _window+_bufoff, amount, bytes);
+            _bufoff += (Sint64)(amount*bytes);
+            pos += amount;
+        } else if (_mapped || !_stream || _scursor >= _ssize) {
+            break;
+        } else if ((count-pos)*bytes >= _capacity && (Uint64)_bufoff == _bufsize) {
+            // Read large arrays in place, keeping any partial value for later
+            Uint8* start = output+pos*bytes;
+            size_t amt = readStream(start, (count-pos)*bytes);
+            if (!amt) {
+                break;
+            }
+            size_t whole = amt/bytes;
+            simd::marshall_copy(start, start, whole, bytes);
+            memcpy(_buffer, start+whole*bytes, amt-whole*bytes);
+            _bufsize = amt-whole*bytes;
+            _bufoff  = 0;
+            _scursor += amt;
+            _window  = _buffer;
+            pos += whole;
+        } else {
+            Sint64 cursor = _scursor;
+            fill(bytes);
+            if (cursor == _scursor) {
+                break;
+            }
+        }
+    }
+    return pos;
 }
 
 #pragma mark -
@@ -266,10 +423,10 @@ void BinaryReader::fill(unsigned int bytes) {
  */
 char BinaryReader::readChar() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _bufsize) {
+    if ((Uint64)_bufoff >= _bufsize) {
         fill(1);
     }
-    return _buffer[_bufoff++];
+    return _window[_bufoff++];
 }
 
 /**
@@ -279,10 +436,10 @@ char BinaryReader::readChar() {
  */
 Uint8 BinaryReader::readByte() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _bufsize) {
+    if ((Uint64)_bufoff >= _bufsize) {
         fill(1);
     }
-    return (Uint8)_buffer[_bufoff++];
+    return (Uint8)_window[_bufoff++];
 }
 
 /**
@@ -295,11 +452,11 @@ Uint8 BinaryReader::readByte() {
  */
 Sint16 BinaryReader::readSint16() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+2 > _bufsize) {
+    if ((Uint64)_bufoff+2 > _bufsize) {
         fill(2);
     }
     CUAssertLog(_bufsize - _bufoff >= 2, "Too few elements remaining in stream");
-    Sint16* ref = (Sint16*)(&_buffer[_bufoff]);
+    Sint16* ref = (Sint16*)(&_window[_bufoff]);
     _bufoff += 2;
     return marshall(*ref);
 }
@@ -314,11 +471,11 @@ Sint16 BinaryReader::readSint16() {
  */
 Uint16 BinaryReader::readUint16() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+2 > _bufsize) {
+    if ((Uint64)_bufoff+2 > _bufsize) {
         fill(2);
     }
     CUAssertLog(_bufsize - _bufoff >= 2, "Too few elements remaining in stream");
-    Uint16* ref = (Uint16*)(&_buffer[_bufoff]);
+    Uint16* ref = (Uint16*)(&_window[_bufoff]);
     _bufoff += 2;
     return marshall(*ref);
 }
@@ -333,11 +490,11 @@ Uint16 BinaryReader::readUint16() {
  */
 Sint32 BinaryReader::readSint32() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+4 > _bufsize) {
+    if ((Uint64)_bufoff+4 > _bufsize) {
         fill(4);
     }
     CUAssertLog(_bufsize - _bufoff >= 4, "Too few elements remaining in stream");
-    Sint32* ref = (Sint32*)(&_buffer[_bufoff]);
+    Sint32* ref = (Sint32*)(&_window[_bufoff]);
     _bufoff += 4;
     return marshall(*ref);
 }
@@ -353,11 +510,11 @@ Sint32 BinaryReader::readSint32() {
  */
 Uint32 BinaryReader::readUint32() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+4 > _bufsize) {
+    if ((Uint64)_bufoff+4 > _bufsize) {
         fill(4);
     }
     CUAssertLog(_bufsize - _bufoff >= 4, "Too few elements remaining in stream");
-    Uint32* ref = (Uint32*)(&_buffer[_bufoff]);
+    Uint32* ref = (Uint32*)(&_window[_bufoff]);
     _bufoff += 4;
     return marshall(*ref);
 }
@@ -373,11 +530,11 @@ Uint32 BinaryReader::readUint32() {
  */
 Sint64 BinaryReader::readSint64() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+8 > _bufsize) {
+    if ((Uint64)_bufoff+8 > _bufsize) {
         fill(8);
     }
     CUAssertLog(_bufsize - _bufoff >= 8, "Too few elements remaining in stream");
-    Sint64* ref = (Sint64*)(&_buffer[_bufoff]);
+    Sint64* ref = (Sint64*)(&_window[_bufoff]);
     _bufoff += 8;
     return marshall(*ref);
 }
@@ -392,11 +549,11 @@ Sint64 BinaryReader::readSint64() {
  */
 Uint64 BinaryReader::readUint64() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+8 > _bufsize) {
+    if ((Uint64)_bufoff+8 > _bufsize) {
         fill(8);
     }
     CUAssertLog(_bufsize - _bufoff >= 8, "Too few elements remaining in stream");
-    Uint64* ref = (Uint64*)(&_buffer[_bufoff]);
+    Uint64* ref = (Uint64*)(&_window[_bufoff]);
     _bufoff += 8;
     return marshall(*ref);
 }
@@ -412,11 +569,11 @@ Uint64 BinaryReader::readUint64() {
  */
 float BinaryReader::readFloat() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+4 > _bufsize) {
+    if ((Uint64)_bufoff+4 > _bufsize) {
         fill(4);
     }
     CUAssertLog(_bufsize - _bufoff >= 4, "Too few elements remaining in stream");
-    float* ref = (float*)(&_buffer[_bufoff]);
+    float* ref = (float*)(&_window[_bufoff]);
     _bufoff += 4;
     return marshall(*ref);
 }
@@ -432,15 +589,47 @@ float BinaryReader::readFloat() {
  */
 double BinaryReader::readDouble()  {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+8 > _bufsize) {
+    if ((Uint64)_bufoff+8 > _bufsize) {
         fill(8);
     }
     CUAssertLog(_bufsize - _bufoff >= 8, "Too few elements remaining in stream");
-    double* ref = (double*)(&_buffer[_bufoff]);
+    double* ref = (double*)(&_window[_bufoff]);
     _bufoff += 8;
     return marshall(*ref);
 }
 
+/**
+ * Returns a pointer to the next given number of bytes in the stream.
+ *
+ * This method does not copy any data.  The pointer references the read
+ * window of this reader, and the bytes are consumed from the stream. For
+ * a mapped reader, the pointer is valid until the reader is closed. For
+ * a buffered reader, the pointer is only valid until the next read, and
+ * the request may not exceed the buffer capacity.
+ *
+ * The bytes are not marshalled in any way.  If there are too few bytes
+ * remaining in the stream, this method returns nullptr and consumes
+ * nothing.
+ *
+ * @param bytes The number of bytes to read
+ *
+ * @return a pointer to the next given number of bytes in the stream.
+ */
+const Uint8* BinaryReader::readSpan(size_t bytes) {
+    if (_window == nullptr) {
+        return nullptr;
+    }
+    if (_bufoff+bytes > _bufsize) {
+        fill((unsigned int)bytes);
+    }
+    if (_bufoff < 0 || _bufoff+bytes > _bufsize) {
+        return nullptr;
+    }
+    const Uint8* result = (const Uint8*)(&_window[_bufoff]);
+    _bufoff += (Sint64)bytes;
+    return result;
+}
+
 
 #pragma mark -
 #pragma mark Array Reads
@@ -458,16 +647,7 @@ double BinaryReader::readDouble()  {
  */
 size_t BinaryReader::read(char* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    while (ready(1) && pos-offset < maximum) {
-        size_t available = _bufsize-_bufoff;
-        size_t wanted = maximum-(pos-offset);
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)wanted;
-    }
-    return pos-offset;
+    return readArray(buffer+offset,maximum,1);
 }
 
 /**
@@ -482,18 +662,9 @@ size_t BinaryReader::read(char* buffer, size_t maximum, size_t offset) {
  *
  * @return the number of bytes read from the stream
  */
-size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
+size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    while (ready(1) && pos-offset < maximum) {
-        size_t available = _bufsize-_bufoff;
-        size_t wanted = maximum-(pos-offset);
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)wanted;
-    }
-    return pos-offset;
+    return readArray(buffer+offset,maximum,1);
 }
 
 /**
@@ -513,21 +684,7 @@ size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
  */
 size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 2;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset,maximum,2);
 }
 
 /**
@@ -545,23 +702,9 @@ size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
  *
  * @return the number of 16 bit unsigned integers read from the stream
  */
-size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
+size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 2;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset,maximum,2);
 }
 
 
@@ -582,21 +725,7 @@ size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
  */
 size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset,maximum,4);
 }
 
 /**
@@ -616,21 +745,7 @@ size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset,maximum,4);
 }
 
 /**
@@ -650,21 +765,7 @@ size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset,maximum,8);
 }
 
 /**
@@ -684,21 +785,7 @@ size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset,maximum,8);
 }
 
 /**
@@ -718,21 +805,7 @@ size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset,maximum,4);
 }
 
 /**
@@ -752,20 +825,6 @@ size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(double* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset,maximum,8);
 }
 
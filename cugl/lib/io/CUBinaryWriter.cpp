@@ -54,6 +54,8 @@
 #include <cugl/base/CUApplication.h>
 #include <cugl/base/CUEndian.h>
 #include <cugl/util/CUDebug.h>
+#include "CUIOSIMD.h"
+#include <algorithm>
 #include <cstring>
 
 using namespace cugl;
@@ -123,7 +125,7 @@ bool BinaryWriter::init(const Pathname& file, unsigned int capacity) {
  * when the buffer fills, or just before the file is closed.
  */
 void BinaryWriter::flush() {
-    size_t amt = SDL_RWwrite(_stream, _cbuffer, 1, _bufoff);
+    size_t amt = writeStream(_cbuffer, _bufoff);
     CUAssertLog(amt == _bufoff, "Unable to fully flush the writer");
     _bufoff = 0;
 }
@@ -147,6 +149,62 @@ void BinaryWriter::close() {
     }
 }
 
+/**
+ * Writes a sequence of values to the binary file, marshalling each one.
+ *
+ * The values are converted to network order in bulk as they are copied
+ * into the write buffer.  If the values need no conversion (e.g. they are
+ * bytes) and there are more than a buffer's worth, they are written to
+ * the file directly, bypassing the buffer.
+ *
+ * @param array  the array of values to write
+ * @param length the number of values to write
+ * @param bytes  the size of each value in bytes
+ */
+void BinaryWriter::writeArray(const void* array, size_t length, unsigned int bytes) {
+    const Uint8* input = (const Uint8*)array;
+#if defined (CU_IO_SWAP)
+    bool direct = bytes == 1;
+#else
+    bool direct = true;
+#endif
+    if (direct && length*bytes >= _capacity) {
+        flush();
+        size_t amt = writeStream(input, length*bytes);
+        CUAssertLog(amt == length*bytes, "Unable to fully write the array");
+        return;
+    }
+
+    size_t pos = 0;
+    while (pos < length) {
+        size_t room = (_capacity-_bufoff)/bytes;
+        if (!room) {
+            flush();
+            continue;
+        }
+        size_t amount = std::min(room,length-pos);
+        simd::marshall_copy(&(_cbuffer[_bufoff]), input+pos*bytes, amount, bytes);
+        _bufoff += (Sint32)(amount*bytes);
+        pos += amount;
+    }
+}
+
+/**
+ * Writes the given bytes to the underlying stream.
+ *
+ * This is the only method that writes to the underlying stream.  The
+ * default implementation writes the bytes as is.  Subclasses may override
+ * it to encode the file (e.g. to compress it) as it is written.
+ *
+ * @param src       The bytes to write
+ * @param length    The number of bytes to write
+ *
+ * @return the number of bytes written to the stream
+ */
+size_t BinaryWriter::writeStream(const void* src, size_t length) {
+    return SDL_RWwrite(_stream, src, 1, length);
+}
+
 
 #pragma mark -
 #pragma mark Single Element Writes
@@ -387,20 +445,7 @@ void BinaryWriter::writeDouble(double n) {
  */
 void BinaryWriter::write(const char* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    if (_bufoff+length > _capacity) {
-        flush();
-    }
-    while (length-pos > _capacity-_bufoff) {
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]),_capacity-_bufoff);
-        pos += _capacity-_bufoff;
-        _bufoff = _capacity;
-        flush();
-    }
-    
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), length-pos);
-    _bufoff += (Sint32)(length-pos);
+    writeArray(array+offset,length,1);
 }
 
 /**
@@ -416,20 +461,7 @@ void BinaryWriter::write(const char* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint8* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-        
-    if (_bufoff+length > _capacity) {
-        flush();
-    }
-    while (length-pos > _capacity-_bufoff) {
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]),_capacity-_bufoff);
-        pos += _capacity-_bufoff;
-        _bufoff = _capacity;
-        flush();
-    }
-        
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), length-pos);
-    _bufoff += (Sint32)(length-pos);
+    writeArray(array+offset,length,1);
 }
 
 /**
@@ -448,34 +480,7 @@ void BinaryWriter::write(const Uint8* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Sint16* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 2;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint16* ref = (Sint16*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint16* ref = (Sint16*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-
-    _bufoff += skip;
+    writeArray(array+offset,length,2);
 }
 
 /**
@@ -494,34 +499,7 @@ void BinaryWriter::write(const Sint16* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint16* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 2;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint16* ref = (Uint16*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint16* ref = (Uint16*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset,length,2);
 }
 
 /**
@@ -540,34 +518,7 @@ void BinaryWriter::write(const Uint16* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Sint32* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint32* ref = (Sint32*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint32* ref = (Sint32*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset,length,4);
 }
 
 
@@ -587,34 +538,7 @@ void BinaryWriter::write(const Sint32* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint32* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint32* ref = (Uint32*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint32* ref = (Uint32*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset,length,4);
 }
 
 
@@ -634,34 +558,7 @@ void BinaryWriter::write(const Uint32* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Sint64* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint64* ref = (Sint64*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint64* ref = (Sint64*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset,length,8);
 }
 
 
@@ -681,34 +578,7 @@ void BinaryWriter::write(const Sint64* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint64* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint64* ref = (Uint64*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint64* ref = (Uint64*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset,length,8);
 }
 
 
@@ -728,34 +598,7 @@ void BinaryWriter::write(const Uint64* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const float* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            float* ref = (float*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        float* ref = (float*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset,length,4);
 }
 
 /**
@@ -774,32 +617,5 @@ void BinaryWriter::write(const float* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const double* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            double* ref = (double*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        double* ref = (double*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset,length,8);
 }
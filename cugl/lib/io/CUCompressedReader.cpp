@@ -0,0 +1,383 @@
+//
+//  CUCompressedReader.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a binary reader for compressed files.  The file is
+//  decompressed a block at a time as it is read, so the reader never needs
+//  more memory than a single block.  Otherwise, it is identical to a normal
+//  BinaryReader, and all data is marshalled from network order.
+//
+//  Compressed files are created with either CompressedWriter or the container
+//  functions in CUCompression.h.  This reader also has support for JSON,
+//  making it suitable for compressed save files.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.  Keep in mind that
+//  absolute paths are very dangerous on mobile devices, because they do not
+//  have proper file systems.  You should confine all files to either the asset
+//  or the save directory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/io/CUCompressedReader.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/base/CUEndian.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace cugl;
+
+#define BUFFSIZE 1024
+/** The maximum compression ratio of a block */
+#define MAX_RATIO 255
+
+#pragma mark -
+#pragma mark Constructors
+
+/**
+ * Initializes a reader for the given file.
+ *
+ * The reader will have the default buffer capacity for reading chunks from
+ * the file.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool CompressedReader::init(const Pathname& file) {
+    return init(file,BUFFSIZE);
+}
+
+/**
+ * Initializes a reader for the given file with the specified capacity.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file      the path (absolute or relative) to the file
+ * @param capacity  the buffer capacity for reading chunks
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool CompressedReader::init(const Pathname& file, unsigned int capacity) {
+    CUAssertLog(capacity, "The buffer capacity must be positive");
+    _name = file.getAbsoluteName();
+    return open(capacity);
+}
+
+/**
+ * Initializes a reader for the given file.
+ *
+ * The reader will have the default buffer capacity for reading chunks from
+ * the file.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file  the relative path to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool CompressedReader::initWithAsset(const char* file) {
+    return initWithAsset(file,BUFFSIZE);
+}
+
+/**
+ * Initializes a reader for the given file with the specified capacity.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file      the relative path to the file
+ * @param capacity  the buffer capacity for reading chunks
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool CompressedReader::initWithAsset(const char* file, unsigned int capacity) {
+    CUAssertLog(capacity, "The buffer capacity must be positive");
+    
+    // Check if the path is absolute
+#if defined (__WINDOWS__)
+    bool absolute = (bool)strstr(file,":");
+#else
+    bool absolute = file[0] == '/';
+#endif
+    CUAssertLog(!absolute, "This initializer does not accept absolute paths");
+    
+    _name = Application::get()->getAssetDirectory();
+    _name.append(file);
+    return open(capacity);
+}
+
+
+#pragma mark -
+#pragma mark Internal Methods
+/**
+ * Returns true if the file was opened and its header is valid
+ *
+ * This method opens the file named by this reader, reads the container
+ * header, and allocates the read buffer.  The file must already be set.
+ *
+ * @param capacity  the buffer capacity for reading chunks
+ *
+ * @return true if the file was opened and its header is valid
+ */
+bool CompressedReader::open(unsigned int capacity) {
+    _stream = SDL_RWFromFile(_name.c_str(), "rb");
+    if (!_stream) {
+        return false;
+    }
+    
+    Uint8 header[CU_COMPRESSION_HEADER];
+    _filesize = SDL_RWsize(_stream);
+    if (SDL_RWread(_stream, header, 1, CU_COMPRESSION_HEADER) != CU_COMPRESSION_HEADER ||
+        !compression::isCompressed(header, CU_COMPRESSION_HEADER)) {
+        CULogError("The file %s is not compressed", _name.c_str());
+        SDL_RWclose(_stream);
+        _stream = nullptr;
+        return false;
+    }
+    
+    Uint32 value32;
+    memcpy(&value32,header+4,4);
+    _blocksize = marshall(value32);
+    Uint64 value64;
+    memcpy(&value64,header+8,8);
+    _ssize = (Sint64)marshall(value64);
+    _filepos  = CU_COMPRESSION_HEADER;
+    _decoded  = 0;
+    _blocklen = 0;
+    _blockoff = 0;
+    
+    _scursor = 0;
+    _capacity = capacity;
+    _buffer = new char[_capacity];
+    _window = _buffer;
+    _bufsize = 0;
+    _bufoff  = -1;
+    fill();
+    
+    return _ssize >= 0;
+}
+
+/**
+ * Returns the number of bytes decompressed into the given buffer
+ *
+ * This method decompresses the next block in the file.  If the block
+ * fits in the buffer, it is decompressed directly into the buffer.
+ * Otherwise, it is decompressed into the block buffer of this reader,
+ * and this method returns 0.  If the block is corrupt, this method
+ * returns -1.
+ *
+ * @param dst   The buffer to store the bytes read
+ * @param room  The capacity of the buffer
+ *
+ * @return the number of bytes decompressed into the given buffer
+ */
+Sint64 CompressedReader::readBlock(Uint8* dst, size_t room) {
+    Uint8 frame[CU_COMPRESSION_FRAME];
+    if (_filesize-_filepos < CU_COMPRESSION_FRAME ||
+        SDL_RWread(_stream, frame, 1, CU_COMPRESSION_FRAME) != CU_COMPRESSION_FRAME) {
+        return -1;
+    }
+    _filepos += CU_COMPRESSION_FRAME;
+    
+    Uint32 value32;
+    memcpy(&value32,frame,4);
+    size_t raw = marshall(value32);
+    memcpy(&value32,frame+4,4);
+    Uint32 marker = marshall(value32);
+    size_t packed = marker & ~CU_COMPRESSION_STORED;
+    bool stored = marker & CU_COMPRESSION_STORED;
+    
+    // Validate the frame before allocating anything
+    if (!raw || raw > _blocksize || raw > (Uint64)_ssize-_decoded ||
+        packed > (Uint64)(_filesize-_filepos)) {
+        return -1;
+    } else if (stored ? packed != raw : (packed > compression::bound(raw) || raw/MAX_RATIO > packed)) {
+        return -1;
+    }
+    
+    Uint8* target = dst;
+    if (room < raw) {
+        if (_block.size() < raw) {
+            _block.resize(raw);
+        }
+        target = _block.data();
+    }
+    
+    if (stored) {
+        if (SDL_RWread(_stream, target, 1, raw) != raw) {
+            return -1;
+        }
+    } else {
+        if (_packed.size() < packed) {
+            _packed.resize(packed);
+        }
+        if (SDL_RWread(_stream, _packed.data(), 1, packed) != packed ||
+            compression::decompressBlock(_packed.data(), packed, target, raw) != (Sint64)raw) {
+            return -1;
+        }
+    }
+    _filepos += packed;
+    _decoded += raw;
+    
+    if (target == dst) {
+        return (Sint64)raw;
+    }
+    _blocklen = raw;
+    _blockoff = 0;
+    return 0;
+}
+
+/**
+ * Returns the number of bytes decompressed into the given buffer
+ *
+ * This method decompresses as many blocks as necessary to fill the buffer.
+ * Any part of a block that does not fit is saved for the next call.
+ *
+ * @param dst       The buffer to store the bytes read
+ * @param length    The maximum number of bytes to read
+ *
+ * @return the number of bytes decompressed into the given buffer
+ */
+size_t CompressedReader::readStream(void* dst, size_t length) {
+    Uint8* output = (Uint8*)dst;
+    size_t total = 0;
+    while (total < length) {
+        if (_blockoff < _blocklen) {
+            size_t amt = std::min(_blocklen-_blockoff,length-total);
+            memcpy(output+total, _block.data()+_blockoff, amt);
+            _blockoff += amt;
+            total += amt;
+        } else if (_decoded >= (Uint64)_ssize) {
+            break;
+        } else {
+            Sint64 amt = readBlock(output+total, length-total);
+            if (amt < 0) {
+                CULogError("The compressed file %s is corrupt", _name.c_str());
+                // Stop the reader at the last valid block
+                _ssize = _scursor+(Sint64)total;
+                break;
+            }
+            total += (size_t)amt;
+        }
+    }
+    return total;
+}
+
+
+#pragma mark -
+#pragma mark Stream Management
+/**
+ * Resets the stream back to the beginning
+ *
+ * This allows the stream to be read a second time.  It may even be called
+ * if the stream has been closed.
+ */
+void CompressedReader::reset() {
+    close();
+    open(_capacity);
+}
+
+/**
+ * Closes the stream, releasing all resources
+ *
+ * Any attempts to read from a closed stream will fail.  Calling this method
+ * on a previously closed stream has no effect.
+ */
+void CompressedReader::close() {
+    BinaryReader::close();
+    _packed.clear();
+    _packed.shrink_to_fit();
+    _block.clear();
+    _block.shrink_to_fit();
+    _blocklen = 0;
+    _blockoff = 0;
+}
+
+
+#pragma mark -
+#pragma mark Bulk Reads
+/**
+ * Returns the remainder of the file as a string.
+ *
+ * The string is the decompressed data from the current position to the
+ * end of the file.  It is empty if the stream is finished or closed.
+ *
+ * @return the remainder of the file as a string.
+ */
+std::string CompressedReader::readAll() {
+    std::string result;
+    if (!ready()) {
+        return result;
+    }
+    
+    Uint64 remain = (Uint64)(_ssize-_scursor);
+    remain += _bufsize-(Uint64)std::max<Sint64>(_bufoff,0);
+    // A corrupt header may claim more data than the file could hold
+    remain = std::min(remain,(Uint64)_filesize*MAX_RATIO+_bufsize);
+    result.resize((size_t)remain);
+    size_t amt = read(&result[0], (size_t)remain);
+    result.resize(amt);
+    return result;
+}
+
+/**
+ * Returns the remainder of the file as a JSON value.
+ *
+ * The remainder of the file must be a single JSON string, such as one
+ * written by {@link CompressedWriter#writeJson}.  This method returns
+ * nullptr if the stream is finished or closed.
+ *
+ * @return the remainder of the file as a JSON value.
+ */
+std::shared_ptr<JsonValue> CompressedReader::readJson() {
+    std::string json = readAll();
+    if (json.empty()) {
+        return nullptr;
+    }
+    return JsonValue::allocWithJson(json);
+}
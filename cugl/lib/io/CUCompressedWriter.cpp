@@ -0,0 +1,234 @@
+//
+//  CUCompressedWriter.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a binary writer for compressed files.  The data is
+//  compressed a block at a time as it is written, so the writer never needs
+//  more memory than a single block.  Otherwise, it is identical to a normal
+//  BinaryWriter, and all data is marshalled to network order.
+//
+//  The files are in the container format of CUCompression.h, and are read
+//  with CompressedReader.  This writer also has support for JSON, making it
+//  suitable for compressed save files.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.  Keep in mind that
+//  absolute paths are very dangerous on mobile devices, because they do not
+//  have proper file systems.  You should confine all files to either the asset
+//  or the save directory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/io/CUCompressedWriter.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <cugl/base/CUEndian.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace cugl;
+
+#define BUFFSIZE 1024
+
+#pragma mark -
+#pragma mark Constructors
+
+/**
+ * Initializes a writer for the given file.
+ *
+ * The writer will have the default buffer capacity for writing chunks to
+ * the file.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to write a file in any other directory, you must provide
+ * an absolute path. Be warned, however, that write priviledges are
+ * heavily restricted on mobile platforms.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the writer is initialized properly, false otherwise.
+ */
+bool CompressedWriter::init(const Pathname& file) {
+    return init(file,BUFFSIZE);
+}
+
+/**
+ * Initializes a writer for the given file with the specified capacity.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to write a file in any other directory, you must provide
+ * an absolute path. Be warned, however, that write priviledges are
+ * heavily restricted on mobile platforms.
+ *
+ * @param file      the path (absolute or relative) to the file
+ * @param capacity  the buffer capacity for reading chunks
+ *
+ * @return true if the writer is initialized properly, false otherwise.
+ */
+bool CompressedWriter::init(const Pathname& file, unsigned int capacity) {
+    if (!BinaryWriter::init(file,capacity)) {
+        return false;
+    }
+    
+    _block.resize(CU_COMPRESSION_BLOCK);
+    _packed.resize(CU_COMPRESSION_BLOCK);
+    _blocklen = 0;
+    _total = 0;
+    
+    // The total size is not known until the file is closed
+    Uint8 header[CU_COMPRESSION_HEADER];
+    memcpy(header,CU_COMPRESSION_MAGIC,4);
+    Uint32 value32 = marshall((Uint32)CU_COMPRESSION_BLOCK);
+    memcpy(header+4,&value32,4);
+    memset(header+8,0,8);
+    return SDL_RWwrite(_stream, header, 1, CU_COMPRESSION_HEADER) == CU_COMPRESSION_HEADER;
+}
+
+
+#pragma mark -
+#pragma mark Internal Methods
+/**
+ * Compresses the given block and writes it to the file.
+ *
+ * If the block does not compress, it is stored as is.
+ *
+ * @param data      The uncompressed data
+ * @param length    The number of uncompressed bytes
+ */
+void CompressedWriter::writeBlock(const Uint8* data, size_t length) {
+    size_t packed = compression::compressBlock(data, length, _packed.data(), length-1);
+    const Uint8* output = _packed.data();
+    Uint32 marker = (Uint32)packed;
+    if (!packed) {
+        output = data;
+        packed = length;
+        marker = (Uint32)length | CU_COMPRESSION_STORED;
+    }
+    
+    Uint8 frame[CU_COMPRESSION_FRAME];
+    Uint32 value32 = marshall((Uint32)length);
+    memcpy(frame,&value32,4);
+    value32 = marshall(marker);
+    memcpy(frame+4,&value32,4);
+    
+    size_t amt = SDL_RWwrite(_stream, frame, 1, CU_COMPRESSION_FRAME);
+    amt += SDL_RWwrite(_stream, output, 1, packed);
+    CUAssertLog(amt == packed+CU_COMPRESSION_FRAME, "Unable to fully write the block");
+    _total += length;
+}
+
+/**
+ * Writes the given bytes to the underlying stream.
+ *
+ * The bytes are added to the current block, which is compressed and
+ * written whenever it is full.
+ *
+ * @param src       The bytes to write
+ * @param length    The number of bytes to write
+ *
+ * @return the number of bytes written to the stream
+ */
+size_t CompressedWriter::writeStream(const void* src, size_t length) {
+    const Uint8* input = (const Uint8*)src;
+    size_t pos = 0;
+    while (pos < length) {
+        if (_blocklen == 0 && length-pos >= _block.size()) {
+            // Compress whole blocks without copying them
+            writeBlock(input+pos, _block.size());
+            pos += _block.size();
+        } else {
+            size_t amt = std::min(_block.size()-_blocklen,length-pos);
+            memcpy(_block.data()+_blocklen, input+pos, amt);
+            _blocklen += amt;
+            pos += amt;
+            if (_blocklen == _block.size()) {
+                writeBlock(_block.data(), _blocklen);
+                _blocklen = 0;
+            }
+        }
+    }
+    return length;
+}
+
+
+#pragma mark -
+#pragma mark Stream Management
+/**
+ * Closes the stream, releasing all resources
+ *
+ * The contents of the buffer are compressed and flushed before the file
+ * is closed, and the header is updated with the total size.  Any attempts
+ * to write to a closed stream will fail.  Calling this method on a
+ * previously closed stream has no effect.
+ */
+void CompressedWriter::close() {
+    if (_stream) {
+        flush();
+        if (_blocklen) {
+            writeBlock(_block.data(), _blocklen);
+            _blocklen = 0;
+        }
+        Uint64 value64 = marshall(_total);
+        if (SDL_RWseek(_stream, 8, RW_SEEK_SET) != 8 ||
+            SDL_RWwrite(_stream, &value64, 1, 8) != 8) {
+            CULogError("Unable to complete the compressed file %s", _name.c_str());
+        }
+    }
+    BinaryWriter::close();
+    _block.clear();
+    _block.shrink_to_fit();
+    _packed.clear();
+    _packed.shrink_to_fit();
+}
+
+
+#pragma mark -
+#pragma mark JSON Writes
+/**
+ * Writes a JsonValue to the file.
+ *
+ * The JSON may either be pretty-printed or condensed depending on the
+ * value of format.  By default, we condense the JSON string, as it is
+ * not meant to be read by a person.
+ *
+ * @param json      The JSON value to write
+ * @param format    Whether to pretty-print the JSON string
+ */
+void CompressedWriter::writeJson(const JsonValue* json, bool format) {
+    CUAssertLog(json, "Attempt to write a nullptr JSON");
+    std::string data = json->toString(format);
+    write(data.data(), data.size());
+}
@@ -0,0 +1,547 @@
+//
+//  CUCompression.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a fast, dependency-free compression codec for save
+//  data and asset payloads.  The block codec produces the LZ4 block format,
+//  which trades some compression ratio for very fast decompression.  Larger
+//  payloads are split into independent blocks inside a small container, so
+//  that they can be compressed and decompressed in a streaming fashion.
+//
+//  The container format is shared with CompressedWriter and CompressedReader.
+//  So a buffer compressed with these functions can be read as a file by a
+//  CompressedReader, and vice versa.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/io/CUCompression.h>
+#include <cugl/base/CUEndian.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace cugl;
+
+/** The minimum length of a match */
+#define MIN_MATCH       4
+/** The number of bytes at the end of a block that must be literals */
+#define LAST_LITERALS   5
+/** The minimum distance from the end of a block for a match to start */
+#define MATCH_LIMIT     12
+/** The maximum offset of a match */
+#define MAX_DISTANCE    65535
+/** The largest block that may be compressed */
+#define MAX_BLOCK       0x7E000000
+/** The log of the size of the match hash table */
+#define HASH_LOG        12
+/** The number of failed searches before the search step grows */
+#define SKIP_TRIGGER    6
+/** The number of bytes copied at once when the decoder is away from the ends */
+#define FAST_MARGIN     16
+
+#pragma mark -
+#pragma mark Block Helpers
+/**
+ * Returns the 32-bit value at the given (unaligned) position
+ *
+ * @param p The position to read
+ *
+ * @return the 32-bit value at the given (unaligned) position
+ */
+static inline Uint32 read32(const Uint8* p) {
+    Uint32 result;
+    memcpy(&result,p,4);
+    return result;
+}
+
+/**
+ * Returns the 64-bit value at the given (unaligned) position
+ *
+ * @param p The position to read
+ *
+ * @return the 64-bit value at the given (unaligned) position
+ */
+static inline Uint64 read64(const Uint8* p) {
+    Uint64 result;
+    memcpy(&result,p,8);
+    return result;
+}
+
+/**
+ * Returns the hash table slot for the four bytes at the given position
+ *
+ * @param p The position to hash
+ *
+ * @return the hash table slot for the four bytes at the given position
+ */
+static inline Uint32 hash4(const Uint8* p) {
+    return (read32(p)*2654435761u) >> (32-HASH_LOG);
+}
+
+/**
+ * Returns the number of equal bytes at the two positions
+ *
+ * The comparison stops at the given limit of the first position.
+ *
+ * @param ip    The current position
+ * @param ref   The earlier position to match against
+ * @param limit The limit of the current position
+ *
+ * @return the number of equal bytes at the two positions
+ */
+static inline size_t match_length(const Uint8* ip, const Uint8* ref, const Uint8* limit) {
+    const Uint8* start = ip;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    while (ip+8 <= limit) {
+        Uint64 diff = read64(ip)^read64(ref);
+        if (diff) {
+            while (!(diff & 0xff)) {
+                diff >>= 8;
+                ip++;
+            }
+            return ip-start;
+        }
+        ip += 8;
+        ref += 8;
+    }
+#endif
+    while (ip < limit && *ip == *ref) {
+        ip++;
+        ref++;
+    }
+    return ip-start;
+}
+
+/**
+ * Returns the output position after writing a length extension
+ *
+ * Lengths of 15 or more are stored as a series of 255s followed by the
+ * remainder.  The output must have room for length/255+1 bytes.
+ *
+ * @param op        The output position
+ * @param length    The length (minus the 15 stored in the token)
+ *
+ * @return the output position after writing a length extension
+ */
+static inline Uint8* write_length(Uint8* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (Uint8)length;
+    return op;
+}
+
+/**
+ * Returns true if the length extension was read successfully
+ *
+ * The extension bytes are added to the given length.  This function returns
+ * false if the extension runs past the end of the input.
+ *
+ * @param ip        The input position
+ * @param iend      The end of the input
+ * @param length    The length to extend
+ *
+ * @return true if the length extension was read successfully
+ */
+static inline bool read_length(const Uint8*& ip, const Uint8* iend, size_t& length) {
+    Uint8 extra;
+    do {
+        if (ip >= iend) {
+            return false;
+        }
+        extra = *ip++;
+        length += extra;
+    } while (extra == 255);
+    return true;
+}
+
+/**
+ * Returns the output position after writing a sequence
+ *
+ * A sequence is a run of literals, optionally followed by a match.  The
+ * final sequence of a block has no match (which is marked by a match
+ * length of 0).  This function returns nullptr if the sequence does not
+ * fit in the output.
+ *
+ * @param op        The output position
+ * @param oend      The end of the output
+ * @param literals  The literals to copy
+ * @param litlen    The number of literals
+ * @param offset    The match offset
+ * @param matchlen  The match length (0 for the last sequence)
+ *
+ * @return the output position after writing a sequence
+ */
+static inline Uint8* write_sequence(Uint8* op, Uint8* oend, const Uint8* literals, size_t litlen,
+                                    size_t offset, size_t matchlen) {
+    // Worst case for the lengths, token, and offset
+    if ((size_t)(oend-op) < 1+litlen+litlen/255+1+2+(matchlen/255+1)) {
+        return nullptr;
+    }
+    
+    Uint8* token = op++;
+    if (litlen >= 15) {
+        *token = 15 << 4;
+        op = write_length(op,litlen-15);
+    } else {
+        *token = (Uint8)(litlen << 4);
+    }
+    if (matchlen && (size_t)(oend-op) >= litlen+8) {
+        // Copy 8 bytes at a time, as the excess is overwritten (a match
+        // is never within MATCH_LIMIT of the end, so this stays in bounds)
+        Uint8* end = op+litlen;
+        while (op < end) {
+            memcpy(op,literals,8);
+            op += 8;
+            literals += 8;
+        }
+        op = end;
+    } else {
+        memcpy(op,literals,litlen);
+        op += litlen;
+    }
+    if (!matchlen) {
+        return op;
+    }
+    
+    *op++ = (Uint8)(offset & 0xff);
+    *op++ = (Uint8)(offset >> 8);
+    matchlen -= MIN_MATCH;
+    if (matchlen >= 15) {
+        *token |= 15;
+        op = write_length(op,matchlen-15);
+    } else {
+        *token |= (Uint8)matchlen;
+    }
+    return op;
+}
+
+
+#pragma mark -
+#pragma mark Block Functions
+/**
+ * Returns the maximum compressed size of a block of the given size.
+ *
+ * This is the capacity required to guarantee that {@link compressBlock}
+ * succeeds.  Incompressible data grows by less than 0.5%.
+ *
+ * @param size  The uncompressed size
+ *
+ * @return the maximum compressed size of a block of the given size.
+ */
+size_t compression::bound(size_t size) {
+    return size+size/255+16;
+}
+
+/**
+ * Returns the size of the data after compressing it into the destination.
+ *
+ * The compressed data is in the LZ4 block format.  This function returns
+ * 0 if the destination capacity is too small, or if the source is larger
+ * than 2 GB.  A capacity of {@link bound} is always large enough.
+ *
+ * @param src       The data to compress
+ * @param size      The number of bytes to compress
+ * @param dst       The buffer to store the compressed data
+ * @param capacity  The capacity of the destination buffer
+ *
+ * @return the size of the data after compressing it into the destination.
+ */
+size_t compression::compressBlock(const void* src, size_t size, void* dst, size_t capacity) {
+    if (size > MAX_BLOCK) {
+        return 0;
+    }
+    
+    const Uint8* base   = (const Uint8*)src;
+    const Uint8* iend   = base+size;
+    const Uint8* anchor = base;
+    Uint8* op   = (Uint8*)dst;
+    Uint8* oend = op+capacity;
+    
+    if (size >= MATCH_LIMIT+1) {
+        // Positions are stored relative to the base; 0 means empty
+        Uint32 table[1 << HASH_LOG];
+        memset(table,0,sizeof(table));
+        
+        const Uint8* mflimit = iend-MATCH_LIMIT;
+        const Uint8* mlimit  = iend-LAST_LITERALS;
+        const Uint8* ip = base;
+        table[hash4(ip)] = 0;
+        ip++;
+        
+        Uint32 searches = 1 << SKIP_TRIGGER;
+        while (ip <= mflimit) {
+            Uint32 slot = hash4(ip);
+            const Uint8* ref = base+table[slot];
+            table[slot] = (Uint32)(ip-base);
+            if (ref >= ip || ip-ref > MAX_DISTANCE || read32(ref) != read32(ip)) {
+                // Search faster through data that does not compress
+                ip += searches++ >> SKIP_TRIGGER;
+                continue;
+            }
+            searches = 1 << SKIP_TRIGGER;
+            
+            // Extend the match backwards over the pending literals
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            
+            size_t length = MIN_MATCH+match_length(ip+MIN_MATCH,ref+MIN_MATCH,mlimit);
+            op = write_sequence(op,oend,anchor,ip-anchor,ip-ref,length);
+            if (!op) {
+                return 0;
+            }
+            ip += length;
+            anchor = ip;
+            
+            // Seed the table with a position inside the match
+            if (ip <= mflimit) {
+                table[hash4(ip-2)] = (Uint32)(ip-2-base);
+            }
+        }
+    }
+    
+    op = write_sequence(op,oend,anchor,iend-anchor,0,0);
+    return op ? op-(Uint8*)dst : 0;
+}
+
+/**
+ * Returns the size of the data after decompressing it into the destination.
+ *
+ * The source must be a complete block in the LZ4 block format.  This
+ * function never reads past the end of the source or writes past the
+ * destination capacity, so it is safe on corrupt data.  It returns -1
+ * if the data is corrupt or the capacity is too small.
+ *
+ * @param src       The data to decompress
+ * @param size      The number of compressed bytes
+ * @param dst       The buffer to store the decompressed data
+ * @param capacity  The capacity of the destination buffer
+ *
+ * @return the size of the data after decompressing it into the destination.
+ */
+Sint64 compression::decompressBlock(const void* src, size_t size, void* dst, size_t capacity) {
+    const Uint8* ip   = (const Uint8*)src;
+    const Uint8* iend = ip+size;
+    Uint8* base = (Uint8*)dst;
+    Uint8* op   = base;
+    Uint8* oend = base+capacity;
+    
+    while (ip < iend) {
+        Uint8 token = *ip++;
+        size_t length = token >> 4;
+        if (length < 15 && (size_t)(iend-ip) >= FAST_MARGIN+2 && (size_t)(oend-op) >= 2*FAST_MARGIN) {
+            // Short literals away from the ends are copied as a fixed 16 bytes
+            memcpy(op,ip,FAST_MARGIN);
+            op += length;
+            ip += length;
+        } else {
+            if (length == 15 && !read_length(ip,iend,length)) {
+                return -1;
+            }
+            if ((size_t)(iend-ip) < length || (size_t)(oend-op) < length) {
+                return -1;
+            } else if (length) {
+                memcpy(op,ip,length);
+                op += length;
+                ip += length;
+            }
+            if (ip == iend) {
+                // The last sequence has no match
+                break;
+            } else if (iend-ip < 2) {
+                return -1;
+            }
+        }
+        
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (!offset || offset > (size_t)(op-base)) {
+            return -1;
+        }
+        
+        const Uint8* ref = op-offset;
+        length = token & 15;
+        if (length < 15 && offset >= 8 && (size_t)(oend-op) >= FAST_MARGIN+2) {
+            // Short matches are copied as a fixed 18 bytes (each 8 byte chunk is disjoint)
+            memcpy(op,ref,8);
+            memcpy(op+8,ref+8,8);
+            memcpy(op+16,ref+16,2);
+            op += length+MIN_MATCH;
+            continue;
+        }
+        
+        if (length == 15 && !read_length(ip,iend,length)) {
+            return -1;
+        }
+        length += MIN_MATCH;
+        if ((size_t)(oend-op) < length) {
+            return -1;
+        }
+        
+        if (offset >= length) {
+            memcpy(op,ref,length);
+            op += length;
+        } else if (offset >= 8) {
+            // Overlapping, but each 8 byte chunk is disjoint
+            Uint8* end = op+length;
+            while (op+8 <= end) {
+                memcpy(op,ref,8);
+                op += 8;
+                ref += 8;
+            }
+            while (op < end) {
+                *op++ = *ref++;
+            }
+        } else {
+            // A short repeating pattern
+            for(size_t ii = 0; ii < length; ii++) {
+                op[ii] = ref[ii];
+            }
+            op += length;
+        }
+    }
+    return op-base;
+}
+
+
+#pragma mark -
+#pragma mark Container Functions
+/**
+ * Returns the given data compressed into a container.
+ *
+ * @param data  The data to compress
+ * @param block The maximum number of uncompressed bytes in a block
+ *
+ * @return the given data compressed into a container.
+ */
+std::string compression::compress(const std::string& data, size_t block) {
+    CUAssertLog(block > 0 && block <= MAX_BLOCK, "Block size %zu is invalid", block);
+    std::string result;
+    size_t blocks = (data.size()+block-1)/block;
+    result.resize(CU_COMPRESSION_HEADER+blocks*CU_COMPRESSION_FRAME+bound(data.size()));
+    
+    Uint8* output = (Uint8*)&result[0];
+    memcpy(output,CU_COMPRESSION_MAGIC,4);
+    Uint32 value32 = marshall((Uint32)block);
+    memcpy(output+4,&value32,4);
+    Uint64 value64 = marshall((Uint64)data.size());
+    memcpy(output+8,&value64,8);
+    
+    size_t pos = CU_COMPRESSION_HEADER;
+    const Uint8* input = (const Uint8*)data.data();
+    for(size_t off = 0; off < data.size(); off += block) {
+        size_t raw = std::min(block,data.size()-off);
+        Uint8* frame = output+pos;
+        pos += CU_COMPRESSION_FRAME;
+        size_t packed = compressBlock(input+off, raw, output+pos, raw-1);
+        Uint32 marker = (Uint32)packed;
+        if (!packed) {
+            memcpy(output+pos,input+off,raw);
+            packed = raw;
+            marker = (Uint32)raw | CU_COMPRESSION_STORED;
+        }
+        value32 = marshall((Uint32)raw);
+        memcpy(frame,&value32,4);
+        value32 = marshall(marker);
+        memcpy(frame+4,&value32,4);
+        pos += packed;
+    }
+    result.resize(pos);
+    return result;
+}
+
+/**
+ * Returns true if the container was decompressed successfully.
+ *
+ * The decompressed data is appended to the result.  If the container is
+ * corrupt, this function returns false, and the contents of result are
+ * unspecified.
+ *
+ * @param data      The container to decompress
+ * @param result    The string to store the decompressed data
+ *
+ * @return true if the container was decompressed successfully.
+ */
+bool compression::decompress(const std::string& data, std::string& result) {
+    if (!isCompressed(data.data(),data.size())) {
+        return false;
+    }
+    const Uint8* input = (const Uint8*)data.data();
+    Uint32 value32;
+    memcpy(&value32,input+4,4);
+    size_t block = marshall(value32);
+    Uint64 value64;
+    memcpy(&value64,input+8,8);
+    Uint64 total = marshall(value64);
+    if (total > (Uint64)(data.size()-CU_COMPRESSION_HEADER)*255+block) {
+        // No block can expand more than this
+        return false;
+    }
+    
+    size_t start = result.size();
+    result.resize(start+(size_t)total);
+    Uint8* output = (Uint8*)&result[0]+start;
+    size_t pos = CU_COMPRESSION_HEADER;
+    size_t out = 0;
+    while (out < total) {
+        if (data.size()-pos < CU_COMPRESSION_FRAME) {
+            return false;
+        }
+        memcpy(&value32,input+pos,4);
+        size_t raw = marshall(value32);
+        memcpy(&value32,input+pos+4,4);
+        Uint32 marker = marshall(value32);
+        size_t packed = marker & ~CU_COMPRESSION_STORED;
+        pos += CU_COMPRESSION_FRAME;
+        if (raw > block || raw > total-out || packed > data.size()-pos) {
+            return false;
+        }
+        
+        if (marker & CU_COMPRESSION_STORED) {
+            if (packed != raw) {
+                return false;
+            }
+            memcpy(output+out,input+pos,raw);
+        } else if (decompressBlock(input+pos,packed,output+out,raw) != (Sint64)raw) {
+            return false;
+        }
+        pos += packed;
+        out += raw;
+    }
+    return pos == data.size();
+}
+
+/**
+ * Returns true if the given data begins with a container header.
+ *
+ * @param data  The data to check
+ * @param size  The number of bytes of data
+ *
+ * @return true if the given data begins with a container header.
+ */
+bool compression::isCompressed(const void* data, size_t size) {
+    return size >= CU_COMPRESSION_HEADER && !memcmp(data,CU_COMPRESSION_MAGIC,4);
+}
@@ -0,0 +1,796 @@
+//
+//  CUDirectorySnapshot.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a snapshot of the contents of a directory.  The
+//  snapshot scans the directory (and all of its subdirectories) once, and
+//  caches the type, size, and modification time of every file.  Queries on
+//  the snapshot never access the file system.  This is much faster than
+//  Pathname when you need to query a lot of files over and over again, such
+//  as when looking for modified assets.
+//
+//  Snapshots can be compared to find the files that were added, removed, or
+//  modified in between.  On Linux (and Android), a snapshot can also watch
+//  its directory, so that refreshing it only rescans the subdirectories that
+//  have actually changed.
+//
+//  Because snapshots are intended to be on the stack, we do not provide any
+//  shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/io/CUDirectorySnapshot.h>
+#include <cugl/util/CUDebug.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+#if defined (__WINDOWS__)
+    #define WINDOWS_TICK 100
+    #define SEC_TO_UNIX_EPOCH 11644473600LL
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <dirent.h>
+#endif
+// SDL undefines __LINUX__ on Android, but Android has inotify as well
+#if defined (__LINUX__) || defined (__ANDROID__)
+    #define SNAPSHOT_INOTIFY
+    #include <sys/inotify.h>
+    #include <errno.h>
+    /** The events that require us to rescan a watched directory */
+    #define WATCH_EVENTS (IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_DELETE_SELF | \
+                          IN_MODIFY | IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR)
+#endif
+
+/** The modification time of a stat result in nanoseconds */
+#if defined (__MACOSX__) || defined (__IPHONEOS__)
+    #define STAT_NANOS(s) ((Uint64)(s).st_mtimespec.tv_sec*1000000000ULL+(Uint64)(s).st_mtimespec.tv_nsec)
+#elif !defined (__WINDOWS__)
+    #define STAT_NANOS(s) ((Uint64)(s).st_mtim.tv_sec*1000000000ULL+(Uint64)(s).st_mtim.tv_nsec)
+#endif
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Entry Helpers
+/**
+ * A comparison function for sorting entries by path
+ *
+ * The paths are stored in a separate string, which must not change while
+ * this function is in use.
+ */
+class PathOrder {
+private:
+    /** The start of the path storage */
+    const char* _base;
+    
+public:
+    /**
+     * Creates a comparison function for the given path storage
+     *
+     * @param names The path storage
+     */
+    PathOrder(const std::string& names) : _base(names.data()) {}
+    
+    /**
+     * Returns true if the first entry precedes the second
+     *
+     * @param a     The first entry
+     * @param b     The second entry
+     *
+     * @return true if the first entry precedes the second
+     */
+    bool operator()(const DirectorySnapshot::Entry& a, const DirectorySnapshot::Entry& b) const {
+        return strcmp(_base+a.path,_base+b.path) < 0;
+    }
+    
+    /**
+     * Returns true if the entry precedes the given path
+     *
+     * @param a     The entry
+     * @param path  The path
+     *
+     * @return true if the entry precedes the given path
+     */
+    bool operator()(const DirectorySnapshot::Entry& a, const char* path) const {
+        return strcmp(_base+a.path,path) < 0;
+    }
+};
+
+/**
+ * Appends a new entry to the given list
+ *
+ * The entry path is the given name in the given directory.  The path is
+ * appended to the path storage.
+ *
+ * @param entries   The list to store the entry
+ * @param names     The path storage
+ * @param dir       The relative path of the parent directory
+ * @param name      The short name of the entry
+ * @param type      The entry type
+ * @param size      The size of the entry in bytes
+ * @param modified  The modification time in nanoseconds
+ */
+static void add_entry(std::vector<DirectorySnapshot::Entry>& entries, std::string& names,
+                      const std::string& dir, const char* name,
+                      DirectorySnapshot::Type type, Uint64 size, Uint64 modified) {
+    DirectorySnapshot::Entry entry;
+    entry.path = (Uint32)names.size();
+    if (!dir.empty()) {
+        names.append(dir);
+        names.push_back('/');
+    }
+    entry.name = (Uint32)(names.size()-entry.path);
+    names.append(name);
+    entry.length = (Uint32)(names.size()-entry.path);
+    names.push_back(0);
+    entry.type = type;
+    entry.size = type == DirectorySnapshot::Type::DIRECTORY ? 0 : size;
+    entry.modified = modified;
+    entries.push_back(entry);
+}
+
+/**
+ * Returns true if the name is one of the special entries . or ..
+ *
+ * @param name  The name to check
+ *
+ * @return true if the name is one of the special entries . or ..
+ */
+static bool is_special(const char* name) {
+    return name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0));
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a snapshot with the resources of the given one.
+ *
+ * The original snapshot is empty and no longer watches the directory.
+ *
+ * @param other The snapshot to take from
+ */
+DirectorySnapshot::DirectorySnapshot(DirectorySnapshot&& other) :
+_root(std::move(other._root)),
+_entries(std::move(other._entries)),
+_names(std::move(other._names)),
+_watcher(other._watcher),
+_watches(std::move(other._watches)) {
+    other._watcher = -1;
+    other._watches.clear();
+}
+
+/**
+ * Sets this snapshot to be a copy of the given one.
+ *
+ * The copy has the same entries, but it does not watch the directory,
+ * even if the original does.  If this snapshot was watching, it stops.
+ *
+ * @param copy  The snapshot to copy
+ *
+ * @return this snapshot, after assignment
+ */
+DirectorySnapshot& DirectorySnapshot::operator=(const DirectorySnapshot& copy) {
+    if (this != &copy) {
+        unwatch();
+        _root = copy._root;
+        _entries = copy._entries;
+        _names = copy._names;
+    }
+    return *this;
+}
+
+/**
+ * Sets this snapshot to have the resources of the given one.
+ *
+ * The original snapshot is empty and no longer watches the directory.
+ *
+ * @param other The snapshot to take from
+ *
+ * @return this snapshot, after assignment
+ */
+DirectorySnapshot& DirectorySnapshot::operator=(DirectorySnapshot&& other) {
+    if (this != &other) {
+        unwatch();
+        _root = std::move(other._root);
+        _entries = std::move(other._entries);
+        _names = std::move(other._names);
+        _watcher = other._watcher;
+        _watches = std::move(other._watches);
+        other._watcher = -1;
+        other._watches.clear();
+    }
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Scanning
+/**
+ * Returns true if the given directory was scanned successfully.
+ *
+ * This method replaces the contents of this snapshot with the given
+ * directory and all of its subdirectories.  If the snapshot is
+ * watching, it watches the new directory instead.
+ *
+ * @param root  The root directory
+ *
+ * @return true if the given directory was scanned successfully.
+ */
+bool DirectorySnapshot::scan(const Pathname& root) {
+    _root = root.getAbsoluteName();
+    while (_root.size() > 1 && (_root.back() == '/' || _root.back() == '\\')) {
+        _root.pop_back();
+    }
+    return scan();
+}
+
+/**
+ * Returns true if the root directory was rescanned successfully.
+ *
+ * This method rescans the entire directory tree, even if the snapshot
+ * is watching the directory.
+ *
+ * @return true if the root directory was rescanned successfully.
+ */
+bool DirectorySnapshot::scan() {
+#if defined (SNAPSHOT_INOTIFY)
+    if (_watcher >= 0) {
+        // Pending events are obsolete, so start over
+        close(_watcher);
+        _watches.clear();
+        _watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    }
+#endif
+    std::vector<Entry> entries;
+    std::string names;
+    bool success = !_root.empty() && scanDirectory("", true, entries, names);
+    assign(entries, names);
+    return success;
+}
+
+/**
+ * Returns true if this snapshot may have changed since the last refresh.
+ *
+ * If this snapshot is watching its directory, this method only rescans
+ * the directories that have changed, and returns false if there were no
+ * changes.  Otherwise, it rescans the entire tree and always returns
+ * true.  Either way, this method never misses a change.
+ *
+ * @return true if this snapshot may have changed since the last refresh.
+ */
+bool DirectorySnapshot::refresh() {
+    if (_watcher >= 0) {
+        return update();
+    }
+    scan();
+    return true;
+}
+
+/**
+ * Returns true if this snapshot is now watching its directory.
+ *
+ * A watching snapshot is notified by the operating system whenever a
+ * file in its directory tree changes.  This makes {@link refresh} much
+ * faster for large directories.  Watching is only supported on Linux and
+ * Android, and this method returns false on other platforms.
+ *
+ * Watching requires a scan of the directory tree, and so this method
+ * updates the snapshot as well.
+ *
+ * @return true if this snapshot is now watching its directory.
+ */
+bool DirectorySnapshot::watch() {
+#if defined (SNAPSHOT_INOTIFY)
+    if (_watcher < 0) {
+        _watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (_watcher < 0) {
+            CULogError("Unable to watch directory '%s': %s", _root.c_str(), strerror(errno));
+            return false;
+        }
+    }
+    if (!scan() || _watcher < 0) {
+        unwatch();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Stops watching the directory of this snapshot.
+ *
+ * This method has no effect if the snapshot is not watching.
+ */
+void DirectorySnapshot::unwatch() {
+#if defined (SNAPSHOT_INOTIFY)
+    if (_watcher >= 0) {
+        close(_watcher);
+    }
+#endif
+    _watcher = -1;
+    _watches.clear();
+}
+
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Returns true if the given directory was successfully scanned
+ *
+ * The entries found are appended to the given list, and their paths are
+ * appended to names.  The entries are not sorted.  If recursive is true,
+ * this method also scans every subdirectory (but not symbolic links to
+ * directories).  If this snapshot is watching, it also watches every
+ * directory scanned.
+ *
+ * @param dir       The relative path of the directory
+ * @param recursive Whether to scan the subdirectories
+ * @param entries   The list to store the entries
+ * @param names     The string to store the paths
+ *
+ * @return true if the given directory was successfully scanned
+ */
+bool DirectorySnapshot::scanDirectory(const std::string& dir, bool recursive,
+                                      std::vector<Entry>& entries, std::string& names) {
+    bool success = true;
+    std::vector<std::string> pending;
+    pending.push_back(dir);
+    while (!pending.empty()) {
+        std::string current = std::move(pending.back());
+        pending.pop_back();
+        
+        // Watch before reading so that we cannot miss a change in between
+        if (_watcher >= 0) {
+            addWatch(current);
+        }
+        
+#if defined (__WINDOWS__)
+        std::string search = _root;
+        if (!current.empty()) {
+            search += '\\';
+            search += current;
+            std::replace(search.begin()+_root.size(), search.end(), '/', '\\');
+        }
+        search += "\\*";
+        
+        WIN32_FIND_DATA data;
+        memset(&data, 0, sizeof(WIN32_FIND_DATA));
+        HANDLE handle = FindFirstFile(search.c_str(), &data);
+        if (handle == INVALID_HANDLE_VALUE) {
+            success = success && current != dir;
+            continue;
+        }
+        
+        // Windows reports the metadata while listing, so no stat is necessary
+        do {
+            if (is_special(data.cFileName)) {
+                continue;
+            }
+            Type type = Type::FILE;
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                type = Type::DIRECTORY;
+            } else if (data.dwFileAttributes & FILE_ATTRIBUTE_DEVICE) {
+                type = Type::OTHER;
+            }
+            Uint64 size = ((Uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+            Uint64 ticks = ((Uint64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+            Uint64 modified = (ticks-SEC_TO_UNIX_EPOCH*10000000ULL)*WINDOWS_TICK;
+            add_entry(entries, names, current, data.cFileName, type, size, modified);
+            if (recursive && type == Type::DIRECTORY && !(data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+                pending.push_back(current.empty() ? data.cFileName : current+"/"+data.cFileName);
+            }
+        } while (FindNextFile(handle, &data) != FALSE);
+        FindClose(handle);
+#else
+        DIR* directory = opendir(current.empty() ? _root.c_str() : (_root+"/"+current).c_str());
+        if (directory == nullptr) {
+            success = success && current != dir;
+            continue;
+        }
+        
+        // Stat relative to the directory to avoid path resolution
+        int handle = dirfd(directory);
+        struct dirent* contents;
+        while ((contents = readdir(directory)) != nullptr) {
+            const char* name = contents->d_name;
+            struct stat status;
+            if (is_special(name) || fstatat(handle, name, &status, 0) != 0) {
+                continue;
+            }
+            Type type = Type::OTHER;
+            if (S_ISREG(status.st_mode)) {
+                type = Type::FILE;
+            } else if (S_ISDIR(status.st_mode)) {
+                type = Type::DIRECTORY;
+            }
+            add_entry(entries, names, current, name, type, (Uint64)status.st_size, STAT_NANOS(status));
+            if (recursive && type == Type::DIRECTORY) {
+                // Do not follow links, as they may cycle
+                bool link;
+#if defined (DT_UNKNOWN)
+                if (contents->d_type != DT_UNKNOWN) {
+                    link = contents->d_type == DT_LNK;
+                } else
+#endif
+                {
+                    struct stat linkstat;
+                    link = fstatat(handle, name, &linkstat, AT_SYMLINK_NOFOLLOW) == 0 && S_ISLNK(linkstat.st_mode);
+                }
+                if (!link) {
+                    pending.push_back(current.empty() ? name : current+"/"+name);
+                }
+            }
+        }
+        closedir(directory);
+#endif
+    }
+    return success;
+}
+
+/**
+ * Sorts the given entries, and makes them the contents of this snapshot
+ *
+ * @param entries   The unsorted entries
+ * @param names     The paths of the entries
+ */
+void DirectorySnapshot::assign(std::vector<Entry>& entries, std::string& names) {
+    std::sort(entries.begin(), entries.end(), PathOrder(names));
+    _entries.swap(entries);
+    _names.swap(names);
+}
+
+/**
+ * Watches the given directory for changes
+ *
+ * If the system runs out of watches, this snapshot stops watching, and
+ * falls back to full rescans.
+ *
+ * @param dir       The relative path of the directory
+ */
+void DirectorySnapshot::addWatch(const std::string& dir) {
+#if defined (SNAPSHOT_INOTIFY)
+    std::string path = dir.empty() ? _root : _root+"/"+dir;
+    int wd = inotify_add_watch(_watcher, path.c_str(), WATCH_EVENTS);
+    if (wd >= 0) {
+        _watches[wd] = dir;
+    } else if (errno == ENOSPC || errno == ENOMEM) {
+        CULogError("Unable to watch directory '%s': %s", path.c_str(), strerror(errno));
+        unwatch();
+    }
+#endif
+}
+
+/**
+ * Stops watching all directories in the given subtree
+ *
+ * @param dir       The relative path of the subtree root
+ */
+void DirectorySnapshot::removeWatches(const std::string& dir) {
+#if defined (SNAPSHOT_INOTIFY)
+    for (auto it = _watches.begin(); it != _watches.end(); ) {
+        const std::string& path = it->second;
+        if (path.compare(0, dir.size(), dir) == 0 &&
+            (path.size() == dir.size() || path[dir.size()] == '/')) {
+            inotify_rm_watch(_watcher, it->first);
+            it = _watches.erase(it);
+        } else {
+            it++;
+        }
+    }
+#endif
+}
+
+/**
+ * Returns true if this snapshot was updated from the watch events
+ *
+ * This method only rescans the directories with pending events.  If the
+ * events were lost, or the root directory itself changed, it rescans the
+ * entire tree.
+ *
+ * @return true if this snapshot was updated from the watch events
+ */
+bool DirectorySnapshot::update() {
+#if defined (SNAPSHOT_INOTIFY)
+    // Collect the directories with pending events
+    std::unordered_set<std::string> dirty;
+    bool rescan = false;
+    alignas(struct inotify_event) char buffer[16384];
+    ssize_t amount;
+    while ((amount = read(_watcher, buffer, sizeof(buffer))) > 0) {
+        for (char* pos = buffer; pos < buffer+amount; ) {
+            const struct inotify_event* event = (const struct inotify_event*)pos;
+            pos += sizeof(struct inotify_event)+event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                rescan = true;
+                continue;
+            }
+            
+            auto it = _watches.find(event->wd);
+            if (it == _watches.end()) {
+                continue;
+            } else if (it->second.empty() && (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))) {
+                rescan = true;
+            } else if (event->mask & IN_IGNORED) {
+                // The directory is gone, and its parent has an event too
+                _watches.erase(it);
+            } else if (!(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))) {
+                dirty.insert(it->second);
+            }
+        }
+    }
+    if (rescan || _watches.empty()) {
+        // The root directory has changed (or was missing)
+        scan();
+        return true;
+    } else if (dirty.empty()) {
+        return false;
+    }
+    
+    // Rescan the dirty directories (but not their subdirectories)
+    std::vector<Entry> scanned;
+    std::string names;
+    for (auto it = dirty.begin(); it != dirty.end(); ++it) {
+        scanDirectory(*it, false, scanned, names);
+    }
+    std::sort(scanned.begin(), scanned.end(), PathOrder(names));
+    
+    // Old children of dirty directories are replaced by the new scan
+    PathOrder before(_names);
+    std::vector<bool> dropped(_entries.size(), false);
+    std::vector<std::string> removed;
+    for (auto it = dirty.begin(); it != dirty.end(); ++it) {
+        size_t first = 0;
+        size_t last  = _entries.size();
+        if (!it->empty()) {
+            std::string bound = *it+"/";
+            first = std::lower_bound(_entries.begin(), _entries.end(), bound.c_str(), before)-_entries.begin();
+            bound.back() = '/'+1;
+            last  = std::lower_bound(_entries.begin(), _entries.end(), bound.c_str(), before)-_entries.begin();
+        }
+        for (size_t ii = first; ii < last; ii++) {
+            const Entry& entry = _entries[ii];
+            if (entry.name != (it->empty() ? 0 : it->size()+1)) {
+                continue;
+            }
+            dropped[ii] = true;
+            if (entry.type == Type::DIRECTORY) {
+                const char* path = _names.data()+entry.path;
+                auto pos = std::lower_bound(scanned.begin(), scanned.end(), path, PathOrder(names));
+                if (pos == scanned.end() || strcmp(names.data()+pos->path, path) || pos->type != Type::DIRECTORY) {
+                    removed.push_back(path);
+                }
+            }
+        }
+    }
+    
+    // Directories that are new (or lost their watch) are scanned in full
+    std::unordered_set<std::string> watched;
+    for (auto it = _watches.begin(); it != _watches.end(); ++it) {
+        watched.insert(it->second);
+    }
+    std::vector<std::string> added;
+    for (auto it = scanned.begin(); it != scanned.end(); ++it) {
+        if (it->type == Type::DIRECTORY) {
+            std::string path = names.data()+it->path;
+            if (!watched.count(path)) {
+                Sint64 index = find(path);
+                if (index >= 0 && _entries[index].type == Type::DIRECTORY) {
+                    removed.push_back(path);
+                }
+                added.push_back(path);
+            }
+        }
+    }
+    
+    // Drop removed subtrees before adding the new ones
+    for (auto it = removed.begin(); it != removed.end(); ++it) {
+        std::string bound = *it+"/";
+        size_t first = std::lower_bound(_entries.begin(), _entries.end(), bound.c_str(), before)-_entries.begin();
+        bound.back() = '/'+1;
+        size_t last  = std::lower_bound(_entries.begin(), _entries.end(), bound.c_str(), before)-_entries.begin();
+        std::fill(dropped.begin()+first, dropped.begin()+last, true);
+        removeWatches(*it);
+    }
+    size_t fresh = scanned.size();
+    for (auto it = added.begin(); it != added.end(); ++it) {
+        scanDirectory(*it, true, scanned, names);
+    }
+    std::sort(scanned.begin()+fresh, scanned.end(), PathOrder(names));
+    std::inplace_merge(scanned.begin(), scanned.begin()+fresh, scanned.end(), PathOrder(names));
+    
+    // Merge the remaining entries with the new ones
+    std::vector<Entry> entries;
+    entries.reserve(_entries.size()+scanned.size());
+    for (size_t ii = 0; ii < _entries.size(); ii++) {
+        if (!dropped[ii]) {
+            Entry entry = _entries[ii];
+            entry.path = (Uint32)names.size();
+            names.append(_names, _entries[ii].path, entry.length+1);
+            entries.push_back(entry);
+        }
+    }
+    size_t kept = entries.size();
+    entries.insert(entries.end(), scanned.begin(), scanned.end());
+    PathOrder after(names);
+    std::inplace_merge(entries.begin(), entries.begin()+kept, entries.end(), after);
+    
+    // Overlapping rescans (e.g. a dirty directory in a new one) may repeat entries
+    auto last = std::unique(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+        return !after(a,b) && !after(b,a);
+    });
+    entries.erase(last, entries.end());
+    _entries.swap(entries);
+    _names.swap(names);
+    return true;
+#else
+    scan();
+    return true;
+#endif
+}
+
+
+#pragma mark -
+#pragma mark Queries
+/**
+ * Returns the index of the entry with the given path.
+ *
+ * The path is relative to the root directory, and must use '/' as the
+ * separator.  This method returns -1 if there is no such entry.
+ *
+ * @param path  The relative path
+ *
+ * @return the index of the entry with the given path.
+ */
+Sint64 DirectorySnapshot::find(const std::string& path) const {
+    auto pos = std::lower_bound(_entries.begin(), _entries.end(), path.c_str(), PathOrder(_names));
+    if (pos == _entries.end() || path.compare(_names.data()+pos->path) != 0) {
+        return -1;
+    }
+    return pos-_entries.begin();
+}
+
+/**
+ * Returns true if the given path was a directory.
+ *
+ * The path is relative to the root directory, and must use '/' as the
+ * separator.  Unlike {@link Pathname#isDirectory}, this method does not
+ * access the file system.
+ *
+ * @param path  The relative path
+ *
+ * @return true if the given path was a directory.
+ */
+bool DirectorySnapshot::isDirectory(const std::string& path) const {
+    Sint64 index = find(path);
+    return index >= 0 && _entries[index].type == Type::DIRECTORY;
+}
+
+/**
+ * Returns true if the given path was a regular file.
+ *
+ * The path is relative to the root directory, and must use '/' as the
+ * separator.  Unlike {@link Pathname#isFile}, this method does not access
+ * the file system.
+ *
+ * @param path  The relative path
+ *
+ * @return true if the given path was a regular file.
+ */
+bool DirectorySnapshot::isFile(const std::string& path) const {
+    Sint64 index = find(path);
+    return index >= 0 && _entries[index].type == Type::FILE;
+}
+
+/**
+ * Returns the length of the given file in bytes.
+ *
+ * The path is relative to the root directory, and must use '/' as the
+ * separator.  The value is 0 if the file does not exist.  Unlike
+ * {@link Pathname#length}, this method does not access the file system.
+ *
+ * @param path  The relative path
+ *
+ * @return the length of the given file in bytes.
+ */
+Uint64 DirectorySnapshot::length(const std::string& path) const {
+    Sint64 index = find(path);
+    return index >= 0 ? _entries[index].size : 0;
+}
+
+/**
+ * Returns the time that the given file was last modified.
+ *
+ * The path is relative to the root directory, and must use '/' as the
+ * separator.  As with {@link Pathname#lastModified}, the value is in
+ * seconds since the epoch, and is 0 if the file does not exist.  However,
+ * this method does not access the file system.
+ *
+ * @param path  The relative path
+ *
+ * @return the time that the given file was last modified.
+ */
+Uint64 DirectorySnapshot::lastModified(const std::string& path) const {
+    Sint64 index = find(path);
+    return index >= 0 ? _entries[index].modified/1000000000ULL : 0;
+}
+
+
+#pragma mark -
+#pragma mark Comparison
+/**
+ * Appends the differences from the previous snapshot to the given list.
+ *
+ * The previous snapshot should be an earlier copy of this one.  An entry
+ * is modified if its type, size, or modification time has changed.  The
+ * exception is directories, whose modification time changes whenever a
+ * child is added or removed.  A directory is only modified if its type
+ * has changed.
+ *
+ * This method is a single pass over the two snapshots, and does not
+ * access the file system.  The changes are sorted by path.
+ *
+ * @param previous  The earlier snapshot
+ * @param changes   The list to store the differences
+ */
+void DirectorySnapshot::diff(const DirectorySnapshot& previous, std::vector<Change>& changes) const {
+    size_t ii = 0;
+    size_t jj = 0;
+    while (ii < previous._entries.size() || jj < _entries.size()) {
+        int order;
+        if (ii == previous._entries.size()) {
+            order = 1;
+        } else if (jj == _entries.size()) {
+            order = -1;
+        } else {
+            order = strcmp(previous._names.data()+previous._entries[ii].path,
+                           _names.data()+_entries[jj].path);
+        }
+        
+        Change change;
+        if (order < 0) {
+            change.before = ii++;
+            change.after  = -1;
+            changes.push_back(change);
+        } else if (order > 0) {
+            change.before = -1;
+            change.after  = jj++;
+            changes.push_back(change);
+        } else {
+            const Entry& old = previous._entries[ii];
+            const Entry& now = _entries[jj];
+            if (old.type != now.type ||
+                (now.type != Type::DIRECTORY && (old.size != now.size || old.modified != now.modified))) {
+                change.before = ii;
+                change.after  = jj;
+                changes.push_back(change);
+            }
+            ii++;
+            jj++;
+        }
+    }
+}
@@ -0,0 +1,245 @@
+//
+//  CUIOSIMD.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the vector primitives for bulk endian conversion in
+//  the binary readers and writers.  Binary files are stored in network (big
+//  endian) order, so arrays must be byte-swapped on most platforms.  These
+//  functions swap an entire array while copying it, using byte shuffles on
+//  SSE and NEON with a scalar fallback for everything else.  On big-endian
+//  platforms they are just a memcpy.
+//
+//  This file is an internal header.  It is not accessible by general users
+//  of the CUGL API.  Because all of the functions are inline, it has no
+//  associated cpp file.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_IO_SIMD_H__
+#define __CU_IO_SIMD_H__
+#include <cugl/base/CUEndian.h>
+#include <cstring>
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    #define CU_IO_SWAP
+    #if defined(__SSSE3__)
+        #define CU_IO_SSSE3
+        #include <tmmintrin.h>
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define CU_IO_SSE
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define CU_IO_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
+namespace cugl {
+namespace simd {
+
+#pragma mark -
+#pragma mark Lane Swaps
+#if defined (CU_IO_SSSE3)
+/** The number of bytes in a lane */
+#define IO_LANE_BYTES 16
+typedef __m128i block_t;
+static inline block_t block_load(const Uint8* p)    { return _mm_loadu_si128((const __m128i*)p); }
+static inline void block_store(Uint8* p, block_t a) { _mm_storeu_si128((__m128i*)p,a); }
+static inline block_t block_swap16(block_t a) {
+    return _mm_shuffle_epi8(a,_mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14));
+}
+static inline block_t block_swap32(block_t a) {
+    return _mm_shuffle_epi8(a,_mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12));
+}
+static inline block_t block_swap64(block_t a) {
+    return _mm_shuffle_epi8(a,_mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8));
+}
+#elif defined (CU_IO_SSE)
+/** The number of bytes in a lane */
+#define IO_LANE_BYTES 16
+typedef __m128i block_t;
+static inline block_t block_load(const Uint8* p)    { return _mm_loadu_si128((const __m128i*)p); }
+static inline void block_store(Uint8* p, block_t a) { _mm_storeu_si128((__m128i*)p,a); }
+static inline block_t block_swap16(block_t a) {
+    return _mm_or_si128(_mm_slli_epi16(a,8),_mm_srli_epi16(a,8));
+}
+static inline block_t block_swap32(block_t a) {
+    // Swap the bytes in each short, then the shorts in each word
+    a = block_swap16(a);
+    a = _mm_shufflelo_epi16(a,_MM_SHUFFLE(2,3,0,1));
+    return _mm_shufflehi_epi16(a,_MM_SHUFFLE(2,3,0,1));
+}
+static inline block_t block_swap64(block_t a) {
+    // Swap the bytes in each short, then reverse the shorts in each long
+    a = block_swap16(a);
+    a = _mm_shufflelo_epi16(a,_MM_SHUFFLE(0,1,2,3));
+    return _mm_shufflehi_epi16(a,_MM_SHUFFLE(0,1,2,3));
+}
+#elif defined (CU_IO_NEON)
+/** The number of bytes in a lane */
+#define IO_LANE_BYTES 16
+typedef uint8x16_t block_t;
+static inline block_t block_load(const Uint8* p)    { return vld1q_u8(p); }
+static inline void block_store(Uint8* p, block_t a) { vst1q_u8(p,a); }
+static inline block_t block_swap16(block_t a) { return vrev16q_u8(a); }
+static inline block_t block_swap32(block_t a) { return vrev32q_u8(a); }
+static inline block_t block_swap64(block_t a) { return vrev64q_u8(a); }
+#endif
+
+
+#pragma mark -
+#pragma mark Array Marshalling
+/**
+ * Copies an array of 16-bit values, converting them to or from network order
+ *
+ * The source and destination may be the same array (for an in-place swap),
+ * but they may not otherwise overlap.  Neither array needs to be aligned.
+ *
+ * @param dst   The destination array
+ * @param src   The source array
+ * @param count The number of 16-bit values to copy
+ */
+static inline void marshall16(void* dst, const void* src, size_t count) {
+#if defined (CU_IO_SWAP)
+    Uint8* out = (Uint8*)dst;
+    const Uint8* in = (const Uint8*)src;
+    size_t pos = 0;
+#if defined (IO_LANE_BYTES)
+    for(; pos+IO_LANE_BYTES/2 <= count; pos += IO_LANE_BYTES/2) {
+        block_store(out+2*pos,block_swap16(block_load(in+2*pos)));
+    }
+#endif
+    for(; pos < count; pos++) {
+        Uint16 value;
+        memcpy(&value,in+2*pos,2);
+        value = SDL_Swap16(value);
+        memcpy(out+2*pos,&value,2);
+    }
+#else
+    if (dst != src) {
+        memcpy(dst,src,2*count);
+    }
+#endif
+}
+
+/**
+ * Copies an array of 32-bit values, converting them to or from network order
+ *
+ * The source and destination may be the same array (for an in-place swap),
+ * but they may not otherwise overlap.  Neither array needs to be aligned.
+ *
+ * @param dst   The destination array
+ * @param src   The source array
+ * @param count The number of 32-bit values to copy
+ */
+static inline void marshall32(void* dst, const void* src, size_t count) {
+#if defined (CU_IO_SWAP)
+    Uint8* out = (Uint8*)dst;
+    const Uint8* in = (const Uint8*)src;
+    size_t pos = 0;
+#if defined (IO_LANE_BYTES)
+    for(; pos+IO_LANE_BYTES/4 <= count; pos += IO_LANE_BYTES/4) {
+        block_store(out+4*pos,block_swap32(block_load(in+4*pos)));
+    }
+#endif
+    for(; pos < count; pos++) {
+        Uint32 value;
+        memcpy(&value,in+4*pos,4);
+        value = SDL_Swap32(value);
+        memcpy(out+4*pos,&value,4);
+    }
+#else
+    if (dst != src) {
+        memcpy(dst,src,4*count);
+    }
+#endif
+}
+
+/**
+ * Copies an array of 64-bit values, converting them to or from network order
+ *
+ * The source and destination may be the same array (for an in-place swap),
+ * but they may not otherwise overlap.  Neither array needs to be aligned.
+ *
+ * @param dst   The destination array
+ * @param src   The source array
+ * @param count The number of 64-bit values to copy
+ */
+static inline void marshall64(void* dst, const void* src, size_t count) {
+#if defined (CU_IO_SWAP)
+    Uint8* out = (Uint8*)dst;
+    const Uint8* in = (const Uint8*)src;
+    size_t pos = 0;
+#if defined (IO_LANE_BYTES)
+    for(; pos+IO_LANE_BYTES/8 <= count; pos += IO_LANE_BYTES/8) {
+        block_store(out+8*pos,block_swap64(block_load(in+8*pos)));
+    }
+#endif
+    for(; pos < count; pos++) {
+        Uint64 value;
+        memcpy(&value,in+8*pos,8);
+        value = SDL_Swap64(value);
+        memcpy(out+8*pos,&value,8);
+    }
+#else
+    if (dst != src) {
+        memcpy(dst,src,8*count);
+    }
+#endif
+}
+
+/**
+ * Copies an array of values, converting them to or from network order
+ *
+ * The element size must be 1, 2, 4, or 8 bytes.  Single bytes are copied
+ * as is.  The source and destination may be the same array (for an in-place
+ * swap), but they may not otherwise overlap.
+ *
+ * @param dst   The destination array
+ * @param src   The source array
+ * @param count The number of values to copy
+ * @param bytes The size of each value in bytes
+ */
+static inline void marshall_copy(void* dst, const void* src, size_t count, unsigned int bytes) {
+    switch (bytes) {
+        case 2:
+            marshall16(dst,src,count);
+            break;
+        case 4:
+            marshall32(dst,src,count);
+            break;
+        case 8:
+            marshall64(dst,src,count);
+            break;
+        default:
+            if (dst != src) {
+                memcpy(dst,src,bytes*count);
+            }
+            break;
+    }
+}
+
+}
+}
+
+#endif /* __CU_IO_SIMD_H__ */
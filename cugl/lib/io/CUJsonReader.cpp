@@ -69,7 +69,7 @@ std::string JsonReader::readJsonString() {
     skip();
     
     // Make sure first character a bracket
-    CUAssertLog(_sbuffer[_bufoff] == '{', "JSON is missing initial {");
+    CUAssertLog(_window[_bufoff] == '{', "JSON is missing initial {");
     
     int depth = 0;
     std::string data;
@@ -77,21 +77,21 @@ std::string JsonReader::readJsonString() {
     while (ready()) {
         fill();
         int pos = 0;
-        for(auto it = _sbuffer.begin()+_bufoff; it != _sbuffer.end(); ++it) {
+        for(const char* it = _window+_bufoff; it != _window+_winsize; ++it) {
             if (*it == '{') {
                 depth++;
             } else if (*it == '}') {
                 depth--;
             }
             if (depth == 0) {
-                data.append(_sbuffer.begin()+_bufoff,it+1);
+                data.append(_window+_bufoff,it+1);
                 _bufoff += pos+1;
                 return data;
             }
             pos++;
         }
-        data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-        _bufoff =  (int)_sbuffer.size();
+        data.append(_window+_bufoff,_window+_winsize);
+        _bufoff = (Sint64)_winsize;
     }
     CUAssertLog(false, "JSON is missing closing }");
     return "";
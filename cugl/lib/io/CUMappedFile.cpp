@@ -0,0 +1,288 @@
+//
+//  CUMappedFile.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides read-only access to an entire file as a single block
+//  of memory.  Where the platform supports it, the file is memory mapped, so
+//  the operating system pages it in on demand and there are no copies at all.
+//  Packaged assets that are not real files (such as those on Android) fall
+//  back to a single read through SDL_RWops.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <cugl/io/CUMappedFile.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/base/CUApplication.h>
+#include <SDL/SDL.h>
+#include <cstring>
+
+#if !defined (__WINDOWS__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a mapped file with no assigned file.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+MappedFile::MappedFile() :
+_name(""),
+_data(nullptr),
+_size(0),
+_mapped(false) {
+#if defined (__WINDOWS__)
+    _handle = NULL;
+#endif
+}
+
+/**
+ * Unmaps the file, releasing all resources.
+ *
+ * Any pointers into the contents are invalid after this call.
+ */
+void MappedFile::dispose() {
+    if (_data) {
+        if (_mapped) {
+#if defined (__WINDOWS__)
+            UnmapViewOfFile(_data);
+#else
+            munmap((void*)_data,_size);
+#endif
+        } else {
+            free((void*)_data);
+        }
+    }
+#if defined (__WINDOWS__)
+    if (_handle) {
+        CloseHandle(_handle);
+        _handle = NULL;
+    }
+#endif
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+}
+
+/**
+ * Initializes a view of the given file.
+ *
+ * If the file is a relative path, this method will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the file is initialized properly, false otherwise.
+ */
+bool MappedFile::init(const Pathname& file) {
+    CUAssertLog(!_data && _name.empty(), "File is already initialized");
+    _name = file.getAbsoluteName();
+    return open();
+}
+
+/**
+ * Initializes a view of the given asset.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file  the relative path to the file
+ *
+ * @return true if the file is initialized properly, false otherwise.
+ */
+bool MappedFile::initWithAsset(const char* file) {
+    CUAssertLog(!_data && _name.empty(), "File is already initialized");
+
+    // Check if the path is absolute
+#if defined (__WINDOWS__)
+    bool absolute = (bool)strstr(file,":") || file[0] == '\\';
+#else
+    bool absolute = file[0] == '/';
+#endif
+    CUAssertLog(!absolute, "This initializer does not accept absolute paths");
+    
+    _name = Application::get()->getAssetDirectory();
+    _name.append(file);
+#if defined (__WINDOWS__)
+    for (int ii = 0; ii < _name.size(); ii++) {
+        if (_name[ii] == '/') {
+            _name[ii] = '\\';
+        }
+    }
+#endif
+    return open();
+}
+
+
+#pragma mark -
+#pragma mark Internal Methods
+/**
+ * Opens the file with the current name, returning true on success
+ *
+ * This method attempts to map the file first, and only reads it through
+ * SDL if the mapping fails (e.g. the file is inside of a packaged
+ * archive).
+ *
+ * @return true if the file was opened
+ */
+bool MappedFile::open() {
+    if (map()) {
+        return true;
+    }
+    return load();
+}
+
+/**
+ * Returns true if the file was successfully mapped into memory.
+ *
+ * @return true if the file was successfully mapped into memory.
+ */
+bool MappedFile::map() {
+#if defined (__WINDOWS__)
+    HANDLE file = CreateFileA(_name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    } else if (size.QuadPart == 0) {
+        // Windows cannot map an empty file
+        CloseHandle(file);
+        _mapped = true;
+        return true;
+    }
+    
+    _handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!_handle) {
+        return false;
+    }
+    _data = (const char*)MapViewOfFile(_handle, FILE_MAP_READ, 0, 0, 0);
+    if (!_data) {
+        CloseHandle(_handle);
+        _handle = NULL;
+        return false;
+    }
+    _size = (size_t)size.QuadPart;
+    _mapped = true;
+    return true;
+#else
+    int fd = ::open(_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    } else if (info.st_size == 0) {
+        // POSIX cannot map an empty file
+        ::close(fd);
+        _mapped = true;
+        return true;
+    }
+    
+    void* addr = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);    // The mapping keeps its own reference
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    // Readers scan front to back, so let the kernel read ahead aggressively
+    madvise(addr, (size_t)info.st_size, MADV_SEQUENTIAL);
+    _data = (const char*)addr;
+    _size = (size_t)info.st_size;
+    _mapped = true;
+    return true;
+#endif
+}
+
+/**
+ * Returns true if the file was successfully read into memory.
+ *
+ * This is the fallback for when the file cannot be mapped.
+ *
+ * @return true if the file was successfully read into memory.
+ */
+bool MappedFile::load() {
+    SDL_RWops* stream = SDL_RWFromFile(_name.c_str(), "rb");
+    if (!stream) {
+        return false;
+    }
+    
+    Sint64 size = SDL_RWsize(stream);
+    if (size < 0) {
+        SDL_RWclose(stream);
+        return false;
+    } else if (size == 0) {
+        SDL_RWclose(stream);
+        return true;
+    }
+    
+    char* buffer = (char*)malloc((size_t)size);
+    size_t total = 0;
+    while (total < (size_t)size) {
+        size_t amt = SDL_RWread(stream, buffer+total, 1, (size_t)size-total);
+        if (amt == 0) {
+            break;
+        }
+        total += amt;
+    }
+    SDL_RWclose(stream);
+    if (total != (size_t)size) {
+        free(buffer);
+        return false;
+    }
+    
+    _data = buffer;
+    _size = total;
+    _mapped = false;
+    return true;
+}
@@ -67,6 +67,35 @@ using namespace cugl;
     #define PATH_SEP '/'
 #endif
 
+#if !defined (__WINDOWS__)
+/**
+ * Returns true if the directory entry refers to an existing file
+ *
+ * Most file systems report the type of each entry, which makes a call to
+ * stat unnecessary.  We only need stat for symbolic links (which may be
+ * broken) or entries of unknown type.  The special entries . and .. are
+ * never considered to exist.
+ *
+ * @param prefix    The directory path, ending in a separator
+ * @param entry     The directory entry
+ *
+ * @return true if the directory entry refers to an existing file
+ */
+static bool entry_exists(const std::string& prefix, const struct dirent* entry) {
+    const char* name = entry->d_name;
+    if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+        return false;
+    }
+#if defined (DT_UNKNOWN)
+    if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK) {
+        return true;
+    }
+#endif
+    struct stat status;
+    return stat((prefix+name).c_str(), &status) == 0;
+}
+#endif
+
 #pragma mark -
 #pragma mark Normalization
 /**
@@ -233,7 +262,7 @@ _shortname(copy._shortname)
  */
 Pathname::Pathname(Pathname&& copy) noexcept :
 _pathname(std::move(copy._pathname)),
-_fullpath(std::move(copy._pathname)),
+_fullpath(std::move(copy._fullpath)),
 _shortname(std::move(copy._shortname))
 {
 }
@@ -536,23 +565,19 @@ std::vector<std::string> Pathname::list() const {
 	FindClose(handle);
 	return result;
 #else
-	std::vector<std::string> result;
-	std::string sep = "";
-	if (_fullpath[_fullpath.size() - 1] != '/') {
-		sep = "/";
-	}
+    std::vector<std::string> result;
+    std::string prefix = _fullpath;
+    if (prefix[prefix.size() - 1] != '/') {
+        prefix += '/';
+    }
+    
     // This is POSIX.
     DIR *directory = opendir(_fullpath.c_str());
-    
-    struct dirent *contents;
-    struct stat status;
     if (directory != nullptr) {
-        contents = readdir(directory);
+        struct dirent *contents = readdir(directory);
         while (contents != nullptr) {
-            std::string item = contents->d_name;
-            int err = stat((_fullpath+sep+item).c_str(), &status);
-            if (err == 0 && item != "." && item != "..") {
-                result.push_back(item);
+            if (entry_exists(prefix,contents)) {
+                result.push_back(contents->d_name);
             }
             contents = readdir(directory);
         }
@@ -600,26 +625,21 @@ std::vector<std::string> Pathname::list(const std::function<bool(const std::stri
 	FindClose(handle);
 	return result;
 #else
-	std::vector<std::string> result;
-	std::string sep = "";
-	if (_fullpath[_fullpath.size() - 1] != '/') {
-		sep = "/";
-	}
+    std::vector<std::string> result;
+    std::string prefix = _fullpath;
+    if (prefix[prefix.size() - 1] != '/') {
+        prefix += '/';
+    }
 
-    // This is POSIX.  We HOPE this works on Windows.
+    // This is POSIX.
     DIR *directory = opendir(_fullpath.c_str());
-    
-    struct dirent *contents;
-    struct stat status;
     if (directory != nullptr) {
-        contents = readdir(directory);
+        std::string item;
+        struct dirent *contents = readdir(directory);
         while (contents != nullptr) {
-            std::string item = contents->d_name;
-            if (filter(item)) {
-                int err = stat((_fullpath+sep+item).c_str(), &status);
-                if (err == 0 && item != "." && item != "..") {
-                    result.push_back(item);
-                }
+            item.assign(contents->d_name);
+            if (entry_exists(prefix,contents) && filter(item)) {
+                result.push_back(item);
             }
             contents = readdir(directory);
         }
@@ -641,6 +661,7 @@ std::vector<std::string> Pathname::list(const std::function<bool(const std::stri
 std::vector<Pathname> Pathname::listPaths() const {
 #if defined (__WINDOWS__)
 	std::vector<Pathname> result;
+	Pathname parent = getAbsolutePath();
 
 	std::string search_path(_fullpath);
 	WIN32_FIND_DATA search_data;
@@ -655,7 +676,7 @@ std::vector<Pathname> Pathname::listPaths() const {
 	while (avail && handle != INVALID_HANDLE_VALUE) {
 		std::string file(search_data.cFileName);
 		if (file != "." && file != "..") {
-			result.push_back(Pathname(search_path + file));
+			result.push_back(Pathname(parent, file));
 		}
 		avail = (FindNextFile(handle, &search_data) != FALSE);
 	}
@@ -664,31 +685,27 @@ std::vector<Pathname> Pathname::listPaths() const {
 	FindClose(handle);
 	return result;
 #else
-	std::vector<Pathname> result;
-	std::string sep = "";
-	if (_fullpath[_fullpath.size() - 1] != '/') {
-		sep = "/";
-	}
-
-	// This is POSIX.  We HOPE this works on Windows.
-	DIR *directory = opendir(_fullpath.c_str());
+    std::vector<Pathname> result;
+    std::string prefix = _fullpath;
+    if (prefix[prefix.size() - 1] != '/') {
+        prefix += '/';
+    }
 
-	struct dirent *contents;
-	struct stat status;
-	if (directory != nullptr) {
-		contents = readdir(directory);
-		while (contents != nullptr) {
-			std::string item = contents->d_name;
-			int err = stat((_fullpath + sep + item).c_str(), &status);
-			if (err == 0 && item != "." && item != "..") {
-				result.push_back(Pathname(_fullpath + sep + item));
-			}
-			contents = readdir(directory);
-		}
-		closedir(directory);
-	}
+    // This is POSIX.  The children share the normalized parent.
+    Pathname parent = getAbsolutePath();
+    DIR *directory = opendir(_fullpath.c_str());
+    if (directory != nullptr) {
+        struct dirent *contents = readdir(directory);
+        while (contents != nullptr) {
+            if (entry_exists(prefix,contents)) {
+                result.push_back(Pathname(parent,contents->d_name));
+            }
+            contents = readdir(directory);
+        }
+        closedir(directory);
+    }
 
-	return result;
+    return result;
 #endif
 }
 
@@ -703,6 +720,7 @@ std::vector<Pathname> Pathname::listPaths() const {
 std::vector<Pathname> Pathname::listPaths(const std::function<bool(const Pathname& path)>& filter) const {
 #if defined (__WINDOWS__)
 	std::vector<Pathname> result;
+	Pathname parent = getAbsolutePath();
 
 	std::string search_path(_fullpath);
 	WIN32_FIND_DATA search_data;
@@ -717,7 +735,7 @@ std::vector<Pathname> Pathname::listPaths(const std::function<bool(const Pathnam
 	while (avail && handle != INVALID_HANDLE_VALUE) {
 		std::string file(search_data.cFileName);
 		if (file != "." && file != "..") {
-			Pathname path(search_path + file);
+			Pathname path(parent, file);
 			if (filter(path)) {
 				result.push_back(path);
 			}
@@ -729,24 +747,20 @@ std::vector<Pathname> Pathname::listPaths(const std::function<bool(const Pathnam
 	FindClose(handle);
 	return result;
 #else
-	std::vector<Pathname> result;
-	std::string sep = "";
-	if (_fullpath[_fullpath.size() - 1] != '/') {
-		sep = "/";
-	}
+    std::vector<Pathname> result;
+    std::string prefix = _fullpath;
+    if (prefix[prefix.size() - 1] != '/') {
+        prefix += '/';
+    }
 
-    // This is POSIX.  We HOPE this works on Windows.
+    // This is POSIX.  The children share the normalized parent.
+    Pathname parent = getAbsolutePath();
     DIR *directory = opendir(_fullpath.c_str());
-    
-    struct dirent *contents;
-    struct stat status;
     if (directory != nullptr) {
-        contents = readdir(directory);
+        struct dirent *contents = readdir(directory);
         while (contents != nullptr) {
-            std::string item = contents->d_name;
-            int err = stat((_fullpath+sep+item).c_str(), &status);
-            if (err == 0 && item != "." && item != "..") {
-                Pathname found(_fullpath+sep+item);
+            if (entry_exists(prefix,contents)) {
+                Pathname found(parent,contents->d_name);
                 if (filter(found)) {
                     result.push_back(found);
                 }
@@ -1201,23 +1215,17 @@ bool Pathname::setWritable(bool writable, bool ownerOnly) {
 /**
  * Returns the length of the file denoted by this pathname.
  *
- * The value is measured in bytes.
+ * The value is measured in bytes.  It is 0 if the file does not exist.
  *
  * @return the length of the file denoted by this pathname.
  */
 size_t Pathname::length() const {
-    size_t result = 0;
-    Uint8 buf[256];
-    SDL_RWops* rw = SDL_RWFromFile(_fullpath.c_str(), "rb");
-    
-    // This is really the only reliable way to do this
-    size_t amt = SDL_RWread(rw, buf, 1, sizeof (buf));
-    while (amt > 0) {
-        result += amt;
-        amt = SDL_RWread(rw, buf, 1, sizeof (buf));
+    struct stat status;
+    int err = stat(_fullpath.c_str(), &status);
+    if (err == 0) {
+        return (size_t)status.st_size;
     }
-    SDL_RWclose(rw);
-    return result;
+    return 0;
 }
 
 /**
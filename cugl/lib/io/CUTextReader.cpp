@@ -51,6 +51,7 @@
 #include <cugl/base/CUApplication.h>
 #include <utf8/utf8.h>
 #include <cctype>
+#include <cstring>
 
 using namespace cugl;
 
@@ -175,6 +176,48 @@ bool TextReader::initWithAsset(const char* file, unsigned int capacity) {
     return _ssize >= 0;
 }
 
+/**
+ * Initializes a memory mapped reader for the given file.
+ *
+ * A mapped reader has no buffer.  Instead, the entire file is readable
+ * at once, and reading a line (or the whole file) only copies the data
+ * into the result.  This is the fastest way to read a large file.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool TextReader::initMapped(const Pathname& file) {
+    _mapping = MappedFile::alloc(file);
+    return attach();
+}
+
+/**
+ * Initializes a memory mapped reader for the given file.
+ *
+ * A mapped reader has no buffer.  Instead, the entire file is readable
+ * at once, and reading a line (or the whole file) only copies the data
+ * into the result.  If the asset cannot be mapped (e.g. it is inside of
+ * a packaged archive), the file is read into memory all at once.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file  the relative path to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool TextReader::initMappedWithAsset(const char* file) {
+    _mapping = MappedFile::allocWithAsset(file);
+    return attach();
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -185,6 +228,14 @@ bool TextReader::initWithAsset(const char* file, unsigned int capacity) {
  * if the stream has been closed.
  */
 void TextReader::reset() {
+    if (_mapped) {
+        if (!_mapping) {
+            _mapping = MappedFile::alloc(Pathname(_name));
+            attach();
+        }
+        _bufoff = 0;
+        return;
+    }
     if (_stream) {
         close();
     }
@@ -192,6 +243,8 @@ void TextReader::reset() {
     _ssize  = SDL_RWsize(_stream);
     _cbuffer = new char[_capacity];
     _sbuffer.clear();
+    _window  = _sbuffer.data();
+    _winsize = 0;
     _bufoff  = -1;
     _scursor = 0;
 }
@@ -212,13 +265,21 @@ void TextReader::close() {
         delete[] _cbuffer;
         _cbuffer = nullptr;
     }
+    if (_mapping) {
+        _mapping = nullptr;
+        _scursor = 0;
+    }
+    _window  = nullptr;
+    _winsize = 0;
+    _ssize   = 0;
 }
 
 /**
  * Fills the storage buffer to capacity
  *
  * This cuts down on the number of reads to the file by allowing us
- * to read from the file in predefined chunks.
+ * to read from the file in predefined chunks.  It has no effect on a
+ * memory mapped reader, as the entire file is already readable.
  */
 void TextReader::fill() {
     if (!_bufoff || !_stream || _scursor == _ssize) {
@@ -231,6 +292,29 @@ void TextReader::fill() {
     size_t amt = SDL_RWread(_stream, _cbuffer, 1, _capacity-_sbuffer.size());
     _sbuffer.append(_cbuffer,amt);
     _scursor += amt;
+    _window  = _sbuffer.data();
+    _winsize = _sbuffer.size();
+}
+
+/**
+ * Returns true if the reader successfully attached to its mapped file
+ *
+ * This method makes the entire mapped file the readable data.
+ *
+ * @return true if the reader successfully attached to its mapped file
+ */
+bool TextReader::attach() {
+    if (!_mapping) {
+        return false;
+    }
+    _name    = _mapping->getName();
+    _mapped  = true;
+    _window  = _mapping->data();
+    _winsize = _mapping->size();
+    _ssize   = (Sint64)_winsize;
+    _scursor = _ssize;
+    _bufoff  = 0;
+    return true;
 }
 
 #pragma mark -
@@ -265,11 +349,11 @@ char TextReader::read() {
  */
 std::string& TextReader::read(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((size_t)_bufoff >= _winsize) {
         fill();
     }
 
-    data.push_back(_sbuffer[_bufoff++]);
+    data.push_back(_window[_bufoff++]);
     return data;
 }
 
@@ -302,17 +386,16 @@ std::string TextReader::readUTF8() {
  */
 std::string& TextReader::readUTF8(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+3 >= _sbuffer.size()) { // Need a full UTF8 sequence
+    if ((size_t)_bufoff+3 >= _winsize) { // Need a full UTF8 sequence
         fill();
     }
     
-    size_t orig = data.size();
-    
-    std::string::iterator start = _sbuffer.begin()+_bufoff;
-    utf8::next(start,_sbuffer.end());
+    const char* begin = _window+_bufoff;
+    const char* start = begin;
+    utf8::next(start,_window+_winsize);
     
-    data.append(_sbuffer.begin()+_bufoff,start);
-    _bufoff += (Sint32)(data.size()-orig);
+    data.append(begin,start);
+    _bufoff += (Sint64)(start-begin);
     
     return data;
 }
@@ -351,26 +434,62 @@ std::string TextReader::readLine() {
  */
 std::string& TextReader::readLine(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((size_t)_bufoff >= _winsize) {
         fill();
     }
     
     bool found = false;
     while (!found) {
-        size_t pos = _sbuffer.find('\n',_bufoff);
-        if (pos != std::string::npos) {
-            data.append(_sbuffer.begin()+_bufoff,_sbuffer.begin()+pos);
-            _bufoff = (Sint32)(pos+1);
+        const char* begin = _window+_bufoff;
+        const char* pos = (const char*)memchr(begin,'\n',_winsize-_bufoff);
+        if (pos) {
+            data.append(begin,pos);
+            _bufoff = (Sint64)(pos-_window)+1;
             found = true;
         } else {
-            data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-            _bufoff = (Sint32)_sbuffer.size();
-            fill();
+            data.append(begin,_window+_winsize);
+            _bufoff = (Sint64)_winsize;
+            if (_scursor < _ssize) {
+                fill();
+            } else {
+                found = true;
+            }
         }
     }
     return data;
 }
 
+/**
+ * Returns a pointer to the next line of text, without copying it.
+ *
+ * This method is only supported by memory mapped readers.  The line is
+ * not null-terminated; its length (without the newline) is stored in
+ * the argument.  The pointer is valid until the reader is closed.
+ *
+ * If the stream is finished, this method returns nullptr.
+ *
+ * @param length    the length of the line (output)
+ *
+ * @return a pointer to the next line of text, without copying it.
+ */
+const char* TextReader::readLineSpan(size_t& length) {
+    CUAssertLog(_mapped, "Spans are only supported by mapped readers");
+    if (!ready()) {
+        length = 0;
+        return nullptr;
+    }
+    const char* begin = _window+_bufoff;
+    const char* pos = (const char*)memchr(begin,'\n',_winsize-_bufoff);
+    if (pos) {
+        length  = (size_t)(pos-begin);
+        _bufoff = (Sint64)(pos-_window)+1;
+    } else {
+        length  = _winsize-_bufoff;
+        _bufoff = (Sint64)_winsize;
+    }
+    return begin;
+}
+
 /**
  * Returns the unread remainder of the stream
  *
@@ -399,14 +518,19 @@ std::string TextReader::readAll() {
  */
 std::string& TextReader::readAll(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((size_t)_bufoff >= _winsize) {
         fill();
     }
     
-    while (ready()) {
-        data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-        _bufoff = (Sint32)_sbuffer.size();
-        fill();
+    data.append(_window+_bufoff,_window+_winsize);
+    _bufoff = (Sint64)_winsize;
+    if (_scursor < _ssize) {
+        // Read the remainder directly, instead of one buffer at a time
+        size_t orig = data.size();
+        data.resize(orig+(size_t)(_ssize-_scursor));
+        size_t amt = SDL_RWread(_stream, &data[orig], 1, (size_t)(_ssize-_scursor));
+        data.resize(orig+amt);
+        _scursor += amt;
     }
     return data;
 }
@@ -419,14 +543,14 @@ std::string& TextReader::readAll(std::string& data) {
  */
 void TextReader::skip() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((size_t)_bufoff >= _winsize) {
         fill();
     }
     
     bool found = false;
-    while (isspace(_sbuffer[_bufoff]) && !found) {
+    while (isspace(_window[_bufoff]) && !found) {
         _bufoff++;
-        if (_bufoff >= _sbuffer.size()) {
+        if ((size_t)_bufoff >= _winsize) {
             if (ready()) {
                 fill();
             } else {
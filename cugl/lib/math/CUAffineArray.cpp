@@ -0,0 +1,368 @@
+//
+//  CUAffineArray.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an array of 2d affine transforms in structure-of-arrays
+//  form.  Each of the six coefficients is stored in a separate aligned array,
+//  so that a large number of transforms (such as the local transforms of a
+//  particle system) can be composed several at a time.
+//
+//  An array may either own its storage or be a view of arrays owned by
+//  someone else.  The latter allows an application that already keeps its
+//  data in structure-of-arrays form to use these operations with no copies.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#include <cugl/math/CUAffineArray.h>
+#include <cstring>
+#include <algorithm>
+#include "CUMathSIMD.h"
+
+using namespace cugl;
+
+/** The identity value of each coefficient */
+static const float IDENTITY[CU_AFFINE_COMPONENTS] = { 1, 0, 0, 0, 1, 0 };
+
+#pragma mark Constructors
+/**
+ * Creates an empty transform array
+ */
+AffineArray::AffineArray() : _raw(nullptr), _size(0), _capacity(0) {
+    std::memset(_coeff,0,sizeof(_coeff));
+}
+
+/**
+ * Creates a transform array of the given size.
+ *
+ * All of the transforms are initialized to the identity.
+ *
+ * @param size  The number of transforms
+ */
+AffineArray::AffineArray(size_t size) : AffineArray() {
+    resize(size);
+}
+
+/**
+ * Creates a transform array with a copy of the given transforms.
+ *
+ * @param transforms    The transforms to copy
+ * @param size          The number of transforms
+ */
+AffineArray::AffineArray(const Affine2* transforms, size_t size) : AffineArray() {
+    load(transforms,size);
+}
+
+/**
+ * Creates a view of the given coefficient arrays.
+ *
+ * There must be six coefficient arrays, in the order specified in the
+ * class description.  The view does not copy the arrays, and it does
+ * not take ownership of them.  They must outlive this view.  The arrays
+ * do not need to be aligned.  A view cannot be resized.
+ *
+ * @param components    The coefficient arrays
+ * @param size          The number of transforms
+ */
+AffineArray::AffineArray(float* const* components, size_t size) :
+_raw(nullptr), _size(size), _capacity(size) {
+    CUAssertLog(components, "Coefficient arrays are null");
+    for(int ii = 0; ii < CU_AFFINE_COMPONENTS; ii++) {
+        _coeff[ii] = components[ii];
+    }
+}
+
+/**
+ * Creates a copy of the given transform array.
+ *
+ * The copy always owns its storage, even if the original is a view.
+ *
+ * @param array The array to copy
+ */
+AffineArray::AffineArray(const AffineArray& array) : AffineArray() {
+    reserve(array._size);
+    _size = array._size;
+    for(int ii = 0; ii < CU_AFFINE_COMPONENTS; ii++) {
+        std::memcpy(_coeff[ii],array._coeff[ii],_size*sizeof(float));
+    }
+}
+
+/**
+ * Creates a transform array with the resources of the original.
+ *
+ * @param array The array to take from
+ */
+AffineArray::AffineArray(AffineArray&& array) :
+_raw(array._raw), _size(array._size), _capacity(array._capacity) {
+    std::memcpy(_coeff,array._coeff,sizeof(_coeff));
+    std::memset(array._coeff,0,sizeof(array._coeff));
+    array._raw = nullptr;
+    array._size = 0;
+    array._capacity = 0;
+}
+
+/**
+ * Deletes this transform array, releasing all resources.
+ */
+AffineArray::~AffineArray() {
+    if (_raw) {
+        free(_raw);
+    }
+}
+
+/**
+ * Sets this array to be a copy of the given one.
+ *
+ * If this array is a view, the array must have the same size, and the
+ * coefficients are copied into the viewed arrays.
+ *
+ * @param array The array to copy
+ *
+ * @return a reference to this array for chaining.
+ */
+AffineArray& AffineArray::operator=(const AffineArray& array) {
+    if (this == &array) {
+        return *this;
+    }
+    if (!isView()) {
+        resize(array._size);
+    }
+    CUAssertLog(_size == array._size, "View size %zu does not match %zu", _size, array._size);
+    for(int ii = 0; ii < CU_AFFINE_COMPONENTS; ii++) {
+        std::memmove(_coeff[ii],array._coeff[ii],_size*sizeof(float));
+    }
+    return *this;
+}
+
+/**
+ * Sets this array to have the resources of the given one.
+ *
+ * @param array The array to take from
+ *
+ * @return a reference to this array for chaining.
+ */
+AffineArray& AffineArray::operator=(AffineArray&& array) {
+    if (this == &array) {
+        return *this;
+    }
+    if (_raw) {
+        free(_raw);
+    }
+    _raw = array._raw;
+    _size = array._size;
+    _capacity = array._capacity;
+    std::memcpy(_coeff,array._coeff,sizeof(_coeff));
+    std::memset(array._coeff,0,sizeof(array._coeff));
+    array._raw = nullptr;
+    array._size = 0;
+    array._capacity = 0;
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Storage
+/**
+ * Ensures that this array can store the given number of transforms.
+ *
+ * This method may not be called on a view.
+ *
+ * @param capacity  The number of transforms to reserve
+ */
+void AffineArray::reserve(size_t capacity) {
+    CUAssertLog(!isView(), "Cannot reallocate a view");
+    if (capacity <= _capacity) {
+        return;
+    }
+    size_t stride = simd::soa_capacity(capacity);
+    void* raw = nullptr;
+    float* data = simd::soa_allocate(CU_AFFINE_COMPONENTS*stride,raw);
+    for(int ii = 0; ii < CU_AFFINE_COMPONENTS; ii++) {
+        if (_size) {
+            std::memcpy(data+ii*stride,_coeff[ii],_size*sizeof(float));
+        }
+        _coeff[ii] = data+ii*stride;
+    }
+    if (_raw) {
+        free(_raw);
+    }
+    _raw = raw;
+    _capacity = stride;
+}
+
+/**
+ * Changes the number of transforms in this array.
+ *
+ * Any new transforms are initialized to the identity.  This method may
+ * not be called on a view.
+ *
+ * @param size  The new number of transforms
+ */
+void AffineArray::resize(size_t size) {
+    CUAssertLog(!isView(), "Cannot resize a view");
+    if (size > _capacity) {
+        reserve(size);
+    }
+    for(int ii = 0; ii < CU_AFFINE_COMPONENTS; ii++) {
+        std::fill(_coeff[ii]+_size,_coeff[ii]+std::max(size,_size),IDENTITY[ii]);
+    }
+    _size = size;
+}
+
+/**
+ * Appends a transform to the end of this array.
+ *
+ * This method may not be called on a view.
+ *
+ * @param transform The transform to append
+ */
+void AffineArray::append(const Affine2& transform) {
+    if (_size == _capacity) {
+        reserve(_capacity ? 2*_capacity : 4);
+    }
+    _size++;
+    set(_size-1,transform);
+}
+
+
+#pragma mark -
+#pragma mark Access
+/**
+ * Returns the transform at the given position.
+ *
+ * @param index The transform position
+ *
+ * @return the transform at the given position.
+ */
+Affine2 AffineArray::get(size_t index) const {
+    CUAssertLog(index < _size, "Index %zu is out of bounds", index);
+    Affine2 result;
+    result.m[0] = _coeff[0][index];
+    result.m[1] = _coeff[1][index];
+    result.m[2] = _coeff[3][index];
+    result.m[3] = _coeff[4][index];
+    result.offset.set(_coeff[2][index],_coeff[5][index]);
+    return result;
+}
+
+/**
+ * Sets the transform at the given position.
+ *
+ * @param index     The transform position
+ * @param transform The new transform value
+ */
+void AffineArray::set(size_t index, const Affine2& transform) {
+    CUAssertLog(index < _size, "Index %zu is out of bounds", index);
+    _coeff[0][index] = transform.m[0];
+    _coeff[1][index] = transform.m[1];
+    _coeff[2][index] = transform.offset.x;
+    _coeff[3][index] = transform.m[2];
+    _coeff[4][index] = transform.m[3];
+    _coeff[5][index] = transform.offset.y;
+}
+
+
+#pragma mark -
+#pragma mark Conversion
+/**
+ * Sets this array to a copy of the given transforms.
+ *
+ * If this array is a view, the number of transforms must be the same as
+ * the size of the view.  Otherwise, the array is resized.
+ *
+ * @param transforms    The transforms to copy
+ * @param size          The number of transforms
+ *
+ * @return a reference to this array for chaining.
+ */
+AffineArray& AffineArray::load(const Affine2* transforms, size_t size) {
+    CUAssertLog(size == 0 || transforms, "Transform array is null");
+    if (!isView()) {
+        resize(size);
+    }
+    CUAssertLog(_size == size, "View size %zu does not match %zu", _size, size);
+    for(size_t ii = 0; ii < size; ii++) {
+        set(ii,transforms[ii]);
+    }
+    return *this;
+}
+
+/**
+ * Stores the transforms of this array in the given buffer.
+ *
+ * The buffer must have room for {@link #size} transforms.
+ *
+ * @param transforms    The buffer to store the transforms
+ */
+void AffineArray::store(Affine2* transforms) const {
+    CUAssertLog(_size == 0 || transforms, "Transform array is null");
+    for(size_t ii = 0; ii < _size; ii++) {
+        Affine2* dst = transforms+ii;
+        dst->m[0] = _coeff[0][ii];
+        dst->m[1] = _coeff[1][ii];
+        dst->m[2] = _coeff[3][ii];
+        dst->m[3] = _coeff[4][ii];
+        dst->offset.set(_coeff[2][ii],_coeff[5][ii]);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Composition
+/**
+ * Multiplies every transform in this array on the right by the given one.
+ *
+ * The result is the same as calling {@link Affine2#multiply} on each
+ * transform.  The given transform is applied after the transforms in
+ * this array.
+ *
+ * @param transform The transform to multiply by
+ *
+ * @return a reference to this array for chaining.
+ */
+AffineArray& AffineArray::multiply(const Affine2& transform) {
+    const float coeff[CU_AFFINE_COMPONENTS] = {
+        transform.m[0], transform.m[1], transform.offset.x,
+        transform.m[2], transform.m[3], transform.offset.y
+    };
+    const float* right[CU_AFFINE_COMPONENTS];
+    for(int ii = 0; ii < CU_AFFINE_COMPONENTS; ii++) {
+        right[ii] = coeff+ii;
+    }
+    simd::affine2_compose(_coeff,right,0,_size);
+    return *this;
+}
+
+/**
+ * Multiplies each transform in this array on the right by its partner.
+ *
+ * The result is the same as calling {@link Affine2#multiply} on each
+ * pair of transforms.  The given transforms are applied after the
+ * transforms in this array.
+ *
+ * @param array The transforms to multiply by
+ *
+ * @return a reference to this array for chaining.
+ */
+AffineArray& AffineArray::multiply(const AffineArray& array) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    simd::affine2_compose(_coeff,array._coeff,1,_size);
+    return *this;
+}
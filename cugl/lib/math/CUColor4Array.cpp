@@ -0,0 +1,488 @@
+//
+//  CUColor4Array.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an array of colors in structure-of-arrays form.  The
+//  four color channels are stored in separate aligned arrays, so that large
+//  batches of colors (such as the tints of a particle system) can be faded
+//  and blended several colors at a time.
+//
+//  An array may either own its storage or be a view of arrays owned by
+//  someone else.  The latter allows an application that already keeps its
+//  data in structure-of-arrays form to use these operations with no copies.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#include <cugl/math/CUColor4Array.h>
+#include <cstring>
+#include "CUMathSIMD.h"
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Creates an empty color array
+ */
+Color4Array::Color4Array() : _raw(nullptr), _size(0), _capacity(0) {
+    std::memset(_channel,0,sizeof(_channel));
+}
+
+/**
+ * Creates a color array of the given size.
+ *
+ * All of the colors are initialized to transparent black.
+ *
+ * @param size  The number of colors
+ */
+Color4Array::Color4Array(size_t size) : Color4Array() {
+    resize(size);
+}
+
+/**
+ * Creates a color array with a copy of the given colors.
+ *
+ * @param colors    The colors to copy
+ * @param size      The number of colors
+ */
+Color4Array::Color4Array(const Color4f* colors, size_t size) : Color4Array() {
+    load(colors,size);
+}
+
+/**
+ * Creates a view of the given channel arrays.
+ *
+ * The view does not copy the arrays, and it does not take ownership of
+ * them.  They must outlive this view.  The arrays do not need to be
+ * aligned.  A view cannot be resized.
+ *
+ * @param r     The red channel
+ * @param g     The green channel
+ * @param b     The blue channel
+ * @param a     The alpha channel
+ * @param size  The number of colors
+ */
+Color4Array::Color4Array(float* r, float* g, float* b, float* a, size_t size) :
+_raw(nullptr), _size(size), _capacity(size) {
+    _channel[0] = r;
+    _channel[1] = g;
+    _channel[2] = b;
+    _channel[3] = a;
+}
+
+/**
+ * Creates a copy of the given color array.
+ *
+ * The copy always owns its storage, even if the original is a view.
+ *
+ * @param array The array to copy
+ */
+Color4Array::Color4Array(const Color4Array& array) : Color4Array() {
+    reserve(array._size);
+    _size = array._size;
+    for(int ii = 0; ii < 4; ii++) {
+        std::memcpy(_channel[ii],array._channel[ii],_size*sizeof(float));
+    }
+}
+
+/**
+ * Creates a color array with the resources of the original.
+ *
+ * @param array The array to take from
+ */
+Color4Array::Color4Array(Color4Array&& array) :
+_raw(array._raw), _size(array._size), _capacity(array._capacity) {
+    std::memcpy(_channel,array._channel,sizeof(_channel));
+    std::memset(array._channel,0,sizeof(array._channel));
+    array._raw = nullptr;
+    array._size = 0;
+    array._capacity = 0;
+}
+
+/**
+ * Deletes this color array, releasing all resources.
+ */
+Color4Array::~Color4Array() {
+    if (_raw) {
+        free(_raw);
+    }
+}
+
+/**
+ * Sets this array to be a copy of the given one.
+ *
+ * If this array is a view, the array must have the same size, and the
+ * colors are copied into the viewed arrays.
+ *
+ * @param array The array to copy
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::operator=(const Color4Array& array) {
+    if (this == &array) {
+        return *this;
+    }
+    if (!isView()) {
+        resize(array._size);
+    }
+    CUAssertLog(_size == array._size, "View size %zu does not match %zu", _size, array._size);
+    for(int ii = 0; ii < 4; ii++) {
+        std::memmove(_channel[ii],array._channel[ii],_size*sizeof(float));
+    }
+    return *this;
+}
+
+/**
+ * Sets this array to have the resources of the given one.
+ *
+ * @param array The array to take from
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::operator=(Color4Array&& array) {
+    if (this == &array) {
+        return *this;
+    }
+    if (_raw) {
+        free(_raw);
+    }
+    _raw = array._raw;
+    _size = array._size;
+    _capacity = array._capacity;
+    std::memcpy(_channel,array._channel,sizeof(_channel));
+    std::memset(array._channel,0,sizeof(array._channel));
+    array._raw = nullptr;
+    array._size = 0;
+    array._capacity = 0;
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Storage
+/**
+ * Ensures that this array can store the given number of colors.
+ *
+ * This method may not be called on a view.
+ *
+ * @param capacity  The number of colors to reserve
+ */
+void Color4Array::reserve(size_t capacity) {
+    CUAssertLog(!isView(), "Cannot reallocate a view");
+    if (capacity <= _capacity) {
+        return;
+    }
+    size_t stride = simd::soa_capacity(capacity);
+    void* raw = nullptr;
+    float* data = simd::soa_allocate(4*stride,raw);
+    for(int ii = 0; ii < 4; ii++) {
+        if (_size) {
+            std::memcpy(data+ii*stride,_channel[ii],_size*sizeof(float));
+        }
+        _channel[ii] = data+ii*stride;
+    }
+    if (_raw) {
+        free(_raw);
+    }
+    _raw = raw;
+    _capacity = stride;
+}
+
+/**
+ * Changes the number of colors in this array.
+ *
+ * Any new colors are initialized to transparent black.  This method may
+ * not be called on a view.
+ *
+ * @param size  The new number of colors
+ */
+void Color4Array::resize(size_t size) {
+    CUAssertLog(!isView(), "Cannot resize a view");
+    if (size > _capacity) {
+        reserve(size);
+    }
+    if (size > _size) {
+        for(int ii = 0; ii < 4; ii++) {
+            std::memset(_channel[ii]+_size,0,(size-_size)*sizeof(float));
+        }
+    }
+    _size = size;
+}
+
+/**
+ * Appends a color to the end of this array.
+ *
+ * This method may not be called on a view.
+ *
+ * @param color The color to append
+ */
+void Color4Array::append(const Color4f& color) {
+    if (_size == _capacity) {
+        reserve(_capacity ? 2*_capacity : 4);
+    }
+    _size++;
+    set(_size-1,color);
+}
+
+
+#pragma mark -
+#pragma mark Conversion
+/**
+ * Sets this array to a copy of the given colors.
+ *
+ * If this array is a view, the number of colors must be the same as
+ * the size of the view.  Otherwise, the array is resized.
+ *
+ * @param colors    The colors to copy
+ * @param size      The number of colors
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::load(const Color4f* colors, size_t size) {
+    CUAssertLog(size == 0 || colors, "Color array is null");
+    if (!isView()) {
+        resize(size);
+    }
+    CUAssertLog(_size == size, "View size %zu does not match %zu", _size, size);
+    simd::soa_split4((const float*)colors,_channel[0],_channel[1],_channel[2],_channel[3],size);
+    return *this;
+}
+
+/**
+ * Sets this array to a copy of the given byte colors.
+ *
+ * If this array is a view, the number of colors must be the same as
+ * the size of the view.  Otherwise, the array is resized.
+ *
+ * @param colors    The colors to copy
+ * @param size      The number of colors
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::load(const Color4* colors, size_t size) {
+    CUAssertLog(size == 0 || colors, "Color array is null");
+    if (!isView()) {
+        resize(size);
+    }
+    CUAssertLog(_size == size, "View size %zu does not match %zu", _size, size);
+    for(size_t ii = 0; ii < size; ii++) {
+        _channel[0][ii] = COLOR_BYTE_TO_FLOAT(colors[ii].r);
+        _channel[1][ii] = COLOR_BYTE_TO_FLOAT(colors[ii].g);
+        _channel[2][ii] = COLOR_BYTE_TO_FLOAT(colors[ii].b);
+        _channel[3][ii] = COLOR_BYTE_TO_FLOAT(colors[ii].a);
+    }
+    return *this;
+}
+
+/**
+ * Stores the colors of this array in the given buffer.
+ *
+ * The buffer must have room for {@link #size} colors.
+ *
+ * @param colors    The buffer to store the colors
+ */
+void Color4Array::store(Color4f* colors) const {
+    CUAssertLog(_size == 0 || colors, "Color array is null");
+    simd::soa_merge4(_channel[0],_channel[1],_channel[2],_channel[3],(float*)colors,_size);
+}
+
+/**
+ * Stores the colors of this array in the given buffer of byte colors.
+ *
+ * The colors are clamped to the range [0,1] before conversion.  The
+ * buffer must have room for {@link #size} colors.
+ *
+ * @param colors    The buffer to store the colors
+ */
+void Color4Array::store(Color4* colors) const {
+    CUAssertLog(_size == 0 || colors, "Color array is null");
+    for(size_t ii = 0; ii < _size; ii++) {
+        colors[ii].r = COLOR_FLOAT_TO_BYTE(clampf(_channel[0][ii],0,1));
+        colors[ii].g = COLOR_FLOAT_TO_BYTE(clampf(_channel[1][ii],0,1));
+        colors[ii].b = COLOR_FLOAT_TO_BYTE(clampf(_channel[2][ii],0,1));
+        colors[ii].a = COLOR_FLOAT_TO_BYTE(clampf(_channel[3][ii],0,1));
+    }
+}
+
+
+#pragma mark -
+#pragma mark Arithmetic
+/**
+ * Adds the given colors to this array in place.
+ *
+ * This operation is functionally identical to additive blending. The
+ * addition is clamped so that these remain valid colors.
+ *
+ * @param array The colors to add
+ * @param alpha Whether to add the alpha values (optional)
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::add(const Color4Array& array, bool alpha) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    int channels = alpha ? 4 : 3;
+    for(int ii = 0; ii < channels; ii++) {
+        simd::soa_add(_channel[ii],array._channel[ii],_channel[ii],_size);
+        simd::soa_clamp(_channel[ii],0,1,_channel[ii],_size);
+    }
+    return *this;
+}
+
+/**
+ * Scales every color in this array by the given factor.
+ *
+ * The scaling is clamped so that these remain valid colors.
+ *
+ * @param s     The scalar to multiply by
+ * @param alpha Whether to scale the alpha values (optional)
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::scale(float s, bool alpha) {
+    int channels = alpha ? 4 : 3;
+    for(int ii = 0; ii < channels; ii++) {
+        simd::soa_scale_clamp(_channel[ii],s,0,0,1,_channel[ii],_size);
+    }
+    return *this;
+}
+
+/**
+ * Scales every color in this array nonuniformly by the given color.
+ *
+ * This operation is functionally identical to multiplicative blending.
+ *
+ * @param c     The color to scale by
+ * @param alpha Whether to scale the alpha values (optional)
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::scale(const Color4f& c, bool alpha) {
+    const float factor[4] = { c.r, c.g, c.b, c.a };
+    int channels = alpha ? 4 : 3;
+    for(int ii = 0; ii < channels; ii++) {
+        simd::soa_scale(_channel[ii],factor[ii],0,_channel[ii],_size);
+    }
+    return *this;
+}
+
+/**
+ * Scales each color in this array nonuniformly by its partner.
+ *
+ * This operation is functionally identical to multiplicative blending.
+ *
+ * @param array The colors to scale by
+ * @param alpha Whether to scale the alpha values (optional)
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::scale(const Color4Array& array, bool alpha) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    int channels = alpha ? 4 : 3;
+    for(int ii = 0; ii < channels; ii++) {
+        simd::soa_mul(_channel[ii],array._channel[ii],_channel[ii],_size);
+    }
+    return *this;
+}
+
+/**
+ * Linearly interpolates this array towards the given one in place.
+ *
+ * If alpha is 0, the colors are unchanged.  If alpha is 1, the colors
+ * are those of other.  If alpha is outside of the range 0 to 1, it is
+ * clamped to the nearest value.
+ *
+ * @param array The colors to interpolate with
+ * @param alpha The interpolation value in 0..1
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::lerp(const Color4Array& array, float alpha) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    float x = clampf(alpha,0,1);
+    for(int ii = 0; ii < 4; ii++) {
+        simd::soa_scale(_channel[ii],1-x,0,_channel[ii],_size);
+        simd::soa_madd(_channel[ii],array._channel[ii],x,_channel[ii],_size);
+        simd::soa_clamp(_channel[ii],0,1,_channel[ii],_size);
+    }
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Blending
+/**
+ * Blends the given colors over the colors of this array.
+ *
+ * The blending is the standard over operation with this array as the
+ * destination. It assumes that the color values are not premultiplied.
+ * Unlike {@link Color4f#blend}, a pair of transparent colors blends to
+ * transparent black instead of dividing by zero.
+ *
+ * @param array The colors to blend with
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::blend(const Color4Array& array) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    simd::color4_blend(_channel,array._channel,_size);
+    return *this;
+}
+
+/**
+ * Blends the given colors over the colors of this array.
+ *
+ * The blending is the standard over operation with this array as the
+ * destination. It assumes that the colors are premultiplied.
+ *
+ * @param array The colors to blend with
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::blendPre(const Color4Array& array) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    simd::color4_blend_pre(_channel,array._channel,_size);
+    return *this;
+}
+
+/**
+ * Premultiplies every color in this array with its alpha.
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::premultiply() {
+    for(int ii = 0; ii < 3; ii++) {
+        simd::soa_mul(_channel[ii],_channel[3],_channel[ii],_size);
+    }
+    return *this;
+}
+
+/**
+ * Undoes premultiplication of every color in this array.
+ *
+ * Any color with alpha value 0 is unchanged.
+ *
+ * @return a reference to this array for chaining.
+ */
+Color4Array& Color4Array::unpremultiply() {
+    for(int ii = 0; ii < 3; ii++) {
+        simd::soa_div_positive(_channel[ii],_channel[3],_channel[ii],_size);
+    }
+    return *this;
+}
@@ -398,13 +398,19 @@ CubicSpline& CubicSpline::set(const CubicSpline& spline) {
  * a closed spline.  They may only be inserted between two other
  * anchors.
  *
+ * Closing a spline adds a copy of the first anchor to the end if it is
+ * not already there.  Opening a spline keeps that last anchor, so the
+ * curve is unchanged.
+ *
  * @param flag whether the spline is closed
  */
 void CubicSpline::setClosed(bool flag) {
-    if (flag && (_points[0] != _points[3 * _size])) {
-        addAnchor(_points[0]);
+    if (flag && !_closed && (_points[0] != _points[3 * _size])) {
+        // Copy the anchor, as adding one may reallocate the points
+        Vec2 anchor = _points[0];
+        addAnchor(anchor);
     }
-    _closed = true;
+    _closed = flag;
 }
 
 /**
@@ -428,7 +434,7 @@ Vec2 CubicSpline::getPoint(int segment, float tp) const {
         return _points[3 * segment];
     }
     
-    int index = 6 * segment;
+    int index = 3 * segment;
     float sp = (1 - tp);
     float a = sp*sp;
     float d = tp*tp;
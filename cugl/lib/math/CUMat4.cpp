@@ -41,6 +41,7 @@
 #include <cugl/util/CUStrings.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/math/CURect.h>
+#include "CUMathSIMD.h"
 
 #include <sstream>
 #include <algorithm>
@@ -918,6 +919,79 @@ Vec2* Mat4::transform(const Mat4& mat, const Vec2& point, Vec2* dst) {
     return dst;
 }
 
+/**
+ * Transforms the array of points and stores the result in output.
+ *
+ * The points are treated as points, which means that translation is
+ * applied to the result.  This method is much faster than transforming
+ * each point individually on vectorized platforms.  The input and output
+ * may be the same array, but they may not otherwise overlap.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The points to transform.
+ * @param output    An array to store the transformed points in.
+ * @param count     The number of points to transform.
+ *
+ * @return A reference to output for chaining
+ */
+Vec2* Mat4::transform(const Mat4& mat, const Vec2* input, Vec2* output, size_t count) {
+    CUAssertLog(count == 0 || (input && output), "Point arrays are null");
+    // A 2d point has z = 0 and w = 1, and the result ignores w
+    const float coeff[6] = { mat.m[0], mat.m[4], mat.m[12], mat.m[1], mat.m[5], mat.m[13] };
+    simd::affine2_packed(coeff,&(input->x),&(output->x),count);
+    return output;
+}
+
+/**
+ * Transforms the strided array of points and stores the result in output.
+ *
+ * Consecutive points are separated by the given number of bytes, instead
+ * of sizeof(Vec2).  This allows the method to transform the positions of
+ * an interleaved vertex array, like those of {@link Vertex2}, without
+ * copying them.  The input and output may be the same array (with the same
+ * stride), but they may not otherwise overlap.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The first point to transform.
+ * @param istride   The number of bytes between input points.
+ * @param output    The location to store the first transformed point.
+ * @param ostride   The number of bytes between output points.
+ * @param count     The number of points to transform.
+ *
+ * @return A reference to output for chaining
+ */
+Vec2* Mat4::transform(const Mat4& mat, const Vec2* input, size_t istride,
+                       Vec2* output, size_t ostride, size_t count) {
+    CUAssertLog(count == 0 || (input && output), "Point arrays are null");
+    // A 2d point has z = 0 and w = 1, and the result ignores w
+    const float coeff[6] = { mat.m[0], mat.m[4], mat.m[12], mat.m[1], mat.m[5], mat.m[13] };
+    simd::affine2_strided(coeff,&(input->x),istride,&(output->x),ostride,count);
+    return output;
+}
+
+/**
+ * Transforms the points stored as separate coordinate arrays.
+ *
+ * This is the structure-of-arrays layout, where the x and y coordinates
+ * are stored in separate arrays.  It is the fastest layout to transform
+ * on vectorized platforms.  Each output array may be the same as its
+ * input array, but the arrays may not otherwise overlap.
+ *
+ * @param mat       The transform matrix.
+ * @param xin       The x-coordinates to transform.
+ * @param yin       The y-coordinates to transform.
+ * @param xout      An array to store the transformed x-coordinates.
+ * @param yout      An array to store the transformed y-coordinates.
+ * @param count     The number of points to transform.
+ */
+void Mat4::transform(const Mat4& mat, const float* xin, const float* yin,
+                      float* xout, float* yout, size_t count) {
+    CUAssertLog(count == 0 || (xin && yin && xout && yout), "Coordinate arrays are null");
+    // A 2d point has z = 0 and w = 1, and the result ignores w
+    const float coeff[6] = { mat.m[0], mat.m[4], mat.m[12], mat.m[1], mat.m[5], mat.m[13] };
+    simd::affine2_soa(coeff,xin,yin,xout,yout,count);
+}
+
 /**
  * Transforms the vector by the given matrix, and stores the result in dst.
  *
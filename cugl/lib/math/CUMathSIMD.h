@@ -0,0 +1,1072 @@
+//
+//  CUMathSIMD.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the bulk vertex kernels shared by Affine2 and Mat4.
+//  A 2d point transformed by either class is an affine map, so both reduce
+//  to the same six coefficients.  It also provides the triangle containment
+//  kernel for Poly2, and the structure-of-arrays kernels for Vec2Array,
+//  Color4Array and AffineArray.  The kernels use SSE on x86 and NEON on ARM, with a
+//  scalar fallback for everything else.  They never assume that the data is
+//  aligned, so they are safe on std::vector and Vertex2 buffers.
+//
+//  This file is an internal header.  It is not accessible by general users
+//  of the CUGL API.  Because all of the functions are inline, it has no
+//  associated cpp file.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CU_MATH_SIMD_H__
+#define __CU_MATH_SIMD_H__
+#include <cugl/math/CUMathBase.h>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+
+#if defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define CU_MATH_SIMD_SSE
+    #include <xmmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+    #define CU_MATH_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace cugl {
+namespace simd {
+
+/**
+ * Transforms a single point by the affine coefficients.
+ *
+ * The coefficients are stored in row order {a, b, tx, c, d, ty}, so that
+ * x' = ax+by+tx and y' = cx+dy+ty.  The output may be the same as the input.
+ *
+ * @param coeff     The affine coefficients
+ * @param input     The point to transform
+ * @param output    The point to store the result
+ */
+static inline void affine2_point(const float* coeff, const float* input, float* output) {
+    float x = coeff[0]*input[0]+coeff[1]*input[1]+coeff[2];
+    float y = coeff[3]*input[0]+coeff[4]*input[1]+coeff[5];
+    output[0] = x;
+    output[1] = y;
+}
+
+#if defined (CU_MATH_SIMD_SSE)
+/**
+ * Returns the transform of the two points stored in v
+ *
+ * The vector v stores the points as {x0, y0, x1, y1}.  The coefficient
+ * vectors are the columns of the affine transform, interleaved for two
+ * points.
+ *
+ * @param v     The points to transform
+ * @param cx    The x column {a, c, a, c}
+ * @param cy    The y column {b, d, b, d}
+ * @param ct    The translation {tx, ty, tx, ty}
+ *
+ * @return the transform of the two points stored in v
+ */
+static inline __m128 affine2_pair(__m128 v, __m128 cx, __m128 cy, __m128 ct) {
+    __m128 xx = _mm_shuffle_ps(v,v,_MM_SHUFFLE(2,2,0,0));
+    __m128 yy = _mm_shuffle_ps(v,v,_MM_SHUFFLE(3,3,1,1));
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx,cx),_mm_mul_ps(yy,cy)),ct);
+}
+#elif defined (CU_MATH_SIMD_NEON)
+/**
+ * Returns the transform of the two points stored in v
+ *
+ * The vector v stores the points as {x0, y0, x1, y1}.  The coefficient
+ * vectors are the columns of the affine transform, interleaved for two
+ * points.
+ *
+ * @param v     The points to transform
+ * @param cx    The x column {a, c, a, c}
+ * @param cy    The y column {b, d, b, d}
+ * @param ct    The translation {tx, ty, tx, ty}
+ *
+ * @return the transform of the two points stored in v
+ */
+static inline float32x4_t affine2_pair(float32x4_t v, float32x4_t cx, float32x4_t cy, float32x4_t ct) {
+    float32x4x2_t split = vtrnq_f32(v,v);
+    return vmlaq_f32(vmlaq_f32(ct,split.val[0],cx),split.val[1],cy);
+}
+#endif
+
+/**
+ * Transforms an array of tightly packed points by the affine coefficients.
+ *
+ * The points are stored as interleaved {x, y} pairs with no padding, which
+ * is the layout of an array of Vec2.  The input and output may be the same
+ * array, but they may not otherwise overlap.
+ *
+ * @param coeff     The affine coefficients {a, b, tx, c, d, ty}
+ * @param input     The points to transform
+ * @param output    The array to store the results
+ * @param count     The number of points to transform
+ */
+static inline void affine2_packed(const float* coeff, const float* input, float* output, size_t count) {
+    size_t ii = 0;
+#if defined (CU_MATH_SIMD_SSE)
+    __m128 cx = _mm_setr_ps(coeff[0],coeff[3],coeff[0],coeff[3]);
+    __m128 cy = _mm_setr_ps(coeff[1],coeff[4],coeff[1],coeff[4]);
+    __m128 ct = _mm_setr_ps(coeff[2],coeff[5],coeff[2],coeff[5]);
+    for(; ii+4 <= count; ii += 4) {
+        __m128 v0 = _mm_loadu_ps(input+2*ii);
+        __m128 v1 = _mm_loadu_ps(input+2*ii+4);
+        _mm_storeu_ps(output+2*ii,  affine2_pair(v0,cx,cy,ct));
+        _mm_storeu_ps(output+2*ii+4,affine2_pair(v1,cx,cy,ct));
+    }
+    for(; ii+2 <= count; ii += 2) {
+        __m128 v0 = _mm_loadu_ps(input+2*ii);
+        _mm_storeu_ps(output+2*ii,affine2_pair(v0,cx,cy,ct));
+    }
+#elif defined (CU_MATH_SIMD_NEON)
+    float32x4_t tx = vdupq_n_f32(coeff[2]);
+    float32x4_t ty = vdupq_n_f32(coeff[5]);
+    for(; ii+4 <= count; ii += 4) {
+        float32x4x2_t v = vld2q_f32(input+2*ii);
+        float32x4x2_t r;
+        r.val[0] = vmlaq_n_f32(vmlaq_n_f32(tx,v.val[0],coeff[0]),v.val[1],coeff[1]);
+        r.val[1] = vmlaq_n_f32(vmlaq_n_f32(ty,v.val[0],coeff[3]),v.val[1],coeff[4]);
+        vst2q_f32(output+2*ii,r);
+    }
+#endif
+    for(; ii < count; ii++) {
+        affine2_point(coeff,input+2*ii,output+2*ii);
+    }
+}
+
+/**
+ * Transforms an array of strided points by the affine coefficients.
+ *
+ * Each point is an {x, y} pair, but consecutive points are separated by
+ * the given number of bytes.  This allows the kernel to transform the
+ * positions of a Vertex2 array in place.  The input and output may be the
+ * same array (with the same stride), but they may not otherwise overlap.
+ *
+ * @param coeff     The affine coefficients {a, b, tx, c, d, ty}
+ * @param input     The first point to transform
+ * @param istride   The number of bytes between input points
+ * @param output    The location to store the first result
+ * @param ostride   The number of bytes between output points
+ * @param count     The number of points to transform
+ */
+static inline void affine2_strided(const float* coeff, const float* input, size_t istride,
+                                   float* output, size_t ostride, size_t count) {
+    if (istride == 2*sizeof(float) && ostride == 2*sizeof(float)) {
+        affine2_packed(coeff, input, output, count);
+        return;
+    }
+
+    const char* src = (const char*)input;
+    char* dst = (char*)output;
+    size_t ii = 0;
+#if defined (CU_MATH_SIMD_SSE)
+    __m128 cx = _mm_setr_ps(coeff[0],coeff[3],coeff[0],coeff[3]);
+    __m128 cy = _mm_setr_ps(coeff[1],coeff[4],coeff[1],coeff[4]);
+    __m128 ct = _mm_setr_ps(coeff[2],coeff[5],coeff[2],coeff[5]);
+    for(; ii+2 <= count; ii += 2) {
+        __m128 v = _mm_loadl_pi(_mm_setzero_ps(),(const __m64*)src);
+        v = _mm_loadh_pi(v,(const __m64*)(src+istride));
+        v = affine2_pair(v,cx,cy,ct);
+        _mm_storel_pi((__m64*)dst,v);
+        _mm_storeh_pi((__m64*)(dst+ostride),v);
+        src += 2*istride;
+        dst += 2*ostride;
+    }
+#elif defined (CU_MATH_SIMD_NEON)
+    float32x4_t cx = {coeff[0],coeff[3],coeff[0],coeff[3]};
+    float32x4_t cy = {coeff[1],coeff[4],coeff[1],coeff[4]};
+    float32x4_t ct = {coeff[2],coeff[5],coeff[2],coeff[5]};
+    for(; ii+2 <= count; ii += 2) {
+        float32x4_t v = vcombine_f32(vld1_f32((const float*)src),vld1_f32((const float*)(src+istride)));
+        v = affine2_pair(v,cx,cy,ct);
+        vst1_f32((float*)dst,vget_low_f32(v));
+        vst1_f32((float*)(dst+ostride),vget_high_f32(v));
+        src += 2*istride;
+        dst += 2*ostride;
+    }
+#endif
+    for(; ii < count; ii++) {
+        affine2_point(coeff,(const float*)src,(float*)dst);
+        src += istride;
+        dst += ostride;
+    }
+}
+
+/**
+ * Transforms points stored as separate coordinate arrays.
+ *
+ * This is the structure-of-arrays layout, where the x and y coordinates
+ * are stored in separate arrays.  Each output array may be the same as
+ * its input array, but the arrays may not otherwise overlap.
+ *
+ * @param coeff     The affine coefficients {a, b, tx, c, d, ty}
+ * @param xin       The x-coordinates to transform
+ * @param yin       The y-coordinates to transform
+ * @param xout      The array to store the transformed x-coordinates
+ * @param yout      The array to store the transformed y-coordinates
+ * @param count     The number of points to transform
+ */
+static inline void affine2_soa(const float* coeff, const float* xin, const float* yin,
+                               float* xout, float* yout, size_t count) {
+    size_t ii = 0;
+#if defined (CU_MATH_SIMD_SSE)
+    __m128 a  = _mm_set1_ps(coeff[0]);
+    __m128 b  = _mm_set1_ps(coeff[1]);
+    __m128 tx = _mm_set1_ps(coeff[2]);
+    __m128 c  = _mm_set1_ps(coeff[3]);
+    __m128 d  = _mm_set1_ps(coeff[4]);
+    __m128 ty = _mm_set1_ps(coeff[5]);
+    for(; ii+4 <= count; ii += 4) {
+        __m128 x = _mm_loadu_ps(xin+ii);
+        __m128 y = _mm_loadu_ps(yin+ii);
+        _mm_storeu_ps(xout+ii,_mm_add_ps(_mm_add_ps(_mm_mul_ps(x,a),_mm_mul_ps(y,b)),tx));
+        _mm_storeu_ps(yout+ii,_mm_add_ps(_mm_add_ps(_mm_mul_ps(x,c),_mm_mul_ps(y,d)),ty));
+    }
+#elif defined (CU_MATH_SIMD_NEON)
+    float32x4_t tx = vdupq_n_f32(coeff[2]);
+    float32x4_t ty = vdupq_n_f32(coeff[5]);
+    for(; ii+4 <= count; ii += 4) {
+        float32x4_t x = vld1q_f32(xin+ii);
+        float32x4_t y = vld1q_f32(yin+ii);
+        vst1q_f32(xout+ii,vmlaq_n_f32(vmlaq_n_f32(tx,x,coeff[0]),y,coeff[1]));
+        vst1q_f32(yout+ii,vmlaq_n_f32(vmlaq_n_f32(ty,x,coeff[3]),y,coeff[4]));
+    }
+#endif
+    for(; ii < count; ii++) {
+        float x = xin[ii];
+        float y = yin[ii];
+        xout[ii] = coeff[0]*x+coeff[1]*y+coeff[2];
+        yout[ii] = coeff[3]*x+coeff[4]*y+coeff[5];
+    }
+}
+
+/** The number of floats in a block of four triangles */
+#define CU_SIMD_TRIANGLE_BLOCK  48
+
+/**
+ * Returns true if the point is inside any of the given triangles.
+ *
+ * The triangles are stored in blocks of four, in structure-of-arrays form.
+ * Each block is 12 groups of four floats, one float for each triangle.  For
+ * a triangle with vertices a, b, and c, these groups are
+ *
+ *     {ax, ay, bx-ax, by-ay, bx, by, cx-bx, cy-by, cx, cy, ax-cx, ay-cy}
+ *
+ * A point is inside a triangle if it is not strictly on the outside of any
+ * edge.  This includes points on the triangle border, and it works for either
+ * orientation.  Degenerate triangles are not supported and should never be
+ * stored in a block.  Any lanes in the final block past count are ignored.
+ *
+ * @param blocks    The triangle blocks
+ * @param count     The number of triangles (not blocks)
+ * @param x         The x-coordinate of the point
+ * @param y         The y-coordinate of the point
+ *
+ * @return true if the point is inside any of the given triangles.
+ */
+static inline bool triangles_contain(const float* blocks, size_t count, float x, float y) {
+    size_t ii = 0;
+#if defined (CU_MATH_SIMD_SSE)
+    __m128 px = _mm_set1_ps(x);
+    __m128 py = _mm_set1_ps(y);
+    __m128 zero = _mm_setzero_ps();
+    for(; ii < count; ii += 4, blocks += CU_SIMD_TRIANGLE_BLOCK) {
+        __m128 neg = zero;
+        __m128 pos = zero;
+        for(int jj = 0; jj < 3; jj++) {
+            const float* edge = blocks+16*jj;
+            __m128 dx = _mm_sub_ps(px,_mm_loadu_ps(edge));
+            __m128 dy = _mm_sub_ps(py,_mm_loadu_ps(edge+4));
+            __m128 d  = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(edge+8),dy),_mm_mul_ps(_mm_loadu_ps(edge+12),dx));
+            neg = _mm_or_ps(neg,_mm_cmplt_ps(d,zero));
+            pos = _mm_or_ps(pos,_mm_cmpgt_ps(d,zero));
+        }
+        int outside = _mm_movemask_ps(_mm_and_ps(neg,pos));
+        int valid = count-ii >= 4 ? 0xf : (1 << (count-ii))-1;
+        if (~outside & valid) {
+            return true;
+        }
+    }
+#elif defined (CU_MATH_SIMD_NEON)
+    float32x4_t px = vdupq_n_f32(x);
+    float32x4_t py = vdupq_n_f32(y);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    uint32_t lanes[4];
+    for(; ii < count; ii += 4, blocks += CU_SIMD_TRIANGLE_BLOCK) {
+        uint32x4_t neg = vdupq_n_u32(0);
+        uint32x4_t pos = vdupq_n_u32(0);
+        for(int jj = 0; jj < 3; jj++) {
+            const float* edge = blocks+16*jj;
+            float32x4_t dx = vsubq_f32(px,vld1q_f32(edge));
+            float32x4_t dy = vsubq_f32(py,vld1q_f32(edge+4));
+            float32x4_t d  = vsubq_f32(vmulq_f32(vld1q_f32(edge+8),dy),vmulq_f32(vld1q_f32(edge+12),dx));
+            neg = vorrq_u32(neg,vcltq_f32(d,zero));
+            pos = vorrq_u32(pos,vcgtq_f32(d,zero));
+        }
+        vst1q_u32(lanes,vandq_u32(neg,pos));
+        size_t valid = count-ii >= 4 ? 4 : count-ii;
+        for(size_t kk = 0; kk < valid; kk++) {
+            if (!lanes[kk]) {
+                return true;
+            }
+        }
+    }
+#else
+    for(; ii < count; ii++) {
+        const float* block = blocks+CU_SIMD_TRIANGLE_BLOCK*(ii/4)+(ii%4);
+        bool neg = false;
+        bool pos = false;
+        for(int jj = 0; jj < 3; jj++) {
+            const float* edge = block+16*jj;
+            float d = edge[8]*(y-edge[4])-edge[12]*(x-edge[0]);
+            neg = neg || d < 0;
+            pos = pos || d > 0;
+        }
+        if (!(neg && pos)) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+
+#pragma mark -
+#pragma mark Structure of Arrays
+#if defined (CU_MATH_SIMD_SSE)
+/** The number of floats in a batch */
+#define CU_MATH_LANES 4
+typedef __m128 batch_t;
+static inline batch_t batch_set(float v)            { return _mm_set1_ps(v); }
+static inline batch_t batch_load(const float* p)    { return _mm_loadu_ps(p); }
+static inline void batch_store(float* p, batch_t a) { _mm_storeu_ps(p,a); }
+static inline batch_t batch_add(batch_t a, batch_t b) { return _mm_add_ps(a,b); }
+static inline batch_t batch_sub(batch_t a, batch_t b) { return _mm_sub_ps(a,b); }
+static inline batch_t batch_mul(batch_t a, batch_t b) { return _mm_mul_ps(a,b); }
+static inline batch_t batch_div(batch_t a, batch_t b) { return _mm_div_ps(a,b); }
+static inline batch_t batch_min(batch_t a, batch_t b) { return _mm_min_ps(a,b); }
+static inline batch_t batch_max(batch_t a, batch_t b) { return _mm_max_ps(a,b); }
+static inline batch_t batch_sqrt(batch_t a)           { return _mm_sqrt_ps(a); }
+static inline batch_t batch_gt(batch_t a, batch_t b)  { return _mm_cmpgt_ps(a,b); }
+static inline batch_t batch_select(batch_t mask, batch_t a, batch_t b) {
+    return _mm_or_ps(_mm_and_ps(mask,a),_mm_andnot_ps(mask,b));
+}
+static inline void batch_load2(const float* p, batch_t& x, batch_t& y) {
+    __m128 v0 = _mm_loadu_ps(p);
+    __m128 v1 = _mm_loadu_ps(p+4);
+    x = _mm_shuffle_ps(v0,v1,_MM_SHUFFLE(2,0,2,0));
+    y = _mm_shuffle_ps(v0,v1,_MM_SHUFFLE(3,1,3,1));
+}
+static inline void batch_store2(float* p, batch_t x, batch_t y) {
+    _mm_storeu_ps(p,  _mm_unpacklo_ps(x,y));
+    _mm_storeu_ps(p+4,_mm_unpackhi_ps(x,y));
+}
+static inline void batch_load4(const float* p, batch_t& x, batch_t& y, batch_t& z, batch_t& w) {
+    x = _mm_loadu_ps(p);
+    y = _mm_loadu_ps(p+4);
+    z = _mm_loadu_ps(p+8);
+    w = _mm_loadu_ps(p+12);
+    _MM_TRANSPOSE4_PS(x,y,z,w);
+}
+static inline void batch_store4(float* p, batch_t x, batch_t y, batch_t z, batch_t w) {
+    _MM_TRANSPOSE4_PS(x,y,z,w);
+    _mm_storeu_ps(p,   x);
+    _mm_storeu_ps(p+4, y);
+    _mm_storeu_ps(p+8, z);
+    _mm_storeu_ps(p+12,w);
+}
+#elif defined (CU_MATH_SIMD_NEON)
+/** The number of floats in a batch */
+#define CU_MATH_LANES 4
+typedef float32x4_t batch_t;
+static inline batch_t batch_set(float v)            { return vdupq_n_f32(v); }
+static inline batch_t batch_load(const float* p)    { return vld1q_f32(p); }
+static inline void batch_store(float* p, batch_t a) { vst1q_f32(p,a); }
+static inline batch_t batch_add(batch_t a, batch_t b) { return vaddq_f32(a,b); }
+static inline batch_t batch_sub(batch_t a, batch_t b) { return vsubq_f32(a,b); }
+static inline batch_t batch_mul(batch_t a, batch_t b) { return vmulq_f32(a,b); }
+static inline batch_t batch_min(batch_t a, batch_t b) { return vminq_f32(a,b); }
+static inline batch_t batch_max(batch_t a, batch_t b) { return vmaxq_f32(a,b); }
+static inline batch_t batch_gt(batch_t a, batch_t b)  { return vreinterpretq_f32_u32(vcgtq_f32(a,b)); }
+static inline batch_t batch_select(batch_t mask, batch_t a, batch_t b) {
+    return vbslq_f32(vreinterpretq_u32_f32(mask),a,b);
+}
+#if defined (__aarch64__)
+static inline batch_t batch_div(batch_t a, batch_t b) { return vdivq_f32(a,b); }
+static inline batch_t batch_sqrt(batch_t a)           { return vsqrtq_f32(a); }
+#else
+static inline batch_t batch_div(batch_t a, batch_t b) {
+    // Reciprocal estimate with two Newton-Raphson refinements
+    float32x4_t r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b,r),r);
+    r = vmulq_f32(vrecpsq_f32(b,r),r);
+    return vmulq_f32(a,r);
+}
+static inline batch_t batch_sqrt(batch_t a) {
+    // Reciprocal square root estimate, with zero inputs masked out
+    float32x4_t e = vrsqrteq_f32(a);
+    e = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a,e),e),e);
+    e = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a,e),e),e);
+    return batch_select(batch_gt(a,vdupq_n_f32(0)),vmulq_f32(a,e),vdupq_n_f32(0));
+}
+#endif
+static inline void batch_load2(const float* p, batch_t& x, batch_t& y) {
+    float32x4x2_t v = vld2q_f32(p);
+    x = v.val[0];
+    y = v.val[1];
+}
+static inline void batch_store2(float* p, batch_t x, batch_t y) {
+    float32x4x2_t v = {{ x, y }};
+    vst2q_f32(p,v);
+}
+static inline void batch_load4(const float* p, batch_t& x, batch_t& y, batch_t& z, batch_t& w) {
+    float32x4x4_t v = vld4q_f32(p);
+    x = v.val[0];
+    y = v.val[1];
+    z = v.val[2];
+    w = v.val[3];
+}
+static inline void batch_store4(float* p, batch_t x, batch_t y, batch_t z, batch_t w) {
+    float32x4x4_t v = {{ x, y, z, w }};
+    vst4q_f32(p,v);
+}
+#else
+/** The number of floats in a batch */
+#define CU_MATH_LANES 1
+typedef float batch_t;
+static inline batch_t batch_set(float v)            { return v; }
+static inline batch_t batch_load(const float* p)    { return *p; }
+static inline void batch_store(float* p, batch_t a) { *p = a; }
+static inline batch_t batch_add(batch_t a, batch_t b) { return a+b; }
+static inline batch_t batch_sub(batch_t a, batch_t b) { return a-b; }
+static inline batch_t batch_mul(batch_t a, batch_t b) { return a*b; }
+static inline batch_t batch_div(batch_t a, batch_t b) { return a/b; }
+static inline batch_t batch_min(batch_t a, batch_t b) { return a < b ? a : b; }
+static inline batch_t batch_max(batch_t a, batch_t b) { return a > b ? a : b; }
+static inline batch_t batch_sqrt(batch_t a)           { return std::sqrt(a); }
+static inline batch_t batch_gt(batch_t a, batch_t b)  { return a > b ? 1.0f : 0.0f; }
+static inline batch_t batch_select(batch_t mask, batch_t a, batch_t b) {
+    return mask != 0 ? a : b;
+}
+static inline void batch_load2(const float* p, batch_t& x, batch_t& y) {
+    x = p[0];
+    y = p[1];
+}
+static inline void batch_store2(float* p, batch_t x, batch_t y) {
+    p[0] = x;
+    p[1] = y;
+}
+static inline void batch_load4(const float* p, batch_t& x, batch_t& y, batch_t& z, batch_t& w) {
+    x = p[0];
+    y = p[1];
+    z = p[2];
+    w = p[3];
+}
+static inline void batch_store4(float* p, batch_t x, batch_t y, batch_t z, batch_t w) {
+    p[0] = x;
+    p[1] = y;
+    p[2] = z;
+    p[3] = w;
+}
+#endif
+
+/**
+ * Returns the number of floats to allocate for an array of the given size
+ *
+ * Structure-of-arrays containers round every component array up to a full
+ * batch, so that each component array starts on a 16 byte boundary.
+ *
+ * @param size  The number of elements
+ *
+ * @return the number of floats to allocate for an array of the given size
+ */
+static inline size_t soa_capacity(size_t size) {
+    return (size+3) & ~(size_t)3;
+}
+
+/**
+ * Returns a 16 byte aligned allocation for the given number of floats
+ *
+ * The raw allocation is stored in raw, and should be released with free.
+ * The memory is not initialized.
+ *
+ * @param count The number of floats to allocate
+ * @param raw   The raw allocation (output)
+ *
+ * @return a 16 byte aligned allocation for the given number of floats
+ */
+static inline float* soa_allocate(size_t count, void*& raw) {
+    raw = malloc(count*sizeof(float)+15);
+    return (float*)(((uintptr_t)raw+15) & ~(uintptr_t)15);
+}
+
+/**
+ * Stores the sum a+b in out
+ *
+ * The output may be the same as either input.
+ *
+ * @param a     The first array
+ * @param b     The second array
+ * @param out   The array to store the result
+ * @param count The number of elements
+ */
+static inline void soa_add(const float* a, const float* b, float* out, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_store(out+ii,batch_add(batch_load(a+ii),batch_load(b+ii)));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = a[ii]+b[ii];
+    }
+}
+
+/**
+ * Stores the difference a-b in out
+ *
+ * The output may be the same as either input.
+ *
+ * @param a     The first array
+ * @param b     The second array
+ * @param out   The array to store the result
+ * @param count The number of elements
+ */
+static inline void soa_sub(const float* a, const float* b, float* out, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_store(out+ii,batch_sub(batch_load(a+ii),batch_load(b+ii)));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = a[ii]-b[ii];
+    }
+}
+
+/**
+ * Stores the product a*b in out
+ *
+ * The output may be the same as either input.
+ *
+ * @param a     The first array
+ * @param b     The second array
+ * @param out   The array to store the result
+ * @param count The number of elements
+ */
+static inline void soa_mul(const float* a, const float* b, float* out, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_store(out+ii,batch_mul(batch_load(a+ii),batch_load(b+ii)));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = a[ii]*b[ii];
+    }
+}
+
+/**
+ * Stores a*s+t in out
+ *
+ * This is a uniform scale followed by a uniform translation, and covers
+ * both scaling and the addition of a constant.  The output may be the same
+ * as the input.
+ *
+ * @param a     The input array
+ * @param s     The scale factor
+ * @param t     The translation
+ * @param out   The array to store the result
+ * @param count The number of elements
+ */
+static inline void soa_scale(const float* a, float s, float t, float* out, size_t count) {
+    size_t ii = 0;
+    batch_t sv = batch_set(s);
+    batch_t tv = batch_set(t);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_store(out+ii,batch_add(batch_mul(batch_load(a+ii),sv),tv));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = a[ii]*s+t;
+    }
+}
+
+/**
+ * Stores a+b*s in out
+ *
+ * This is the multiply-add used for numerical integration, such as adding
+ * a velocity times a time step to a position.  The output may be the same
+ * as either input.
+ *
+ * @param a     The first array
+ * @param b     The second array
+ * @param s     The factor for the second array
+ * @param out   The array to store the result
+ * @param count The number of elements
+ */
+static inline void soa_madd(const float* a, const float* b, float s, float* out, size_t count) {
+    size_t ii = 0;
+    batch_t sv = batch_set(s);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_store(out+ii,batch_add(batch_load(a+ii),batch_mul(batch_load(b+ii),sv)));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = a[ii]+b[ii]*s;
+    }
+}
+
+/**
+ * Stores the values a*s+t, clamped to [min,max], in out
+ *
+ * This fuses {@link #soa_scale} and {@link #soa_clamp} into a single pass,
+ * which is how colors are scaled.  The output may be the same as the input.
+ *
+ * @param a     The input array
+ * @param s     The scale factor
+ * @param t     The translation
+ * @param min   The minimum value
+ * @param max   The maximum value
+ * @param out   The array to store the result
+ * @param count The number of elements
+ */
+static inline void soa_scale_clamp(const float* a, float s, float t, float min, float max,
+                                   float* out, size_t count) {
+    size_t ii = 0;
+    batch_t sv = batch_set(s);
+    batch_t tv = batch_set(t);
+    batch_t lo = batch_set(min);
+    batch_t hi = batch_set(max);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t v = batch_add(batch_mul(batch_load(a+ii),sv),tv);
+        batch_store(out+ii,batch_min(batch_max(v,lo),hi));
+    }
+    for(; ii < count; ii++) {
+        float v = a[ii]*s+t;
+        out[ii] = v < min ? min : (v > max ? max : v);
+    }
+}
+
+/**
+ * Stores the clamped values of a in out
+ *
+ * The output may be the same as the input.
+ *
+ * @param a     The input array
+ * @param min   The minimum value
+ * @param max   The maximum value
+ * @param out   The array to store the result
+ * @param count The number of elements
+ */
+static inline void soa_clamp(const float* a, float min, float max, float* out, size_t count) {
+    size_t ii = 0;
+    batch_t lo = batch_set(min);
+    batch_t hi = batch_set(max);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_store(out+ii,batch_min(batch_max(batch_load(a+ii),lo),hi));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = a[ii] < min ? min : (a[ii] > max ? max : a[ii]);
+    }
+}
+
+/**
+ * Stores the quotient a/b in out, wherever b is positive
+ *
+ * If b is not positive, the value of a is copied unchanged.  This is the
+ * guarded division used to undo alpha premultiplication.  The output may
+ * be the same as either input.
+ *
+ * @param a     The first array
+ * @param b     The second array
+ * @param out   The array to store the result
+ * @param count The number of elements
+ */
+static inline void soa_div_positive(const float* a, const float* b, float* out, size_t count) {
+    size_t ii = 0;
+    batch_t zero = batch_set(0.0f);
+    batch_t one  = batch_set(1.0f);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t bv = batch_load(b+ii);
+        batch_t mask = batch_gt(bv,zero);
+        batch_store(out+ii,batch_div(batch_load(a+ii),batch_select(mask,bv,one)));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = b[ii] > 0 ? a[ii]/b[ii] : a[ii];
+    }
+}
+
+/**
+ * Separates an array of interleaved pairs into two arrays
+ *
+ * This converts an array of Vec2 into structure-of-arrays form.
+ *
+ * @param input The interleaved pairs
+ * @param x     The array to store the first element of each pair
+ * @param y     The array to store the second element of each pair
+ * @param count The number of pairs
+ */
+static inline void soa_split2(const float* input, float* x, float* y, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t xv, yv;
+        batch_load2(input+2*ii,xv,yv);
+        batch_store(x+ii,xv);
+        batch_store(y+ii,yv);
+    }
+    for(; ii < count; ii++) {
+        x[ii] = input[2*ii];
+        y[ii] = input[2*ii+1];
+    }
+}
+
+/**
+ * Interleaves two arrays into an array of pairs
+ *
+ * This converts structure-of-arrays form into an array of Vec2.
+ *
+ * @param x         The first element of each pair
+ * @param y         The second element of each pair
+ * @param output    The array to store the interleaved pairs
+ * @param count     The number of pairs
+ */
+static inline void soa_merge2(const float* x, const float* y, float* output, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_store2(output+2*ii,batch_load(x+ii),batch_load(y+ii));
+    }
+    for(; ii < count; ii++) {
+        output[2*ii]   = x[ii];
+        output[2*ii+1] = y[ii];
+    }
+}
+
+/**
+ * Separates an array of interleaved quadruples into four arrays
+ *
+ * This converts an array of Color4f (or Vec4) into structure-of-arrays form.
+ *
+ * @param input The interleaved quadruples
+ * @param x     The array to store the first element of each quadruple
+ * @param y     The array to store the second element of each quadruple
+ * @param z     The array to store the third element of each quadruple
+ * @param w     The array to store the fourth element of each quadruple
+ * @param count The number of quadruples
+ */
+static inline void soa_split4(const float* input, float* x, float* y, float* z, float* w, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t xv, yv, zv, wv;
+        batch_load4(input+4*ii,xv,yv,zv,wv);
+        batch_store(x+ii,xv);
+        batch_store(y+ii,yv);
+        batch_store(z+ii,zv);
+        batch_store(w+ii,wv);
+    }
+    for(; ii < count; ii++) {
+        x[ii] = input[4*ii];
+        y[ii] = input[4*ii+1];
+        z[ii] = input[4*ii+2];
+        w[ii] = input[4*ii+3];
+    }
+}
+
+/**
+ * Interleaves four arrays into an array of quadruples
+ *
+ * This converts structure-of-arrays form into an array of Color4f (or Vec4).
+ *
+ * @param x         The first element of each quadruple
+ * @param y         The second element of each quadruple
+ * @param z         The third element of each quadruple
+ * @param w         The fourth element of each quadruple
+ * @param output    The array to store the interleaved quadruples
+ * @param count     The number of quadruples
+ */
+static inline void soa_merge4(const float* x, const float* y, const float* z, const float* w,
+                              float* output, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_store4(output+4*ii,batch_load(x+ii),batch_load(y+ii),batch_load(z+ii),batch_load(w+ii));
+    }
+    for(; ii < count; ii++) {
+        output[4*ii]   = x[ii];
+        output[4*ii+1] = y[ii];
+        output[4*ii+2] = z[ii];
+        output[4*ii+3] = w[ii];
+    }
+}
+
+/**
+ * Stores the dot products of the vectors (x1,y1) and (x2,y2) in out
+ *
+ * @param x1    The x-coordinates of the first vectors
+ * @param y1    The y-coordinates of the first vectors
+ * @param x2    The x-coordinates of the second vectors
+ * @param y2    The y-coordinates of the second vectors
+ * @param out   The array to store the dot products
+ * @param count The number of vectors
+ */
+static inline void vec2_dot(const float* x1, const float* y1, const float* x2, const float* y2,
+                            float* out, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t xx = batch_mul(batch_load(x1+ii),batch_load(x2+ii));
+        batch_t yy = batch_mul(batch_load(y1+ii),batch_load(y2+ii));
+        batch_store(out+ii,batch_add(xx,yy));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = x1[ii]*x2[ii]+y1[ii]*y2[ii];
+    }
+}
+
+/**
+ * Stores the dot products of the vectors (x,y) with (vx,vy) in out
+ *
+ * @param x     The x-coordinates of the vectors
+ * @param y     The y-coordinates of the vectors
+ * @param vx    The x-coordinate of the fixed vector
+ * @param vy    The y-coordinate of the fixed vector
+ * @param out   The array to store the dot products
+ * @param count The number of vectors
+ */
+static inline void vec2_dot(const float* x, const float* y, float vx, float vy,
+                            float* out, size_t count) {
+    size_t ii = 0;
+    batch_t bx = batch_set(vx);
+    batch_t by = batch_set(vy);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t xx = batch_mul(batch_load(x+ii),bx);
+        batch_t yy = batch_mul(batch_load(y+ii),by);
+        batch_store(out+ii,batch_add(xx,yy));
+    }
+    for(; ii < count; ii++) {
+        out[ii] = x[ii]*vx+y[ii]*vy;
+    }
+}
+
+/**
+ * Stores the lengths (or squared lengths) of the vectors (x,y) in out
+ *
+ * @param x         The x-coordinates of the vectors
+ * @param y         The y-coordinates of the vectors
+ * @param out       The array to store the lengths
+ * @param count     The number of vectors
+ * @param squared   Whether to compute the squared lengths
+ */
+static inline void vec2_length(const float* x, const float* y, float* out, size_t count, bool squared) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t xv = batch_load(x+ii);
+        batch_t yv = batch_load(y+ii);
+        batch_t len = batch_add(batch_mul(xv,xv),batch_mul(yv,yv));
+        batch_store(out+ii,squared ? len : batch_sqrt(len));
+    }
+    for(; ii < count; ii++) {
+        float len = x[ii]*x[ii]+y[ii]*y[ii];
+        out[ii] = squared ? len : std::sqrt(len);
+    }
+}
+
+/**
+ * Normalizes the vectors (x,y) in place
+ *
+ * As with {@link Vec2#normalize}, vectors whose length is less than
+ * CU_MATH_FLOAT_SMALL are unchanged.
+ *
+ * @param x     The x-coordinates of the vectors
+ * @param y     The y-coordinates of the vectors
+ * @param count The number of vectors
+ */
+static inline void vec2_normalize(float* x, float* y, size_t count) {
+    size_t ii = 0;
+    batch_t one = batch_set(1.0f);
+    batch_t small = batch_set(CU_MATH_FLOAT_SMALL);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t xv = batch_load(x+ii);
+        batch_t yv = batch_load(y+ii);
+        batch_t len = batch_sqrt(batch_add(batch_mul(xv,xv),batch_mul(yv,yv)));
+        batch_t inv = batch_select(batch_gt(len,small),batch_div(one,len),one);
+        batch_store(x+ii,batch_mul(xv,inv));
+        batch_store(y+ii,batch_mul(yv,inv));
+    }
+    for(; ii < count; ii++) {
+        float len = std::sqrt(x[ii]*x[ii]+y[ii]*y[ii]);
+        if (len > CU_MATH_FLOAT_SMALL) {
+            x[ii] /= len;
+            y[ii] /= len;
+        }
+    }
+}
+
+/**
+ * Transforms the points (x,y) in place, each by its own affine transform
+ *
+ * The transforms are stored as six coefficient arrays in the order
+ * {a, b, tx, c, d, ty}, so that x' = ax+by+tx and y' = cx+dy+ty.
+ *
+ * @param coeff The six coefficient arrays
+ * @param x     The x-coordinates of the points
+ * @param y     The y-coordinates of the points
+ * @param count The number of points
+ */
+static inline void affine2_each(const float* const* coeff, float* x, float* y, size_t count) {
+    size_t ii = 0;
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t xv = batch_load(x+ii);
+        batch_t yv = batch_load(y+ii);
+        batch_t rx = batch_add(batch_mul(batch_load(coeff[0]+ii),xv),batch_mul(batch_load(coeff[1]+ii),yv));
+        batch_t ry = batch_add(batch_mul(batch_load(coeff[3]+ii),xv),batch_mul(batch_load(coeff[4]+ii),yv));
+        batch_store(x+ii,batch_add(rx,batch_load(coeff[2]+ii)));
+        batch_store(y+ii,batch_add(ry,batch_load(coeff[5]+ii)));
+    }
+    for(; ii < count; ii++) {
+        float xv = x[ii];
+        float yv = y[ii];
+        x[ii] = coeff[0][ii]*xv+coeff[1][ii]*yv+coeff[2][ii];
+        y[ii] = coeff[3][ii]*xv+coeff[4][ii]*yv+coeff[5][ii];
+    }
+}
+
+/**
+ * Composes each transform in the left array with the one in the right array
+ *
+ * Both arrays are stored as in {@link #affine2_each}.  Composition follows
+ * {@link Affine2#multiply}, with the right transform applied second.  The
+ * result is stored in the left array.  If right is only a single transform,
+ * set stride to 0 and store each coefficient array as a single value.
+ *
+ * @param left      The six coefficient arrays of the left transforms
+ * @param right     The six coefficient arrays of the right transforms
+ * @param stride    The step between right transforms (0 or 1)
+ * @param count     The number of transforms
+ */
+static inline void affine2_compose(float* const* left, const float* const* right, size_t stride, size_t count) {
+    size_t ii = 0;
+    if (stride) {
+        for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+            batch_t la = batch_load(left[0]+ii), lb = batch_load(left[1]+ii), lt = batch_load(left[2]+ii);
+            batch_t lc = batch_load(left[3]+ii), ld = batch_load(left[4]+ii), lu = batch_load(left[5]+ii);
+            batch_t ra = batch_load(right[0]+ii), rb = batch_load(right[1]+ii), rt = batch_load(right[2]+ii);
+            batch_t rc = batch_load(right[3]+ii), rd = batch_load(right[4]+ii), ru = batch_load(right[5]+ii);
+            batch_store(left[0]+ii,batch_add(batch_mul(ra,la),batch_mul(rc,lb)));
+            batch_store(left[1]+ii,batch_add(batch_mul(rb,la),batch_mul(rd,lb)));
+            batch_store(left[3]+ii,batch_add(batch_mul(ra,lc),batch_mul(rc,ld)));
+            batch_store(left[4]+ii,batch_add(batch_mul(rb,lc),batch_mul(rd,ld)));
+            batch_store(left[2]+ii,batch_add(batch_add(batch_mul(lt,ra),batch_mul(lu,rb)),rt));
+            batch_store(left[5]+ii,batch_add(batch_add(batch_mul(lt,rc),batch_mul(lu,rd)),ru));
+        }
+    } else {
+        batch_t ra = batch_set(right[0][0]), rb = batch_set(right[1][0]), rt = batch_set(right[2][0]);
+        batch_t rc = batch_set(right[3][0]), rd = batch_set(right[4][0]), ru = batch_set(right[5][0]);
+        for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+            batch_t la = batch_load(left[0]+ii), lb = batch_load(left[1]+ii), lt = batch_load(left[2]+ii);
+            batch_t lc = batch_load(left[3]+ii), ld = batch_load(left[4]+ii), lu = batch_load(left[5]+ii);
+            batch_store(left[0]+ii,batch_add(batch_mul(ra,la),batch_mul(rc,lb)));
+            batch_store(left[1]+ii,batch_add(batch_mul(rb,la),batch_mul(rd,lb)));
+            batch_store(left[3]+ii,batch_add(batch_mul(ra,lc),batch_mul(rc,ld)));
+            batch_store(left[4]+ii,batch_add(batch_mul(rb,lc),batch_mul(rd,ld)));
+            batch_store(left[2]+ii,batch_add(batch_add(batch_mul(lt,ra),batch_mul(lu,rb)),rt));
+            batch_store(left[5]+ii,batch_add(batch_add(batch_mul(lt,rc),batch_mul(lu,rd)),ru));
+        }
+    }
+    for(; ii < count; ii++) {
+        size_t jj = ii*stride;
+        float la = left[0][ii], lb = left[1][ii], lt = left[2][ii];
+        float lc = left[3][ii], ld = left[4][ii], lu = left[5][ii];
+        left[0][ii] = right[0][jj]*la+right[3][jj]*lb;
+        left[1][ii] = right[1][jj]*la+right[4][jj]*lb;
+        left[3][ii] = right[0][jj]*lc+right[3][jj]*ld;
+        left[4][ii] = right[1][jj]*lc+right[4][jj]*ld;
+        left[2][ii] = lt*right[0][jj]+lu*right[1][jj]+right[2][jj];
+        left[5][ii] = lt*right[3][jj]+lu*right[4][jj]+right[5][jj];
+    }
+}
+
+/**
+ * Blends the source colors over the destination colors in place
+ *
+ * This is the standard over operation of {@link Color4f#blend}, with colors
+ * that are not premultiplied.  The four components of each color are stored
+ * in separate arrays.  If the blended alpha is zero, the color is cleared.
+ *
+ * @param dst   The destination color arrays {r, g, b, a}
+ * @param src   The source color arrays {r, g, b, a}
+ * @param count The number of colors
+ */
+static inline void color4_blend(float* const* dst, const float* const* src, size_t count) {
+    size_t ii = 0;
+    batch_t one  = batch_set(1.0f);
+    batch_t zero = batch_set(0.0f);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t sa = batch_load(src[3]+ii);
+        batch_t a1 = batch_mul(batch_load(dst[3]+ii),batch_sub(one,sa));
+        batch_t a2 = batch_add(sa,a1);
+        batch_t valid = batch_gt(a2,zero);
+        batch_t inv = batch_select(valid,batch_div(one,a2),zero);
+        for(int jj = 0; jj < 3; jj++) {
+            batch_t c = batch_add(batch_mul(batch_load(src[jj]+ii),sa),batch_mul(batch_load(dst[jj]+ii),a1));
+            batch_store(dst[jj]+ii,batch_mul(c,inv));
+        }
+        batch_store(dst[3]+ii,a2);
+    }
+    for(; ii < count; ii++) {
+        float sa = src[3][ii];
+        float a1 = dst[3][ii]*(1-sa);
+        float a2 = sa+a1;
+        float inv = a2 > 0 ? 1/a2 : 0;
+        for(int jj = 0; jj < 3; jj++) {
+            dst[jj][ii] = (src[jj][ii]*sa+dst[jj][ii]*a1)*inv;
+        }
+        dst[3][ii] = a2;
+    }
+}
+
+/**
+ * Blends the source colors over the destination colors in place
+ *
+ * This is the standard over operation of {@link Color4f#blendPre}, with
+ * premultiplied colors.  The four components of each color are stored in
+ * separate arrays.
+ *
+ * @param dst   The destination color arrays {r, g, b, a}
+ * @param src   The source color arrays {r, g, b, a}
+ * @param count The number of colors
+ */
+static inline void color4_blend_pre(float* const* dst, const float* const* src, size_t count) {
+    size_t ii = 0;
+    batch_t one = batch_set(1.0f);
+    for(; ii+CU_MATH_LANES <= count; ii += CU_MATH_LANES) {
+        batch_t factor = batch_sub(one,batch_load(src[3]+ii));
+        for(int jj = 0; jj < 4; jj++) {
+            batch_store(dst[jj]+ii,batch_add(batch_load(src[jj]+ii),batch_mul(batch_load(dst[jj]+ii),factor)));
+        }
+    }
+    for(; ii < count; ii++) {
+        float factor = 1-src[3][ii];
+        for(int jj = 0; jj < 4; jj++) {
+            dst[jj][ii] = src[jj][ii]+dst[jj][ii]*factor;
+        }
+    }
+}
+
+}
+}
+
+#endif /* __CU_MATH_SIMD_H__ */
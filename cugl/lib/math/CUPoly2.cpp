@@ -51,6 +51,12 @@
 #include <iterator>
 #include <cugl/math/CUMat4.h>
 #include <cugl/math/CUAffine2.h>
+#include "CUMathSIMD.h"
+
+/** The number of triangles before contains() uses the containment grid */
+#define GRID_THRESHOLD  16
+/** The maximum number of cells in either dimension of a containment grid */
+#define GRID_MAX_CELLS  1024
 
 using namespace std;
 using namespace cugl;
@@ -132,6 +138,198 @@ public:
 };
 
 
+#pragma mark -
+#pragma mark Containment Grid
+/**
+ * The acceleration structure for containment queries.
+ *
+ * This is a uniform grid over the bounding box of the triangles, with about
+ * one cell per triangle.  Each cell stores the triangles that overlap it in
+ * the block format of simd::triangles_contain.  A triangle appears in every
+ * cell that it overlaps, so a query only needs to test the cell of the point.
+ */
+struct Poly2::TriangleGrid {
+    /** The bottom left corner of the grid */
+    Vec2 origin;
+    /** The top right corner of the grid */
+    Vec2 corner;
+    /** The number of cells in each dimension */
+    int cols, rows;
+    /** The inverse of the cell size in each dimension */
+    Vec2 scale;
+    /** The first block of each cell */
+    std::vector<Uint32> start;
+    /** The number of triangles in each cell */
+    std::vector<Uint32> count;
+    /** The triangle blocks for all of the cells */
+    std::vector<float> blocks;
+    
+    /**
+     * Creates an empty grid that contains no points.
+     */
+    TriangleGrid() : cols(0), rows(0) {}
+    
+    /**
+     * Returns the column of the given x-coordinate, clamped to the grid
+     *
+     * @param x     The x-coordinate
+     *
+     * @return the column of the given x-coordinate, clamped to the grid
+     */
+    int column(float x) const {
+        int result = (int)((x-origin.x)*scale.x);
+        return result < 0 ? 0 : (result >= cols ? cols-1 : result);
+    }
+    
+    /**
+     * Returns the row of the given y-coordinate, clamped to the grid
+     *
+     * @param y     The y-coordinate
+     *
+     * @return the row of the given y-coordinate, clamped to the grid
+     */
+    int row(float y) const {
+        int result = (int)((y-origin.y)*scale.y);
+        return result < 0 ? 0 : (result >= rows ? rows-1 : result);
+    }
+    
+    /**
+     * Builds the grid for the given triangles.
+     *
+     * Degenerate triangles are skipped, as they contain no points.
+     *
+     * @param vertices  The polygon vertices
+     * @param indices   The triangle indices
+     */
+    void build(const std::vector<Vec2>& vertices, const std::vector<Uint32>& indices);
+    
+    /**
+     * Returns true if one of the triangles contains the given point.
+     *
+     * @param point The point to test
+     *
+     * @return true if one of the triangles contains the given point.
+     */
+    bool contains(const Vec2& point) const {
+        if (point.x < origin.x || point.x > corner.x || point.y < origin.y || point.y > corner.y) {
+            return false;
+        }
+        size_t cell = row(point.y)*cols+column(point.x);
+        return simd::triangles_contain(blocks.data()+CU_SIMD_TRIANGLE_BLOCK*start[cell],
+                                       count[cell], point.x, point.y);
+    }
+};
+
+/**
+ * Builds the grid for the given triangles.
+ *
+ * Degenerate triangles are skipped, as they contain no points.
+ *
+ * @param vertices  The polygon vertices
+ * @param indices   The triangle indices
+ */
+void Poly2::TriangleGrid::build(const std::vector<Vec2>& vertices, const std::vector<Uint32>& indices) {
+    std::vector<Uint32> triangles;
+    triangles.reserve(indices.size()/3);
+    for(size_t ii = 0; ii+2 < indices.size(); ii += 3) {
+        const Vec2& a = vertices[indices[ii  ]];
+        const Vec2& b = vertices[indices[ii+1]];
+        const Vec2& c = vertices[indices[ii+2]];
+        if ((b-a).cross(c-a) != 0) {
+            triangles.push_back((Uint32)ii);
+        }
+    }
+    if (triangles.empty()) {
+        return;
+    }
+    
+    origin = vertices[indices[triangles[0]]];
+    corner = origin;
+    for(auto it = triangles.begin(); it != triangles.end(); ++it) {
+        for(int jj = 0; jj < 3; jj++) {
+            const Vec2& v = vertices[indices[*it+jj]];
+            origin.x = std::min(origin.x,v.x);
+            origin.y = std::min(origin.y,v.y);
+            corner.x = std::max(corner.x,v.x);
+            corner.y = std::max(corner.y,v.y);
+        }
+    }
+    
+    // Aim for one cell per triangle, with cells as square as possible
+    Vec2 size = corner-origin;
+    float cells = (float)triangles.size();
+    float width = std::sqrt(cells*size.x/size.y);
+    cols = (int)std::min(std::max(width+0.5f,1.0f),(float)GRID_MAX_CELLS);
+    rows = (int)std::min(std::max(cells/cols+0.5f,1.0f),(float)GRID_MAX_CELLS);
+    scale.set(cols/size.x,rows/size.y);
+    
+    // Find the cells that overlap each triangle
+    Vec2 cellsize(size.x/cols,size.y/rows);
+    Vec2 margin = cellsize*0.001f;
+    std::vector<std::pair<Uint32,Uint32>> overlaps;
+    overlaps.reserve(2*triangles.size());
+    for(auto it = triangles.begin(); it != triangles.end(); ++it) {
+        Vec2 tri[3];
+        tri[0] = vertices[indices[*it  ]];
+        tri[1] = vertices[indices[*it+1]];
+        tri[2] = vertices[indices[*it+2]];
+        if ((tri[1]-tri[0]).cross(tri[2]-tri[0]) < 0) {
+            std::swap(tri[1],tri[2]);
+        }
+        
+        int x0 = column(std::min(tri[0].x,std::min(tri[1].x,tri[2].x)));
+        int x1 = column(std::max(tri[0].x,std::max(tri[1].x,tri[2].x)));
+        int y0 = row(std::min(tri[0].y,std::min(tri[1].y,tri[2].y)));
+        int y1 = row(std::max(tri[0].y,std::max(tri[1].y,tri[2].y)));
+        for(int yy = y0; yy <= y1; yy++) {
+            for(int xx = x0; xx <= x1; xx++) {
+                // The cell is outside if it is to the right of any edge
+                Vec2 lo(origin.x+xx*cellsize.x-margin.x,origin.y+yy*cellsize.y-margin.y);
+                Vec2 hi = lo+cellsize+margin*2;
+                bool outside = false;
+                for(int jj = 0; !outside && jj < 3; jj++) {
+                    const Vec2& p = tri[jj];
+                    Vec2 edge = tri[(jj+1) % 3]-p;
+                    Vec2 far(edge.y > 0 ? lo.x : hi.x, edge.x > 0 ? hi.y : lo.y);
+                    outside = edge.cross(far-p) < 0;
+                }
+                if (!outside) {
+                    overlaps.push_back(std::make_pair((Uint32)(yy*cols+xx),*it));
+                }
+            }
+        }
+    }
+    
+    // Pack the triangles of each cell into blocks of four
+    size_t total = (size_t)cols*rows;
+    count.assign(total,0);
+    start.assign(total,0);
+    for(auto it = overlaps.begin(); it != overlaps.end(); ++it) {
+        count[it->first]++;
+    }
+    Uint32 nblocks = 0;
+    for(size_t ii = 0; ii < total; ii++) {
+        start[ii] = nblocks;
+        nblocks += (count[ii]+3)/4;
+    }
+    
+    blocks.assign((size_t)nblocks*CU_SIMD_TRIANGLE_BLOCK,0.0f);
+    std::vector<Uint32> fill(total,0);
+    for(auto it = overlaps.begin(); it != overlaps.end(); ++it) {
+        Uint32 slot = fill[it->first]++;
+        float* lane = blocks.data()+CU_SIMD_TRIANGLE_BLOCK*(start[it->first]+slot/4)+(slot % 4);
+        for(int jj = 0; jj < 3; jj++) {
+            const Vec2& p = vertices[indices[it->second+jj]];
+            const Vec2& q = vertices[indices[it->second+(jj+1) % 3]];
+            lane[16*jj   ] = p.x;
+            lane[16*jj+ 4] = p.y;
+            lane[16*jj+ 8] = q.x-p.x;
+            lane[16*jj+12] = q.y-p.y;
+        }
+    }
+}
+
+
 #pragma mark -
 #pragma mark Static Constructors
 
@@ -418,7 +616,7 @@ Poly2& Poly2::set(const vector<Vec2>& vertices) {
  *
  * @return This polygon, returned for chaining
  */
-Poly2& Poly2::set(const vector<Vec2>& vertices, const vector<unsigned short>& indices) {
+Poly2& Poly2::set(const vector<Vec2>& vertices, const vector<Uint32>& indices) {
     _vertices.assign(vertices.begin(),vertices.end());
     _indices.assign(indices.begin(),indices.end());
     computeType();
@@ -473,7 +671,7 @@ Poly2& Poly2::set(const vector<float>& vertices) {
  *
  * @return This polygon, returned for chaining
  */
-Poly2& Poly2::set(const vector<float>& vertices, const vector<unsigned short>& indices) {
+Poly2& Poly2::set(const vector<float>& vertices, const vector<Uint32>& indices) {
     vector<Vec2>* ref = (vector<Vec2>*)&vertices;
     _vertices.assign(ref->begin(),ref->end());
     _indices.assign(indices.begin(),indices.end());
@@ -526,7 +724,7 @@ Poly2& Poly2::set(Vec2* vertices, int vertsize, int voffset) {
  *
  * @return This polygon, returned for chaining
  */
-Poly2& Poly2::set(Vec2* vertices, int vertsize, unsigned short* indices, int indxsize,
+Poly2& Poly2::set(Vec2* vertices, int vertsize, Uint32* indices, int indxsize,
                   int voffset, int ioffset) {
     _vertices.assign(vertices+voffset,vertices+voffset+vertsize);
     _indices.assign(indices+ioffset, indices+ioffset+indxsize);
@@ -548,6 +746,7 @@ Poly2& Poly2::set(const Poly2& poly) {
     _indices.assign(poly._indices.begin(),poly._indices.end());
     _bounds = poly._bounds;
     _type = poly._type;
+    _grid = poly._grid;
     return *this;
 }
 
@@ -598,6 +797,7 @@ Poly2& Poly2::set(const Rect& rect, bool solid) {
         _type = Type::PATH;
     }
     _bounds = rect;
+    _grid = nullptr;
     return *this;
 }
 
@@ -621,9 +821,10 @@ Poly2& Poly2::set(const Rect& rect, bool solid) {
  *
  * @return This polygon, returned for chaining
  */
-Poly2& Poly2::setIndices(const vector<unsigned short>& indices) {
+Poly2& Poly2::setIndices(const vector<Uint32>& indices) {
     _indices.assign(indices.begin(), indices.end());
     computeType();
+    _grid = nullptr;
     return *this;
 }
 
@@ -649,9 +850,10 @@ Poly2& Poly2::setIndices(const vector<unsigned short>& indices) {
  *
  * @return This polygon, returned for chaining
  */
-Poly2& Poly2::setIndices(unsigned short* indices, int indxsize, int ioffset) {
+Poly2& Poly2::setIndices(Uint32* indices, int indxsize, int ioffset) {
     _indices.assign(indices+ioffset, indices+ioffset+indxsize);
     computeType();
+    _grid = nullptr;
     return *this;
 }
 
@@ -774,11 +976,7 @@ Poly2& Poly2::operator*=(const Vec2& scale) {
  * @return This polygon with the vertices transformed
  */
 Poly2& Poly2::operator*=(const Affine2& transform) {
-    Vec2 tmp;
-    for(int ii = 0; ii < _vertices.size(); ii++) {
-        Affine2::transform(transform,_vertices[ii], &tmp);
-        _vertices[ii] = tmp;
-    }
+    Affine2::transform(transform,_vertices.data(),_vertices.data(),_vertices.size());
     
     computeBounds();
     return *this;
@@ -794,11 +992,7 @@ Poly2& Poly2::operator*=(const Affine2& transform) {
  * @return This polygon with the vertices transformed
  */
 Poly2& Poly2::operator*=(const Mat4& transform) {
-    Vec2 tmp;
-    for(int ii = 0; ii < _vertices.size(); ii++) {
-        Mat4::transform(transform,_vertices[ii], &tmp);
-        _vertices[ii] = tmp;
-    }
+    Mat4::transform(transform,_vertices.data(),_vertices.data(),_vertices.size());
     
     computeBounds();
     return *this;
@@ -1010,6 +1204,11 @@ std::vector<Vec2> Poly2::convexHull() const {
  * it checks for containment within the associated triangles.  It includes
  * points on the polygon border.
  *
+ * If the polygon has many triangles, this method builds a containment grid
+ * the first time that it is called.  Later queries only test the triangles
+ * in the cell of the point.  Because the grid is built on demand, the first
+ * query is not thread safe, even though this method is const.
+ *
  * @param  point    The point to test
  *
  * @return true if this polygon contains the given point.
@@ -1017,6 +1216,8 @@ std::vector<Vec2> Poly2::convexHull() const {
 bool Poly2::contains(const Vec2& point) const {
     if (_type != Type::SOLID) {
         return false;
+    } else if (_grid != nullptr || _indices.size() >= 3*GRID_THRESHOLD) {
+        return getGrid()->contains(point);
     }
     bool inside = false;
     for(int ii = 0; !inside && 3*ii < _indices.size(); ii++) {
@@ -1026,6 +1227,36 @@ bool Poly2::contains(const Vec2& point) const {
     return inside;
 }
 
+/**
+ * Tests each of the given points for containment in this polygon.
+ *
+ * This method is the same as calling {@link contains} on each point, and
+ * storing the result in the corresponding position of results.  However,
+ * it always uses the containment grid, building it if necessary.  Hence it
+ * is the preferred way to test many points at once.  As with the single
+ * point version, the first query is not thread safe.
+ *
+ * @param  points   The points to test
+ * @param  results  The array to store the results
+ * @param  count    The number of points to test
+ *
+ * @return the number of points contained in this polygon.
+ */
+size_t Poly2::contains(const Vec2* points, bool* results, size_t count) const {
+    if (_type != Type::SOLID) {
+        std::fill(results, results+count, false);
+        return 0;
+    }
+    
+    const TriangleGrid* grid = getGrid();
+    size_t total = 0;
+    for(size_t ii = 0; ii < count; ii++) {
+        results[ii] = grid->contains(points[ii]);
+        total += results[ii] ? 1 : 0;
+    }
+    return total;
+}
+
 /**
  * Returns true if the given point is on the boundary of this polygon.
  *
@@ -1074,9 +1305,11 @@ bool Poly2::incident(const Vec2& point, float variance) const {
  * Compute the bounding box for this polygon.
  *
  * The bounding box is the minimal rectangle that contains all of the vertices in
- * this polygon.  It is recomputed whenever the vertices are set.
+ * this polygon.  It is recomputed whenever the vertices are set.  As this
+ * means the vertices have changed, it also discards any containment grid.
  */
 void Poly2::computeBounds() {
+    _grid = nullptr;
     float minx, maxx;
     float miny, maxy;
     
@@ -1133,7 +1366,7 @@ void Poly2::computeType() {
  *
  * This method is not defined if the polygon is not SOLID.
  */
-Vec3 Poly2::getBarycentric(const Vec2& point, unsigned short index) const {
+Vec3 Poly2::getBarycentric(const Vec2& point, Uint32 index) const {
     Vec2 a = _vertices[_indices[3*index  ]];
     Vec2 b = _vertices[_indices[3*index+1]];
     Vec2 c = _vertices[_indices[3*index+2]];
@@ -1147,3 +1380,19 @@ Vec3 Poly2::getBarycentric(const Vec2& point, unsigned short index) const {
     result.z = 1 - result.x - result.y;
     return result;
 }
+
+/**
+ * Returns the containment grid for this polygon, building it if necessary.
+ *
+ * This method is not defined if the polygon is not SOLID.
+ *
+ * @return the containment grid for this polygon
+ */
+const Poly2::TriangleGrid* Poly2::getGrid() const {
+    if (_grid == nullptr) {
+        std::shared_ptr<TriangleGrid> grid = std::make_shared<TriangleGrid>();
+        grid->build(_vertices,_indices);
+        _grid = grid;
+    }
+    return _grid.get();
+}
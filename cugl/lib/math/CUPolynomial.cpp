@@ -33,6 +33,7 @@
 //  Version: 6/20/16
 
 #include <cugl/math/CUPolynomial.h>
+#include <cugl/math/CUSmallPolynomial.h>
 #include <algorithm>
 #include <functional>
 #include <sstream>
@@ -129,7 +130,70 @@ float Polynomial::normalize() {
 }
 
 /**
- * Computes the roots of this polynomial using Bairstow's method
+ * Computes the roots of this polynomial
+ *
+ * Polynomials of degree at most four are solved exactly using the
+ * closed-form solutions in {@link SmallPolynomial}. Higher degree
+ * polynomials are factored with Bairstow's method until the remaining
+ * factor has degree four, which is then solved exactly.  The value
+ * epsilon is the error tolerance for Bairstow's method.
+ *
+ * The roots are stored in the provided vector.  When complete, the vector
+ * will have degree many elements.  If any root is complex, this method will
+ * have added NaN in its place.
+ *
+ * It is possible for Bairstow's method to fail, which is why this method
+ * has a return value.  This method always succeeds for polynomials of
+ * degree at most four.
+ *
+ * @param  roots    the vector to store the root values
+ * @param  epsilon  the error tolerance for the root values
+ *
+ * @return true if the root finding completes successfully
+ */
+bool Polynomial::roots(vector<float>& roots, float epsilon) const {
+    Polynomial result1(*this);
+    Polynomial quad(2);
+    Polynomial result2;
+    
+    // Remove the x's
+    while (result1.size() > 1 && result1.back() == 0) {
+        roots.push_back(0.0f);
+        result1.pop_back();
+    }
+    
+    long degree = result1.degree();
+    
+    int attempts = 0;
+    while (degree > CU_SMALL_POLY_DEGREE && attempts <= MAX_ATTEMPTS) {
+        float a = (float)rand()/RAND_MAX;
+        float b = (float)rand()/RAND_MAX;
+        quad[1] = -a-b;
+        quad[2] = a*b;
+        if (result1.bairstow_factor(quad,result2,epsilon)) {
+            quad.solve_quadratic(roots);
+            degree -= 2; attempts = 0;
+            result1 = result2;
+        } else {
+            attempts++;
+        }
+    }
+    
+    if (attempts > MAX_ATTEMPTS) {
+        return false;
+    }
+    
+    if (degree > 0) {
+        float values[CU_SMALL_POLY_DEGREE];
+        int amt = SmallPolynomial(result1.data(),(int)degree).roots(values);
+        roots.insert(roots.end(), values, values+amt);
+        roots.insert(roots.end(), degree-amt, nanf(""));
+    }
+    return true;
+}
+
+/**
+ * Computes the roots of this polynomial using only Bairstow's method
  *
  * Bairstow's method is an approximate root finding technique.  The value
  * epsilon is the error value for all of the roots.  A good description
@@ -137,6 +201,10 @@ float Polynomial::normalize() {
  *
  *    http://nptel.ac.in/courses/122104019/numerical-analysis/Rathish-kumar/ratish-1/f3node9.html
  *
+ * Unlike {@link #roots}, this method does not use the closed-form
+ * solutions for small degree.  It is slower and less accurate, and is
+ * provided for comparison purposes.
+ *
  * The roots are stored in the provided vector.  When complete, the vector
  * will have degree many elements.  If any root is complex, this method will
  * have added NaN in its place.
@@ -149,13 +217,13 @@ float Polynomial::normalize() {
  *
  * @return true if Bairstow's method completes successfully
  */
-bool Polynomial::roots(vector<float>& roots, float epsilon) const {
+bool Polynomial::bairstowRoots(vector<float>& roots, float epsilon) const {
     Polynomial result1(*this);
     Polynomial quad(2);
     Polynomial result2;
     
     // Remove the x's
-    while (result1.back() == 0) {
+    while (result1.size() > 1 && result1.back() == 0) {
         roots.push_back(0.0f);
         result1.pop_back();
     }
@@ -0,0 +1,478 @@
+//
+//  CUSmallPolynomial.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a fixed-capacity polynomial of degree at most four.
+//  Unlike Polynomial, this class never allocates memory, and it finds its
+//  roots with closed-form solvers instead of iteration.  It is designed for
+//  the inner loops of curve math, such as bezier easing and intersection,
+//  where the polynomials are small and there are a lot of them.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+
+#include <cugl/math/CUSmallPolynomial.h>
+#include <cugl/math/CUPolynomial.h>
+#include <cmath>
+#include <algorithm>
+
+/** Relative tolerance for treating a discriminant as zero */
+#define DISC_EPSILON    1e-12
+/** Relative tolerance for treating a complex pair as a double root */
+#define PAIR_EPSILON    1e-6
+/** The number of Newton steps used to polish a root */
+#define POLISH_STEPS    2
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Solver Helpers
+/**
+ * Sorts the given roots in ascending order.
+ *
+ * As there are at most four roots, this is an insertion sort.
+ *
+ * @param roots The roots to sort
+ * @param size  The number of roots
+ */
+static void sort_roots(double* roots, int size) {
+    for(int ii = 1; ii < size; ii++) {
+        double value = roots[ii];
+        int jj = ii-1;
+        while (jj >= 0 && roots[jj] > value) {
+            roots[jj+1] = roots[jj];
+            jj--;
+        }
+        roots[jj+1] = value;
+    }
+}
+
+/**
+ * Returns the root after polishing it with Newton's method
+ *
+ * The closed-form solutions can lose precision through cancellation.  A
+ * step or two of Newton's method (in double precision) recovers it.  A
+ * step is only accepted if it reduces the residual, so this is safe to
+ * apply to repeated roots, where the derivative vanishes.
+ *
+ * @param coeffs    The polynomial coefficients, from highest degree
+ * @param degree    The polynomial degree
+ * @param x         The root to polish
+ *
+ * @return the root after polishing it with Newton's method
+ */
+static double polish_root(const double* coeffs, int degree, double x) {
+    for(int step = 0; step < POLISH_STEPS; step++) {
+        double value = coeffs[0];
+        double slope = 0;
+        for(int ii = 1; ii <= degree; ii++) {
+            slope = slope*x+value;
+            value = value*x+coeffs[ii];
+        }
+        if (value == 0 || slope == 0) {
+            return x;
+        }
+        double next = x-value/slope;
+        double check = coeffs[0];
+        for(int ii = 1; ii <= degree; ii++) {
+            check = check*next+coeffs[ii];
+        }
+        if (std::fabs(check) >= std::fabs(value)) {
+            return x;
+        }
+        x = next;
+    }
+    return x;
+}
+
+/**
+ * Computes the real roots of the monic quadratic x^2 + bx + c.
+ *
+ * This uses the numerically stable form of the quadratic formula, which
+ * avoids cancellation between -b and the square root of the discriminant.
+ *
+ * @param b     The linear coefficient
+ * @param c     The constant coefficient
+ * @param roots The array to store the roots
+ *
+ * @return the number of real roots found
+ */
+static int monic_quadratic(double b, double c, double* roots) {
+    double disc = b*b-4*c;
+    if (disc < 0) {
+        if (disc < -DISC_EPSILON*std::max(b*b,std::fabs(c))) {
+            return 0;
+        }
+        disc = 0;
+    }
+    double q = -0.5*(b+std::copysign(std::sqrt(disc),b));
+    if (q == 0) {
+        roots[0] = roots[1] = 0;
+    } else {
+        roots[0] = q;
+        roots[1] = c/q;
+    }
+    return 2;
+}
+
+/**
+ * Computes the real roots of the monic cubic x^3 + ax^2 + bx + c.
+ *
+ * This uses the trigonometric form when there are three real roots, and
+ * Cardano's formula otherwise.
+ *
+ * @param a     The quadratic coefficient
+ * @param b     The linear coefficient
+ * @param c     The constant coefficient
+ * @param roots The array to store the roots
+ *
+ * @return the number of real roots found
+ */
+static int monic_cubic(double a, double b, double c, double* roots) {
+    if (c == 0) {
+        int size = monic_quadratic(a, b, roots);
+        roots[size] = 0;
+        return size+1;
+    }
+
+    double q = (a*a-3*b)/9;
+    double r = (a*(2*a*a-9*b)+27*c)/54;
+    double shift = a/3;
+    double r2 = r*r;
+    double q3 = q*q*q;
+    if (r2 < q3) {
+        double theta = std::acos(r/std::sqrt(q3));
+        double scale = -2*std::sqrt(q);
+        roots[0] = scale*std::cos(theta/3)-shift;
+        roots[1] = scale*std::cos((theta+2*M_PI)/3)-shift;
+        roots[2] = scale*std::cos((theta-2*M_PI)/3)-shift;
+        return 3;
+    }
+
+    double u = -std::copysign(std::cbrt(std::fabs(r)+std::sqrt(r2-q3)),r);
+    double v = (u == 0 ? 0 : q/u);
+    roots[0] = u+v-shift;
+
+    // The imaginary part of the other roots is proportional to u-v
+    if (std::fabs(u-v) <= PAIR_EPSILON*std::max(std::fabs(u),std::fabs(v))) {
+        roots[1] = roots[2] = -0.5*(u+v)-shift;
+        return 3;
+    }
+    return 1;
+}
+
+/**
+ * Computes the real roots of the monic quartic x^4 + ax^3 + bx^2 + cx + d.
+ *
+ * This uses Ferrari's method, which reduces the quartic to the product of
+ * two quadratics using a root of the resolvent cubic.
+ *
+ * @param a     The cubic coefficient
+ * @param b     The quadratic coefficient
+ * @param c     The linear coefficient
+ * @param d     The constant coefficient
+ * @param roots The array to store the roots
+ *
+ * @return the number of real roots found
+ */
+static int monic_quartic(double a, double b, double c, double d, double* roots) {
+    if (d == 0) {
+        int size = monic_cubic(a, b, c, roots);
+        roots[size] = 0;
+        return size+1;
+    }
+
+    // Depress the quartic with x = y-a/4
+    double a2 = a*a;
+    double p = b-3*a2/8;
+    double q = c-a*b/2+a2*a/8;
+    double r = d-a*c/4+a2*b/16-3*a2*a2/256;
+    double shift = a/4;
+
+    double temp[4];
+    int size = 0;
+    double scale = std::max(1.0,std::max(std::fabs(p),std::fabs(r)));
+    double m = 0;
+    if (std::fabs(q) > DISC_EPSILON*scale) {
+        // Largest root of the resolvent cubic
+        int amt = monic_cubic(p, p*p/4-r, -q*q/8, temp);
+        m = temp[0];
+        for(int ii = 1; ii < amt; ii++) {
+            m = std::max(m,temp[ii]);
+        }
+    }
+
+    if (m <= 0) {
+        // Biquadratic y^4 + py^2 + r
+        int amt = monic_quadratic(p, r, temp);
+        for(int ii = 0; ii < amt; ii++) {
+            double z = temp[ii];
+            if (z >= 0) {
+                double y = std::sqrt(z);
+                roots[size++] =  y-shift;
+                roots[size++] = -y-shift;
+            } else if (z > -DISC_EPSILON*scale) {
+                roots[size++] = -shift;
+                roots[size++] = -shift;
+            }
+        }
+        return size;
+    }
+
+    double s = std::sqrt(2*m);
+    double t = q/(2*s);
+    size  = monic_quadratic( s, p/2+m-t, roots);
+    size += monic_quadratic(-s, p/2+m+t, roots+size);
+    for(int ii = 0; ii < size; ii++) {
+        roots[ii] -= shift;
+    }
+    return size;
+}
+
+/**
+ * Computes the real roots of the given polynomial of degree at most four.
+ *
+ * Leading zero coefficients are ignored.  The roots are polished, sorted
+ * and then stored as floats.
+ *
+ * @param coeffs    The polynomial coefficients, from highest degree
+ * @param degree    The polynomial degree
+ * @param roots     The array to store the roots
+ *
+ * @return the number of real roots found
+ */
+static int solve_small(const float* coeffs, int degree, float* roots) {
+    int offset = 0;
+    while (offset < degree && coeffs[offset] == 0) {
+        offset++;
+    }
+    degree -= offset;
+    coeffs += offset;
+    if (degree == 0) {
+        return 0;
+    }
+
+    double monic[CU_SMALL_POLY_DEGREE+1];
+    monic[0] = 1;
+    for(int ii = 1; ii <= degree; ii++) {
+        monic[ii] = (double)coeffs[ii]/coeffs[0];
+    }
+
+    double result[CU_SMALL_POLY_DEGREE];
+    int size = 0;
+    switch (degree) {
+        case 1:
+            result[0] = -monic[1];
+            size = 1;
+            break;
+        case 2:
+            size = monic_quadratic(monic[1], monic[2], result);
+            break;
+        case 3:
+            size = monic_cubic(monic[1], monic[2], monic[3], result);
+            break;
+        case 4:
+            size = monic_quartic(monic[1], monic[2], monic[3], monic[4], result);
+            break;
+    }
+
+    for(int ii = 0; ii < size; ii++) {
+        result[ii] = polish_root(monic, degree, result[ii]);
+    }
+    sort_roots(result, size);
+    for(int ii = 0; ii < size; ii++) {
+        roots[ii] = (float)result[ii];
+    }
+    return size;
+}
+
+
+#pragma mark -
+#pragma mark Setters
+/**
+ * Sets the coefficients of this polynomial.
+ *
+ * The coefficients are specified from highest degree to constant, and
+ * there must be degree+1 of them.  The degree may not exceed four.
+ *
+ * @param coeffs    The polynomial coefficients
+ * @param degree    The polynomial degree
+ *
+ * @return this polynomial, after modification.
+ */
+SmallPolynomial& SmallPolynomial::set(const float* coeffs, int degree) {
+    CUAssertLog(degree >= 0 && degree <= CU_SMALL_POLY_DEGREE, "Degree %d is out of range", degree);
+    _degree = degree;
+    std::copy(coeffs, coeffs+degree+1, _coeffs);
+    return *this;
+}
+
+/**
+ * Sets this polynomial to be a copy of the given one.
+ *
+ * The polynomial must have degree at most four.
+ *
+ * @param poly      The polynomial to copy
+ *
+ * @return this polynomial, after modification.
+ */
+SmallPolynomial& SmallPolynomial::set(const Polynomial& poly) {
+    return set(poly.data(), (int)poly.degree());
+}
+
+
+#pragma mark -
+#pragma mark Calculation Methods
+/**
+ * Returns the derivative of this polynomial
+ *
+ * The derivative has degree one less than original, unless it the
+ * original has degree 0.  In that case, the derivative is 0.
+ *
+ * @return the derivative of this polynomial
+ */
+SmallPolynomial SmallPolynomial::derivative() const {
+    SmallPolynomial result;
+    if (_degree == 0) {
+        return result;
+    }
+    result._degree = _degree-1;
+    for(int ii = 0; ii < _degree; ii++) {
+        result._coeffs[ii] = _coeffs[ii]*(_degree-ii);
+    }
+    return result;
+}
+
+/**
+ * Computes the real roots of this polynomial.
+ *
+ * The roots are stored in ascending order in the given array, which must
+ * have room for degree() elements.  Repeated roots are stored once for
+ * each multiplicity.  Leading zero coefficients are ignored, and the zero
+ * polynomial has no roots.
+ *
+ * @param roots The array to store the roots
+ *
+ * @return the number of real roots found
+ */
+int SmallPolynomial::roots(float* roots) const {
+    return solve_small(_coeffs, _degree, roots);
+}
+
+/**
+ * Returns a Polynomial equivalent to this one.
+ *
+ * @return a Polynomial equivalent to this one.
+ */
+SmallPolynomial::operator Polynomial() const {
+    Polynomial result(_degree);
+    std::copy(_coeffs, _coeffs+_degree+1, result.begin());
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Static Solvers
+/**
+ * Computes the real roots of the polynomial ax^2 + bx + c.
+ *
+ * The roots are stored in ascending order in the given array, which must
+ * have room for two elements.  A double root is stored twice.  If a is
+ * zero, this solves the linear equation instead.
+ *
+ * @param a     The quadratic coefficient
+ * @param b     The linear coefficient
+ * @param c     The constant coefficient
+ * @param roots The array to store the roots
+ *
+ * @return the number of real roots found
+ */
+int SmallPolynomial::solveQuadratic(float a, float b, float c, float* roots) {
+    float coeffs[3] = { a, b, c };
+    return solve_small(coeffs, 2, roots);
+}
+
+/**
+ * Computes the real roots of the polynomial ax^3 + bx^2 + cx + d.
+ *
+ * The roots are stored in ascending order in the given array, which must
+ * have room for three elements.  Repeated roots are stored once for each
+ * multiplicity.  If a is zero, this solves the quadratic instead.
+ *
+ * @param a     The cubic coefficient
+ * @param b     The quadratic coefficient
+ * @param c     The linear coefficient
+ * @param d     The constant coefficient
+ * @param roots The array to store the roots
+ *
+ * @return the number of real roots found
+ */
+int SmallPolynomial::solveCubic(float a, float b, float c, float d, float* roots) {
+    float coeffs[4] = { a, b, c, d };
+    return solve_small(coeffs, 3, roots);
+}
+
+/**
+ * Computes the real roots of the polynomial ax^4 + bx^3 + cx^2 + dx + e.
+ *
+ * The roots are stored in ascending order in the given array, which must
+ * have room for four elements.  Repeated roots are stored once for each
+ * multiplicity.  If a is zero, this solves the cubic instead.
+ *
+ * @param a     The quartic coefficient
+ * @param b     The cubic coefficient
+ * @param c     The quadratic coefficient
+ * @param d     The linear coefficient
+ * @param e     The constant coefficient
+ * @param roots The array to store the roots
+ *
+ * @return the number of real roots found
+ */
+int SmallPolynomial::solveQuartic(float a, float b, float c, float d, float e, float* roots) {
+    float coeffs[5] = { a, b, c, d, e };
+    return solve_small(coeffs, 4, roots);
+}
+
+/**
+ * Computes the real roots of many cubics at once.
+ *
+ * The array coeffs stores the cubics as consecutive groups of four
+ * coefficients, each from highest degree to constant.  The roots of
+ * cubic i are stored (in ascending order) at positions 3i to 3i+2 of
+ * the array roots, and the number of roots is stored in sizes[i].
+ *
+ * This method is designed for solving easing curves and intersections
+ * in bulk.  The cubics are solved in a single pass with no allocation.
+ *
+ * @param coeffs    The cubic coefficients (4*count elements)
+ * @param count     The number of cubics
+ * @param roots     The array to store the roots (3*count elements)
+ * @param sizes     The array to store the number of roots (count elements)
+ */
+void SmallPolynomial::solveCubics(const float* coeffs, size_t count, float* roots, int* sizes) {
+    for(size_t ii = 0; ii < count; ii++) {
+        sizes[ii] = solve_small(coeffs+4*ii, 3, roots+3*ii);
+    }
+}
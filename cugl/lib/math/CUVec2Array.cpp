@@ -0,0 +1,498 @@
+//
+//  CUVec2Array.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an array of 2d vectors in structure-of-arrays form.
+//  The x and y coordinates are stored in separate aligned arrays, so that
+//  operations on the entire array (such as integrating positions in a
+//  particle system) can be processed several vectors at a time.
+//
+//  An array may either own its storage or be a view of arrays owned by
+//  someone else.  The latter allows an application that already keeps its
+//  data in structure-of-arrays form to use these operations with no copies.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#include <cugl/math/CUVec2Array.h>
+#include <cugl/math/CUAffineArray.h>
+#include <cugl/math/CUAffine2.h>
+#include <cstring>
+#include "CUMathSIMD.h"
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Creates a vector array of the given size.
+ *
+ * All of the vectors are initialized to zero.
+ *
+ * @param size  The number of vectors
+ */
+Vec2Array::Vec2Array(size_t size) :
+_raw(nullptr), _x(nullptr), _y(nullptr), _size(0), _capacity(0) {
+    resize(size);
+}
+
+/**
+ * Creates a vector array with a copy of the given vectors.
+ *
+ * @param vecs  The vectors to copy
+ * @param size  The number of vectors
+ */
+Vec2Array::Vec2Array(const Vec2* vecs, size_t size) :
+_raw(nullptr), _x(nullptr), _y(nullptr), _size(0), _capacity(0) {
+    load(vecs,size);
+}
+
+/**
+ * Creates a copy of the given vector array.
+ *
+ * The copy always owns its storage, even if the original is a view.
+ *
+ * @param array The array to copy
+ */
+Vec2Array::Vec2Array(const Vec2Array& array) :
+_raw(nullptr), _x(nullptr), _y(nullptr), _size(0), _capacity(0) {
+    reserve(array._size);
+    _size = array._size;
+    std::memcpy(_x,array._x,_size*sizeof(float));
+    std::memcpy(_y,array._y,_size*sizeof(float));
+}
+
+/**
+ * Creates a vector array with the resources of the original.
+ *
+ * @param array The array to take from
+ */
+Vec2Array::Vec2Array(Vec2Array&& array) :
+_raw(array._raw), _x(array._x), _y(array._y), _size(array._size), _capacity(array._capacity) {
+    array._raw = nullptr;
+    array._x = nullptr;
+    array._y = nullptr;
+    array._size = 0;
+    array._capacity = 0;
+}
+
+/**
+ * Deletes this vector array, releasing all resources.
+ */
+Vec2Array::~Vec2Array() {
+    if (_raw) {
+        free(_raw);
+    }
+}
+
+/**
+ * Sets this array to be a copy of the given one.
+ *
+ * If this array is a view, the array must have the same size, and the
+ * coordinates are copied into the viewed arrays.
+ *
+ * @param array The array to copy
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::operator=(const Vec2Array& array) {
+    if (this == &array) {
+        return *this;
+    }
+    if (!isView()) {
+        resize(array._size);
+    }
+    CUAssertLog(_size == array._size, "View size %zu does not match %zu", _size, array._size);
+    std::memmove(_x,array._x,_size*sizeof(float));
+    std::memmove(_y,array._y,_size*sizeof(float));
+    return *this;
+}
+
+/**
+ * Sets this array to have the resources of the given one.
+ *
+ * @param array The array to take from
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::operator=(Vec2Array&& array) {
+    if (this == &array) {
+        return *this;
+    }
+    if (_raw) {
+        free(_raw);
+    }
+    _raw = array._raw;
+    _x = array._x;
+    _y = array._y;
+    _size = array._size;
+    _capacity = array._capacity;
+    array._raw = nullptr;
+    array._x = nullptr;
+    array._y = nullptr;
+    array._size = 0;
+    array._capacity = 0;
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Storage
+/**
+ * Ensures that this array can store the given number of vectors.
+ *
+ * This method may not be called on a view.
+ *
+ * @param capacity  The number of vectors to reserve
+ */
+void Vec2Array::reserve(size_t capacity) {
+    CUAssertLog(!isView(), "Cannot reallocate a view");
+    if (capacity <= _capacity) {
+        return;
+    }
+    size_t stride = simd::soa_capacity(capacity);
+    void* raw = nullptr;
+    float* data = simd::soa_allocate(2*stride,raw);
+    if (_size) {
+        std::memcpy(data,_x,_size*sizeof(float));
+        std::memcpy(data+stride,_y,_size*sizeof(float));
+    }
+    if (_raw) {
+        free(_raw);
+    }
+    _raw = raw;
+    _x = data;
+    _y = data+stride;
+    _capacity = stride;
+}
+
+/**
+ * Changes the number of vectors in this array.
+ *
+ * Any new vectors are initialized to zero.  This method may not be
+ * called on a view.
+ *
+ * @param size  The new number of vectors
+ */
+void Vec2Array::resize(size_t size) {
+    CUAssertLog(!isView(), "Cannot resize a view");
+    if (size > _capacity) {
+        reserve(size);
+    }
+    if (size > _size) {
+        std::memset(_x+_size,0,(size-_size)*sizeof(float));
+        std::memset(_y+_size,0,(size-_size)*sizeof(float));
+    }
+    _size = size;
+}
+
+/**
+ * Appends a vector to the end of this array.
+ *
+ * This method may not be called on a view.
+ *
+ * @param v     The vector to append
+ */
+void Vec2Array::append(const Vec2& v) {
+    if (_size == _capacity) {
+        reserve(_capacity ? 2*_capacity : 4);
+    }
+    _x[_size] = v.x;
+    _y[_size] = v.y;
+    _size++;
+}
+
+
+#pragma mark -
+#pragma mark Conversion
+/**
+ * Sets this array to a copy of the given interleaved coordinates.
+ *
+ * The stride is the number of floats between consecutive vectors, and
+ * must be at least 2.  This allows the array to load the positions
+ * directly from a vertex buffer.  If this array is a view, the number
+ * of vectors must be the same as the size of the view.  Otherwise, the
+ * array is resized.
+ *
+ * @param data      The interleaved coordinates
+ * @param size      The number of vectors
+ * @param stride    The number of floats between consecutive vectors
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::load(const float* data, size_t size, size_t stride) {
+    CUAssertLog(stride >= 2, "Stride %zu is too small", stride);
+    CUAssertLog(size == 0 || data, "Coordinate array is null");
+    if (!isView()) {
+        resize(size);
+    }
+    CUAssertLog(_size == size, "View size %zu does not match %zu", _size, size);
+    if (stride == 2) {
+        simd::soa_split2(data,_x,_y,size);
+    } else {
+        for(size_t ii = 0; ii < size; ii++) {
+            _x[ii] = data[ii*stride];
+            _y[ii] = data[ii*stride+1];
+        }
+    }
+    return *this;
+}
+
+/**
+ * Stores the vectors of this array as interleaved coordinates.
+ *
+ * The stride is the number of floats between consecutive vectors, and
+ * must be at least 2.  Any floats between vectors are left unchanged,
+ * so this method can write positions directly into a vertex buffer.
+ *
+ * @param data      The buffer to store the coordinates
+ * @param stride    The number of floats between consecutive vectors
+ */
+void Vec2Array::store(float* data, size_t stride) const {
+    CUAssertLog(stride >= 2, "Stride %zu is too small", stride);
+    CUAssertLog(_size == 0 || data, "Coordinate array is null");
+    if (stride == 2) {
+        simd::soa_merge2(_x,_y,data,_size);
+    } else {
+        for(size_t ii = 0; ii < _size; ii++) {
+            data[ii*stride]   = _x[ii];
+            data[ii*stride+1] = _y[ii];
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Arithmetic
+/**
+ * Adds the given array to this one in place.
+ *
+ * @param array The array to add
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::add(const Vec2Array& array) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    simd::soa_add(_x,array._x,_x,_size);
+    simd::soa_add(_y,array._y,_y,_size);
+    return *this;
+}
+
+/**
+ * Adds the given vector to every vector in this array.
+ *
+ * @param v     The vector to add
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::add(const Vec2& v) {
+    simd::soa_scale(_x,1.0f,v.x,_x,_size);
+    simd::soa_scale(_y,1.0f,v.y,_y,_size);
+    return *this;
+}
+
+/**
+ * Subtracts the given array from this one in place.
+ *
+ * @param array The array to subtract
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::subtract(const Vec2Array& array) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    simd::soa_sub(_x,array._x,_x,_size);
+    simd::soa_sub(_y,array._y,_y,_size);
+    return *this;
+}
+
+/**
+ * Scales every vector in this array uniformly.
+ *
+ * @param s     The scalar
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::scale(float s) {
+    simd::soa_scale(_x,s,0.0f,_x,_size);
+    simd::soa_scale(_y,s,0.0f,_y,_size);
+    return *this;
+}
+
+/**
+ * Scales each vector in this array by its own scalar.
+ *
+ * There must be one scalar for each vector in this array.  This is
+ * useful for applying per-particle drag.
+ *
+ * @param s     The scalars
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::scale(const float* s) {
+    CUAssertLog(_size == 0 || s, "Scalar array is null");
+    simd::soa_mul(_x,s,_x,_size);
+    simd::soa_mul(_y,s,_y,_size);
+    return *this;
+}
+
+/**
+ * Adds the given array, scaled by s, to this one in place.
+ *
+ * This is the update step for explicit integration, as in
+ * positions.addScaled(velocities,dt).
+ *
+ * @param array The array to add
+ * @param s     The scalar for the added array
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::addScaled(const Vec2Array& array, float s) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    simd::soa_madd(_x,array._x,s,_x,_size);
+    simd::soa_madd(_y,array._y,s,_y,_size);
+    return *this;
+}
+
+/**
+ * Linearly interpolates this array towards the given one in place.
+ *
+ * If alpha is 0, the array is unchanged.  If alpha is 1, this array is
+ * a copy of the other.
+ *
+ * @param array The array to interpolate towards
+ * @param alpha The interpolation value
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::lerp(const Vec2Array& array, float alpha) {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    // (1-alpha)*this + alpha*other, as two passes that stay in cache
+    simd::soa_scale(_x,1-alpha,0.0f,_x,_size);
+    simd::soa_scale(_y,1-alpha,0.0f,_y,_size);
+    simd::soa_madd(_x,array._x,alpha,_x,_size);
+    simd::soa_madd(_y,array._y,alpha,_y,_size);
+    return *this;
+}
+
+/**
+ * Normalizes every vector in this array.
+ *
+ * As with {@link Vec2#normalize}, a vector with (nearly) zero length
+ * is left unchanged.
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::normalize() {
+    simd::vec2_normalize(_x,_y,_size);
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Queries
+/**
+ * Stores the dot product of each vector with its partner in array.
+ *
+ * The output buffer must have room for {@link #size} values.
+ *
+ * @param array     The array of partner vectors
+ * @param output    The buffer to store the dot products
+ */
+void Vec2Array::dot(const Vec2Array& array, float* output) const {
+    CUAssertLog(_size == array._size, "Array sizes %zu and %zu do not match", _size, array._size);
+    CUAssertLog(_size == 0 || output, "Output array is null");
+    simd::vec2_dot(_x,_y,array._x,array._y,output,_size);
+}
+
+/**
+ * Stores the dot product of each vector with v.
+ *
+ * The output buffer must have room for {@link #size} values.
+ *
+ * @param v         The vector to dot with
+ * @param output    The buffer to store the dot products
+ */
+void Vec2Array::dot(const Vec2& v, float* output) const {
+    CUAssertLog(_size == 0 || output, "Output array is null");
+    simd::vec2_dot(_x,_y,v.x,v.y,output,_size);
+}
+
+/**
+ * Stores the length of each vector.
+ *
+ * The output buffer must have room for {@link #size} values.
+ *
+ * @param output    The buffer to store the lengths
+ */
+void Vec2Array::length(float* output) const {
+    CUAssertLog(_size == 0 || output, "Output array is null");
+    simd::vec2_length(_x,_y,output,_size,false);
+}
+
+/**
+ * Stores the squared length of each vector.
+ *
+ * This method is faster than {@link #length}, and should be preferred
+ * when only comparing lengths.  The output buffer must have room for
+ * {@link #size} values.
+ *
+ * @param output    The buffer to store the squared lengths
+ */
+void Vec2Array::lengthSquared(float* output) const {
+    CUAssertLog(_size == 0 || output, "Output array is null");
+    simd::vec2_length(_x,_y,output,_size,true);
+}
+
+
+#pragma mark -
+#pragma mark Transforms
+/**
+ * Transforms every vector in this array by the given transform.
+ *
+ * The vectors are treated as points, and so are affected by the
+ * translation.
+ *
+ * @param transform The affine transform
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::transform(const Affine2& transform) {
+    Affine2::transform(transform,_x,_y,_x,_y,_size);
+    return *this;
+}
+
+/**
+ * Transforms each vector in this array by its own transform.
+ *
+ * There must be one transform for each vector in this array.  The
+ * vectors are treated as points, and so are affected by the translation.
+ *
+ * @param transforms    The affine transforms
+ *
+ * @return a reference to this array for chaining.
+ */
+Vec2Array& Vec2Array::transform(const AffineArray& transforms) {
+    CUAssertLog(_size == transforms.size(), "Array sizes %zu and %zu do not match", _size, transforms.size());
+    const float* coeff[6];
+    for(int ii = 0; ii < 6; ii++) {
+        coeff[ii] = transforms.component(ii);
+    }
+    simd::affine2_each(coeff,_x,_y,_size);
+    return *this;
+}
@@ -168,4 +168,27 @@ Vec4* Mat4::transform(const Mat4& mat, const Vec4& vec, Vec4* dst) {
     vSgemtx(4,4,1.0f,&(mat.col[0]),&(vec.v),&(tmp.v));
     dst->v = tmp.v;
     return dst;
-}
\ No newline at end of file
+}
+
+/**
+ * Transforms the array of vectors by the given matrix.
+ *
+ * The vectors are treated as is.  Hence whether or not translation is
+ * applied depends on the value of w.  This method is much faster than
+ * transforming each vector individually on vectorized platforms.  The
+ * input and output may be the same array, but they may not otherwise
+ * overlap.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The vectors to transform.
+ * @param output    An array to store the transformed vectors in.
+ * @param count     The number of vectors to transform.
+ *
+ * @return A reference to output for chaining
+ */
+Vec4* Mat4::transform(const Mat4& mat, const Vec4* input, Vec4* output, size_t count) {
+    for(size_t ii = 0; ii < count; ii++) {
+        transform(mat, input[ii], output+ii);
+    }
+    return output;
+}
@@ -301,3 +301,32 @@ Vec4* Mat4::transform(const Mat4& mat, const Vec4& vec, Vec4* dst) {
     dst->w = w;
     return dst;
 }
+
+/**
+ * Transforms the array of vectors by the given matrix.
+ *
+ * The vectors are treated as is.  Hence whether or not translation is
+ * applied depends on the value of w.  This method is much faster than
+ * transforming each vector individually on vectorized platforms.  The
+ * input and output may be the same array, but they may not otherwise
+ * overlap.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The vectors to transform.
+ * @param output    An array to store the transformed vectors in.
+ * @param count     The number of vectors to transform.
+ *
+ * @return A reference to output for chaining
+ */
+Vec4* Mat4::transform(const Mat4& mat, const Vec4* input, Vec4* output, size_t count) {
+    const float* m = mat.m;
+    for(size_t ii = 0; ii < count; ii++) {
+        const Vec4& vec = input[ii];
+        float x = vec.x * m[0] + vec.y * m[4] + vec.z * m[8]  + vec.w * m[12];
+        float y = vec.x * m[1] + vec.y * m[5] + vec.z * m[9]  + vec.w * m[13];
+        float z = vec.x * m[2] + vec.y * m[6] + vec.z * m[10] + vec.w * m[14];
+        float w = vec.x * m[3] + vec.y * m[7] + vec.z * m[11] + vec.w * m[15];
+        output[ii].set(x,y,z,w);
+    }
+    return output;
+}
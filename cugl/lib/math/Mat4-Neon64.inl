@@ -35,6 +35,8 @@
 //  Author: Walker White
 //  Version: 6/12/16
 
+#include <arm_neon.h>
+
 /**
  * Adds a scalar to each component of mat and stores the result in dst.
  *
@@ -300,4 +302,38 @@ Vec4* Mat4::transform(const Mat4& mat, const Vec4& vec, Vec4* dst) {
                  : "v0", "v9", "v10","v11", "v12", "v13", "memory"
                  );
     return dst;
-}
\ No newline at end of file
+}
+
+/**
+ * Transforms the array of vectors by the given matrix.
+ *
+ * The vectors are treated as is.  Hence whether or not translation is
+ * applied depends on the value of w.  This method is much faster than
+ * transforming each vector individually on vectorized platforms.  The
+ * input and output may be the same array, but they may not otherwise
+ * overlap.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The vectors to transform.
+ * @param output    An array to store the transformed vectors in.
+ * @param count     The number of vectors to transform.
+ *
+ * @return A reference to output for chaining
+ */
+Vec4* Mat4::transform(const Mat4& mat, const Vec4* input, Vec4* output, size_t count) {
+    float32x4_t c0 = vld1q_f32(mat.m);
+    float32x4_t c1 = vld1q_f32(mat.m+4);
+    float32x4_t c2 = vld1q_f32(mat.m+8);
+    float32x4_t c3 = vld1q_f32(mat.m+12);
+    const float* src = &(input[0].x);
+    float* dst = &(output[0].x);
+    for(size_t ii = 0; ii < count; ii++) {
+        float32x4_t v = vld1q_f32(src+4*ii);
+        float32x4_t r = vmulq_laneq_f32(c0, v, 0);
+        r = vfmaq_laneq_f32(r, c1, v, 1);
+        r = vfmaq_laneq_f32(r, c2, v, 2);
+        r = vfmaq_laneq_f32(r, c3, v, 3);
+        vst1q_f32(dst+4*ii, r);
+    }
+    return output;
+}
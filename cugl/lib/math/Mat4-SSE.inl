@@ -3,9 +3,14 @@
 //  Cornell University Game Library (CUGL)
 //
 //  This module provides vectorized support for matrix multiplication on SSE
-//  (e.g. Windows) platforms.  Profiling tests show that it is really not that
-//  much slower than non-vectorized computation because of the small size of
-//  the matrix.
+//  (e.g. Windows and x86 Linux) platforms.  Matrices are not guaranteed to
+//  be 16-byte aligned (they may live in a std::vector or in an object made
+//  by std::make_shared), so every load and store is unaligned.  On any x86
+//  processor from the last decade, an unaligned access to aligned data is
+//  no slower than an aligned one.
+//
+//  If AVX is enabled at compile time, matrix multiplication and the array
+//  transforms use 256-bit registers to process two columns at a time.
 //
 //  Because math objects are intended to be on the stack, we do not provide
 //  any shared pointer support in this class.
@@ -35,6 +40,84 @@
 //  Author: Walker White
 //  Version: 6/12/16
 
+#if defined CU_MATH_VECTOR_AVX
+    #include <immintrin.h>
+#else
+    #include <xmmintrin.h>
+#endif
+
+/**
+ * Returns the given column of the matrix as a vector register
+ *
+ * @param mat   The matrix
+ * @param col   The column index
+ *
+ * @return the given column of the matrix as a vector register
+ */
+static inline __m128 mat4_col(const Mat4& mat, int col) {
+    return _mm_loadu_ps(mat.m+4*col);
+}
+
+/**
+ * Returns the product of the columns of m2 with the given column of m1
+ *
+ * This is a single column of the matrix product of m1 and m2.
+ *
+ * @param m2    The matrix on the right
+ * @param col   The column of the matrix on the left
+ *
+ * @return the product of the columns of m2 with the given column of m1
+ */
+static inline __m128 mat4_mult_col(const Mat4& m2, __m128 col) {
+    __m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
+    __m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
+    
+    __m128 v0 = _mm_mul_ps(mat4_col(m2,0), e0);
+    __m128 v1 = _mm_mul_ps(mat4_col(m2,1), e1);
+    __m128 v2 = _mm_mul_ps(mat4_col(m2,2), e2);
+    __m128 v3 = _mm_mul_ps(mat4_col(m2,3), e3);
+    return _mm_add_ps(_mm_add_ps(v0, v1), _mm_add_ps(v2, v3));
+}
+
+#if defined CU_MATH_VECTOR_AVX
+/**
+ * Returns the given column of the matrix in both halves of a register
+ *
+ * @param mat   The matrix
+ * @param col   The column index
+ *
+ * @return the given column of the matrix in both halves of a register
+ */
+static inline __m256 mat4_col2(const Mat4& mat, int col) {
+    __m128 c = _mm_loadu_ps(mat.m+4*col);
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(c), c, 1);
+}
+
+/**
+ * Returns the product of the columns of m2 with two packed columns
+ *
+ * The columns are packed into the low and high halves of the register.  Each
+ * half of the result is a single column of a matrix product.
+ *
+ * @param c0    The first column of m2 (in both halves)
+ * @param c1    The second column of m2 (in both halves)
+ * @param c2    The third column of m2 (in both halves)
+ * @param c3    The fourth column of m2 (in both halves)
+ * @param cols  The packed columns
+ *
+ * @return the product of the columns of m2 with two packed columns
+ */
+static inline __m256 mat4_mult_col2(__m256 c0, __m256 c1, __m256 c2, __m256 c3, __m256 cols) {
+    __m256 v0 = _mm256_mul_ps(c0, _mm256_permute_ps(cols, _MM_SHUFFLE(0, 0, 0, 0)));
+    __m256 v1 = _mm256_mul_ps(c1, _mm256_permute_ps(cols, _MM_SHUFFLE(1, 1, 1, 1)));
+    __m256 v2 = _mm256_mul_ps(c2, _mm256_permute_ps(cols, _MM_SHUFFLE(2, 2, 2, 2)));
+    __m256 v3 = _mm256_mul_ps(c3, _mm256_permute_ps(cols, _MM_SHUFFLE(3, 3, 3, 3)));
+    return _mm256_add_ps(_mm256_add_ps(v0, v1), _mm256_add_ps(v2, v3));
+}
+#endif
+
 /**
  * Adds a scalar to each component of mat and stores the result in dst.
  *
@@ -46,10 +129,9 @@
  */
 Mat4* Mat4::add(const Mat4& mat, float scalar, Mat4* dst) {
     __m128 s = _mm_set1_ps(scalar);
-    dst->col[0] = _mm_add_ps(mat.col[0], s);
-    dst->col[1] = _mm_add_ps(mat.col[1], s);
-    dst->col[2] = _mm_add_ps(mat.col[2], s);
-    dst->col[3] = _mm_add_ps(mat.col[3], s);
+    for(int ii = 0; ii < 4; ii++) {
+        _mm_storeu_ps(dst->m+4*ii, _mm_add_ps(mat4_col(mat,ii), s));
+    }
     return dst;
 }
 
@@ -63,10 +145,9 @@ Mat4* Mat4::add(const Mat4& mat, float scalar, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Mat4* Mat4::add(const Mat4& m1, const Mat4& m2, Mat4* dst) {
-    dst->col[0] = _mm_add_ps(m1.col[0], m2.col[0]);
-    dst->col[1] = _mm_add_ps(m1.col[1], m2.col[1]);
-    dst->col[2] = _mm_add_ps(m1.col[2], m2.col[2]);
-    dst->col[3] = _mm_add_ps(m1.col[3], m2.col[3]);
+    for(int ii = 0; ii < 4; ii++) {
+        _mm_storeu_ps(dst->m+4*ii, _mm_add_ps(mat4_col(m1,ii), mat4_col(m2,ii)));
+    }
     return dst;
 }
 
@@ -81,10 +162,9 @@ Mat4* Mat4::add(const Mat4& m1, const Mat4& m2, Mat4* dst) {
  */
 Mat4* Mat4::subtract(const Mat4& mat, float scalar, Mat4* dst) {
     __m128 s = _mm_set1_ps(scalar);
-    dst->col[0] = _mm_sub_ps(mat.col[0], s);
-    dst->col[1] = _mm_sub_ps(mat.col[1], s);
-    dst->col[2] = _mm_sub_ps(mat.col[2], s);
-    dst->col[3] = _mm_sub_ps(mat.col[3], s);
+    for(int ii = 0; ii < 4; ii++) {
+        _mm_storeu_ps(dst->m+4*ii, _mm_sub_ps(mat4_col(mat,ii), s));
+    }
     return dst;
 }
 
@@ -98,10 +178,9 @@ Mat4* Mat4::subtract(const Mat4& mat, float scalar, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Mat4* Mat4::subtract(const Mat4& m1, const Mat4& m2, Mat4* dst) {
-    dst->col[0] = _mm_sub_ps(m1.col[0], m2.col[0]);
-    dst->col[1] = _mm_sub_ps(m1.col[1], m2.col[1]);
-    dst->col[2] = _mm_sub_ps(m1.col[2], m2.col[2]);
-    dst->col[3] = _mm_sub_ps(m1.col[3], m2.col[3]);
+    for(int ii = 0; ii < 4; ii++) {
+        _mm_storeu_ps(dst->m+4*ii, _mm_sub_ps(mat4_col(m1,ii), mat4_col(m2,ii)));
+    }
     return dst;
 }
 
@@ -116,10 +195,9 @@ Mat4* Mat4::subtract(const Mat4& m1, const Mat4& m2, Mat4* dst) {
  */
 Mat4* Mat4::multiply(const Mat4& mat, float scalar, Mat4* dst) {
     __m128 s = _mm_set1_ps(scalar);
-    dst->col[0] = _mm_mul_ps(mat.col[0], s);
-    dst->col[1] = _mm_mul_ps(mat.col[1], s);
-    dst->col[2] = _mm_mul_ps(mat.col[2], s);
-    dst->col[3] = _mm_mul_ps(mat.col[3], s);
+    for(int ii = 0; ii < 4; ii++) {
+        _mm_storeu_ps(dst->m+4*ii, _mm_mul_ps(mat4_col(mat,ii), s));
+    }
     return dst;
 }
 
@@ -136,86 +214,29 @@ Mat4* Mat4::multiply(const Mat4& mat, float scalar, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Mat4* Mat4::multiply(const Mat4& m1, const Mat4& m2, Mat4* dst) {
-    __m128 dst0, dst1, dst2, dst3;
-    {
-		__m128 col = m1.col[0];
-        __m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
-        __m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
-        __m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
-        __m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
-        
-        __m128 v0 = _mm_mul_ps(m2.col[0], e0);
-        __m128 v1 = _mm_mul_ps(m2.col[1], e1);
-        __m128 v2 = _mm_mul_ps(m2.col[2], e2);
-        __m128 v3 = _mm_mul_ps(m2.col[3], e3);
-        
-        __m128 a0 = _mm_add_ps(v0, v1);
-        __m128 a1 = _mm_add_ps(v2, v3);
-        __m128 a2 = _mm_add_ps(a0, a1);
-        
-        dst0 = a2;
-    }
+#if defined CU_MATH_VECTOR_AVX
+    __m256 c0 = mat4_col2(m2,0);
+    __m256 c1 = mat4_col2(m2,1);
+    __m256 c2 = mat4_col2(m2,2);
+    __m256 c3 = mat4_col2(m2,3);
+    __m256 dst01 = mat4_mult_col2(c0, c1, c2, c3, _mm256_loadu_ps(m1.m));
+    __m256 dst23 = mat4_mult_col2(c0, c1, c2, c3, _mm256_loadu_ps(m1.m+8));
     
-    {
-		__m128 col = m1.col[1];
-		__m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
-		__m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
-		__m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
-		__m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
-
-        __m128 v0 = _mm_mul_ps(m2.col[0], e0);
-        __m128 v1 = _mm_mul_ps(m2.col[1], e1);
-        __m128 v2 = _mm_mul_ps(m2.col[2], e2);
-        __m128 v3 = _mm_mul_ps(m2.col[3], e3);
-        
-        __m128 a0 = _mm_add_ps(v0, v1);
-        __m128 a1 = _mm_add_ps(v2, v3);
-        __m128 a2 = _mm_add_ps(a0, a1);
-        
-        dst1 = a2;
-    }
+    // Store last, as dst may be either m1 or m2
+    _mm256_storeu_ps(dst->m,   dst01);
+    _mm256_storeu_ps(dst->m+8, dst23);
+#else
+    __m128 dst0 = mat4_mult_col(m2, mat4_col(m1,0));
+    __m128 dst1 = mat4_mult_col(m2, mat4_col(m1,1));
+    __m128 dst2 = mat4_mult_col(m2, mat4_col(m1,2));
+    __m128 dst3 = mat4_mult_col(m2, mat4_col(m1,3));
     
-    {
-		__m128 col = m1.col[2];
-		__m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
-		__m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
-		__m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
-		__m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
-
-        __m128 v0 = _mm_mul_ps(m2.col[0], e0);
-        __m128 v1 = _mm_mul_ps(m2.col[1], e1);
-        __m128 v2 = _mm_mul_ps(m2.col[2], e2);
-        __m128 v3 = _mm_mul_ps(m2.col[3], e3);
-        
-        __m128 a0 = _mm_add_ps(v0, v1);
-        __m128 a1 = _mm_add_ps(v2, v3);
-        __m128 a2 = _mm_add_ps(a0, a1);
-        
-        dst2 = a2;
-    }
-    
-    {
-		__m128 col = m1.col[3];
-		__m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
-		__m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
-		__m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
-		__m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
-
-        __m128 v0 = _mm_mul_ps(m2.col[0], e0);
-        __m128 v1 = _mm_mul_ps(m2.col[1], e1);
-        __m128 v2 = _mm_mul_ps(m2.col[2], e2);
-        __m128 v3 = _mm_mul_ps(m2.col[3], e3);
-        
-        __m128 a0 = _mm_add_ps(v0, v1);
-        __m128 a1 = _mm_add_ps(v2, v3);
-        __m128 a2 = _mm_add_ps(a0, a1);
-        
-        dst3 = a2;
-    }
-    dst->col[0] = dst0;
-    dst->col[1] = dst1;
-    dst->col[2] = dst2;
-    dst->col[3] = dst3;
+    // Store last, as dst may be either m1 or m2
+    _mm_storeu_ps(dst->m,    dst0);
+    _mm_storeu_ps(dst->m+4,  dst1);
+    _mm_storeu_ps(dst->m+8,  dst2);
+    _mm_storeu_ps(dst->m+12, dst3);
+#endif
     return dst;
 }
 
@@ -229,10 +250,9 @@ Mat4* Mat4::multiply(const Mat4& m1, const Mat4& m2, Mat4* dst) {
  */
 Mat4* Mat4::negate(const Mat4& mat, Mat4* dst) {
     __m128 z = _mm_setzero_ps();
-    dst->col[0] = _mm_sub_ps(z, mat.col[0]);
-    dst->col[1] = _mm_sub_ps(z, mat.col[1]);
-    dst->col[2] = _mm_sub_ps(z, mat.col[2]);
-    dst->col[3] = _mm_sub_ps(z, mat.col[3]);
+    for(int ii = 0; ii < 4; ii++) {
+        _mm_storeu_ps(dst->m+4*ii, _mm_sub_ps(z, mat4_col(mat,ii)));
+    }
     return dst;
 }
 
@@ -249,15 +269,15 @@ Mat4* Mat4::negate(const Mat4& mat, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Mat4* Mat4::transpose(const Mat4& m1, Mat4* dst) {
-    __m128 tmp0 = _mm_shuffle_ps(m1.col[0], m1.col[1], 0x44);
-    __m128 tmp2 = _mm_shuffle_ps(m1.col[0], m1.col[1], 0xEE);
-    __m128 tmp1 = _mm_shuffle_ps(m1.col[2], m1.col[3], 0x44);
-    __m128 tmp3 = _mm_shuffle_ps(m1.col[2], m1.col[3], 0xEE);
-    
-    dst->col[0] = _mm_shuffle_ps(tmp0, tmp1, 0x88);
-    dst->col[1] = _mm_shuffle_ps(tmp0, tmp1, 0xDD);
-    dst->col[2] = _mm_shuffle_ps(tmp2, tmp3, 0x88);
-    dst->col[3] = _mm_shuffle_ps(tmp2, tmp3, 0xDD);
+    __m128 col0 = mat4_col(m1,0);
+    __m128 col1 = mat4_col(m1,1);
+    __m128 col2 = mat4_col(m1,2);
+    __m128 col3 = mat4_col(m1,3);
+    _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+    _mm_storeu_ps(dst->m,    col0);
+    _mm_storeu_ps(dst->m+4,  col1);
+    _mm_storeu_ps(dst->m+8,  col2);
+    _mm_storeu_ps(dst->m+12, col3);
     return dst;
 }
 
@@ -274,14 +294,54 @@ Mat4* Mat4::transpose(const Mat4& m1, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Vec4* Mat4::transform(const Mat4& mat, const Vec4& vec, Vec4* dst) {
-    __m128 col1 = _mm_shuffle_ps(vec.v, vec.v, _MM_SHUFFLE(0, 0, 0, 0));
-    __m128 col2 = _mm_shuffle_ps(vec.v, vec.v, _MM_SHUFFLE(1, 1, 1, 1));
-    __m128 col3 = _mm_shuffle_ps(vec.v, vec.v, _MM_SHUFFLE(2, 2, 2, 2));
-    __m128 col4 = _mm_shuffle_ps(vec.v, vec.v, _MM_SHUFFLE(3, 3, 3, 3));
-    
-    dst->v = _mm_add_ps(
-                        _mm_add_ps(_mm_mul_ps(mat.col[0], col1), _mm_mul_ps(mat.col[1], col2)),
-                        _mm_add_ps(_mm_mul_ps(mat.col[2], col3), _mm_mul_ps(mat.col[3], col4))
-                        );
+    _mm_storeu_ps(&(dst->x), mat4_mult_col(mat, _mm_loadu_ps(&(vec.x))));
     return dst;
-}
\ No newline at end of file
+}
+
+/**
+ * Transforms the array of vectors by the given matrix.
+ *
+ * The vectors are treated as is.  Hence whether or not translation is
+ * applied depends on the value of w.  This method is much faster than
+ * transforming each vector individually on vectorized platforms.  The
+ * input and output may be the same array, but they may not otherwise
+ * overlap.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The vectors to transform.
+ * @param output    An array to store the transformed vectors in.
+ * @param count     The number of vectors to transform.
+ *
+ * @return A reference to output for chaining
+ */
+Vec4* Mat4::transform(const Mat4& mat, const Vec4* input, Vec4* output, size_t count) {
+    const float* src = &(input[0].x);
+    float* dst = &(output[0].x);
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX
+    __m256 c0 = mat4_col2(mat,0);
+    __m256 c1 = mat4_col2(mat,1);
+    __m256 c2 = mat4_col2(mat,2);
+    __m256 c3 = mat4_col2(mat,3);
+    for(; ii+2 <= count; ii += 2) {
+        _mm256_storeu_ps(dst+4*ii, mat4_mult_col2(c0, c1, c2, c3, _mm256_loadu_ps(src+4*ii)));
+    }
+#else
+    __m128 c0 = mat4_col(mat,0);
+    __m128 c1 = mat4_col(mat,1);
+    __m128 c2 = mat4_col(mat,2);
+    __m128 c3 = mat4_col(mat,3);
+    for(; ii < count; ii++) {
+        __m128 v = _mm_loadu_ps(src+4*ii);
+        __m128 v0 = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+        __m128 v1 = _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+        __m128 v2 = _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)));
+        __m128 v3 = _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+        _mm_storeu_ps(dst+4*ii, _mm_add_ps(_mm_add_ps(v0, v1), _mm_add_ps(v2, v3)));
+    }
+#endif
+    for(; ii < count; ii++) {
+        transform(mat, input[ii], output+ii);
+    }
+    return output;
+}
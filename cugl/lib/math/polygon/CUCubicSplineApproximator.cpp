@@ -36,12 +36,38 @@
 #include <cugl/math/polygon/CUCubicSplineApproximator.h>
 #include <cugl/util/CUDebug.h>
 #include <iterator>
+#include <cmath>
 
 /** Tolerance to identify a point as "smooth" */
 #define SMOOTH_TOLERANCE    0.0001f
 
 using namespace cugl;
 
+/**
+ * Returns the number of line segments needed to flatten the given bezier
+ *
+ * This is Wang's formula, which bounds the distance between the bezier and
+ * the polyline of uniformly spaced parameters by the size of the second
+ * differences of the control points.  Straight beziers need only one segment.
+ *
+ * @param p         The four control points of the bezier
+ * @param tolerance The maximum distance from the true curve
+ *
+ * @return the number of line segments needed to flatten the given bezier
+ */
+static int flatten_segments(const Vec2* p, float tolerance) {
+    float ax = p[0].x-2*p[1].x+p[2].x;
+    float ay = p[0].y-2*p[1].y+p[2].y;
+    float bx = p[1].x-2*p[2].x+p[3].x;
+    float by = p[1].y-2*p[2].y+p[3].y;
+    float m = std::sqrt(std::max(ax*ax+ay*ay,bx*bx+by*by));
+    float n = std::ceil(std::sqrt(0.75f*m/tolerance));
+    if (!(n >= 1.0f)) {
+        return 1;
+    }
+    return n > MAX_FLATTEN_SEGMENTS ? MAX_FLATTEN_SEGMENTS : (int)n;
+}
+
 #pragma mark Calculation
 /**
  * Performs an approximation of the current spline
@@ -67,8 +93,9 @@ void CubicSplineApproximator::calculate(Criterion criterion, float tolerance) {
     reset();
     if (!_spline) { return; }
     
+    const Vec2* points = _spline->_points.data();
     for (int ii = 0; ii < _spline->_size; ii++) {
-        generate(_spline->_points, (3 * ii), (float)ii, tolerance, criterion, 0);
+        generate(points+3*ii, (float)ii, tolerance, criterion, 0);
     }
     
     // Push back last point and parameter
@@ -85,8 +112,10 @@ void CubicSplineApproximator::calculate(Criterion criterion, float tolerance) {
  * de Castlejau's algorithm and stores the data in the buffer.  You
  * will never call this method directly.
  *
- * @param  src          the control point list for the bezier
- * @param  soff         the offset into the control point list
+ * The subdivision is performed on the stack, so this method only allocates
+ * memory if the output buffers must grow.
+ *
+ * @param  src          the four control points for the bezier
  * @param  tp           the parameter to split at
  * @param  tolerance    the error tolerance of the stopping condition
  * @param  criterion    the stopping condition criterion
@@ -94,26 +123,25 @@ void CubicSplineApproximator::calculate(Criterion criterion, float tolerance) {
  *
  * @return The number of (anchor) points generated by this recursive call.
  */
-int CubicSplineApproximator::generate(const std::vector<Vec2>& src, int soff, float tp,
-                                      float tolerance, CubicSplineApproximator::Criterion criterion,
-                                      int depth) {
+int CubicSplineApproximator::generate(const Vec2* src, float tp, float tolerance,
+                                      CubicSplineApproximator::Criterion criterion, int depth) {
     // Do not go to far
-    bool terminate = (depth >= 8) || (soff >= src.size() - 1);
+    bool terminate = (depth >= 8);
         
     // Check if we are at the bottom level
     if (!terminate && criterion == CubicSplineApproximator::Criterion::SPACING) {
-        Vec2 temp0 = src[soff + 3] - src[soff];             // p3 - p0
+        Vec2 temp0 = src[3] - src[0];             // p3 - p0
         terminate = temp0.length() < tolerance;
     }
     else if (!terminate && (criterion == CubicSplineApproximator::Criterion::DISTANCE ||
                                 criterion == CubicSplineApproximator::Criterion::FLAT)) {
-        Vec2 temp0 = src[soff + 3] - src[soff];             // p3 - p0
+        Vec2 temp0 = src[3] - src[0];             // p3 - p0
         float leng = 1.0f;
         if (criterion == CubicSplineApproximator::Criterion::FLAT) {
             leng = temp0.length();
         }
             
-        Vec2 temp1 = src[soff + 1] - src[soff];             // p1 - p0
+        Vec2 temp1 = src[1] - src[0];             // p1 - p0
         temp1.normalize();
         float scale = temp0.dot(temp1);
         temp1 *= scale;
@@ -121,8 +149,8 @@ int CubicSplineApproximator::generate(const std::vector<Vec2>& src, int soff, fl
             
         terminate = (temp0.length() < tolerance*leng);
     
-        temp0 = src[soff] - src[soff + 3];                  // p0 - p3
-        temp1 = src[soff + 2] - src[soff + 3];              // p2 - p3
+        temp0 = src[0] - src[3];                  // p0 - p3
+        temp1 = src[2] - src[3];              // p2 - p3
         temp1.normalize();
         scale = temp0.dot(temp1);
         temp1 *= scale;
@@ -135,20 +163,29 @@ int CubicSplineApproximator::generate(const std::vector<Vec2>& src, int soff, fl
     int result = 0;
     if (terminate) {
         _parambuff.push_back(tp);
-        _pointbuff.push_back(src[soff]);
-        _pointbuff.push_back(src[soff + 1]);
-        _pointbuff.push_back(src[soff + 2]);
+        _pointbuff.push_back(src[0]);
+        _pointbuff.push_back(src[1]);
+        _pointbuff.push_back(src[2]);
         return 1;
     }
         
-    std::vector<Vec2> left;
-    std::vector<Vec2> rght;
-    CubicSpline::subdivide(src, soff, 0.5, left, rght);
-        
+    // de Castlejau's at the midpoint
+    Vec2 left[4];
+    Vec2 rght[4];
+    Vec2 mid = (src[1]+src[2])*0.5f;
+    left[0] = src[0];
+    left[1] = (src[0]+src[1])*0.5f;
+    left[2] = (left[1]+mid)*0.5f;
+    rght[3] = src[3];
+    rght[2] = (src[2]+src[3])*0.5f;
+    rght[1] = (mid+rght[2])*0.5f;
+    left[3] = (left[2]+rght[1])*0.5f;
+    rght[0] = left[3];
+    
     // Recursive calls
     float sp = tp + 1.0f / (1 << (depth + 1));
-    result =  generate(left, 0, tp, tolerance, criterion, depth + 1);
-    result += generate(rght, 0, sp, tolerance, criterion, depth + 1);
+    result =  generate(left, tp, tolerance, criterion, depth + 1);
+    result += generate(rght, sp, tolerance, criterion, depth + 1);
     return result;
 }
 
@@ -189,7 +226,7 @@ Poly2 CubicSplineApproximator::getPath() const {
         poly._indices.pop_back();
         poly._indices.push_back(0);
     } else {
-        poly._vertices.push_back(points->at(size));
+        poly._vertices.push_back(points->at(size-1));
     }
     
     poly.setType(Poly2::Type::PATH);
@@ -238,13 +275,98 @@ Poly2* CubicSplineApproximator::getPath(Poly2* buffer) const {
         buffer->_indices.pop_back();
         buffer->_indices.push_back(offs);
     } else {
-        buffer->_vertices.push_back(points->at(size));
+        buffer->_vertices.push_back(points->at(size-1));
     }
 
     buffer->setType(Poly2::Type::PATH);
     return buffer;
 }
 
+/**
+ * Stores a polyline approximating this spline in the given storage.
+ *
+ * Unlike {@link #getPath}, this method does not use the results of
+ * {@link #calculate}.  Instead, it flattens each bezier segment of the
+ * spline directly, choosing the number of line segments from the
+ * curvature of that bezier (using Wang's formula).  The result is
+ * guaranteed to be within tolerance of the true curve.  The points are
+ * then computed with forward differencing.
+ *
+ * The tolerance is measured in the coordinate space of the spline. To
+ * flatten with respect to a screen-space tolerance, divide that tolerance
+ * by the scale of the transform used to draw the spline.
+ *
+ * The result is a sequence of points along the spline.  If the spline
+ * is open, the last point is the end of the spline. If it is closed,
+ * the last point is omitted, as it is the same as the first. If params
+ * is not null, it will store the spline parameter for each point.
+ *
+ * This method does not allocate memory.  If the capacity is too small
+ * to hold the result, this method will write nothing.  In either case,
+ * it returns the number of points required.  Hence you can call this
+ * method with a null buffer to determine the size of the storage.
+ *
+ * @param  buffer       The storage for the points
+ * @param  capacity     The number of points the buffer (and params) can hold
+ * @param  tolerance    The maximum distance from the true curve
+ * @param  params       Optional storage for the point parameters
+ *
+ * @return the number of points required for the approximation.
+ */
+size_t CubicSplineApproximator::flatten(Vec2* buffer, size_t capacity, float tolerance,
+                                        float* params) const {
+    if (!_spline || _spline->_size == 0) {
+        return 0;
+    }
+    
+    const Vec2* points = _spline->_points.data();
+    size_t total = _spline->_closed ? 0 : 1;
+    for (int ii = 0; ii < _spline->_size; ii++) {
+        total += flatten_segments(points+3*ii, tolerance);
+    }
+    if (buffer == nullptr || total > capacity) {
+        return total;
+    }
+    
+    size_t pos = 0;
+    for (int ii = 0; ii < _spline->_size; ii++) {
+        const Vec2* p = points+3*ii;
+        int n = flatten_segments(p, tolerance);
+        float h  = 1.0f/n;
+        float h2 = h*h;
+        float h3 = h2*h;
+        
+        // Power basis coefficients
+        Vec2 a = p[3]-p[0]+3*(p[1]-p[2]);
+        Vec2 b = 3*(p[0]+p[2])-6*p[1];
+        Vec2 c = 3*(p[1]-p[0]);
+        
+        // Forward differences
+        Vec2 f  = p[0];
+        Vec2 d1 = a*h3+b*h2+c*h;
+        Vec2 d3 = a*(6*h3);
+        Vec2 d2 = d3+b*(2*h2);
+        for (int jj = 0; jj < n; jj++) {
+            buffer[pos] = f;
+            if (params) {
+                params[pos] = ii+jj*h;
+            }
+            pos++;
+            f  += d1;
+            d1 += d2;
+            d2 += d3;
+        }
+    }
+    
+    if (!_spline->_closed) {
+        buffer[pos] = points[3*_spline->_size];
+        if (params) {
+            params[pos] = (float)_spline->_size;
+        }
+    }
+    return total;
+}
+
 
 /**
  * Returns a list of parameters for a polygon approximation
@@ -295,7 +417,7 @@ std::vector<float> CubicSplineApproximator::getParameters() const {
  *
  * @return the number of elements added to the buffer
  */
-size_t CubicSplineApproximator::getParameters(std::vector<float> buffer) {
+size_t CubicSplineApproximator::getParameters(std::vector<float>& buffer) const {
     if (_calculated) {
         buffer.reserve(buffer.size()+_parambuff.size());
         std::copy(_parambuff.begin(),_parambuff.end(),std::back_inserter(buffer));
@@ -365,7 +487,7 @@ std::vector<Vec2> CubicSplineApproximator::getTangents() const {
  *
  * @return the number of elements added to the buffer
  */
-size_t CubicSplineApproximator::getTangents(std::vector<Vec2> buffer) {
+size_t CubicSplineApproximator::getTangents(std::vector<Vec2>& buffer) const {
     const std::vector<Vec2>* points = getActivePoints();
     if (!points) { return 0; }
 
@@ -402,7 +524,7 @@ size_t CubicSplineApproximator::getTangents(std::vector<Vec2> buffer) {
  *
  * @return the number of elements added to the buffer
  */
-Poly2* CubicSplineApproximator::getTangents(Poly2* buffer) {
+Poly2* CubicSplineApproximator::getTangents(Poly2* buffer) const {
     CUAssertLog(buffer, "Destination buffer is null");
     const std::vector<Vec2>* points = getActivePoints();
     if (!points) { return buffer; }
@@ -489,8 +611,9 @@ std::vector<Vec2> CubicSplineApproximator::getNormals() const {
  *
  * @return the number of elements added to the buffer
  */
-size_t CubicSplineApproximator::getNormals(std::vector<Vec2> buffer) {
+size_t CubicSplineApproximator::getNormals(std::vector<Vec2>& buffer) const {
     const std::vector<Vec2>* points = getActivePoints();
+    if (!points) { return 0; }
 
     int size = (int)points->size();
     int amt = (size-1)/3;
@@ -531,7 +654,7 @@ size_t CubicSplineApproximator::getNormals(std::vector<Vec2> buffer) {
  *
  * @return the number of elements added to the buffer
  */
-Poly2* CubicSplineApproximator::getNormals(Poly2* buffer) {
+Poly2* CubicSplineApproximator::getNormals(Poly2* buffer) const {
     CUAssertLog(buffer, "Destination buffer is null");
     const std::vector<Vec2>* points = getActivePoints();
     if (!points) { return buffer; }
@@ -572,7 +695,7 @@ Poly2* CubicSplineApproximator::getNormals(Poly2* buffer) {
  * @param  indices  the vector storing the index data
  */
 void fillHandle(const Vec2& point, float radius, int segments,
-                std::vector<Vec2> vertices, std::vector<unsigned short> indices) {
+                std::vector<Vec2> vertices, std::vector<Uint32> indices) {
     // Figure out the starting vertex
     int offset = (int)vertices.size();
     
@@ -0,0 +1,667 @@
+//
+//  CUMonotoneTriangulator.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for a sweep-line triangulator.  It partitions the
+//  polygon into y-monotone pieces in a single sweep, and then triangulates
+//  each piece in linear time.  This makes it O(n log n), as opposed to the
+//  ear clipping of SimpleTriangulator, and it supports polygons with holes.
+//  It is the triangulator to use for large outlines, such as level geometry.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  The algorithm is the classic one from "Computational Geometry: Algorithms
+//  and Applications" by de Berg, Cheong, van Kreveld, and Overmars.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+
+#include <cugl/math/polygon/CUMonotoneTriangulator.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <set>
+
+using namespace cugl;
+
+namespace {
+    /** The edge identifier of the sweep point in the status tree */
+    const int PROBE = -1;
+    
+    /**
+     * The ordering of edges in the sweep status.
+     *
+     * An edge is identified by the index of its start vertex.  Edges are ordered
+     * by where they cross the sweep line, from left to right.  Since edges of
+     * a simple polygon never cross, this order never changes while the edges
+     * are in the tree.  The special edge {@link PROBE} is the sweep point itself,
+     * and is used to search for the edge immediately to the left of a vertex.
+     */
+    struct EdgeOrder {
+        /** The polygon vertices */
+        const Vec2* verts;
+        /** The next vertex along each boundary */
+        const Uint32* next;
+        /** The current sweep point */
+        const Vec2* sweep;
+        
+        /**
+         * Returns the x-coordinate where the given edge crosses the sweep line.
+         *
+         * @param edge  The edge identifier
+         *
+         * @return the x-coordinate where the given edge crosses the sweep line.
+         */
+        float xAt(int edge) const {
+            if (edge == PROBE) {
+                return sweep->x;
+            }
+            const Vec2& a = verts[edge];
+            const Vec2& b = verts[next[edge]];
+            if (a.y == b.y) {
+                // Horizontal edges cross the sweep line at the sweep point
+                return std::min(std::max(sweep->x, std::min(a.x, b.x)), std::max(a.x, b.x));
+            }
+            return a.x + (sweep->y - a.y)*(b.x - a.x)/(b.y - a.y);
+        }
+        
+        /**
+         * Returns true if edge a is to the left of edge b.
+         *
+         * @param a     The first edge
+         * @param b     The second edge
+         *
+         * @return true if edge a is to the left of edge b.
+         */
+        bool operator()(int a, int b) const {
+            float xa = xAt(a);
+            float xb = xAt(b);
+            if (xa != xb) {
+                return xa < xb;
+            }
+            return a < b;
+        }
+    };
+}
+
+#pragma mark -
+#pragma mark Initialization
+/**
+ * Adds a hole to the polygon.
+ *
+ * The hole must lie strictly inside the outer boundary, and it may not
+ * intersect any other hole.  Holes with fewer than three vertices are
+ * ignored.  The vertex data is copied.  The triangulator does not retain
+ * any references to the original data.
+ *
+ * This method resets all interal data.  You will need to reperform the
+ * calculation before accessing data.
+ *
+ * @param points    The vertices of the hole
+ */
+void MonotoneTriangulator::addHole(const std::vector<Vec2>& points) {
+    reset();
+    if (points.size() < 3) {
+        return;
+    }
+    _holes.push_back((Uint32)_input.size());
+    _input.reserve(_input.size()+points.size());
+    std::copy(points.begin(), points.end(), std::back_inserter(_input));
+}
+
+
+#pragma mark -
+#pragma mark Calculation
+/**
+ * Performs a triangulation of the current vertex data.
+ */
+void MonotoneTriangulator::calculate() {
+    reset();
+    size_t outer = _holes.empty() ? _input.size() : _holes[0];
+    if (outer < 3) {
+        _calculated = true;
+        return;
+    }
+    
+    // A polygon with n vertices and h holes has n+2h-2 triangles
+    _output.reserve(3*(_input.size()+2*_holes.size()-2));
+    linkBoundaries();
+    classifyVertices();
+    computeDiagonals();
+    computeTriangulation();
+    _calculated = true;
+}
+
+/**
+ * Returns true if vertex a is above vertex b in the sweep order.
+ *
+ * The sweep moves from top to bottom.  Vertices at the same height are
+ * ordered left to right, which is the same as rotating the plane by an
+ * infinitesimal amount.  Hence no two vertices are at the same height.
+ *
+ * @param a     The first vertex index
+ * @param b     The second vertex index
+ *
+ * @return true if vertex a is above vertex b in the sweep order.
+ */
+bool MonotoneTriangulator::isAbove(Uint32 a, Uint32 b) const {
+    const Vec2& pa = _input[a];
+    const Vec2& pb = _input[b];
+    if (pa.y != pb.y) {
+        return pa.y > pb.y;
+    } else if (pa.x != pb.x) {
+        return pa.x < pb.x;
+    }
+    return a < b;
+}
+
+/**
+ * Links the vertices of each boundary so that the interior is on the left.
+ *
+ * This method makes the outer boundary counterclockwise and each hole
+ * clockwise, regardless of the orientation of the input.
+ */
+void MonotoneTriangulator::linkBoundaries() {
+    Uint32 vcount = (Uint32)_input.size();
+    _next.resize(vcount);
+    _prev.resize(vcount);
+    for(size_t ring = 0; ring <= _holes.size(); ring++) {
+        Uint32 first = ring == 0 ? 0 : _holes[ring-1];
+        Uint32 last  = ring == _holes.size() ? vcount : _holes[ring];
+        
+        // Twice the signed area (positive is counterclockwise)
+        double area = 0;
+        for(Uint32 ii = first; ii < last; ii++) {
+            const Vec2& a = _input[ii];
+            const Vec2& b = _input[ii+1 == last ? first : ii+1];
+            area += (double)a.x*b.y-(double)a.y*b.x;
+        }
+        
+        bool forward = ring == 0 ? area > 0 : area < 0;
+        for(Uint32 ii = first; ii < last; ii++) {
+            Uint32 succ = ii+1 == last ? first : ii+1;
+            Uint32 pred = ii == first ? last-1 : ii-1;
+            _next[ii] = forward ? succ : pred;
+            _prev[ii] = forward ? pred : succ;
+        }
+    }
+}
+
+/**
+ * Classifies each vertex according to its neighbors.
+ *
+ * The classification determines how the sweep line handles the vertex.
+ */
+void MonotoneTriangulator::classifyVertices() {
+    Uint32 vcount = (Uint32)_input.size();
+    _types.resize(vcount);
+    for(Uint32 ii = 0; ii < vcount; ii++) {
+        Uint32 prev = _prev[ii];
+        Uint32 next = _next[ii];
+        bool abovePrev = isAbove(ii, prev);
+        bool aboveNext = isAbove(ii, next);
+        if (abovePrev == aboveNext) {
+            // The interior is on the left, so a left turn is convex
+            bool convex = (_input[ii]-_input[prev]).cross(_input[next]-_input[ii]) > 0;
+            if (abovePrev) {
+                _types[ii] = convex ? START : SPLIT;
+            } else {
+                _types[ii] = convex ? END : MERGE;
+            }
+        } else {
+            _types[ii] = REGULAR;
+        }
+    }
+}
+
+/**
+ * Computes the diagonals that partition the polygon into monotone pieces.
+ *
+ * This is a sweep from top to bottom.  The sweep status is a balanced tree
+ * of the edges with the interior to their right, ordered by where they
+ * cross the sweep line.  Each split or merge vertex gets a diagonal to the
+ * closest vertex that resolves it.
+ */
+void MonotoneTriangulator::computeDiagonals() {
+    Uint32 vcount = (Uint32)_input.size();
+    std::vector<Uint32> events(vcount);
+    for(Uint32 ii = 0; ii < vcount; ii++) {
+        events[ii] = ii;
+    }
+    std::sort(events.begin(), events.end(), [this](Uint32 a, Uint32 b) {
+        return isAbove(a, b);
+    });
+    
+    // Edges are identified by their start vertex
+    Vec2 sweep;
+    EdgeOrder order;
+    order.verts = _input.data();
+    order.next  = _next.data();
+    order.sweep = &sweep;
+    
+    typedef std::set<int,EdgeOrder> Status;
+    Status status(order);
+    std::vector<Status::iterator> entries(vcount,status.end());
+    std::vector<Uint32> helper(vcount,0);
+    
+    // Returns the edge immediately to the left of the sweep point
+    auto findLeft = [&]() {
+        Status::iterator it = status.lower_bound(PROBE);
+        CUAssertLog(it != status.begin(), "Polygon is not simple");
+        return (Uint32)*(--it);
+    };
+    // Adds a diagonal to the helper of the edge if it is a merge vertex
+    auto resolve = [&](Uint32 v, Uint32 edge) {
+        if (_types[helper[edge]] == MERGE) {
+            _diagonals.push_back(v);
+            _diagonals.push_back(helper[edge]);
+        }
+    };
+    
+    for(auto it = events.begin(); it != events.end(); ++it) {
+        Uint32 v = *it;
+        Uint32 prev = _prev[v];
+        sweep = _input[v];
+        switch (_types[v]) {
+            case START:
+                entries[v] = status.insert((int)v).first;
+                helper[v] = v;
+                break;
+            case END:
+                resolve(v, prev);
+                status.erase(entries[prev]);
+                break;
+            case SPLIT:
+            {
+                Uint32 left = findLeft();
+                _diagonals.push_back(v);
+                _diagonals.push_back(helper[left]);
+                helper[left] = v;
+                entries[v] = status.insert((int)v).first;
+                helper[v] = v;
+            }
+                break;
+            case MERGE:
+            {
+                resolve(v, prev);
+                status.erase(entries[prev]);
+                Uint32 left = findLeft();
+                resolve(v, left);
+                helper[left] = v;
+            }
+                break;
+            case REGULAR:
+                if (isAbove(prev, v)) {
+                    // The interior is to the right of this vertex
+                    resolve(v, prev);
+                    status.erase(entries[prev]);
+                    entries[v] = status.insert((int)v).first;
+                    helper[v] = v;
+                } else {
+                    Uint32 left = findLeft();
+                    resolve(v, left);
+                    helper[left] = v;
+                }
+                break;
+        }
+    }
+}
+
+/**
+ * Triangulates each of the monotone pieces.
+ *
+ * The pieces are the faces of the boundary edges and the diagonals.  This
+ * method walks each face, and then triangulates it.
+ */
+void MonotoneTriangulator::computeTriangulation() {
+    Uint32 vcount = (Uint32)_input.size();
+    
+    // Build the adjacency lists of the planar graph
+    std::vector<Uint32> offsets(vcount+1,0);
+    for(Uint32 ii = 0; ii < vcount; ii++) {
+        offsets[ii+1] = 2;
+    }
+    for(auto it = _diagonals.begin(); it != _diagonals.end(); ++it) {
+        offsets[*it+1]++;
+    }
+    for(Uint32 ii = 0; ii < vcount; ii++) {
+        offsets[ii+1] += offsets[ii];
+    }
+    
+    std::vector<Uint32> adjacent(offsets[vcount]);
+    std::vector<Uint32> fill(offsets.begin(), offsets.end()-1);
+    for(Uint32 ii = 0; ii < vcount; ii++) {
+        adjacent[fill[ii]++] = _next[ii];
+        adjacent[fill[ii]++] = _prev[ii];
+    }
+    for(size_t ii = 0; ii < _diagonals.size(); ii += 2) {
+        Uint32 a = _diagonals[ii];
+        Uint32 b = _diagonals[ii+1];
+        adjacent[fill[a]++] = b;
+        adjacent[fill[b]++] = a;
+    }
+    
+    // Sort each list counterclockwise
+    for(Uint32 ii = 0; ii < vcount; ii++) {
+        Uint32 begin = offsets[ii];
+        Uint32 end   = offsets[ii+1];
+        if (end-begin > 2) {
+            const Vec2& origin = _input[ii];
+            std::sort(adjacent.begin()+begin, adjacent.begin()+end, [&](Uint32 a, Uint32 b) {
+                Vec2 da = _input[a]-origin;
+                Vec2 db = _input[b]-origin;
+                return atan2f(da.y,da.x) < atan2f(db.y,db.x);
+            });
+        }
+    }
+    
+    // Walk each face with the interior on the left
+    std::vector<bool> visited(adjacent.size(),false);
+    auto slot = [&](Uint32 from, Uint32 to) {
+        for(Uint32 kk = offsets[from]; kk < offsets[from+1]; kk++) {
+            if (adjacent[kk] == to) {
+                return kk;
+            }
+        }
+        return offsets[from+1];
+    };
+    
+    std::vector<Uint32> face;
+    auto walk = [&](Uint32 from, Uint32 to) {
+        Uint32 start = slot(from,to);
+        if (visited[start]) {
+            return;
+        }
+        face.clear();
+        Uint32 edge = start;
+        size_t limit = adjacent.size();
+        while (!visited[edge] && limit--) {
+            visited[edge] = true;
+            face.push_back(from);
+            
+            // Take the next edge clockwise from the reverse edge
+            Uint32 begin = offsets[to];
+            Uint32 size  = offsets[to+1]-begin;
+            Uint32 back  = slot(to,from)-begin;
+            Uint32 succ  = adjacent[begin+(back == 0 ? size : back)-1];
+            from = to;
+            to = succ;
+            edge = slot(from,to);
+        }
+        triangulateMonotone(face);
+    };
+    
+    for(Uint32 ii = 0; ii < vcount; ii++) {
+        walk(ii,_next[ii]);
+    }
+    for(size_t ii = 0; ii < _diagonals.size(); ii += 2) {
+        walk(_diagonals[ii],_diagonals[ii+1]);
+        walk(_diagonals[ii+1],_diagonals[ii]);
+    }
+}
+
+/**
+ * Triangulates a single y-monotone polygon.
+ *
+ * The polygon is given as a list of vertex indices, with the interior on
+ * the left.  This is the linear time stack algorithm, which processes the
+ * vertices in sweep order and cuts off triangles as soon as possible.
+ *
+ * @param face  The vertex indices of the monotone polygon
+ */
+void MonotoneTriangulator::triangulateMonotone(const std::vector<Uint32>& face) {
+    size_t size = face.size();
+    if (size < 3) {
+        return;
+    } else if (size == 3) {
+        addTriangle(face[0], face[1], face[2]);
+        return;
+    }
+    
+    size_t top = 0;
+    size_t bot = 0;
+    for(size_t ii = 1; ii < size; ii++) {
+        if (isAbove(face[ii], face[top])) {
+            top = ii;
+        }
+        if (isAbove(face[bot], face[ii])) {
+            bot = ii;
+        }
+    }
+    
+    // Merge the two chains into sweep order. The left chain runs forward from
+    // the top (counterclockwise), while the right chain runs backward.
+    std::vector<Uint32> sorted;
+    std::vector<bool> onleft;
+    sorted.reserve(size);
+    onleft.reserve(size);
+    sorted.push_back(face[top]);
+    onleft.push_back(true);
+    size_t lpos = (top+1) % size;
+    size_t rpos = (top+size-1) % size;
+    while (sorted.size() < size) {
+        bool takeLeft;
+        if (lpos == (bot+1) % size) {
+            takeLeft = false;
+        } else if (rpos == bot) {
+            takeLeft = true;
+        } else {
+            takeLeft = isAbove(face[lpos], face[rpos]);
+        }
+        if (takeLeft) {
+            sorted.push_back(face[lpos]);
+            onleft.push_back(true);
+            lpos = (lpos+1) % size;
+        } else {
+            sorted.push_back(face[rpos]);
+            onleft.push_back(false);
+            rpos = (rpos+size-1) % size;
+        }
+    }
+    
+    std::vector<size_t> stack;
+    stack.reserve(size);
+    stack.push_back(0);
+    stack.push_back(1);
+    for(size_t jj = 2; jj+1 < size; jj++) {
+        Uint32 uj = sorted[jj];
+        if (onleft[jj] != onleft[stack.back()]) {
+            // Connect to every vertex on the opposite chain
+            for(size_t kk = 0; kk+1 < stack.size(); kk++) {
+                Uint32 a = sorted[stack[kk]];
+                Uint32 b = sorted[stack[kk+1]];
+                if (onleft[jj]) {
+                    addTriangle(b, a, uj);
+                } else {
+                    addTriangle(a, b, uj);
+                }
+            }
+            stack.clear();
+            stack.push_back(jj-1);
+            stack.push_back(jj);
+        } else {
+            // Cut off triangles while the diagonal is inside
+            size_t last = stack.back();
+            stack.pop_back();
+            while (!stack.empty()) {
+                const Vec2& p = _input[uj];
+                float turn = (_input[sorted[stack.back()]]-p).cross(_input[sorted[last]]-p);
+                if (onleft[jj] ? turn <= 0 : turn >= 0) {
+                    break;
+                }
+                if (onleft[jj]) {
+                    addTriangle(sorted[stack.back()], sorted[last], uj);
+                } else {
+                    addTriangle(uj, sorted[last], sorted[stack.back()]);
+                }
+                last = stack.back();
+                stack.pop_back();
+            }
+            stack.push_back(last);
+            stack.push_back(jj);
+        }
+    }
+    
+    // Fan the remaining vertices from the bottom
+    Uint32 bottom = sorted[size-1];
+    bool left = onleft[stack.back()];
+    for(size_t kk = 0; kk+1 < stack.size(); kk++) {
+        Uint32 a = sorted[stack[kk]];
+        Uint32 b = sorted[stack[kk+1]];
+        if (left) {
+            addTriangle(a, b, bottom);
+        } else {
+            addTriangle(b, a, bottom);
+        }
+    }
+}
+
+/**
+ * Adds the given triangle to the output, unless it is degenerate.
+ *
+ * Colinear triangles will crash OpenGL, so we remove them.
+ *
+ * @param a     The first vertex index
+ * @param b     The second vertex index
+ * @param c     The third vertex index
+ */
+void MonotoneTriangulator::addTriangle(Uint32 a, Uint32 b, Uint32 c) {
+    float area = (_input[b]-_input[a]).cross(_input[c]-_input[a]);
+    if (fabsf(area) < 0.0000001f) {
+        return;
+    }
+    _output.push_back(a);
+    _output.push_back(b);
+    _output.push_back(c);
+}
+
+
+#pragma mark -
+#pragma mark Materialization
+/**
+ * Returns a list of indices representing the triangulation.
+ *
+ * The indices represent positions in the vertex list of the outer boundary
+ * followed by each hole.  If you have modified those lists, these indices
+ * may no longer be valid.
+ *
+ * The triangulator does not retain a reference to the returned list; it
+ * is safe to modify it.
+ *
+ * If the calculation is not yet performed, this method will return the
+ * empty list.
+ *
+ * @param buffer    The buffer to store the index data
+ *
+ * @return a list of indices representing the triangulation.
+ */
+std::vector<Uint32> MonotoneTriangulator::getTriangulation() {
+    std::vector<Uint32> result;
+    if (_calculated) {
+        result.assign(_output.begin(), _output.end());
+    }
+    return result;
+}
+
+/**
+ * Stores the triangulation indices in the given buffer.
+ *
+ * The indices represent positions in the vertex list of the outer boundary
+ * followed by each hole.  If you have modified those lists, these indices
+ * may no longer be valid.
+ *
+ * The indices will be appended to the provided vector. You should clear
+ * the vector first if you do not want to preserve the original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @return the number of elements added to the buffer
+ */
+size_t MonotoneTriangulator::getTriangulation(std::vector<Uint32>& buffer) {
+    if (_calculated) {
+        buffer.reserve(buffer.size()+_output.size());
+        std::copy(_output.begin(), _output.end(),std::back_inserter(buffer));
+        return _output.size();
+    }
+    return 0;
+}
+
+/**
+ * Returns a polygon representing the triangulation.
+ *
+ * The polygon contains the vertices of the outer boundary and every hole,
+ * together with the new indices defining a solid shape.  The triangulator
+ * does not maintain references to this polygon and it is safe to modify it.
+ *
+ * If the calculation is not yet performed, this method will return the
+ * empty polygon.
+ *
+ * @return a polygon representing the triangulation.
+ */
+Poly2 MonotoneTriangulator::getPolygon() {
+    Poly2 poly;
+    if (_calculated) {
+        poly._vertices = _input;
+        poly._indices  = _output;
+        poly._type = Poly2::Type::SOLID;
+        poly.computeBounds();
+    }
+    return poly;
+}
+
+/**
+ * Stores the triangulation in the given buffer.
+ *
+ * This method will add both the vertices (of the outer boundary and every
+ * hole), and the corresponding indices to the new buffer.  If the buffer
+ * is not empty, the indices will be adjusted accordingly. You should clear
+ * the buffer first if you do not want to preserve the original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @param buffer    The buffer to store the triangulated polygon
+ *
+ * @return a reference to the buffer for chaining.
+ */
+Poly2* MonotoneTriangulator::getPolygon(Poly2* buffer) {
+    CUAssertLog(buffer, "Destination buffer is null");
+    if (_calculated) {
+        if (buffer->_vertices.size() == 0) {
+            buffer->_vertices = _input;
+            buffer->_indices  = _output;
+        } else {
+            int offset = (int)buffer->_vertices.size();
+            buffer->_vertices.reserve(offset+_input.size());
+            std::copy(_input.begin(),_input.end(),std::back_inserter(buffer->_vertices));
+            
+            buffer->_indices.reserve(buffer->_indices.size()+_output.size());
+            for(auto it = _output.begin(); it != _output.end(); ++it) {
+                buffer->_indices.push_back(offset+*it);
+            }
+        }
+        buffer->_type = Poly2::Type::SOLID;
+        buffer->computeBounds();
+    }
+    return buffer;
+}
\ No newline at end of file
@@ -43,12 +43,18 @@
 
 #include <cugl/math/polygon/CUPathExtruder.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUThreadPool.h>
 #include <iterator>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 /** The number of segments to use in a rounded joint */
 #define JOINT_PRECISION 10
 /** The number of segments to use in a rounded cap */
 #define CAP_PRECISION   10
+/** The number of segments in each chunk of a parallel extrusion */
+#define PARALLEL_CHUNK  4096
 
 namespace cugl {
 
@@ -115,6 +121,54 @@ public:
     unsigned int ppos;
     /** The previous previous vertex index */
     unsigned int p2pos;
+    /** The buffer for the extruded vertices */
+    std::vector<Vec2>* verts;
+    /** The buffer for the extruded indices */
+    std::vector<Uint32>* indx;
+};
+    
+/**
+ * A range of segments extruded independently for a parallel extrusion
+ *
+ * Each chunk has its own buffers.  The indices in these buffers are relative
+ * to the chunk, and are adjusted when the chunks are stitched together.
+ */
+class ExtrusionChunk {
+public:
+    /** The first segment in the chunk */
+    unsigned int first;
+    /** The segment after the last one in the chunk */
+    unsigned int last;
+    /** The extruded vertices */
+    std::vector<Vec2> verts;
+    /** The extruded indices */
+    std::vector<Uint32> indx;
+    /** The algorithm state for this chunk */
+    KivyData data;
+};
+
+/**
+ * The shared state of a parallel extrusion
+ *
+ * Threads claim chunks with an atomic counter.  This state is shared with
+ * the tasks in the thread pool, so that a task that starts after all of the
+ * chunks are claimed can exit safely.
+ */
+class ExtrusionJob {
+public:
+    /** The chunks to extrude */
+    std::vector<ExtrusionChunk> chunks;
+    /** The next chunk to claim */
+    std::atomic<size_t> next;
+    /** The number of completed chunks */
+    size_t finished;
+    /** The mutex for the completed chunks */
+    std::mutex mutex;
+    /** The condition variable for the completed chunks */
+    std::condition_variable condition;
+    
+    /** Creates a job with no chunks */
+    ExtrusionJob() : next(0), finished(0) {}
 };
 }
 
@@ -167,62 +221,231 @@ void PathExtruder::set(const Poly2& poly) {
  *
  *      http://kivy.org/docs/_images/line-instruction.png
  *
+ * If the path is open, and the only change since the last calculation is
+ * points added with {@link append}, this method only extrudes the new
+ * segments.  It removes the old end caps, extends the path, and recreates
+ * the caps.  The stroke, joint, and cap must be the same as the last
+ * calculation.  This is the efficient way to extrude a growing path, such
+ * as a trail.
+ *
+ * If a thread pool is provided, and the path is long, then the path is split
+ * into chunks that are extruded in parallel.  This method still blocks until
+ * the extrusion is complete.
+ *
  * @param stroke    The stroke width of the extrusion
  * @param joint     The extrusion joint type.
  * @param cap       The extrusion cap type.
+ * @param pool      The thread pool for a parallel extrusion (optional)
  */
-void PathExtruder::calculate(float stroke, PathJoint joint, PathCap cap) {
+void PathExtruder::calculate(float stroke, PathJoint joint, PathCap cap,
+                             const std::shared_ptr<ThreadPool>& pool) {
     if (_input.size() == 0) {
         _calculated = true;
         return;
     }
-        _outverts.clear();
-    _outindx.clear();
     
     // Closed paths have no cap;
-    if (_closed && _input.size() > 2) {
+    bool closed = _closed && _input.size() > 2;
+    if (closed) {
         cap = PathCap::NONE;
     }
 
     // Determine how large the new polygon is
     unsigned int vcount, icount;
     unsigned int count = computeSize(joint, cap, &vcount, &icount);
-    _outverts.reserve(vcount*2);
-    _outindx.reserve(icount);
     
     // Thanks Kivy guys for all the hard work.
-    KivyData data;
+    KivyData data = KivyData();
     
-    // Initialize the data
-    data.stroke = stroke;
-    data.joint = joint;
-    data.cap = cap;
+    // Pick up where the last extrusion stopped if we only appended points
+    bool incremental = (_state != nullptr && !closed && _extruded >= 2 && _extruded <= count &&
+                        _stroke == stroke && _joint == joint && _cap == cap);
+    unsigned int first = 0;
+    if (incremental) {
+        // Remove the old caps
+        _outverts.resize(_capverts);
+        _outindx.resize(_capindx);
+        data = *_state;
+        first = (unsigned int)_extruded-1;
+    } else {
+        _outverts.clear();
+        _outindx.clear();
+        
+        // Initialize the data
+        data.stroke = stroke;
+        data.joint = joint;
+        data.cap = cap;
+    }
+    _outverts.reserve(vcount*2);
+    _outindx.reserve(icount);
+    data.verts = &_outverts;
+    data.indx  = &_outindx;
     
     // Iterate through the path
-    data.angle = data.sangle = 0;
-    data.pangle = data.pangle2 = 0;
-    data.pos = data.ppos = data.p2pos = 0;
-    int mod = (int)_input.size();
-    for(int ii = 0; ii < count-1; ii++) {
-        Vec2 a = _input[  ii   % mod];
-        Vec2 b = _input[(ii+1) % mod];
-        data.index = ii;
-        
-        makeSegment(a, b, &data);
-        makeJoint(a, &data);
+    if (!incremental && pool != nullptr && count > 2*PARALLEL_CHUNK) {
+        extrudeParallel(count, &data, pool);
+    } else {
+        extrudeRange(first, count-1, &data);
+    }
+    
+    // Save the state before the caps for the next extrusion
+    if (closed) {
+        _state = nullptr;
+    } else {
+        if (_state == nullptr || _state.use_count() > 1) {
+            _state = std::make_shared<KivyData>();
+        }
+        *_state = data;
+        _extruded = count;
+        _capverts = _outverts.size();
+        _capindx  = _outindx.size();
+        _stroke = stroke;
+        _joint  = joint;
+        _cap    = cap;
     }
     
     // Process the caps
     makeCaps(count, &data);
     
     // If closed, make one last joint
-    if (_closed && mod > 2) {
+    if (closed) {
         makeLastJoint(&data);
     }
     
     _calculated = true;
 }
 
+/**
+ * Extrudes the segments in the given range.
+ *
+ * Segment ii is the line segment from input point ii to the next one.  The
+ * joint at the start of each segment is created with the segment.  The new
+ * vertices and indices are appended to the buffers in data.
+ *
+ * @param first     The first segment to extrude
+ * @param last      The segment after the last one to extrude
+ * @param data      The data necessary to run the Kivy algorithm.
+ */
+void PathExtruder::extrudeRange(unsigned int first, unsigned int last, KivyData* data) {
+    unsigned int mod = (unsigned int)_input.size();
+    for(unsigned int ii = first; ii < last; ii++) {
+        Vec2 a = _input[  ii   % mod];
+        Vec2 b = _input[(ii+1) % mod];
+        data->index = ii;
+        
+        makeSegment(a, b, data);
+        makeJoint(a, data);
+    }
+}
+
+/**
+ * Extrudes the segments in the given range as an independent chunk.
+ *
+ * This method is the same as {@link extrudeRange}, except that it first
+ * extrudes the segment before the range (when there is one).  The joint
+ * at the start of the range needs this segment.  The extra four vertices
+ * and six indices are at the start of the buffers, and they are removed
+ * when the chunks are stitched together.
+ *
+ * @param first     The first segment to extrude
+ * @param last      The segment after the last one to extrude
+ * @param data      The data necessary to run the Kivy algorithm.
+ */
+void PathExtruder::extrudeChunk(unsigned int first, unsigned int last, KivyData* data) {
+    if (first > 0) {
+        unsigned int mod = (unsigned int)_input.size();
+        data->index = first-1;
+        makeSegment(_input[(first-1) % mod], _input[first % mod], data);
+    }
+    extrudeRange(first, last, data);
+}
+
+/**
+ * Extrudes all of the segments in parallel chunks.
+ *
+ * The segments are split into chunks which are extruded on the threads of
+ * the pool (and on the calling thread).  The chunks are then stitched
+ * together in order.  The result is identical to extruding the segments
+ * in a single pass.  This method blocks until all chunks are complete.
+ *
+ * @param count     The number of generating points in the path.
+ * @param data      The data necessary to run the Kivy algorithm.
+ * @param pool      The thread pool for the chunks
+ */
+void PathExtruder::extrudeParallel(unsigned int count, KivyData* data,
+                                   const std::shared_ptr<ThreadPool>& pool) {
+    unsigned int segments = count-1;
+    size_t amount = segments/PARALLEL_CHUNK;
+    
+    std::shared_ptr<ExtrusionJob> job = std::make_shared<ExtrusionJob>();
+    job->chunks.resize(amount);
+    for(size_t ii = 0; ii < amount; ii++) {
+        ExtrusionChunk* chunk = &(job->chunks[ii]);
+        chunk->first = (unsigned int)(ii*segments/amount);
+        chunk->last  = (unsigned int)((ii+1)*segments/amount);
+        chunk->data  = *data;
+        chunk->data.verts = &(chunk->verts);
+        chunk->data.indx  = &(chunk->indx);
+    }
+    
+    // The calling thread claims chunks too, so we never wait on an idle pool
+    auto work = [this,job]() {
+        size_t ii;
+        while ((ii = job->next++) < job->chunks.size()) {
+            ExtrusionChunk* chunk = &(job->chunks[ii]);
+            extrudeChunk(chunk->first, chunk->last, &(chunk->data));
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->finished++;
+            job->condition.notify_all();
+        }
+    };
+    for(size_t ii = 1; ii < amount; ii++) {
+        pool->addTask(work);
+    }
+    work();
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->condition.wait(lock, [&]() { return job->finished == amount; });
+    }
+    
+    // Stitch the chunks, replacing each copy of a previous segment with the original
+    Uint32 offset = 0;
+    Uint32 previous = 0;
+    auto remap = [&](size_t chunk, Uint32 local) {
+        if (chunk == 0) {
+            return local;
+        }
+        return local < 4 ? previous+local : offset+local-4;
+    };
+    for(size_t ii = 0; ii < amount; ii++) {
+        ExtrusionChunk* chunk = &(job->chunks[ii]);
+        size_t vskip = ii == 0 ? 0 : 4;
+        size_t iskip = ii == 0 ? 0 : 6;
+        offset = (Uint32)_outverts.size();
+        _outverts.insert(_outverts.end(), chunk->verts.begin()+vskip, chunk->verts.end());
+        for(auto it = chunk->indx.begin()+iskip; it != chunk->indx.end(); ++it) {
+            _outindx.push_back(remap(ii,*it));
+        }
+        
+        if (ii+1 == amount) {
+            // The caps need the state of the last chunk, and the start of the first
+            KivyData* start = &(job->chunks[0].data);
+            KivyData* last  = &(chunk->data);
+            last->s1 = start->s1;
+            last->s4 = start->s4;
+            last->sangle = start->sangle;
+            last->verts = data->verts;
+            last->indx  = data->indx;
+            last->pos   = (Uint32)_outverts.size();
+            last->ppos  = remap(ii,last->ppos);
+            last->p2pos = remap(ii,last->p2pos);
+            *data = *last;
+        } else {
+            previous = remap(ii,chunk->data.ppos);
+        }
+    }
+}
+
 /**
  * Computes the number of vertices and indices necessary for the extrusion.
  *
@@ -286,8 +509,8 @@ unsigned int PathExtruder::computeSize(PathJoint joint, PathCap cap,
 /**
  * Creates the extruded line segment from a to b.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param a     The start of the line segment
  * @param b     The end of the line segment.
@@ -324,26 +547,26 @@ void PathExtruder::makeSegment(const Vec2& a, const Vec2& b, KivyData* data) {
     }
     
     // Add the indices
-    _outindx.push_back(data->pos  );
-    _outindx.push_back(data->pos+1);
-    _outindx.push_back(data->pos+2);
-    _outindx.push_back(data->pos  );
-    _outindx.push_back(data->pos+2);
-    _outindx.push_back(data->pos+3);
+    data->indx->push_back(data->pos  );
+    data->indx->push_back(data->pos+1);
+    data->indx->push_back(data->pos+2);
+    data->indx->push_back(data->pos  );
+    data->indx->push_back(data->pos+2);
+    data->indx->push_back(data->pos+3);
     
     // Add the vertices
-    _outverts.push_back(data->v1);
-    _outverts.push_back(data->v2);
-    _outverts.push_back(data->v3);
-    _outverts.push_back(data->v4);
+    data->verts->push_back(data->v1);
+    data->verts->push_back(data->v2);
+    data->verts->push_back(data->v3);
+    data->verts->push_back(data->v4);
     data->pos += 4;
 }
 
 /**
  * Creates a joint immediately before point a.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param a         The generating point after the joint.
  * @param data      The data necessary to run the Kivy algorithm.
@@ -382,8 +605,8 @@ bool PathExtruder::makeJoint(const Vec2& a, KivyData* data) {
 /**
  * Creates a mitre joint immediately before point a.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param a         The generating point after the joint.
  * @param jangle    The joint angle
@@ -392,20 +615,20 @@ bool PathExtruder::makeJoint(const Vec2& a, KivyData* data) {
  * @return true if a joint was successfully created.
  */
 bool PathExtruder::makeMitreJoint(const Vec2& a, float jangle, KivyData* data) {
-    _outverts.push_back(a);
+    data->verts->push_back(a);
     
     // Indices depend on angle
     if (jangle < 0) {
         float s, t;
         if (Vec2::doesLineIntersect(data->p1, data->p2, data->v1, data->v2, &s,&t)) {
             Vec2 temp = data->p1 + s*(data->p2-data->p1);
-            _outverts.push_back(temp);
-            _outindx.push_back(data->pos    );
-            _outindx.push_back(data->pos+1  );
-            _outindx.push_back(data->p2pos+1);
-            _outindx.push_back(data->pos    );
-            _outindx.push_back(data->ppos   );
-            _outindx.push_back(data->pos+1  );
+            data->verts->push_back(temp);
+            data->indx->push_back(data->pos    );
+            data->indx->push_back(data->pos+1  );
+            data->indx->push_back(data->p2pos+1);
+            data->indx->push_back(data->pos    );
+            data->indx->push_back(data->ppos   );
+            data->indx->push_back(data->pos+1  );
             data->pos += 2;
             return true;
         }
@@ -413,13 +636,13 @@ bool PathExtruder::makeMitreJoint(const Vec2& a, float jangle, KivyData* data) {
         float s, t;
         if (Vec2::doesLineIntersect(data->p3, data->p4, data->v3, data->v4, &s, &t)) {
             Vec2 temp = data->p3 + s*(data->p4-data->p3);
-            _outverts.push_back(temp);
-            _outindx.push_back(data->pos    );
-            _outindx.push_back(data->pos+1  );
-            _outindx.push_back(data->p2pos+2);
-            _outindx.push_back(data->pos    );
-            _outindx.push_back(data->ppos+3 );
-            _outindx.push_back(data->pos+1  );
+            data->verts->push_back(temp);
+            data->indx->push_back(data->pos    );
+            data->indx->push_back(data->pos+1  );
+            data->indx->push_back(data->p2pos+2);
+            data->indx->push_back(data->pos    );
+            data->indx->push_back(data->ppos+3 );
+            data->indx->push_back(data->pos+1  );
             data->pos += 2;
             return true;
         }
@@ -430,8 +653,8 @@ bool PathExtruder::makeMitreJoint(const Vec2& a, float jangle, KivyData* data) {
 /**
  * Creates a bevel joint immediately before point a.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param a         The generating point after the joint.
  * @param jangle    The joint angle
@@ -440,17 +663,17 @@ bool PathExtruder::makeMitreJoint(const Vec2& a, float jangle, KivyData* data) {
  * @return true if a joint was successfully created.
  */
 bool PathExtruder::makeBevelJoint(const Vec2& a, float jangle, KivyData* data) {
-    _outverts.push_back(a);
+    data->verts->push_back(a);
 
     // Indices depend on angle
     if (jangle < 0) {
-        _outindx.push_back(data->p2pos+1);
-        _outindx.push_back(data->ppos   );
-        _outindx.push_back(data->pos    );
+        data->indx->push_back(data->p2pos+1);
+        data->indx->push_back(data->ppos   );
+        data->indx->push_back(data->pos    );
     } else {
-        _outindx.push_back(data->p2pos+2);
-        _outindx.push_back(data->ppos +3);
-        _outindx.push_back(data->pos    );
+        data->indx->push_back(data->p2pos+2);
+        data->indx->push_back(data->ppos +3);
+        data->indx->push_back(data->pos    );
     }
     data->pos += 1;
     return true;
@@ -459,8 +682,8 @@ bool PathExtruder::makeBevelJoint(const Vec2& a, float jangle, KivyData* data) {
 /**
  * Creates a round joint immediately before point a.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param a         The generating point after the joint.
  * @param jangle    The joint angle
@@ -485,34 +708,34 @@ bool PathExtruder::makeRoundJoint(const Vec2& a, float jangle, KivyData* data) {
     }
     
     unsigned int opos = data->pos;
-    _outverts.push_back(a);
+    data->verts->push_back(a);
     data->pos += 1;
     for(int j = 0; j <  JOINT_PRECISION - 1; j++) {
-        _outverts.push_back(a-Vec2(cos(a0 - step * j) * data->stroke,
+        data->verts->push_back(a-Vec2(cos(a0 - step * j) * data->stroke,
                                    sin(a0 - step * j) * data->stroke));
         if (j == 0) {
-            _outindx.push_back(opos );
-            _outindx.push_back(s_pos);
-            _outindx.push_back(data->pos);
+            data->indx->push_back(opos );
+            data->indx->push_back(s_pos);
+            data->indx->push_back(data->pos);
         } else {
-            _outindx.push_back(opos );
-            _outindx.push_back(data->pos-1);
-            _outindx.push_back(data->pos);
+            data->indx->push_back(opos );
+            data->indx->push_back(data->pos-1);
+            data->indx->push_back(data->pos);
         }
         data->pos += 1;
     }
     
-    _outindx.push_back(opos );
-    _outindx.push_back(data->pos-1);
-    _outindx.push_back(e_pos);
+    data->indx->push_back(opos );
+    data->indx->push_back(data->pos-1);
+    data->indx->push_back(e_pos);
     return true;
 }
 
 /**
  * Creates the caps on the two ends of the open path.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param count     The number of generating points in the path.
  * @param data      The data necessary to run the Kivy algorithm.
@@ -536,8 +759,8 @@ void PathExtruder::makeCaps(int count, KivyData* data) {
 /**
  * Creates square caps on the two ends of the open path.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param count     The number of generating points in the path.
  * @param data      The data necessary to run the Kivy algorithm.
@@ -548,35 +771,35 @@ void PathExtruder::makeSquareCaps(int count, KivyData* data) {
     // cap end
     Vec2 temp = Vec2(cos(data->angle) * data->stroke,
                      sin(data->angle) * data->stroke);
-    _outverts.push_back(data->v2+temp);
-    _outverts.push_back(data->v3+temp);
-    _outindx.push_back(data->ppos + 1);
-    _outindx.push_back(data->ppos + 2);
-    _outindx.push_back(data->pos  + 1);
-    _outindx.push_back(data->ppos + 1);
-    _outindx.push_back(data->pos);
-    _outindx.push_back(data->pos + 1);
+    data->verts->push_back(data->v2+temp);
+    data->verts->push_back(data->v3+temp);
+    data->indx->push_back(data->ppos + 1);
+    data->indx->push_back(data->ppos + 2);
+    data->indx->push_back(data->pos  + 1);
+    data->indx->push_back(data->ppos + 1);
+    data->indx->push_back(data->pos);
+    data->indx->push_back(data->pos + 1);
     data->pos += 2;
     
     // cap start
     temp = Vec2(cos(data->sangle) * data->stroke,
                 sin(data->sangle) * data->stroke);
-    _outverts.push_back(data->s1-temp);
-    _outverts.push_back(data->s4-temp);
-    _outindx.push_back(0);
-    _outindx.push_back(3);
-    _outindx.push_back(data->pos + 1 );
-    _outindx.push_back(0);
-    _outindx.push_back(data->pos);
-    _outindx.push_back(data->pos + 1 );
+    data->verts->push_back(data->s1-temp);
+    data->verts->push_back(data->s4-temp);
+    data->indx->push_back(0);
+    data->indx->push_back(3);
+    data->indx->push_back(data->pos + 1 );
+    data->indx->push_back(0);
+    data->indx->push_back(data->pos);
+    data->indx->push_back(data->pos + 1 );
     data->pos += 2;
 }
 
 /**
  * Creates round caps on the two ends of the open path.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param count     The number of generating points in the path.
  * @param data      The data necessary to run the Kivy algorithm.
@@ -590,27 +813,27 @@ void PathExtruder::makeRoundCaps(int count, KivyData* data) {
     float step = (a1 - a2) / (float)CAP_PRECISION;
     unsigned int opos = data->pos;
     data->c = _input[0];
-    _outverts.push_back(data->c);
+    data->verts->push_back(data->c);
     data->pos += 1;
     for(int i = 0; i < CAP_PRECISION - 1; i++) {
         Vec2 temp = Vec2(cos(a1 + step * i) * data->stroke,
                          sin(a1 + step * i) * data->stroke);
-        _outverts.push_back(data->c+temp);
+        data->verts->push_back(data->c+temp);
         if (i == 0) {
-            _outindx.push_back(opos);
-            _outindx.push_back(0);
-            _outindx.push_back(data->pos);
+            data->indx->push_back(opos);
+            data->indx->push_back(0);
+            data->indx->push_back(data->pos);
         } else {
-            _outindx.push_back(opos);
-            _outindx.push_back(data->pos-1);
-            _outindx.push_back(data->pos);
+            data->indx->push_back(opos);
+            data->indx->push_back(data->pos-1);
+            data->indx->push_back(data->pos);
         }
         data->pos += 1;
     }
     
-    _outindx.push_back(opos );
-    _outindx.push_back(data->pos-1);
-    _outindx.push_back(3);
+    data->indx->push_back(opos );
+    data->indx->push_back(data->pos-1);
+    data->indx->push_back(3);
     
     // cap end
     a1 = data->angle - M_PI_2;
@@ -618,33 +841,33 @@ void PathExtruder::makeRoundCaps(int count, KivyData* data) {
     step = (a2 - a1) / (float)CAP_PRECISION;
     opos = data->pos;
     data->c = _input[count-1];
-    _outverts.push_back(data->c);
+    data->verts->push_back(data->c);
     data->pos += 1;
     for(int i = 0; i < CAP_PRECISION - 1; i++) {
         Vec2 temp =  Vec2(cos(a1 + step * i) * data->stroke,
                           sin(a1 + step * i) * data->stroke);
-        _outverts.push_back(data->c+temp);
+        data->verts->push_back(data->c+temp);
         if (i == 0) {
-            _outindx.push_back(opos  );
-            _outindx.push_back(data->ppos+1);
-            _outindx.push_back(data->pos);
+            data->indx->push_back(opos  );
+            data->indx->push_back(data->ppos+1);
+            data->indx->push_back(data->pos);
         } else {
-            _outindx.push_back(opos );
-            _outindx.push_back(data->pos-1);
-            _outindx.push_back(data->pos);
+            data->indx->push_back(opos );
+            data->indx->push_back(data->pos-1);
+            data->indx->push_back(data->pos);
         }
         data->pos += 1;
     }
-    _outindx.push_back(opos);
-    _outindx.push_back(data->pos-1);
-    _outindx.push_back(data->ppos+2);
+    data->indx->push_back(opos);
+    data->indx->push_back(data->pos-1);
+    data->indx->push_back(data->ppos+2);
 }
 
 /**
  * Creates the final joint at the end of a closed path.
  *
- * The new vertices are appended to _outvert, while the new _indices are
- * appended to _outindx.
+ * The new vertices are appended to the vertex buffer of data, while the
+ * new indices are appended to its index buffer.
  *
  * @param data      The data necessary to run the Kivy algorithm.
  *
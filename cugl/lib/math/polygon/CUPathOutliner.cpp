@@ -68,7 +68,7 @@ void PathOutliner::calculate(PathTraversal traversal) {
         }
         case PathTraversal::INTERIOR:
         {
-            std::vector<unsigned short> indx;
+            std::vector<Uint32> indx;
             _triangulator.set(_input);
             _triangulator.calculate();
             _triangulator.getTriangulation(indx);
@@ -108,8 +108,8 @@ void PathOutliner::calculate(PathTraversal traversal) {
  * @return a list of indices representing the path outline.
  */
 
-std::vector<unsigned short> PathOutliner::getPath() {
-    std::vector<unsigned short> result;
+std::vector<Uint32> PathOutliner::getPath() {
+    std::vector<Uint32> result;
     if (_calculated) {
         result.assign(_output.begin(), _output.end());
     }
@@ -129,7 +129,7 @@ std::vector<unsigned short> PathOutliner::getPath() {
  *
  * @return the number of elements added to the buffer
  */
-size_t PathOutliner::getPath(std::vector<unsigned short>& buffer) {
+size_t PathOutliner::getPath(std::vector<Uint32>& buffer) {
     if (_calculated) {
         buffer.reserve(buffer.size()+_output.size());
         std::copy(_output.begin(), _output.end(),std::back_inserter(buffer));
@@ -0,0 +1,1255 @@
+//
+//  CUPolyClipper.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for performing boolean operations (union,
+//  intersection, difference) and offsets on polygon outlines.  The factory
+//  maintains a shape, and each operation modifies that shape in place.  This
+//  makes it suitable for destructible terrain or fog-of-war, where a large
+//  shape is repeatedly edited by small ones.
+//
+//  The algorithm is a variation of Martinez-Rueda clipping on a snapping grid.
+//  First, all of the edges are split at their intersections (rounding the new
+//  vertices to the grid), and identical edges are merged. Next, a sweep line
+//  computes the winding number of each operand on either side of every edge.
+//  An edge is on the boundary of the result if the operation gives different
+//  answers on its two sides.  Finally, those edges are linked into contours.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+
+#include <cugl/math/polygon/CUPolyClipper.h>
+#include <cugl/math/polygon/CUMonotoneTriangulator.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <set>
+
+/** The maximum absolute value of a grid coordinate */
+#define MAX_COORDINATE      (((Sint64)1) << 30)
+/** The maximum number of passes to resolve intersections created by rounding */
+#define MAX_SPLIT_PASSES    8
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Clipping Data
+/**
+ * A point on the snapping grid.
+ *
+ * Points are ordered lexicographically, first by x and then by y.  This is
+ * the order of the sweep line.
+ */
+class ClipPoint {
+public:
+    /** The x-coordinate, in grid units */
+    Sint64 x;
+    /** The y-coordinate, in grid units */
+    Sint64 y;
+
+    /** Creates the origin */
+    ClipPoint() : x(0), y(0) {}
+
+    /** Creates the point (x,y) */
+    ClipPoint(Sint64 x, Sint64 y) : x(x), y(y) {}
+
+    /** Returns true if this point is equal to p */
+    bool operator==(const ClipPoint& p) const { return x == p.x && y == p.y; }
+
+    /** Returns true if this point is not equal to p */
+    bool operator!=(const ClipPoint& p) const { return x != p.x || y != p.y; }
+
+    /** Returns true if this point is before p in the sweep order */
+    bool operator<(const ClipPoint& p) const { return x < p.x || (x == p.x && y < p.y); }
+};
+
+/**
+ * An edge segment in the clipping calculation.
+ *
+ * A segment is always stored with its endpoints in sweep order.  The winding
+ * deltas record the original direction of the edge in each operand. A delta
+ * of +1 means the edge went from a to b, while -1 means the edge went from b
+ * to a.  Merged edges add their deltas together.  Hence the winding number of
+ * each operand above the segment is the winding number below plus the delta.
+ */
+class ClipSegment {
+public:
+    /** The first endpoint in sweep order */
+    ClipPoint a;
+    /** The second endpoint in sweep order */
+    ClipPoint b;
+    /** The winding delta of the shape */
+    int shape;
+    /** The winding delta of the clip polygon */
+    int clip;
+    /** The shape winding number below this segment */
+    int below;
+    /** The clip winding number below this segment */
+    int clipBelow;
+
+    /** Creates a degenerate segment at the origin */
+    ClipSegment() : shape(0), clip(0), below(0), clipBelow(0) {}
+
+    /**
+     * Creates a segment for the directed edge from p to q
+     *
+     * @param p         The edge start
+     * @param q         The edge end
+     * @param isClip    Whether the edge belongs to the clip polygon
+     */
+    ClipSegment(const ClipPoint& p, const ClipPoint& q, bool isClip) :
+    below(0), clipBelow(0) {
+        int delta = 1;
+        if (p < q) {
+            a = p; b = q;
+        } else {
+            a = q; b = p;
+            delta = -1;
+        }
+        shape = isClip ? 0 : delta;
+        clip  = isClip ? delta : 0;
+    }
+};
+
+/**
+ * A directed chain of edges to link into contours
+ *
+ * Most chains are a single edge of the result.  However, in an incremental
+ * operation, each run of consecutive shape edges outside of the clipping slab
+ * is a single chain.  These runs are unchanged, so there is no reason to link
+ * them one edge at a time.  The interior points of the chain are stored in a
+ * separate buffer.
+ */
+class ClipChain {
+public:
+    /** The first point of the chain */
+    ClipPoint start;
+    /** The second point of the chain (for the outgoing direction) */
+    ClipPoint head;
+    /** The second to last point of the chain (for the incoming direction) */
+    ClipPoint tail;
+    /** The last point of the chain */
+    ClipPoint end;
+    /** The position of the first interior point in the buffer */
+    size_t first;
+    /** The number of interior points */
+    size_t count;
+
+    /**
+     * Creates a chain for the directed edge from p to q
+     *
+     * @param p     The edge start
+     * @param q     The edge end
+     * @param pos   The position of any future interior points
+     */
+    ClipChain(const ClipPoint& p, const ClipPoint& q, size_t pos=0) :
+    start(p), head(q), tail(p), end(q), first(pos), count(0) {}
+};
+
+/**
+ * Returns twice the signed area of the triangle abc
+ *
+ * The value is positive if c is to the left of the line from a to b, and
+ * negative if it is to the right.  As the coordinates are less than 2^30,
+ * this computation is exact.
+ *
+ * @param a     The first point
+ * @param b     The second point
+ * @param c     The third point
+ *
+ * @return twice the signed area of the triangle abc
+ */
+static inline Sint64 orient(const ClipPoint& a, const ClipPoint& b, const ClipPoint& c) {
+    return (b.x-a.x)*(c.y-a.y)-(b.y-a.y)*(c.x-a.x);
+}
+
+/**
+ * Returns true if p is strictly between the endpoints of s in sweep order
+ *
+ * If p is on the line through s, this means that p is in the interior of s.
+ *
+ * @param s     The segment
+ * @param p     The point to test
+ *
+ * @return true if p is strictly between the endpoints of s in sweep order
+ */
+static inline bool between(const ClipSegment& s, const ClipPoint& p) {
+    return s.a < p && p < s.b;
+}
+
+/**
+ * Returns true if the given operation includes the region with these windings
+ *
+ * The windings are interpreted with the nonzero fill rule.
+ *
+ * @param op    The boolean operation
+ * @param shape The shape winding number
+ * @param clip  The clip winding number
+ *
+ * @return true if the given operation includes the region with these windings
+ */
+static inline bool contains(PolyClipper::Operation op, int shape, int clip) {
+    bool a = shape != 0;
+    bool b = clip  != 0;
+    switch (op) {
+        case PolyClipper::Operation::UNION:
+            return a || b;
+        case PolyClipper::Operation::INTERSECTION:
+            return a && b;
+        case PolyClipper::Operation::DIFFERENCE:
+            return a && !b;
+        case PolyClipper::Operation::XOR:
+            return a != b;
+    }
+    return false;
+}
+
+/**
+ * The status order of the sweep line.
+ *
+ * Segments are ordered from bottom to top.  This order is only well-defined
+ * for segments that do not cross, and are active at the same time.
+ */
+class SegmentOrder {
+public:
+    /** The segments being ordered */
+    const std::vector<ClipSegment>* segments;
+
+    /**
+     * Creates an order for the given segments
+     *
+     * @param segs  The segments being ordered
+     */
+    SegmentOrder(const std::vector<ClipSegment>* segs) : segments(segs) {}
+
+    /**
+     * Returns true if segment s is below segment t
+     *
+     * @param s     The first segment index
+     * @param t     The second segment index
+     *
+     * @return true if segment s is below segment t
+     */
+    bool operator()(size_t s, size_t t) const {
+        if (s == t) {
+            return false;
+        }
+        const ClipSegment& ss = segments->at(s);
+        const ClipSegment& ts = segments->at(t);
+        Sint64 side;
+        if (ss.a == ts.a) {
+            side = orient(ss.a, ss.b, ts.b);
+            return side != 0 ? side > 0 : s < t;
+        } else if (ss.a < ts.a) {
+            side = orient(ss.a, ss.b, ts.a);
+            if (side == 0) {
+                side = orient(ss.a, ss.b, ts.b);
+            }
+            return side != 0 ? side > 0 : s < t;
+        }
+        side = orient(ts.a, ts.b, ss.a);
+        if (side == 0) {
+            side = orient(ts.a, ts.b, ss.b);
+        }
+        return side != 0 ? side < 0 : s < t;
+    }
+};
+
+
+#pragma mark -
+#pragma mark Clipping Phases
+/**
+ * Records the split points of a pair of segments
+ *
+ * Segments are split where they cross, where an endpoint of one lies in
+ * the interior of the other, and where they overlap.  Crossing points are
+ * rounded to the snapping grid.
+ *
+ * @param segs      The segments
+ * @param s         The first segment index
+ * @param t         The second segment index
+ * @param splits    The buffer to store the (segment, point) splits
+ */
+static void split_pair(const std::vector<ClipSegment>& segs, size_t s, size_t t,
+                       std::vector<std::pair<size_t,ClipPoint>>& splits) {
+    const ClipSegment& ss = segs[s];
+    const ClipSegment& ts = segs[t];
+    if (std::max(ss.a.y,ss.b.y) < std::min(ts.a.y,ts.b.y) ||
+        std::max(ts.a.y,ts.b.y) < std::min(ss.a.y,ss.b.y)) {
+        return;
+    }
+
+    Sint64 o1 = orient(ss.a, ss.b, ts.a);
+    Sint64 o2 = orient(ss.a, ss.b, ts.b);
+    Sint64 o3 = orient(ts.a, ts.b, ss.a);
+    Sint64 o4 = orient(ts.a, ts.b, ss.b);
+
+    // Touching and overlapping segments
+    if (o1 == 0 && between(ss,ts.a)) { splits.push_back(std::make_pair(s,ts.a)); }
+    if (o2 == 0 && between(ss,ts.b)) { splits.push_back(std::make_pair(s,ts.b)); }
+    if (o3 == 0 && between(ts,ss.a)) { splits.push_back(std::make_pair(t,ss.a)); }
+    if (o4 == 0 && between(ts,ss.b)) { splits.push_back(std::make_pair(t,ss.b)); }
+
+    // Proper crossings
+    if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) &&
+        ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0))) {
+        double rx = (double)(ss.b.x-ss.a.x);
+        double ry = (double)(ss.b.y-ss.a.y);
+        double param = (double)o3/(double)(o3-o4);
+        ClipPoint p((Sint64)std::llround(ss.a.x+param*rx),(Sint64)std::llround(ss.a.y+param*ry));
+        bool inside1 = between(ss,p);
+        bool inside2 = between(ts,p);
+        if (inside1) { splits.push_back(std::make_pair(s,p)); }
+        if (inside2) { splits.push_back(std::make_pair(t,p)); }
+
+        // If the crossing rounds past an endpoint, route the other segment through it
+        if (!inside1) {
+            const ClipPoint& q = (p < ss.b ? ss.a : ss.b);
+            if (between(ts,q)) { splits.push_back(std::make_pair(t,q)); }
+        }
+        if (!inside2) {
+            const ClipPoint& q = (p < ts.b ? ts.a : ts.b);
+            if (between(ss,q)) { splits.push_back(std::make_pair(s,q)); }
+        }
+    }
+}
+
+/**
+ * Splits the segments so that no two segments cross
+ *
+ * This uses a sort-and-sweep on the x-intervals of the segments to find
+ * candidate pairs.  As rounding the crossing points can create new crossings,
+ * this process is repeated until no more splits are necessary (or we reach
+ * MAX_SPLIT_PASSES).
+ *
+ * @param segs      The segments to split
+ */
+static void split_segments(std::vector<ClipSegment>& segs) {
+    std::vector<std::pair<size_t,ClipPoint>> splits;
+    std::vector<size_t> order;
+    std::vector<size_t> active;
+    for(int pass = 0; pass < MAX_SPLIT_PASSES; pass++) {
+        order.resize(segs.size());
+        for(size_t ii = 0; ii < order.size(); ii++) {
+            order[ii] = ii;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t s, size_t t) {
+            return segs[s].a.x < segs[t].a.x;
+        });
+
+        splits.clear();
+        active.clear();
+        for(auto it = order.begin(); it != order.end(); ++it) {
+            const ClipSegment& seg = segs[*it];
+            size_t keep = 0;
+            for(size_t jj = 0; jj < active.size(); jj++) {
+                if (segs[active[jj]].b.x >= seg.a.x) {
+                    active[keep++] = active[jj];
+                    split_pair(segs, active[jj], *it, splits);
+                }
+            }
+            active.resize(keep);
+            active.push_back(*it);
+        }
+        if (splits.empty()) {
+            return;
+        }
+
+        // Sort the splits along each segment
+        std::sort(splits.begin(), splits.end(), [](const std::pair<size_t,ClipPoint>& p,
+                                                   const std::pair<size_t,ClipPoint>& q) {
+            return p.first < q.first || (p.first == q.first && p.second < q.second);
+        });
+
+        size_t size = segs.size();
+        auto pos = splits.begin();
+        for(size_t ii = 0; ii < size; ii++) {
+            if (pos == splits.end() || pos->first != ii) {
+                continue;
+            }
+            ClipSegment seg = segs[ii];
+            ClipPoint last = seg.a;
+            bool first = true;
+            for(; pos != splits.end() && pos->first == ii; ++pos) {
+                if (pos->second == last) {
+                    continue;
+                }
+                ClipSegment piece = seg;
+                piece.a = last;
+                piece.b = pos->second;
+                if (first) {
+                    segs[ii] = piece;
+                    first = false;
+                } else {
+                    segs.push_back(piece);
+                }
+                last = pos->second;
+            }
+            seg.a = last;
+            segs.push_back(seg);
+        }
+    }
+}
+
+/**
+ * Merges identical segments, removing any that cancel out.
+ *
+ * @param segs      The segments to merge
+ */
+static void merge_segments(std::vector<ClipSegment>& segs) {
+    std::sort(segs.begin(), segs.end(), [](const ClipSegment& s, const ClipSegment& t) {
+        return s.a < t.a || (s.a == t.a && s.b < t.b);
+    });
+    size_t keep = 0;
+    for(size_t ii = 0; ii < segs.size(); ) {
+        ClipSegment seg = segs[ii++];
+        while (ii < segs.size() && segs[ii].a == seg.a && segs[ii].b == seg.b) {
+            seg.shape += segs[ii].shape;
+            seg.clip  += segs[ii].clip;
+            ii++;
+        }
+        if (seg.shape != 0 || seg.clip != 0) {
+            segs[keep++] = seg;
+        }
+    }
+    segs.resize(keep);
+}
+
+/**
+ * Computes the winding numbers below each segment with a sweep line
+ *
+ * The segments must not cross.  The shape is always the result of a previous
+ * operation, so its winding number is 1 to the left of a shape edge and 0 to
+ * the right.  Hence we only need the sweep for the shape winding below the
+ * edges of the clip polygon.  For that, the sweep must contain every shape
+ * edge crossing the vertical line through the start of each clip edge.
+ *
+ * @param segs      The segments to sweep
+ */
+static void sweep_segments(std::vector<ClipSegment>& segs) {
+    // Events are 2*index for insertion and 2*index+1 for removal
+    std::vector<size_t> events(2*segs.size());
+    for(size_t ii = 0; ii < events.size(); ii++) {
+        events[ii] = ii;
+    }
+    std::sort(events.begin(), events.end(), [&](size_t e, size_t f) {
+        const ClipSegment& es = segs[e/2];
+        const ClipSegment& fs = segs[f/2];
+        const ClipPoint& p = (e & 1) ? es.b : es.a;
+        const ClipPoint& q = (f & 1) ? fs.b : fs.a;
+        if (p != q) {
+            return p < q;
+        } else if ((e & 1) != (f & 1)) {
+            return (e & 1) == 1;
+        } else if ((e & 1) == 1) {
+            return e < f;
+        }
+        // Insert from bottom to top
+        Sint64 side = orient(p, es.b, fs.b);
+        return side != 0 ? side > 0 : e < f;
+    });
+
+    SegmentOrder order(&segs);
+    std::set<size_t,SegmentOrder> status(order);
+    std::vector<std::set<size_t,SegmentOrder>::iterator> positions(segs.size());
+    for(auto it = events.begin(); it != events.end(); ++it) {
+        size_t index = *it/2;
+        if (*it & 1) {
+            status.erase(positions[index]);
+            continue;
+        }
+
+        auto pos = status.insert(index).first;
+        positions[index] = pos;
+        ClipSegment& seg = segs[index];
+        if (pos == status.begin()) {
+            seg.below = 0;
+            seg.clipBelow = 0;
+        } else {
+            const ClipSegment& prev = segs[*std::prev(pos)];
+            seg.below = prev.below+prev.shape;
+            seg.clipBelow = prev.clipBelow+prev.clip;
+        }
+        if (seg.shape != 0) {
+            seg.below = seg.shape > 0 ? 0 : 1;
+        }
+    }
+}
+
+/**
+ * Stores the given contour in the shape buffers
+ *
+ * This method removes collinear vertices (and zero-width spikes) from the
+ * contour.  Contours with fewer than three vertices are discarded.
+ *
+ * @param loop      The contour vertices
+ * @param points    The interleaved point buffer
+ * @param starts    The contour start buffer
+ * @param bounds    The contour bounds buffer
+ */
+static void store_contour(std::vector<ClipPoint>& loop, std::vector<Sint64>& points,
+                          std::vector<Uint32>& starts, std::vector<Sint64>& bounds) {
+    // Remove collinear vertices with a stack
+    size_t top = 0;
+    for(size_t ii = 0; ii < loop.size(); ii++) {
+        while (top >= 2 && orient(loop[top-2],loop[top-1],loop[ii]) == 0) {
+            top--;
+        }
+        loop[top++] = loop[ii];
+    }
+    loop.resize(top);
+
+    // Now check the wrap-around
+    size_t first = 0;
+    bool changed = true;
+    while (changed && loop.size()-first >= 3) {
+        changed = false;
+        size_t size = loop.size();
+        if (orient(loop[size-2],loop[size-1],loop[first]) == 0) {
+            loop.pop_back();
+            changed = true;
+        } else if (orient(loop[size-1],loop[first],loop[first+1]) == 0) {
+            first++;
+            changed = true;
+        }
+    }
+    if (loop.size()-first < 3) {
+        return;
+    }
+
+    Sint64 minx = std::numeric_limits<Sint64>::max();
+    Sint64 miny = minx;
+    Sint64 maxx = std::numeric_limits<Sint64>::min();
+    Sint64 maxy = maxx;
+    for(size_t ii = first; ii < loop.size(); ii++) {
+        points.push_back(loop[ii].x);
+        points.push_back(loop[ii].y);
+        minx = std::min(minx,loop[ii].x);
+        miny = std::min(miny,loop[ii].y);
+        maxx = std::max(maxx,loop[ii].x);
+        maxy = std::max(maxy,loop[ii].y);
+    }
+    starts.push_back((Uint32)(points.size()/2));
+    bounds.push_back(minx);
+    bounds.push_back(miny);
+    bounds.push_back(maxx);
+    bounds.push_back(maxy);
+}
+
+/**
+ * Links the directed chains into contours
+ *
+ * The interior of the result is to the left of each chain.  At a vertex with
+ * several outgoing chains, we take the first chain clockwise from the incoming
+ * one.  This keeps the interior on the left and separates contours that only
+ * touch at a vertex.
+ *
+ * @param chains    The directed chains
+ * @param interior  The interior points of the chains
+ * @param points    The interleaved point buffer
+ * @param starts    The contour start buffer
+ * @param bounds    The contour bounds buffer
+ */
+static void link_chains(const std::vector<ClipChain>& chains, const std::vector<ClipPoint>& interior,
+                        std::vector<Sint64>& points, std::vector<Uint32>& starts,
+                        std::vector<Sint64>& bounds) {
+    size_t count = chains.size();
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<ClipPoint> verts;
+    verts.reserve(count);
+    for(auto it = chains.begin(); it != chains.end(); ++it) {
+        verts.push_back(it->start);
+    }
+    std::sort(verts.begin(), verts.end());
+    verts.erase(std::unique(verts.begin(), verts.end()), verts.end());
+
+    // Group the chains by their starting vertex
+    std::vector<Uint32> offsets(verts.size()+1,0);
+    std::vector<Uint32> source(count);
+    for(size_t ii = 0; ii < count; ii++) {
+        source[ii] = (Uint32)(std::lower_bound(verts.begin(), verts.end(), chains[ii].start)-verts.begin());
+        offsets[source[ii]+1]++;
+    }
+    for(size_t ii = 1; ii < offsets.size(); ii++) {
+        offsets[ii] += offsets[ii-1];
+    }
+    std::vector<Uint32> outgoing(count);
+    std::vector<Uint32> fill(offsets.begin(), offsets.end()-1);
+    for(size_t ii = 0; ii < count; ii++) {
+        outgoing[fill[source[ii]]++] = (Uint32)ii;
+    }
+
+    std::vector<bool> used(count,false);
+    std::vector<ClipPoint> loop;
+    for(size_t start = 0; start < count; start++) {
+        if (used[start]) {
+            continue;
+        }
+        loop.clear();
+        size_t curr = start;
+        while (!used[curr]) {
+            used[curr] = true;
+            const ClipChain& chain = chains[curr];
+            loop.push_back(chain.start);
+            loop.insert(loop.end(), interior.begin()+chain.first, interior.begin()+chain.first+chain.count);
+
+            auto vert = std::lower_bound(verts.begin(), verts.end(), chain.end);
+            if (vert == verts.end() || *vert != chain.end) {
+                break;
+            }
+            size_t vidx = vert-verts.begin();
+            if (offsets[vidx+1]-offsets[vidx] == 1) {
+                curr = outgoing[offsets[vidx]];
+                continue;
+            }
+
+            // Choose the first unused chain clockwise from the reverse direction
+            const ClipPoint& pivot = chain.end;
+            double back = std::atan2((double)(chain.tail.y-pivot.y),(double)(chain.tail.x-pivot.x));
+            double best = 4*M_PI;
+            size_t next = curr;
+            for(Uint32 jj = offsets[vidx]; jj < offsets[vidx+1]; jj++) {
+                size_t cand = outgoing[jj];
+                if (used[cand] && cand != start) {
+                    continue;
+                }
+                const ClipPoint& dest = chains[cand].head;
+                double angle = back-std::atan2((double)(dest.y-pivot.y),(double)(dest.x-pivot.x));
+                while (angle <= 0) {
+                    angle += 2*M_PI;
+                }
+                if (angle < best) {
+                    best = angle;
+                    next = cand;
+                }
+            }
+            curr = next;
+        }
+        store_contour(loop, points, starts, bounds);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Initialization
+/**
+ * Sets the shape of this clipper to the given contour.
+ *
+ * The contour may be in either orientation, and may intersect itself.
+ * The vertex data is copied. The clipper does not retain any references
+ * to the original data.
+ *
+ * @param points    The contour vertices
+ */
+void PolyClipper::set(const std::vector<Vec2>& points) {
+    clear();
+    std::vector<Sint64> edges;
+    gather(points, edges);
+    apply(Operation::UNION, edges, false);
+}
+
+/**
+ * Sets the shape of this clipper to the given polygon.
+ *
+ * If the polygon is solid, the shape is the union of its triangles. If
+ * it is a path, the index pairs are the contour edges.  Otherwise, the
+ * vertices are treated as a single contour.  The vertex data is copied.
+ * The clipper does not retain any references to the original data.
+ *
+ * @param poly      The polygon for the shape
+ */
+void PolyClipper::set(const Poly2& poly) {
+    clear();
+    std::vector<Sint64> edges;
+    gather(poly, edges);
+    apply(Operation::UNION, edges, false);
+}
+
+/**
+ * Sets the shape of this clipper to the given contours.
+ *
+ * The contours are interpreted with the nonzero fill rule.  Hence holes
+ * must have the opposite orientation of their boundary.  The vertex data
+ * is copied. The clipper does not retain any references to the original
+ * data.
+ *
+ * @param contours  The shape contours
+ */
+void PolyClipper::set(const std::vector<std::vector<Vec2>>& contours) {
+    clear();
+    std::vector<Sint64> edges;
+    for(auto it = contours.begin(); it != contours.end(); ++it) {
+        gather(*it, edges);
+    }
+    apply(Operation::UNION, edges, false);
+}
+
+
+#pragma mark -
+#pragma mark Calculation
+/**
+ * Applies the boolean operation with the given clip contour to the shape
+ *
+ * The contour may be in either orientation, and may intersect itself.
+ * The shape is the first operand of the operation.
+ *
+ * @param op        The boolean operation
+ * @param clip      The clip contour
+ */
+void PolyClipper::calculate(Operation op, const std::vector<Vec2>& clip) {
+    std::vector<Sint64> edges;
+    gather(clip, edges);
+    apply(op, edges, _incremental);
+}
+
+/**
+ * Applies the boolean operation with the given clip polygon to the shape
+ *
+ * The clip polygon is interpreted just as in {@link #set}. The shape is
+ * the first operand of the operation.
+ *
+ * @param op        The boolean operation
+ * @param clip      The clip polygon
+ */
+void PolyClipper::calculate(Operation op, const Poly2& clip) {
+    std::vector<Sint64> edges;
+    gather(clip, edges);
+    apply(op, edges, _incremental);
+}
+
+/**
+ * Offsets the boundary of the shape by the given distance
+ *
+ * A positive distance grows the shape, while a negative one shrinks it.
+ * The offset has rounded corners, approximated by line segments so that
+ * the error is at most tolerance.  This operation always processes the
+ * entire shape.
+ *
+ * @param distance  The offset distance
+ * @param tolerance The error tolerance of the rounded corners
+ */
+void PolyClipper::offset(float distance, float tolerance) {
+    float radius = std::fabs(distance);
+    if (radius*_resolution < 0.5f || _starts.size() < 2) {
+        return;
+    }
+
+    // The angle spanned by each segment of a rounded corner
+    float step = (float)M_PI_2;
+    if (tolerance < radius) {
+        step = std::min(step,2.0f*std::acos(1.0f-tolerance/radius));
+    }
+
+    // Sweep every edge with a rectangle, and fill the gaps at each corner
+    std::vector<Vec2> contour;
+    std::vector<Vec2> band;
+    std::vector<Sint64> edges;
+    for(size_t ii = 0; ii+1 < _starts.size(); ii++) {
+        contour.clear();
+        for(Uint32 jj = _starts[ii]; jj < _starts[ii+1]; jj++) {
+            contour.push_back(Vec2((float)(_points[2*jj]/(double)_resolution),
+                                   (float)(_points[2*jj+1]/(double)_resolution)));
+        }
+
+        size_t size = contour.size();
+        for(size_t jj = 0; jj < size; jj++) {
+            const Vec2& prev = contour[(jj+size-1) % size];
+            const Vec2& curr = contour[jj];
+            const Vec2& next = contour[(jj+1) % size];
+            Vec2 norm1 = (curr-prev).getPerp().getNormalization()*radius;
+            Vec2 norm2 = (next-curr).getPerp().getNormalization()*radius;
+
+            band.clear();
+            band.push_back(curr-norm2);
+            band.push_back(next-norm2);
+            band.push_back(next+norm2);
+            band.push_back(curr+norm2);
+            gather(band, edges);
+
+            // The gap is on the outside of the turn
+            float turn = (curr-prev).cross(next-curr);
+            if (turn == 0) {
+                continue;
+            }
+            Vec2 start = turn > 0 ? -norm1 : norm2;
+            Vec2 end   = turn > 0 ? -norm2 : norm1;
+            float angle = std::atan2(start.cross(end),start.dot(end));
+            int segments = std::max(1,(int)std::ceil(std::fabs(angle)/step));
+
+            band.clear();
+            band.push_back(curr);
+            for(int kk = 0; kk <= segments; kk++) {
+                band.push_back(curr+start.getRotation(angle*kk/segments));
+            }
+            gather(band, edges);
+        }
+    }
+
+    apply(distance > 0 ? Operation::UNION : Operation::DIFFERENCE, edges, false);
+}
+
+
+#pragma mark -
+#pragma mark Materialization
+/**
+ * Returns the contours of the shape
+ *
+ * Outer boundaries are counter-clockwise, while holes are clockwise.
+ * Each contour is closed (the last vertex connects to the first) and
+ * does not repeat its first vertex.
+ *
+ * @return the contours of the shape
+ */
+std::vector<std::vector<Vec2>> PolyClipper::getContours() const {
+    std::vector<std::vector<Vec2>> result;
+    getContours(result);
+    return result;
+}
+
+/**
+ * Stores the contours of the shape in the given buffer
+ *
+ * Outer boundaries are counter-clockwise, while holes are clockwise.
+ * Each contour is closed (the last vertex connects to the first) and
+ * does not repeat its first vertex.
+ *
+ * The contours will be appended to the buffer.  You should clear the
+ * buffer first if you do not want to preserve the original data.
+ *
+ * @param buffer    The buffer to store the contours
+ *
+ * @return the number of contours added to the buffer
+ */
+size_t PolyClipper::getContours(std::vector<std::vector<Vec2>>& buffer) const {
+    size_t count = _starts.size()-1;
+    buffer.reserve(buffer.size()+count);
+    for(size_t ii = 0; ii < count; ii++) {
+        buffer.push_back(std::vector<Vec2>());
+        std::vector<Vec2>& contour = buffer.back();
+        contour.reserve(_starts[ii+1]-_starts[ii]);
+        for(Uint32 jj = _starts[ii]; jj < _starts[ii+1]; jj++) {
+            contour.push_back(Vec2((float)(_points[2*jj]/(double)_resolution),
+                                   (float)(_points[2*jj+1]/(double)_resolution)));
+        }
+    }
+    return count;
+}
+
+/**
+ * Returns the signed area of the shape
+ *
+ * This is the area of the outer boundaries minus the area of the holes.
+ *
+ * @return the signed area of the shape
+ */
+double PolyClipper::getArea() const {
+    double total = 0;
+    for(size_t ii = 0; ii+1 < _starts.size(); ii++) {
+        Uint32 first = _starts[ii];
+        Uint32 last  = _starts[ii+1]-1;
+        for(Uint32 jj = first; jj <= last; jj++) {
+            Uint32 kk = (jj == last ? first : jj+1);
+            total += (double)(_points[2*jj]*_points[2*kk+1]-_points[2*kk]*_points[2*jj+1]);
+        }
+    }
+    return total/(2.0*_resolution*_resolution);
+}
+
+/**
+ * Returns a path polygon outlining the shape
+ *
+ * The indices form closed paths around each contour. Hence this Poly2
+ * may be drawn as a wireframe.
+ *
+ * @return a path polygon outlining the shape
+ */
+Poly2 PolyClipper::getOutline() const {
+    Poly2 poly;
+    getOutline(&poly);
+    return poly;
+}
+
+/**
+ * Stores a path polygon outlining the shape in the given buffer
+ *
+ * The indices form closed paths around each contour. Hence this Poly2
+ * may be drawn as a wireframe.  If the buffer is not empty, the indices
+ * will be adjusted accordingly. You should clear the buffer first if you
+ * do not want to preserve the original data.
+ *
+ * @param buffer    The buffer to store the outline
+ *
+ * @return a reference to the buffer for chaining.
+ */
+Poly2* PolyClipper::getOutline(Poly2* buffer) const {
+    CUAssertLog(buffer, "Destination buffer is null");
+    Uint32 offset = (Uint32)buffer->_vertices.size();
+    buffer->_vertices.reserve(offset+_points.size()/2);
+    buffer->_indices.reserve(buffer->_indices.size()+_points.size());
+    for(size_t ii = 0; ii+1 < _starts.size(); ii++) {
+        Uint32 first = _starts[ii];
+        Uint32 last  = _starts[ii+1]-1;
+        for(Uint32 jj = first; jj <= last; jj++) {
+            buffer->_vertices.push_back(Vec2((float)(_points[2*jj]/(double)_resolution),
+                                             (float)(_points[2*jj+1]/(double)_resolution)));
+            buffer->_indices.push_back(offset+jj);
+            buffer->_indices.push_back(offset+(jj == last ? first : jj+1));
+        }
+    }
+    buffer->setType(Poly2::Type::PATH);
+    return buffer;
+}
+
+/**
+ * Returns a solid polygon triangulating the shape
+ *
+ * Each outer boundary is triangulated together with the holes that it
+ * contains, using a {@link MonotoneTriangulator}.
+ *
+ * @return a solid polygon triangulating the shape
+ */
+Poly2 PolyClipper::getPolygon() const {
+    Poly2 poly;
+    getPolygon(&poly);
+    return poly;
+}
+
+/**
+ * Stores a solid polygon triangulating the shape in the given buffer
+ *
+ * Each outer boundary is triangulated together with the holes that it
+ * contains, using a {@link MonotoneTriangulator}.  If the buffer is not
+ * empty, the indices will be adjusted accordingly. You should clear the
+ * buffer first if you do not want to preserve the original data.
+ *
+ * @param buffer    The buffer to store the triangulation
+ *
+ * @return a reference to the buffer for chaining.
+ */
+Poly2* PolyClipper::getPolygon(Poly2* buffer) const {
+    CUAssertLog(buffer, "Destination buffer is null");
+    size_t count = _starts.size()-1;
+
+    // Classify the contours by orientation
+    std::vector<double> areas(count,0);
+    for(size_t ii = 0; ii < count; ii++) {
+        Uint32 first = _starts[ii];
+        Uint32 last  = _starts[ii+1]-1;
+        for(Uint32 jj = first; jj <= last; jj++) {
+            Uint32 kk = (jj == last ? first : jj+1);
+            areas[ii] += (double)(_points[2*jj]*_points[2*kk+1]-_points[2*kk]*_points[2*jj+1]);
+        }
+    }
+
+    // Assign each hole to the smallest boundary containing it
+    std::vector<long> parent(count,-1);
+    for(size_t ii = 0; ii < count; ii++) {
+        if (areas[ii] >= 0) {
+            continue;
+        }
+
+        // Probe just to the right of the first edge (inside the hole)
+        Uint32 first = _starts[ii];
+        double ax = (double)_points[2*first];
+        double ay = (double)_points[2*first+1];
+        double bx = (double)_points[2*first+2];
+        double by = (double)_points[2*first+3];
+        double len = std::sqrt((bx-ax)*(bx-ax)+(by-ay)*(by-ay));
+        double px = (ax+bx)/2+0.25*(by-ay)/len;
+        double py = (ay+by)/2-0.25*(bx-ax)/len;
+
+        double best = std::numeric_limits<double>::max();
+        for(size_t jj = 0; jj < count; jj++) {
+            if (areas[jj] <= 0 || areas[jj] >= best ||
+                px < _bounds[4*jj] || px > _bounds[4*jj+2] ||
+                py < _bounds[4*jj+1] || py > _bounds[4*jj+3]) {
+                continue;
+            }
+            bool inside = false;
+            Uint32 start = _starts[jj];
+            Uint32 last  = _starts[jj+1]-1;
+            for(Uint32 kk = start; kk <= last; kk++) {
+                Uint32 ll = (kk == last ? start : kk+1);
+                double x1 = (double)_points[2*kk];
+                double y1 = (double)_points[2*kk+1];
+                double x2 = (double)_points[2*ll];
+                double y2 = (double)_points[2*ll+1];
+                if ((y1 > py) != (y2 > py) && px < x1+(py-y1)*(x2-x1)/(y2-y1)) {
+                    inside = !inside;
+                }
+            }
+            if (inside) {
+                best = areas[jj];
+                parent[ii] = (long)jj;
+            }
+        }
+    }
+
+    MonotoneTriangulator triangulator;
+    std::vector<Vec2> contour;
+    for(size_t ii = 0; ii < count; ii++) {
+        if (areas[ii] <= 0) {
+            continue;
+        }
+        contour.clear();
+        for(Uint32 jj = _starts[ii]; jj < _starts[ii+1]; jj++) {
+            contour.push_back(Vec2((float)(_points[2*jj]/(double)_resolution),
+                                   (float)(_points[2*jj+1]/(double)_resolution)));
+        }
+        triangulator.set(contour);
+        for(size_t jj = 0; jj < count; jj++) {
+            if (parent[jj] != (long)ii) {
+                continue;
+            }
+            contour.clear();
+            for(Uint32 kk = _starts[jj]; kk < _starts[jj+1]; kk++) {
+                contour.push_back(Vec2((float)(_points[2*kk]/(double)_resolution),
+                                       (float)(_points[2*kk+1]/(double)_resolution)));
+            }
+            triangulator.addHole(contour);
+        }
+        triangulator.calculate();
+        triangulator.getPolygon(buffer);
+    }
+    buffer->setType(Poly2::Type::SOLID);
+    return buffer;
+}
+
+
+#pragma mark -
+#pragma mark Internal Data Generation
+/**
+ * Appends the directed edges of the given polygon to the buffer
+ *
+ * Each edge is stored as four grid coordinates: the x and y coordinates
+ * of the start, followed by those of the end. Solid polygons contribute
+ * their triangles (in counter-clockwise order), path polygons contribute
+ * their index pairs, and other polygons are treated as a single contour.
+ *
+ * @param poly      The polygon to convert
+ * @param edges     The buffer to store the edges
+ */
+void PolyClipper::gather(const Poly2& poly, std::vector<Sint64>& edges) const {
+    std::vector<Sint64> verts;
+    verts.reserve(2*poly._vertices.size());
+    for(auto it = poly._vertices.begin(); it != poly._vertices.end(); ++it) {
+        Sint64 x = (Sint64)std::llround(it->x*(double)_resolution);
+        Sint64 y = (Sint64)std::llround(it->y*(double)_resolution);
+        CUAssertLog(x > -MAX_COORDINATE && x < MAX_COORDINATE &&
+                    y > -MAX_COORDINATE && y < MAX_COORDINATE,
+                    "Vertex (%f,%f) is out of range", it->x, it->y);
+        verts.push_back(x);
+        verts.push_back(y);
+    }
+
+    const std::vector<Uint32>& indices = poly._indices;
+    switch (poly.getType()) {
+        case Poly2::Type::SOLID:
+            edges.reserve(edges.size()+4*indices.size());
+            for(size_t ii = 0; ii+2 < indices.size(); ii += 3) {
+                ClipPoint a(verts[2*indices[ii  ]],verts[2*indices[ii  ]+1]);
+                ClipPoint b(verts[2*indices[ii+1]],verts[2*indices[ii+1]+1]);
+                ClipPoint c(verts[2*indices[ii+2]],verts[2*indices[ii+2]+1]);
+                Sint64 side = orient(a,b,c);
+                if (side == 0) {
+                    continue;
+                } else if (side < 0) {
+                    std::swap(b,c);
+                }
+                Sint64 tri[] = { a.x, a.y, b.x, b.y, b.x, b.y, c.x, c.y, c.x, c.y, a.x, a.y };
+                edges.insert(edges.end(), tri, tri+12);
+            }
+            break;
+        case Poly2::Type::PATH:
+            edges.reserve(edges.size()+2*indices.size());
+            for(size_t ii = 0; ii+1 < indices.size(); ii += 2) {
+                edges.push_back(verts[2*indices[ii  ]  ]);
+                edges.push_back(verts[2*indices[ii  ]+1]);
+                edges.push_back(verts[2*indices[ii+1]  ]);
+                edges.push_back(verts[2*indices[ii+1]+1]);
+            }
+            break;
+        default:
+            gather(poly._vertices, edges);
+            break;
+    }
+}
+
+/**
+ * Appends the directed edges of the given contour to the buffer
+ *
+ * Each edge is stored as four grid coordinates: the x and y coordinates
+ * of the start, followed by those of the end.
+ *
+ * @param points    The contour vertices
+ * @param edges     The buffer to store the edges
+ */
+void PolyClipper::gather(const std::vector<Vec2>& points, std::vector<Sint64>& edges) const {
+    size_t size = points.size();
+    if (size < 3) {
+        return;
+    }
+    edges.reserve(edges.size()+4*size);
+    Sint64 firstx = (Sint64)std::llround(points[0].x*(double)_resolution);
+    Sint64 firsty = (Sint64)std::llround(points[0].y*(double)_resolution);
+    Sint64 prevx = firstx;
+    Sint64 prevy = firsty;
+    for(size_t ii = 1; ii <= size; ii++) {
+        Sint64 x = firstx;
+        Sint64 y = firsty;
+        if (ii < size) {
+            x = (Sint64)std::llround(points[ii].x*(double)_resolution);
+            y = (Sint64)std::llround(points[ii].y*(double)_resolution);
+            CUAssertLog(x > -MAX_COORDINATE && x < MAX_COORDINATE &&
+                        y > -MAX_COORDINATE && y < MAX_COORDINATE,
+                        "Vertex (%f,%f) is out of range", points[ii].x, points[ii].y);
+        }
+        edges.push_back(prevx);
+        edges.push_back(prevy);
+        edges.push_back(x);
+        edges.push_back(y);
+        prevx = x;
+        prevy = y;
+    }
+}
+
+/**
+ * Applies the boolean operation with the given clip edges to the shape
+ *
+ * Each clip edge is stored as four grid coordinates, as in {@link #gather}.
+ * This is the primary calculation method.  If incremental is true, only the
+ * shape edges in the vertical slab spanned by the clip edges are processed.
+ * This slab contains every shape edge that can affect the windings of the
+ * clip edges, so the result is the same.
+ *
+ * @param op            The boolean operation
+ * @param clip          The clip edges
+ * @param incremental   Whether to process only the region near the clip
+ */
+void PolyClipper::apply(Operation op, const std::vector<Sint64>& clip, bool incremental) {
+    if (clip.empty()) {
+        if (op == Operation::INTERSECTION) {
+            clear();
+        }
+        return;
+    }
+
+    // The vertical slab affected by the clip polygon
+    Sint64 left  = std::numeric_limits<Sint64>::max();
+    Sint64 right = std::numeric_limits<Sint64>::min();
+    for(size_t ii = 0; ii+1 < clip.size(); ii += 2) {
+        left  = std::min(left, clip[ii]);
+        right = std::max(right,clip[ii]);
+    }
+    left--; right++;
+
+    std::vector<Sint64> points;
+    std::vector<Uint32> starts;
+    std::vector<Sint64> bounds;
+    starts.push_back(0);
+
+    // Partition the shape into the slab to clip and the chains to keep
+    std::vector<ClipSegment> segs;
+    std::vector<ClipChain> chains;
+    std::vector<ClipPoint> interior;
+    bool keep = op != Operation::INTERSECTION;
+    for(size_t ii = 0; ii+1 < _starts.size(); ii++) {
+        Uint32 first = _starts[ii];
+        Uint32 size  = _starts[ii+1]-first;
+        if (incremental && (_bounds[4*ii+2] < left || _bounds[4*ii] > right)) {
+            if (keep) {
+                points.insert(points.end(), _points.begin()+2*first, _points.begin()+2*(first+size));
+                starts.push_back((Uint32)(points.size()/2));
+                bounds.insert(bounds.end(), _bounds.begin()+4*ii, _bounds.begin()+4*ii+4);
+            }
+            continue;
+        }
+
+        // Start at an edge in the slab so that runs do not wrap around
+        Uint32 offset = 0;
+        while (incremental && offset < size) {
+            Sint64 x1 = _points[2*(first+offset)];
+            Sint64 x2 = _points[2*(first+(offset+1) % size)];
+            if (std::max(x1,x2) >= left && std::min(x1,x2) <= right) {
+                break;
+            }
+            offset++;
+        }
+
+        bool open = false;
+        for(Uint32 jj = 0; jj < size; jj++) {
+            Uint32 pos1 = first+(offset+jj) % size;
+            Uint32 pos2 = first+(offset+jj+1) % size;
+            ClipPoint p(_points[2*pos1],_points[2*pos1+1]);
+            ClipPoint q(_points[2*pos2],_points[2*pos2+1]);
+            if (!incremental || (std::max(p.x,q.x) >= left && std::min(p.x,q.x) <= right)) {
+                segs.push_back(ClipSegment(p,q,false));
+                open = false;
+            } else if (keep && open) {
+                ClipChain& chain = chains.back();
+                interior.push_back(chain.end);
+                chain.count++;
+                chain.tail = chain.end;
+                chain.end  = q;
+            } else if (keep) {
+                chains.push_back(ClipChain(p,q,interior.size()));
+                open = true;
+            }
+        }
+    }
+    for(size_t ii = 0; ii+3 < clip.size(); ii += 4) {
+        ClipPoint p(clip[ii  ],clip[ii+1]);
+        ClipPoint q(clip[ii+2],clip[ii+3]);
+        if (p != q) {
+            segs.push_back(ClipSegment(p,q,true));
+        }
+    }
+
+    split_segments(segs);
+    merge_segments(segs);
+    sweep_segments(segs);
+
+    // Keep the edges where the operation changes
+    chains.reserve(chains.size()+segs.size());
+    for(auto it = segs.begin(); it != segs.end(); ++it) {
+        bool below = contains(op, it->below, it->clipBelow);
+        bool above = contains(op, it->below+it->shape, it->clipBelow+it->clip);
+        if (below == above) {
+            continue;
+        } else if (above) {
+            chains.push_back(ClipChain(it->a,it->b));
+        } else {
+            chains.push_back(ClipChain(it->b,it->a));
+        }
+    }
+
+    link_chains(chains, interior, points, starts, bounds);
+    _points.swap(points);
+    _starts.swap(starts);
+    _bounds.swap(bounds);
+}
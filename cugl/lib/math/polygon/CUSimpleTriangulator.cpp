@@ -59,12 +59,12 @@ void SimpleTriangulator::calculate() {
     _naive.resize(vcount,0);
     
     if (areVerticesClockwise(_input)) {
-        for (short i = 0; i < vcount; i++) {
+        for (int i = 0; i < vcount; i++) {
             _naive[i] = i;
         }
     } else {
         for (int i = 0, n = vcount - 1; i < vcount; i++) {
-            _naive[i] = (short)(n - i); // Reversed.
+            _naive[i] = (Uint32)(n - i); // Reversed.
         }
     }
     
@@ -321,8 +321,8 @@ void SimpleTriangulator::trimColinear() {
  *
  * @return a list of indices representing the triangulation.
  */
-std::vector<unsigned short> SimpleTriangulator::getTriangulation() {
-    std::vector<unsigned short> result;
+std::vector<Uint32> SimpleTriangulator::getTriangulation() {
+    std::vector<Uint32> result;
     if (_calculated) {
         result.assign(_output.begin(), _output.end());
     }
@@ -342,7 +342,7 @@ std::vector<unsigned short> SimpleTriangulator::getTriangulation() {
  *
  * @return the number of elements added to the buffer
  */
-size_t SimpleTriangulator::getTriangulation(std::vector<unsigned short>& buffer) {
+size_t SimpleTriangulator::getTriangulation(std::vector<Uint32>& buffer) {
     if (_calculated) {
         buffer.reserve(buffer.size()+_output.size());
         std::copy(_output.begin(), _output.end(),std::back_inserter(buffer));
@@ -123,6 +123,8 @@ bool SpriteBatch::init() {
  * before continuing to draw. You should tune your system to have the
  * appropriate capacity.  To small a capacity will cause the system to
  * thrash.  However, too large a capacity could stall on memory transfers.
+ * A single mesh larger than the capacity will grow the buffers, so that
+ * it is still drawn in one piece.
  *
  * The sprite batch begins with the default blank texture, and color white.
  * The perspective matrix is the identity.
@@ -144,6 +146,8 @@ bool SpriteBatch::init(unsigned int capacity) {
  * before continuing to draw. You should tune your system to have the
  * appropriate capacity.  To small a capacity will cause the system to
  * thrash.  However, too large a capacity could stall on memory transfers.
+ * A single mesh larger than the capacity will grow the buffers, so that
+ * it is still drawn in one piece.
  *
  * The sprite batch begins with the default blank texture, and color white.
  * The perspective matrix is the identity.
@@ -467,9 +471,7 @@ void SpriteBatch::fill(const Rect& rect,  const Vec2& origin, const Vec2& scale,
     transform.rotateZ(angle);
     transform.translate((Vec3)(origin+offset));
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= transform;
-    }
+    transformVertices(transform,count);
 }
 
 /**
@@ -499,9 +501,7 @@ void SpriteBatch::fill(const Rect& rect, const Vec2& origin, const Mat4& transfo
     matrix *= transform;
     matrix.translate(origin.x,origin.y,0);
 
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= matrix;
-    }
+    transformVertices(matrix,count);
 }
 
 /**
@@ -531,9 +531,7 @@ void SpriteBatch::fill(const Rect& rect, const Vec2& origin, const Affine2& tran
     matrix *= transform;
     matrix.translate(origin);
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= matrix;
-    }
+    transformVertices(matrix,count);
 }
 
 /**
@@ -639,9 +637,7 @@ void SpriteBatch::fill(const Poly2& poly, const Vec2& origin, const Vec2& scale,
     transform.rotateZ(angle);
     transform.translate((Vec3)(origin+offset));
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= transform;
-    }
+    transformVertices(transform,count);
 }
 
 /**
@@ -682,9 +678,7 @@ void SpriteBatch::fill(const Poly2& poly, const Vec2& origin, const Mat4& transf
     matrix *= transform;
     matrix.translate(origin.x,origin.y,0);
 
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= matrix;
-    }
+    transformVertices(matrix,count);
 }
 
 /**
@@ -725,9 +719,7 @@ void SpriteBatch::fill(const Poly2& poly, const Vec2& origin, const Affine2& tra
     matrix *= transform;
     matrix.translate(origin);
 
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= matrix;
-    }
+    transformVertices(matrix,count);
 }
 
 /**
@@ -759,9 +751,42 @@ void SpriteBatch::fill(const Vertex2* vertices, unsigned int vsize, unsigned int
     setCommand(GL_TRIANGLES);
     unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,true,tint);
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= transform;
-    }
+    transformVertices(transform,count);
+}
+
+/**
+ * Fills the triangulated vertices with the current texture.
+ *
+ * This method provides more fine tuned control over texture coordinates
+ * that the other fill methods.  The texture no longer needs to be
+ * drawn uniformly over the shape.
+ *
+ * The triangulation will be determined by the given indices. If necessary,
+ * these can be generated via one of the triangulation factories
+ * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+ *
+ * The vertices use their own color values.  However, if tint is true, these
+ * values will be tinted (i.e. multiplied) by the current active color.
+ *
+ * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+ * This is the index format of {@link Poly2} and the polygon tools.
+ *
+ * @param vertices  The array of vertices
+ * @param vsize     The size of the vertex array
+ * @param voffset   The first element of the vertex array
+ * @param indices   The triangulation array
+ * @param isize     The size of the index array
+ * @param ioffset   The first element of the index array
+ * @param transform The coordinate transform
+ * @param tint      Whether to tint with the active color
+ */
+void SpriteBatch::fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                       const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                       const Mat4& transform, bool tint) {
+    setCommand(GL_TRIANGLES);
+    unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,true,tint);
+    
+    transformVertices(transform,count);
 }
 
 /**
@@ -794,9 +819,43 @@ void SpriteBatch::fill(const Vertex2* vertices, unsigned int vsize, unsigned int
     setCommand(GL_TRIANGLES);
     unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,true,tint);
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= transform;
-    }
+    transformVertices(transform,count);
+}
+
+/**
+ * Fills the triangulated vertices with the current texture.
+ *
+ * This method provides more fine tuned control over texture coordinates
+ * that the other fill methods.  The texture no longer needs to be
+ * drawn uniformly over the shape. The transform will be applied to the
+ * vertex positions directly in world space.
+ *
+ * The triangulation will be determined by the given indices. If necessary,
+ * these can be generated via one of the triangulation factories
+ * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+ *
+ * The vertices use their own color values.  However, if tint is true, these
+ * values will be tinted (i.e. multiplied) by the current active color.
+ *
+ * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+ * This is the index format of {@link Poly2} and the polygon tools.
+ *
+ * @param vertices  The array of vertices
+ * @param vsize     The size of the vertex array
+ * @param voffset   The first element of the vertex array
+ * @param indices   The triangulation array
+ * @param isize     The size of the index array
+ * @param ioffset   The first element of the index array
+ * @param transform The coordinate transform
+ * @param tint      Whether to tint with the active color
+ */
+void SpriteBatch::fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                       const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                       const Affine2& transform, bool tint) {
+    setCommand(GL_TRIANGLES);
+    unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,true,tint);
+    
+    transformVertices(transform,count);
 }
 
 #pragma mark -
@@ -852,9 +911,7 @@ void SpriteBatch::outline(const Rect& rect, const Vec2& origin, const Vec2& scal
     transform.rotateZ(angle);
     transform.translate((Vec3)(origin+offset));
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= transform;
-    }
+    transformVertices(transform,count);
 }
 
 /**
@@ -885,9 +942,7 @@ void SpriteBatch::outline(const Rect& rect, const Vec2& origin, const Mat4& tran
     matrix *= transform;
     matrix.translate(origin.x,origin.y,0);
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= matrix;
-    }
+    transformVertices(matrix,count);
 }
 
 /**
@@ -918,9 +973,7 @@ void SpriteBatch::outline(const Rect& rect, const Vec2& origin, const Affine2& t
     matrix *= transform;
     matrix.translate(origin.x,origin.y);
 
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= matrix;
-    }
+    transformVertices(matrix,count);
 }
 
 /**
@@ -1026,9 +1079,7 @@ void SpriteBatch::outline(const Poly2& poly, const Vec2& origin, const Vec2& sca
     transform.rotateZ(angle);
     transform.translate((Vec3)(origin+offset));
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= transform;
-    }
+    transformVertices(transform,count);
 
 }
 
@@ -1070,9 +1121,7 @@ void SpriteBatch::outline(const Poly2& poly, const Vec2& origin, const Mat4& tra
     matrix *= transform;
     matrix.translate(origin.x,origin.y,0);
 
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= matrix;
-    }
+    transformVertices(matrix,count);
 }
 
 /**
@@ -1113,9 +1162,7 @@ void SpriteBatch::outline(const Poly2& poly, const Vec2& origin, const Affine2&
     matrix *= transform;
     matrix.translate(origin.x,origin.y);
 
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= matrix;
-    }
+    transformVertices(matrix,count);
 }
 
 /**
@@ -1148,9 +1195,43 @@ void SpriteBatch::outline(const Vertex2* vertices, unsigned int vsize, unsigned
     setCommand(GL_LINES);
     unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,false,tint);
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= transform;
-    }
+    transformVertices(transform,count);
+}
+
+/**
+ * Outlines the vertex path with the current texture.
+ *
+ * This method provides more fine tuned control over texture coordinates
+ * that the other outline methods.  The texture no longer needs to be
+ * drawn uniformly over the wireframe. The transform will be applied to the
+ * vertex positions directly in world space.
+ *
+ * The vertex path will be determined by the provided indices. The indices
+ * should be a multiple of two, preferably generated by the factories
+ * {@link PathOutliner} or {@link CubicSplineApproximator}.
+ *
+ * The vertices use their own color values.  However, if tint is true, these
+ * values will be tinted (i.e. multiplied) by the current active color.
+ *
+ * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+ * This is the index format of {@link Poly2} and the polygon tools.
+ *
+ * @param vertices  The array of vertices
+ * @param vsize     The size of the vertex array
+ * @param voffset   The first element of the vertex array
+ * @param indices   The triangulation array
+ * @param isize     The size of the index array
+ * @param ioffset   The first element of the index array
+ * @param transform The coordinate transform
+ * @param tint      Whether to tint with the active color
+ */
+void SpriteBatch::outline(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                          const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                          const Mat4& transform, bool tint) {
+    setCommand(GL_LINES);
+    unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,false,tint);
+    
+    transformVertices(transform,count);
 }
 
 /**
@@ -1183,9 +1264,43 @@ void SpriteBatch::outline(const Vertex2* vertices, unsigned int vsize, unsigned
     setCommand(GL_LINES);
     unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,false,tint);
     
-    for(int ii = 1; ii <= count; ii++) {
-        _vertData[_vertSize-ii].position *= transform;
-    }
+    transformVertices(transform,count);
+}
+
+/**
+ * Outlines the vertex path with the current texture.
+ *
+ * This method provides more fine tuned control over texture coordinates
+ * that the other outline methods.  The texture no longer needs to be
+ * drawn uniformly over the wireframe. The transform will be applied to the
+ * vertex positions directly in world space.
+ *
+ * The vertex path will be determined by the provided indices. The indices
+ * should be a multiple of two, preferably generated by the factories
+ * {@link PathOutliner} or {@link CubicSplineApproximator}.
+ *
+ * The vertices use their own color values.  However, if tint is true, these
+ * values will be tinted (i.e. multiplied) by the current active color.
+ *
+ * The indices are 32-bit, so the mesh may have more than 65,535 vertices.
+ * This is the index format of {@link Poly2} and the polygon tools.
+ *
+ * @param vertices  The array of vertices
+ * @param vsize     The size of the vertex array
+ * @param voffset   The first element of the vertex array
+ * @param indices   The triangulation array
+ * @param isize     The size of the index array
+ * @param ioffset   The first element of the index array
+ * @param transform The coordinate transform
+ * @param tint      Whether to tint with the active color
+ */
+void SpriteBatch::outline(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                          const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                          const Affine2& transform, bool tint) {
+    setCommand(GL_LINES);
+    unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,false,tint);
+    
+    transformVertices(transform,count);
 }
 
 #pragma mark -
@@ -1441,10 +1556,7 @@ unsigned int SpriteBatch::prepare(const Rect& rect, bool solid) {
 unsigned int SpriteBatch::prepare(const Poly2& poly, bool solid) {
     CUAssertLog((solid ? poly.getIndices().size() % 3 : poly.getIndices().size() % 2) == 0,
                 "Polynomial has the wrong number of indices: %d", (int)poly.getIndices().size());
-    if (_vertSize+poly.getVertices().size() > _vertMax ||
-        _indxSize+poly.getIndices().size()  > _indxMax) {
-        flush();
-    }
+    reserve((unsigned int)poly.getVertices().size(),(unsigned int)poly.getIndices().size());
     
     unsigned int vstart = _vertSize;
     int ii = 0;
@@ -1492,11 +1604,57 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, bool solid) {
 unsigned int SpriteBatch::prepare(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
                                   const unsigned short* indices, unsigned int isize, unsigned int ioffset,
                                   bool solid, bool tint) {
+    return prepareMesh(vertices,vsize,voffset,indices,isize,ioffset,solid,tint);
+}
+
+/**
+ * Returns the number of vertices added to the drawing buffer.
+ *
+ * This method adds the given vertices and indices to the drawing buffer,
+ * but does not draw them.  You must call flush() to draw the mesh.
+ *
+ * @param vertices  The vertices to add to the buffer
+ * @param vsize     The number of vertices to add
+ * @param voffset   The position of the first vertex to add
+ * @param indices   The indices to add to the buffer
+ * @param isize     The number of indices to add
+ * @param ioffset   The position of the first index to add
+ * @param solid     Whether the vertex mesh is to be filled
+ * @param tint      Whether to tint with the active color
+ *
+ * @return the number of vertices added to the drawing buffer.
+ */
+unsigned int SpriteBatch::prepare(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                                  const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                                  bool solid, bool tint) {
+    return prepareMesh(vertices,vsize,voffset,indices,isize,ioffset,solid,tint);
+}
+
+/**
+ * Returns the number of vertices added to the drawing buffer.
+ *
+ * This method is the shared implementation of prepare for both index
+ * widths.  It adds the given vertices and indices to the drawing buffer,
+ * but does not draw them.  You must call flush() to draw the mesh.
+ *
+ * @param vertices  The vertices to add to the buffer
+ * @param vsize     The number of vertices to add
+ * @param voffset   The position of the first vertex to add
+ * @param indices   The indices to add to the buffer
+ * @param isize     The number of indices to add
+ * @param ioffset   The position of the first index to add
+ * @param solid     Whether the vertex mesh is to be filled
+ * @param tint      Whether to tint with the active color
+ *
+ * @return the number of vertices added to the drawing buffer.
+ */
+template <typename T>
+unsigned int SpriteBatch::prepareMesh(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                                      const T* indices, unsigned int isize, unsigned int ioffset,
+                                      bool solid, bool tint) {
     CUAssertLog((solid ? isize % 3 : isize % 2) == 0,
                 "Vertex mesh has the wrong number of indices: %d", isize);
-    if (_vertSize+vsize > _vertMax || _indxSize+isize  > _indxMax) {
-        flush();
-    }
+    reserve(vsize,isize);
     
     int ii = 0;
     unsigned int vstart = _vertSize;
@@ -1519,6 +1677,67 @@ unsigned int SpriteBatch::prepare(const Vertex2* vertices, unsigned int vsize, u
     return ii;
 }
 
+/**
+ * Transforms the positions of the most recently prepared vertices.
+ *
+ * The vertices are the last count vertices in the drawing buffer, which
+ * are the ones added by the previous call to prepare.  The positions are
+ * transformed in bulk, which is much faster than transforming each one
+ * individually on vectorized platforms.
+ *
+ * @param transform The coordinate transform
+ * @param count     The number of vertices to transform
+ */
+void SpriteBatch::transformVertices(const Mat4& transform, unsigned int count) {
+    Vec2* first = &(_vertData[_vertSize-count].position);
+    Mat4::transform(transform,first,sizeof(Vertex2),first,sizeof(Vertex2),count);
+}
+
+/**
+ * Transforms the positions of the most recently prepared vertices.
+ *
+ * The vertices are the last count vertices in the drawing buffer, which
+ * are the ones added by the previous call to prepare.  The positions are
+ * transformed in bulk, which is much faster than transforming each one
+ * individually on vectorized platforms.
+ *
+ * @param transform The coordinate transform
+ * @param count     The number of vertices to transform
+ */
+void SpriteBatch::transformVertices(const Affine2& transform, unsigned int count) {
+    Vec2* first = &(_vertData[_vertSize-count].position);
+    Affine2::transform(transform,first,sizeof(Vertex2),first,sizeof(Vertex2),count);
+}
+
+/**
+ * Ensures that the drawing buffer has room for the given mesh.
+ *
+ * If the mesh does not fit in the remaining space, the sprite batch will
+ * flush.  If the mesh is larger than the entire buffer, the buffer is grown
+ * to fit it.  That way a large mesh is always drawn in one piece, instead
+ * of overflowing the buffer.
+ *
+ * @param vsize     The number of vertices to add
+ * @param isize     The number of indices to add
+ */
+void SpriteBatch::reserve(unsigned int vsize, unsigned int isize) {
+    if (_vertSize+vsize <= _vertMax && _indxSize+isize <= _indxMax) {
+        return;
+    }
+    
+    flush();
+    if (vsize > _vertMax) {
+        delete[] _vertData;
+        _vertMax  = vsize;
+        _vertData = new Vertex2[_vertMax];
+    }
+    if (isize > _indxMax) {
+        delete[] _indxData;
+        _indxMax  = isize;
+        _indxData = new GLuint[_indxMax];
+    }
+}
+
 
 
 
@@ -11,6 +11,11 @@
 #include "CUDebug.h"
 #include "CUStrings.h"
 #include "CUNode.h"
+#include "CULabel.h"
+#include "CUFont.h"
+#include "CUTextBatch.h"
+#include "CUSpriteBatch.h"
+#include "CUApplication.h"
 #include <chrono>
 
 /** Data type for timestamp support */
@@ -760,11 +765,64 @@ void testNode() {
 }
     
 
+#pragma mark -
+#pragma mark TextBatch
+    
+void testTextBatch() {
+    CULog("Running tests for TextBatch.\n");
+    std::shared_ptr<Font> font = Font::alloc(Application::get()->getAssetDirectory()+"fonts/MarkerFelt.ttf",24);
+    CUAssertLog(font != nullptr, "Font failed to load");
+    
+    // The text has more vertices than a SpriteBatch can hold at once
+    std::string text(3000,'W');
+    std::vector<Vertex2> quads;
+    font->getQuads(text,Vec2::ZERO,quads);
+    CUAssertLog(quads.size() > DEFAULT_CAPACITY, "Text is too small for this test");
+    
+    std::shared_ptr<Label> label = Label::alloc(text,font);
+    std::shared_ptr<TextBatch> batch = TextBatch::alloc();
+    batch->add(label.get(),Mat4::IDENTITY,Color4::WHITE);
+    batch->add(font,text,Vec2::ZERO,Mat4::IDENTITY,Color4::WHITE);
+    CUAssertLog(batch->getLabelCount() == 2, "Method add() failed");
+    CUAssertLog(batch->getPageCount() == 1,  "Method add() failed");
+    
+    std::shared_ptr<SpriteBatch> sprites = SpriteBatch::alloc();
+    sprites->begin(Mat4::IDENTITY);
+    batch->draw(sprites);
+    sprites->end();
+    CUAssertLog(sprites->getVerticesDrawn() > quads.size(), "Method draw() failed");
+    CUAssertLog(sprites->getCallsMade() >= (2*quads.size()+DEFAULT_CAPACITY-1)/DEFAULT_CAPACITY,
+                "Method draw() exceeded the SpriteBatch capacity");
+    
+    batch->clear();
+    CUAssertLog(batch->getPageCount() == 0 && batch->getLabelCount() == 0, "Method clear() failed");
+    
+    // Backgrounds must be drawn before all glyphs, even if added later
+    std::shared_ptr<Label> plain = Label::alloc("Plain",font);
+    std::shared_ptr<Label> panel = Label::alloc("Panel",font);
+    panel->setBackground(Color4::BLUE);
+    batch->add(plain.get(),Mat4::IDENTITY,Color4::WHITE);
+    batch->add(panel.get(),Mat4::IDENTITY,Color4::WHITE);
+    CUAssertLog(batch->getLabelCount() == 2, "Method add() failed");
+    CUAssertLog(batch->getPageCount() == 2,  "Method add() failed");
+    
+    sprites->begin(Mat4::IDENTITY);
+    batch->draw(sprites);
+    CUAssertLog(sprites->getTexture() != SpriteBatch::getBlankTexture(),
+                "Method draw() drew a background over the text");
+    sprites->end();
+    
+    batch->clear();
+    CULog("TextBatch tests complete.\n");
+}
+
+
 #pragma mark -
 #pragma mark Main
     
 void sceneUnitTest() {
     testNode();
+    testTextBatch();
 }
     
 }
@@ -12,6 +12,8 @@
 namespace cugl {
     
 void testNode();
+
+void testTextBatch();
     
 void sceneUnitTest();
     
@@ -0,0 +1,1542 @@
+//
+//  TCUAudioTest.cpp
+//  CUGL
+//
+//  Created by Walker White on 10/18/26.
+//  Copyright © 2026 Game Design Initiative at Cornell. All rights reserved.
+//
+
+#include "TCUAudioTest.h"
+#include <string>
+#include <vector>
+#include "CUDebug.h"
+#include "CUTimestamp.h"
+#include "CUSoundMixer.h"
+#include "CUSoundStream.h"
+#include "CUSampleCache.h"
+#include "CUAudioSIMD.h"
+#include <cugl/audio/CUAudioRecorder.h>
+#include <cugl/audio/CUAudioEngine.h>
+#include <cugl/audio/CUSound.h>
+#include <cugl/audio/CUMusic.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/io/CUPathname.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Sound Mixer
+
+void testSoundMixer() {
+    CULog("Running tests for SoundMixer.\n");
+    
+    std::vector<float> output;
+    Uint32 ended = 0;
+    bool   normal = false;
+    auto listener = [&](Uint32 voice, bool status) { ended++; normal = status; };
+
+#pragma mark Constructor Test
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(4,48000);
+    CUAssertLog(mixer != nullptr,                           "Method alloc() failed");
+    CUAssertLog(mixer->getCapacity() == 4,                  "Method alloc() failed");
+    CUAssertLog(mixer->getRate() == 48000,                  "Method alloc() failed");
+    CUAssertLog(!mixer->isPlaying(0),                       "Method alloc() failed");
+    
+    std::shared_ptr<PCMBuffer> mono = PCMBuffer::alloc(1,1000,48000);
+    CUAssertLog(mono != nullptr,                            "Method alloc() failed");
+    CUAssertLog(mono->getChannels() == 1,                   "Method alloc() failed");
+    CUAssertLog(mono->getFrames() == 1000,                  "Method alloc() failed");
+    CUAssertLog(((uintptr_t)mono->getData() & 15) == 0,     "Method alloc() failed");
+    for(Uint32 ii = 0; ii < 1000; ii++) {
+        mono->getData()[ii] = 0.5f;
+    }
+
+#pragma mark Playback Test
+    mixer->play(0,mono,1.0f,false);
+    CUAssertLog(mixer->isPlaying(0),                        "Method play() failed");
+    CUAssertLog(mono.use_count() == 2,                      "Method play() failed");
+    output.assign(2*2000,0.0f);
+    mixer->mix(output.data(),2000);
+    CUAssertLog(output[0] == 0.5f && output[1] == 0.5f,     "Method mix() failed");
+    CUAssertLog(output[2*999+1] == 0.5f,                    "Method mix() failed");
+    CUAssertLog(output[2*1000] == 0.0f,                     "Method mix() failed");
+    CUAssertLog(mixer->isPlaying(0),                        "Method mix() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && normal,                       "Method poll() failed");
+    CUAssertLog(!mixer->isPlaying(0),                       "Method poll() failed");
+    CUAssertLog(mono.use_count() == 1,                      "Method poll() failed");
+
+#pragma mark Stop Test
+    ended = 0;
+    mixer->play(1,mono,0.5f,true);
+    output.assign(2*1500,0.0f);
+    mixer->mix(output.data(),1500);
+    CUAssertLog(output[2*1200] == 0.25f,                    "Method setLoop() failed");
+    mixer->stop(1);
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[0] > 0.0f && output[0] <= 0.25f,     "Method stop() failed");
+    CUAssertLog(output[2*MIXER_RAMP_FRAMES/2] < 0.25f,      "Method stop() failed");
+    CUAssertLog(output[2*MIXER_RAMP_FRAMES] == 0.0f,        "Method stop() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && !normal,                      "Method stop() failed");
+    CUAssertLog(mono.use_count() == 1,                      "Method stop() failed");
+
+#pragma mark Pause Test
+    mixer->play(2,mono,1.0f,true);
+    output.assign(2*100,0.0f);
+    mixer->mix(output.data(),100);
+    CUAssertLog(mixer->getFrame(2) == 100,                  "Method getFrame() failed");
+    mixer->pause(2);
+    CUAssertLog(mixer->isPaused(2),                         "Method pause() failed");
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    Uint64 frame = mixer->getFrame(2);
+    CUAssertLog(frame == 100+MIXER_RAMP_FRAMES,             "Method pause() failed");
+    CUAssertLog(output[2*MIXER_RAMP_FRAMES] == 0.0f,        "Method pause() failed");
+    mixer->mix(output.data(),1024);
+    CUAssertLog(mixer->getFrame(2) == frame,                "Method pause() failed");
+    mixer->setFrame(2,10);
+    CUAssertLog(mixer->getFrame(2) == 10,                   "Method setFrame() failed");
+    mixer->resume(2);
+    CUAssertLog(!mixer->isPaused(2),                        "Method resume() failed");
+    mixer->mix(output.data(),100);
+    CUAssertLog(mixer->getFrame(2) == 110,                  "Method resume() failed");
+    mixer->mix(output.data(),MIXER_RAMP_FRAMES);
+    mixer->expire(2,50);
+    output.assign(2*100,0.0f);
+    mixer->mix(output.data(),100);
+    CUAssertLog(output[2*49] == 0.5f,                       "Method expire() failed");
+    CUAssertLog(output[2*50] > 0.49f,                       "Method expire() failed");
+    CUAssertLog(output[2*60] < 0.5f,                        "Method expire() failed");
+    mixer->poll(listener);
+    CUAssertLog(!mixer->isPlaying(2),                       "Method expire() failed");
+
+#pragma mark Saturation Test
+    std::shared_ptr<PCMBuffer> loud = PCMBuffer::alloc(2,64,48000);
+    for(Uint32 ii = 0; ii < 128; ii++) {
+        loud->getData()[ii] = 1.0f;
+    }
+    mixer->play(0,loud,1.0f,false);
+    mixer->play(1,loud,1.0f,false);
+    std::vector<Sint16> pcm(2*64,0);
+    mixer->mix(pcm.data(),64,2);
+    CUAssertLog(pcm[0] == 32767 && pcm[127] == 32767,       "Method mix() failed");
+    mixer->mix(pcm.data(),64,2);
+    mixer->poll(listener);
+    CUAssertLog(loud.use_count() == 1,                      "Method mix() failed");
+
+#pragma mark Notice Test
+    // Far more notices than the queue holds, without polling
+    ended = 0;
+    output.assign(2*64,0.0f);
+    for(Uint32 ii = 0; ii < 300; ii++) {
+        mixer->play(ii % 4,loud,1.0f,false);
+        mixer->mix(output.data(),64);
+    }
+    for(Uint32 ii = 0; ii < 16 && ended < 300; ii++) {
+        mixer->poll(listener);
+        mixer->mix(output.data(),64);
+    }
+    mixer->poll(listener);
+    CUAssertLog(ended == 300,                               "Method poll() failed");
+    CUAssertLog(loud.use_count() == 1,                      "Method poll() failed");
+
+    mixer = nullptr;
+    
+#pragma mark Complete
+    CULog("SoundMixer tests complete.\n");
+}
+
+void benchSoundMixer() {
+    const Uint32 voices = 64;
+    const Uint32 frames = 48000;
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(voices,frames);
+    std::shared_ptr<PCMBuffer> buffer = PCMBuffer::alloc(2,frames,frames);
+    for(Uint32 ii = 0; ii < 2*frames; ii++) {
+        buffer->getData()[ii] = (ii % 100)/100.0f-0.5f;
+    }
+    for(Uint32 ii = 0; ii < voices; ii++) {
+        mixer->play(ii,buffer,1.0f/voices,true,(ii*97) % frames);
+    }
+    
+    std::vector<Sint16> output(2*MIXER_BLOCK_FRAMES,0);
+    timestamp_t start = cuclock_t::now();
+    for(Uint32 ii = 0; ii < frames; ii += MIXER_BLOCK_FRAMES) {
+        mixer->mix(output.data(),MIXER_BLOCK_FRAMES,2);
+    }
+    timestamp_t end = cuclock_t::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Mixed %d voices for 1 second of audio in %.3f ms (%.1f voice-seconds per ms).",
+          voices,millis,voices/millis);
+}
+
+
+#pragma mark -
+#pragma mark Sound Stream
+/**
+ * A synthetic stream whose samples are a function of the frame index.
+ *
+ * This allows us to verify that every frame arrives exactly where it
+ * should, without needing an audio file.
+ */
+class TestStream : public SoundStream {
+private:
+    /** The codec position */
+    Uint64 _cursor;
+    
+public:
+    /** Returns the sample value for the given frame and channel */
+    static float sample(Uint64 frame, Uint32 channel) {
+        return ((frame % 997)+channel)/1024.0f;
+    }
+    
+    TestStream() : _cursor(0) {}
+    
+    bool init(Uint32 channels, Uint64 frames, Uint64 start) {
+        _channels = channels;
+        _frames = frames;
+        _rate = 48000;
+        return initBuffers(start);
+    }
+    
+    static std::shared_ptr<TestStream> alloc(Uint32 channels, Uint64 frames, Uint64 start=0) {
+        std::shared_ptr<TestStream> result = std::make_shared<TestStream>();
+        return (result->init(channels,frames,start) ? result : nullptr);
+    }
+    
+protected:
+    Uint32 decode(float* output, Uint32 frames) override {
+        // Deliberately return short reads to exercise the decode loop
+        Uint32 amount = frames < 300 ? frames : 300;
+        if (_frames-_cursor < amount) {
+            amount = (Uint32)(_frames-_cursor);
+        }
+        for(Uint32 ii = 0; ii < amount; ii++) {
+            for(Uint32 jj = 0; jj < _channels; jj++) {
+                output[ii*_channels+jj] = sample(_cursor+ii,jj);
+            }
+        }
+        _cursor += amount;
+        return amount;
+    }
+    
+    bool reposition(Uint64 frame) override {
+        _cursor = frame;
+        return true;
+    }
+};
+
+/**
+ * Reads the given number of frames from a stream, checking each sample.
+ *
+ * The decoder is run synchronously whenever the stream runs dry.
+ *
+ * @return true if every frame matched the expected sample
+ */
+static bool readStream(const std::shared_ptr<TestStream>& stream, Uint64 start, Uint64 frames) {
+    Uint32 channels = stream->getChannels();
+    Uint64 position = start;
+    while (frames > 0) {
+        const float* data = nullptr;
+        Uint32 available = stream->acquire(&data);
+        if (available == 0) {
+            stream->fill();
+            continue;
+        }
+        Uint32 amount = available < frames ? available : (Uint32)frames;
+        for(Uint32 ii = 0; ii < amount; ii++) {
+            Uint64 frame = (position+ii) % stream->getFrames();
+            for(Uint32 jj = 0; jj < channels; jj++) {
+                if (data[ii*channels+jj] != TestStream::sample(frame,jj)) {
+                    return false;
+                }
+            }
+        }
+        stream->consume(amount);
+        position += amount;
+        frames -= amount;
+    }
+    return true;
+}
+
+void testSoundStream() {
+    CULog("Running tests for SoundStream.\n");
+    
+    std::vector<float> output;
+    Uint32 ended = 0;
+    bool   normal = false;
+    auto listener = [&](Uint32 voice, bool status) { ended++; normal = status; };
+    
+#pragma mark Priming Test
+    std::shared_ptr<TestStream> stream = TestStream::alloc(2,10000);
+    CUAssertLog(stream != nullptr,                          "Method alloc() failed");
+    CUAssertLog(stream->getChannels() == 2,                 "Method alloc() failed");
+    CUAssertLog(stream->getFrames() == 10000,               "Method alloc() failed");
+    const float* data = nullptr;
+    CUAssertLog(stream->acquire(&data) == STREAM_CHUNK_FRAMES, "Method acquire() failed");
+    CUAssertLog(data[0] == TestStream::sample(0,0),         "Method acquire() failed");
+    CUAssertLog(data[1] == TestStream::sample(0,1),         "Method acquire() failed");
+    CUAssertLog(stream->getUnderruns() == 0,                "Method acquire() failed");
+    CUAssertLog(stream->getMemoryUsage() > STREAM_CHUNK_COUNT*STREAM_CHUNK_FRAMES*2*sizeof(float),
+                                                            "Method getMemoryUsage() failed");
+    
+#pragma mark Loop Test
+    // Chunks never straddle the end, so the loop seam is exact
+    CUAssertLog(readStream(stream,0,25000),                 "Method fill() failed");
+    
+#pragma mark Seek Test
+    // The synchronous reads above ran dry whenever the stream was drained
+    Uint32 underruns = stream->getUnderruns();
+    stream->seek(1234);
+    CUAssertLog(stream->acquire(&data) == 0,                "Method seek() failed");
+    CUAssertLog(stream->getUnderruns() == underruns+1,      "Method seek() failed");
+    CUAssertLog(stream->fill(),                             "Method fill() failed");
+    CUAssertLog(readStream(stream,1234,10000),              "Method seek() failed");
+    stream->seek(9999);
+    stream->seek(50);
+    CUAssertLog(readStream(stream,50,3000),                 "Method seek() failed");
+    
+    stream = TestStream::alloc(1,5000,4000);
+    CUAssertLog(readStream(stream,4000,2000),               "Method alloc() failed");
+    stream = TestStream::alloc(1,5000,8000);
+    CUAssertLog(readStream(stream,0,100),                   "Method alloc() failed");
+    
+#pragma mark Mixer Test
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(2,48000);
+    stream = TestStream::alloc(2,3000);
+    mixer->play(0,stream,1.0f,true);
+    CUAssertLog(stream.use_count() == 2,                    "Method play() failed");
+    
+    bool match = true;
+    Uint64 frame = 0;
+    output.resize(2*MIXER_BLOCK_FRAMES);
+    for(Uint32 ii = 0; ii < 16; ii++) {
+        stream->fill();
+        output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+        mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+        for(Uint32 jj = 0; jj < MIXER_BLOCK_FRAMES; jj++) {
+            Uint64 pos = (frame+jj) % 3000;
+            match = match && output[2*jj  ] == TestStream::sample(pos,0);
+            match = match && output[2*jj+1] == TestStream::sample(pos,1);
+        }
+        frame += MIXER_BLOCK_FRAMES;
+    }
+    CUAssertLog(match,                                      "Method mix() failed");
+    CUAssertLog(mixer->getFrame(0) == frame % 3000,         "Method mix() failed");
+    
+    // Seeking fades out, seeks, and then fades in
+    mixer->setFrame(0,100);
+    CUAssertLog(mixer->getFrame(0) == 100,                  "Method setFrame() failed");
+    output.assign(2*MIXER_RAMP_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_RAMP_FRAMES);
+    CUAssertLog(mixer->getFrame(0) == 100,                  "Method setFrame() failed");
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(output[0] == 0.0f,                          "Method setFrame() failed");
+    CUAssertLog(mixer->getFrame(0) == 100,                  "Method setFrame() failed");
+    stream->fill();
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(mixer->getFrame(0) == 100+MIXER_BLOCK_FRAMES, "Method setFrame() failed");
+    CUAssertLog(output[2*300] == TestStream::sample(400,0), "Method setFrame() failed");
+    
+    // Underruns are silent, but do not lose our place
+    underruns = stream->getUnderruns();
+    for(Uint32 ii = 0; ii < 8*STREAM_CHUNK_COUNT; ii++) {
+        mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    }
+    CUAssertLog(stream->getUnderruns() > underruns,         "Method mix() failed");
+    frame = mixer->getFrame(0);
+    stream->fill();
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(output[0] == TestStream::sample(frame % 3000,0), "Method mix() failed");
+    
+    mixer->stop(0);
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && !normal,                      "Method stop() failed");
+    CUAssertLog(stream.use_count() == 1,                    "Method stop() failed");
+    
+#pragma mark Service Test
+    std::shared_ptr<StreamService> service = StreamService::alloc();
+    CUAssertLog(service != nullptr,                         "Method alloc() failed");
+    stream = TestStream::alloc(1,50000);
+    service->add(stream);
+    CUAssertLog(service->size() == 1,                       "Method add() failed");
+    stream->seek(20000);
+    Uint32 available = 0;
+    for(Uint32 ii = 0; ii < 1000 && available == 0; ii++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        available = stream->acquire(&data);
+    }
+    CUAssertLog(available > 0,                              "Method add() failed");
+    CUAssertLog(data[0] == TestStream::sample(20000,0),     "Method add() failed");
+    stream = nullptr;
+    for(Uint32 ii = 0; ii < 1000 && service->size() > 0; ii++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CUAssertLog(service->size() == 0,                       "Method add() failed");
+    service->dispose();
+    
+    // Without a thread, streams only decode when pumped
+    service = StreamService::alloc(false);
+    CUAssertLog(service != nullptr,                         "Method alloc() failed");
+    stream = TestStream::alloc(1,50000);
+    service->add(stream);
+    stream->seek(20000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CUAssertLog(stream->acquire(&data) == 0,                "Method alloc() failed");
+    service->pump();
+    available = stream->acquire(&data);
+    CUAssertLog(available > 0,                              "Method pump() failed");
+    CUAssertLog(data[0] == TestStream::sample(20000,0),     "Method pump() failed");
+    stream = nullptr;
+    service->pump();
+    CUAssertLog(service->size() == 0,                       "Method pump() failed");
+    service->dispose();
+    
+    mixer = nullptr;
+    
+#pragma mark Complete
+    CULog("SoundStream tests complete.\n");
+}
+
+void benchSoundStream() {
+    const Uint32 rate = 48000;
+    const Uint64 frames = 60*rate;
+    
+    // Memory for one minute of stereo audio
+    size_t pcmbytes = (size_t)(frames*2*sizeof(float));
+    std::shared_ptr<TestStream> stream = TestStream::alloc(2,frames);
+    CULog("One minute of stereo PCM uses %zu KB; a stream instance uses %zu KB.",
+          pcmbytes/1024,stream->getMemoryUsage()/1024);
+
+    // Overhead of mixing from a stream instead of a buffer
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(1,rate);
+    std::vector<float> output(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->play(0,stream,1.0f,true);
+    timestamp_t start = cuclock_t::now();
+    for(Uint32 ii = 0; ii < rate; ii += MIXER_BLOCK_FRAMES) {
+        stream->fill();
+        mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    }
+    timestamp_t end = cuclock_t::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Streamed (synthetic) 1 second of audio in %.3f ms.",millis);
+    mixer = nullptr;
+    stream = nullptr;
+    
+    // Actual decode cost, if we have a file to test with
+    const char* file = "sounds/stream.ogg";
+    std::shared_ptr<std::string> source = VorbisStream::load(file);
+    std::shared_ptr<VorbisStream> vorbis = VorbisStream::alloc(source);
+    if (vorbis == nullptr) {
+        CULog("Skipping Vorbis benchmark; %s not found.",file);
+        return;
+    }
+    
+    Uint64 decoded = 0;
+    const float* data = nullptr;
+    start = cuclock_t::now();
+    while (decoded < vorbis->getFrames()) {
+        Uint32 available = vorbis->acquire(&data);
+        if (available == 0) {
+            vorbis->fill();
+        } else {
+            vorbis->consume(available);
+            decoded += available;
+        }
+    }
+    end = cuclock_t::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    double seconds = (double)vorbis->getFrames()/vorbis->getRate();
+    pcmbytes = (size_t)(vorbis->getFrames()*vorbis->getChannels()*sizeof(float));
+    CULog("Decoded %.1f seconds of Vorbis in %.3f ms (%.3f ms per second of audio).",
+          seconds,millis,millis/seconds);
+    CULog("Vorbis stream uses %zu KB compressed + %zu KB decode buffers versus %zu KB of PCM.",
+          source->size()/1024,vorbis->getMemoryUsage()/1024,pcmbytes/1024);
+}
+
+
+#pragma mark -
+#pragma mark Spatial Audio
+
+void testSpatialAudio() {
+    CULog("Running tests for spatial audio.\n");
+    
+    std::vector<float> output;
+    const float root = 0.70710678f;
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(4,48000);
+    std::shared_ptr<PCMBuffer> mono = PCMBuffer::alloc(1,48000,48000);
+    for(Uint32 ii = 0; ii < 48000; ii++) {
+        mono->getData()[ii] = 0.5f;
+    }
+
+#pragma mark Pan Test
+    // The first block snaps to the emitter, so there is no ramp
+    mixer->setEmitter(0,Vec2(-10,0),Vec2::ZERO,1,FLT_MAX,1);
+    mixer->play(0,mono,1.0f,true);
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(output[0]-0.05f) < 1e-4f,         "Method setEmitter() failed");
+    CUAssertLog(std::fabs(output[1]) < 1e-4f,               "Method setEmitter() failed");
+
+    // Later changes ramp across a single block
+    mixer->setEmitter(0,Vec2(0,0.5f),Vec2::ZERO,1,FLT_MAX,1);
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(output[0]-0.05f) < 1e-4f,         "Method setEmitter() failed");
+    CUAssertLog(output[2*MIXER_BLOCK_FRAMES-1] > 0.3f,      "Method setEmitter() failed");
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(output[0]-0.5f*root) < 1e-4f,     "Method setEmitter() failed");
+    CUAssertLog(std::fabs(output[1]-0.5f*root) < 1e-4f,     "Method setEmitter() failed");
+
+#pragma mark Attenuation Test
+    mixer->setEmitter(0,Vec2(0,2),Vec2::ZERO,1,FLT_MAX,1);
+    output.assign(4*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),2*MIXER_BLOCK_FRAMES);
+    float* last = output.data()+2*(2*MIXER_BLOCK_FRAMES-1);
+    CUAssertLog(std::fabs(last[0]-0.25f*root) < 1e-4f,      "Method setEmitter() failed");
+    
+    mixer->setDistanceModel(AudioEngine::DistanceModel::LINEAR);
+    mixer->setEmitter(0,Vec2(0,3),Vec2::ZERO,1,5,1);
+    output.assign(4*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),2*MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(last[1]-0.25f*root) < 1e-4f,      "Method setDistanceModel() failed");
+
+    mixer->setDistanceModel(AudioEngine::DistanceModel::EXPONENTIAL);
+    mixer->setEmitter(0,Vec2(0,4),Vec2::ZERO,1,FLT_MAX,0.5f);
+    output.assign(4*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),2*MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(last[0]-0.25f*root) < 1e-4f,      "Method setDistanceModel() failed");
+
+    // Moving the listener is the same as moving the emitter
+    mixer->setDistanceModel(AudioEngine::DistanceModel::INVERSE);
+    mixer->setEmitter(0,Vec2(0,2),Vec2::ZERO,1,FLT_MAX,1);
+    mixer->setListener(Vec2(0,4),Vec2::ZERO);
+    output.assign(4*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),2*MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(last[0]-0.25f*root) < 1e-4f,      "Method setListener() failed");
+    mixer->setListener(Vec2::ZERO,Vec2::ZERO);
+
+#pragma mark Doppler Test
+    // Approaching at half the speed of sound doubles the pitch
+    mixer->setDoppler(1,343.3f);
+    mixer->setEmitter(0,Vec2(0,10),Vec2(0,-171.65f),1,FLT_MAX,1);
+    Uint64 frame = mixer->getFrame(0);
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    Uint64 delta = mixer->getFrame(0)-frame;
+    CUAssertLog(delta+2 >= 2*MIXER_BLOCK_FRAMES && delta <= 2*MIXER_BLOCK_FRAMES,
+                "Method setDoppler() failed");
+    mixer->setDoppler(0,343.3f);
+    frame = mixer->getFrame(0);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(mixer->getFrame(0)-frame == MIXER_BLOCK_FRAMES,"Method setDoppler() failed");
+
+#pragma mark Clear Test
+    mixer->clearEmitter(0);
+    output.assign(4*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),2*MIXER_BLOCK_FRAMES);
+    CUAssertLog(last[0] == 0.5f && last[1] == 0.5f,         "Method clearEmitter() failed");
+    mixer->stop(0);
+    mixer = nullptr;
+
+#pragma mark Complete
+    CULog("Spatial audio tests complete.\n");
+}
+
+void benchSpatialAudio() {
+    const Uint32 voices = 64;
+    const Uint32 frames = 48000;
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(voices,frames);
+    std::shared_ptr<PCMBuffer> buffer = PCMBuffer::alloc(2,frames,frames);
+    for(Uint32 ii = 0; ii < 2*frames; ii++) {
+        buffer->getData()[ii] = (ii % 100)/100.0f-0.5f;
+    }
+    for(Uint32 ii = 0; ii < voices; ii++) {
+        mixer->setEmitter(ii,Vec2((float)ii-32,(float)(ii % 7)),Vec2::ZERO,1,100,1);
+        mixer->play(ii,buffer,1.0f/voices,true,(ii*97) % frames);
+    }
+    
+    // Move the listener every block, as a game would every frame
+    std::vector<Sint16> output(2*MIXER_BLOCK_FRAMES,0);
+    timestamp_t start = cuclock_t::now();
+    for(Uint32 ii = 0; ii < frames; ii += MIXER_BLOCK_FRAMES) {
+        mixer->setListener(Vec2(std::sin(ii/4800.0f)*32,0),Vec2::ZERO);
+        mixer->mix(output.data(),MIXER_BLOCK_FRAMES,2);
+    }
+    timestamp_t end = cuclock_t::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Mixed %d positional voices for 1 second of audio in %.3f ms (%.1f voice-seconds per ms).",
+          voices,millis,voices/millis);
+}
+
+#pragma mark -
+#pragma mark Audio Buses
+
+/**
+ * Returns the left sample of the last frame after mixing the given blocks
+ *
+ * @param mixer     The mixer
+ * @param blocks    The number of blocks to mix
+ *
+ * @return the left sample of the last frame after mixing the given blocks
+ */
+static float mixBlocks(const std::shared_ptr<SoundMixer>& mixer, Uint32 blocks) {
+    std::vector<float> output(2*MIXER_BLOCK_FRAMES,0.0f);
+    for(Uint32 ii = 0; ii < blocks; ii++) {
+        std::fill(output.begin(),output.end(),0.0f);
+        mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    }
+    return output[2*MIXER_BLOCK_FRAMES-2];
+}
+
+void testAudioBus() {
+    CULog("Running tests for AudioBus.\n");
+    
+    const Uint32 rate = 48000;
+    const float pi = 3.14159265f;
+    std::vector<float> output;
+    std::shared_ptr<PCMBuffer> mono = PCMBuffer::alloc(1,rate,rate);
+    for(Uint32 ii = 0; ii < rate; ii++) {
+        mono->getData()[ii] = 0.5f;
+    }
+
+#pragma mark Graph Test
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(4,rate);
+    CUAssertLog(mixer->getBusCount() == 4,                  "Method init() failed");
+    CUAssertLog(mixer->getBus(AudioBus::MASTER)->isMaster(),"Method init() failed");
+    CUAssertLog(mixer->getBus("sound")->getIndex() == AudioBus::SOUND, "Method getBus() failed");
+    CUAssertLog(mixer->getBus("sound")->getParent() == AudioBus::MASTER, "Method getBus() failed");
+    CUAssertLog(mixer->getBus(7) == nullptr,                "Method getBus() failed");
+    CUAssertLog(mixer->getBus("none") == nullptr,           "Method getBus() failed");
+    
+    std::shared_ptr<AudioBus> child = mixer->addBus("child",AudioBus::SOUND);
+    CUAssertLog(child != nullptr && child->getIndex() == 4, "Method addBus() failed");
+    CUAssertLog(child->getParent() == AudioBus::SOUND,      "Method addBus() failed");
+    CUAssertLog(!child->isMaster(),                         "Method addBus() failed");
+    CUAssertLog(mixer->getBusCount() == 5,                  "Method addBus() failed");
+
+#pragma mark Gain Test
+    // Gain changes ramp across a single block
+    mixer->play(0,mono,1.0f,true);
+    CUAssertLog(mixBlocks(mixer,1) == 0.5f,                 "Method mix() failed");
+    mixer->getBus(AudioBus::SOUND)->setGain(0.5f);
+    CUAssertLog(mixer->getBus(AudioBus::SOUND)->getGain() == 0.5f, "Method setGain() failed");
+    CUAssertLog(std::fabs(mixBlocks(mixer,1)-0.25f) < 1e-3f,"Method setGain() failed");
+    CUAssertLog(mixBlocks(mixer,1) == 0.25f,                "Method setGain() failed");
+    float level = mixer->getBus(AudioBus::SOUND)->getLevel();
+    CUAssertLog(std::fabs(level-0.25f) < 1e-4f,             "Method getLevel() failed");
+    CUAssertLog(mixer->getBus(AudioBus::MUSIC)->getLevel() == 0, "Method getLevel() failed");
+    
+    // Child buses mix into their parent
+    mixer->setBus(1,child->getIndex());
+    mixer->play(1,mono,1.0f,true);
+    CUAssertLog(mixBlocks(mixer,1) == 0.5f,                 "Method setBus() failed");
+    child->setGain(0);
+    CUAssertLog(mixBlocks(mixer,2) == 0.25f,                "Method setBus() failed");
+    mixer->stop(0);
+    mixer->stop(1);
+    mixBlocks(mixer,1);
+    mixer->poll(nullptr);
+
+#pragma mark Input Test
+    // The output buffer is routed through the input bus
+    mixer = SoundMixer::alloc(4,rate);
+    mixer->setInput(AudioBus::MUSIC);
+    mixer->getBus(AudioBus::MUSIC)->setGain(0.5f);
+    output.assign(2*MIXER_BLOCK_FRAMES,0.8f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    output.assign(2*MIXER_BLOCK_FRAMES,0.8f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(output[0]-0.4f) < 1e-6f,          "Method setInput() failed");
+    std::vector<Sint16> pcm(MIXER_BLOCK_FRAMES,16000);
+    mixer->mix(pcm.data(),MIXER_BLOCK_FRAMES,1);
+    CUAssertLog(std::abs(pcm[0]-8000) <= 1,                 "Method setInput() failed");
+    mixer->clearInput();
+    output.assign(2*MIXER_BLOCK_FRAMES,0.8f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(output[0] == 0.8f,                          "Method clearInput() failed");
+
+#pragma mark Biquad Test
+    std::shared_ptr<BiquadNode> biquad = BiquadNode::alloc(rate,BiquadNode::Type::LOWPASS,500);
+    CUAssertLog(biquad != nullptr,                          "Method alloc() failed");
+    CUAssertLog(biquad->getType() == BiquadNode::Type::LOWPASS, "Method alloc() failed");
+    output.resize(2*MIXER_BLOCK_FRAMES);
+    float peak = 0;
+    for(Uint32 block = 0; block < 8; block++) {
+        for(Uint32 ii = 0; ii < MIXER_BLOCK_FRAMES; ii++) {
+            float t = (float)(block*MIXER_BLOCK_FRAMES+ii)/rate;
+            output[2*ii] = output[2*ii+1] = std::sin(2*pi*10000*t);
+        }
+        biquad->render(output.data(),MIXER_BLOCK_FRAMES);
+        if (block == 7) {
+            for(Uint32 ii = 0; ii < 2*MIXER_BLOCK_FRAMES; ii++) {
+                peak = std::max(peak,std::fabs(output[ii]));
+            }
+        }
+    }
+    CUAssertLog(peak < 0.01f,                               "Method process() failed");
+    output.assign(2*MIXER_BLOCK_FRAMES,1.0f);
+    for(Uint32 block = 0; block < 8; block++) {
+        std::fill(output.begin(),output.end(),1.0f);
+        biquad->render(output.data(),MIXER_BLOCK_FRAMES);
+    }
+    CUAssertLog(std::fabs(output[0]-1.0f) < 1e-3f,          "Method process() failed");
+    CUAssertLog(std::fabs(output[1]-1.0f) < 1e-3f,          "Method process() failed");
+    
+    // A bypassed node does nothing
+    biquad->setBypass(true);
+    biquad->setType(BiquadNode::Type::HIGHPASS);
+    std::fill(output.begin(),output.end(),1.0f);
+    biquad->render(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(output[0] == 1.0f,                          "Method setBypass() failed");
+    biquad->setBypass(false);
+    biquad->reset();
+    for(Uint32 block = 0; block < 8; block++) {
+        std::fill(output.begin(),output.end(),1.0f);
+        biquad->render(output.data(),MIXER_BLOCK_FRAMES);
+    }
+    CUAssertLog(std::fabs(output[0]) < 1e-3f,               "Method setType() failed");
+
+#pragma mark Compressor Test
+    // A ratio of 4 above -12 dB maps 0 dB to -9 dB
+    std::shared_ptr<CompressorNode> compressor = CompressorNode::alloc(rate,-12,4);
+    for(Uint32 block = 0; block < 100; block++) {
+        std::fill(output.begin(),output.end(),1.0f);
+        compressor->render(output.data(),MIXER_BLOCK_FRAMES);
+    }
+    CUAssertLog(std::fabs(output[0]-0.3548f) < 1e-3f,       "Method process() failed");
+    CUAssertLog(std::fabs(compressor->getReduction()-9.0f) < 0.05f, "Method getReduction() failed");
+    
+    // A limiter never exceeds its ceiling, even on the first frame
+    std::shared_ptr<CompressorNode> limiter = CompressorNode::allocLimiter(rate,-1);
+    CUAssertLog(limiter->getName() == "limiter",            "Method allocLimiter() failed");
+    const float ceiling = std::pow(10.0f,-1/20.0f)+1e-5f;
+    peak = 0;
+    for(Uint32 block = 0; block < 20; block++) {
+        for(Uint32 ii = 0; ii < MIXER_BLOCK_FRAMES; ii++) {
+            float t = (float)(block*MIXER_BLOCK_FRAMES+ii)/rate;
+            float amp = block < 10 ? 2.0f : 0.5f;
+            output[2*ii] = output[2*ii+1] = amp*std::sin(2*pi*220*t);
+        }
+        limiter->render(output.data(),MIXER_BLOCK_FRAMES);
+        for(Uint32 ii = 0; ii < 2*MIXER_BLOCK_FRAMES; ii++) {
+            peak = std::max(peak,std::fabs(output[ii]));
+        }
+    }
+    CUAssertLog(peak <= ceiling && peak > 0.8f,             "Method allocLimiter() failed");
+
+#pragma mark Reverb Test
+    std::shared_ptr<ReverbNode> reverb = ReverbNode::alloc(rate);
+    CUAssertLog(reverb != nullptr,                          "Method alloc() failed");
+    float tail = 0;
+    for(Uint32 block = 0; block < 8; block++) {
+        std::fill(output.begin(),output.end(),0.0f);
+        if (block == 0) {
+            output[0] = output[1] = 1.0f;
+        }
+        reverb->render(output.data(),MIXER_BLOCK_FRAMES);
+        if (block == 0) {
+            CUAssertLog(std::fabs(output[0]-1.0f) < 1e-3f,  "Method process() failed");
+        } else {
+            for(Uint32 ii = 0; ii < 2*MIXER_BLOCK_FRAMES; ii++) {
+                tail += std::fabs(output[ii]);
+            }
+        }
+    }
+    CUAssertLog(tail > 1e-3f,                               "Method process() failed");
+    reverb->reset();
+    std::fill(output.begin(),output.end(),0.0f);
+    reverb->render(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(output[2*MIXER_BLOCK_FRAMES-1]) < 1e-12f, "Method reset() failed");
+
+#pragma mark Ducker Test
+    // Dialogue ducks the sound effects by 12 dB
+    mixer = SoundMixer::alloc(4,rate);
+    std::shared_ptr<AudioBus> sounds = mixer->getBus(AudioBus::SOUND);
+    std::shared_ptr<AudioBus> voices = mixer->getBus(AudioBus::VOICE);
+    std::shared_ptr<DuckerNode> ducker = DuckerNode::alloc(rate,voices);
+    sounds->addNode(ducker);
+    CUAssertLog(sounds->getNodeCount() == 1,                "Method addNode() failed");
+    CUAssertLog(sounds->getNode(0) == ducker,               "Method getNode() failed");
+    CUAssertLog(sounds->getNode("ducker") == ducker,        "Method getNode() failed");
+    mixer->setBus(1,AudioBus::VOICE);
+    mixer->play(0,mono,1.0f,true);
+    mixer->play(1,mono,1.0f,true);
+    float ducked = 0.5f+0.5f*std::pow(10.0f,-12/20.0f);
+    CUAssertLog(std::fabs(mixBlocks(mixer,100)-ducked) < 1e-3f, "Method process() failed");
+    mixer->stop(1);
+    CUAssertLog(std::fabs(mixBlocks(mixer,300)-0.5f) < 2e-3f, "Method process() failed");
+    
+    // Bypassed nodes are skipped
+    mixer->play(1,mono,1.0f,true);
+    ducker->setBypass(true);
+    CUAssertLog(mixBlocks(mixer,2) == 1.0f,                 "Method setBypass() failed");
+
+#pragma mark Profile Test
+    CUAssertLog(ducker->getBlocks() > 0,                    "Method getBlocks() failed");
+    CUAssertLog(ducker->getCost() > 0,                      "Method getCost() failed");
+    CUAssertLog(ducker->getLoad() > 0,                      "Method getLoad() failed");
+    std::string profile = sounds->getProfile();
+    CUAssertLog(profile.find("ducker") != std::string::npos,"Method getProfile() failed");
+    ducker->resetCost();
+    CUAssertLog(ducker->getBlocks() == 0,                   "Method resetCost() failed");
+    
+    CUAssertLog(sounds->removeNode(ducker),                 "Method removeNode() failed");
+    CUAssertLog(!sounds->removeNode(ducker),                "Method removeNode() failed");
+    CUAssertLog(sounds->getNodeCount() == 0,                "Method removeNode() failed");
+
+#pragma mark Concurrency Test
+    // The audio thread keeps mixing while the graph is edited
+    std::atomic<bool> running(true);
+    std::thread audio([&] {
+        std::vector<float> block(2*MIXER_BLOCK_FRAMES,0.0f);
+        while (running.load()) {
+            mixer->mix(block.data(),MIXER_BLOCK_FRAMES);
+        }
+    });
+    for(Uint32 ii = 0; ii < 400; ii++) {
+        sounds->addNode(ducker);
+        sounds->insertNode(0,reverb);
+        profile = sounds->getProfile();
+        sounds->removeNode(ducker);
+        sounds->clearNodes();
+        if (ii % 100 == 0) {
+            std::shared_ptr<AudioBus> bus = mixer->addBus("extra",AudioBus::SOUND);
+            mixer->setBus(2,bus->getIndex());
+            mixer->play(2,mono,1.0f,false);
+        }
+    }
+    running.store(false);
+    audio.join();
+    CUAssertLog(mixer->getBusCount() == 8,                  "Method addBus() failed");
+    CUAssertLog(mixer->getBus("extra")->getIndex() == 4,    "Method addBus() failed");
+    CUAssertLog(sounds->getNodeCount() == 0,                "Method clearNodes() failed");
+
+    mixer->stop(0);
+    mixer->stop(1);
+    mixer = nullptr;
+
+#pragma mark Complete
+    CULog("AudioBus tests complete.\n");
+}
+
+void benchAudioBus() {
+    const Uint32 voices = 32;
+    const Uint32 frames = 48000;
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(voices,frames);
+    std::shared_ptr<PCMBuffer> buffer = PCMBuffer::alloc(2,frames,frames);
+    for(Uint32 ii = 0; ii < 2*frames; ii++) {
+        buffer->getData()[ii] = (ii % 100)/100.0f-0.5f;
+    }
+    for(Uint32 ii = 0; ii < voices; ii++) {
+        mixer->setBus(ii,ii % 2 ? AudioBus::SOUND : AudioBus::MUSIC);
+        mixer->play(ii,buffer,1.0f/voices,true,(ii*97) % frames);
+    }
+    
+    // A typical chain: EQ and reverb on effects, a limiter on master
+    std::shared_ptr<AudioBus> sounds = mixer->getBus(AudioBus::SOUND);
+    sounds->addNode(BiquadNode::alloc(frames,BiquadNode::Type::HIGHSHELF,4000,0.7071f,-6));
+    sounds->addNode(ReverbNode::alloc(frames));
+    mixer->getBus(AudioBus::MUSIC)->addNode(DuckerNode::alloc(frames,sounds));
+    mixer->getBus(AudioBus::MASTER)->addNode(CompressorNode::allocLimiter(frames));
+    
+    std::vector<Sint16> output(2*MIXER_BLOCK_FRAMES,0);
+    timestamp_t start = cuclock_t::now();
+    for(Uint32 ii = 0; ii < frames; ii += MIXER_BLOCK_FRAMES) {
+        mixer->mix(output.data(),MIXER_BLOCK_FRAMES,2);
+    }
+    timestamp_t end = cuclock_t::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Mixed %d voices through 4 effect nodes for 1 second of audio in %.3f ms.",voices,millis);
+    for(Uint32 ii = 0; ii < mixer->getBusCount(); ii++) {
+        CULog("%s",mixer->getBus(ii)->getProfile().c_str());
+    }
+}
+
+
+#pragma mark -
+#pragma mark Audio Recorder
+
+/**
+ * Returns a WAV recording of a short tone played through a new mixer
+ *
+ * @param rate      The sample rate
+ * @param source    The tone to play
+ * @param blocks    The number of blocks to record
+ *
+ * @return a WAV recording of a short tone played through a new mixer
+ */
+static std::vector<Uint8> recordTone(Uint32 rate, const std::shared_ptr<PCMBuffer>& source, Uint32 blocks) {
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(2,rate);
+    std::shared_ptr<AudioRecorder> recorder = AudioRecorder::alloc(2,rate,[=](float* buffer, Uint32 frames) {
+        mixer->mix(buffer,frames);
+    });
+    mixer->play(0,source,0.75f,false);
+    for(Uint32 ii = 0; ii < blocks; ii++) {
+        recorder->advance(MIXER_BLOCK_FRAMES);
+    }
+    return recorder->encode();
+}
+
+void testAudioRecorder() {
+    CULog("Running tests for AudioRecorder.\n");
+    
+    const Uint32 rate = 48000;
+    const Uint32 length = 1000;
+    std::shared_ptr<PCMBuffer> tone = PCMBuffer::alloc(1,length,rate);
+    for(Uint32 ii = 0; ii < length; ii++) {
+        tone->getData()[ii] = 0.5f*std::sin(ii*0.05f);
+    }
+
+#pragma mark Capture Test
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(2,rate);
+    std::shared_ptr<AudioRecorder> recorder = AudioRecorder::alloc(2,rate,[=](float* buffer, Uint32 frames) {
+        mixer->mix(buffer,frames);
+    });
+    CUAssertLog(recorder != nullptr,                        "Method alloc() failed");
+    CUAssertLog(recorder->getChannels() == 2,               "Method getChannels() failed");
+    CUAssertLog(recorder->getRate() == rate,                "Method getRate() failed");
+    CUAssertLog(recorder->isCapture(),                      "Method isCapture() failed");
+    
+    mixer->play(0,tone,1.0f,false);
+    const Uint32 blocks = (length+MIXER_BLOCK_FRAMES)/MIXER_BLOCK_FRAMES+1;
+    for(Uint32 ii = 0; ii < blocks; ii++) {
+        recorder->advance(MIXER_BLOCK_FRAMES);
+    }
+    CUAssertLog(recorder->getFrames() == blocks*MIXER_BLOCK_FRAMES, "Method advance() failed");
+    const std::vector<float>& samples = recorder->getSamples();
+    bool match = true;
+    for(Uint32 ii = 0; ii < blocks*MIXER_BLOCK_FRAMES; ii++) {
+        float expect = ii < length ? tone->getData()[ii] : 0.0f;
+        match = match && std::fabs(samples[2*ii]-expect) < 1e-6f && samples[2*ii] == samples[2*ii+1];
+    }
+    CUAssertLog(match,                                      "Method advance() failed");
+    Uint32 done = 0;
+    mixer->poll([&](Uint32 channel, bool normal) { done += normal ? 1 : 0; });
+    CUAssertLog(done == 1,                                  "Method advance() failed");
+    
+    // Uncaptured blocks are rendered but not kept
+    recorder->setCapture(false);
+    mixer->play(0,tone,1.0f,false);
+    const float* block = recorder->advance(MIXER_BLOCK_FRAMES);
+    CUAssertLog(std::fabs(block[2]-tone->getData()[1]) < 1e-6f, "Method setCapture() failed");
+    CUAssertLog(recorder->getFrames() == blocks*MIXER_BLOCK_FRAMES, "Method setCapture() failed");
+    
+#pragma mark Encoding Test
+    std::vector<Uint8> wav = recorder->encode();
+    Uint32 bytes = blocks*MIXER_BLOCK_FRAMES*2*sizeof(Sint16);
+    CUAssertLog(wav.size() == 44+bytes,                     "Method encode() failed");
+    CUAssertLog(std::memcmp(wav.data(),"RIFF",4) == 0,      "Method encode() failed");
+    CUAssertLog(std::memcmp(wav.data()+8,"WAVEfmt ",8) == 0,"Method encode() failed");
+    CUAssertLog(std::memcmp(wav.data()+36,"data",4) == 0,   "Method encode() failed");
+    CUAssertLog(wav[20] == 1 && wav[22] == 2 && wav[34] == 16, "Method encode() failed");
+    Uint32 field = wav[24] | (wav[25] << 8) | (wav[26] << 16) | (wav[27] << 24);
+    CUAssertLog(field == rate,                              "Method encode() failed");
+    field = wav[40] | (wav[41] << 8) | (wav[42] << 16) | (wav[43] << 24);
+    CUAssertLog(field == bytes,                             "Method encode() failed");
+    
+    wav = recorder->encode(true);
+    CUAssertLog(wav.size() == 44+2*bytes,                   "Method encode() failed");
+    CUAssertLog(wav[20] == 3 && wav[34] == 32,              "Method encode() failed");
+    
+    // Integer samples are clamped and rounded
+    const float edges[4] = { 1.0f, -1.0f, 0.25f, 2.0f };
+    AudioRecorder::encode(edges,2,2,rate,false,wav);
+    CUAssertLog(wav.size() == 44+8,                         "Method encode() failed");
+    CUAssertLog(wav[44] == 0xff && wav[45] == 0x7f,         "Method encode() failed");
+    CUAssertLog(wav[46] == 0x01 && wav[47] == 0x80,         "Method encode() failed");
+    CUAssertLog(wav[48] == 0x00 && wav[49] == 0x20,         "Method encode() failed");
+    CUAssertLog(wav[50] == 0xff && wav[51] == 0x7f,         "Method encode() failed");
+    
+    recorder->clear();
+    CUAssertLog(recorder->getFrames() == 0,                 "Method clear() failed");
+    
+#pragma mark Determinism Test
+    std::vector<Uint8> first  = recordTone(rate,tone,4);
+    std::vector<Uint8> second = recordTone(rate,tone,4);
+    CUAssertLog(first.size() == 44+4*MIXER_BLOCK_FRAMES*4, "Method encode() failed");
+    CUAssertLog(first == second,                            "Recording is not deterministic");
+    
+    recorder = nullptr;
+    mixer = nullptr;
+    
+#pragma mark Complete
+    CULog("AudioRecorder tests complete.\n");
+}
+
+
+#pragma mark -
+#pragma mark Music Scheduling
+
+void testMusicSchedule() {
+    CULog("Running tests for music scheduling.\n");
+    
+    std::vector<float> output;
+    Uint32 ended = 0;
+    bool   normal = false;
+    auto listener = [&](Uint32 voice, bool status) { ended++; normal = status; };
+    
+    std::shared_ptr<PCMBuffer> first = PCMBuffer::alloc(1,700,48000);
+    std::shared_ptr<PCMBuffer> second = PCMBuffer::alloc(1,1000,48000);
+    for(Uint32 ii = 0; ii < 700; ii++) {
+        first->getData()[ii] = 0.25f;
+    }
+    for(Uint32 ii = 0; ii < 1000; ii++) {
+        second->getData()[ii] = 0.5f;
+    }
+
+#pragma mark Schedule Test
+    std::shared_ptr<SoundMixer> mixer = SoundMixer::alloc(2,48000);
+    CUAssertLog(mixer->getTime() == 0,                      "Method getTime() failed");
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(mixer->getTime() == MIXER_BLOCK_FRAMES,     "Method getTime() failed");
+    
+    // Start in the middle of the next block
+    mixer->play(0,first,1.0f,false,0,mixer->getTime()+300);
+    output.assign(2*MIXER_BLOCK_FRAMES,0.0f);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    CUAssertLog(output[2*299] == 0.0f,                      "Method play() failed");
+    CUAssertLog(output[2*300] == 0.25f,                     "Method play() failed");
+    CUAssertLog(mixer->getFrame(0) == MIXER_BLOCK_FRAMES-300, "Method play() failed");
+    mixer->stop(0);
+    mixer->mix(output.data(),MIXER_BLOCK_FRAMES);
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && !normal,                      "Method play() failed");
+    
+    // A time in the past starts immediately
+    ended = 0;
+    mixer->play(0,first,1.0f,false,0,1);
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[0] == 0.25f,                         "Method play() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && normal,                       "Method play() failed");
+
+#pragma mark Gapless Test
+    ended = 0;
+    mixer->play(0,first,1.0f,false);
+    mixer->cue(0,second,1.0f,false);
+    CUAssertLog(mixer->isCued(0),                           "Method cue() failed");
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[2*699] == 0.25f,                     "Method cue() failed");
+    CUAssertLog(output[2*700] == 0.5f,                      "Method cue() failed");
+    CUAssertLog(output[2*1023+1] == 0.5f,                   "Method cue() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && normal,                       "Method cue() failed");
+    CUAssertLog(mixer->isPlaying(0) && !mixer->isCued(0),   "Method cue() failed");
+    CUAssertLog(mixer->getFrame(0) == 1024-700,             "Method cue() failed");
+    CUAssertLog(first.use_count() == 1,                     "Method cue() failed");
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[2*(1000-324)] == 0.0f,               "Method cue() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 2 && !mixer->isPlaying(0),         "Method cue() failed");
+    CUAssertLog(second.use_count() == 1,                    "Method cue() failed");
+
+#pragma mark Crossfade Test
+    ended = 0;
+    mixer->play(0,first,1.0f,false);
+    mixer->cue(0,second,1.0f,false,200);
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[2*499] == 0.25f,                     "Method cue() failed");
+    CUAssertLog(std::fabs(output[2*600]-0.375f) < 1e-4f,    "Method cue() failed");
+    CUAssertLog(output[2*700] == 0.5f,                      "Method cue() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && normal,                       "Method cue() failed");
+    CUAssertLog(first.use_count() == 1,                     "Method cue() failed");
+    CUAssertLog(mixer->getFrame(0) == 1024-500,             "Method cue() failed");
+    mixer->stop(0);
+    mixer->mix(output.data(),1024);
+    mixer->poll(listener);
+
+#pragma mark Uncue Test
+    ended = 0;
+    mixer->play(0,first,1.0f,false);
+    mixer->cue(0,second,1.0f,false);
+    mixer->uncue(0);
+    CUAssertLog(!mixer->isCued(0),                          "Method uncue() failed");
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[2*700] == 0.0f,                      "Method uncue() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && normal,                       "Method uncue() failed");
+    CUAssertLog(second.use_count() == 1,                    "Method uncue() failed");
+    
+    // A looping sound holds the cue until the loop is released
+    ended = 0;
+    mixer->play(0,first,1.0f,true);
+    mixer->cue(0,second,1.0f,false);
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[2*700] == 0.25f,                     "Method cue() failed");
+    mixer->setLoop(0,false);
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[2*(1400-1024)-2] == 0.25f,           "Method cue() failed");
+    CUAssertLog(output[2*(1400-1024)] == 0.5f,              "Method cue() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && mixer->isPlaying(0),          "Method cue() failed");
+
+#pragma mark Fade Test
+    ended = 0;
+    mixer->setLoop(0,true);
+    mixer->fadeOut(0,300);
+    output.assign(2*1024,0.0f);
+    mixer->mix(output.data(),1024);
+    CUAssertLog(output[0] == 0.5f,                          "Method fadeOut() failed");
+    CUAssertLog(std::fabs(output[2*150]-0.25f) < 1e-4f,     "Method fadeOut() failed");
+    CUAssertLog(output[2*300] == 0.0f,                      "Method fadeOut() failed");
+    mixer->poll(listener);
+    CUAssertLog(ended == 1 && !normal,                      "Method fadeOut() failed");
+    CUAssertLog(!mixer->isPlaying(0),                       "Method fadeOut() failed");
+    CUAssertLog(second.use_count() == 1,                    "Method fadeOut() failed");
+    
+    mixer = nullptr;
+    
+#pragma mark Complete
+    CULog("Music scheduling tests complete.\n");
+}
+
+
+#pragma mark -
+#pragma mark Sample Cache
+/**
+ * Returns a buffer with a sine tone (and a cosine tone in the right channel)
+ *
+ * @param channels  The number of channels
+ * @param frames    The number of frames
+ * @param rate      The sample rate
+ * @param freq      The tone frequency
+ *
+ * @return a buffer with a sine tone
+ */
+static std::shared_ptr<PCMBuffer> makeTone(Uint32 channels, Uint32 frames, Uint32 rate, double freq) {
+    std::shared_ptr<PCMBuffer> result = PCMBuffer::alloc(channels,frames,rate);
+    for(Uint32 ii = 0; ii < frames; ii++) {
+        double t = 2*3.14159265358979*freq*ii/rate;
+        result->getData()[ii*channels] = 0.5f*(float)std::sin(t);
+        if (channels == 2) {
+            result->getData()[ii*channels+1] = 0.5f*(float)std::cos(t);
+        }
+    }
+    return result;
+}
+
+void testSampleCache() {
+    CULog("Running tests for the sample cache.\n");
+    const double pi = 3.14159265358979;
+    
+#pragma mark Conversion Test
+    std::vector<Sint16> ints = { 0, 16384, -16384, 32767, -32768, 1, -1, 8192, 100 };
+    std::vector<float> floats(ints.size());
+    simd::s16_to_f32(floats.data(),ints.data(),(Uint32)ints.size());
+    for(size_t ii = 0; ii < ints.size(); ii++) {
+        CUAssertLog(floats[ii] == ints[ii]/32768.0f,            "Method s16_to_f32() failed");
+    }
+    std::vector<float> taps = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    CUAssertLog(simd::dot_f32(taps.data(),taps.data(),11) == 506.0f, "Method dot_f32() failed");
+
+#pragma mark Resample Test
+    std::shared_ptr<PCMBuffer> tone = makeTone(2,4800,48000,1000);
+    CUAssertLog(SampleCache::resample(tone,48000) == tone,      "Method resample() failed");
+    std::shared_ptr<PCMBuffer> down = SampleCache::resample(tone,44100);
+    CUAssertLog(down->getRate() == 44100,                       "Method resample() failed");
+    CUAssertLog(down->getChannels() == 2,                       "Method resample() failed");
+    CUAssertLog(down->getFrames() == 4410,                      "Method resample() failed");
+    float error = 0;
+    for(Uint32 ii = 100; ii < 4310; ii++) {
+        double t = 2*pi*1000*ii/44100.0;
+        error = std::max(error,std::fabs(down->getData()[2*ii  ]-0.5f*(float)std::sin(t)));
+        error = std::max(error,std::fabs(down->getData()[2*ii+1]-0.5f*(float)std::cos(t)));
+    }
+    CUAssertLog(error < 1e-3f,                                  "Method resample() failed");
+    
+    std::shared_ptr<PCMBuffer> up = SampleCache::resample(makeTone(1,2205,22050,440),48000);
+    CUAssertLog(up->getChannels() == 1 && up->getFrames() == 4800, "Method resample() failed");
+    error = 0;
+    for(Uint32 ii = 200; ii < 4600; ii++) {
+        double t = 2*pi*440*ii/48000.0;
+        error = std::max(error,std::fabs(up->getData()[ii]-0.5f*(float)std::sin(t)));
+    }
+    CUAssertLog(error < 1e-3f,                                  "Method resample() failed");
+    
+    // Tones above the new Nyquist frequency must be removed
+    std::shared_ptr<PCMBuffer> alias = SampleCache::resample(makeTone(1,4410,44100,15000),22050);
+    float peak = 0;
+    for(Uint32 ii = 100; ii < alias->getFrames()-100; ii++) {
+        peak = std::max(peak,std::fabs(alias->getData()[ii]));
+    }
+    CUAssertLog(peak < 0.01f,                                   "Method resample() failed");
+    
+#pragma mark Key Test
+    std::shared_ptr<SampleCache> cache = SampleCache::alloc(48000);
+    std::shared_ptr<SampleCache> other = SampleCache::alloc(44100);
+    std::string file1 = "RIFF....WAVEfmt sound one";
+    std::string file2 = "RIFF....WAVEfmt sound two";
+    CUAssertLog(cache->getKey(file1) == cache->getKey(std::string(file1)), "Method getKey() failed");
+    CUAssertLog(cache->getKey(file1) != cache->getKey(file2),   "Method getKey() failed");
+    CUAssertLog(cache->getKey(file1) != other->getKey(file1),   "Method getKey() failed");
+    
+#pragma mark Share Test
+    Uint64 key1 = cache->getKey(file1);
+    Uint64 key2 = cache->getKey(file2);
+    CUAssertLog(cache->acquire(key1) == nullptr,                "Method acquire() failed");
+    std::shared_ptr<PCMBuffer> first = PCMBuffer::alloc(2,1000,48000);
+    std::shared_ptr<PCMBuffer> copy  = PCMBuffer::alloc(2,1000,48000);
+    CUAssertLog(cache->insert(key1,first) == first,             "Method insert() failed");
+    CUAssertLog(cache->getShareCount(key1) == 1,                "Method insert() failed");
+    CUAssertLog(cache->acquire(key1) == first,                  "Method acquire() failed");
+    CUAssertLog(cache->getShareCount(key1) == 2,                "Method acquire() failed");
+    
+    // A second decode of the same contents is discarded
+    CUAssertLog(cache->insert(key1,copy) == first,              "Method insert() failed");
+    CUAssertLog(cache->getShareCount(key1) == 3,                "Method insert() failed");
+    CUAssertLog(cache->getSize() == 1,                          "Method insert() failed");
+    CUAssertLog(cache->getMemoryUsage() == first->getSize(),    "Method getMemoryUsage() failed");
+    
+    cache->insert(key2,PCMBuffer::alloc(1,500,48000));
+    CUAssertLog(cache->getSize() == 2,                          "Method insert() failed");
+    CUAssertLog(cache->getMemoryUsage() == first->getSize()+500*sizeof(float), "Method getMemoryUsage() failed");
+
+#pragma mark Release Test
+    cache->release(key1);
+    cache->release(key1);
+    CUAssertLog(cache->getShareCount(key1) == 1,                "Method release() failed");
+    cache->release(key1);
+    CUAssertLog(cache->getShareCount(key1) == 0,                "Method release() failed");
+    CUAssertLog(cache->acquire(key1) == nullptr,                "Method release() failed");
+    CUAssertLog(first.use_count() == 1,                         "Method release() failed");
+    CUAssertLog(cache->getMemoryUsage() == 500*sizeof(float),   "Method release() failed");
+    cache->release(key2);
+    CUAssertLog(cache->getSize() == 0 && cache->getMemoryUsage() == 0, "Method release() failed");
+    
+#pragma mark Complete
+    CULog("Sample cache tests complete.\n");
+}
+
+void benchSampleCache() {
+    const Uint32 frames = 48000*10;
+    std::shared_ptr<PCMBuffer> tone = makeTone(2,frames,48000,1000);
+    timestamp_t start = cuclock_t::now();
+    std::shared_ptr<PCMBuffer> result = SampleCache::resample(tone,44100);
+    timestamp_t end = cuclock_t::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Resampled 10 seconds of stereo audio from 48 kHz to 44.1 kHz in %.3f ms.",millis);
+}
+
+
+#pragma mark -
+#pragma mark Audio Engine
+/**
+ * Returns the path to a new WAV file with a constant mono signal.
+ *
+ * The file is written to the save directory, so that the engine can load
+ * it as a normal asset.  The samples are floats, so they load exactly.
+ *
+ * @param name      The file name
+ * @param rate      The sample rate
+ * @param frames    The number of frames
+ * @param value     The sample value
+ *
+ * @return the path to a new WAV file with a constant mono signal.
+ */
+static std::string writeLevel(const std::string& name, Uint32 rate, Uint32 frames, float value) {
+    std::shared_ptr<AudioRecorder> recorder = AudioRecorder::alloc(1,rate,[=](float* buffer, Uint32 amount) {
+        std::fill(buffer,buffer+amount,value);
+    });
+    recorder->advance(frames);
+    std::string path = Application::get()->getSaveDirectory()+name;
+    recorder->save(path,true);
+    return path;
+}
+
+/**
+ * Returns true if the output frames in the given range all have this value.
+ *
+ * @param output    The interleaved output
+ * @param outputs   The number of output channels
+ * @param start     The first frame to check
+ * @param end       The frame after the last one to check
+ * @param value     The expected sample value
+ *
+ * @return true if the output frames in the given range all have this value.
+ */
+static bool isLevel(const std::vector<float>& output, Uint32 outputs, Uint32 start, Uint32 end, float value) {
+    for(Uint32 ii = start*outputs; ii < end*outputs; ii++) {
+        if (std::fabs(output[ii]-value) > 1e-6f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testAudioEngine() {
+    CULog("Running tests for the offline AudioEngine.\n");
+    
+    AudioEngine::startOffline(2);
+    AudioEngine* engine = AudioEngine::get();
+    CUAssertLog(engine != nullptr && engine->isOffline(),   "Method startOffline() failed");
+    const Uint32 rate = engine->getSampleRate();
+    const Uint32 outputs = engine->getOutputChannels();
+    const Uint32 block = 1024;
+    std::vector<float> output(block*outputs);
+    
+    std::vector<std::string> files;
+    files.push_back(writeLevel("engine_first.wav",rate,rate,0.25f));
+    files.push_back(writeLevel("engine_second.wav",rate,rate,0.5f));
+    files.push_back(writeLevel("engine_third.wav",rate,rate,0.125f));
+    files.push_back(writeLevel("engine_opening.wav",rate,4*block,0.5f));
+    files.push_back(writeLevel("engine_closing.wav",rate,4*block,0.25f));
+    
+    std::shared_ptr<Sound> first  = Sound::alloc(files[0]);
+    std::shared_ptr<Sound> second = Sound::alloc(files[1]);
+    std::shared_ptr<Sound> third  = Sound::alloc(files[2]);
+    CUAssertLog(first && second && third,                   "Method Sound::alloc() failed");
+    
+#pragma mark Effect Test
+    EffectHandle a = engine->playEffect(first);
+    engine->render(output.data(),block);
+    CUAssertLog(engine->getClock() == block,                "Method render() failed");
+    CUAssertLog(isLevel(output,outputs,0,block,0.25f),      "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(a)-block/(float)rate) < 1e-6f, "Method render() failed");
+    
+    EffectHandle b = engine->playEffect(second);
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,0,block,0.75f),      "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(a)-2*block/(float)rate) < 1e-6f, "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(b)-block/(float)rate) < 1e-6f,   "Method render() failed");
+    
+#pragma mark Steal Test
+    // Both channels are busy, so the oldest effect is forced off its channel
+    EffectHandle c = engine->playEffect(third,false,-1,true);
+    CUAssertLog(engine->isVirtualEffect(a),                 "Method playEffect() failed");
+    CUAssertLog(!engine->isVirtualEffect(c),                "Method playEffect() failed");
+    
+    // The new effect starts on the first frame, as the old one fades out
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,MIXER_RAMP_FRAMES,block,0.625f), "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(c)-block/(float)rate) < 1e-6f,   "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(b)-2*block/(float)rate) < 1e-6f, "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(a)-3*block/(float)rate) < 1e-6f, "Method render() failed");
+    
+    // Reusing a stopped channel also waits for the next render
+    engine->stopEffect(b);
+    EffectHandle d = engine->playEffect(second);
+    CUAssertLog(engine->isActiveEffect(d) && !engine->isVirtualEffect(d), "Method playEffect() failed");
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,MIXER_RAMP_FRAMES,block,0.625f), "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(d)-block/(float)rate) < 1e-6f,   "Method render() failed");
+    
+    engine->stopAllEffects();
+    engine->render(output.data(),block);
+    for(Uint32 ii = 0; ii < 8; ii++) {
+        engine->render(output.data(),block);
+    }
+    CUAssertLog(isLevel(output,outputs,0,block,0.0f),       "Method stopAllEffects() failed");
+    
+#pragma mark Music Test
+    std::shared_ptr<Music> opening = Music::alloc(files[3]);
+    std::shared_ptr<Music> closing = Music::alloc(files[4]);
+    CUAssertLog(opening && closing,                         "Method Music::alloc() failed");
+    
+    Uint32 ended = 0;
+    engine->setMusicListener([&](Music* music, bool status) {
+        ended += (music == opening.get() && status) ? 1 : 0;
+    });
+    
+    // Crossfade for 10 ms (441 frames at 44.1 kHz)
+    const Uint32 fade = rate/100;
+    engine->playMusic(opening,false,1.0f);
+    engine->queueMusic(closing,false,1.0f,0.01f);
+    CUAssertLog(engine->getMusicQueueSize() == 1,           "Method queueMusic() failed");
+    for(Uint32 ii = 0; ii < 3; ii++) {
+        engine->render(output.data(),block);
+        CUAssertLog(isLevel(output,outputs,0,block,0.5f),   "Method playMusic() failed");
+    }
+    CUAssertLog(engine->currentMusic() == opening.get(),    "Method playMusic() failed");
+    CUAssertLog(std::fabs(engine->getMusicElapsed()-3*block/(float)rate) < 1e-6f, "Method getMusicElapsed() failed");
+    
+    // The last block of the opening overlaps the closing
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,0,block-fade,0.5f),  "Method queueMusic() failed");
+    CUAssertLog(ended == 1,                                 "Method queueMusic() failed");
+    CUAssertLog(engine->currentMusic() == closing.get(),    "Method queueMusic() failed");
+    CUAssertLog(engine->getMusicQueueSize() == 0,           "Method queueMusic() failed");
+    CUAssertLog(std::fabs(engine->getMusicElapsed()-fade/(float)rate) < 1e-6f, "Method queueMusic() failed");
+    
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,0,block,0.25f),      "Method queueMusic() failed");
+    CUAssertLog(std::fabs(engine->getMusicElapsed()-(block+fade)/(float)rate) < 1e-6f, "Method queueMusic() failed");
+    
+    engine->setMusicListener(nullptr);
+    engine->stopMusic();
+    opening = nullptr;
+    closing = nullptr;
+    first  = nullptr;
+    second = nullptr;
+    third  = nullptr;
+    AudioEngine::stop();
+    for(auto it = files.begin(); it != files.end(); ++it) {
+        Pathname(*it).deleteFile();
+    }
+    
+#pragma mark Complete
+    CULog("AudioEngine tests complete.\n");
+}
+
+void testEffectStealing() {
+    CULog("Running tests for sound effect stealing.\n");
+    
+    AudioEngine::startOffline(3);
+    AudioEngine* engine = AudioEngine::get();
+    const Uint32 rate = engine->getSampleRate();
+    const Uint32 outputs = engine->getOutputChannels();
+    const Uint32 block = 1024;
+    std::vector<float> output(block*outputs);
+    
+    std::string file = writeLevel("stealing.wav",rate,rate,0.125f);
+    std::shared_ptr<Sound> sound = Sound::alloc(file);
+    CUAssertLog(sound != nullptr,                           "Method Sound::alloc() failed");
+    
+#pragma mark Steal Test
+    // Fill every channel
+    EffectHandle a = engine->playEffect(sound,false,1.0f,false,1);
+    EffectHandle b = engine->playEffect(sound,false,1.0f,false,0);
+    EffectHandle c = engine->playEffect(sound,false,1.0f,false,2);
+    CUAssertLog(!engine->isVirtualEffect(a) && !engine->isVirtualEffect(b) &&
+                !engine->isVirtualEffect(c),                "Method playEffect() failed");
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,0,block,0.375f),     "Method render() failed");
+    
+    // The lowest priority effect gives up its channel
+    EffectHandle d = engine->playEffect(sound,false,1.0f,false,1);
+    CUAssertLog(engine->isVirtualEffect(b),                 "Method playEffect() failed");
+    CUAssertLog(!engine->isVirtualEffect(a) && !engine->isVirtualEffect(c) &&
+                !engine->isVirtualEffect(d),                "Method playEffect() failed");
+    
+    // An effect that outranks nothing starts virtual
+    EffectHandle e = engine->playEffect(sound,false,1.0f,false,0);
+    CUAssertLog(engine->isActiveEffect(e),                  "Method playEffect() failed");
+    CUAssertLog(engine->isVirtualEffect(e),                 "Method playEffect() failed");
+    CUAssertLog(!engine->isVirtualEffect(a),                "Method playEffect() failed");
+    
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,MIXER_RAMP_FRAMES,block,0.375f), "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(b)-2*block/(float)rate) < 1e-6f, "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(d)-block/(float)rate) < 1e-6f,   "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(e)-block/(float)rate) < 1e-6f,   "Method render() failed");
+    
+#pragma mark Promotion Test
+    // Freeing a channel promotes the oldest of the equally ranked virtual effects
+    engine->stopEffect(c);
+    CUAssertLog(!engine->isActiveEffect(c),                 "Method stopEffect() failed");
+    engine->render(output.data(),block);
+    CUAssertLog(!engine->isVirtualEffect(b),                "Method render() failed");
+    CUAssertLog(engine->isVirtualEffect(e),                 "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(b)-3*block/(float)rate) < 1e-6f, "Method render() failed");
+    
+    // The promoted effect resumes where its virtual time left off
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,MIXER_RAMP_FRAMES,block,0.375f), "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(b)-4*block/(float)rate) < 1e-6f, "Method render() failed");
+    CUAssertLog(std::fabs(engine->getEffectElapsed(e)-3*block/(float)rate) < 1e-6f, "Method render() failed");
+    
+    engine->stopAllEffects();
+    sound = nullptr;
+    AudioEngine::stop();
+    Pathname(file).deleteFile();
+    
+#pragma mark Complete
+    CULog("Sound effect stealing tests complete.\n");
+}
+
+void testEffectHandles() {
+    CULog("Running tests for sound effect handles.\n");
+    
+    AudioEngine::startOffline(2);
+    AudioEngine* engine = AudioEngine::get();
+    const Uint32 rate = engine->getSampleRate();
+    const Uint32 outputs = engine->getOutputChannels();
+    const Uint32 block = 1024;
+    std::vector<float> output(block*outputs);
+    
+    std::string file = writeLevel("handles.wav",rate,rate,0.125f);
+    std::shared_ptr<Sound> sound = Sound::alloc(file);
+    CUAssertLog(sound != nullptr,                           "Method Sound::alloc() failed");
+    
+#pragma mark Reuse Test
+    EffectHandle stale = engine->playEffect(sound);
+    CUAssertLog(stale != 0,                                 "Method playEffect() failed");
+    CUAssertLog(engine->isActiveEffect(stale),              "Method playEffect() failed");
+    engine->stopEffect(stale);
+    CUAssertLog(!engine->isActiveEffect(stale),             "Method stopEffect() failed");
+    
+    // The freed slot is reused with the next generation
+    EffectHandle fresh = engine->playEffect(sound,false,0.5f);
+    Uint32 generation = (Uint32)(stale >> 32);
+    CUAssertLog((fresh & 0xFFFFFFFF) == (stale & 0xFFFFFFFF), "Method playEffect() failed");
+    CUAssertLog((Uint32)(fresh >> 32) == AudioEngine::nextGeneration(generation), "Method playEffect() failed");
+    CUAssertLog(engine->isActiveEffect(fresh),              "Method playEffect() failed");
+    
+    // The stale handle does not reach the new effect
+    CUAssertLog(!engine->isActiveEffect(stale),             "Method isActiveEffect() failed");
+    engine->setEffectVolume(stale,1.0f);
+    CUAssertLog(engine->getEffectVolume(fresh) == 0.5f,     "Method setEffectVolume() failed");
+    engine->stopEffect(stale);
+    CUAssertLog(engine->isActiveEffect(fresh),              "Method stopEffect() failed");
+    engine->render(output.data(),block);
+    CUAssertLog(isLevel(output,outputs,MIXER_RAMP_FRAMES,block,0.0625f), "Method render() failed");
+    
+#pragma mark Wrap Test
+    CUAssertLog(AudioEngine::nextGeneration(1) == 2,        "Method nextGeneration() failed");
+    CUAssertLog(AudioEngine::nextGeneration(0xFFFFFFFE) == 0xFFFFFFFF, "Method nextGeneration() failed");
+    CUAssertLog(AudioEngine::nextGeneration(0xFFFFFFFF) == 1, "Method nextGeneration() failed");
+    
+    engine->stopAllEffects();
+    sound = nullptr;
+    AudioEngine::stop();
+    Pathname(file).deleteFile();
+    
+#pragma mark Complete
+    CULog("Sound effect handle tests complete.\n");
+}
+
+
+#pragma mark -
+#pragma mark Main
+
+void audioUnitTest() {
+    testSoundMixer();
+    benchSoundMixer();
+    testSoundStream();
+    benchSoundStream();
+    testSpatialAudio();
+    benchSpatialAudio();
+    testAudioBus();
+    benchAudioBus();
+    testAudioRecorder();
+    testMusicSchedule();
+    testSampleCache();
+    benchSampleCache();
+    testAudioEngine();
+    testEffectStealing();
+    testEffectHandles();
+}
+
+}
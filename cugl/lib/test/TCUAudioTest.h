@@ -0,0 +1,135 @@
+//
+//  TCUAudioTest.h
+//  CUGL
+//
+//  Created by Walker White on 10/18/26.
+//  Copyright © 2026 Game Design Initiative at Cornell. All rights reserved.
+//
+
+#ifndef __T_CU_AUDIO_TEST_H__
+#define __T_CU_AUDIO_TEST_H__
+
+namespace cugl {
+
+/**
+ * Unit test for the software sound mixer
+ *
+ * This test does not require an audio device.
+ */
+void testSoundMixer();
+
+/**
+ * Performance test for the software sound mixer
+ *
+ * This test logs the time to mix one second of audio for many voices.
+ */
+void benchSoundMixer();
+
+/**
+ * Unit test for streaming sound sources
+ *
+ * This test uses a synthetic stream, and does not require an audio file.
+ */
+void testSoundStream();
+
+/**
+ * Performance test for streaming sound sources
+ *
+ * This test logs the memory and CPU cost of streaming.  The Vorbis decode
+ * benchmark is skipped if sounds/stream.ogg is not present.
+ */
+void benchSoundStream();
+
+/**
+ * Unit test for positional audio in the sound mixer
+ *
+ * This test checks panning, attenuation, and doppler with synthetic data.
+ */
+void testSpatialAudio();
+
+/**
+ * Performance test for positional audio in the sound mixer
+ *
+ * This test logs the time to mix one second of audio for many emitters.
+ */
+void benchSpatialAudio();
+
+/**
+ * Unit test for audio buses and their effect nodes
+ *
+ * This test checks the bus graph, the input bus, and each of the built-in
+ * nodes with synthetic data.
+ */
+void testAudioBus();
+
+/**
+ * Performance test for audio buses
+ *
+ * This test logs the time to mix one second of audio through a typical
+ * effect chain, followed by the profile of each bus.
+ */
+void benchAudioBus();
+
+/**
+ * Unit test for the offline audio recorder
+ *
+ * This test records a software mixer, and checks that the WAV encoding is
+ * correct and deterministic.  It does not require an audio device.
+ */
+void testAudioRecorder();
+
+/**
+ * Unit test for scheduled and gapless playback in the sound mixer
+ *
+ * This test checks sample accurate start times, cued sounds, crossfades,
+ * and fades with synthetic data.
+ */
+void testMusicSchedule();
+
+/**
+ * Unit test for the sample cache
+ *
+ * This test checks the resampling filter and the sharing of decoded
+ * samples with synthetic data.
+ */
+void testSampleCache();
+
+/**
+ * Performance test for the sample cache
+ *
+ * This test logs the time to resample a long sound.
+ */
+void benchSampleCache();
+
+/**
+ * Unit test for the offline audio engine
+ *
+ * This test renders sound effects, channel steals, and a music crossfade,
+ * checking the exact output frames and playback positions.
+ */
+void testAudioEngine();
+
+/**
+ * Unit test for sound effect stealing in the offline audio engine
+ *
+ * This test checks that a full engine virtualizes the lowest ranked
+ * effect, and that virtual effects resume at the right position once
+ * a channel is free.
+ */
+void testEffectStealing();
+
+/**
+ * Unit test for sound effect handles in the offline audio engine
+ *
+ * This test checks that a handle is rejected once its slot is reused,
+ * and that slot generations wrap around without reaching 0.
+ */
+void testEffectHandles();
+
+/**
+ * Runs all of the audio tests
+ */
+void audioUnitTest();
+
+}
+#endif /* __T_CU_AUDIO_TEST_H__ */
@@ -0,0 +1,1088 @@
+//
+//  TCUIOTest.cpp
+//  CUGL
+//
+//  Created by Walker White on 10/18/26.
+//  Copyright © 2026 Game Design Initiative at Cornell. All rights reserved.
+//
+
+#include "TCUIOTest.h"
+#include <string>
+#include <vector>
+#include <cugl/util/CUDebug.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/io/CUMappedFile.h>
+#include <cugl/io/CUTextReader.h>
+#include <cugl/io/CUTextWriter.h>
+#include <cugl/io/CUBinaryReader.h>
+#include <cugl/io/CUBinaryWriter.h>
+#include <cugl/io/CUAsyncIO.h>
+#include <cugl/io/CUCompression.h>
+#include <cugl/io/CUCompressedReader.h>
+#include <cugl/io/CUCompressedWriter.h>
+#include <cugl/io/CUDirectorySnapshot.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace cugl {
+
+/**
+ * Returns the absolute path for a scratch file in the save directory
+ *
+ * @param name  The scratch file name
+ *
+ * @return the absolute path for a scratch file in the save directory
+ */
+static std::string scratch(const char* name) {
+    return Application::get()->getSaveDirectory()+name;
+}
+
+
+#pragma mark -
+#pragma mark Mapped Files
+
+void testMappedFile() {
+    CULog("Running tests for MappedFile.\n");
+    
+    std::string textfile = scratch("cugl_mapped.txt");
+    std::string datafile = scratch("cugl_mapped.bin");
+    std::string emptyfile = scratch("cugl_empty.txt");
+
+    auto twriter = TextWriter::alloc(textfile);
+    twriter->writeLine("alpha");
+    twriter->writeLine("");
+    twriter->write("gamma");
+    twriter->close();
+    
+    auto bwriter = BinaryWriter::alloc(datafile);
+    bwriter->writeUint32(0xDEADBEEF);
+    bwriter->writeFloat(1.5f);
+    bwriter->writeDouble(-2.25);
+    Sint32 values[5] = { 1, -2, 3, -4, 5 };
+    bwriter->write(values,5);
+    bwriter->close();
+    
+    auto ewriter = TextWriter::alloc(emptyfile);
+    ewriter->close();
+
+#pragma mark Mapping Test
+    auto mapping = MappedFile::alloc(textfile);
+    CUAssertLog(mapping != nullptr,                         "Method alloc() failed");
+    CUAssertLog(mapping->size() == 12,                      "Method size() failed");
+    CUAssertLog(std::string(mapping->data(),5) == "alpha",  "Method data() failed");
+    CUAssertLog(mapping->getName() == textfile,             "Method getName() failed");
+#if defined (__WINDOWS__) || defined (__MACOSX__) || defined (__linux__)
+    CUAssertLog(mapping->isMapped(),                        "Method isMapped() failed");
+#endif
+    mapping->dispose();
+    CUAssertLog(mapping->data() == nullptr,                 "Method dispose() failed");
+    CUAssertLog(mapping->size() == 0,                       "Method dispose() failed");
+    
+    mapping = MappedFile::alloc(emptyfile);
+    CUAssertLog(mapping != nullptr,                         "Method alloc() failed on empty file");
+    CUAssertLog(mapping->size() == 0,                       "Method alloc() failed on empty file");
+    mapping = MappedFile::alloc(scratch("cugl_missing.txt"));
+    CUAssertLog(mapping == nullptr,                         "Method alloc() failed on missing file");
+
+#pragma mark Text Reader Test
+    auto treader = TextReader::allocMapped(textfile);
+    CUAssertLog(treader != nullptr,                         "Method allocMapped() failed");
+    CUAssertLog(treader->isMapped(),                        "Method isMapped() failed");
+    CUAssertLog(treader->readLine() == "alpha",             "Method readLine() failed");
+    CUAssertLog(treader->readLine() == "",                  "Method readLine() failed");
+    size_t length = 0;
+    const char* span = treader->readLineSpan(length);
+    CUAssertLog(span != nullptr && length == 5,             "Method readLineSpan() failed");
+    CUAssertLog(std::string(span,length) == "gamma",        "Method readLineSpan() failed");
+    CUAssertLog(!treader->ready(),                          "Method ready() failed");
+    CUAssertLog(treader->readLineSpan(length) == nullptr,   "Method readLineSpan() failed at end of file");
+    treader->reset();
+    CUAssertLog(treader->ready(),                           "Method reset() failed");
+    CUAssertLog(treader->read() == 'a',                     "Method read() failed");
+    treader->skip();
+    CUAssertLog(treader->readAll() == "lpha\n\ngamma",      "Method readAll() failed");
+    treader->close();
+    CUAssertLog(!treader->ready(),                          "Method close() failed");
+    treader->reset();
+    CUAssertLog(treader->readLine() == "alpha",             "Method reset() failed after close()");
+    treader->close();
+
+    treader = TextReader::alloc(textfile);
+    CUAssertLog(!treader->isMapped(),                       "Method isMapped() failed");
+    CUAssertLog(treader->readLine() == "alpha",             "Method readLine() failed");
+    CUAssertLog(treader->readLine() == "",                  "Method readLine() failed");
+    CUAssertLog(treader->readLine() == "gamma",             "Method readLine() failed at end of file");
+    CUAssertLog(!treader->ready(),                          "Method ready() failed");
+    treader->close();
+    
+    treader = TextReader::allocMapped(emptyfile);
+    CUAssertLog(treader != nullptr,                         "Method allocMapped() failed on empty file");
+    CUAssertLog(!treader->ready(),                          "Method ready() failed on empty file");
+    treader->close();
+
+#pragma mark Binary Reader Test
+    auto breader = BinaryReader::allocMapped(datafile);
+    CUAssertLog(breader != nullptr,                         "Method allocMapped() failed");
+    CUAssertLog(breader->isMapped(),                        "Method isMapped() failed");
+    CUAssertLog(breader->readUint32() == 0xDEADBEEF,        "Method readUint32() failed");
+    CUAssertLog(breader->readFloat() == 1.5f,               "Method readFloat() failed");
+    CUAssertLog(breader->readDouble() == -2.25,             "Method readDouble() failed");
+    Sint32 results[5];
+    CUAssertLog(breader->read(results,5) == 5,              "Method read() failed");
+    CUAssertLog(results[0] == 1 && results[4] == 5,         "Method read() failed");
+    CUAssertLog(!breader->ready(),                          "Method ready() failed");
+    breader->reset();
+    const Uint8* bytes = breader->readSpan(4);
+    CUAssertLog(bytes != nullptr,                           "Method readSpan() failed");
+    CUAssertLog(bytes[0] == 0xDE && bytes[3] == 0xEF,       "Method readSpan() failed");
+    CUAssertLog(breader->readSpan(1024) == nullptr,         "Method readSpan() failed past end");
+    CUAssertLog(breader->readFloat() == 1.5f,               "Method readSpan() failed past end");
+    breader->close();
+    
+    breader = BinaryReader::alloc(datafile);
+    CUAssertLog(!breader->isMapped(),                       "Method isMapped() failed");
+    bytes = breader->readSpan(4);
+    CUAssertLog(bytes != nullptr && bytes[1] == 0xAD,       "Method readSpan() failed");
+    CUAssertLog(breader->readFloat() == 1.5f,               "Method readFloat() failed");
+    breader->reset();
+    CUAssertLog(breader->readUint32() == 0xDEADBEEF,        "Method reset() failed");
+    breader->close();
+    
+    Pathname(textfile).deleteFile();
+    Pathname(datafile).deleteFile();
+    Pathname(emptyfile).deleteFile();
+    CULog("MappedFile tests complete.\n");
+}
+
+void benchMappedFile() {
+    const int lines = 1 << 18;
+    std::string textfile = scratch("cugl_bench.txt");
+    std::string datafile = scratch("cugl_bench.bin");
+    
+    auto twriter = TextWriter::alloc(textfile);
+    for(int ii = 0; ii < lines; ii++) {
+        twriter->writeLine("The quick brown fox jumps over the lazy dog "+std::to_string(ii));
+    }
+    twriter->close();
+    
+    std::vector<float> values(lines*4);
+    for(size_t ii = 0; ii < values.size(); ii++) {
+        values[ii] = (float)ii;
+    }
+    auto bwriter = BinaryWriter::alloc(datafile);
+    bwriter->write(values.data(),values.size());
+    bwriter->close();
+    
+    double megs = 0;
+    size_t count = 0;
+    
+    // Buffered lines
+    auto start = std::chrono::high_resolution_clock::now();
+    auto treader = TextReader::alloc(textfile);
+    std::string line;
+    while (treader->ready()) {
+        line.clear();
+        treader->readLine(line);
+        count += line.size()+1;
+    }
+    treader->close();
+    auto end = std::chrono::high_resolution_clock::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    megs = count/(1024.0*1024.0);
+    CULog("Buffered readLine: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    // Mapped lines
+    count = 0;
+    start = std::chrono::high_resolution_clock::now();
+    treader = TextReader::allocMapped(textfile);
+    while (treader->ready()) {
+        line.clear();
+        treader->readLine(line);
+        count += line.size()+1;
+    }
+    treader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Mapped readLine: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    // Mapped spans
+    count = 0;
+    start = std::chrono::high_resolution_clock::now();
+    treader = TextReader::allocMapped(textfile);
+    size_t length;
+    while (treader->readLineSpan(length) != nullptr) {
+        count += length+1;
+    }
+    treader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CUAssertLog(count/(1024.0*1024.0) == megs, "Method readLineSpan() failed");
+    CULog("Mapped readLineSpan: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    // Whole file
+    start = std::chrono::high_resolution_clock::now();
+    treader = TextReader::alloc(textfile);
+    count = treader->readAll().size();
+    treader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Buffered readAll: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+
+    start = std::chrono::high_resolution_clock::now();
+    treader = TextReader::allocMapped(textfile);
+    count = treader->readAll().size();
+    treader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Mapped readAll: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    // Binary floats
+    double total = 0;
+    megs = values.size()*sizeof(float)/(1024.0*1024.0);
+    start = std::chrono::high_resolution_clock::now();
+    auto breader = BinaryReader::alloc(datafile);
+    while (breader->ready(4)) {
+        total += breader->readFloat();
+    }
+    breader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Buffered readFloat: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    double check = 0;
+    start = std::chrono::high_resolution_clock::now();
+    breader = BinaryReader::allocMapped(datafile);
+    while (breader->ready(4)) {
+        check += breader->readFloat();
+    }
+    breader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CUAssertLog(check == total, "Method readFloat() failed");
+    CULog("Mapped readFloat: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    Pathname(textfile).deleteFile();
+    Pathname(datafile).deleteFile();
+}
+
+
+#pragma mark -
+#pragma mark Binary Arrays
+
+/**
+ * Returns true if the array read from the reader matches the given one
+ *
+ * The values are read into the middle of a larger array, to test offsets.
+ *
+ * @param reader    The binary reader
+ * @param expected  The expected values
+ *
+ * @return true if the array read from the reader matches the given one
+ */
+template <typename T>
+static bool checkArray(const std::shared_ptr<BinaryReader>& reader, const std::vector<T>& expected) {
+    std::vector<T> actual(expected.size()+2,0);
+    if (reader->read(actual.data(),expected.size(),1) != expected.size()) {
+        return false;
+    }
+    for(size_t ii = 0; ii < expected.size(); ii++) {
+        if (actual[ii+1] != expected[ii]) {
+            return false;
+        }
+    }
+    return actual[0] == 0 && actual.back() == 0;
+}
+
+void testBinaryArrays() {
+    CULog("Running tests for binary arrays.\n");
+    
+    std::string datafile = scratch("cugl_arrays.bin");
+    const size_t size = 1001;
+    std::vector<char>   chars(size);
+    std::vector<Sint16> shorts(size);
+    std::vector<Uint16> ushorts(size);
+    std::vector<Sint32> ints(size);
+    std::vector<Uint32> uints(size);
+    std::vector<Sint64> longs(size);
+    std::vector<Uint64> ulongs(size);
+    std::vector<float>  floats(size);
+    std::vector<double> doubles(size);
+    for(size_t ii = 0; ii < size; ii++) {
+        chars[ii]   = (char)('a'+ii % 26);
+        shorts[ii]  = (Sint16)(ii*37)-15000;
+        ushorts[ii] = (Uint16)(ii*61+3);
+        ints[ii]    = (Sint32)(ii*104729)-50000000;
+        uints[ii]   = (Uint32)(ii*2654435761u);
+        longs[ii]   = (Sint64)ii*0x100000001LL-0x7000000000LL;
+        ulongs[ii]  = (Uint64)ii*0x9E3779B97F4A7C15ULL;
+        floats[ii]  = ii*0.25f-100.0f;
+        doubles[ii] = ii*1.0e-3-0.5;
+    }
+
+#pragma mark Write Test
+    // An odd capacity forces values to straddle the buffer boundaries
+    auto writer = BinaryWriter::alloc(datafile,37);
+    writer->writeUint8(7);
+    writer->write(chars.data(),size);
+    writer->write(shorts.data(),size);
+    writer->write(ushorts.data(),size);
+    writer->write(ints.data(),size);
+    writer->write(uints.data(),size);
+    writer->write(longs.data(),size);
+    writer->write(ulongs.data(),size);
+    writer->write(floats.data(),size);
+    writer->write(doubles.data(),size);
+    writer->writeSint32(ints[5]);
+    writer->writeDouble(doubles[5]);
+    writer->write(floats.data(),3,size-3);
+    writer->close();
+
+#pragma mark Read Test
+    std::shared_ptr<BinaryReader> readers[3];
+    readers[0] = BinaryReader::alloc(datafile);
+    readers[1] = BinaryReader::alloc(datafile,37);
+    readers[2] = BinaryReader::allocMapped(datafile);
+    for(int ii = 0; ii < 3; ii++) {
+        auto reader = readers[ii];
+        CUAssertLog(reader != nullptr,                  "Method alloc() failed");
+        CUAssertLog(reader->readByte() == 7,            "Method readByte() failed");
+        CUAssertLog(checkArray(reader,chars),           "Method read(char*) failed");
+        CUAssertLog(checkArray(reader,shorts),          "Method read(Sint16*) failed");
+        CUAssertLog(checkArray(reader,ushorts),         "Method read(Uint16*) failed");
+        CUAssertLog(checkArray(reader,ints),            "Method read(Sint32*) failed");
+        CUAssertLog(checkArray(reader,uints),           "Method read(Uint32*) failed");
+        CUAssertLog(checkArray(reader,longs),           "Method read(Sint64*) failed");
+        CUAssertLog(checkArray(reader,ulongs),          "Method read(Uint64*) failed");
+        CUAssertLog(checkArray(reader,floats),          "Method read(float*) failed");
+        CUAssertLog(checkArray(reader,doubles),         "Method read(double*) failed");
+        CUAssertLog(reader->readSint32() == ints[5],    "Method readSint32() failed");
+        CUAssertLog(reader->readDouble() == doubles[5], "Method readDouble() failed");
+        
+        float tail[8];
+        CUAssertLog(reader->read(tail,8) == 3,          "Method read(float*) failed at end");
+        CUAssertLog(tail[0] == floats[size-3],          "Method write(float*) failed with offset");
+        CUAssertLog(tail[2] == floats[size-1],          "Method write(float*) failed with offset");
+        CUAssertLog(!reader->ready(),                   "Method ready() failed");
+        reader->close();
+    }
+    
+    Pathname(datafile).deleteFile();
+    CULog("Binary array tests complete.\n");
+}
+
+void benchBinaryArrays() {
+    const size_t size = 1 << 22;
+    std::string datafile = scratch("cugl_bench.bin");
+    std::vector<float> values(size);
+    for(size_t ii = 0; ii < size; ii++) {
+        values[ii] = (float)ii;
+    }
+    double megs = size*sizeof(float)/(1024.0*1024.0);
+    
+    // Element writes
+    auto start = std::chrono::high_resolution_clock::now();
+    auto writer = BinaryWriter::alloc(datafile);
+    for(size_t ii = 0; ii < size; ii++) {
+        writer->writeFloat(values[ii]);
+    }
+    writer->close();
+    auto end = std::chrono::high_resolution_clock::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Element writeFloat: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    // Array writes
+    start = std::chrono::high_resolution_clock::now();
+    writer = BinaryWriter::alloc(datafile);
+    writer->write(values.data(),size);
+    writer->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Array write(float*): %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    // Element reads
+    std::vector<float> results(size);
+    start = std::chrono::high_resolution_clock::now();
+    auto reader = BinaryReader::alloc(datafile);
+    for(size_t ii = 0; ii < size; ii++) {
+        results[ii] = reader->readFloat();
+    }
+    reader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CUAssertLog(results == values, "Method readFloat() failed");
+    CULog("Element readFloat: %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    // Array reads
+    results.assign(size,0);
+    start = std::chrono::high_resolution_clock::now();
+    reader = BinaryReader::alloc(datafile);
+    reader->read(results.data(),size);
+    reader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CUAssertLog(results == values, "Method read(float*) failed");
+    CULog("Buffered read(float*): %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    results.assign(size,0);
+    start = std::chrono::high_resolution_clock::now();
+    reader = BinaryReader::allocMapped(datafile);
+    reader->read(results.data(),size);
+    reader->close();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CUAssertLog(results == values, "Method read(float*) failed");
+    CULog("Mapped read(float*): %.2f MB in %.3f ms (%.1f MB/s).",megs,millis,1000*megs/millis);
+    
+    Pathname(datafile).deleteFile();
+}
+
+
+#pragma mark -
+#pragma mark Asynchronous I/O
+
+void testAsyncIO() {
+    CULog("Running tests for AsyncIO.\n");
+    
+    std::string first  = scratch("cugl_async1.txt");
+    std::string second = scratch("cugl_async2.txt");
+    std::string large  = scratch("cugl_async3.bin");
+
+#pragma mark Read Write Test
+    auto service = AsyncIO::alloc(1);
+    CUAssertLog(service != nullptr,                             "Method alloc() failed");
+    CUAssertLog(service->writeFile(first,"hello world").get(),  "Method writeFile() failed");
+    auto data = service->readFile(first).get();
+    CUAssertLog(data != nullptr && *data == "hello world",      "Method readFile() failed");
+    data = service->readRange(first,6,3).get();
+    CUAssertLog(data != nullptr && *data == "wor",              "Method readRange() failed");
+    data = service->readRange(first,6,100).get();
+    CUAssertLog(data != nullptr && *data == "world",            "Method readRange() failed at end");
+    data = service->readRange(first,100,1).get();
+    CUAssertLog(data == nullptr,                                "Method readRange() failed past end");
+    data = service->readFile(scratch("cugl_missing.txt")).get();
+    CUAssertLog(data == nullptr,                                "Method readFile() failed on missing file");
+    CUAssertLog(!Pathname(first+".tmp").exists(),               "Method writeFile() failed to clean up");
+
+#pragma mark Coalescing Test
+    // Occupy the only worker so that the next requests wait in the queue
+    auto busy = service->writeFile(large,std::string(1 << 24,'x'));
+    std::vector<AsyncIO::WriteFuture> saves;
+    for(int ii = 0; ii < 10; ii++) {
+        saves.push_back(service->writeFile(second,"save "+std::to_string(ii)));
+    }
+    auto early = service->readFile(second);
+    auto range = service->readRange(second,5,1);
+    CUAssertLog(*early.get() == "save 9",                       "Method readFile() failed after writeFile()");
+    CUAssertLog(*range.get() == "9",                            "Method readRange() failed after writeFile()");
+    for(auto it = saves.begin(); it != saves.end(); ++it) {
+        CUAssertLog(it->get(),                                  "Method writeFile() failed");
+    }
+    CUAssertLog(busy.get(),                                     "Method writeFile() failed");
+    service->wait();
+    CUAssertLog(service->getPending() == 0,                     "Method wait() failed");
+    CUAssertLog(service->getCoalesced() > 0,                    "Method writeFile() failed to coalesce");
+    CUAssertLog(*service->readFile(second).get() == "save 9",   "Method writeFile() failed to coalesce");
+
+#pragma mark Priority Test
+    // The later write has higher priority, so the earlier read sees it
+    busy = service->writeFile(large,std::string(1 << 24,'y'));
+    auto low  = service->readFile(first,nullptr,0);
+    auto high = service->writeFile(first,"priority",nullptr,10);
+    CUAssertLog(high.get(),                                     "Method writeFile() failed");
+    CUAssertLog(*low.get() == "priority",                       "Method readFile() ignored the priority");
+
+#pragma mark Dispose Test
+    auto last = service->writeFile(first,"goodbye");
+    service->dispose();
+    CUAssertLog(last.wait_for(std::chrono::seconds(0)) == std::future_status::ready,
+                "Method dispose() abandoned a write");
+    CUAssertLog(service->init(2),                               "Method init() failed");
+    CUAssertLog(*service->readFile(first).get() == "goodbye",   "Method dispose() failed");
+    service->dispose();
+    
+    Pathname(first).deleteFile();
+    Pathname(second).deleteFile();
+    Pathname(large).deleteFile();
+    CULog("AsyncIO tests complete.\n");
+}
+
+void benchAsyncIO() {
+    const int files = 64;
+    const size_t size = 1 << 18;
+    double megs = files*size/(1024.0*1024.0);
+    std::vector<std::string> names;
+    for(int ii = 0; ii < files; ii++) {
+        names.push_back(scratch(("cugl_save"+std::to_string(ii)+".bin").c_str()));
+    }
+    std::string payload(size,'s');
+    
+    // Synchronous saves on the main thread
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int ii = 0; ii < files; ii++) {
+        auto writer = BinaryWriter::alloc(names[ii]);
+        writer->write(payload.data(),payload.size());
+        writer->close();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Synchronous saves (not atomic): %.2f MB in %.3f ms (%.1f MB/s), all on the main thread.",
+          megs,millis,1000*megs/millis);
+    
+    int threads[3] = { 1, 2, 4 };
+    for(int jj = 0; jj < 3; jj++) {
+        auto service = AsyncIO::alloc(threads[jj]);
+        start = std::chrono::high_resolution_clock::now();
+        for(int ii = 0; ii < files; ii++) {
+            service->writeFile(names[ii],payload);
+        }
+        auto issued = std::chrono::high_resolution_clock::now();
+        
+        // A high priority read should not wait for the whole backlog
+        auto read = service->readRange(names[0],0,16,nullptr,10);
+        read.wait();
+        auto answered = std::chrono::high_resolution_clock::now();
+        service->wait();
+        end = std::chrono::high_resolution_clock::now();
+        
+        double stall   = std::chrono::duration_cast<std::chrono::microseconds>(issued-start).count()/1000.0;
+        double latency = std::chrono::duration_cast<std::chrono::microseconds>(answered-issued).count()/1000.0;
+        millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+        CULog("Async saves (%d threads): %.2f MB in %.3f ms (%.1f MB/s), main thread stall %.3f ms, read latency %.3f ms.",
+              threads[jj],megs,millis,1000*megs/millis,stall,latency);
+    }
+    
+    // A burst of saves to a single file
+    auto service = AsyncIO::alloc(1);
+    start = std::chrono::high_resolution_clock::now();
+    for(int ii = 0; ii < files; ii++) {
+        service->writeFile(names[0],payload);
+    }
+    service->wait();
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Burst of %d saves to one file in %.3f ms (%llu coalesced).",
+          files,millis,(unsigned long long)service->getCoalesced());
+    
+    for(int ii = 0; ii < files; ii++) {
+        Pathname(names[ii]).deleteFile();
+    }
+}
+
+
+#pragma mark -
+#pragma mark Compression
+
+/**
+ * Returns a JSON string resembling a save file with the given number of entities
+ *
+ * @param entities  The number of entities in the save file
+ *
+ * @return a JSON string resembling a save file with the given number of entities
+ */
+static std::string sampleJson(int entities) {
+    static const char* kinds[] = { "goblin", "archer", "crate", "torch", "door" };
+    std::string result = "{\"version\":3,\"level\":\"dungeon-04\",\"entities\":[";
+    char entry[256];
+    for(int ii = 0; ii < entities; ii++) {
+        snprintf(entry, sizeof(entry),
+                 "%s{\"id\":%d,\"kind\":\"%s\",\"position\":[%.2f,%.2f],\"health\":%d,\"active\":%s}",
+                 ii ? "," : "", ii, kinds[(ii*7) % 5], (ii % 97)*1.25f, (ii % 31)*2.5f,
+                 100-(ii % 13)*5, ii % 3 ? "true" : "false");
+        result.append(entry);
+    }
+    result.append("]}");
+    return result;
+}
+
+/**
+ * Returns the given file as a string, without decompressing it
+ *
+ * @param file  The file to read
+ *
+ * @return the given file as a string, without decompressing it
+ */
+static std::string rawFile(const std::string& file) {
+    auto reader = BinaryReader::alloc(file);
+    std::string result;
+    char chunk[4096];
+    while (reader->ready()) {
+        size_t amt = reader->read(chunk,sizeof(chunk));
+        result.append(chunk,amt);
+    }
+    reader->close();
+    return result;
+}
+
+void testCompression() {
+    CULog("Running tests for compression.\n");
+    
+#pragma mark Block Test
+    std::string text = sampleJson(500);
+    std::vector<char> packed(compression::bound(text.size()));
+    size_t size = compression::compressBlock(text.data(), text.size(), packed.data(), packed.size());
+    CUAssertLog(size > 0 && size < text.size()/2,  "Method compressBlock() failed");
+    CUAssertLog(!compression::compressBlock(text.data(), text.size(), packed.data(), 16),
+                "Method compressBlock() ignored the capacity");
+    std::vector<char> unpacked(text.size());
+    Sint64 amt = compression::decompressBlock(packed.data(), size, unpacked.data(), unpacked.size());
+    CUAssertLog(amt == (Sint64)text.size(),        "Method decompressBlock() failed");
+    CUAssertLog(!memcmp(unpacked.data(),text.data(),text.size()), "Method decompressBlock() failed");
+    amt = compression::decompressBlock(packed.data(), size/2, unpacked.data(), unpacked.size());
+    CUAssertLog(amt < (Sint64)text.size(),         "Method decompressBlock() accepted a truncated block");
+    amt = compression::decompressBlock(packed.data(), size, unpacked.data(), text.size()/2);
+    CUAssertLog(amt == -1,                         "Method decompressBlock() ignored the capacity");
+
+#pragma mark Container Test
+    std::string noise(200000,0);
+    Uint32 seed = 12345;
+    for(size_t ii = 0; ii < noise.size(); ii++) {
+        seed = seed*1664525+1013904223;
+        noise[ii] = (char)(seed >> 24);
+    }
+    std::string sources[] = { std::string(), std::string("a"), text, text+noise+text };
+    for(int ii = 0; ii < 4; ii++) {
+        std::string container = compression::compress(sources[ii], 4096);
+        CUAssertLog(compression::isCompressed(container.data(), container.size()),
+                    "Method isCompressed() failed");
+        std::string result = "prefix";
+        CUAssertLog(compression::decompress(container, result), "Method decompress() failed");
+        CUAssertLog(result == "prefix"+sources[ii],  "Method decompress() failed");
+    }
+    std::string container = compression::compress(noise);
+    size_t overhead = CU_COMPRESSION_HEADER+CU_COMPRESSION_FRAME*(noise.size()/CU_COMPRESSION_BLOCK+1);
+    CUAssertLog(container.size() <= noise.size()+overhead, "Method compress() failed on noise");
+    CUAssertLog(!compression::isCompressed(text.data(), text.size()), "Method isCompressed() failed");
+    
+    std::string result;
+    container = compression::compress(text, 4096);
+    for(size_t pos = 0; pos < container.size(); pos += 97) {
+        std::string corrupt = container;
+        corrupt[pos] ^= 0x5A;
+        result.clear();
+        if (compression::decompress(corrupt, result)) {
+            // A corrupt literal still decodes, but it must not change the size
+            CUAssertLog(result.size() == text.size(), "Method decompress() accepted a corrupt container");
+        }
+    }
+    result.clear();
+    CUAssertLog(!compression::decompress(container.substr(0,container.size()-1), result),
+                "Method decompress() accepted a truncated container");
+
+#pragma mark Stream Test
+    std::string datafile = scratch("cugl_compressed.bin");
+    std::string rawfile  = scratch("cugl_uncompressed.bin");
+    const size_t count = 50000;
+    std::vector<Sint32> ints(count);
+    std::vector<float>  floats(count);
+    std::vector<double> doubles(count);
+    for(size_t ii = 0; ii < count; ii++) {
+        ints[ii]    = (Sint32)(ii*104729 % 100000000)-50000000;
+        floats[ii]  = (ii % 1000)*0.25f-100.0f;
+        doubles[ii] = ii*1.0e-3-0.5;
+    }
+    
+    // An odd capacity forces values to straddle the buffer boundaries
+    std::shared_ptr<BinaryWriter> writers[2];
+    writers[0] = CompressedWriter::alloc(datafile,37);
+    writers[1] = BinaryWriter::alloc(rawfile,37);
+    for(int ii = 0; ii < 2; ii++) {
+        auto writer = writers[ii];
+        CUAssertLog(writer != nullptr,  "Method alloc() failed");
+        writer->writeUint8(7);
+        writer->write(ints.data(),count);
+        writer->writeDouble(doubles[5]);
+        writer->write(floats.data(),count);
+        writer->write(text.data(),text.size());
+        writer->write(doubles.data(),count);
+        writer->writeSint32(ints[5]);
+        writer->close();
+    }
+    std::string compressed = rawFile(datafile);
+    std::string original = rawFile(rawfile);
+    CUAssertLog(compressed.size() < original.size()*3/4, "CompressedWriter failed to compress");
+    result.clear();
+    CUAssertLog(compression::decompress(compressed,result) && result == original,
+                "CompressedWriter is incompatible with decompress()");
+    
+    std::shared_ptr<BinaryReader> readers[2];
+    readers[0] = CompressedReader::alloc(datafile);
+    readers[1] = CompressedReader::alloc(datafile,37);
+    for(int ii = 0; ii < 2; ii++) {
+        auto reader = readers[ii];
+        CUAssertLog(reader != nullptr,  "Method alloc() failed");
+        for(int pass = 0; pass < 2; pass++) {
+            CUAssertLog(reader->readByte() == 7,            "Method readByte() failed");
+            CUAssertLog(checkArray(reader,ints),            "Method read(Sint32*) failed");
+            CUAssertLog(reader->readDouble() == doubles[5], "Method readDouble() failed");
+            CUAssertLog(checkArray(reader,floats),          "Method read(float*) failed");
+            std::vector<char> chars(text.begin(),text.end());
+            CUAssertLog(checkArray(reader,chars),           "Method read(char*) failed");
+            CUAssertLog(checkArray(reader,doubles),         "Method read(double*) failed");
+            CUAssertLog(reader->readSint32() == ints[5],    "Method readSint32() failed");
+            CUAssertLog(!reader->ready(),                   "Method ready() failed");
+            reader->reset();
+        }
+        reader->close();
+    }
+    CUAssertLog(CompressedReader::alloc(rawfile) == nullptr, "Method alloc() accepted an uncompressed file");
+    
+    // A container from compress() is a valid compressed file
+    writers[1] = BinaryWriter::alloc(datafile);
+    container = compression::compress(text+noise, 1000);
+    writers[1]->write(container.data(), container.size());
+    writers[1]->close();
+    auto reader = CompressedReader::alloc(datafile);
+    CUAssertLog(reader->readAll() == text+noise,   "Method readAll() failed");
+    CUAssertLog(reader->readAll().empty(),         "Method readAll() failed at end");
+    reader->close();
+    
+    // A truncated file stops at the last valid block
+    writers[1] = BinaryWriter::alloc(datafile);
+    writers[1]->write(container.data(), container.size()/2);
+    writers[1]->close();
+    reader = CompressedReader::alloc(datafile);
+    result = reader->readAll();
+    CUAssertLog(result.size() < container.size() && result.size() % 1000 == 0,
+                "Method readAll() failed on a truncated file");
+    CUAssertLog(result == (text+noise).substr(0,result.size()), "Method readAll() failed on a truncated file");
+    CUAssertLog(!reader->ready(),                  "Method ready() failed on a truncated file");
+    reader->close();
+
+#pragma mark JSON Test
+    auto json = JsonValue::allocWithJson(sampleJson(200));
+    auto jwriter = CompressedWriter::alloc(datafile);
+    jwriter->writeJson(json);
+    jwriter->close();
+    reader = CompressedReader::alloc(datafile);
+    auto copy = reader->readJson();
+    CUAssertLog(copy != nullptr && copy->toString() == json->toString(), "Method readJson() failed");
+    CUAssertLog(reader->readJson() == nullptr,     "Method readJson() failed at end");
+    reader->close();
+    
+    Pathname(datafile).deleteFile();
+    Pathname(rawfile).deleteFile();
+    CULog("Compression tests complete.\n");
+}
+
+void benchCompression() {
+    std::string datafile = scratch("cugl_bench.culz");
+    std::string samples[2];
+    const char* names[2] = { "JSON save", "Binary mesh" };
+    samples[0] = sampleJson(60000);
+    
+    // A binary file of vertex positions and normals
+    const size_t size = 1 << 20;
+    std::vector<float> values(size);
+    for(size_t ii = 0; ii < size; ii += 4) {
+        float angle = (ii % 4096)*0.001534f;
+        values[ii]   = (ii/4096)*0.5f;
+        values[ii+1] = cosf(angle)*10.0f;
+        values[ii+2] = sinf(angle)*10.0f;
+        values[ii+3] = 1.0f;
+    }
+    std::string rawfile = scratch("cugl_bench.bin");
+    auto bwriter = BinaryWriter::alloc(rawfile);
+    bwriter->write(values.data(),size);
+    bwriter->close();
+    samples[1] = rawFile(rawfile);
+    Pathname(rawfile).deleteFile();
+    
+    for(int ii = 0; ii < 2; ii++) {
+        const std::string& data = samples[ii];
+        double megs = data.size()/(1024.0*1024.0);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        std::string container = compression::compress(data);
+        auto end = std::chrono::high_resolution_clock::now();
+        double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+        CULog("%s compress: %.2f MB in %.3f ms (%.1f MB/s), ratio %.2f.",
+              names[ii],megs,millis,1000*megs/millis,(double)data.size()/container.size());
+        
+        std::string result;
+        result.reserve(data.size());
+        start = std::chrono::high_resolution_clock::now();
+        compression::decompress(container,result);
+        end = std::chrono::high_resolution_clock::now();
+        millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+        CUAssertLog(result == data, "Method decompress() failed");
+        CULog("%s decompress: %.2f MB in %.3f ms (%.1f MB/s).",names[ii],megs,millis,1000*megs/millis);
+        
+        start = std::chrono::high_resolution_clock::now();
+        auto writer = CompressedWriter::alloc(datafile);
+        writer->write(data.data(),data.size());
+        writer->close();
+        end = std::chrono::high_resolution_clock::now();
+        millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+        CULog("%s CompressedWriter: %.2f MB in %.3f ms (%.1f MB/s).",names[ii],megs,millis,1000*megs/millis);
+        
+        start = std::chrono::high_resolution_clock::now();
+        auto reader = CompressedReader::alloc(datafile);
+        result = reader->readAll();
+        reader->close();
+        end = std::chrono::high_resolution_clock::now();
+        millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+        CUAssertLog(result == data, "Method readAll() failed");
+        CULog("%s CompressedReader: %.2f MB in %.3f ms (%.1f MB/s).",names[ii],megs,millis,1000*megs/millis);
+    }
+    
+    Pathname(datafile).deleteFile();
+}
+
+#pragma mark -
+#pragma mark Directory Snapshots
+
+/**
+ * Creates a file with the given contents
+ *
+ * @param path      The absolute path to the file
+ * @param contents  The file contents
+ */
+static void makeFile(const std::string& path, const std::string& contents) {
+    auto writer = BinaryWriter::alloc(path);
+    writer->write(contents.data(),contents.size());
+    writer->close();
+}
+
+/**
+ * Deletes the given directory and everything in it
+ *
+ * @param root  The absolute path to the directory
+ */
+static void deleteTree(const std::string& root) {
+    // Children always follow their parents in a snapshot
+    DirectorySnapshot snapshot((Pathname(root)));
+    for(size_t ii = snapshot.size(); ii > 0; ii--) {
+        Pathname path(root+"/"+snapshot.getPath(ii-1));
+        if (snapshot[ii-1].type == DirectorySnapshot::Type::DIRECTORY) {
+            path.deleteDirectory();
+        } else {
+            path.deleteFile();
+        }
+    }
+    Pathname(root).deleteDirectory();
+}
+
+/**
+ * Returns a summary of the changes, with the symbols +, -, and ~
+ *
+ * @param later     The later snapshot
+ * @param earlier   The earlier snapshot
+ *
+ * @return a summary of the changes, with the symbols +, -, and ~
+ */
+static std::string summarize(const DirectorySnapshot& later, const DirectorySnapshot& earlier) {
+    std::string result;
+    std::vector<DirectorySnapshot::Change> changes = later.diff(earlier);
+    for(auto it = changes.begin(); it != changes.end(); ++it) {
+        if (it->isAdded()) {
+            result += "+";
+            result += later.getPath(it->after);
+        } else if (it->isRemoved()) {
+            result += "-";
+            result += earlier.getPath(it->before);
+        } else {
+            result += "~";
+            result += later.getPath(it->after);
+        }
+        result += " ";
+    }
+    return result;
+}
+
+void testDirectorySnapshot() {
+    CULog("Running tests for DirectorySnapshot.\n");
+    std::string root = scratch("cugl_snapshot");
+    deleteTree(root);
+    Pathname(root).createDirectory();
+    Pathname(root+"/sub").createDirectory();
+    Pathname(root+"/sub/deep").createDirectory();
+    makeFile(Pathname(root+"/a.txt").getAbsoluteName(),"alpha");
+    makeFile(Pathname(root+"/b.txt").getAbsoluteName(),"bravo!");
+    makeFile(Pathname(root+"/sub/c.txt").getAbsoluteName(),"charlie");
+    makeFile(Pathname(root+"/sub/deep/d.txt").getAbsoluteName(),"delta");
+    
+    // Pathname queries
+    Pathname cfile(root+"/sub/c.txt");
+    CUAssertLog(cfile.length() == 7,                        "Method Pathname::length() failed");
+    CUAssertLog(Pathname(root+"/none.txt").length() == 0,    "Method Pathname::length() failed on missing file");
+    CUAssertLog(Pathname(root).list().size() == 3,          "Method Pathname::list() failed");
+    std::vector<Pathname> paths = Pathname(root+"/sub").listPaths();
+    CUAssertLog(paths.size() == 2,                          "Method Pathname::listPaths() failed");
+    for(auto it = paths.begin(); it != paths.end(); ++it) {
+        CUAssertLog(it->exists(),                           "Method Pathname::listPaths() has bad path %s",it->getAbsoluteName().c_str());
+    }
+    Pathname moved(std::move(cfile));
+    CUAssertLog(moved.getAbsoluteName() == Pathname(root+"/sub/c.txt").getAbsoluteName(), "Pathname move failed");
+    CUAssertLog(moved.isFile(),                             "Pathname move failed");
+    
+    // Snapshot queries
+    DirectorySnapshot snapshot((Pathname(root)));
+    CUAssertLog(snapshot.size() == 6,                       "Method scan() failed");
+    CUAssertLog(snapshot.isFile("a.txt"),                   "Method isFile() failed");
+    CUAssertLog(!snapshot.isFile("sub"),                    "Method isFile() failed");
+    CUAssertLog(snapshot.isDirectory("sub/deep"),           "Method isDirectory() failed");
+    CUAssertLog(!snapshot.exists("sub/none.txt"),           "Method exists() failed");
+    CUAssertLog(!snapshot.exists("sub/deep/"),              "Method exists() failed");
+    CUAssertLog(snapshot.length("b.txt") == 6,              "Method length() failed");
+    CUAssertLog(snapshot.length("none.txt") == 0,           "Method length() failed");
+    CUAssertLog(snapshot.lastModified("sub/c.txt") == moved.lastModified(), "Method lastModified() failed");
+    Sint64 index = snapshot.find("sub/deep/d.txt");
+    CUAssertLog(index >= 0 && std::string(snapshot.getName(index)) == "d.txt", "Method getName() failed");
+    CUAssertLog(snapshot[index].length == 14,               "Entry length is wrong");
+    for(size_t ii = 1; ii < snapshot.size(); ii++) {
+        CUAssertLog(strcmp(snapshot.getPath(ii-1),snapshot.getPath(ii)) < 0, "Snapshot is not sorted");
+    }
+    CUAssertLog(summarize(snapshot,snapshot).empty(),       "Method diff() failed on identical snapshots");
+    
+    // Differences
+    DirectorySnapshot before(snapshot);
+    CUAssertLog(before.size() == snapshot.size(),           "Snapshot copy failed");
+    makeFile(Pathname(root+"/sub/c.txt").getAbsoluteName(),"charlie chaplin");
+    makeFile(Pathname(root+"/sub/e.txt").getAbsoluteName(),"echo");
+    Pathname(root+"/b.txt").deleteFile();
+    Pathname(root+"/sub/deep/d.txt").deleteFile();
+    Pathname(root+"/sub/deep").deleteDirectory();
+    Pathname(root+"/new").createDirectory();
+    makeFile(Pathname(root+"/new/f.txt").getAbsoluteName(),"foxtrot");
+    CUAssertLog(before.exists("b.txt"),                     "Snapshot accessed the file system");
+    CUAssertLog(snapshot.refresh(),                         "Method refresh() failed");
+    std::string summary = summarize(snapshot,before);
+    CUAssertLog(summary == "-b.txt +new +new/f.txt ~sub/c.txt -sub/deep -sub/deep/d.txt +sub/e.txt ",
+                "Method diff() failed: %s",summary.c_str());
+    
+#if defined (__LINUX__)
+    // Incremental refreshes
+    DirectorySnapshot watched((Pathname(root)));
+    CUAssertLog(watched.watch(),                            "Method watch() failed");
+    CUAssertLog(!watched.refresh(),                         "Method refresh() found phantom changes");
+    DirectorySnapshot copy(watched);
+    CUAssertLog(!copy.isWatching(),                         "Snapshot copy is watching");
+    
+    // Changes at every level, including moves and new subtrees
+    makeFile(Pathname(root+"/a.txt").getAbsoluteName(),"alpha beta");
+    makeFile(Pathname(root+"/new/g.txt").getAbsoluteName(),"golf");
+    Pathname(root+"/new/inner").createDirectory();
+    Pathname(root+"/new/inner/core").createDirectory();
+    makeFile(Pathname(root+"/new/inner/core/h.txt").getAbsoluteName(),"hotel");
+    Pathname(root+"/sub").renameTo(Pathname(root+"/moved"));
+    CUAssertLog(watched.refresh(),                          "Method refresh() missed changes");
+    summary = summarize(watched,DirectorySnapshot(Pathname(root)));
+    CUAssertLog(summary.empty(),                            "Method refresh() is incorrect: %s",summary.c_str());
+    summary = summarize(watched,copy);
+    CUAssertLog(summary == "~a.txt +moved +moved/c.txt +moved/e.txt +new/g.txt +new/inner +new/inner/core +new/inner/core/h.txt -sub -sub/c.txt -sub/e.txt ",
+                "Method diff() failed: %s",summary.c_str());
+    
+    // Changes inside moved directories, and recreated directories
+    makeFile(Pathname(root+"/moved/i.txt").getAbsoluteName(),"india");
+    deleteTree(Pathname(root+"/new/inner").getAbsoluteName());
+    Pathname(root+"/new/inner").createDirectory();
+    makeFile(Pathname(root+"/new/inner/j.txt").getAbsoluteName(),"juliett");
+    Pathname(root+"/new/inner").renameTo(Pathname(root+"/moved/inner"));
+    CUAssertLog(watched.refresh(),                          "Method refresh() missed changes");
+    summary = summarize(watched,DirectorySnapshot(Pathname(root)));
+    CUAssertLog(summary.empty(),                            "Method refresh() is incorrect: %s",summary.c_str());
+    
+    makeFile(Pathname(root+"/moved/inner/k.txt").getAbsoluteName(),"kilo");
+    DirectorySnapshot taken(std::move(watched));
+    CUAssertLog(taken.isWatching() && !watched.isWatching(), "Snapshot move failed");
+    CUAssertLog(taken.refresh() && taken.isFile("moved/inner/k.txt"), "Method refresh() missed changes");
+    CUAssertLog(!taken.refresh(),                           "Method refresh() found phantom changes");
+#endif
+    
+    deleteTree(root);
+    CUAssertLog(!Pathname(root).exists(),                   "Directory cleanup failed");
+    snapshot.refresh();
+    CUAssertLog(snapshot.size() == 0,                       "Method refresh() failed on missing directory");
+    CULog("DirectorySnapshot tests complete.\n");
+}
+
+void benchDirectorySnapshot() {
+    const int dirs  = 32;
+    const int files = 128;
+    std::string root = scratch("cugl_snapshot");
+    deleteTree(root);
+    Pathname(root).createDirectory();
+    for(int ii = 0; ii < dirs; ii++) {
+        std::string dir = "level"+std::to_string(ii);
+        Pathname(root+"/"+dir).createDirectory();
+        for(int jj = 0; jj < files; jj++) {
+            makeFile(Pathname(root+"/"+dir+"/asset"+std::to_string(jj)+".json").getAbsoluteName(),std::string(jj+1,'x'));
+        }
+    }
+    
+    // Walking the tree with Pathname stats every file for every query
+    Uint64 total = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<Pathname> levels = Pathname(root).listPaths();
+    for(auto it = levels.begin(); it != levels.end(); ++it) {
+        std::vector<Pathname> assets = it->listPaths();
+        for(auto jt = assets.begin(); jt != assets.end(); ++jt) {
+            if (jt->isFile()) {
+                total += jt->length()+jt->lastModified();
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("Pathname walk of %d files: %.3f ms.",dirs*files,millis);
+    
+    start = std::chrono::high_resolution_clock::now();
+    DirectorySnapshot snapshot((Pathname(root)));
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("DirectorySnapshot scan of %d files: %.3f ms.",dirs*files,millis);
+    
+    Uint64 check = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for(int ii = 0; ii < dirs; ii++) {
+        std::string dir = "level"+std::to_string(ii);
+        for(int jj = 0; jj < files; jj++) {
+            std::string path = dir+"/asset"+std::to_string(jj)+".json";
+            if (snapshot.isFile(path)) {
+                check += snapshot.length(path)+snapshot.lastModified(path);
+            }
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CUAssertLog(check == total, "DirectorySnapshot queries disagree with Pathname");
+    CULog("DirectorySnapshot queries of %d files: %.3f ms.",dirs*files,millis);
+    
+    // Look for a few modified files, as in hot reloading
+    const int edits = 4;
+    DirectorySnapshot previous(snapshot);
+    bool watching = snapshot.watch();
+    for(int ii = 0; ii < edits; ii++) {
+        makeFile(Pathname(root+"/level"+std::to_string(ii*7)+"/asset0.json").getAbsoluteName(),"edited");
+    }
+    start = std::chrono::high_resolution_clock::now();
+    snapshot.refresh();
+    std::vector<DirectorySnapshot::Change> changes = snapshot.diff(previous);
+    end = std::chrono::high_resolution_clock::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CUAssertLog(changes.size() == edits, "Method diff() found %zu changes", changes.size());
+    CULog("DirectorySnapshot refresh and diff (%s): %.3f ms.",watching ? "watching" : "full scan",millis);
+    
+    deleteTree(root);
+}
+
+
+#pragma mark -
+#pragma mark Test Harness
+
+void ioUnitTest() {
+    testMappedFile();
+    benchMappedFile();
+    testBinaryArrays();
+    benchBinaryArrays();
+    testAsyncIO();
+    benchAsyncIO();
+    testCompression();
+    benchCompression();
+    testDirectorySnapshot();
+    benchDirectorySnapshot();
+}
+
+}
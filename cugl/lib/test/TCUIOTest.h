@@ -0,0 +1,91 @@
+//
+//  TCUIOTest.h
+//  CUGL
+//
+//  Created by Walker White on 10/18/26.
+//  Copyright © 2026 Game Design Initiative at Cornell. All rights reserved.
+//
+
+#ifndef __T_CU_IO_TEST_H__
+#define __T_CU_IO_TEST_H__
+
+namespace cugl {
+
+/**
+ * Unit test for memory mapped files and readers
+ *
+ * This test writes its files to the save directory and deletes them after.
+ */
+void testMappedFile();
+
+/**
+ * Performance test for memory mapped readers
+ *
+ * This test logs the throughput of the buffered and mapped readers in MB/s.
+ */
+void benchMappedFile();
+
+/**
+ * Unit test for bulk array reads and writes
+ *
+ * This test checks every element type against both buffered and mapped readers.
+ */
+void testBinaryArrays();
+
+/**
+ * Performance test for bulk array reads and writes
+ *
+ * This test logs the throughput of element and array access in MB/s.
+ */
+void benchBinaryArrays();
+
+/**
+ * Unit test for the asynchronous I/O service
+ *
+ * This test only uses futures, as callbacks require a running application.
+ */
+void testAsyncIO();
+
+/**
+ * Performance test for the asynchronous I/O service
+ *
+ * This test logs the main thread stall and throughput of concurrent saves.
+ */
+void benchAsyncIO();
+
+/**
+ * Unit test for the compression codec and compressed streams
+ *
+ * This test includes corrupt and truncated data, which should log errors.
+ */
+void testCompression();
+
+/**
+ * Performance test for the compression codec
+ *
+ * This test logs the speed in MB/s and the ratio on JSON and binary data.
+ */
+void benchCompression();
+
+/**
+ * Unit test for directory snapshots and the Pathname queries
+ *
+ * The incremental refresh is only tested on platforms that support watching.
+ */
+void testDirectorySnapshot();
+
+/**
+ * Performance test for directory snapshots
+ *
+ * This test compares a snapshot to a Pathname walk, and logs the time to refresh.
+ */
+void benchDirectorySnapshot();
+
+/**
+ * Master unit test that invokes all others in this module.
+ */
+void ioUnitTest();
+
+}
+
+#endif /* __T_CU_IO_TEST_H__ */
@@ -33,6 +33,8 @@
 #include "TCUMathTest.h"
 #include <string>
 #include <chrono>
+#include <vector>
+#include <new>
 #include <cugl/cugl.h>
 
 /** Round-off varies from platform to platform.  This is our tolerance */
@@ -6784,11 +6786,143 @@ void testMat4() {
     test6.set(atest1);
     CUAssertAlwaysLog(test6.equals(test5),          "Alternate Affine2 assignment failed");
     
+#pragma mark Vectorization Test
+    // Compare against a scalar reference, with matrices at unaligned addresses
+    Mat4 vmat1(1,-2,3,4,5,6,-7,8,9,10,11,-12,13,14,15,16);
+    Mat4 vmat2(0.5f,1,0,2,-1,3,0.25f,1,2,0,1,-3,4,1,2,1);
+    float expected[16];
+    for(int col = 0; col < 4; col++) {
+        for(int row = 0; row < 4; row++) {
+            float sum = 0;
+            for(int k = 0; k < 4; k++) {
+                sum += vmat2.m[4*k+row]*vmat1.m[4*col+k];
+            }
+            expected[4*col+row] = sum;
+        }
+    }
+    
+    char storage[4*sizeof(Mat4)+sizeof(float)];
+    Mat4* vmat3 = new (storage+sizeof(float)) Mat4(vmat1);
+    Mat4* vmat4 = new (storage+sizeof(float)+sizeof(Mat4)) Mat4(vmat2);
+    Mat4* vmat5 = new (storage+sizeof(float)+2*sizeof(Mat4)) Mat4();
+    Mat4::multiply(*vmat3,*vmat4,vmat5);
+    bool match = true;
+    for(int ii = 0; ii < 16; ii++) {
+        match = match && CU_MATH_APPROX(vmat5->m[ii],expected[ii],CU_TEST_EPSILON);
+    }
+    CUAssertAlwaysLog(match,                        "Unaligned multiply failed");
+    
+    // The destination may be either argument
+    Mat4::multiply(*vmat3,*vmat4,vmat3);
+    CUAssertAlwaysLog(*vmat3 == *vmat5,             "Aliased multiply failed");
+    vmat3->set(vmat1);
+    Mat4::multiply(*vmat3,*vmat4,vmat4);
+    CUAssertAlwaysLog(*vmat4 == *vmat5,             "Aliased multiply failed");
+    
+    Mat4::add(vmat1,vmat2,vmat5);
+    Mat4::subtract(*vmat5,vmat2,vmat5);
+    CUAssertAlwaysLog(vmat5->equals(vmat1,CU_TEST_EPSILON), "Unaligned add failed");
+    Mat4::transpose(vmat1,vmat5);
+    CUAssertAlwaysLog(vmat5->m[1] == vmat1.m[4] && vmat5->m[14] == vmat1.m[11],
+                      "Unaligned transpose failed");
+    Mat4::negate(*vmat5,vmat5);
+    CUAssertAlwaysLog(vmat5->m[1] == -vmat1.m[4], "Unaligned negate failed");
+    
+    // Matrices in containers and shared objects
+    std::vector<Mat4> vlist(7,vmat1);
+    std::shared_ptr<Mat4> vshared = std::make_shared<Mat4>(vmat2);
+    for(auto it = vlist.begin(); it != vlist.end(); ++it) {
+        *it *= *vshared;
+    }
+    match = true;
+    for(int ii = 0; ii < 16; ii++) {
+        match = match && CU_MATH_APPROX(vlist.back().m[ii],expected[ii],CU_TEST_EPSILON);
+    }
+    CUAssertAlwaysLog(match,                        "Multiply in std::vector failed");
+    
+    // Array transforms (odd count to exercise the tail)
+    std::vector<Vec4> vinput;
+    for(int ii = 0; ii < 13; ii++) {
+        vinput.push_back(Vec4((float)ii,1.0f-ii,0.5f*ii,(ii % 2 ? 1.0f : 0.0f)));
+    }
+    std::vector<Vec4> voutput(vinput.size());
+    Mat4::transform(vmat1,vinput.data(),voutput.data(),vinput.size());
+    match = true;
+    for(size_t ii = 0; ii < vinput.size(); ii++) {
+        Vec4 single;
+        Mat4::transform(vmat1,vinput[ii],&single);
+        match = match && single.equals(voutput[ii],CU_TEST_EPSILON);
+    }
+    CUAssertAlwaysLog(match,                        "Array transform failed");
+    Mat4::transform(vmat1,vinput.data(),vinput.data(),vinput.size());
+    match = true;
+    for(size_t ii = 0; ii < vinput.size(); ii++) {
+        match = match && vinput[ii] == voutput[ii];
+    }
+    CUAssertAlwaysLog(match,                        "In place array transform failed");
+    
 #pragma mark Complete
     CULog("Mat4 tests complete.\n");
 
 }
 
+/**
+ * Performance test for a 4x4 matrix
+ *
+ * This test logs the throughput of each vectorized operation.
+ */
+void benchMat4() {
+    const int iterations = 1000000;
+    Mat4 mat1(1,-2,3,4,5,6,-7,8,9,10,11,-12,13,14,15,16);
+    Mat4 mat2;
+    Mat4::createRotationZ(0.001f,&mat2);
+    mat1.scale(0.01f);
+    Mat4 result = mat1;
+    
+    timestamp_t start = cuclock_t::now();
+    for(int ii = 0; ii < iterations; ii++) {
+        Mat4::multiply(result,mat2,&result);
+    }
+    timestamp_t end = cuclock_t::now();
+    double micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Mat4 multiply: %.1f operations per microsecond (%.3f)",iterations/micros,result.m[0]);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < iterations; ii++) {
+        Mat4::add(result,mat2,&result);
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Mat4 add: %.1f operations per microsecond (%.3f)",iterations/micros,result.m[0]);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < iterations; ii++) {
+        Mat4::transpose(result,&result);
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Mat4 transpose: %.1f operations per microsecond (%.3f)",iterations/micros,result.m[0]);
+    
+    Vec4 vec(1,2,3,1);
+    start = cuclock_t::now();
+    for(int ii = 0; ii < iterations; ii++) {
+        Mat4::transform(mat2,vec,&vec);
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Mat4 transform: %.1f vectors per microsecond (%.3f)",iterations/micros,vec.x);
+    
+    std::vector<Vec4> vecs(4096,Vec4(1,2,3,1));
+    start = cuclock_t::now();
+    for(int ii = 0; ii < iterations/4096; ii++) {
+        Mat4::transform(mat2,vecs.data(),vecs.data(),vecs.size());
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Mat4 array transform: %.1f vectors per microsecond (%.3f)",
+          (iterations/4096)*4096/micros,vecs[0].x);
+}
+
 #pragma mark -
 #pragma mark Affine2
 /**
@@ -7490,6 +7624,72 @@ void testAffine2() {
     CUAssertAlwaysLog(rect2.equals(Rect(-3*O_SQRT2,-3*O_SQRT2,6*O_SQRT2,6*O_SQRT2)),
                       "Method transform() failed");
     
+#pragma mark Bulk Transform Test
+    // A stand-in for Vertex2, with the position interleaved in 20 bytes
+    struct Strided {
+        Vec2  position;
+        float padding[3];
+    };
+    
+    // Odd count to exercise the tail
+    Mat4 mtest3;
+    Mat4::createRotationZ(0.3f,&mtest3);
+    mtest3.scale(2,3,1);
+    mtest3.translate(5,-6,0);
+    Affine2 test9(mtest3);
+    
+    std::vector<Vec2> vinput;
+    std::vector<float> xinput, yinput;
+    std::vector<Strided> sinput(13);
+    for(int ii = 0; ii < 13; ii++) {
+        vinput.push_back(Vec2(ii-6.0f,0.5f*ii));
+        xinput.push_back(vinput.back().x);
+        yinput.push_back(vinput.back().y);
+        sinput[ii].position = vinput.back();
+    }
+    
+    std::vector<Vec2> voutput(vinput.size());
+    std::vector<Vec2> moutput(vinput.size());
+    std::vector<float> xoutput(vinput.size()), youtput(vinput.size());
+    std::vector<Strided> soutput(sinput);
+    Affine2::transform(test9,vinput.data(),voutput.data(),vinput.size());
+    Mat4::transform(mtest3,vinput.data(),moutput.data(),vinput.size());
+    Affine2::transform(test9,xinput.data(),yinput.data(),xoutput.data(),youtput.data(),vinput.size());
+    Affine2::transform(test9,&(sinput[0].position),sizeof(Strided),
+                       &(soutput[0].position),sizeof(Strided),sinput.size());
+    bool match = true;
+    for(size_t ii = 0; ii < vinput.size(); ii++) {
+        Vec2 single = test9.transform(vinput[ii]);
+        match = match && single.equals(voutput[ii],CU_TEST_EPSILON);
+    }
+    CUAssertAlwaysLog(match,                        "Affine2 array transform failed");
+    match = true;
+    for(size_t ii = 0; ii < vinput.size(); ii++) {
+        Vec2 single = mtest3.transform(vinput[ii]);
+        match = match && single.equals(moutput[ii],CU_TEST_EPSILON);
+    }
+    CUAssertAlwaysLog(match,                        "Mat4 array transform failed");
+    match = true;
+    for(size_t ii = 0; ii < vinput.size(); ii++) {
+        match = match && voutput[ii].equals(Vec2(xoutput[ii],youtput[ii]),CU_TEST_EPSILON);
+        match = match && voutput[ii].equals(soutput[ii].position,CU_TEST_EPSILON);
+        match = match && soutput[ii].padding[0] == sinput[ii].padding[0];
+    }
+    CUAssertAlwaysLog(match,                        "Affine2 layout transforms failed");
+    
+    // The transforms may be in place
+    Mat4::transform(mtest3,&(sinput[0].position),sizeof(Strided),
+                    &(sinput[0].position),sizeof(Strided),sinput.size());
+    Mat4::transform(mtest3,xinput.data(),yinput.data(),xinput.data(),yinput.data(),vinput.size());
+    Affine2::transform(test9,vinput.data(),vinput.data(),vinput.size());
+    match = true;
+    for(size_t ii = 0; ii < vinput.size(); ii++) {
+        match = match && vinput[ii] == voutput[ii];
+        match = match && sinput[ii].position.equals(moutput[ii],CU_TEST_EPSILON);
+        match = match && Vec2(xinput[ii],yinput[ii]).equals(moutput[ii],CU_TEST_EPSILON);
+    }
+    CUAssertAlwaysLog(match,                        "In place array transform failed");
+    
     
 #pragma mark Conversion Test
     std::string str1;
@@ -7547,9 +7747,580 @@ void testAffine2() {
     
 }
 
+/**
+ * Performance test for bulk 2d transforms
+ *
+ * This test logs the throughput of the bulk point transforms of Affine2 and
+ * Mat4 for each memory layout, compared to transforming each point.
+ */
+void benchAffine2() {
+    const int iterations = 1000000;
+    const size_t count = 4096;
+    const int passes = iterations/(int)count;
+    Affine2 aff;
+    Affine2::createRotation(0.001f,&aff);
+    Mat4 mat = (Mat4)aff;
+    
+    struct Strided {
+        Vec2  position;
+        float padding[3];
+    };
+    std::vector<Vec2> points(count,Vec2(1,2));
+    std::vector<Strided> vertices(count);
+    std::vector<float> xs(count,1.0f), ys(count,2.0f);
+    for(auto it = vertices.begin(); it != vertices.end(); ++it) {
+        it->position.set(1,2);
+    }
+    
+    timestamp_t start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        for(auto it = points.begin(); it != points.end(); ++it) {
+            *it *= aff;
+        }
+    }
+    timestamp_t end = cuclock_t::now();
+    double micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Affine2 point loop: %.1f vertices per microsecond (%.3f)",passes*count/micros,points[0].x);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        Affine2::transform(aff,points.data(),points.data(),count);
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Affine2 packed transform: %.1f vertices per microsecond (%.3f)",passes*count/micros,points[0].x);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        Affine2::transform(aff,&(vertices[0].position),sizeof(Strided),
+                           &(vertices[0].position),sizeof(Strided),count);
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Affine2 strided transform: %.1f vertices per microsecond (%.3f)",
+          passes*count/micros,vertices[0].position.x);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        Affine2::transform(aff,xs.data(),ys.data(),xs.data(),ys.data(),count);
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Affine2 SoA transform: %.1f vertices per microsecond (%.3f)",passes*count/micros,xs[0]);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        for(auto it = vertices.begin(); it != vertices.end(); ++it) {
+            it->position *= mat;
+        }
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Mat4 vertex loop: %.1f vertices per microsecond (%.3f)",
+          passes*count/micros,vertices[0].position.x);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        Mat4::transform(mat,&(vertices[0].position),sizeof(Strided),
+                        &(vertices[0].position),sizeof(Strided),count);
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Mat4 strided transform: %.1f vertices per microsecond (%.3f)",
+          passes*count/micros,vertices[0].position.x);
+}
+
+#pragma mark -
+#pragma mark Structure of Arrays
+/**
+ * Unit test for an array of 2d vectors in structure-of-arrays form.
+ */
+void testVec2Array() {
+    CULog("Running tests for Vec2Array.\n");
+    
+#pragma mark Storage Test
+    // An odd size exercises the scalar tail of every kernel
+    const size_t count = 11;
+    std::vector<Vec2> vecs, other;
+    for(size_t ii = 0; ii < count; ii++) {
+        vecs.push_back(Vec2(sinf(ii*1.3f)*5,cosf(ii*0.7f)*3));
+        other.push_back(Vec2(cosf(ii*2.1f)*2,sinf(ii*0.4f)*4));
+    }
+    vecs[3].setZero();
+    
+    Vec2Array test1;
+    CUAssertAlwaysLog(test1.size() == 0 && !test1.isView(), "Trivial constructor failed");
+    Vec2Array test2(5);
+    CUAssertAlwaysLog(test2.size() == 5 && test2.get(4) == Vec2::ZERO, "Size constructor failed");
+    CUAssertAlwaysLog(((uintptr_t)test2.x() & 15) == 0 && ((uintptr_t)test2.y() & 15) == 0,
+                      "Size constructor failed");
+    test2.append(Vec2(1,2));
+    CUAssertAlwaysLog(test2.size() == 6 && test2.get(5) == Vec2(1,2), "Method append() failed");
+    test2.clear();
+    CUAssertAlwaysLog(test2.size() == 0 && test2.capacity() >= 6, "Method clear() failed");
+    
+    Vec2Array test3(vecs);
+    CUAssertAlwaysLog(test3.size() == count, "Load constructor failed");
+    bool match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && test3.get(ii) == vecs[ii];
+    }
+    CUAssertAlwaysLog(match, "Load constructor failed");
+    
+    std::vector<Vec2> result(count);
+    test3.store(result.data());
+    CUAssertAlwaysLog(result == vecs, "Method store() failed");
+    
+    // Strided access, as in a vertex buffer
+    std::vector<float> strided(count*5,-1.0f);
+    test3.store(strided.data(),5);
+    CUAssertAlwaysLog(strided[5] == vecs[1].x && strided[6] == vecs[1].y && strided[7] == -1,
+                      "Method store() failed");
+    test1.load(strided.data(),count,5);
+    CUAssertAlwaysLog(test1.size() == count && test1.get(7) == vecs[7], "Method load() failed");
+    
+    // Views share their storage
+    std::vector<float> xs(count,0.0f), ys(count,0.0f);
+    Vec2Array view(xs.data(),ys.data(),count);
+    CUAssertAlwaysLog(view.isView() && view.size() == count, "View constructor failed");
+    view.load(vecs.data(),count);
+    CUAssertAlwaysLog(xs[2] == vecs[2].x && ys[2] == vecs[2].y, "View load failed");
+    Vec2Array copy(view);
+    CUAssertAlwaysLog(!copy.isView() && copy.get(2) == vecs[2], "Copy constructor failed");
+    Vec2Array moved(std::move(copy));
+    CUAssertAlwaysLog(moved.get(2) == vecs[2] && copy.size() == 0, "Move constructor failed");
+    
+#pragma mark Arithmetic Test
+    Vec2Array test4(other);
+    test1 = test3;
+    test1.add(test4);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && test1.get(ii).equals(vecs[ii]+other[ii],1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method add() failed");
+    
+    test1 = test3;
+    test1.subtract(test4).add(Vec2(1,-2));
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && test1.get(ii).equals(vecs[ii]-other[ii]+Vec2(1,-2),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method subtract() failed");
+    
+    test1 = test3;
+    test1.scale(2.5f).addScaled(test4,0.5f);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && test1.get(ii).equals(vecs[ii]*2.5f+other[ii]*0.5f,1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method addScaled() failed");
+    
+    test1 = test3;
+    test1.lerp(test4,0.25f);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && test1.get(ii).equals(vecs[ii].getLerp(other[ii],0.25f),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method lerp() failed");
+    
+    test1 = test3;
+    test1.normalize();
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && test1.get(ii).equals(vecs[ii].getNormalization(),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method normalize() failed");
+    CUAssertAlwaysLog(test1.get(3) == Vec2::ZERO, "Method normalize() failed");
+    
+#pragma mark Query Test
+    std::vector<float> values(count);
+    test3.dot(test4,values.data());
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && fabsf(values[ii]-vecs[ii].dot(other[ii])) < 1e-5f;
+    }
+    CUAssertAlwaysLog(match, "Method dot() failed");
+    
+    test3.dot(Vec2(2,3),values.data());
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && fabsf(values[ii]-vecs[ii].dot(Vec2(2,3))) < 1e-5f;
+    }
+    CUAssertAlwaysLog(match, "Method dot() failed");
+    
+    test3.length(values.data());
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && fabsf(values[ii]-vecs[ii].length()) < 1e-5f;
+    }
+    CUAssertAlwaysLog(match, "Method length() failed");
+    
+    test3.lengthSquared(values.data());
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && fabsf(values[ii]-vecs[ii].lengthSquared()) < 1e-4f;
+    }
+    CUAssertAlwaysLog(match, "Method lengthSquared() failed");
+    
+#pragma mark Transform Test
+    Affine2 aff(2,1,-1,3,4,5);
+    test1 = test3;
+    test1.transform(aff);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && test1.get(ii).equals(vecs[ii]*aff,1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method transform() failed");
+    
+    std::vector<Affine2> affs;
+    for(size_t ii = 0; ii < count; ii++) {
+        affs.push_back(Affine2::createRotation(ii*0.3f));
+        affs.back().translate((float)ii,1.0f);
+    }
+    AffineArray transforms(affs);
+    test1 = test3;
+    test1.transform(transforms);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && test1.get(ii).equals(vecs[ii]*affs[ii],1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method transform() failed");
+    
+    CULog("Vec2Array tests complete.\n");
+}
+
+/**
+ * Unit test for an array of colors in structure-of-arrays form.
+ */
+void testColor4Array() {
+    CULog("Running tests for Color4Array.\n");
+    
+#pragma mark Storage Test
+    const size_t count = 9;
+    std::vector<Color4f> colors, other;
+    for(size_t ii = 0; ii < count; ii++) {
+        colors.push_back(Color4f(0.1f*ii,1-0.1f*ii,0.5f,0.05f+0.1f*ii));
+        other.push_back(Color4f(0.3f,0.08f*ii,1-0.05f*ii,1-0.1f*ii));
+    }
+    colors[2].a = 0;
+    other[2].a = 0;
+    
+    Color4Array test1(colors);
+    CUAssertAlwaysLog(test1.size() == count && test1.get(4) == colors[4], "Load constructor failed");
+    std::vector<Color4f> result(count);
+    test1.store(result.data());
+    CUAssertAlwaysLog(result == colors, "Method store() failed");
+    
+    std::vector<Color4> bytes(count);
+    test1.store(bytes.data());
+    bool match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        match = match && bytes[ii] == (Color4)colors[ii];
+    }
+    CUAssertAlwaysLog(match, "Method store() failed");
+    Color4Array test2;
+    test2.load(bytes.data(),count);
+    CUAssertAlwaysLog(test2.get(5) == (Color4f)bytes[5], "Method load() failed");
+    
+    std::vector<float> channels(4*count,0.0f);
+    Color4Array view(channels.data(),channels.data()+count,channels.data()+2*count,
+                     channels.data()+3*count,count);
+    view = test1;
+    CUAssertAlwaysLog(view.isView() && channels[count+4] == colors[4].g, "View assignment failed");
+    
+#pragma mark Arithmetic Test
+    Color4Array test3(other);
+    test2 = test1;
+    test2.add(test3,true);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        Color4f c = colors[ii];
+        match = match && test2.get(ii).equals(c.add(other[ii],true),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method add() failed");
+    
+    test2 = test1;
+    test2.scale(1.5f);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        Color4f c = colors[ii];
+        match = match && test2.get(ii).equals(c.scale(1.5f),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method scale() failed");
+    
+    test2 = test1;
+    test2.scale(test3,true);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        Color4f c = colors[ii];
+        match = match && test2.get(ii).equals(c.scale(other[ii],true),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method scale() failed");
+    
+    test2 = test1;
+    test2.lerp(test3,0.3f);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        Color4f c = colors[ii];
+        match = match && test2.get(ii).equals(c.lerp(other[ii],0.3f),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method lerp() failed");
+    
+#pragma mark Blending Test
+    test2 = test1;
+    test2.blend(test3);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        if (ii != 2) {
+            Color4f c = colors[ii];
+            match = match && test2.get(ii).equals(c.blend(other[ii]),1e-5f);
+        }
+    }
+    CUAssertAlwaysLog(match, "Method blend() failed");
+    CUAssertAlwaysLog(test2.get(2) == Color4f::CLEAR, "Method blend() failed");
+    
+    test2 = test1;
+    test2.premultiply();
+    test2.blendPre(test3);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        Color4f c = colors[ii];
+        c.premultiply();
+        match = match && test2.get(ii).equals(c.blendPre(other[ii]),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method blendPre() failed");
+    
+    test2 = test1;
+    test2.premultiply().unpremultiply();
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        Color4f c = colors[ii];
+        match = match && test2.get(ii).equals(c.premultiply().unpremultiply(),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method unpremultiply() failed");
+    
+    CULog("Color4Array tests complete.\n");
+}
+
+/**
+ * Unit test for an array of affine transforms in structure-of-arrays form.
+ */
+void testAffineArray() {
+    CULog("Running tests for AffineArray.\n");
+    
+#pragma mark Storage Test
+    const size_t count = 7;
+    std::vector<Affine2> affs, other;
+    for(size_t ii = 0; ii < count; ii++) {
+        affs.push_back(Affine2(1+0.1f*ii,0.2f,-0.3f*ii,2,(float)ii,-1));
+        other.push_back(Affine2::createRotation(ii*0.5f));
+        other.back().scale(2.0f).translate(3,-4);
+    }
+    
+    AffineArray test1(4);
+    CUAssertAlwaysLog(test1.size() == 4 && test1.get(3) == Affine2::IDENTITY, "Size constructor failed");
+    test1.append(affs[1]);
+    CUAssertAlwaysLog(test1.get(4) == affs[1], "Method append() failed");
+    
+    AffineArray test2(affs);
+    CUAssertAlwaysLog(test2.size() == count && test2.get(5) == affs[5], "Load constructor failed");
+    std::vector<Affine2> result(count);
+    test2.store(result.data());
+    CUAssertAlwaysLog(result == affs, "Method store() failed");
+    
+#pragma mark Composition Test
+    AffineArray test3(other);
+    test1 = test2;
+    test1.multiply(test3);
+    bool match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        Affine2 aff = affs[ii];
+        match = match && test1.get(ii).equals(aff.multiply(other[ii]),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method multiply() failed");
+    
+    test1 = test2;
+    test1.multiply(other[3]);
+    match = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        Affine2 aff = affs[ii];
+        match = match && test1.get(ii).equals(aff.multiply(other[3]),1e-5f);
+    }
+    CUAssertAlwaysLog(match, "Method multiply() failed");
+    
+    CULog("AffineArray tests complete.\n");
+}
+
+/**
+ * Performance test for the structure-of-arrays containers
+ *
+ * This test compares the particle update loop on arrays of Vec2 and Color4f
+ * against the same loop on Vec2Array and Color4Array.
+ */
+void benchVec2Array() {
+    const size_t count = 4096;
+    const int passes = 1000;
+    const float dt = 0.016f;
+    
+    std::vector<Vec2> positions(count), velocities(count);
+    std::vector<Color4f> tints(count,Color4f(1,1,1,1));
+    for(size_t ii = 0; ii < count; ii++) {
+        positions[ii].set(sinf(ii*0.1f),cosf(ii*0.1f));
+        velocities[ii].set(cosf(ii*0.3f),sinf(ii*0.3f));
+    }
+    Vec2Array soaPositions(positions), soaVelocities(velocities);
+    Color4Array soaTints(tints);
+    
+    timestamp_t start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        for(size_t jj = 0; jj < count; jj++) {
+            velocities[jj] *= 0.999f;
+            positions[jj] += velocities[jj]*dt;
+            tints[jj].scale(0.999f,true);
+        }
+    }
+    timestamp_t end = cuclock_t::now();
+    double micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("AoS particle update: %.1f particles per microsecond (%.3f)",
+          passes*count/micros,positions[0].x+tints[0].a);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        soaVelocities.scale(0.999f);
+        soaPositions.addScaled(soaVelocities,dt);
+        soaTints.scale(0.999f,true);
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("SoA particle update: %.1f particles per microsecond (%.3f)",
+          passes*count/micros,soaPositions.x()[0]+soaTints.a()[0]);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        for(size_t jj = 0; jj < count; jj++) {
+            velocities[jj].normalize();
+        }
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("AoS normalize: %.1f vectors per microsecond (%.3f)",passes*count/micros,velocities[0].x);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        soaVelocities.normalize();
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("SoA normalize: %.1f vectors per microsecond (%.3f)",passes*count/micros,soaVelocities.x()[0]);
+    
+    start = cuclock_t::now();
+    for(int ii = 0; ii < passes; ii++) {
+        soaPositions.load(positions.data(),count);
+        soaPositions.store(positions.data());
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("SoA load and store: %.1f vectors per microsecond (%.3f)",passes*count/micros,positions[0].x);
+}
+
+
 
 #pragma mark -
 #pragma mark Poly2
+/**
+ * Returns the total (signed) area of the given triangulation
+ *
+ * Every triangle should be counterclockwise, so this method fails if any
+ * triangle has negative area.
+ *
+ * @param poly  The triangulated polygon
+ *
+ * @return the total area of the given triangulation
+ */
+static float triangulatedArea(const Poly2& poly) {
+    const std::vector<Vec2>& verts = poly.getVertices();
+    const std::vector<Uint32>& indx = poly.getIndices();
+    float total = 0;
+    for(size_t ii = 0; ii+2 < indx.size(); ii += 3) {
+        CUAssertAlwaysLog(indx[ii] < verts.size() && indx[ii+1] < verts.size() && indx[ii+2] < verts.size(),
+                          "Triangulation index out of range");
+        const Vec2& a = verts[indx[ii  ]];
+        const Vec2& b = verts[indx[ii+1]];
+        const Vec2& c = verts[indx[ii+2]];
+        float area = (b-a).cross(c-a)/2.0f;
+        CUAssertAlwaysLog(area > 0, "Triangulation has an inverted triangle");
+        total += area;
+    }
+    return total;
+}
+
+/**
+ * Returns the (signed) area of the given boundary
+ *
+ * @param vertices  The polygon boundary
+ *
+ * @return the (signed) area of the given boundary
+ */
+static float boundaryArea(const std::vector<Vec2>& vertices) {
+    float total = 0;
+    for(size_t ii = 0; ii < vertices.size(); ii++) {
+        total += vertices[ii].cross(vertices[(ii+1) % vertices.size()]);
+    }
+    return total/2.0f;
+}
+
+/**
+ * Returns a star-shaped polygon with the given number of vertices
+ *
+ * The vertices alternate between two radii, so half of them are reflex.
+ * The result is counterclockwise.
+ *
+ * @param count     The number of vertices
+ *
+ * @return a star-shaped polygon with the given number of vertices
+ */
+static std::vector<Vec2> createStar(size_t count) {
+    std::vector<Vec2> result;
+    result.reserve(count);
+    for(size_t ii = 0; ii < count; ii++) {
+        float angle = (float)(2*M_PI*ii/count);
+        float radius = ii % 2 ? 50.0f : 100.0f;
+        result.push_back(Vec2(radius*cosf(angle),radius*sinf(angle)));
+    }
+    return result;
+}
+
+/**
+ * Returns true if the polygon contains the point, testing every triangle
+ *
+ * This is the brute force algorithm, which we use to verify the containment
+ * grid.  Like Poly2, it includes the triangle borders.
+ *
+ * @param poly  The triangulated polygon
+ * @param point The point to test
+ *
+ * @return true if the polygon contains the point, testing every triangle
+ */
+static bool bruteContains(const Poly2& poly, const Vec2& point) {
+    const std::vector<Vec2>& verts = poly.getVertices();
+    const std::vector<Uint32>& indx = poly.getIndices();
+    for(size_t ii = 0; ii+2 < indx.size(); ii += 3) {
+        const Vec2& a = verts[indx[ii  ]];
+        const Vec2& b = verts[indx[ii+1]];
+        const Vec2& c = verts[indx[ii+2]];
+        float d1 = (b-a).cross(point-a);
+        float d2 = (c-b).cross(point-b);
+        float d3 = (a-c).cross(point-c);
+        bool neg = d1 < 0 || d2 < 0 || d3 < 0;
+        bool pos = d1 > 0 || d2 > 0 || d3 > 0;
+        if ((b-a).cross(c-a) != 0 && !(neg && pos)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * Unit test for  2-dimensional polygon
  */
@@ -7567,8 +8338,8 @@ void testPoly2() {
         fvec.push_back(vertices[2*ii+1]);
     }
     
-    unsigned short parr[6] = {0,1,1,2,2,0};
-    std::vector<unsigned short> pindx;
+    Uint32 parr[6] = {0,1,1,2,2,0};
+    std::vector<Uint32> pindx;
     pindx.push_back(0);
     pindx.push_back(1);
     pindx.push_back(1);
@@ -7576,8 +8347,8 @@ void testPoly2() {
     pindx.push_back(2);
     pindx.push_back(0);
     
-    unsigned short sarr[3] = {0,1,2};
-    std::vector<unsigned short> sindx;
+    Uint32 sarr[3] = {0,1,2};
+    std::vector<Uint32> sindx;
     sindx.push_back(0);
     sindx.push_back(1);
     sindx.push_back(2);
@@ -7798,8 +8569,8 @@ void testPoly2() {
                       test1.getType() == Poly2::Type::SOLID  && test1.getBounds() == bounds,
                       "Array-based setIndex failed");
     
-    unsigned short arr1[3] = {10,11,12};
-    unsigned short arr2[5] = {0,1,2,1,0};
+    Uint32 arr1[3] = {10,11,12};
+    Uint32 arr2[5] = {0,1,2,1,0};
     test1.clear();
     test2.set(vvec,sindx);
     test3.set(vvec,pindx);
@@ -7824,6 +8595,21 @@ void testPoly2() {
     CUAssertAlwaysLog(!test6.isValid(),         "Method isValid() failed");
     CUAssertAlwaysLog(!test7.isValid(),         "Method isValid() failed");
 
+    // Indices are not limited to 65,535 vertices
+    std::vector<Vec2> large;
+    for(int ii = 0; ii < 70000; ii++) {
+        large.push_back(Vec2(cosf(ii*0.00008f),sinf(ii*0.00008f)));
+    }
+    PathOutliner outliner;
+    outliner.set(large);
+    outliner.calculate(PathTraversal::CLOSED);
+    test1.clear();
+    outliner.getPolygon(&test1);
+    CUAssertAlwaysLog(test1.getIndices().size() == 140000,  "Large path outline failed");
+    CUAssertAlwaysLog(test1.getIndices()[139998] == 69999,  "Large path outline failed");
+    CUAssertAlwaysLog(test1.isValid() && test1.isStandardized(), "Large path outline failed");
+    test1.clear();
+
 #pragma mark Operator Test
     test1.set(vvec);
     test4.set(vvec);
@@ -7945,11 +8731,731 @@ void testPoly2() {
     CUAssertAlwaysLog(test4.incident(Vec2(0.5,0)),          "Method incident() failed");
     CUAssertAlwaysLog(test5.incident(Vec2(0.5,0)),          "Method incident() failed");
 
+#pragma mark Containment Test
+    // Large enough to use the containment grid
+    MonotoneTriangulator triang(createStar(512));
+    triang.calculate();
+    test1 = triang.getPolygon();
+    
+    std::vector<Vec2> points;
+    for(int yy = -55; yy <= 55; yy++) {
+        for(int xx = -55; xx <= 55; xx++) {
+            points.push_back(Vec2(xx*1.9f+0.01f,yy*1.9f-0.02f));
+        }
+    }
+    points.push_back(test1.getVertices()[0]);
+    points.push_back(test1.getVertices()[1]);
+    
+    bool correct = true;
+    size_t inside = 0;
+    for(auto it = points.begin(); it != points.end(); ++it) {
+        bool expected = bruteContains(test1, *it);
+        correct = correct && test1.contains(*it) == expected;
+        inside += expected ? 1 : 0;
+    }
+    CUAssertAlwaysLog(correct,                              "Method contains() failed");
+    CUAssertAlwaysLog(inside > 0 && inside < points.size(), "Method contains() failed");
+    CUAssertAlwaysLog(test1.contains(points[points.size()-1]), "Method contains() failed");
+    
+    bool* results = new bool[points.size()];
+    CUAssertAlwaysLog(test1.contains(points.data(), results, points.size()) == inside, "Method contains() failed");
+    for(size_t ii = 0; ii < points.size(); ii++) {
+        correct = correct && results[ii] == test1.contains(points[ii]);
+    }
+    CUAssertAlwaysLog(correct,                              "Method contains() failed");
+    
+    // The grid is discarded on mutation
+    test2 = test1;
+    test1 += Vec2(1000,0);
+    CUAssertAlwaysLog(!test1.contains(Vec2::ZERO),          "Method contains() failed");
+    CUAssertAlwaysLog(test1.contains(Vec2(1000,0)),         "Method contains() failed");
+    CUAssertAlwaysLog(test2.contains(Vec2::ZERO),           "Method contains() failed");
+    test2.at(0) = Vec2(200,0);
+    CUAssertAlwaysLog(test2.contains(Vec2(150,0)),          "Method contains() failed");
+    test2.setType(Poly2::Type::PATH);
+    CUAssertAlwaysLog(!test2.contains(Vec2::ZERO),          "Method contains() failed");
+    CUAssertAlwaysLog(test2.contains(points.data(), results, points.size()) == 0, "Method contains() failed");
+    delete[] results;
+
 #pragma mark Complete
     CULog("Poly2 tests complete.\n");
     
 }
 
+
+#pragma mark -
+#pragma mark Triangulator
+/**
+ * Performance test for polygon containment
+ *
+ * This test logs the throughput of containment queries on a large polygon,
+ * comparing the containment grid to a test of every triangle.
+ */
+void benchPoly2() {
+    MonotoneTriangulator triang(createStar(5000));
+    triang.calculate();
+    Poly2 poly = triang.getPolygon();
+    
+    const size_t count = 100000;
+    std::vector<Vec2> points;
+    points.reserve(count);
+    for(size_t ii = 0; ii < count; ii++) {
+        points.push_back(Vec2((ii % 317)*0.7f-110.0f,((ii*7) % 311)*0.7f-110.0f));
+    }
+    
+    size_t inside = 0;
+    timestamp_t start = cuclock_t::now();
+    for(size_t ii = 0; ii < count/100; ii++) {
+        inside += bruteContains(poly, points[ii]) ? 1 : 0;
+    }
+    timestamp_t end = cuclock_t::now();
+    double micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Poly2 brute force contains: %.3f queries per microsecond (%zu)",count/100/micros,inside);
+    
+    inside = 0;
+    start = cuclock_t::now();
+    poly.contains(Vec2::ZERO);
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Poly2 grid construction: %.1f microseconds",micros);
+    
+    start = cuclock_t::now();
+    for(auto it = points.begin(); it != points.end(); ++it) {
+        inside += poly.contains(*it) ? 1 : 0;
+    }
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Poly2 grid contains: %.3f queries per microsecond (%zu)",count/micros,inside);
+    
+    bool* results = new bool[count];
+    start = cuclock_t::now();
+    inside = poly.contains(points.data(), results, count);
+    end = cuclock_t::now();
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count();
+    CULog("Poly2 batch contains: %.3f queries per microsecond (%zu)",count/micros,inside);
+    delete[] results;
+}
+
+/**
+ * Unit test for the polygon triangulators
+ */
+void testTriangulator() {
+    CULog("Running tests for Triangulator.\n");
+    
+#pragma mark Simple Polygon Test
+    std::vector<Vec2> square = { Vec2(0,0), Vec2(10,0), Vec2(10,10), Vec2(0,10) };
+    MonotoneTriangulator triang(square);
+    triang.calculate();
+    Poly2 test1 = triang.getPolygon();
+    CUAssertAlwaysLog(test1.getType() == Poly2::Type::SOLID,   "Method getPolygon() failed");
+    CUAssertAlwaysLog(test1.getIndices().size() == 6,          "Method calculate() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(triangulatedArea(test1), 100.0f, CU_MATH_EPSILON), "Method calculate() failed");
+    
+    std::vector<Vec2> reversed(square.rbegin(),square.rend());
+    triang.set(reversed);
+    triang.calculate();
+    test1 = triang.getPolygon();
+    CUAssertAlwaysLog(test1.getIndices().size() == 6,          "Method calculate() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(triangulatedArea(test1), 100.0f, CU_MATH_EPSILON), "Method calculate() failed");
+    
+    // Colinear points and horizontal edges
+    std::vector<Vec2> comb = { Vec2(0,0), Vec2(5,0), Vec2(10,0), Vec2(10,10), Vec2(8,10), Vec2(8,2),
+                               Vec2(6,2), Vec2(6,10), Vec2(4,10), Vec2(4,2), Vec2(2,2), Vec2(2,10), Vec2(0,10) };
+    triang.set(comb);
+    triang.calculate();
+    test1 = triang.getPolygon();
+    CUAssertAlwaysLog(test1.getIndices().size() <= 3*(comb.size()-2), "Method calculate() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(triangulatedArea(test1), 68.0f, CU_MATH_EPSILON), "Method calculate() failed");
+    
+    std::vector<Vec2> star = createStar(64);
+    triang.set(star);
+    triang.calculate();
+    test1 = triang.getPolygon();
+    SimpleTriangulator simple(star);
+    simple.calculate();
+    Poly2 test2 = simple.getPolygon();
+    CUAssertAlwaysLog(test1.getIndices().size() == test2.getIndices().size(), "Method calculate() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(triangulatedArea(test1), boundaryArea(star), 0.01f), "Method calculate() failed");
+    
+    std::vector<Uint32> indices = triang.getTriangulation();
+    CUAssertAlwaysLog(indices == test1.getIndices(),           "Method getTriangulation() failed");
+    CUAssertAlwaysLog(triang.getTriangulation(indices) == indices.size()/2, "Method getTriangulation() failed");
+    
+#pragma mark Hole Test
+    std::vector<Vec2> hole1 = { Vec2(2,2), Vec2(2,4), Vec2(4,4), Vec2(4,2) };
+    std::vector<Vec2> hole2 = { Vec2(6,6), Vec2(8,6), Vec2(7,8) };
+    triang.set(square);
+    triang.addHole(hole1);
+    triang.calculate();
+    test1 = triang.getPolygon();
+    CUAssertAlwaysLog(test1.getVertices().size() == 8,         "Method addHole() failed");
+    CUAssertAlwaysLog(test1.getIndices().size() == 3*8,        "Method addHole() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(triangulatedArea(test1), 96.0f, CU_MATH_EPSILON), "Method addHole() failed");
+    
+    triang.addHole(hole2);
+    triang.addHole(std::vector<Vec2>(2,Vec2::ONE));
+    triang.calculate();
+    test1 = triang.getPolygon();
+    CUAssertAlwaysLog(test1.getVertices().size() == 11,        "Method addHole() failed");
+    CUAssertAlwaysLog(test1.getIndices().size() == 3*13,       "Method addHole() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(triangulatedArea(test1), 94.0f, CU_MATH_EPSILON), "Method addHole() failed");
+    
+    Poly2 circle;
+    Poly2::createEllipse(Vec2::ZERO, Size(400,400), 1000, &circle, false);
+    triang.set(circle);
+    triang.addHole(star);
+    triang.calculate();
+    test1 = triang.getPolygon();
+    float expected = circle.getVertices().size()*40000*sinf((float)(2*M_PI/circle.getVertices().size()))/2;
+    expected -= boundaryArea(star);
+    CUAssertAlwaysLog(test1.getIndices().size() == 3*(1000+64+2-2), "Method addHole() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(triangulatedArea(test1), expected, 1.0f), "Method addHole() failed");
+    
+    test2.set(square);
+    triang.getPolygon(&test2);
+    CUAssertAlwaysLog(test2.getVertices().size() == 1068,      "Method getPolygon() failed");
+    CUAssertAlwaysLog(test2.getIndices().size() == test1.getIndices().size(),  "Method getPolygon() failed");
+    CUAssertAlwaysLog(test2.getIndices()[0] == test1.getIndices()[0]+4,  "Method getPolygon() failed");
+    
+    triang.clear();
+    triang.calculate();
+    CUAssertAlwaysLog(triang.getTriangulation().empty(),       "Method clear() failed");
+
+#pragma mark Complete
+    CULog("Triangulator tests complete.\n");
+}
+
+/**
+ * Performance test for the polygon triangulators
+ *
+ * This test logs the time to triangulate stars of increasing size, comparing
+ * the sweep line of MonotoneTriangulator to the ear clipping of
+ * SimpleTriangulator.
+ */
+void benchTriangulator() {
+    size_t sizes[] = { 100, 1000, 5000, 50000 };
+    for(size_t size : sizes) {
+        std::vector<Vec2> star = createStar(size);
+        
+        MonotoneTriangulator monotone(star);
+        timestamp_t start = cuclock_t::now();
+        monotone.calculate();
+        timestamp_t end = cuclock_t::now();
+        double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+        CULog("MonotoneTriangulator with %zu vertices: %.3f ms",size,millis);
+        
+        // Ear clipping is too slow for the largest polygon
+        if (size <= 5000) {
+            SimpleTriangulator simple(star);
+            start = cuclock_t::now();
+            simple.calculate();
+            end = cuclock_t::now();
+            millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+            CULog("SimpleTriangulator with %zu vertices: %.3f ms",size,millis);
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Extruder
+/**
+ * Returns a wavy path with the given number of points
+ *
+ * @param count     The number of points
+ *
+ * @return a wavy path with the given number of points
+ */
+static std::vector<Vec2> createWave(size_t count) {
+    std::vector<Vec2> result;
+    result.reserve(count);
+    for(size_t ii = 0; ii < count; ii++) {
+        result.push_back(Vec2(ii*3.0f,20.0f*sinf(ii*0.3f)));
+    }
+    return result;
+}
+
+/**
+ * Unit test for the path extruder
+ */
+void testExtruder() {
+    CULog("Running tests for PathExtruder.\n");
+    
+#pragma mark Incremental Test
+    std::vector<Vec2> path = createWave(200);
+    PathJoint joints[] = { PathJoint::NONE, PathJoint::MITRE, PathJoint::BEVEL, PathJoint::ROUND };
+    PathCap caps[] = { PathCap::NONE, PathCap::SQUARE, PathCap::ROUND };
+    
+    bool correct = true;
+    for(PathJoint joint : joints) {
+        for(PathCap cap : caps) {
+            PathExtruder full(path,false);
+            full.calculate(2.0f,joint,cap);
+            Poly2 expected = full.getPolygon();
+            
+            PathExtruder grow(std::vector<Vec2>(path.begin(),path.begin()+2),false);
+            grow.calculate(2.0f,joint,cap);
+            for(size_t ii = 2; ii < path.size(); ii += 7) {
+                grow.append(std::vector<Vec2>(path.begin()+ii,path.begin()+std::min(ii+7,path.size())));
+                grow.calculate(2.0f,joint,cap);
+            }
+            Poly2 actual = grow.getPolygon();
+            correct = correct && actual.getVertices() == expected.getVertices();
+            correct = correct && actual.getIndices() == expected.getIndices();
+        }
+    }
+    CUAssertAlwaysLog(correct, "Method append() failed");
+    
+    // Changing the settings recomputes the entire path
+    PathExtruder full(path,false);
+    full.calculate(3.0f,PathJoint::MITRE,PathCap::SQUARE);
+    PathExtruder grow(std::vector<Vec2>(path.begin(),path.begin()+100),false);
+    grow.calculate(2.0f,PathJoint::MITRE,PathCap::SQUARE);
+    grow.append(std::vector<Vec2>(path.begin()+100,path.end()));
+    CUAssertAlwaysLog(grow.getPolygon().getVertices().empty(), "Method append() failed");
+    grow.calculate(3.0f,PathJoint::MITRE,PathCap::SQUARE);
+    CUAssertAlwaysLog(grow.getPolygon().getVertices() == full.getPolygon().getVertices(), "Method append() failed");
+    CUAssertAlwaysLog(grow.getPolygon().getIndices() == full.getPolygon().getIndices(), "Method append() failed");
+
+#pragma mark Parallel Test
+    std::shared_ptr<ThreadPool> pool = ThreadPool::alloc(4);
+    path = createWave(20000);
+    for(PathJoint joint : joints) {
+        for(int closed = 0; closed < 2; closed++) {
+            PathExtruder single(path,closed != 0);
+            single.calculate(2.0f,joint,PathCap::ROUND);
+            PathExtruder parallel(path,closed != 0);
+            parallel.calculate(2.0f,joint,PathCap::ROUND,pool);
+            Poly2 expected = single.getPolygon();
+            Poly2 actual = parallel.getPolygon();
+            correct = correct && actual.getVertices() == expected.getVertices();
+            correct = correct && actual.getIndices() == expected.getIndices();
+        }
+    }
+    CUAssertAlwaysLog(correct, "Method calculate() failed");
+
+#pragma mark Complete
+    CULog("PathExtruder tests complete.\n");
+}
+
+/**
+ * Performance test for the path extruder
+ *
+ * This test logs the time to extrude a growing path every frame, both by
+ * extruding the entire path and by extruding only the new segments.  It
+ * also compares a single threaded extrusion of a long path to a parallel one.
+ */
+void benchExtruder() {
+    std::vector<Vec2> path = createWave(2000);
+    
+    PathExtruder extruder;
+    timestamp_t start = cuclock_t::now();
+    for(size_t ii = 2; ii <= path.size(); ii++) {
+        extruder.set(std::vector<Vec2>(path.begin(),path.begin()+ii),false);
+        extruder.calculate(2.0f);
+    }
+    timestamp_t end = cuclock_t::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("PathExtruder full extrusion of %zu frames: %.3f ms",path.size()-1,millis);
+    
+    start = cuclock_t::now();
+    extruder.set(std::vector<Vec2>(path.begin(),path.begin()+2),false);
+    extruder.calculate(2.0f);
+    for(size_t ii = 2; ii < path.size(); ii++) {
+        extruder.append(path[ii]);
+        extruder.calculate(2.0f);
+    }
+    end = cuclock_t::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("PathExtruder incremental extrusion of %zu frames: %.3f ms",path.size()-1,millis);
+    
+    std::shared_ptr<ThreadPool> pool = ThreadPool::alloc(4);
+    path = createWave(200000);
+    extruder.set(path,false);
+    start = cuclock_t::now();
+    extruder.calculate(2.0f);
+    end = cuclock_t::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("PathExtruder single threaded extrusion of %zu points: %.3f ms",path.size(),millis);
+    
+    extruder.reset();
+    start = cuclock_t::now();
+    extruder.calculate(2.0f,PathJoint::ROUND,PathCap::ROUND,pool);
+    end = cuclock_t::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("PathExtruder parallel extrusion of %zu points: %.3f ms",path.size(),millis);
+}
+
+
+#pragma mark -
+#pragma mark Spline Approximator
+/**
+ * Returns an open spline winding back and forth with the given number of beziers
+ *
+ * @param segments  The number of bezier segments
+ *
+ * @return an open spline winding back and forth
+ */
+static CubicSpline createSpline(int segments) {
+    std::vector<Vec2> points;
+    points.reserve(3*segments+1);
+    for(int ii = 0; ii < segments; ii++) {
+        float sign = (ii % 2) ? -1.0f : 1.0f;
+        points.push_back(Vec2(ii*40.0f,0.0f));
+        points.push_back(Vec2(ii*40.0f+5.0f,sign*(30.0f+ii%7)));
+        points.push_back(Vec2(ii*40.0f+35.0f,-sign*15.0f));
+    }
+    points.push_back(Vec2(segments*40.0f,0.0f));
+    return CubicSpline(points);
+}
+
+/**
+ * Unit test for the spline approximator
+ */
+void testSplineApproximator() {
+    CULog("Running tests for CubicSplineApproximator.\n");
+    
+#pragma mark Calculation Test
+    CubicSpline spline = createSpline(6);
+    CubicSplineApproximator approx(&spline);
+    approx.calculate();
+    Poly2 path = approx.getPath();
+    std::vector<float> params;
+    size_t amt = approx.getParameters(params);
+    CUAssertAlwaysLog(amt == params.size(), "Method getParameters() failed");
+    CUAssertAlwaysLog(path.getVertices().size() == params.size(), "Method getPath() failed");
+    CUAssertAlwaysLog(path.getVertices().front() == spline.getAnchor(0), "Method getPath() failed");
+    CUAssertAlwaysLog(path.getVertices().back()  == spline.getAnchor(6), "Method getPath() failed");
+    std::vector<Vec2> normals;
+    approx.getNormals(normals);
+    CUAssertAlwaysLog(normals.size() == params.size(), "Method getNormals() failed");
+    
+#pragma mark Flatten Test
+    float tolerances[] = { 1.0f, 0.25f, 0.01f };
+    for(float tolerance : tolerances) {
+        size_t size = approx.flatten(nullptr,0,tolerance);
+        CUAssertAlwaysLog(size > 7, "Method flatten() failed");
+        
+        std::vector<Vec2> points(size);
+        std::vector<float> values(size);
+        CUAssertAlwaysLog(approx.flatten(points.data(),size-1,tolerance,values.data()) == size, "Method flatten() failed");
+        CUAssertAlwaysLog(points[0] == Vec2::ZERO && values[0] == 0, "Method flatten() failed");
+        CUAssertAlwaysLog(approx.flatten(points.data(),size,tolerance,values.data()) == size, "Method flatten() failed");
+        CUAssertAlwaysLog(points.front() == spline.getAnchor(0), "Method flatten() failed");
+        CUAssertAlwaysLog(points.back()  == spline.getAnchor(6), "Method flatten() failed");
+        CUAssertAlwaysLog(values.back() == 6.0f, "Method flatten() failed");
+        
+        bool correct = true;
+        for(size_t ii = 0; ii+1 < size; ii++) {
+            correct = correct && values[ii] < values[ii+1];
+            Vec2 chord = (points[ii]+points[ii+1])*0.5f;
+            Vec2 curve = spline.getPoint((values[ii]+values[ii+1])*0.5f);
+            correct = correct && chord.distance(curve) <= tolerance*1.01f;
+            correct = correct && points[ii].distance(spline.getPoint(values[ii])) < 0.01f;
+        }
+        CUAssertAlwaysLog(correct, "Method flatten() failed");
+    }
+    
+    // Flatter tolerance means more points
+    CUAssertAlwaysLog(approx.flatten(nullptr,0,0.01f) > approx.flatten(nullptr,0,1.0f), "Method flatten() failed");
+    
+    // Straight lines need only one segment
+    std::vector<Vec2> straight = { Vec2(0,0), Vec2(3,3), Vec2(6,6), Vec2(9,9) };
+    CubicSpline line(straight);
+    approx.set(&line);
+    CUAssertAlwaysLog(approx.flatten(nullptr,0,0.01f) == 2, "Method flatten() failed");
+    
+    // Closed splines do not repeat the first point
+    spline.setClosed(true);
+    approx.set(&spline);
+    size_t size = approx.flatten(nullptr,0,0.25f);
+    std::vector<Vec2> points(size);
+    approx.flatten(points.data(),size,0.25f);
+    CUAssertAlwaysLog(points.front() == spline.getAnchor(0), "Method flatten() failed");
+    CUAssertAlwaysLog(points.back() != spline.getAnchor(0), "Method flatten() failed");
+    
+#pragma mark Complete
+    CULog("CubicSplineApproximator tests complete.\n");
+}
+
+/**
+ * Performance test for the spline approximator
+ *
+ * This test logs the time to approximate a collection of splines with the
+ * calculate-materialize cycle and with the allocation free flatten method.
+ */
+void benchSplineApproximator() {
+    const int count = 500;
+    std::vector<CubicSpline> splines;
+    splines.reserve(count);
+    for(int ii = 0; ii < count; ii++) {
+        splines.push_back(createSpline(8+ii%8));
+    }
+    
+    CubicSplineApproximator approx;
+    size_t total = 0;
+    timestamp_t start = cuclock_t::now();
+    for(int ii = 0; ii < count; ii++) {
+        approx.set(&splines[ii]);
+        approx.calculate(CubicSplineApproximator::Criterion::DISTANCE,0.25f);
+        Poly2 path = approx.getPath();
+        total += path.getVertices().size();
+    }
+    timestamp_t end = cuclock_t::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("CubicSplineApproximator calculate of %d splines (%zu points): %.3f ms",count,total,millis);
+    
+    std::vector<Vec2> buffer(1 << 16);
+    total = 0;
+    start = cuclock_t::now();
+    for(int ii = 0; ii < count; ii++) {
+        approx.set(&splines[ii]);
+        total += approx.flatten(buffer.data(),buffer.size(),0.25f);
+    }
+    end = cuclock_t::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("CubicSplineApproximator flatten of %d splines (%zu points): %.3f ms",count,total,millis);
+}
+
+#pragma mark -
+#pragma mark PolyClipper
+/**
+ * Returns a square contour with the given corner and width
+ *
+ * @param x     The x-coordinate of the bottom left corner
+ * @param y     The y-coordinate of the bottom left corner
+ * @param width The width of the square
+ *
+ * @return a square contour with the given corner and width
+ */
+static std::vector<Vec2> createSquare(float x, float y, float width) {
+    std::vector<Vec2> result = { Vec2(x,y), Vec2(x+width,y), Vec2(x+width,y+width), Vec2(x,y+width) };
+    return result;
+}
+
+/**
+ * Returns a regular polygon approximating a circle
+ *
+ * @param center    The circle center
+ * @param radius    The circle radius
+ * @param sides     The number of sides
+ *
+ * @return a regular polygon approximating a circle
+ */
+static std::vector<Vec2> createCircle(const Vec2& center, float radius, int sides) {
+    std::vector<Vec2> result;
+    result.reserve(sides);
+    for(int ii = 0; ii < sides; ii++) {
+        float angle = 2.0f*(float)M_PI*ii/sides;
+        result.push_back(center+Vec2(std::cos(angle),std::sin(angle))*radius);
+    }
+    return result;
+}
+
+/**
+ * Returns the area of the given solid polygon
+ *
+ * @param poly  The solid polygon
+ *
+ * @return the area of the given solid polygon
+ */
+static double solidArea(const Poly2& poly) {
+    const std::vector<Vec2>& verts = poly.getVertices();
+    const std::vector<Uint32>& indices = poly.getIndices();
+    double area = 0;
+    for(size_t ii = 0; ii+2 < indices.size(); ii += 3) {
+        const Vec2& a = verts[indices[ii]];
+        const Vec2& b = verts[indices[ii+1]];
+        const Vec2& c = verts[indices[ii+2]];
+        area += std::fabs((b-a).cross(c-a))/2.0;
+    }
+    return area;
+}
+
+/**
+ * Unit test for the polygon clipper
+ */
+void testPolyClipper() {
+    CULog("Running tests for PolyClipper.\n");
+    
+#pragma mark Boolean Test
+    std::vector<Vec2> square1 = createSquare(0,0,2);
+    std::vector<Vec2> square2 = createSquare(1,1,2);
+    PolyClipper clipper(square1);
+    CUAssertAlwaysLog(clipper.getContourCount() == 1, "Method set() failed");
+    CUAssertAlwaysLog(clipper.getArea() == 4, "Method set() failed");
+    
+    clipper.calculate(PolyClipper::Operation::UNION,square2);
+    CUAssertAlwaysLog(clipper.getContourCount() == 1, "Union failed");
+    CUAssertAlwaysLog(clipper.getArea() == 7, "Union failed");
+    CUAssertAlwaysLog(clipper.getContours()[0].size() == 8, "Union failed");
+    
+    clipper.set(square1);
+    clipper.calculate(PolyClipper::Operation::INTERSECTION,square2);
+    CUAssertAlwaysLog(clipper.getContourCount() == 1, "Intersection failed");
+    CUAssertAlwaysLog(clipper.getArea() == 1, "Intersection failed");
+    
+    clipper.set(square1);
+    clipper.calculate(PolyClipper::Operation::DIFFERENCE,square2);
+    CUAssertAlwaysLog(clipper.getContourCount() == 1, "Difference failed");
+    CUAssertAlwaysLog(clipper.getArea() == 3, "Difference failed");
+    
+    clipper.set(square1);
+    clipper.calculate(PolyClipper::Operation::XOR,square2);
+    CUAssertAlwaysLog(clipper.getContourCount() == 2, "Exclusive or failed");
+    CUAssertAlwaysLog(clipper.getArea() == 6, "Exclusive or failed");
+    
+    // Orientation of the clip polygon does not matter
+    std::vector<Vec2> reverse(square2.rbegin(),square2.rend());
+    clipper.set(square1);
+    clipper.calculate(PolyClipper::Operation::DIFFERENCE,reverse);
+    CUAssertAlwaysLog(clipper.getArea() == 3, "Difference failed");
+    
+    // Disjoint shapes and shared edges
+    clipper.set(square1);
+    clipper.calculate(PolyClipper::Operation::UNION,createSquare(5,5,1));
+    CUAssertAlwaysLog(clipper.getContourCount() == 2, "Union failed");
+    CUAssertAlwaysLog(clipper.getArea() == 5, "Union failed");
+    clipper.set(createSquare(0,0,1));
+    clipper.calculate(PolyClipper::Operation::UNION,createSquare(1,0,1));
+    CUAssertAlwaysLog(clipper.getContourCount() == 1, "Union failed");
+    CUAssertAlwaysLog(clipper.getContours()[0].size() == 4, "Union failed");
+    CUAssertAlwaysLog(clipper.getArea() == 2, "Union failed");
+    clipper.set(square1);
+    clipper.calculate(PolyClipper::Operation::INTERSECTION,createSquare(5,5,1));
+    CUAssertAlwaysLog(clipper.getContourCount() == 0, "Intersection failed");
+    
+#pragma mark Hole Test
+    clipper.set(createSquare(0,0,10));
+    clipper.calculate(PolyClipper::Operation::DIFFERENCE,createSquare(4,4,2));
+    CUAssertAlwaysLog(clipper.getContourCount() == 2, "Difference failed");
+    CUAssertAlwaysLog(clipper.getArea() == 96, "Difference failed");
+    Poly2 solid = clipper.getPolygon();
+    CUAssertAlwaysLog(solid.getType() == Poly2::Type::SOLID, "Method getPolygon() failed");
+    CUAssertAlwaysLog(std::fabs(solidArea(solid)-96) < 0.01, "Method getPolygon() failed");
+    Poly2 outline = clipper.getOutline();
+    CUAssertAlwaysLog(outline.getType() == Poly2::Type::PATH, "Method getOutline() failed");
+    CUAssertAlwaysLog(outline.getVertices().size() == 8, "Method getOutline() failed");
+    CUAssertAlwaysLog(outline.getIndices().size() == 16, "Method getOutline() failed");
+    
+    // A hole touching the boundary at a vertex
+    clipper.calculate(PolyClipper::Operation::DIFFERENCE,createSquare(6,6,4));
+    CUAssertAlwaysLog(clipper.getArea() == 80, "Difference failed");
+    CUAssertAlwaysLog(std::fabs(solidArea(clipper.getPolygon())-80) < 0.01, "Method getPolygon() failed");
+    
+    // Nonzero winding of the input
+    std::vector<std::vector<Vec2>> contours;
+    contours.push_back(createSquare(0,0,4));
+    contours.push_back(createSquare(1,1,2));
+    std::reverse(contours.back().begin(), contours.back().end());
+    clipper.set(contours);
+    CUAssertAlwaysLog(clipper.getContourCount() == 2, "Method set() failed");
+    CUAssertAlwaysLog(clipper.getArea() == 12, "Method set() failed");
+    
+#pragma mark Input Test
+    // A bowtie
+    std::vector<Vec2> bowtie = { Vec2(0,0), Vec2(2,2), Vec2(2,0), Vec2(0,2) };
+    clipper.set(bowtie);
+    CUAssertAlwaysLog(clipper.getContourCount() == 2, "Method set() failed");
+    CUAssertAlwaysLog(clipper.getArea() == 2, "Method set() failed");
+    
+    // A triangulated polygon (on the snapping grid)
+    std::vector<Vec2> circle = createCircle(Vec2::ZERO,5,16);
+    for(auto it = circle.begin(); it != circle.end(); ++it) {
+        it->set(std::round(it->x*8)/8,std::round(it->y*8)/8);
+    }
+    Poly2 poly(circle);
+    MonotoneTriangulator triangulator(poly.getVertices());
+    triangulator.calculate();
+    poly = triangulator.getPolygon();
+    clipper.set(poly);
+    CUAssertAlwaysLog(clipper.getContourCount() == 1, "Method set() failed");
+    CUAssertAlwaysLog(clipper.getContours()[0].size() == 16, "Method set() failed");
+    CUAssertAlwaysLog(std::fabs(clipper.getArea()-solidArea(poly)) < 0.01, "Method set() failed");
+    
+    // A path polygon
+    outline = clipper.getOutline();
+    clipper.set(outline);
+    CUAssertAlwaysLog(std::fabs(clipper.getArea()-solidArea(poly)) < 0.01, "Method set() failed");
+    
+#pragma mark Offset Test
+    clipper.set(square1);
+    clipper.offset(1.0f,0.01f);
+    CUAssertAlwaysLog(std::fabs(clipper.getArea()-(12+M_PI)) < 0.05, "Method offset() failed");
+    clipper.set(createSquare(0,0,4));
+    clipper.offset(-1.0f);
+    CUAssertAlwaysLog(clipper.getArea() == 4, "Method offset() failed");
+    clipper.offset(-2.0f);
+    CUAssertAlwaysLog(clipper.getContourCount() == 0, "Method offset() failed");
+    
+#pragma mark Incremental Test
+    PolyClipper full(createCircle(Vec2(50,50),40,256));
+    PolyClipper incremental(full.getContours()[0]);
+    full.setIncremental(false);
+    CUAssertAlwaysLog(!full.isIncremental() && incremental.isIncremental(), "Method setIncremental() failed");
+    bool correct = true;
+    for(int ii = 0; ii < 60; ii++) {
+        float angle = 2.0f*(float)M_PI*ii/23;
+        Vec2 center = Vec2(50,50)+Vec2(std::cos(angle),std::sin(angle))*(30.0f+ii%15);
+        std::vector<Vec2> stamp = createCircle(center,3.0f+ii%4,12);
+        PolyClipper::Operation op = ii % 3 ? PolyClipper::Operation::DIFFERENCE : PolyClipper::Operation::UNION;
+        full.calculate(op,stamp);
+        incremental.calculate(op,stamp);
+        correct = correct && full.getContourCount() == incremental.getContourCount();
+        correct = correct && std::fabs(full.getArea()-incremental.getArea()) < 1e-6;
+    }
+    CUAssertAlwaysLog(correct, "Incremental clipping failed");
+    
+#pragma mark Complete
+    CULog("PolyClipper tests complete.\n");
+}
+
+/**
+ * Performance test for the polygon clipper
+ *
+ * This test logs the time to apply many small edits to a large polygon, both
+ * incrementally and by clipping the entire shape.
+ */
+void benchPolyClipper() {
+    const int count = 500;
+    std::vector<std::vector<Vec2>> stamps;
+    stamps.reserve(count);
+    for(int ii = 0; ii < count; ii++) {
+        float angle = 2.0f*(float)M_PI*ii/97;
+        Vec2 center = Vec2(500,500)+Vec2(std::cos(angle),std::sin(angle))*(390.0f+ii%20);
+        stamps.push_back(createCircle(center,4.0f+ii%5,16));
+    }
+    
+    std::vector<Vec2> terrain = createCircle(Vec2(500,500),400,4096);
+    PolyClipper clipper(terrain);
+    clipper.setIncremental(false);
+    timestamp_t start = cuclock_t::now();
+    for(int ii = 0; ii < count; ii++) {
+        clipper.calculate(PolyClipper::Operation::DIFFERENCE,stamps[ii]);
+    }
+    timestamp_t end = cuclock_t::now();
+    double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    double area = clipper.getArea();
+    CULog("PolyClipper full clipping of %d edits: %.3f ms",count,millis);
+    
+    clipper.set(terrain);
+    clipper.setIncremental(true);
+    start = cuclock_t::now();
+    for(int ii = 0; ii < count; ii++) {
+        clipper.calculate(PolyClipper::Operation::DIFFERENCE,stamps[ii]);
+    }
+    end = cuclock_t::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CUAssertAlwaysLog(std::fabs(clipper.getArea()-area) < 1e-3, "Incremental clipping failed");
+    CULog("PolyClipper incremental clipping of %d edits: %.3f ms",count,millis);
+    
+    start = cuclock_t::now();
+    clipper.offset(2.0f);
+    end = cuclock_t::now();
+    millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+    CULog("PolyClipper offset of %zu contours: %.3f ms",clipper.getContourCount(),millis);
+}
+
 #pragma mark -
 #pragma mark Polynomial
 /**
@@ -8213,6 +9719,223 @@ void testPolynomial() {
     
 }
 
+/**
+ * Returns the coefficients of the polynomial with the given roots
+ *
+ * @param roots     The polynomial roots
+ * @param degree    The number of roots
+ * @param coeffs    The array to store the degree+1 coefficients
+ */
+static void expandRoots(const float* roots, int degree, float* coeffs) {
+    double values[5] = { 1, 0, 0, 0, 0 };
+    for(int ii = 0; ii < degree; ii++) {
+        for(int jj = ii+1; jj > 0; jj--) {
+            values[jj] -= roots[ii]*values[jj-1];
+        }
+    }
+    for(int ii = 0; ii <= degree; ii++) {
+        coeffs[ii] = (float)values[ii];
+    }
+}
+
+/**
+ * Returns the roots of the ith generated polynomial of the given degree
+ *
+ * The roots are sorted and lie in the range [-1,1].
+ *
+ * @param index     The polynomial index
+ * @param degree    The number of roots
+ * @param roots     The array to store the roots
+ */
+static void createRoots(int index, int degree, float* roots) {
+    for(int ii = 0; ii < degree; ii++) {
+        roots[ii] = sinf(index*1.7f+ii*2.3f+0.5f);
+    }
+    std::sort(roots,roots+degree);
+}
+
+/**
+ * Unit test for a polynomial of degree at most four
+ */
+void testSmallPolynomial() {
+    CULog("Running tests for SmallPolynomial.\n");
+    
+#pragma mark Solver Test
+    float roots[4];
+    CUAssertAlwaysLog(SmallPolynomial::solveQuadratic(1,-3,2,roots) == 2,  "Method solveQuadratic() failed");
+    CUAssertAlwaysLog(roots[0] == 1 && roots[1] == 2,                       "Method solveQuadratic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveQuadratic(1,0,1,roots) == 0,   "Method solveQuadratic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveQuadratic(0,2,-4,roots) == 1,  "Method solveQuadratic() failed");
+    CUAssertAlwaysLog(roots[0] == 2,                                        "Method solveQuadratic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveQuadratic(1,-2,1,roots) == 2,  "Method solveQuadratic() failed");
+    CUAssertAlwaysLog(roots[0] == 1 && roots[1] == 1,                       "Method solveQuadratic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveQuadratic(0,0,1,roots) == 0,   "Method solveQuadratic() failed");
+    
+    CUAssertAlwaysLog(SmallPolynomial::solveCubic(1,-6,11,-6,roots) == 3,  "Method solveCubic() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(roots[0],1,CU_MATH_EPSILON) && CU_MATH_APPROX(roots[1],2,CU_MATH_EPSILON) &&
+                      CU_MATH_APPROX(roots[2],3,CU_MATH_EPSILON),           "Method solveCubic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveCubic(1,0,0,-1,roots) == 1,    "Method solveCubic() failed");
+    CUAssertAlwaysLog(roots[0] == 1,                                        "Method solveCubic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveCubic(1,-4,5,-2,roots) == 3,   "Method solveCubic() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(roots[0],1,CU_MATH_EPSILON) && CU_MATH_APPROX(roots[1],1,CU_MATH_EPSILON) &&
+                      CU_MATH_APPROX(roots[2],2,CU_MATH_EPSILON),           "Method solveCubic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveCubic(1,0,0,0,roots) == 3,     "Method solveCubic() failed");
+    CUAssertAlwaysLog(roots[0] == 0 && roots[1] == 0 && roots[2] == 0,      "Method solveCubic() failed");
+    
+    CUAssertAlwaysLog(SmallPolynomial::solveQuartic(1,-10,35,-50,24,roots) == 4, "Method solveQuartic() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(roots[0],1,CU_MATH_EPSILON) && CU_MATH_APPROX(roots[1],2,CU_MATH_EPSILON) &&
+                      CU_MATH_APPROX(roots[2],3,CU_MATH_EPSILON) && CU_MATH_APPROX(roots[3],4,CU_MATH_EPSILON),
+                      "Method solveQuartic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveQuartic(1,0,0,0,1,roots) == 0,  "Method solveQuartic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveQuartic(1,0,-5,0,4,roots) == 4, "Method solveQuartic() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(roots[0],-2,CU_MATH_EPSILON) && CU_MATH_APPROX(roots[1],-1,CU_MATH_EPSILON) &&
+                      CU_MATH_APPROX(roots[2], 1,CU_MATH_EPSILON) && CU_MATH_APPROX(roots[3], 2,CU_MATH_EPSILON),
+                      "Method solveQuartic() failed");
+    CUAssertAlwaysLog(SmallPolynomial::solveQuartic(1,1,-1,1,-2,roots) == 2, "Method solveQuartic() failed");
+    CUAssertAlwaysLog(CU_MATH_APPROX(roots[0],-2,CU_MATH_EPSILON) && CU_MATH_APPROX(roots[1],1,CU_MATH_EPSILON),
+                      "Method solveQuartic() failed");
+    
+    // Generated polynomials with known roots
+    bool correct = true;
+    float expected[4];
+    float coeffs[5];
+    for(int ii = 0; ii < 1000; ii++) {
+        for(int degree = 2; degree <= 4; degree++) {
+            createRoots(ii,degree,expected);
+            expandRoots(expected,degree,coeffs);
+            int amt = SmallPolynomial(coeffs,degree).roots(roots);
+            correct = correct && amt == degree;
+            for(int jj = 0; correct && jj < amt; jj++) {
+                correct = CU_MATH_APPROX(roots[jj],expected[jj],0.01f);
+            }
+        }
+    }
+    CUAssertAlwaysLog(correct, "Method roots() failed");
+    
+#pragma mark Batch Test
+    std::vector<float> cubics(4*100);
+    std::vector<float> values(3*100);
+    std::vector<int> sizes(100);
+    for(int ii = 0; ii < 100; ii++) {
+        cubics[4*ii  ] = 1.0f+ii%3;
+        cubics[4*ii+1] = sinf(ii*0.7f);
+        cubics[4*ii+2] = -2.0f+cosf(ii*1.3f);
+        cubics[4*ii+3] = sinf(ii*2.9f);
+    }
+    SmallPolynomial::solveCubics(cubics.data(),100,values.data(),sizes.data());
+    for(int ii = 0; ii < 100; ii++) {
+        int amt = SmallPolynomial::solveCubic(cubics[4*ii],cubics[4*ii+1],cubics[4*ii+2],cubics[4*ii+3],roots);
+        correct = correct && amt == sizes[ii];
+        for(int jj = 0; correct && jj < amt; jj++) {
+            correct = roots[jj] == values[3*ii+jj];
+        }
+    }
+    CUAssertAlwaysLog(correct, "Method solveCubics() failed");
+    
+#pragma mark Polynomial Test
+    coeffs[0] = 2; coeffs[1] = -6; coeffs[2] = 4;
+    SmallPolynomial test1(coeffs,2);
+    CUAssertAlwaysLog(test1.degree() == 2 && test1[0] == 2,    "Array constructor failed");
+    CUAssertAlwaysLog(test1.evaluate(3) == 4,                   "Method evaluate() failed");
+    SmallPolynomial test2 = test1.derivative();
+    CUAssertAlwaysLog(test2.degree() == 1 && test2[0] == 4 && test2[1] == -6, "Method derivative() failed");
+    CUAssertAlwaysLog(SmallPolynomial().derivative().degree() == 0, "Method derivative() failed");
+    CUAssertAlwaysLog(SmallPolynomial().roots(roots) == 0,     "Method roots() failed");
+    
+    Polynomial test3 = test1;
+    CUAssertAlwaysLog(test3.degree() == 2 && test3[2] == 4,    "Conversion failed");
+    SmallPolynomial test4(test3);
+    CUAssertAlwaysLog(test4.degree() == 2 && test4[1] == -6,   "Polynomial constructor failed");
+    
+    // Polynomial now uses the closed form solutions
+    std::vector<float> result;
+    CUAssertAlwaysLog(test3.roots(result),                      "Method roots() failed");
+    CUAssertAlwaysLog(result.size() == 2 && result[0] == 1 && result[1] == 2, "Method roots() failed");
+    test3[2] = 9;
+    result.clear();
+    CUAssertAlwaysLog(test3.roots(result),                      "Method roots() failed");
+    CUAssertAlwaysLog(result.size() == 2 && std::isnan(result[0]) && std::isnan(result[1]), "Method roots() failed");
+    
+#pragma mark Complete
+    CULog("SmallPolynomial tests complete.\n");
+}
+
+/**
+ * Performance test for polynomial root finding
+ *
+ * This test compares the accuracy and speed of Bairstow's method to the
+ * closed-form solutions for cubics and quartics with known roots.
+ */
+void benchPolynomial() {
+    const int count = 20000;
+    for(int degree = 3; degree <= 4; degree++) {
+        std::vector<float> coeffs((degree+1)*count);
+        std::vector<float> expected(degree*count);
+        for(int ii = 0; ii < count; ii++) {
+            createRoots(ii,degree,expected.data()+degree*ii);
+            expandRoots(expected.data()+degree*ii,degree,coeffs.data()+(degree+1)*ii);
+        }
+        
+        std::vector<Polynomial> polys;
+        polys.reserve(count);
+        for(int ii = 0; ii < count; ii++) {
+            auto first = coeffs.begin()+(degree+1)*ii;
+            polys.push_back(Polynomial(first,first+degree+1));
+        }
+        
+        // Bairstow's method
+        std::vector<float> roots;
+        double error = 0;
+        int failed = 0;
+        timestamp_t start = cuclock_t::now();
+        for(int ii = 0; ii < count; ii++) {
+            roots.clear();
+            if (polys[ii].bairstowRoots(roots)) {
+                std::sort(roots.begin(),roots.end());
+                for(int jj = 0; jj < degree; jj++) {
+                    error = std::max(error,(double)fabsf(roots[jj]-expected[degree*ii+jj]));
+                }
+            } else {
+                failed++;
+            }
+        }
+        timestamp_t end = cuclock_t::now();
+        double millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+        CULog("Bairstow roots of %d degree %d polynomials: %.3f ms (max error %g, %d failed)",
+              count,degree,millis,error,failed);
+        
+        // Closed form solutions
+        float values[4];
+        error = 0;
+        failed = 0;
+        start = cuclock_t::now();
+        for(int ii = 0; ii < count; ii++) {
+            SmallPolynomial poly(coeffs.data()+(degree+1)*ii,degree);
+            if (poly.roots(values) == degree) {
+                for(int jj = 0; jj < degree; jj++) {
+                    error = std::max(error,(double)fabsf(values[jj]-expected[degree*ii+jj]));
+                }
+            } else {
+                failed++;
+            }
+        }
+        end = cuclock_t::now();
+        millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+        CULog("Closed form roots of %d degree %d polynomials: %.3f ms (max error %g, %d failed)",
+              count,degree,millis,error,failed);
+        
+        if (degree == 3) {
+            std::vector<float> batch(3*count);
+            std::vector<int> sizes(count);
+            start = cuclock_t::now();
+            SmallPolynomial::solveCubics(coeffs.data(),count,batch.data(),sizes.data());
+            end = cuclock_t::now();
+            millis = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+            CULog("Batched roots of %d cubics: %.3f ms",count,millis);
+        }
+    }
+}
+
 #pragma mark -
 #pragma mark Ray
 /**
@@ -8609,9 +10332,26 @@ void mathUnitTest() {
     testRect();
     testQuaternion();
     testMat4();
+    benchMat4();
     testAffine2();
+    benchAffine2();
+    testVec2Array();
+    testColor4Array();
+    testAffineArray();
+    benchVec2Array();
     testPolynomial();
+    testSmallPolynomial();
+    benchPolynomial();
     testPoly2();
+    benchPoly2();
+    testTriangulator();
+    benchTriangulator();
+    testExtruder();
+    benchExtruder();
+    testSplineApproximator();
+    benchSplineApproximator();
+    testPolyClipper();
+    benchPolyClipper();
     testRay();
     testPlane();
     testFrustum();
@@ -88,21 +88,124 @@ void testQuaternion();
  */
 void testMat4();
 
+/**
+ * Performance test for a 4x4 matrix
+ *
+ * This test logs the throughput of each vectorized operation.
+ */
+void benchMat4();
+
 /**
  * Unit test for a 2-dimensional affine transform.
  */
 void testAffine2();
 
+/**
+ * Performance test for bulk 2d transforms
+ *
+ * This test logs the throughput of each memory layout in vertices per microsecond.
+ */
+void benchAffine2();
+
+/**
+ * Unit test for an array of 2d vectors in structure-of-arrays form.
+ */
+void testVec2Array();
+
+/**
+ * Unit test for an array of colors in structure-of-arrays form.
+ */
+void testColor4Array();
+
+/**
+ * Unit test for an array of affine transforms in structure-of-arrays form.
+ */
+void testAffineArray();
+
+/**
+ * Performance test for the structure-of-arrays containers
+ *
+ * This test logs the throughput of a particle update in particles per microsecond.
+ */
+void benchVec2Array();
+
 /**
  * Unit test for  2-dimensional polygon
  */
 void testPoly2();
 
+/**
+ * Performance test for polygon containment
+ *
+ * This test logs the throughput of containment queries in queries per microsecond.
+ */
+void benchPoly2();
+
+/**
+ * Unit test for the polygon triangulators
+ */
+void testTriangulator();
+
+/**
+ * Performance test for the polygon triangulators
+ *
+ * This test logs the time to triangulate polygons of increasing size.
+ */
+void benchTriangulator();
+
+/**
+ * Unit test for the path extruder
+ */
+void testExtruder();
+
+/**
+ * Performance test for the path extruder
+ *
+ * This test logs the time for incremental and parallel extrusion.
+ */
+void benchExtruder();
+
+/**
+ * Unit test for the spline approximator
+ */
+void testSplineApproximator();
+
+/**
+ * Performance test for the spline approximator
+ *
+ * This test logs the time for the calculate and flatten methods.
+ */
+void benchSplineApproximator();
+
+/**
+ * Unit test for the polygon clipper
+ */
+void testPolyClipper();
+
+/**
+ * Performance test for the polygon clipper
+ *
+ * This test logs the time for incremental and full clipping.
+ */
+void benchPolyClipper();
+
 /**
  * Unit test for a polynomial equation with root solver
  */
 void testPolynomial();
 
+/**
+ * Unit test for a polynomial of degree at most four
+ */
+void testSmallPolynomial();
+
+/**
+ * Performance test for polynomial root finding
+ *
+ * This test compares Bairstow's method to the closed-form solvers.
+ */
+void benchPolynomial();
+
 /**
  * Unit test for a 3-dimensional ray
  */
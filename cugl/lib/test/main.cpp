@@ -14,6 +14,8 @@
 
 #include "TCUMathTest.h"
 #include "TCU2DTest.h"
+#include "TCUAudioTest.h"
+#include "TCUIOTest.h"
 
 void testBinary() {
     CULog("Writing to File");
@@ -181,6 +183,8 @@ int main() {
     
     //cugl::mathUnitTest();
     //cugl::sceneUnitTest();
+    //cugl::audioUnitTest();
+    //cugl::ioUnitTest();
     //testBinary();
     //testFree();
     testThread();